@@ -51,7 +51,15 @@ def generate_decompositions():
 
 	return {c: gen(c) for c in interesting}
 
+DECOMP_BLOCK_SHIFT = 8
+
+def gen_lookup_table(decompositions):
+	# Indices into `decomp_slices`, offset by one so zero means no decomposition.
+	return unicode.two_level_table({k: i + 1 for i, k in enumerate(sorted(decompositions))}, DECOMP_BLOCK_SHIFT)
+
 def gen_header(decompositions, len_set):
+	block_indices, blocks = gen_lookup_table(decompositions)
+
 	print("""\
 #include <cstdint>
 
@@ -65,6 +73,9 @@ struct DECOMP_SLICE
 	print("{")
 	print(f"\tNUM_DECOMP_LENGTHS = {len(len_set)},")
 	print(f"\tNUM_DECOMPS = {len(decompositions)},")
+	print(f"\tDECOMP_BLOCK_SHIFT = {DECOMP_BLOCK_SHIFT},")
+	print(f"\tNUM_DECOMP_BLOCK_INDICES = {len(block_indices)},")
+	print(f"\tNUM_DECOMP_BLOCKS = {len(blocks)},")
 	print("};")
 	print()
 
@@ -72,6 +83,11 @@ struct DECOMP_SLICE
 	print("extern const int32_t decomp_chars[NUM_DECOMPS];")
 	print("extern const struct DECOMP_SLICE decomp_slices[NUM_DECOMPS];")
 	print("extern const int32_t decomp_data[];")
+	print()
+	print("// Two-level lookup table from code point to index into `decomp_slices` plus one,")
+	print("// zero if the code point has no decomposition.")
+	print("extern const uint16_t decomp_block_indices[NUM_DECOMP_BLOCK_INDICES];")
+	print("extern const uint16_t decomp_blocks[NUM_DECOMP_BLOCKS][1 << DECOMP_BLOCK_SHIFT];")
 
 def gen_data(decompositions, decomposition_set, decomposition_offsets, len_set):
 	print("""\
@@ -106,6 +122,10 @@ def gen_data(decompositions, decomposition_set, decomposition_offsets, len_set):
 		for c in d:
 			print(f"\t0x{c:x},")
 	print("};")
+	print()
+
+	block_indices, blocks = gen_lookup_table(decompositions)
+	unicode.print_two_level_table("decomp", "uint16_t", "DECOMP_BLOCK_SHIFT", block_indices, blocks, "NUM_DECOMP_BLOCK_INDICES", "NUM_DECOMP_BLOCKS")
 
 def main():
 	decompositions = generate_decompositions()
@@ -14,7 +14,14 @@ def generate_cases():
 	ud = unicode.data()
 	return [(unicode.unhex(u["Value"]), unicode.unhex(u["Simple_Lowercase_Mapping"])) for u in ud if u["Simple_Lowercase_Mapping"]]
 
+TOLOWER_BLOCK_SHIFT = 8
+
+def gen_lookup_table(cases):
+	# Indices into `tolowermap`, offset by one so zero means no lowercase mapping.
+	return unicode.two_level_table({upper_code: i + 1 for i, (upper_code, _) in enumerate(cases)}, TOLOWER_BLOCK_SHIFT)
+
 def gen_header(cases):
+	block_indices, blocks = gen_lookup_table(cases)
 	print(f"""\
 #include <cstdint>
 
@@ -27,9 +34,17 @@ struct UPPER_LOWER
 enum
 {{
 \tNUM_TOLOWER = {len(cases)},
+\tTOLOWER_BLOCK_SHIFT = {TOLOWER_BLOCK_SHIFT},
+\tNUM_TOLOWER_BLOCK_INDICES = {len(block_indices)},
+\tNUM_TOLOWER_BLOCKS = {len(blocks)},
 }};
 
-extern const struct UPPER_LOWER tolowermap[];""")
+extern const struct UPPER_LOWER tolowermap[];
+
+// Two-level lookup table from code point to index into `tolowermap` plus one,
+// zero if the code point has no lowercase mapping.
+extern const uint16_t tolower_block_indices[NUM_TOLOWER_BLOCK_INDICES];
+extern const uint16_t tolower_blocks[NUM_TOLOWER_BLOCKS][1 << TOLOWER_BLOCK_SHIFT];""")
 
 def gen_data(cases):
 	print("""\
@@ -41,6 +56,10 @@ const struct UPPER_LOWER tolowermap[] = {""")
 	for upper_code, lower_code in cases:
 		print(f"\t{{{upper_code}, {lower_code}}},")
 	print("};")
+	print()
+
+	block_indices, blocks = gen_lookup_table(cases)
+	unicode.print_two_level_table("tolower", "uint16_t", "TOLOWER_BLOCK_SHIFT", block_indices, blocks, "NUM_TOLOWER_BLOCK_INDICES", "NUM_TOLOWER_BLOCKS")
 
 def main():
 	cases = generate_cases()
@@ -33,3 +33,35 @@ def unhex(s):
 
 def unhex_sequence(s):
 	return [unhex(x) for x in s.split()] if '<' not in s else None
+
+def two_level_table(values, block_shift=8):
+	"""Builds a two-level lookup table from a dict mapping code points to
+	non-zero values. Returns the block index per code point block and the
+	deduplicated blocks, the first block contains only zeros."""
+	block_size = 1 << block_shift
+	num_block_indices = (max(values) >> block_shift) + 1
+	blocks = [tuple([0] * block_size)]
+	block_lookup = {blocks[0]: 0}
+	block_indices = []
+	for b in range(num_block_indices):
+		block = tuple(values.get((b << block_shift) + i, 0) for i in range(block_size))
+		if block not in block_lookup:
+			block_lookup[block] = len(blocks)
+			blocks.append(block)
+		block_indices.append(block_lookup[block])
+	return block_indices, blocks
+
+def print_two_level_table(name, value_type, block_shift_name, block_indices, blocks, num_indices_name, num_blocks_name):
+	print(f"const uint16_t {name}_block_indices[{num_indices_name}] = {{")
+	for i in range(0, len(block_indices), 16):
+		print("\t" + " ".join(f"{x}," for x in block_indices[i:i + 16]))
+	print("};")
+	print()
+
+	print(f"const {value_type} {name}_blocks[{num_blocks_name}][1 << {block_shift_name}] = {{")
+	for block in blocks:
+		print("\t{")
+		for i in range(0, len(block), 16):
+			print("\t\t" + " ".join(f"{x}," for x in block[i:i + 16]))
+		print("\t},")
+	print("};")
@@ -40,6 +40,7 @@
 #include <netinet/in.h>
 #include <pthread.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 
 #include <dirent.h>
@@ -392,6 +393,52 @@ int64_t io_length(IOHANDLE io)
 	return length;
 }
 
+const void *io_map(IOHANDLE io, unsigned *size)
+{
+	*size = 0;
+	const int64_t length = io_length(io);
+	if(length <= 0 || length > std::numeric_limits<unsigned>::max())
+	{
+		return nullptr;
+	}
+#if defined(CONF_FAMILY_WINDOWS)
+	HANDLE file = (HANDLE)_get_osfhandle(_fileno((FILE *)io));
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(mapping == nullptr)
+	{
+		return nullptr;
+	}
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, length);
+	// the view keeps the mapping alive
+	CloseHandle(mapping);
+	if(data == nullptr)
+	{
+		return nullptr;
+	}
+#else
+	void *data = mmap(nullptr, length, PROT_READ, MAP_SHARED, fileno((FILE *)io), 0);
+	if(data == MAP_FAILED)
+	{
+		return nullptr;
+	}
+#endif
+	*size = length;
+	return data;
+}
+
+void io_unmap(const void *data, unsigned size)
+{
+	if(data == nullptr)
+	{
+		return;
+	}
+#if defined(CONF_FAMILY_WINDOWS)
+	UnmapViewOfFile(data);
+#else
+	munmap(const_cast<void *>(data), size);
+#endif
+}
+
 unsigned io_write(IOHANDLE io, const void *buffer, unsigned size)
 {
 	return fwrite(buffer, 1, size, (FILE *)io);
@@ -2220,8 +2267,10 @@ void fs_listdir_fileinfo(const char *dir, FS_LISTDIR_CALLBACK_FILEINFO cb, int t
 		info.m_pName = current_entry.value().c_str();
 		info.m_TimeCreated = filetime_to_unixtime(&finddata.ftCreationTime);
 		info.m_TimeModified = filetime_to_unixtime(&finddata.ftLastWriteTime);
+		const bool is_dir = (finddata.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+		info.m_Size = is_dir ? 0 : (((int64_t)finddata.nFileSizeHigh << 32) | finddata.nFileSizeLow);
 
-		if(cb(&info, (finddata.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0, type, user))
+		if(cb(&info, is_dir, type, user))
 			break;
 	} while(FindNextFileW(handle, &finddata));
 
@@ -2246,15 +2295,19 @@ void fs_listdir_fileinfo(const char *dir, FS_LISTDIR_CALLBACK_FILEINFO cb, int t
 			continue;
 		}
 		str_copy(buffer + length, entry->d_name, sizeof(buffer) - length);
-		time_t created = -1, modified = -1;
-		fs_file_time(buffer, &created, &modified);
+
+		// a single stat for the times, the size and the type
+		struct stat sb;
+		const bool exists = stat(buffer, &sb) == 0;
+		const bool is_dir = exists && S_ISDIR(sb.st_mode);
 
 		CFsFileInfo info;
 		info.m_pName = entry->d_name;
-		info.m_TimeCreated = created;
-		info.m_TimeModified = modified;
+		info.m_TimeCreated = exists ? sb.st_ctime : -1;
+		info.m_TimeModified = exists ? sb.st_mtime : -1;
+		info.m_Size = exists && !is_dir ? (int64_t)sb.st_size : 0;
 
-		if(cb(&info, fs_is_dir(buffer), type, user))
+		if(cb(&info, is_dir, type, user))
 			break;
 	}
 
@@ -374,6 +374,33 @@ int64_t io_tell(IOHANDLE io);
  */
 int64_t io_length(IOHANDLE io);
 
+/**
+ * Maps the whole file read-only into memory. The mapping stays valid after
+ * the file is closed, and its pages are shared with every other process
+ * mapping the same file.
+ *
+ * @ingroup File-IO
+ *
+ * @param io Handle to the file.
+ * @param size Pointer that will receive the size of the mapping.
+ *
+ * @return Pointer to the mapped data, or `nullptr` on failure or if the file is empty.
+ *
+ * @remark The mapping must be released with @link io_unmap @endlink.
+ * @remark Truncating the file while it is mapped can crash the process.
+ */
+const void *io_map(IOHANDLE io, unsigned *size);
+
+/**
+ * Releases a mapping created by @link io_map @endlink.
+ *
+ * @ingroup File-IO
+ *
+ * @param data Pointer to the mapped data.
+ * @param size Size of the mapping.
+ */
+void io_unmap(const void *data, unsigned size);
+
 /**
  * Writes data from a buffer to a file.
  *
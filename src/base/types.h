@@ -1,6 +1,7 @@
 #ifndef BASE_TYPES_H
 #define BASE_TYPES_H
 
+#include <cstdint>
 #include <ctime>
 
 enum class TRISTATE
@@ -24,6 +25,7 @@ typedef struct
 	const char *m_pName;
 	time_t m_TimeCreated; // seconds since UNIX Epoch
 	time_t m_TimeModified; // seconds since UNIX Epoch
+	int64_t m_Size; // in bytes, 0 for directories
 } CFsFileInfo;
 
 typedef int (*FS_LISTDIR_CALLBACK_FILEINFO)(const CFsFileInfo *info, int is_dir, int dir_type, void *user);
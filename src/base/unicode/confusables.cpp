@@ -6,22 +6,19 @@
 
 static int str_utf8_skeleton(int ch, const int **skeleton, int *skeleton_len)
 {
-	int i;
-	for(i = 0; i < NUM_DECOMPS; i++)
+	int index = 0;
+	if(ch >= 0 && (ch >> DECOMP_BLOCK_SHIFT) < NUM_DECOMP_BLOCK_INDICES)
 	{
-		if(ch == decomp_chars[i])
-		{
-			int offset = decomp_slices[i].offset;
-			int length = decomp_lengths[decomp_slices[i].length];
+		index = decomp_blocks[decomp_block_indices[ch >> DECOMP_BLOCK_SHIFT]][ch & ((1 << DECOMP_BLOCK_SHIFT) - 1)];
+	}
+	if(index != 0)
+	{
+		int offset = decomp_slices[index - 1].offset;
+		int length = decomp_lengths[decomp_slices[index - 1].length];
 
-			*skeleton = &decomp_data[offset];
-			*skeleton_len = length;
-			return 1;
-		}
-		else if(ch < decomp_chars[i])
-		{
-			break;
-		}
+		*skeleton = &decomp_data[offset];
+		*skeleton_len = length;
+		return 1;
 	}
 	*skeleton = NULL;
 	*skeleton_len = 1;
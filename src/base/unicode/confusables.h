@@ -10,9 +10,17 @@ enum
 {
 	NUM_DECOMP_LENGTHS = 8,
 	NUM_DECOMPS = 9770,
+	DECOMP_BLOCK_SHIFT = 8,
+	NUM_DECOMP_BLOCK_INDICES = 4352,
+	NUM_DECOMP_BLOCKS = 170,
 };
 
 extern const uint8_t decomp_lengths[NUM_DECOMP_LENGTHS];
 extern const int32_t decomp_chars[NUM_DECOMPS];
 extern const struct DECOMP_SLICE decomp_slices[NUM_DECOMPS];
 extern const int32_t decomp_data[];
+
+// Two-level lookup table from code point to index into `decomp_slices` plus one,
+// zero if the code point has no decomposition.
+extern const uint16_t decomp_block_indices[NUM_DECOMP_BLOCK_INDICES];
+extern const uint16_t decomp_blocks[NUM_DECOMP_BLOCKS][1 << DECOMP_BLOCK_SHIFT];
@@ -1,24 +1,21 @@
-#include <cstdlib>
-
 #include "tolower.h"
 
-static int compul(const void *a, const void *b)
-{
-	struct UPPER_LOWER *ul_a = (struct UPPER_LOWER *)a;
-	struct UPPER_LOWER *ul_b = (struct UPPER_LOWER *)b;
-	return ul_a->upper - ul_b->upper;
-}
-
 int str_utf8_tolower(int code)
 {
-	struct UPPER_LOWER key;
-	struct UPPER_LOWER *res;
-	key.upper = code;
-	res = (UPPER_LOWER *)bsearch(&key, tolowermap, NUM_TOLOWER, sizeof(struct UPPER_LOWER), compul);
+	if(code < 0x80)
+	{
+		if(code >= 'A' && code <= 'Z')
+			return code + ('a' - 'A');
+		return code;
+	}
+
+	if((code >> TOLOWER_BLOCK_SHIFT) >= NUM_TOLOWER_BLOCK_INDICES)
+		return code;
 
-	if(res == NULL)
+	int index = tolower_blocks[tolower_block_indices[code >> TOLOWER_BLOCK_SHIFT]][code & ((1 << TOLOWER_BLOCK_SHIFT) - 1)];
+	if(index == 0)
 		return code;
-	return res->lower;
+	return tolowermap[index - 1].lower;
 }
 
 #define TOLOWER_DATA
@@ -9,6 +9,14 @@ struct UPPER_LOWER
 enum
 {
 	NUM_TOLOWER = 1433,
+	TOLOWER_BLOCK_SHIFT = 8,
+	NUM_TOLOWER_BLOCK_INDICES = 490,
+	NUM_TOLOWER_BLOCKS = 24,
 };
 
 extern const struct UPPER_LOWER tolowermap[];
+
+// Two-level lookup table from code point to index into `tolowermap` plus one,
+// zero if the code point has no lowercase mapping.
+extern const uint16_t tolower_block_indices[NUM_TOLOWER_BLOCK_INDICES];
+extern const uint16_t tolower_blocks[NUM_TOLOWER_BLOCKS][1 << TOLOWER_BLOCK_SHIFT];
@@ -71,6 +71,7 @@
 #undef main
 #endif
 
+#include <algorithm>
 #include <chrono>
 #include <limits>
 #include <new>
@@ -98,7 +99,7 @@ CClient::CClient() :
 	for(auto &SnapshotStorage : m_aSnapshotStorage)
 		SnapshotStorage.Init();
 	mem_zero(m_aDemorecSnapshotHolders, sizeof(m_aDemorecSnapshotHolders));
-	mem_zero(&m_CurrentServerInfo, sizeof(m_CurrentServerInfo));
+	m_CurrentServerInfo = CServerInfo{};
 	mem_zero(&m_Checksum, sizeof(m_Checksum));
 	for(auto &GameTime : m_aGameTime)
 		GameTime.Init(0);
@@ -680,7 +681,8 @@ void CClient::DisconnectWithReason(const char *pReason)
 	ResetMapDownload(true);
 
 	// clear the current server info
-	mem_zero(&m_CurrentServerInfo, sizeof(m_CurrentServerInfo));
+	m_CurrentServerInfo = CServerInfo{};
+	m_CurrentServerInfoArena.Reset();
 
 	// clear snapshots
 	m_aapSnapshots[0][SNAP_CURRENT] = 0;
@@ -780,12 +782,13 @@ bool CClient::DummyAllowed() const
 
 void CClient::GetServerInfo(CServerInfo *pServerInfo) const
 {
-	mem_copy(pServerInfo, &m_CurrentServerInfo, sizeof(m_CurrentServerInfo));
+	*pServerInfo = m_CurrentServerInfo;
 }
 
 void CClient::ServerInfoRequest()
 {
-	mem_zero(&m_CurrentServerInfo, sizeof(m_CurrentServerInfo));
+	m_CurrentServerInfo = CServerInfo{};
+	m_CurrentServerInfoArena.Reset();
 	m_CurrentServerInfoRequestTime = 0;
 }
 
@@ -890,6 +893,10 @@ void CClient::DebugRender()
 		Graphics()->QuadsText(2, 14, 16, aBuffer);
 	}
 
+	str_format(aBuffer, sizeof(aBuffer), "draw calls: %5" PRIu64 " render calls: %5" PRIu64,
+		Graphics()->DrawCallsLastFrame(), Graphics()->RenderCallsLastFrame());
+	Graphics()->QuadsText(2, 46, 16, aBuffer);
+
 	// render rates
 	{
 		int y = 0;
@@ -1204,12 +1211,17 @@ void CClient::ProcessServerInfo(int RawType, NETADDR *pFrom, const void *pData,
 {
 	CServerBrowser::CServerEntry *pEntry = m_ServerBrowser.Find(*pFrom);
 
+	CServerInfoArena Arena;
 	CServerInfo Info = {0};
 	int SavedType = SavedServerInfoType(RawType);
 	if(SavedType == SERVERINFO_EXTENDED && pEntry && pEntry->m_GotInfo && SavedType == pEntry->m_Info.m_Type)
 	{
 		Info = pEntry->m_Info;
 	}
+	// the clients of this packet are appended to the ones received before
+	CServerInfo::CClient *pClients = Arena.AllocateClients(MAX_CLIENTS);
+	std::copy(Info.m_pClients, Info.m_pClients + Info.m_NumReceivedClients, pClients);
+	Info.m_pClients = pClients;
 
 	Info.m_Type = SavedType;
 
@@ -1229,7 +1241,9 @@ void CClient::ProcessServerInfo(int RawType, NETADDR *pFrom, const void *pData,
 	{
 		GET_STRING(Info.m_aVersion);
 		GET_STRING(Info.m_aName);
-		GET_STRING(Info.m_aMap);
+		char aMap[MAX_MAP_LENGTH];
+		GET_STRING(aMap);
+		Info.m_pMap = Arena.InternString(aMap);
 
 		if(SavedType == SERVERINFO_EXTENDED)
 		{
@@ -1237,7 +1251,9 @@ void CClient::ProcessServerInfo(int RawType, NETADDR *pFrom, const void *pData,
 			GET_INT(Info.m_MapSize);
 		}
 
-		GET_STRING(Info.m_aGameType);
+		char aGameType[16];
+		GET_STRING(aGameType);
+		Info.m_pGameType = Arena.InternString(aGameType);
 		GET_INT(Info.m_Flags);
 		GET_INT(Info.m_NumPlayers);
 		GET_INT(Info.m_MaxPlayers);
@@ -1303,8 +1319,10 @@ void CClient::ProcessServerInfo(int RawType, NETADDR *pFrom, const void *pData,
 	bool IgnoreError = false;
 	for(int i = 0; i < MAX_CLIENTS && Info.m_NumReceivedClients < MAX_CLIENTS && !Up.Error(); i++)
 	{
-		CServerInfo::CClient *pClient = &Info.m_aClients[Info.m_NumReceivedClients];
-		GET_STRING(pClient->m_aName);
+		CServerInfo::CClient *pClient = &Info.m_pClients[Info.m_NumReceivedClients];
+		*pClient = {};
+		char aName[MAX_NAME_LENGTH];
+		GET_STRING(aName);
 		if(Up.Error())
 		{
 			// Packet end, no problem unless it happens during one
@@ -1312,7 +1330,11 @@ void CClient::ProcessServerInfo(int RawType, NETADDR *pFrom, const void *pData,
 			IgnoreError = true;
 			break;
 		}
-		GET_STRING(pClient->m_aClan);
+		char aClan[MAX_CLAN_LENGTH];
+		GET_STRING(aClan);
+		pClient->m_pName = Arena.StoreString(aName);
+		pClient->m_pClan = Arena.StoreString(aClan);
+		pClient->m_pSkin = "";
 		GET_INT(pClient->m_Country);
 		GET_INT(pClient->m_Score);
 		GET_INT(pClient->m_Player);
@@ -1359,7 +1381,9 @@ void CClient::ProcessServerInfo(int RawType, NETADDR *pFrom, const void *pData,
 			// us.
 			if(SavedType >= m_CurrentServerInfo.m_Type)
 			{
-				mem_copy(&m_CurrentServerInfo, &Info, sizeof(m_CurrentServerInfo));
+				m_CurrentServerInfoArena.Reset();
+				m_CurrentServerInfo = Info;
+				m_CurrentServerInfoArena.Store(&m_CurrentServerInfo);
 				m_CurrentServerInfo.m_NumAddresses = 1;
 				m_CurrentServerInfo.m_aAddresses[0] = ServerAddress();
 				m_CurrentServerInfoRequestTime = -1;
@@ -3858,8 +3882,9 @@ const char *CClient::DemoPlayer_Play(const char *pFilename, int StorageType)
 	}
 
 	// setup current server info
-	mem_zero(&m_CurrentServerInfo, sizeof(m_CurrentServerInfo));
-	str_copy(m_CurrentServerInfo.m_aMap, pMapInfo->m_aName);
+	m_CurrentServerInfo = CServerInfo{};
+	m_CurrentServerInfoArena.Reset();
+	m_CurrentServerInfo.m_pMap = m_CurrentServerInfoArena.InternString(pMapInfo->m_aName);
 	m_CurrentServerInfo.m_MapCrc = pMapInfo->m_Crc;
 	m_CurrentServerInfo.m_MapSize = pMapInfo->m_Size;
 
@@ -3968,7 +3993,8 @@ void CClient::DemoRecorder_Start(const char *pFilename, bool WithTimestamp, int
 			0,
 			m_pMap->File(),
 			nullptr,
-			nullptr);
+			nullptr,
+			g_Config.m_ClDemoAsyncWrite);
 	}
 }
 
@@ -4957,7 +4983,8 @@ void CClient::RaceRecord_Start(const char *pFilename)
 			0,
 			m_pMap->File(),
 			nullptr,
-			nullptr);
+			nullptr,
+			g_Config.m_ClDemoAsyncWrite);
 }
 
 void CClient::RaceRecord_Stop()
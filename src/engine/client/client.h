@@ -214,6 +214,7 @@ class CClient : public IClient, public CDemoPlayer::IListener
 	bool ServerCapAnyPlayerFlag() const override { return m_ServerCapabilities.m_AnyPlayerFlag; }
 
 	CServerInfo m_CurrentServerInfo;
+	CServerInfoArena m_CurrentServerInfoArena;
 	int64_t m_CurrentServerInfoRequestTime = -1; // >= 0 should request, == -1 got info
 
 	int m_CurrentServerPingInfoType = -1;
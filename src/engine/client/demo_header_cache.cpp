@@ -0,0 +1,193 @@
+#include "demo_header_cache.h"
+
+#include <base/lock.h>
+#include <base/system.h>
+#include <engine/console.h>
+#include <engine/sqlite.h>
+
+#include <sqlite3.h>
+
+#include <string>
+#include <unordered_map>
+
+class CDemoHeaderCache : public IDemoHeaderCache
+{
+public:
+	CDemoHeaderCache(IConsole *pConsole, IStorage *pStorage);
+	~CDemoHeaderCache() override;
+
+	bool Get(const char *pPath, int64_t Size, time_t Modified, CEntry *pEntry) override REQUIRES(!m_Lock);
+	void Set(const char *pPath, int64_t Size, time_t Modified, const CEntry &Entry) override REQUIRES(!m_Lock);
+	void Flush() override REQUIRES(!m_Lock);
+
+private:
+	// entries are written in batches, a transaction per demo would
+	// make scanning a folder with many demos slow
+	enum
+	{
+		FLUSH_THRESHOLD = 256,
+	};
+
+	class CPendingEntry
+	{
+	public:
+		int64_t m_Size;
+		time_t m_Modified;
+		CEntry m_Entry;
+	};
+
+	static bool ReadEntry(sqlite3_stmt *pStmt, int64_t Size, time_t Modified, CEntry *pEntry);
+	void FlushLocked() REQUIRES(m_Lock);
+
+	IConsole *m_pConsole;
+
+	CLock m_Lock;
+	CSqlite m_pDisk GUARDED_BY(m_Lock);
+	CSqliteStmt m_pLoadStmt GUARDED_BY(m_Lock);
+	CSqliteStmt m_pStoreStmt GUARDED_BY(m_Lock);
+	std::unordered_map<std::string, CPendingEntry> m_PendingEntries GUARDED_BY(m_Lock);
+};
+
+CDemoHeaderCache::CDemoHeaderCache(IConsole *pConsole, IStorage *pStorage) :
+	m_pConsole(pConsole)
+{
+	CLockScope LockScope(m_Lock);
+	m_pDisk = SqliteOpen(pConsole, pStorage, "ddnet-cache.sqlite3");
+	if(!m_pDisk)
+	{
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_header_cache", "failed to open ddnet-cache.sqlite3");
+		return;
+	}
+	sqlite3 *pSqlite = m_pDisk.get();
+	static const char TABLE[] = "CREATE TABLE IF NOT EXISTS demo_headers (path TEXT PRIMARY KEY NOT NULL, size INTEGER NOT NULL, modified INTEGER NOT NULL, valid INTEGER NOT NULL, header BLOB NOT NULL, timeline_markers BLOB NOT NULL, map_sha256 BLOB NOT NULL)";
+	if(SQLITE_HANDLE_ERROR(sqlite3_exec(pSqlite, TABLE, nullptr, nullptr, nullptr)))
+	{
+		m_pDisk = nullptr;
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_header_cache", "failed to create demo_headers table");
+		return;
+	}
+	m_pLoadStmt = SqlitePrepare(pConsole, pSqlite, "SELECT size, modified, valid, header, timeline_markers, map_sha256 FROM demo_headers WHERE path = ?");
+	m_pStoreStmt = SqlitePrepare(pConsole, pSqlite, "INSERT OR REPLACE INTO demo_headers (path, size, modified, valid, header, timeline_markers, map_sha256) VALUES (?, ?, ?, ?, ?, ?, ?)");
+}
+
+CDemoHeaderCache::~CDemoHeaderCache()
+{
+	Flush();
+}
+
+bool CDemoHeaderCache::Get(const char *pPath, int64_t Size, time_t Modified, CEntry *pEntry)
+{
+	CLockScope LockScope(m_Lock);
+	auto Pending = m_PendingEntries.find(pPath);
+	if(Pending != m_PendingEntries.end())
+	{
+		if(Pending->second.m_Size != Size || Pending->second.m_Modified != Modified)
+			return false;
+		*pEntry = Pending->second.m_Entry;
+		return true;
+	}
+
+	if(!m_pDisk || !m_pLoadStmt)
+		return false;
+
+	sqlite3 *pSqlite = m_pDisk.get();
+	IConsole *pConsole = m_pConsole;
+	sqlite3_stmt *pStmt = m_pLoadStmt.get();
+	if(SQLITE_HANDLE_ERROR(sqlite3_reset(pStmt)) != SQLITE_OK ||
+		SQLITE_HANDLE_ERROR(sqlite3_bind_text(pStmt, 1, pPath, -1, SQLITE_STATIC)) != SQLITE_OK ||
+		SQLITE_HANDLE_ERROR(sqlite3_step(pStmt)) != SQLITE_ROW)
+	{
+		sqlite3_reset(pStmt);
+		return false;
+	}
+	const bool Found = ReadEntry(pStmt, Size, Modified, pEntry);
+	// don't keep the read transaction open
+	sqlite3_reset(pStmt);
+	return Found;
+}
+
+bool CDemoHeaderCache::ReadEntry(sqlite3_stmt *pStmt, int64_t Size, time_t Modified, CEntry *pEntry)
+{
+	if(sqlite3_column_int64(pStmt, 0) != Size || sqlite3_column_int64(pStmt, 1) != (int64_t)Modified ||
+		sqlite3_column_bytes(pStmt, 3) != (int)sizeof(CDemoHeader) ||
+		sqlite3_column_bytes(pStmt, 4) > (int)sizeof(CTimelineMarkers) ||
+		sqlite3_column_bytes(pStmt, 5) != (int)sizeof(SHA256_DIGEST))
+	{
+		return false;
+	}
+
+	pEntry->m_Valid = sqlite3_column_int(pStmt, 2) != 0;
+	mem_copy(&pEntry->m_Info, sqlite3_column_blob(pStmt, 3), sizeof(CDemoHeader));
+	mem_zero(&pEntry->m_TimelineMarkers, sizeof(CTimelineMarkers));
+	if(sqlite3_column_bytes(pStmt, 4) > 0)
+		mem_copy(&pEntry->m_TimelineMarkers, sqlite3_column_blob(pStmt, 4), sqlite3_column_bytes(pStmt, 4));
+
+	// the map info is taken from the header like CDemoPlayer::GetDemoInfo does
+	mem_zero(&pEntry->m_MapInfo, sizeof(CMapInfo));
+	if(pEntry->m_Valid)
+	{
+		str_copy(pEntry->m_MapInfo.m_aName, pEntry->m_Info.m_aMapName);
+		mem_copy(&pEntry->m_MapInfo.m_Sha256, sqlite3_column_blob(pStmt, 5), sizeof(SHA256_DIGEST));
+		pEntry->m_MapInfo.m_Crc = bytes_be_to_uint(pEntry->m_Info.m_aMapCrc);
+		pEntry->m_MapInfo.m_Size = bytes_be_to_uint(pEntry->m_Info.m_aMapSize);
+	}
+	return true;
+}
+
+void CDemoHeaderCache::Set(const char *pPath, int64_t Size, time_t Modified, const CEntry &Entry)
+{
+	CLockScope LockScope(m_Lock);
+	m_PendingEntries[pPath] = CPendingEntry{Size, Modified, Entry};
+	if(m_PendingEntries.size() >= FLUSH_THRESHOLD)
+		FlushLocked();
+}
+
+void CDemoHeaderCache::Flush()
+{
+	CLockScope LockScope(m_Lock);
+	FlushLocked();
+}
+
+void CDemoHeaderCache::FlushLocked()
+{
+	if(m_PendingEntries.empty())
+		return;
+	if(!m_pDisk || !m_pStoreStmt)
+	{
+		m_PendingEntries.clear();
+		return;
+	}
+
+	sqlite3 *pSqlite = m_pDisk.get();
+	IConsole *pConsole = m_pConsole;
+	sqlite3_stmt *pStmt = m_pStoreStmt.get();
+	bool Error = SQLITE_HANDLE_ERROR(sqlite3_exec(pSqlite, "BEGIN", nullptr, nullptr, nullptr)) != SQLITE_OK;
+	for(const auto &[Path, Pending] : m_PendingEntries)
+	{
+		// only the markers that are used are stored
+		const int NumMarkers = clamp<int>(bytes_be_to_uint(Pending.m_Entry.m_TimelineMarkers.m_aNumTimelineMarkers), 0, MAX_TIMELINE_MARKERS);
+		const int MarkersSize = Pending.m_Entry.m_Valid ? sizeof(Pending.m_Entry.m_TimelineMarkers.m_aNumTimelineMarkers) + NumMarkers * sizeof(Pending.m_Entry.m_TimelineMarkers.m_aTimelineMarkers[0]) : 0;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_reset(pStmt)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_text(pStmt, 1, Path.c_str(), -1, SQLITE_STATIC)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int64(pStmt, 2, Pending.m_Size)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int64(pStmt, 3, Pending.m_Modified)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int(pStmt, 4, Pending.m_Entry.m_Valid)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_blob(pStmt, 5, &Pending.m_Entry.m_Info, sizeof(CDemoHeader), SQLITE_STATIC)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_blob(pStmt, 6, &Pending.m_Entry.m_TimelineMarkers, MarkersSize, SQLITE_STATIC)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_blob(pStmt, 7, &Pending.m_Entry.m_MapInfo.m_Sha256, sizeof(SHA256_DIGEST), SQLITE_STATIC)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_step(pStmt)) != SQLITE_DONE;
+		if(Error)
+			break;
+	}
+	Error = SQLITE_HANDLE_ERROR(sqlite3_exec(pSqlite, Error ? "ROLLBACK" : "COMMIT", nullptr, nullptr, nullptr)) != SQLITE_OK || Error;
+	if(Error)
+	{
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_header_cache", "failed to store demo headers");
+	}
+	m_PendingEntries.clear();
+}
+
+IDemoHeaderCache *CreateDemoHeaderCache(IConsole *pConsole, IStorage *pStorage)
+{
+	return new CDemoHeaderCache(pConsole, pStorage);
+}
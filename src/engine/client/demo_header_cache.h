@@ -0,0 +1,37 @@
+#ifndef ENGINE_CLIENT_DEMO_HEADER_CACHE_H
+#define ENGINE_CLIENT_DEMO_HEADER_CACHE_H
+#include <engine/demo.h>
+
+#include <cstdint>
+#include <ctime>
+
+class IConsole;
+class IStorage;
+
+// Persistent cache of the demo headers shown in the demo browser, so that
+// demos don't have to be opened again as long as they are not modified.
+// Safe to use from multiple threads.
+class IDemoHeaderCache
+{
+public:
+	class CEntry
+	{
+	public:
+		bool m_Valid;
+		CDemoHeader m_Info;
+		CTimelineMarkers m_TimelineMarkers;
+		CMapInfo m_MapInfo;
+	};
+
+	virtual ~IDemoHeaderCache() {}
+
+	// `pPath` is the complete path of the demo file. Returns false if the
+	// file isn't cached or its size or modification time changed.
+	virtual bool Get(const char *pPath, int64_t Size, time_t Modified, CEntry *pEntry) = 0;
+	virtual void Set(const char *pPath, int64_t Size, time_t Modified, const CEntry &Entry) = 0;
+	// Writes the entries that were set since the last flush to the disk.
+	virtual void Flush() = 0;
+};
+
+IDemoHeaderCache *CreateDemoHeaderCache(IConsole *pConsole, IStorage *pStorage);
+#endif // ENGINE_CLIENT_DEMO_HEADER_CACHE_H
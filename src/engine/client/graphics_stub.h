@@ -0,0 +1,236 @@
+#ifndef ENGINE_CLIENT_GRAPHICS_STUB_H
+#define ENGINE_CLIENT_GRAPHICS_STUB_H
+
+#include <engine/graphics.h>
+
+#include <cstdlib>
+
+// Graphics that do not render anything. Textures, buffers and containers
+// get valid handles and the draw calls are counted, so code built on top of
+// the graphics can be tested and benchmarked without a window.
+class CGraphicsStub : public IGraphics
+{
+	float m_ScreenX0 = 0.0f;
+	float m_ScreenY0 = 0.0f;
+	float m_ScreenX1 = 0.0f;
+	float m_ScreenY1 = 0.0f;
+	int m_NextBufferObject = 0;
+	int m_NextBufferContainer = 0;
+	int m_NextQuadContainer = 0;
+	TTwGraphicsGpuList m_Gpus;
+	TGLBackendReadPresentedImageData m_ReadPresentedImageDataFunc;
+
+public:
+	int m_NumTextures = 0;
+	int m_NumBufferObjects = 0;
+	int m_NumBufferContainers = 0;
+	int m_NumBufferContainersCreated = 0;
+	int m_NumDrawCalls = 0;
+	uint64_t m_NumIndicesDrawn = 0;
+
+	CGraphicsStub(int ScreenWidth = 1920, int ScreenHeight = 1080)
+	{
+		m_ScreenWidth = ScreenWidth;
+		m_ScreenHeight = ScreenHeight;
+		m_ScreenRefreshRate = 60;
+		m_ScreenHiDPIScale = 1.0f;
+		MapScreen(0.0f, 0.0f, ScreenWidth, ScreenHeight);
+	}
+
+	void ResetCounters()
+	{
+		m_NumBufferContainersCreated = 0;
+		m_NumDrawCalls = 0;
+		m_NumIndicesDrawn = 0;
+	}
+
+	void WarnPngliteIncompatibleImages(bool Warn) override {}
+	void SetWindowParams(int FullscreenMode, bool IsBorderless) override {}
+	bool SetWindowScreen(int Index) override { return false; }
+	bool SetVSync(bool State) override { return false; }
+	bool SetMultiSampling(uint32_t ReqMultiSamplingCount, uint32_t &MultiSamplingCountBackend) override { return false; }
+	int GetWindowScreen() override { return 0; }
+	void Move(int x, int y) override {}
+	bool Resize(int w, int h, int RefreshRate) override { return false; }
+	void ResizeToScreen() override {}
+	void GotResized(int w, int h, int RefreshRate) override {}
+	void UpdateViewport(int X, int Y, int W, int H, bool ByResize) override {}
+	void AddWindowResizeListener(WINDOW_RESIZE_FUNC pFunc) override {}
+	void AddWindowPropChangeListener(WINDOW_PROPS_CHANGED_FUNC pFunc) override {}
+	void WindowDestroyNtf(uint32_t WindowId) override {}
+	void WindowCreateNtf(uint32_t WindowId) override {}
+	void Clear(float r, float g, float b, bool ForceClearNow) override {}
+	void ClipEnable(int x, int y, int w, int h) override {}
+	void ClipDisable() override {}
+	void MapScreen(float TopLeftX, float TopLeftY, float BottomRightX, float BottomRightY) override {
+		m_ScreenX0 = TopLeftX;
+		m_ScreenY0 = TopLeftY;
+		m_ScreenX1 = BottomRightX;
+		m_ScreenY1 = BottomRightY;
+	}
+	void GetScreen(float *pTopLeftX, float *pTopLeftY, float *pBottomRightX, float *pBottomRightY) override {
+		*pTopLeftX = m_ScreenX0;
+		*pTopLeftY = m_ScreenY0;
+		*pBottomRightX = m_ScreenX1;
+		*pBottomRightY = m_ScreenY1;
+	}
+	void BlendNone() override {}
+	void BlendNormal() override {}
+	void BlendAdditive() override {}
+	void WrapNormal() override {}
+	void WrapClamp() override {}
+	uint64_t TextureMemoryUsage() const override { return 0; }
+	uint64_t BufferMemoryUsage() const override { return 0; }
+	uint64_t StreamedMemoryUsage() const override { return 0; }
+	uint64_t StagingMemoryUsage() const override { return 0; }
+	const TTwGraphicsGpuList &GetGpus() const override { return m_Gpus; }
+	bool LoadPng(CImageInfo &Image, const char *pFilename, int StorageType) override { return false; }
+	bool LoadPng(CImageInfo &Image, const uint8_t *pData, size_t DataSize, const char *pContextName) override { return false; }
+	bool CheckImageDivisibility(const char *pContextName, CImageInfo &Image, int DivX, int DivY, bool AllowResize) override { return false; }
+	bool IsImageFormatRgba(const char *pContextName, const CImageInfo &Image) override { return false; }
+	void UnloadTexture(CTextureHandle *pIndex) override { pIndex->Invalidate(); }
+	CTextureHandle LoadTextureRaw(const CImageInfo &Image, int Flags, const char *pTexName) override { return CreateTextureHandle(++m_NumTextures); }
+	CTextureHandle LoadTextureRawMove(CImageInfo &Image, int Flags, const char *pTexName) override
+	{
+		free(Image.m_pData);
+		Image.m_pData = nullptr;
+		return CreateTextureHandle(++m_NumTextures);
+	}
+	CTextureHandle LoadTexture(const char *pFilename, int StorageType, int Flags) override { return CreateTextureHandle(++m_NumTextures); }
+	void TextureSet(CTextureHandle Texture) override {}
+	bool LoadTextTextures(size_t Width, size_t Height, CTextureHandle &TextTexture, CTextureHandle &TextOutlineTexture, uint8_t *pTextData, uint8_t *pTextOutlineData) override {
+		free(pTextData);
+		free(pTextOutlineData);
+		TextTexture = CreateTextureHandle(++m_NumTextures);
+		TextOutlineTexture = CreateTextureHandle(++m_NumTextures);
+		return true;
+	}
+	bool UnloadTextTextures(CTextureHandle &TextTexture, CTextureHandle &TextOutlineTexture) override {
+		TextTexture.Invalidate();
+		TextOutlineTexture.Invalidate();
+		return true;
+	}
+	bool UpdateTextTexture(CTextureHandle TextureId, int x, int y, size_t Width, size_t Height, uint8_t *pData, bool IsMovedPointer) override {
+		if(IsMovedPointer)
+			free(pData);
+		return true;
+	}
+	CTextureHandle LoadSpriteTexture(const CImageInfo &FromImageInfo, const struct CDataSprite *pSprite) override { return CreateTextureHandle(++m_NumTextures); }
+	bool IsImageSubFullyTransparent(const CImageInfo &FromImageInfo, int x, int y, int w, int h) override { return false; }
+	bool IsSpriteTextureFullyTransparent(const CImageInfo &FromImageInfo, const struct CDataSprite *pSprite) override { return false; }
+	void FlushVertices(bool KeepVertices) override {}
+	void FlushVerticesTex3D() override {}
+	void RenderTileLayer(int BufferContainerIndex, const ColorRGBA &Color, char **pOffsets, unsigned int *pIndicedVertexDrawNum, size_t NumIndicesOffset) override {
+		m_NumDrawCalls++;
+		for(size_t i = 0; i < NumIndicesOffset; i++)
+			m_NumIndicesDrawn += pIndicedVertexDrawNum[i];
+	}
+	void RenderBorderTiles(int BufferContainerIndex, const ColorRGBA &Color, char *pIndexBufferOffset, const vec2 &Offset, const vec2 &Scale, uint32_t DrawNum) override { m_NumDrawCalls++; }
+	void RenderQuadLayer(int BufferContainerIndex, SQuadRenderInfo *pQuadInfo, size_t QuadNum, int QuadOffset) override { m_NumDrawCalls++; }
+	void RenderText(int BufferContainerIndex, int TextQuadNum, int TextureSize, int TextureTextIndex, int TextureTextOutlineIndex, const ColorRGBA &TextColor, const ColorRGBA &TextOutlineColor) override {
+		m_NumDrawCalls++;
+		m_NumIndicesDrawn += TextQuadNum * 6;
+	}
+	int CreateBufferObject(size_t UploadDataSize, void *pUploadData, int CreateFlags, bool IsMovedPointer) override {
+		if(IsMovedPointer)
+			free(pUploadData);
+		m_NumBufferObjects++;
+		return m_NextBufferObject++;
+	}
+	void RecreateBufferObject(int BufferIndex, size_t UploadDataSize, void *pUploadData, int CreateFlags, bool IsMovedPointer) override {
+		if(IsMovedPointer)
+			free(pUploadData);
+	}
+	void DeleteBufferObject(int BufferIndex) override { m_NumBufferObjects--; }
+	int CreateBufferContainer(struct SBufferContainerInfo *pContainerInfo) override {
+		m_NumBufferContainers++;
+		m_NumBufferContainersCreated++;
+		return m_NextBufferContainer++;
+	}
+	void DeleteBufferContainer(int &ContainerIndex, bool DestroyAllBO) override {
+		if(ContainerIndex == -1)
+			return;
+		m_NumBufferContainers--;
+		if(DestroyAllBO)
+			m_NumBufferObjects--;
+		ContainerIndex = -1;
+	}
+	void IndicesNumRequiredNotify(unsigned int RequiredIndicesCount) override {}
+	bool GetDriverVersion(EGraphicsDriverAgeType DriverAgeType, int &Major, int &Minor, int &Patch, const char *&pName, EBackendType BackendType) override { return false; }
+	bool IsConfigModernAPI() override { return false; }
+	bool IsTileBufferingEnabled() override { return true; }
+	bool IsQuadBufferingEnabled() override { return true; }
+	bool IsTextBufferingEnabled() override { return true; }
+	bool IsQuadContainerBufferingEnabled() override { return true; }
+	bool Uses2DTextureArrays() override { return false; }
+	bool HasTextureArraysSupport() override { return false; }
+	const char *GetVendorString() override { return "stub"; }
+	const char *GetVersionString() override { return "stub"; }
+	const char *GetRendererString() override { return "stub"; }
+	void LinesBegin() override {}
+	void LinesEnd() override {}
+	void LinesDraw(const CLineItem *pArray, int Num) override {}
+	void QuadsBegin() override {}
+	void QuadsEnd() override {}
+	void QuadsTex3DBegin() override {}
+	void QuadsTex3DEnd() override {}
+	void TrianglesBegin() override {}
+	void TrianglesEnd() override {}
+	void QuadsEndKeepVertices() override {}
+	void QuadsDrawCurrentVertices(bool KeepVertices) override {}
+	void QuadsSetRotation(float Angle) override {}
+	void QuadsSetSubset(float TopLeftU, float TopLeftV, float BottomRightU, float BottomRightV) override {}
+	void QuadsSetSubsetFree(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3, int Index) override {}
+	void QuadsDraw(CQuadItem *pArray, int Num) override {}
+	void QuadsDrawTL(const CQuadItem *pArray, int Num) override {}
+	void QuadsTex3DDrawTL(const CQuadItem *pArray, int Num) override {}
+	int CreateQuadContainer(bool AutomaticUpload) override { return m_NextQuadContainer++; }
+	void QuadContainerChangeAutomaticUpload(int ContainerIndex, bool AutomaticUpload) override {}
+	void QuadContainerUpload(int ContainerIndex) override {}
+	int QuadContainerAddQuads(int ContainerIndex, CQuadItem *pArray, int Num) override { return 0; }
+	int QuadContainerAddQuads(int ContainerIndex, CFreeformItem *pArray, int Num) override { return 0; }
+	void QuadContainerReset(int ContainerIndex) override {}
+	void DeleteQuadContainer(int &ContainerIndex) override { ContainerIndex = -1; }
+	void RenderQuadContainer(int ContainerIndex, int QuadDrawNum) override {}
+	void RenderQuadContainer(int ContainerIndex, int QuadOffset, int QuadDrawNum, bool ChangeWrapMode) override {}
+	void RenderQuadContainerEx(int ContainerIndex, int QuadOffset, int QuadDrawNum, float X, float Y, float ScaleX, float ScaleY) override {}
+	void RenderQuadContainerAsSprite(int ContainerIndex, int QuadOffset, float X, float Y, float ScaleX, float ScaleY) override {}
+	void RenderQuadContainerAsSpriteMultiple(int ContainerIndex, int QuadOffset, int DrawCount, SRenderSpriteInfo *pRenderInfo) override {}
+	void QuadsDrawFreeform(const CFreeformItem *pArray, int Num) override {}
+	void QuadsDrawFreeformBatch(const CFreeformQuad *pArray, int Num) override {}
+	void QuadsText(float x, float y, float Size, const char *pText) override {}
+	void DrawRectExt(float x, float y, float w, float h, float r, int Corners) override {}
+	void DrawRectExt4(float x, float y, float w, float h, ColorRGBA ColorTopLeft, ColorRGBA ColorTopRight, ColorRGBA ColorBottomLeft, ColorRGBA ColorBottomRight, float r, int Corners) override {}
+	int CreateRectQuadContainer(float x, float y, float w, float h, float r, int Corners) override { return m_NextQuadContainer++; }
+	void DrawRect(float x, float y, float w, float h, ColorRGBA Color, int Corners, float Rounding) override {}
+	void DrawRect4(float x, float y, float w, float h, ColorRGBA ColorTopLeft, ColorRGBA ColorTopRight, ColorRGBA ColorBottomLeft, ColorRGBA ColorBottomRight, int Corners, float Rounding) override {}
+	void DrawCircle(float CenterX, float CenterY, float Radius, int Segments) override {}
+	void SetColorVertex(const CColorVertex *pArray, size_t Num) override {}
+	void SetColor(float r, float g, float b, float a) override {}
+	void SetColor(ColorRGBA Color) override {}
+	void SetColor4(ColorRGBA TopLeft, ColorRGBA TopRight, ColorRGBA BottomLeft, ColorRGBA BottomRight) override {}
+	void ChangeColorOfCurrentQuadVertices(float r, float g, float b, float a) override {}
+	void ChangeColorOfQuadVertices(size_t QuadOffset, unsigned char r, unsigned char g, unsigned char b, unsigned char a) override {}
+	void ReadPixel(ivec2 Position, ColorRGBA *pColor) override {}
+	void TakeScreenshot(const char *pFilename) override {}
+	void TakeCustomScreenshot(const char *pFilename) override {}
+	int GetVideoModes(CVideoMode *pModes, int MaxModes, int Screen) override { return 0; }
+	void GetCurrentVideoMode(CVideoMode &CurMode, int Screen) override {}
+	void Swap() override {}
+	uint64_t FrameCount() const override { return 0; }
+	uint64_t DrawCallsLastFrame() const override { return 0; }
+	uint64_t RenderCallsLastFrame() const override { return 0; }
+	int GetNumScreens() const override { return 1; }
+	const char *GetScreenName(int Screen) const override { return "stub"; }
+	void InsertSignal(class CSemaphore *pSemaphore) override {}
+	bool IsIdle() const override { return true; }
+	void WaitForIdle() override {}
+	void SetWindowGrab(bool Grab) override {}
+	void NotifyWindow() override {}
+	TGLBackendReadPresentedImageData &GetReadPresentedImageDataFuncUnsafe() override { return m_ReadPresentedImageDataFunc; }
+	std::optional<SWarning> CurrentWarning() override { return std::nullopt; }
+	bool ShowMessageBox(unsigned Type, const char *pTitle, const char *pMsg) override { return false; }
+	bool IsBackendInitialized() override { return true; }
+};
+
+#endif
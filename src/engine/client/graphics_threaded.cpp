@@ -246,6 +246,7 @@ void CGraphics_Threaded::LinesEnd()
 void CGraphics_Threaded::LinesDraw(const CLineItem *pArray, int Num)
 {
 	dbg_assert(m_Drawing == DRAWING_LINES, "called Graphics()->LinesDraw without begin");
+	m_FrameDrawCalls++;
 
 	for(int i = 0; i < Num; ++i)
 	{
@@ -619,6 +620,7 @@ bool CGraphics_Threaded::IsImageFormatRgba(const char *pContextName, const CImag
 
 void CGraphics_Threaded::KickCommandBuffer()
 {
+	m_FrameRenderCalls += m_pCommandBuffer->m_RenderCallCount;
 	m_pBackend->RunBuffer(m_pCommandBuffer);
 
 	std::vector<std::string> WarningStrings;
@@ -894,11 +896,13 @@ void CGraphics_Threaded::QuadsDraw(CQuadItem *pArray, int Num)
 
 void CGraphics_Threaded::QuadsDrawTL(const CQuadItem *pArray, int Num)
 {
+	m_FrameDrawCalls++;
 	QuadsDrawTLImpl(m_aVertices, pArray, Num);
 }
 
 void CGraphics_Threaded::QuadsTex3DDrawTL(const CQuadItem *pArray, int Num)
 {
+	m_FrameDrawCalls++;
 	const int VertNum = g_Config.m_GfxQuadAsTriangle && !m_GLUseTrianglesAsQuad ? 6 : 4;
 	const float CurIndex = Uses2DTextureArrays() ? m_CurIndex : (m_CurIndex + 0.5f) / 256.0f;
 
@@ -916,6 +920,7 @@ void CGraphics_Threaded::QuadsTex3DDrawTL(const CQuadItem *pArray, int Num)
 void CGraphics_Threaded::QuadsDrawFreeform(const CFreeformItem *pArray, int Num)
 {
 	dbg_assert(m_Drawing == DRAWING_QUADS || m_Drawing == DRAWING_TRIANGLES, "called Graphics()->QuadsDrawFreeform without begin");
+	m_FrameDrawCalls++;
 
 	if((g_Config.m_GfxQuadAsTriangle && !m_GLUseTrianglesAsQuad) || m_Drawing == DRAWING_TRIANGLES)
 	{
@@ -983,6 +988,67 @@ void CGraphics_Threaded::QuadsDrawFreeform(const CFreeformItem *pArray, int Num)
 	}
 }
 
+void CGraphics_Threaded::QuadsDrawFreeformBatch(const CFreeformQuad *pArray, int Num)
+{
+	dbg_assert(m_Drawing == DRAWING_QUADS || m_Drawing == DRAWING_TRIANGLES, "called Graphics()->QuadsDrawFreeformBatch without begin");
+	m_FrameDrawCalls++;
+	if(Num <= 0)
+		return;
+
+	// keep the order with the vertices that were added before
+	FlushVertices();
+
+	const bool AsTriangles = (g_Config.m_GfxQuadAsTriangle && !m_GLUseTrianglesAsQuad) || m_Drawing == DRAWING_TRIANGLES;
+	static const int s_aTriangleCorners[] = {0, 1, 3, 0, 3, 2};
+	static const int s_aQuadCorners[] = {0, 1, 3, 2};
+	const int *pCorners = AsTriangles ? s_aTriangleCorners : s_aQuadCorners;
+	const int VertNum = AsTriangles ? 6 : 4;
+	const int MaxQuadsPerCommand = CCommandBuffer::MAX_VERTICES / VertNum;
+
+	while(Num > 0)
+	{
+		const int NumQuads = minimum(Num, MaxQuadsPerCommand);
+		const size_t NumVerts = (size_t)NumQuads * VertNum;
+
+		CCommandBuffer::SCommand_Render Cmd;
+		Cmd.m_State = m_State;
+		Cmd.m_PrimType = AsTriangles ? CCommandBuffer::PRIMTYPE_TRIANGLES : CCommandBuffer::PRIMTYPE_QUADS;
+		Cmd.m_PrimCount = AsTriangles ? NumQuads * 2 : NumQuads;
+		Cmd.m_pVertices = (CCommandBuffer::SVertex *)AllocCommandBufferData(sizeof(CCommandBuffer::SVertex) * NumVerts);
+		AddCmd(Cmd, [&] {
+			Cmd.m_pVertices = (CCommandBuffer::SVertex *)m_pCommandBuffer->AllocData(sizeof(CCommandBuffer::SVertex) * NumVerts);
+			return Cmd.m_pVertices != nullptr;
+		});
+		m_pCommandBuffer->AddRenderCalls(1);
+
+		CCommandBuffer::SVertex *pVertex = Cmd.m_pVertices;
+		for(int i = 0; i < NumQuads; ++i)
+		{
+			const CFreeformQuad &Quad = pArray[i];
+			CCommandBuffer::SColor aColors[4];
+			for(int c = 0; c < 4; ++c)
+			{
+				aColors[c].r = NormalizeColorComponent(Quad.m_aColors[c].r);
+				aColors[c].g = NormalizeColorComponent(Quad.m_aColors[c].g);
+				aColors[c].b = NormalizeColorComponent(Quad.m_aColors[c].b);
+				aColors[c].a = NormalizeColorComponent(Quad.m_aColors[c].a);
+			}
+			for(int v = 0; v < VertNum; ++v, ++pVertex)
+			{
+				const int Corner = pCorners[v];
+				pVertex->m_Pos.x = Quad.m_aPos[Corner].x;
+				pVertex->m_Pos.y = Quad.m_aPos[Corner].y;
+				pVertex->m_Tex.u = Quad.m_aTexCoords[Corner].x;
+				pVertex->m_Tex.v = Quad.m_aTexCoords[Corner].y;
+				pVertex->m_Color = aColors[Corner];
+			}
+		}
+
+		pArray += NumQuads;
+		Num -= NumQuads;
+	}
+}
+
 void CGraphics_Threaded::QuadsText(float x, float y, float Size, const char *pText)
 {
 	float StartX = x;
@@ -2719,6 +2785,11 @@ void CGraphics_Threaded::Swap()
 	}
 
 	KickCommandBuffer();
+	m_FrameCount++;
+	m_LastFrameDrawCalls = m_FrameDrawCalls;
+	m_LastFrameRenderCalls = m_FrameRenderCalls;
+	m_FrameDrawCalls = 0;
+	m_FrameRenderCalls = 0;
 	// TODO: Remove when https://github.com/libsdl-org/SDL/issues/5203 is fixed
 #ifdef CONF_PLATFORM_MACOS
 	if(str_find(GetVersionString(), "Metal"))
@@ -773,6 +773,11 @@ class CGraphics_Threaded : public IEngineGraphics
 	CCommandBuffer *m_apCommandBuffers[NUM_CMDBUFFERS];
 	CCommandBuffer *m_pCommandBuffer;
 	unsigned m_CurrentCommandBuffer;
+	uint64_t m_FrameCount = 0;
+	uint64_t m_FrameDrawCalls = 0;
+	uint64_t m_FrameRenderCalls = 0;
+	uint64_t m_LastFrameDrawCalls = 0;
+	uint64_t m_LastFrameRenderCalls = 0;
 
 	//
 	class IStorage *m_pStorage;
@@ -1103,6 +1108,7 @@ public:
 	void QuadsTex3DDrawTL(const CQuadItem *pArray, int Num) override;
 
 	void QuadsDrawFreeform(const CFreeformItem *pArray, int Num) override;
+	void QuadsDrawFreeformBatch(const CFreeformQuad *pArray, int Num) override;
 	void QuadsText(float x, float y, float Size, const char *pText) override;
 
 	void DrawRectExt(float x, float y, float w, float h, float r, int Corners) override;
@@ -1231,6 +1237,9 @@ public:
 	void TakeScreenshot(const char *pFilename) override;
 	void TakeCustomScreenshot(const char *pFilename) override;
 	void Swap() override;
+	uint64_t FrameCount() const override { return m_FrameCount; }
+	uint64_t DrawCallsLastFrame() const override { return m_LastFrameDrawCalls; }
+	uint64_t RenderCallsLastFrame() const override { return m_LastFrameRenderCalls; }
 	bool SetVSync(bool State) override;
 	bool SetMultiSampling(uint32_t ReqMultiSamplingCount, uint32_t &MultiSamplingCountBackend) override;
 
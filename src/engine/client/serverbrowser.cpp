@@ -49,6 +49,41 @@ bool matchesExactly(const char *a, const char *b)
 	return str_comp(a, &b[1]) == 0;
 }
 
+class CSearchToken
+{
+public:
+	char m_aString[sizeof(g_Config.m_BrFilterString)];
+	bool (*m_pfnMatches)(const char *, const char *);
+	// whether only the servers in m_vCandidates can match
+	bool m_Indexed;
+	std::vector<bool> m_vCandidates;
+};
+
+static void ParseSearchTokens(const char *pStr, std::vector<CSearchToken> &vTokens)
+{
+	char aToken[sizeof(CSearchToken::m_aString)];
+	while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aToken, sizeof(aToken))))
+	{
+		CSearchToken Token;
+		str_copy(Token.m_aString, str_utf8_skip_whitespaces(aToken));
+		str_utf8_trim_right(Token.m_aString);
+
+		if(Token.m_aString[0] == '\0')
+		{
+			continue;
+		}
+		Token.m_pfnMatches = matchesPart;
+		const int Length = str_length(Token.m_aString);
+		if(Token.m_aString[0] == '"' && Token.m_aString[Length - 1] == '"')
+		{
+			Token.m_aString[Length - 1] = '\0';
+			Token.m_pfnMatches = matchesExactly;
+		}
+		Token.m_Indexed = false;
+		vTokens.push_back(Token);
+	}
+}
+
 CServerBrowser::CServerBrowser() :
 	m_CommunityCache(this),
 	m_CountriesFilter(&m_CommunityCache),
@@ -344,70 +379,57 @@ int CServerBrowser::GetExtraToken(int Token)
 
 bool CServerBrowser::SortCompareName(int Index1, int Index2) const
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
+	const bool GotInfo1 = m_SortKeys.m_vGotInfo[Index1];
+	const bool GotInfo2 = m_SortKeys.m_vGotInfo[Index2];
 	//	make sure empty entries are listed last
-	return (pIndex1->m_GotInfo && pIndex2->m_GotInfo) || (!pIndex1->m_GotInfo && !pIndex2->m_GotInfo) ? str_comp(pIndex1->m_Info.m_aName, pIndex2->m_Info.m_aName) < 0 :
-													    pIndex1->m_GotInfo != 0;
+	return GotInfo1 == GotInfo2 ? str_comp(m_SortKeys.m_vpName[Index1], m_SortKeys.m_vpName[Index2]) < 0 : GotInfo1;
 }
 
 bool CServerBrowser::SortCompareMap(int Index1, int Index2) const
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return str_comp(pIndex1->m_Info.m_aMap, pIndex2->m_Info.m_aMap) < 0;
+	return str_comp(m_SortKeys.m_vpMap[Index1], m_SortKeys.m_vpMap[Index2]) < 0;
 }
 
 bool CServerBrowser::SortComparePing(int Index1, int Index2) const
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return pIndex1->m_Info.m_Latency < pIndex2->m_Info.m_Latency;
+	return m_SortKeys.m_vLatency[Index1] < m_SortKeys.m_vLatency[Index2];
 }
 
 bool CServerBrowser::SortCompareGametype(int Index1, int Index2) const
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return str_comp(pIndex1->m_Info.m_aGameType, pIndex2->m_Info.m_aGameType) < 0;
+	return m_SortKeys.m_vGameTypeRank[Index1] < m_SortKeys.m_vGameTypeRank[Index2];
 }
 
 bool CServerBrowser::SortCompareNumPlayers(int Index1, int Index2) const
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return pIndex1->m_Info.m_NumFilteredPlayers > pIndex2->m_Info.m_NumFilteredPlayers;
+	return m_SortKeys.m_vNumFilteredPlayers[Index1] > m_SortKeys.m_vNumFilteredPlayers[Index2];
 }
 
 bool CServerBrowser::SortCompareNumClients(int Index1, int Index2) const
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return pIndex1->m_Info.m_NumClients > pIndex2->m_Info.m_NumClients;
+	return m_SortKeys.m_vNumClients[Index1] > m_SortKeys.m_vNumClients[Index2];
 }
 
 bool CServerBrowser::SortCompareNumFriends(int Index1, int Index2) const
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-
-	if(pIndex1->m_Info.m_FriendNum == pIndex2->m_Info.m_FriendNum)
-		return pIndex1->m_Info.m_NumFilteredPlayers > pIndex2->m_Info.m_NumFilteredPlayers;
+	const std::vector<int> &vFriendNum = m_SortKeys.m_vFriendNum;
+	if(vFriendNum[Index1] == vFriendNum[Index2])
+		return m_SortKeys.m_vNumFilteredPlayers[Index1] > m_SortKeys.m_vNumFilteredPlayers[Index2];
 	else
-		return pIndex1->m_Info.m_FriendNum > pIndex2->m_Info.m_FriendNum;
+		return vFriendNum[Index1] > vFriendNum[Index2];
 }
 
 bool CServerBrowser::SortCompareNumPlayersAndPing(int Index1, int Index2) const
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
+	const std::vector<int> &vNumPlayers = m_SortKeys.m_vNumFilteredPlayers;
+	const std::vector<int> &vLatency = m_SortKeys.m_vLatency;
 
-	if(pIndex1->m_Info.m_NumFilteredPlayers == pIndex2->m_Info.m_NumFilteredPlayers)
-		return pIndex1->m_Info.m_Latency > pIndex2->m_Info.m_Latency;
-	else if(pIndex1->m_Info.m_NumFilteredPlayers == 0 || pIndex2->m_Info.m_NumFilteredPlayers == 0 || pIndex1->m_Info.m_Latency / 100 == pIndex2->m_Info.m_Latency / 100)
-		return pIndex1->m_Info.m_NumFilteredPlayers < pIndex2->m_Info.m_NumFilteredPlayers;
+	if(vNumPlayers[Index1] == vNumPlayers[Index2])
+		return vLatency[Index1] > vLatency[Index2];
+	else if(vNumPlayers[Index1] == 0 || vNumPlayers[Index2] == 0 || vLatency[Index1] / 100 == vLatency[Index2] / 100)
+		return vNumPlayers[Index1] < vNumPlayers[Index2];
 	else
-		return pIndex1->m_Info.m_Latency > pIndex2->m_Info.m_Latency;
+		return vLatency[Index1] > vLatency[Index2];
 }
 
 void CServerBrowser::Filter()
@@ -423,6 +445,25 @@ void CServerBrowser::Filter()
 		m_pSortedServerlist = (int *)calloc(m_NumSortedServersCapacity, sizeof(int));
 	}
 
+	// split the search strings once and look up which servers can match
+	// the quick search tokens, so that the others don't need to be checked
+	std::vector<CSearchToken> vFilterTokens;
+	std::vector<CSearchToken> vExcludeTokens;
+	ParseSearchTokens(g_Config.m_BrFilterString, vFilterTokens);
+	ParseSearchTokens(g_Config.m_BrExcludeString, vExcludeTokens);
+	std::vector<int> vCandidates;
+	for(CSearchToken &Token : vFilterTokens)
+	{
+		const char *pNeedle = Token.m_pfnMatches == matchesExactly ? &Token.m_aString[1] : Token.m_aString;
+		Token.m_Indexed = m_SearchIndex.Candidates(pNeedle, vCandidates);
+		if(Token.m_Indexed)
+		{
+			Token.m_vCandidates.resize(m_NumServers);
+			for(int Candidate : vCandidates)
+				Token.m_vCandidates[Candidate] = true;
+		}
+	}
+
 	// filter the servers
 	for(int i = 0; i < m_NumServers; i++)
 	{
@@ -437,9 +478,9 @@ void CServerBrowser::Filter()
 			Filtered = true;
 		else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(Info.m_aAddress, g_Config.m_BrFilterServerAddress))
 			Filtered = true;
-		else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
+		else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(Info.m_pGameType, g_Config.m_BrFilterGametype))
 			Filtered = true;
-		else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_utf8_find_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
+		else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_utf8_find_nocase(Info.m_pGameType, g_Config.m_BrFilterGametype))
 			Filtered = true;
 		else if(g_Config.m_BrFilterUnfinishedMap && Info.m_HasRank == CServerInfo::RANK_RANKED)
 			Filtered = true;
@@ -451,13 +492,13 @@ void CServerBrowser::Filter()
 			{
 				if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES)
 				{
-					Filtered = CommunitiesFilter().Filtered(Info.m_aCommunityId);
+					Filtered = CommunitiesFilter().Filtered(Info.m_pCommunityId);
 				}
 				if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES ||
 					(m_ServerlistType >= IServerBrowser::TYPE_FAVORITE_COMMUNITY_1 && m_ServerlistType <= IServerBrowser::TYPE_FAVORITE_COMMUNITY_5))
 				{
-					Filtered = Filtered || CountriesFilter().Filtered(Info.m_aCommunityCountry);
-					Filtered = Filtered || TypesFilter().Filtered(Info.m_aCommunityType);
+					Filtered = Filtered || CountriesFilter().Filtered(Info.m_pCommunityCountry);
+					Filtered = Filtered || TypesFilter().Filtered(Info.m_pCommunityType);
 				}
 			}
 
@@ -465,9 +506,9 @@ void CServerBrowser::Filter()
 			{
 				Filtered = true;
 				// match against player country
-				for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
+				for(int p = 0; p < Info.m_NumReceivedClients; p++)
 				{
-					if(Info.m_aClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
+					if(Info.m_pClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
 					{
 						Filtered = false;
 						break;
@@ -475,45 +516,32 @@ void CServerBrowser::Filter()
 				}
 			}
 
-			if(!Filtered && g_Config.m_BrFilterString[0] != '\0')
+			if(!Filtered && !vFilterTokens.empty())
 			{
 				Info.m_QuickSearchHit = 0;
 
-				const char *pStr = g_Config.m_BrFilterString;
-				char aFilterStr[sizeof(g_Config.m_BrFilterString)];
-				char aFilterStrTrimmed[sizeof(g_Config.m_BrFilterString)];
-				while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aFilterStr, sizeof(aFilterStr))))
+				for(const CSearchToken &Token : vFilterTokens)
 				{
-					str_copy(aFilterStrTrimmed, str_utf8_skip_whitespaces(aFilterStr));
-					str_utf8_trim_right(aFilterStrTrimmed);
-
-					if(aFilterStrTrimmed[0] == '\0')
+					if(Token.m_Indexed && !Token.m_vCandidates[i])
 					{
 						continue;
 					}
-					auto MatchesFn = matchesPart;
-					const int FilterLen = str_length(aFilterStrTrimmed);
-					if(aFilterStrTrimmed[0] == '"' && aFilterStrTrimmed[FilterLen - 1] == '"')
-					{
-						aFilterStrTrimmed[FilterLen - 1] = '\0';
-						MatchesFn = matchesExactly;
-					}
 
 					// match against server name
-					if(MatchesFn(Info.m_aName, aFilterStrTrimmed))
+					if(Token.m_pfnMatches(Info.m_aName, Token.m_aString))
 					{
 						Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
 					}
 
 					// match against players
-					for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
+					for(int p = 0; p < Info.m_NumReceivedClients; p++)
 					{
-						if(MatchesFn(Info.m_aClients[p].m_aName, aFilterStrTrimmed) ||
-							MatchesFn(Info.m_aClients[p].m_aClan, aFilterStrTrimmed))
+						if(Token.m_pfnMatches(Info.m_pClients[p].m_pName, Token.m_aString) ||
+							Token.m_pfnMatches(Info.m_pClients[p].m_pClan, Token.m_aString))
 						{
 							if(g_Config.m_BrFilterConnectingPlayers &&
-								str_comp(Info.m_aClients[p].m_aName, "(connecting)") == 0 &&
-								Info.m_aClients[p].m_aClan[0] == '\0')
+								str_comp(Info.m_pClients[p].m_pName, "(connecting)") == 0 &&
+								Info.m_pClients[p].m_pClan[0] == '\0')
 							{
 								continue;
 							}
@@ -523,7 +551,7 @@ void CServerBrowser::Filter()
 					}
 
 					// match against map
-					if(MatchesFn(Info.m_aMap, aFilterStrTrimmed))
+					if(Token.m_pfnMatches(Info.m_pMap, Token.m_aString))
 					{
 						Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
 					}
@@ -533,44 +561,26 @@ void CServerBrowser::Filter()
 					Filtered = true;
 			}
 
-			if(!Filtered && g_Config.m_BrExcludeString[0] != '\0')
+			if(!Filtered && !vExcludeTokens.empty())
 			{
-				const char *pStr = g_Config.m_BrExcludeString;
-				char aExcludeStr[sizeof(g_Config.m_BrExcludeString)];
-				char aExcludeStrTrimmed[sizeof(g_Config.m_BrExcludeString)];
-				while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aExcludeStr, sizeof(aExcludeStr))))
+				for(const CSearchToken &Token : vExcludeTokens)
 				{
-					str_copy(aExcludeStrTrimmed, str_utf8_skip_whitespaces(aExcludeStr));
-					str_utf8_trim_right(aExcludeStrTrimmed);
-
-					if(aExcludeStrTrimmed[0] == '\0')
-					{
-						continue;
-					}
-					auto MatchesFn = matchesPart;
-					const int FilterLen = str_length(aExcludeStrTrimmed);
-					if(aExcludeStrTrimmed[0] == '"' && aExcludeStrTrimmed[FilterLen - 1] == '"')
-					{
-						aExcludeStrTrimmed[FilterLen - 1] = '\0';
-						MatchesFn = matchesExactly;
-					}
-
 					// match against server name
-					if(MatchesFn(Info.m_aName, aExcludeStrTrimmed))
+					if(Token.m_pfnMatches(Info.m_aName, Token.m_aString))
 					{
 						Filtered = true;
 						break;
 					}
 
 					// match against map
-					if(MatchesFn(Info.m_aMap, aExcludeStrTrimmed))
+					if(Token.m_pfnMatches(Info.m_pMap, Token.m_aString))
 					{
 						Filtered = true;
 						break;
 					}
 
 					// match against gametype
-					if(MatchesFn(Info.m_aGameType, aExcludeStrTrimmed))
+					if(Token.m_pfnMatches(Info.m_pGameType, Token.m_aString))
 					{
 						Filtered = true;
 						break;
@@ -621,6 +631,7 @@ void CServerBrowser::Sort()
 	Filter();
 
 	// sort
+	m_SortKeys.Update(m_ppServerlist, m_NumServers, g_Config.m_BrSort);
 	if(g_Config.m_BrSortOrder == 2 && (g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS || g_Config.m_BrSort == IServerBrowser::SORT_PING))
 		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumPlayersAndPing));
 	else if(g_Config.m_BrSort == IServerBrowser::SORT_NAME)
@@ -723,7 +734,7 @@ void ServerBrowserFormatAddresses(char *pBuffer, int BufferSize, NETADDR *pAddrs
 	}
 }
 
-void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info) const
+void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info)
 {
 	const CServerInfo TmpInfo = pEntry->m_Info;
 	pEntry->m_Info = Info;
@@ -731,15 +742,17 @@ void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info) cons
 	pEntry->m_Info.m_FavoriteAllowPing = TmpInfo.m_FavoriteAllowPing;
 	mem_copy(pEntry->m_Info.m_aAddresses, TmpInfo.m_aAddresses, sizeof(pEntry->m_Info.m_aAddresses));
 	pEntry->m_Info.m_NumAddresses = TmpInfo.m_NumAddresses;
+	pEntry->m_Info.m_ServerIndex = TmpInfo.m_ServerIndex;
 	ServerBrowserFormatAddresses(pEntry->m_Info.m_aAddress, sizeof(pEntry->m_Info.m_aAddress), pEntry->m_Info.m_aAddresses, pEntry->m_Info.m_NumAddresses);
-	str_copy(pEntry->m_Info.m_aCommunityId, TmpInfo.m_aCommunityId);
-	str_copy(pEntry->m_Info.m_aCommunityCountry, TmpInfo.m_aCommunityCountry);
-	str_copy(pEntry->m_Info.m_aCommunityType, TmpInfo.m_aCommunityType);
+	pEntry->m_Info.m_pCommunityId = TmpInfo.m_pCommunityId;
+	pEntry->m_Info.m_pCommunityCountry = TmpInfo.m_pCommunityCountry;
+	pEntry->m_Info.m_pCommunityType = TmpInfo.m_pCommunityType;
+	m_ServerInfoArena.Store(&pEntry->m_Info);
 	UpdateServerRank(&pEntry->m_Info);
 
 	if(pEntry->m_Info.m_ClientScoreKind == CServerInfo::CLIENT_SCORE_KIND_UNSPECIFIED)
 	{
-		if(str_find_nocase(pEntry->m_Info.m_aGameType, "race") || str_find_nocase(pEntry->m_Info.m_aGameType, "fastcap"))
+		if(str_find_nocase(pEntry->m_Info.m_pGameType, "race") || str_find_nocase(pEntry->m_Info.m_pGameType, "fastcap"))
 		{
 			pEntry->m_Info.m_ClientScoreKind = CServerInfo::CLIENT_SCORE_KIND_TIME_BACKCOMPAT;
 		}
@@ -788,11 +801,12 @@ void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info) cons
 					return Score0 > Score1;
 			}
 
-			return str_comp_nocase(p0.m_aName, p1.m_aName) < 0;
+			return str_comp_nocase(p0.m_pName, p1.m_pName) < 0;
 		}
 	};
 
-	std::sort(pEntry->m_Info.m_aClients, pEntry->m_Info.m_aClients + Info.m_NumReceivedClients, CPlayerScoreNameLess(pEntry->m_Info.m_ClientScoreKind));
+	std::sort(pEntry->m_Info.m_pClients, pEntry->m_Info.m_pClients + pEntry->m_Info.m_NumReceivedClients, CPlayerScoreNameLess(pEntry->m_Info.m_ClientScoreKind));
+	m_SearchIndex.Update(pEntry->m_Info.m_ServerIndex, pEntry->m_Info);
 
 	pEntry->m_GotInfo = 1;
 }
@@ -837,7 +851,6 @@ CServerBrowser::CServerEntry *CServerBrowser::Add(const NETADDR *pAddrs, int Num
 {
 	// create new pEntry
 	CServerEntry *pEntry = m_ServerlistHeap.Allocate<CServerEntry>();
-	mem_zero(pEntry, sizeof(CServerEntry));
 
 	// set the info
 	mem_copy(pEntry->m_Info.m_aAddresses, pAddrs, NumAddrs * sizeof(pAddrs[0]));
@@ -872,6 +885,7 @@ CServerBrowser::CServerEntry *CServerBrowser::Add(const NETADDR *pAddrs, int Num
 	// add to list
 	m_ppServerlist[m_NumServers] = pEntry;
 	pEntry->m_Info.m_ServerIndex = m_NumServers;
+	m_SearchIndex.Update(m_NumServers, pEntry->m_Info);
 	m_NumServers++;
 
 	return pEntry;
@@ -1186,10 +1200,12 @@ void CServerBrowser::CleanUp()
 {
 	// clear out everything
 	m_ServerlistHeap.Reset();
+	m_ServerInfoArena.Reset();
 	m_NumServers = 0;
 	m_NumSortedServers = 0;
 	m_NumSortedPlayers = 0;
 	m_ByAddr.clear();
+	m_SearchIndex.Clear();
 	m_pFirstReqServer = nullptr;
 	m_pLastReqServer = nullptr;
 	m_NumRequests = 0;
@@ -1556,9 +1572,10 @@ void CServerBrowser::UpdateServerFilteredPlayers(CServerInfo *pInfo) const
 	pInfo->m_NumFilteredPlayers = g_Config.m_BrFilterSpectators ? pInfo->m_NumPlayers : pInfo->m_NumClients;
 	if(g_Config.m_BrFilterConnectingPlayers)
 	{
-		for(const auto &Client : pInfo->m_aClients)
+		for(int ClientIndex = 0; ClientIndex < pInfo->m_NumReceivedClients; ClientIndex++)
 		{
-			if((!g_Config.m_BrFilterSpectators || Client.m_Player) && str_comp(Client.m_aName, "(connecting)") == 0 && Client.m_aClan[0] == '\0')
+			const CServerInfo::CClient &Client = pInfo->m_pClients[ClientIndex];
+			if((!g_Config.m_BrFilterSpectators || Client.m_Player) && str_comp(Client.m_pName, "(connecting)") == 0 && Client.m_pClan[0] == '\0')
 				pInfo->m_NumFilteredPlayers--;
 		}
 	}
@@ -1570,35 +1587,36 @@ void CServerBrowser::UpdateServerFriends(CServerInfo *pInfo) const
 	pInfo->m_FriendNum = 0;
 	for(int ClientIndex = 0; ClientIndex < minimum(pInfo->m_NumReceivedClients, (int)MAX_CLIENTS); ClientIndex++)
 	{
-		pInfo->m_aClients[ClientIndex].m_FriendState = m_pFriends->GetFriendState(pInfo->m_aClients[ClientIndex].m_aName, pInfo->m_aClients[ClientIndex].m_aClan);
-		pInfo->m_FriendState = maximum(pInfo->m_FriendState, pInfo->m_aClients[ClientIndex].m_FriendState);
-		if(pInfo->m_aClients[ClientIndex].m_FriendState != IFriends::FRIEND_NO)
+		CServerInfo::CClient &Client = pInfo->m_pClients[ClientIndex];
+		Client.m_FriendState = m_pFriends->GetFriendState(Client.m_pName, Client.m_pClan);
+		pInfo->m_FriendState = maximum(pInfo->m_FriendState, Client.m_FriendState);
+		if(Client.m_FriendState != IFriends::FRIEND_NO)
 			pInfo->m_FriendNum++;
 	}
 }
 
-void CServerBrowser::UpdateServerCommunity(CServerInfo *pInfo) const
+void CServerBrowser::UpdateServerCommunity(CServerInfo *pInfo)
 {
 	for(int AddressIndex = 0; AddressIndex < pInfo->m_NumAddresses; AddressIndex++)
 	{
 		const auto Community = m_CommunityServersByAddr.find(pInfo->m_aAddresses[AddressIndex]);
 		if(Community != m_CommunityServersByAddr.end())
 		{
-			str_copy(pInfo->m_aCommunityId, Community->second.CommunityId());
-			str_copy(pInfo->m_aCommunityCountry, Community->second.CountryName());
-			str_copy(pInfo->m_aCommunityType, Community->second.TypeName());
+			pInfo->m_pCommunityId = m_ServerInfoArena.InternString(Community->second.CommunityId());
+			pInfo->m_pCommunityCountry = m_ServerInfoArena.InternString(Community->second.CountryName());
+			pInfo->m_pCommunityType = m_ServerInfoArena.InternString(Community->second.TypeName());
 			return;
 		}
 	}
-	str_copy(pInfo->m_aCommunityId, COMMUNITY_NONE);
-	str_copy(pInfo->m_aCommunityCountry, COMMUNITY_COUNTRY_NONE);
-	str_copy(pInfo->m_aCommunityType, COMMUNITY_TYPE_NONE);
+	pInfo->m_pCommunityId = COMMUNITY_NONE;
+	pInfo->m_pCommunityCountry = COMMUNITY_COUNTRY_NONE;
+	pInfo->m_pCommunityType = COMMUNITY_TYPE_NONE;
 }
 
 void CServerBrowser::UpdateServerRank(CServerInfo *pInfo) const
 {
-	const CCommunity *pCommunity = Community(pInfo->m_aCommunityId);
-	pInfo->m_HasRank = pCommunity == nullptr ? CServerInfo::RANK_UNAVAILABLE : pCommunity->HasRank(pInfo->m_aMap);
+	const CCommunity *pCommunity = Community(pInfo->m_pCommunityId);
+	pInfo->m_HasRank = pCommunity == nullptr ? CServerInfo::RANK_UNAVAILABLE : pCommunity->HasRank(pInfo->m_pMap);
 }
 
 const char *CServerBrowser::GetTutorialServer()
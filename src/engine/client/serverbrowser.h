@@ -6,9 +6,12 @@
 #include <base/hash.h>
 #include <base/system.h>
 
+#include <engine/client/serverbrowser_search.h>
+#include <engine/client/serverbrowser_sortkeys.h>
 #include <engine/console.h>
 #include <engine/serverbrowser.h>
 #include <engine/shared/memheap.h>
+#include <engine/shared/serverinfo_arena.h>
 
 #include <functional>
 #include <unordered_map>
@@ -257,7 +260,7 @@ public:
 	void LoadDDNetServers();
 	void UpdateServerFilteredPlayers(CServerInfo *pInfo) const;
 	void UpdateServerFriends(CServerInfo *pInfo) const;
-	void UpdateServerCommunity(CServerInfo *pInfo) const;
+	void UpdateServerCommunity(CServerInfo *pInfo);
 	void UpdateServerRank(CServerInfo *pInfo) const;
 	const char *GetTutorialServer() override;
 
@@ -316,9 +319,13 @@ private:
 	const char *m_pHttpPrevBestUrl = nullptr;
 
 	CHeap m_ServerlistHeap;
+	// the clients and strings of the server entries
+	CServerInfoArena m_ServerInfoArena;
 	CServerEntry **m_ppServerlist;
 	int *m_pSortedServerlist;
 	std::unordered_map<NETADDR, int> m_ByAddr;
+	CServerBrowserSearchIndex m_SearchIndex;
+	CServerBrowserSortKeys m_SortKeys;
 
 	std::vector<CCommunity> m_vCommunities;
 	std::unordered_map<NETADDR, CCommunityServer> m_CommunityServersByAddr;
@@ -398,7 +405,7 @@ private:
 	bool ValidateCountryName(const char *pCountryName) const;
 	bool ValidateTypeName(const char *pTypeName) const;
 
-	void SetInfo(CServerEntry *pEntry, const CServerInfo &Info) const;
+	void SetInfo(CServerEntry *pEntry, const CServerInfo &Info);
 	void SetLatency(NETADDR Addr, int Latency);
 
 	static bool ParseCommunityFinishes(CCommunity *pCommunity, const json_value &Finishes);
@@ -14,6 +14,7 @@
 #include <base/log.h>
 #include <base/system.h>
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -21,6 +22,43 @@
 
 using namespace std::chrono_literals;
 
+// Receives the server list and parses it while it is being downloaded.
+class CServerListRequest : public CHttpRequest
+{
+	CServerListStreamParser m_Parser;
+	bool m_Success = false;
+
+protected:
+	bool OnResponseData(const unsigned char *pData, size_t DataSize) override
+	{
+		return m_Parser.Feed((const char *)pData, DataSize);
+	}
+
+	void OnCompletion(EHttpState State) override
+	{
+		if(State == EHttpState::DONE)
+		{
+			m_Success = m_Parser.Finish();
+		}
+		if(m_Parser.Failed())
+		{
+			log_error("serverbrowser_http", "invalid serverlist: %s", m_Parser.Error());
+		}
+	}
+
+public:
+	CServerListRequest(const char *pUrl) :
+		CHttpRequest(pUrl)
+	{
+		StreamResponse();
+	}
+
+	// Only valid after the request is done.
+	bool Success() const { return State() == EHttpState::DONE && m_Success; }
+	std::vector<CServerInfo> &Servers() { return m_Parser.Servers(); }
+	CServerInfoArena &Arena() { return m_Parser.Arena(); }
+};
+
 static int SanitizeAge(std::optional<int64_t> Age)
 {
 	// A year is of course pi*10**7 seconds.
@@ -46,13 +84,11 @@ static int ClassifyAge(int AgeSeconds)
 class CChooseMaster
 {
 public:
-	typedef bool (*VALIDATOR)(json_value *pJson);
-
 	enum
 	{
 		MAX_URLS = 16,
 	};
-	CChooseMaster(IEngine *pEngine, IHttp *pHttp, VALIDATOR pfnValidator, const char **ppUrls, int NumUrls, int PreviousBestIndex);
+	CChooseMaster(IEngine *pEngine, IHttp *pHttp, const char **ppUrls, int NumUrls, int PreviousBestIndex);
 	virtual ~CChooseMaster();
 
 	bool GetBestUrl(const char **pBestUrl) const;
@@ -68,7 +104,6 @@ private:
 	public:
 		std::atomic_int m_BestIndex{-1};
 		// Constant after construction.
-		VALIDATOR m_pfnValidator;
 		int m_NumUrls;
 		char m_aaUrls[MAX_URLS][256];
 	};
@@ -98,7 +133,7 @@ private:
 	std::shared_ptr<CJob> m_pJob;
 };
 
-CChooseMaster::CChooseMaster(IEngine *pEngine, IHttp *pHttp, VALIDATOR pfnValidator, const char **ppUrls, int NumUrls, int PreviousBestIndex) :
+CChooseMaster::CChooseMaster(IEngine *pEngine, IHttp *pHttp, const char **ppUrls, int NumUrls, int PreviousBestIndex) :
 	m_pEngine(pEngine),
 	m_pHttp(pHttp),
 	m_PreviousBestIndex(PreviousBestIndex)
@@ -108,7 +143,6 @@ CChooseMaster::CChooseMaster(IEngine *pEngine, IHttp *pHttp, VALIDATOR pfnValida
 	dbg_assert(PreviousBestIndex >= -1, "previous best index negative and not -1");
 	dbg_assert(PreviousBestIndex < NumUrls, "previous best index too high");
 	m_pData = std::make_shared<CData>();
-	m_pData->m_pfnValidator = pfnValidator;
 	m_pData->m_NumUrls = NumUrls;
 	for(int i = 0; i < m_pData->m_NumUrls; i++)
 	{
@@ -234,7 +268,7 @@ void CChooseMaster::CJob::Run()
 		}
 
 		auto StartTime = time_get_nanoseconds();
-		std::shared_ptr<CHttpRequest> pGet = HttpGet(pUrl);
+		std::shared_ptr<CServerListRequest> pGet = std::make_shared<CServerListRequest>(pUrl);
 		pGet->Timeout(Timeout);
 		pGet->LogProgress(HTTPLOG::FAILURE);
 		{
@@ -251,19 +285,7 @@ void CChooseMaster::CJob::Run()
 			log_debug("serverbrowser_http", "master chooser aborted");
 			return;
 		}
-		if(pGet->State() != EHttpState::DONE)
-		{
-			continue;
-		}
-		json_value *pJson = pGet->ResultJson();
-		if(!pJson)
-		{
-			continue;
-		}
-
-		bool ParseFailure = m_pData->m_pfnValidator(pJson);
-		json_value_free(pJson);
-		if(ParseFailure)
+		if(!pGet->Success())
 		{
 			continue;
 		}
@@ -329,21 +351,19 @@ private:
 		STATE_NO_MASTER,
 	};
 
-	static bool Validate(json_value *pJson);
-	static bool Parse(json_value *pJson, std::vector<CServerInfo> *pvServers);
-
 	IHttp *m_pHttp;
 
 	int m_State = STATE_DONE;
-	std::shared_ptr<CHttpRequest> m_pGetServers;
+	std::shared_ptr<CServerListRequest> m_pGetServers;
 	std::unique_ptr<CChooseMaster> m_pChooseMaster;
 
 	std::vector<CServerInfo> m_vServers;
+	CServerInfoArena m_Arena;
 };
 
 CServerBrowserHttp::CServerBrowserHttp(IEngine *pEngine, IHttp *pHttp, const char **ppUrls, int NumUrls, int PreviousBestIndex) :
 	m_pHttp(pHttp),
-	m_pChooseMaster(new CChooseMaster(pEngine, pHttp, Validate, ppUrls, NumUrls, PreviousBestIndex))
+	m_pChooseMaster(new CChooseMaster(pEngine, pHttp, ppUrls, NumUrls, PreviousBestIndex))
 {
 	m_pChooseMaster->Refresh();
 }
@@ -370,7 +390,7 @@ void CServerBrowserHttp::Update()
 			}
 			return;
 		}
-		m_pGetServers = HttpGet(pBestUrl);
+		m_pGetServers = std::make_shared<CServerListRequest>(pBestUrl);
 		// 10 seconds connection timeout, lower than 8KB/s for 10 seconds to fail.
 		m_pGetServers->Timeout(CTimeout{10000, 0, 8000, 10});
 		m_pHttp->Run(m_pGetServers);
@@ -383,15 +403,10 @@ void CServerBrowserHttp::Update()
 			return;
 		}
 		m_State = STATE_DONE;
-		std::shared_ptr<CHttpRequest> pGetServers = nullptr;
+		std::shared_ptr<CServerListRequest> pGetServers = nullptr;
 		std::swap(m_pGetServers, pGetServers);
 
-		bool Success = true;
-		json_value *pJson = pGetServers->State() == EHttpState::DONE ? pGetServers->ResultJson() : nullptr;
-		Success = Success && pJson;
-		Success = Success && !Parse(pJson, &m_vServers);
-		json_value_free(pJson);
-		if(!Success)
+		if(!pGetServers->Success())
 		{
 			log_error("serverbrowser_http", "failed getting serverlist, trying to find best URL");
 			m_pChooseMaster->Reset();
@@ -399,6 +414,9 @@ void CServerBrowserHttp::Update()
 		}
 		else
 		{
+			m_vServers = std::move(pGetServers->Servers());
+			m_Arena = std::move(pGetServers->Arena());
+
 			// Try to find new master if the current one returns
 			// results that are 5 minutes old.
 			int Age = SanitizeAge(pGetServers->ResultAgeSeconds());
@@ -429,12 +447,82 @@ bool ServerbrowserParseUrl(NETADDR *pOut, const char *pUrl)
 		return true;
 	return false;
 }
-bool CServerBrowserHttp::Validate(json_value *pJson)
+// Returns true if the server list is invalid. Servers with invalid info are
+// skipped instead.
+static bool ParseServer(const json_value &Server, std::vector<CServerInfo> *pvServers, CServerInfoArena *pArena)
 {
-	std::vector<CServerInfo> vServers;
-	return Parse(pJson, &vServers);
+	const json_value &Addresses = Server["addresses"];
+	const json_value &Info = Server["info"];
+	const json_value &Location = Server["location"];
+	int ParsedLocation = CServerInfo::LOC_UNKNOWN;
+	CServerInfo2 ParsedInfo;
+	if(Addresses.type != json_array || (Location.type != json_string && Location.type != json_none))
+	{
+		return true;
+	}
+	if(Location.type == json_string)
+	{
+		if(CServerInfo::ParseLocation(&ParsedLocation, Location))
+		{
+			return true;
+		}
+	}
+	if(CServerInfo2::FromJson(&ParsedInfo, &Info))
+	{
+		// Only skip the current server on parsing
+		// failure; the server info is "user input" by
+		// the game server and can be set to arbitrary
+		// values.
+		return false;
+	}
+	CServerInfo SetInfo;
+	ParsedInfo.ToServerInfo(&SetInfo, pArena);
+	SetInfo.m_Location = ParsedLocation;
+	SetInfo.m_NumAddresses = 0;
+	bool GotVersion6 = false;
+	for(unsigned int a = 0; a < Addresses.u.array.length; a++)
+	{
+		const json_value &Address = Addresses[a];
+		if(Address.type != json_string)
+		{
+			return true;
+		}
+		if(str_startswith(Addresses[a], "tw-0.6+udp://"))
+		{
+			GotVersion6 = true;
+			break;
+		}
+	}
+	for(unsigned int a = 0; a < Addresses.u.array.length; a++)
+	{
+		const json_value &Address = Addresses[a];
+		if(Address.type != json_string)
+		{
+			return true;
+		}
+		if(GotVersion6 && str_startswith(Addresses[a], "tw-0.7+udp://"))
+		{
+			continue;
+		}
+		NETADDR ParsedAddr;
+		if(ServerbrowserParseUrl(&ParsedAddr, Addresses[a]))
+		{
+			// Skip unknown addresses.
+			continue;
+		}
+		if(SetInfo.m_NumAddresses < (int)std::size(SetInfo.m_aAddresses))
+		{
+			SetInfo.m_aAddresses[SetInfo.m_NumAddresses] = ParsedAddr;
+			SetInfo.m_NumAddresses += 1;
+		}
+	}
+	if(SetInfo.m_NumAddresses > 0)
+	{
+		pvServers->push_back(SetInfo);
+	}
+	return false;
 }
-bool CServerBrowserHttp::Parse(json_value *pJson, std::vector<CServerInfo> *pvServers)
+bool ServerbrowserParseServerList(const json_value *pJson, std::vector<CServerInfo> *pvServers, CServerInfoArena *pArena)
 {
 	std::vector<CServerInfo> vServers;
 
@@ -446,78 +534,146 @@ bool CServerBrowserHttp::Parse(json_value *pJson, std::vector<CServerInfo> *pvSe
 	}
 	for(unsigned int i = 0; i < Servers.u.array.length; i++)
 	{
-		const json_value &Server = Servers[i];
-		const json_value &Addresses = Server["addresses"];
-		const json_value &Info = Server["info"];
-		const json_value &Location = Server["location"];
-		int ParsedLocation = CServerInfo::LOC_UNKNOWN;
-		CServerInfo2 ParsedInfo;
-		if(Addresses.type != json_array || (Location.type != json_string && Location.type != json_none))
+		if(ParseServer(Servers[i], &vServers, pArena))
 		{
 			return true;
 		}
-		if(Location.type == json_string)
-		{
-			if(CServerInfo::ParseLocation(&ParsedLocation, Location))
-			{
-				return true;
-			}
-		}
-		if(CServerInfo2::FromJson(&ParsedInfo, &Info))
+	}
+	*pvServers = vServers;
+	return false;
+}
+
+CServerListStreamParser::CServerListStreamParser() :
+	m_Parser(this)
+{
+}
+
+bool CServerListStreamParser::Fail(const char *pReason)
+{
+	str_copy(m_aError, pReason);
+	return false;
+}
+
+bool CServerListStreamParser::Feed(const char *pData, size_t DataSize)
+{
+	m_pChunk = pData;
+	m_ChunkOffset = m_Parser.Offset();
+	const bool Result = m_Parser.Feed(pData, DataSize);
+	if(Result && m_Capturing)
+	{
+		// Keep the part of the unfinished server entry that is in this chunk.
+		const uint64_t Start = std::max(m_CaptureStart, m_ChunkOffset);
+		m_vRaw.insert(m_vRaw.end(), pData + (Start - m_ChunkOffset), pData + DataSize);
+		m_PeakBufferSize = std::max(m_PeakBufferSize, m_vRaw.size());
+	}
+	m_pChunk = nullptr;
+	return Result;
+}
+
+bool CServerListStreamParser::Finish()
+{
+	if(!m_Parser.Finish())
+	{
+		return false;
+	}
+	if(!m_GotServers)
+	{
+		return Fail("no servers array");
+	}
+	return true;
+}
+
+bool CServerListStreamParser::OnJsonEvent(EJsonEvent Event, const char *pValue, size_t ValueLength, uint64_t Offset)
+{
+	const bool ServersKey = m_ServersKey;
+	m_ServersKey = false;
+	switch(Event)
+	{
+	case EJsonEvent::BEGIN_OBJECT:
+	case EJsonEvent::BEGIN_ARRAY:
+		if(m_Depth == 0 && Event != EJsonEvent::BEGIN_OBJECT)
 		{
-			// Only skip the current server on parsing
-			// failure; the server info is "user input" by
-			// the game server and can be set to arbitrary
-			// values.
-			continue;
+			return Fail("serverlist is not an object");
 		}
-		CServerInfo SetInfo = ParsedInfo;
-		SetInfo.m_Location = ParsedLocation;
-		SetInfo.m_NumAddresses = 0;
-		bool GotVersion6 = false;
-		for(unsigned int a = 0; a < Addresses.u.array.length; a++)
+		if(ServersKey)
 		{
-			const json_value &Address = Addresses[a];
-			if(Address.type != json_string)
+			if(Event != EJsonEvent::BEGIN_ARRAY)
 			{
-				return true;
+				return Fail("servers is not an array");
 			}
-			if(str_startswith(Addresses[a], "tw-0.6+udp://"))
+			m_InServers = true;
+		}
+		else if(m_InServers && m_Depth == 2)
+		{
+			if(Event != EJsonEvent::BEGIN_OBJECT)
 			{
-				GotVersion6 = true;
-				break;
+				return Fail("server is not an object");
 			}
+			m_Capturing = true;
+			m_CaptureStart = Offset;
 		}
-		for(unsigned int a = 0; a < Addresses.u.array.length; a++)
+		m_Depth++;
+		return true;
+
+	case EJsonEvent::END_OBJECT:
+	case EJsonEvent::END_ARRAY:
+		m_Depth--;
+		if(m_InServers && m_Depth == 2)
 		{
-			const json_value &Address = Addresses[a];
-			if(Address.type != json_string)
+			// Parse the server entry on its own, directly from the chunk
+			// if it is completely contained in it.
+			const char *pServer;
+			if(m_CaptureStart >= m_ChunkOffset)
 			{
-				return true;
+				pServer = m_pChunk + (m_CaptureStart - m_ChunkOffset);
 			}
-			if(GotVersion6 && str_startswith(Addresses[a], "tw-0.7+udp://"))
+			else
 			{
-				continue;
+				m_vRaw.insert(m_vRaw.end(), m_pChunk, m_pChunk + (Offset + 1 - m_ChunkOffset));
+				m_PeakBufferSize = std::max(m_PeakBufferSize, m_vRaw.size());
+				pServer = m_vRaw.data();
 			}
-			NETADDR ParsedAddr;
-			if(ServerbrowserParseUrl(&ParsedAddr, Addresses[a]))
+			json_value *pJson = json_parse(pServer, Offset + 1 - m_CaptureStart);
+			m_Capturing = false;
+			m_vRaw.clear();
+			if(!pJson)
 			{
-				// Skip unknown addresses.
-				continue;
+				return Fail("invalid server");
 			}
-			if(SetInfo.m_NumAddresses < (int)std::size(SetInfo.m_aAddresses))
+			const bool Failure = ParseServer(*pJson, &m_vServers, &m_Arena);
+			json_value_free(pJson);
+			if(Failure)
 			{
-				SetInfo.m_aAddresses[SetInfo.m_NumAddresses] = ParsedAddr;
-				SetInfo.m_NumAddresses += 1;
+				return Fail("invalid server");
 			}
 		}
-		if(SetInfo.m_NumAddresses > 0)
+		else if(m_InServers && m_Depth == 1)
+		{
+			m_InServers = false;
+			m_GotServers = true;
+		}
+		return true;
+
+	case EJsonEvent::KEY:
+		// Like `json_value::operator[]`, only the first key counts.
+		if(m_Depth == 1 && !m_SeenServersKey && str_comp(pValue, "servers") == 0)
+		{
+			m_SeenServersKey = true;
+			m_ServersKey = true;
+		}
+		return true;
+
+	default:
+		if(ServersKey)
+		{
+			return Fail("servers is not an array");
+		}
+		if(m_InServers && m_Depth == 2)
 		{
-			vServers.push_back(SetInfo);
+			return Fail("server is not an object");
 		}
+		return true;
 	}
-	*pvServers = vServers;
-	return false;
 }
 
 static const char *DEFAULT_SERVERLIST_URLS[] = {
@@ -2,7 +2,13 @@
 #define ENGINE_CLIENT_SERVERBROWSER_HTTP_H
 #include <base/types.h>
 
-class CServerInfo;
+#include <engine/serverbrowser.h>
+#include <engine/shared/jsonstream.h>
+#include <engine/shared/serverinfo_arena.h>
+
+#include <vector>
+
+typedef struct _json_value json_value;
 class IEngine;
 class IStorage;
 class IHttp;
@@ -23,5 +29,57 @@ public:
 	virtual const CServerInfo &Server(int Index) const = 0;
 };
 
+// Parses the server list served by the master servers while it is being
+// received. Every entry of "servers" is converted as soon as it is complete,
+// so only the entry that is currently read is kept besides the results.
+class CServerListStreamParser : public IJsonStreamHandler
+{
+public:
+	CServerListStreamParser();
+
+	// Returns false if the server list is invalid.
+	bool Feed(const char *pData, size_t DataSize);
+	bool Finish();
+
+	bool Failed() const { return m_aError[0] != '\0' || m_Parser.Failed(); }
+	const char *Error() const { return m_aError[0] != '\0' ? m_aError : m_Parser.Error(); }
+	std::vector<CServerInfo> &Servers() { return m_vServers; }
+	// The clients and strings of the servers.
+	CServerInfoArena &Arena() { return m_Arena; }
+	// The largest number of bytes that had to be kept between chunks.
+	size_t PeakBufferSize() const { return m_PeakBufferSize; }
+
+	bool OnJsonEvent(EJsonEvent Event, const char *pValue, size_t ValueLength, uint64_t Offset) override;
+
+private:
+	bool Fail(const char *pReason);
+
+	CJsonStreamParser m_Parser;
+	int m_Depth = 0;
+	bool m_ServersKey = false;
+	bool m_SeenServersKey = false;
+	bool m_InServers = false;
+	bool m_GotServers = false;
+
+	// the chunk that is currently fed, starting at `m_ChunkOffset` of the
+	// whole input
+	const char *m_pChunk = nullptr;
+	uint64_t m_ChunkOffset = 0;
+	// the server entry that is currently read, only copied if it spans
+	// multiple chunks
+	bool m_Capturing = false;
+	uint64_t m_CaptureStart = 0;
+	std::vector<char> m_vRaw;
+	size_t m_PeakBufferSize = 0;
+
+	std::vector<CServerInfo> m_vServers;
+	CServerInfoArena m_Arena;
+	char m_aError[128] = "";
+};
+
+// Parses an already complete server list, the clients and strings of the
+// servers are stored in the arena. Returns true on failure.
+bool ServerbrowserParseServerList(const json_value *pJson, std::vector<CServerInfo> *pvServers, CServerInfoArena *pArena);
+
 IServerBrowserHttp *CreateServerBrowserHttp(IEngine *pEngine, IStorage *pStorage, IHttp *pHttp, const char *pPreviousBestUrl);
 #endif // ENGINE_CLIENT_SERVERBROWSER_HTTP_H
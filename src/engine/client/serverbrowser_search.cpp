@@ -0,0 +1,108 @@
+#include "serverbrowser_search.h"
+
+#include <base/system.h>
+
+#include <engine/serverbrowser.h>
+
+#include <algorithm>
+
+// the code points are decoded and lowercased the same way as in
+// str_utf8_find_nocase, so every match of it contains all trigrams
+// of the needle
+void CServerBrowserSearchIndex::Trigrams(const char *pStr, std::vector<uint64_t> &vTrigrams)
+{
+	uint64_t Trigram = 0;
+	int NumCodepoints = 0;
+	while(*pStr)
+	{
+		const int Code = str_utf8_tolower(str_utf8_decode(&pStr));
+		Trigram = ((Trigram << 21) | (Code & 0x1fffff)) & ((uint64_t(1) << 63) - 1);
+		if(++NumCodepoints >= 3)
+			vTrigrams.push_back(Trigram);
+	}
+}
+
+void CServerBrowserSearchIndex::Clear()
+{
+	m_vEntries.clear();
+	m_Postings.clear();
+}
+
+void CServerBrowserSearchIndex::Update(int Id, const CServerInfo &Info)
+{
+	if(Id >= (int)m_vEntries.size())
+		m_vEntries.resize(Id + 1);
+
+	std::vector<uint64_t> vTrigrams;
+	Trigrams(Info.m_aName, vTrigrams);
+	Trigrams(Info.m_pMap, vTrigrams);
+	for(int p = 0; p < Info.m_NumReceivedClients; p++)
+	{
+		Trigrams(Info.m_pClients[p].m_pName, vTrigrams);
+		Trigrams(Info.m_pClients[p].m_pClan, vTrigrams);
+	}
+	std::sort(vTrigrams.begin(), vTrigrams.end());
+	vTrigrams.erase(std::unique(vTrigrams.begin(), vTrigrams.end()), vTrigrams.end());
+
+	// walk both sorted lists to only touch the postings that changed
+	std::vector<uint64_t> &vOld = m_vEntries[Id];
+	auto OldIt = vOld.begin();
+	auto NewIt = vTrigrams.begin();
+	while(OldIt != vOld.end() || NewIt != vTrigrams.end())
+	{
+		if(NewIt == vTrigrams.end() || (OldIt != vOld.end() && *OldIt < *NewIt))
+		{
+			auto PostingIt = m_Postings.find(*OldIt);
+			std::vector<int> &vIds = PostingIt->second;
+			auto IdIt = std::find(vIds.begin(), vIds.end(), Id);
+			*IdIt = vIds.back();
+			vIds.pop_back();
+			if(vIds.empty())
+				m_Postings.erase(PostingIt);
+			++OldIt;
+		}
+		else if(OldIt == vOld.end() || *NewIt < *OldIt)
+		{
+			m_Postings[*NewIt].push_back(Id);
+			++NewIt;
+		}
+		else
+		{
+			++OldIt;
+			++NewIt;
+		}
+	}
+	vOld = std::move(vTrigrams);
+}
+
+bool CServerBrowserSearchIndex::Candidates(const char *pNeedle, std::vector<int> &vCandidates) const
+{
+	vCandidates.clear();
+
+	std::vector<uint64_t> vTrigrams;
+	Trigrams(pNeedle, vTrigrams);
+	if(vTrigrams.empty())
+		return false;
+
+	// start with the rarest trigram and check the others per entry
+	const std::vector<int> *pRarest = nullptr;
+	for(uint64_t Trigram : vTrigrams)
+	{
+		auto PostingIt = m_Postings.find(Trigram);
+		if(PostingIt == m_Postings.end())
+			return true;
+		if(!pRarest || PostingIt->second.size() < pRarest->size())
+			pRarest = &PostingIt->second;
+	}
+
+	for(int Id : *pRarest)
+	{
+		const std::vector<uint64_t> &vEntry = m_vEntries[Id];
+		const bool Found = std::all_of(vTrigrams.begin(), vTrigrams.end(), [&](uint64_t Trigram) {
+			return std::binary_search(vEntry.begin(), vEntry.end(), Trigram);
+		});
+		if(Found)
+			vCandidates.push_back(Id);
+	}
+	return true;
+}
@@ -0,0 +1,38 @@
+#ifndef ENGINE_CLIENT_SERVERBROWSER_SEARCH_H
+#define ENGINE_CLIENT_SERVERBROWSER_SEARCH_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class CServerInfo;
+
+// Trigram index over the lowercased server names, map names and player
+// names and clans of the server list. It is used to narrow down the servers
+// that need to be checked against the quick search string.
+class CServerBrowserSearchIndex
+{
+public:
+	void Clear();
+	// (re)indexes the server with the given index, only the trigrams that
+	// changed since the last update are touched
+	void Update(int Id, const CServerInfo &Info);
+
+	// Fills vCandidates with the ids of all servers that might contain the
+	// needle as case insensitive substring in one of the indexed fields.
+	// Returns false if the needle is too short to be looked up, in that case
+	// every server is a candidate.
+	bool Candidates(const char *pNeedle, std::vector<int> &vCandidates) const;
+
+	int NumEntries() const { return m_vEntries.size(); }
+	int NumTrigrams() const { return m_Postings.size(); }
+
+	static void Trigrams(const char *pStr, std::vector<uint64_t> &vTrigrams);
+
+private:
+	// sorted and without duplicates
+	std::vector<std::vector<uint64_t>> m_vEntries;
+	std::unordered_map<uint64_t, std::vector<int>> m_Postings;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#include "serverbrowser_sortkeys.h"
+
+#include <base/system.h>
+
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+void CServerBrowserSortKeys::RankStrings(const std::vector<const char *> &vpStrings, std::vector<int> &vRanks)
+{
+	// only the distinct strings are sorted
+	std::unordered_map<std::string_view, int> Distinct;
+	std::vector<const char *> vpDistinct;
+	vRanks.resize(vpStrings.size());
+	for(size_t i = 0; i < vpStrings.size(); i++)
+	{
+		auto [It, Inserted] = Distinct.emplace(vpStrings[i], vpDistinct.size());
+		if(Inserted)
+			vpDistinct.push_back(vpStrings[i]);
+		vRanks[i] = It->second;
+	}
+
+	std::vector<int> vOrder(vpDistinct.size());
+	for(size_t i = 0; i < vOrder.size(); i++)
+		vOrder[i] = i;
+	std::sort(vOrder.begin(), vOrder.end(), [&](int a, int b) { return str_comp(vpDistinct[a], vpDistinct[b]) < 0; });
+
+	std::vector<int> vDistinctRanks(vpDistinct.size());
+	for(size_t i = 0; i < vOrder.size(); i++)
+		vDistinctRanks[vOrder[i]] = i;
+	for(int &Rank : vRanks)
+		Rank = vDistinctRanks[Rank];
+}
+
+void CServerBrowserSortKeys::Update(const IServerBrowser::CServerEntry *const *ppServers, int NumServers, int Sort)
+{
+	m_vGotInfo.resize(NumServers);
+	m_vLatency.resize(NumServers);
+	m_vNumClients.resize(NumServers);
+	m_vNumFilteredPlayers.resize(NumServers);
+	m_vFriendNum.resize(NumServers);
+	for(int i = 0; i < NumServers; i++)
+	{
+		const CServerInfo &Info = ppServers[i]->m_Info;
+		m_vGotInfo[i] = ppServers[i]->m_GotInfo;
+		m_vLatency[i] = Info.m_Latency;
+		m_vNumClients[i] = Info.m_NumClients;
+		m_vNumFilteredPlayers[i] = Info.m_NumFilteredPlayers;
+		m_vFriendNum[i] = Info.m_FriendNum;
+	}
+
+	if(Sort == IServerBrowser::SORT_NAME)
+	{
+		m_vpName.resize(NumServers);
+		for(int i = 0; i < NumServers; i++)
+			m_vpName[i] = ppServers[i]->m_Info.m_aName;
+	}
+	else if(Sort == IServerBrowser::SORT_MAP)
+	{
+		m_vpMap.resize(NumServers);
+		for(int i = 0; i < NumServers; i++)
+			m_vpMap[i] = ppServers[i]->m_Info.m_pMap;
+	}
+	else if(Sort == IServerBrowser::SORT_GAMETYPE)
+	{
+		std::vector<const char *> vpGameTypes(NumServers);
+		for(int i = 0; i < NumServers; i++)
+			vpGameTypes[i] = ppServers[i]->m_Info.m_pGameType;
+		RankStrings(vpGameTypes, m_vGameTypeRank);
+	}
+}
@@ -0,0 +1,34 @@
+#ifndef ENGINE_CLIENT_SERVERBROWSER_SORTKEYS_H
+#define ENGINE_CLIENT_SERVERBROWSER_SORTKEYS_H
+
+#include <engine/serverbrowser.h>
+
+#include <vector>
+
+// The values that the server list is sorted by, copied into contiguous
+// arrays indexed by the server index so that sorting doesn't have to jump
+// into the large server entries. Game types are replaced by their rank
+// among the distinct game types. Names and maps are mostly distinct, for
+// them ranking costs more than comparing the strings while sorting.
+class CServerBrowserSortKeys
+{
+public:
+	// the integer keys are always updated, the string keys only for the
+	// sort criterion that is passed
+	void Update(const IServerBrowser::CServerEntry *const *ppServers, int NumServers, int Sort);
+
+	// assigns every string its position in the sorted list of distinct
+	// strings, equal strings get the same rank
+	static void RankStrings(const std::vector<const char *> &vpStrings, std::vector<int> &vRanks);
+
+	std::vector<int> m_vGotInfo;
+	std::vector<int> m_vLatency;
+	std::vector<int> m_vNumClients;
+	std::vector<int> m_vNumFilteredPlayers;
+	std::vector<int> m_vFriendNum;
+	std::vector<const char *> m_vpName;
+	std::vector<const char *> m_vpMap;
+	std::vector<int> m_vGameTypeRank;
+};
+
+#endif
@@ -1,11 +1,15 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/hash.h>
 #include <base/log.h>
 #include <base/math.h>
 #include <base/system.h>
 
 #include <engine/console.h>
+#include <engine/engine.h>
 #include <engine/graphics.h>
+#include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
 #include <engine/shared/json.h>
 #include <engine/storage.h>
 #include <engine/textrender.h>
@@ -17,8 +21,11 @@
 #include <chrono>
 #include <cstddef>
 #include <limits>
+#include <map>
+#include <memory>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 using namespace std::chrono_literals;
@@ -271,6 +278,367 @@ public:
 	}
 };
 
+/**
+ * Glyph bitmaps and metrics produced by FreeType, before they are packed into the atlas.
+ * Rasterization does not depend on the atlas, so it can happen on a worker thread.
+ */
+struct SRasterizedGlyph
+{
+	FT_UInt m_GlyphIndex;
+	unsigned m_Width;
+	unsigned m_Height;
+	unsigned m_CharWidth;
+	unsigned m_CharHeight;
+	int m_OffsetX;
+	int m_OffsetY;
+	int m_AdvanceX;
+	std::vector<uint8_t> m_vFillData;
+	std::vector<uint8_t> m_vOutlineData;
+};
+
+static int AdjustOutlineThicknessToFontSize(int OutlineThickness, int FontSize)
+{
+	if(FontSize > 48)
+		OutlineThickness *= 4;
+	else if(FontSize >= 18)
+		OutlineThickness *= 2;
+	return OutlineThickness;
+}
+
+static void GrowGlyph(const unsigned char *pIn, unsigned char *pOut, int w, int h, int OutlineCount)
+{
+	for(int y = 0; y < h; y++)
+	{
+		for(int x = 0; x < w; x++)
+		{
+			int c = pIn[y * w + x];
+
+			for(int sy = -OutlineCount; sy <= OutlineCount; sy++)
+			{
+				for(int sx = -OutlineCount; sx <= OutlineCount; sx++)
+				{
+					int GetX = x + sx;
+					int GetY = y + sy;
+					if(GetX >= 0 && GetY >= 0 && GetX < w && GetY < h)
+					{
+						int Index = GetY * w + GetX;
+						float Mask = 1.f - clamp(length(vec2(sx, sy)) - OutlineCount, 0.f, 1.f);
+						c = maximum(c, int(pIn[Index] * Mask));
+					}
+				}
+			}
+
+			pOut[y * w + x] = c;
+		}
+	}
+}
+
+static bool RasterizeGlyph(FT_Face Face, FT_UInt GlyphIndex, int Chr, int FontSize, SRasterizedGlyph &Result)
+{
+	FT_Set_Pixel_Sizes(Face, 0, FontSize);
+
+	if(FT_Load_Glyph(Face, GlyphIndex, FT_LOAD_RENDER | FT_LOAD_NO_BITMAP))
+	{
+		log_debug("textrender", "Error loading glyph. Chr=%d GlyphIndex=%u", Chr, GlyphIndex);
+		return false;
+	}
+
+	const FT_Bitmap *pBitmap = &Face->glyph->bitmap;
+	if(pBitmap->pixel_mode != FT_PIXEL_MODE_GRAY)
+	{
+		log_debug("textrender", "Error loading glyph, unsupported pixel mode. Chr=%d GlyphIndex=%u PixelMode=%d", Chr, GlyphIndex, pBitmap->pixel_mode);
+		return false;
+	}
+
+	const unsigned RealWidth = pBitmap->width;
+	const unsigned RealHeight = pBitmap->rows;
+
+	// adjust spacing
+	int OutlineThickness = 0;
+	int x = 0;
+	int y = 0;
+	if(RealWidth > 0)
+	{
+		OutlineThickness = AdjustOutlineThicknessToFontSize(1, FontSize);
+		x += (OutlineThickness + 1);
+		y += (OutlineThickness + 1);
+	}
+
+	const unsigned Width = RealWidth + x * 2;
+	const unsigned Height = RealHeight + y * 2;
+
+	Result.m_GlyphIndex = GlyphIndex;
+	Result.m_Width = Width;
+	Result.m_Height = Height;
+	Result.m_CharWidth = RealWidth;
+	Result.m_CharHeight = RealHeight;
+	Result.m_OffsetX = Face->glyph->metrics.horiBearingX >> 6;
+	Result.m_OffsetY = -((Face->glyph->metrics.height >> 6) - (Face->glyph->metrics.horiBearingY >> 6));
+	Result.m_AdvanceX = Face->glyph->advance.x >> 6;
+	Result.m_vFillData.clear();
+	Result.m_vOutlineData.clear();
+
+	if(Width > 0 && Height > 0)
+	{
+		const size_t GlyphDataSize = (size_t)Width * Height;
+		Result.m_vFillData.resize(GlyphDataSize, 0);
+		Result.m_vOutlineData.resize(GlyphDataSize, 0);
+		for(unsigned py = 0; py < pBitmap->rows; ++py)
+		{
+			mem_copy(&Result.m_vFillData[(py + y) * Width + x], &pBitmap->buffer[py * pBitmap->width], pBitmap->width);
+		}
+		GrowGlyph(Result.m_vFillData.data(), Result.m_vOutlineData.data(), Width, Height, OutlineThickness);
+	}
+	return true;
+}
+
+/**
+ * Identifies the font file data a face was loaded from, so the face can be
+ * loaded again independently of the main thread and cached glyphs can be
+ * associated with the exact font file.
+ */
+struct SFontFaceSource
+{
+	std::shared_ptr<void> m_pFontData;
+	FT_Long m_FontDataSize;
+	FT_Long m_FaceIndex;
+	SHA256_DIGEST m_FontHash;
+};
+
+/**
+ * Persistent cache of rasterized glyphs for one font face and font size.
+ *
+ * The file consists of a magic followed by one record per glyph: the glyph
+ * index and metrics as big-endian integers, followed by the fill and the
+ * outline bitmap.
+ */
+class CGlyphCacheFile
+{
+	static constexpr const char MAGIC[8] = {'D', 'D', 'N', 'G', 'L', 'Y', 'C', '1'};
+	static constexpr size_t NUM_RECORD_FIELDS = 8;
+
+public:
+	static void GetPath(const SFontFaceSource &Source, int FontSize, char *pPath, size_t PathSize)
+	{
+		char aHash[SHA256_MAXSTRSIZE];
+		sha256_str(Source.m_FontHash, aHash, sizeof(aHash));
+		str_format(pPath, PathSize, "glyphcache/%s_%ld_%d.glyphs", aHash, (long)Source.m_FaceIndex, FontSize);
+	}
+
+	static void Load(IStorage *pStorage, const char *pPath, std::unordered_map<FT_UInt, SRasterizedGlyph> &Glyphs)
+	{
+		void *pFileData;
+		unsigned FileSize;
+		if(!pStorage->ReadFile(pPath, IStorage::TYPE_SAVE, &pFileData, &FileSize))
+			return;
+
+		const unsigned char *pData = static_cast<const unsigned char *>(pFileData);
+		const unsigned char *pEnd = pData + FileSize;
+		if(FileSize < sizeof(MAGIC) || mem_comp(pData, MAGIC, sizeof(MAGIC)) != 0)
+		{
+			log_warn("textrender", "Ignoring invalid glyph cache file '%s'", pPath);
+			free(pFileData);
+			return;
+		}
+		pData += sizeof(MAGIC);
+
+		while(pEnd - pData >= (ptrdiff_t)(NUM_RECORD_FIELDS * sizeof(uint32_t)))
+		{
+			unsigned aFields[NUM_RECORD_FIELDS];
+			for(unsigned &Field : aFields)
+			{
+				Field = bytes_be_to_uint(pData);
+				pData += sizeof(uint32_t);
+			}
+
+			SRasterizedGlyph Glyph;
+			Glyph.m_GlyphIndex = aFields[0];
+			Glyph.m_Width = aFields[1];
+			Glyph.m_Height = aFields[2];
+			Glyph.m_CharWidth = aFields[3];
+			Glyph.m_CharHeight = aFields[4];
+			Glyph.m_OffsetX = (int)aFields[5];
+			Glyph.m_OffsetY = (int)aFields[6];
+			Glyph.m_AdvanceX = (int)aFields[7];
+
+			const size_t GlyphDataSize = (size_t)Glyph.m_Width * Glyph.m_Height;
+			if(Glyph.m_Width > 0xFFFF || Glyph.m_Height > 0xFFFF || (size_t)(pEnd - pData) < GlyphDataSize * 2)
+			{
+				log_warn("textrender", "Glyph cache file '%s' is truncated", pPath);
+				break;
+			}
+			Glyph.m_vFillData.assign(pData, pData + GlyphDataSize);
+			pData += GlyphDataSize;
+			Glyph.m_vOutlineData.assign(pData, pData + GlyphDataSize);
+			pData += GlyphDataSize;
+			Glyphs[Glyph.m_GlyphIndex] = std::move(Glyph);
+		}
+
+		free(pFileData);
+	}
+
+	// the file is written to a temporary file first, so it is never read while it is incomplete
+	static bool Save(IStorage *pStorage, const char *pPath, const std::unordered_map<FT_UInt, SRasterizedGlyph> &Glyphs)
+	{
+		char aTmpPath[IO_MAX_PATH_LENGTH];
+		IStorage::FormatTmpPath(aTmpPath, sizeof(aTmpPath), pPath);
+		IOHANDLE File = pStorage->OpenFile(aTmpPath, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+		if(!File)
+		{
+			log_error("textrender", "Failed to open glyph cache file '%s' for writing", aTmpPath);
+			return false;
+		}
+
+		bool Success = io_write(File, MAGIC, sizeof(MAGIC)) == sizeof(MAGIC);
+		for(const auto &[GlyphIndex, Glyph] : Glyphs)
+		{
+			const unsigned aFields[NUM_RECORD_FIELDS] = {Glyph.m_GlyphIndex, Glyph.m_Width, Glyph.m_Height, Glyph.m_CharWidth, Glyph.m_CharHeight, (unsigned)Glyph.m_OffsetX, (unsigned)Glyph.m_OffsetY, (unsigned)Glyph.m_AdvanceX};
+			unsigned char aHeader[NUM_RECORD_FIELDS * sizeof(uint32_t)];
+			for(size_t i = 0; i < NUM_RECORD_FIELDS; ++i)
+				uint_to_bytes_be(&aHeader[i * sizeof(uint32_t)], aFields[i]);
+			Success &= io_write(File, aHeader, sizeof(aHeader)) == sizeof(aHeader);
+			Success &= io_write(File, Glyph.m_vFillData.data(), Glyph.m_vFillData.size()) == Glyph.m_vFillData.size();
+			Success &= io_write(File, Glyph.m_vOutlineData.data(), Glyph.m_vOutlineData.size()) == Glyph.m_vOutlineData.size();
+		}
+		Success &= io_close(File) == 0;
+
+		if(!Success)
+		{
+			log_error("textrender", "Failed to write glyph cache file '%s'", aTmpPath);
+			pStorage->RemoveFile(aTmpPath, IStorage::TYPE_SAVE);
+			return false;
+		}
+		if(!pStorage->RenameFile(aTmpPath, pPath, IStorage::TYPE_SAVE))
+		{
+			log_error("textrender", "Failed to rename glyph cache file '%s' to '%s'", aTmpPath, pPath);
+			pStorage->RemoveFile(aTmpPath, IStorage::TYPE_SAVE);
+			return false;
+		}
+		return true;
+	}
+};
+
+/**
+ * Rasterizes a set of glyphs on a worker thread, optionally using and
+ * updating the persistent glyph cache. FreeType faces must not be shared
+ * between threads, so the job loads its own faces from the font data.
+ */
+class CGlyphPrewarmJob : public IJob
+{
+public:
+	struct SRequest
+	{
+		FT_Face m_Face; // face of the main thread, only used to identify results
+		SFontFaceSource m_Source;
+		int m_FontSize;
+		std::vector<std::pair<int, FT_UInt>> m_vGlyphs; // character and glyph index
+	};
+
+	struct SResult
+	{
+		FT_Face m_Face;
+		int m_FontSize;
+		int m_Chr;
+		bool m_Success;
+		SRasterizedGlyph m_Glyph;
+	};
+
+private:
+	IStorage *m_pStorage;
+	bool m_UseDiskCache;
+	std::vector<SRequest> m_vRequests;
+	std::vector<SResult> m_vResults;
+	// held while the glyph cache is accessed, so the storage is not used anymore once Abort returned
+	CLock m_StorageLock;
+
+	void RunRequest(FT_Library Library, const SRequest &Request)
+	{
+		FT_Face Face;
+		if(FT_New_Memory_Face(Library, static_cast<const FT_Byte *>(Request.m_Source.m_pFontData.get()), Request.m_Source.m_FontDataSize, Request.m_Source.m_FaceIndex, &Face))
+			return;
+
+		char aCachePath[IO_MAX_PATH_LENGTH];
+		std::unordered_map<FT_UInt, SRasterizedGlyph> CachedGlyphs;
+		bool CacheModified = false;
+		if(m_UseDiskCache)
+		{
+			CGlyphCacheFile::GetPath(Request.m_Source, Request.m_FontSize, aCachePath, sizeof(aCachePath));
+			const CLockScope LockScope(m_StorageLock);
+			if(State() != IJob::STATE_ABORTED)
+				CGlyphCacheFile::Load(m_pStorage, aCachePath, CachedGlyphs);
+		}
+
+		for(const auto &[Chr, GlyphIndex] : Request.m_vGlyphs)
+		{
+			if(State() == IJob::STATE_ABORTED)
+				break;
+
+			SResult Result;
+			Result.m_Face = Request.m_Face;
+			Result.m_FontSize = Request.m_FontSize;
+			Result.m_Chr = Chr;
+
+			const auto CachedGlyph = CachedGlyphs.find(GlyphIndex);
+			if(CachedGlyph != CachedGlyphs.end())
+			{
+				Result.m_Success = true;
+				Result.m_Glyph = CachedGlyph->second;
+			}
+			else
+			{
+				Result.m_Success = RasterizeGlyph(Face, GlyphIndex, Chr, Request.m_FontSize, Result.m_Glyph);
+				if(Result.m_Success && m_UseDiskCache)
+				{
+					CachedGlyphs[GlyphIndex] = Result.m_Glyph;
+					CacheModified = true;
+				}
+			}
+			m_vResults.push_back(std::move(Result));
+		}
+
+		FT_Done_Face(Face);
+
+		if(CacheModified)
+		{
+			const CLockScope LockScope(m_StorageLock);
+			if(State() != IJob::STATE_ABORTED)
+				CGlyphCacheFile::Save(m_pStorage, aCachePath, CachedGlyphs);
+		}
+	}
+
+	void Run() override
+	{
+		FT_Library Library;
+		if(FT_Init_FreeType(&Library))
+			return;
+		for(const SRequest &Request : m_vRequests)
+		{
+			if(State() == IJob::STATE_ABORTED)
+				break;
+			RunRequest(Library, Request);
+		}
+		FT_Done_FreeType(Library);
+	}
+
+public:
+	CGlyphPrewarmJob(IStorage *pStorage, bool UseDiskCache, std::vector<SRequest> &&vRequests) :
+		m_pStorage(pStorage),
+		m_UseDiskCache(UseDiskCache),
+		m_vRequests(std::move(vRequests))
+	{
+		Abortable(true);
+	}
+
+	// waits for the glyph cache file that is being loaded or saved
+	bool Abort() override
+	{
+		const CLockScope LockScope(m_StorageLock);
+		return IJob::Abort();
+	}
+
+	const std::vector<SResult> &Results() const { return m_vResults; }
+};
+
 class CGlyphMap
 {
 public:
@@ -311,6 +679,7 @@ private:
 
 	IGraphics *m_pGraphics;
 	IGraphics *Graphics() { return m_pGraphics; }
+	IStorage *m_pStorage;
 
 	// Atlas textures and data
 	IGraphics::CTextureHandle m_aTextures[NUM_FONT_TEXTURES];
@@ -328,6 +697,8 @@ private:
 	FT_Face m_SelectedFace = nullptr;
 	std::vector<FT_Face> m_vFallbackFaces;
 	std::vector<FT_Face> m_vFtFaces;
+	std::unordered_map<FT_Face, SFontFaceSource> m_FaceSources;
+	std::map<std::pair<FT_Face, int>, std::unordered_map<FT_UInt, SRasterizedGlyph>> m_DiskCachedGlyphs;
 
 	FT_Face GetFaceByName(const char *pFamilyName)
 	{
@@ -445,43 +816,6 @@ private:
 		return GlyphIndex;
 	}
 
-	void Grow(const unsigned char *pIn, unsigned char *pOut, int w, int h, int OutlineCount) const
-	{
-		for(int y = 0; y < h; y++)
-		{
-			for(int x = 0; x < w; x++)
-			{
-				int c = pIn[y * w + x];
-
-				for(int sy = -OutlineCount; sy <= OutlineCount; sy++)
-				{
-					for(int sx = -OutlineCount; sx <= OutlineCount; sx++)
-					{
-						int GetX = x + sx;
-						int GetY = y + sy;
-						if(GetX >= 0 && GetY >= 0 && GetX < w && GetY < h)
-						{
-							int Index = GetY * w + GetX;
-							float Mask = 1.f - clamp(length(vec2(sx, sy)) - OutlineCount, 0.f, 1.f);
-							c = maximum(c, int(pIn[Index] * Mask));
-						}
-					}
-				}
-
-				pOut[y * w + x] = c;
-			}
-		}
-	}
-
-	int AdjustOutlineThicknessToFontSize(int OutlineThickness, int FontSize) const
-	{
-		if(FontSize > 48)
-			OutlineThickness *= 4;
-		else if(FontSize >= 18)
-			OutlineThickness *= 2;
-		return OutlineThickness;
-	}
-
 	void UploadGlyph(int TextureIndex, int PosX, int PosY, size_t Width, size_t Height, uint8_t *pData)
 	{
 		for(size_t y = 0; y < Height; ++y)
@@ -496,39 +830,10 @@ private:
 		return m_TextureAtlas.Add(Width, Height, PosX, PosY);
 	}
 
-	bool RenderGlyph(SGlyph &Glyph)
+	bool PlaceGlyph(SGlyph &Glyph, const SRasterizedGlyph &RasterizedGlyph)
 	{
-		FT_Set_Pixel_Sizes(Glyph.m_Face, 0, Glyph.m_FontSize);
-
-		if(FT_Load_Glyph(Glyph.m_Face, Glyph.m_GlyphIndex, FT_LOAD_RENDER | FT_LOAD_NO_BITMAP))
-		{
-			log_debug("textrender", "Error loading glyph. Chr=%d GlyphIndex=%u", Glyph.m_Chr, Glyph.m_GlyphIndex);
-			return false;
-		}
-
-		const FT_Bitmap *pBitmap = &Glyph.m_Face->glyph->bitmap;
-		if(pBitmap->pixel_mode != FT_PIXEL_MODE_GRAY)
-		{
-			log_debug("textrender", "Error loading glyph, unsupported pixel mode. Chr=%d GlyphIndex=%u PixelMode=%d", Glyph.m_Chr, Glyph.m_GlyphIndex, pBitmap->pixel_mode);
-			return false;
-		}
-
-		const unsigned RealWidth = pBitmap->width;
-		const unsigned RealHeight = pBitmap->rows;
-
-		// adjust spacing
-		int OutlineThickness = 0;
-		int x = 0;
-		int y = 0;
-		if(RealWidth > 0)
-		{
-			OutlineThickness = AdjustOutlineThicknessToFontSize(1, Glyph.m_FontSize);
-			x += (OutlineThickness + 1);
-			y += (OutlineThickness + 1);
-		}
-
-		const unsigned Width = RealWidth + x * 2;
-		const unsigned Height = RealHeight + y * 2;
+		const unsigned Width = RasterizedGlyph.m_Width;
+		const unsigned Height = RasterizedGlyph.m_Height;
 
 		int X = 0;
 		int Y = 0;
@@ -545,18 +850,12 @@ private:
 				}
 			}
 
-			// prepare glyph data
+			// upload the glyph, the texture update takes ownership of the data
 			const size_t GlyphDataSize = (size_t)Width * Height * sizeof(uint8_t);
 			uint8_t *pGlyphDataFill = static_cast<uint8_t *>(malloc(GlyphDataSize));
 			uint8_t *pGlyphDataOutline = static_cast<uint8_t *>(malloc(GlyphDataSize));
-			mem_zero(pGlyphDataFill, GlyphDataSize);
-			for(unsigned py = 0; py < pBitmap->rows; ++py)
-			{
-				mem_copy(&pGlyphDataFill[(py + y) * Width + x], &pBitmap->buffer[py * pBitmap->width], pBitmap->width);
-			}
-			Grow(pGlyphDataFill, pGlyphDataOutline, Width, Height, OutlineThickness);
-
-			// upload the glyph
+			mem_copy(pGlyphDataFill, RasterizedGlyph.m_vFillData.data(), GlyphDataSize);
+			mem_copy(pGlyphDataOutline, RasterizedGlyph.m_vOutlineData.data(), GlyphDataSize);
 			UploadGlyph(FONT_TEXTURE_FILL, X, Y, Width, Height, pGlyphDataFill);
 			UploadGlyph(FONT_TEXTURE_OUTLINE, X, Y, Width, Height, pGlyphDataOutline);
 		}
@@ -565,11 +864,11 @@ private:
 		{
 			Glyph.m_Height = Height;
 			Glyph.m_Width = Width;
-			Glyph.m_CharHeight = RealHeight;
-			Glyph.m_CharWidth = RealWidth;
-			Glyph.m_OffsetX = (Glyph.m_Face->glyph->metrics.horiBearingX >> 6);
-			Glyph.m_OffsetY = -((Glyph.m_Face->glyph->metrics.height >> 6) - (Glyph.m_Face->glyph->metrics.horiBearingY >> 6));
-			Glyph.m_AdvanceX = (Glyph.m_Face->glyph->advance.x >> 6);
+			Glyph.m_CharHeight = RasterizedGlyph.m_CharHeight;
+			Glyph.m_CharWidth = RasterizedGlyph.m_CharWidth;
+			Glyph.m_OffsetX = RasterizedGlyph.m_OffsetX;
+			Glyph.m_OffsetY = RasterizedGlyph.m_OffsetY;
+			Glyph.m_AdvanceX = RasterizedGlyph.m_AdvanceX;
 
 			Glyph.m_aUVs[0] = X;
 			Glyph.m_aUVs[1] = Y;
@@ -581,10 +880,46 @@ private:
 		return true;
 	}
 
+	// Glyphs that are not in the atlas yet are also looked up in the glyph cache
+	// files written by the prewarm job. A file is read once for each face and
+	// size, glyphs rendered on demand are not added to it.
+	bool TakeDiskCachedGlyph(const SGlyph &Glyph, SRasterizedGlyph &RasterizedGlyph)
+	{
+		if(!m_pStorage || !g_Config.m_ClTextGlyphCache)
+			return false;
+		const auto Source = m_FaceSources.find(Glyph.m_Face);
+		if(Source == m_FaceSources.end())
+			return false;
+
+		const auto [CachedGlyphs, Inserted] = m_DiskCachedGlyphs.try_emplace(std::make_pair(Glyph.m_Face, Glyph.m_FontSize));
+		if(Inserted)
+		{
+			char aCachePath[IO_MAX_PATH_LENGTH];
+			CGlyphCacheFile::GetPath(Source->second, Glyph.m_FontSize, aCachePath, sizeof(aCachePath));
+			CGlyphCacheFile::Load(m_pStorage, aCachePath, CachedGlyphs->second);
+		}
+
+		const auto CachedGlyph = CachedGlyphs->second.find(Glyph.m_GlyphIndex);
+		if(CachedGlyph == CachedGlyphs->second.end())
+			return false;
+		RasterizedGlyph = std::move(CachedGlyph->second);
+		CachedGlyphs->second.erase(CachedGlyph);
+		return true;
+	}
+
+	bool RenderGlyph(SGlyph &Glyph)
+	{
+		SRasterizedGlyph RasterizedGlyph;
+		if(!TakeDiskCachedGlyph(Glyph, RasterizedGlyph) && !RasterizeGlyph(Glyph.m_Face, Glyph.m_GlyphIndex, Glyph.m_Chr, Glyph.m_FontSize, RasterizedGlyph))
+			return false;
+		return PlaceGlyph(Glyph, RasterizedGlyph);
+	}
+
 public:
-	CGlyphMap(IGraphics *pGraphics)
+	CGlyphMap(IGraphics *pGraphics, IStorage *pStorage)
 	{
 		m_pGraphics = pGraphics;
+		m_pStorage = pStorage;
 		for(auto &pTextureData : m_apTextureData)
 		{
 			pTextureData = new uint8_t[m_TextureDimension * m_TextureDimension];
@@ -614,9 +949,10 @@ public:
 		return m_IconFace;
 	}
 
-	void AddFace(FT_Face Face)
+	void AddFace(FT_Face Face, const SFontFaceSource &Source)
 	{
 		m_vFtFaces.push_back(Face);
+		m_FaceSources[Face] = Source;
 	}
 
 	bool SetDefaultFaceByName(const char *pFamilyName)
@@ -701,6 +1037,7 @@ public:
 
 		m_TextureAtlas.Clear(m_TextureDimension);
 		m_Glyphs.clear();
+		m_DiskCachedGlyphs.clear();
 	}
 
 	const SGlyph *GetGlyph(int Chr, int FontSize)
@@ -747,6 +1084,56 @@ public:
 		return nullptr;
 	}
 
+	void CollectPrewarmRequests(const std::vector<std::pair<int, int>> &vGlyphs, std::vector<CGlyphPrewarmJob::SRequest> &vRequests)
+	{
+		std::unordered_set<std::tuple<FT_Face, int, int>, SGlyphKeyHash, SGlyphKeyEquals> CollectedGlyphs;
+		std::unordered_map<std::tuple<FT_Face, int, int>, size_t, SGlyphKeyHash, SGlyphKeyEquals> RequestIndices;
+		for(auto [Chr, FontSize] : vGlyphs)
+		{
+			FontSize = clamp(FontSize, MIN_FONT_SIZE, MAX_FONT_SIZE);
+
+			// Missing glyphs use the replacement character, which is resolved when the glyph is first used.
+			FT_Face Face;
+			const FT_UInt GlyphIndex = GetCharGlyph(Chr, &Face, false);
+			if(GlyphIndex == 0 || m_Glyphs.find(std::make_tuple(Face, Chr, FontSize)) != m_Glyphs.end() || !CollectedGlyphs.emplace(Face, Chr, FontSize).second)
+				continue;
+
+			const auto Source = m_FaceSources.find(Face);
+			if(Source == m_FaceSources.end())
+				continue;
+
+			const auto RequestIndex = RequestIndices.emplace(std::make_tuple(Face, 0, FontSize), vRequests.size());
+			if(RequestIndex.second)
+			{
+				CGlyphPrewarmJob::SRequest &Request = vRequests.emplace_back();
+				Request.m_Face = Face;
+				Request.m_Source = Source->second;
+				Request.m_FontSize = FontSize;
+			}
+			vRequests[RequestIndex.first->second].m_vGlyphs.emplace_back(Chr, GlyphIndex);
+		}
+	}
+
+	void ApplyPrewarmResults(const std::vector<CGlyphPrewarmJob::SResult> &vResults)
+	{
+		for(const CGlyphPrewarmJob::SResult &Result : vResults)
+		{
+			// Failed glyphs are rendered again on demand, which also handles the replacement character.
+			if(!Result.m_Success)
+				continue;
+
+			SGlyph &Glyph = m_Glyphs[std::make_tuple(Result.m_Face, Result.m_Chr, Result.m_FontSize)];
+			if(Glyph.m_State != SGlyph::EState::UNINITIALIZED)
+				continue;
+
+			Glyph.m_FontSize = Result.m_FontSize;
+			Glyph.m_Face = Result.m_Face;
+			Glyph.m_Chr = Result.m_Chr;
+			Glyph.m_GlyphIndex = Result.m_Glyph.m_GlyphIndex;
+			PlaceGlyph(Glyph, Result.m_Glyph);
+		}
+	}
+
 	vec2 Kerning(const SGlyph *pLeft, const SGlyph *pRight) const
 	{
 		if(pLeft != nullptr && pRight != nullptr && pLeft->m_Face == pRight->m_Face && pLeft->m_FontSize == pRight->m_FontSize)
@@ -932,14 +1319,19 @@ struct SFontLanguageVariant
 class CTextRender : public IEngineTextRender
 {
 	IConsole *m_pConsole;
+	IEngine *m_pEngine;
 	IGraphics *m_pGraphics;
 	IStorage *m_pStorage;
 	IConsole *Console() { return m_pConsole; }
+	IEngine *Engine() { return m_pEngine; }
 	IGraphics *Graphics() { return m_pGraphics; }
 	IStorage *Storage() { return m_pStorage; }
 
 	CGlyphMap *m_pGlyphMap;
-	std::vector<void *> m_vpFontData;
+	std::vector<std::shared_ptr<void>> m_vpFontData;
+
+	std::shared_ptr<CGlyphPrewarmJob> m_pPrewarmJob;
+	std::vector<std::pair<int, int>> m_vPendingPrewarmGlyphs;
 
 	std::vector<SFontLanguageVariant> m_vVariants;
 
@@ -1018,8 +1410,14 @@ class CTextRender : public IEngineTextRender
 		}
 	}
 
-	bool LoadFontCollection(const char *pFontName, const FT_Byte *pFontData, FT_Long FontDataSize)
+	bool LoadFontCollection(const char *pFontName, const std::shared_ptr<void> &pFontFileData, FT_Long FontDataSize)
 	{
+		const FT_Byte *pFontData = static_cast<const FT_Byte *>(pFontFileData.get());
+		SFontFaceSource Source;
+		Source.m_pFontData = pFontFileData;
+		Source.m_FontDataSize = FontDataSize;
+		Source.m_FontHash = sha256(pFontData, FontDataSize);
+
 		FT_Face FtFace;
 		FT_Error CollectionLoadError = FT_New_Memory_Face(m_FTLibrary, pFontData, FontDataSize, -1, &FtFace);
 		if(CollectionLoadError)
@@ -1042,7 +1440,8 @@ class CTextRender : public IEngineTextRender
 				continue;
 			}
 
-			m_pGlyphMap->AddFace(FtFace);
+			Source.m_FaceIndex = FaceIndex;
+			m_pGlyphMap->AddFace(FtFace, Source);
 
 			log_debug("textrender", "Loaded font face %ld '%s %s' from font file '%s'", FaceIndex, FtFace->family_name, FtFace->style_name, pFontName);
 			LoadedAny = true;
@@ -1071,6 +1470,7 @@ public:
 	CTextRender()
 	{
 		m_pConsole = nullptr;
+		m_pEngine = nullptr;
 		m_pGraphics = nullptr;
 		m_pStorage = nullptr;
 		m_pGlyphMap = nullptr;
@@ -1088,10 +1488,11 @@ public:
 	void Init() override
 	{
 		m_pConsole = Kernel()->RequestInterface<IConsole>();
+		m_pEngine = Kernel()->RequestInterface<IEngine>();
 		m_pGraphics = Kernel()->RequestInterface<IGraphics>();
 		m_pStorage = Kernel()->RequestInterface<IStorage>();
 		FT_Init_FreeType(&m_FTLibrary);
-		m_pGlyphMap = new CGlyphMap(m_pGraphics);
+		m_pGlyphMap = new CGlyphMap(m_pGraphics, m_pStorage);
 
 		// print freetype version
 		{
@@ -1132,6 +1533,15 @@ public:
 
 	void Shutdown() override
 	{
+		// the job keeps its own references to the font data, only the glyph cache
+		// file it might be writing is waited for
+		if(m_pPrewarmJob)
+		{
+			m_pPrewarmJob->Abort();
+			m_pPrewarmJob = nullptr;
+		}
+		m_vPendingPrewarmGlyphs.clear();
+
 		for(auto *pTextCont : m_vpTextContainers)
 			delete pTextCont;
 		m_vpTextContainers.clear();
@@ -1143,13 +1553,12 @@ public:
 			FT_Done_FreeType(m_FTLibrary);
 		m_FTLibrary = nullptr;
 
-		for(auto *pFontData : m_vpFontData)
-			free(pFontData);
 		m_vpFontData.clear();
 
 		m_DefaultTextContainerInfo.m_vAttributes.clear();
 
 		m_pConsole = nullptr;
+		m_pEngine = nullptr;
 		m_pGraphics = nullptr;
 		m_pStorage = nullptr;
 	}
@@ -1203,13 +1612,10 @@ public:
 				unsigned FontDataSize;
 				if(Storage()->ReadFile(aFontName, IStorage::TYPE_ALL, &pFontData, &FontDataSize))
 				{
-					if(LoadFontCollection(aFontName, static_cast<FT_Byte *>(pFontData), (FT_Long)FontDataSize))
-					{
-						m_vpFontData.push_back(pFontData);
-					}
-					else
+					std::shared_ptr<void> pFontFileData(pFontData, free);
+					if(LoadFontCollection(aFontName, pFontFileData, (FT_Long)FontDataSize))
 					{
-						free(pFontData);
+						m_vpFontData.push_back(std::move(pFontFileData));
 					}
 				}
 				else
@@ -1315,6 +1721,51 @@ public:
 		m_pGlyphMap->SetFontPreset(FontPreset);
 	}
 
+	void UpdatePrewarm()
+	{
+		if(m_pPrewarmJob)
+		{
+			if(!m_pPrewarmJob->Done())
+				return;
+			if(m_pPrewarmJob->State() == IJob::STATE_DONE)
+				m_pGlyphMap->ApplyPrewarmResults(m_pPrewarmJob->Results());
+			m_pPrewarmJob = nullptr;
+		}
+
+		if(m_vPendingPrewarmGlyphs.empty())
+			return;
+
+		std::vector<CGlyphPrewarmJob::SRequest> vRequests;
+		m_pGlyphMap->CollectPrewarmRequests(m_vPendingPrewarmGlyphs, vRequests);
+		m_vPendingPrewarmGlyphs.clear();
+		if(vRequests.empty())
+			return;
+
+		m_pPrewarmJob = std::make_shared<CGlyphPrewarmJob>(Storage(), g_Config.m_ClTextGlyphCache, std::move(vRequests));
+		Engine()->AddJob(m_pPrewarmJob);
+	}
+
+	bool IsPrewarming() override
+	{
+		UpdatePrewarm();
+		return m_pPrewarmJob != nullptr;
+	}
+
+	void PrewarmGlyphs(const char *pText, float FontSize) override
+	{
+		float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+		Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+		const int ActualSize = round_truncate(FontSize * Graphics()->ScreenHeight() / (ScreenY1 - ScreenY0));
+
+		while(*pText)
+		{
+			const int Character = str_utf8_decode(&pText);
+			if(Character > 0 && Character != '\n' && Character != '\t')
+				m_vPendingPrewarmGlyphs.emplace_back(Character, ActualSize);
+		}
+		UpdatePrewarm();
+	}
+
 	void SetFontLanguageVariant(const char *pLanguageFile) override
 	{
 		for(const auto &Variant : m_vVariants)
@@ -1539,6 +1990,8 @@ public:
 
 	void AppendTextContainer(STextContainerIndex TextContainerIndex, CTextCursor *pCursor, const char *pText, int Length = -1) override
 	{
+		UpdatePrewarm();
+
 		STextContainer &TextContainer = GetTextContainer(TextContainerIndex);
 		str_append(TextContainer.m_aDebugText, pText);
 
@@ -398,6 +398,19 @@ public:
 	virtual void RenderQuadContainerAsSpriteMultiple(int ContainerIndex, int QuadOffset, int DrawCount, SRenderSpriteInfo *pRenderInfo) = 0;
 
 	virtual void QuadsDrawFreeform(const CFreeformItem *pArray, int Num) = 0;
+
+	// A quad with its own texture coordinates and color for every corner,
+	// the corners are in the same order as in CFreeformItem.
+	struct CFreeformQuad
+	{
+		vec2 m_aPos[4];
+		vec2 m_aTexCoords[4];
+		ColorRGBA m_aColors[4];
+	};
+	// Writes the quads directly into render commands, the current texture
+	// subset, colors and rotation are not used. Must be called between
+	// QuadsBegin and QuadsEnd or TrianglesBegin and TrianglesEnd.
+	virtual void QuadsDrawFreeformBatch(const CFreeformQuad *pArray, int Num) = 0;
 	virtual void QuadsText(float x, float y, float Size, const char *pText) = 0;
 
 	enum
@@ -453,6 +466,12 @@ public:
 	virtual int GetVideoModes(CVideoMode *pModes, int MaxModes, int Screen) = 0;
 	virtual void GetCurrentVideoMode(CVideoMode &CurMode, int Screen) = 0;
 	virtual void Swap() = 0;
+	// number of frames that have been presented with Swap
+	virtual uint64_t FrameCount() const = 0;
+	// number of calls to the vertex drawing functions (QuadsDraw*, LinesDraw)
+	// and of render calls in the last presented frame, for debugging
+	virtual uint64_t DrawCallsLastFrame() const = 0;
+	virtual uint64_t RenderCallsLastFrame() const = 0;
 	virtual int GetNumScreens() const = 0;
 	virtual const char *GetScreenName(int Screen) const = 0;
 
@@ -1,9 +1,13 @@
 #include "name_ban.h"
 
+#include <base/math.h>
 #include <base/system.h>
 
 #include <engine/shared/config.h>
 
+#include <algorithm>
+#include <deque>
+
 CNameBan::CNameBan(const char *pName, const char *pReason, int Distance, bool IsSubstring) :
 	m_Distance(Distance), m_IsSubstring(IsSubstring)
 {
@@ -36,11 +40,13 @@ void CNameBans::Ban(const char *pName, const char *pReason, const int Distance,
 			str_copy(Ban.m_aReason, pReason);
 			Ban.m_Distance = Distance;
 			Ban.m_IsSubstring = IsSubstring;
+			m_IndexValid = false;
 			return;
 		}
 	}
 
 	m_vNameBans.emplace_back(pName, pReason, Distance, IsSubstring);
+	m_IndexValid = false;
 	if(m_pConsole)
 	{
 		char aBuf[256];
@@ -70,6 +76,7 @@ void CNameBans::Unban(const char *pName)
 			m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "name_ban", aBuf);
 		}
 		m_vNameBans.erase(ToRemove, m_vNameBans.end());
+		m_IndexValid = false;
 	}
 }
 
@@ -86,24 +93,178 @@ void CNameBans::Dump() const
 	}
 }
 
+// Levenshtein distance like `str_utf32_dist_buffer`, but only exact up to
+// `Limit`. Returns a value larger than `Limit` as soon as the distance is
+// known to exceed it.
+static int BoundedDistance(const int *pA, int ALength, const int *pB, int BLength, int Limit)
+{
+	if(absolute(ALength - BLength) > Limit)
+		return Limit + 1;
+
+	int aaRows[2][MAX_NAME_SKELETON_LENGTH + 1];
+	int *pPrev = aaRows[0];
+	int *pCur = aaRows[1];
+	for(int i = 0; i <= ALength; i++)
+		pPrev[i] = i;
+	for(int j = 1; j <= BLength; j++)
+	{
+		pCur[0] = j;
+		int RowMin = pCur[0];
+		for(int i = 1; i <= ALength; i++)
+		{
+			pCur[i] = minimum(minimum(pPrev[i] + 1, pCur[i - 1] + 1), pPrev[i - 1] + (pA[i - 1] != pB[j - 1]));
+			RowMin = minimum(RowMin, pCur[i]);
+		}
+		// the distance can never be smaller than the minimum of the current row
+		if(RowMin > Limit)
+			return Limit + 1;
+		std::swap(pPrev, pCur);
+	}
+	return pPrev[ALength];
+}
+
+void CNameBans::BuildIndex() const
+{
+	for(int Length = 0; Length <= MAX_NAME_SKELETON_LENGTH; Length++)
+	{
+		m_avLengthBuckets[Length].clear();
+		m_aBucketMaxDistance[Length] = -1;
+	}
+	m_vSubstringNodes.clear();
+	m_vSubstringNodes.emplace_back();
+
+	for(int BanIndex = 0; BanIndex < (int)m_vNameBans.size(); BanIndex++)
+	{
+		const CNameBan &Ban = m_vNameBans[BanIndex];
+		if(Ban.m_Distance >= 0)
+		{
+			m_avLengthBuckets[Ban.m_SkeletonLength].push_back(BanIndex);
+			m_aBucketMaxDistance[Ban.m_SkeletonLength] = maximum(m_aBucketMaxDistance[Ban.m_SkeletonLength], Ban.m_Distance);
+		}
+
+		if(Ban.m_IsSubstring)
+		{
+			int Node = 0;
+			const char *pStr = Ban.m_aName;
+			while(*pStr)
+			{
+				const int Code = str_utf8_tolower(str_utf8_decode(&pStr));
+				auto Child = m_vSubstringNodes[Node].m_Children.find(Code);
+				if(Child == m_vSubstringNodes[Node].m_Children.end())
+				{
+					m_vSubstringNodes[Node].m_Children[Code] = m_vSubstringNodes.size();
+					Node = m_vSubstringNodes.size();
+					m_vSubstringNodes.emplace_back();
+				}
+				else
+				{
+					Node = Child->second;
+				}
+			}
+			m_vSubstringNodes[Node].m_BanIndex = BanIndex;
+		}
+	}
+
+	// compute failure links breadth-first, so the suffix of each node is already complete
+	std::deque<int> Queue;
+	for(const auto &[Code, Child] : m_vSubstringNodes[0].m_Children)
+		Queue.push_back(Child);
+	while(!Queue.empty())
+	{
+		const int Node = Queue.front();
+		Queue.pop_front();
+		m_vSubstringNodes[Node].m_BanIndex = maximum(m_vSubstringNodes[Node].m_BanIndex, m_vSubstringNodes[m_vSubstringNodes[Node].m_Fail].m_BanIndex);
+		for(const auto &[Code, Child] : m_vSubstringNodes[Node].m_Children)
+		{
+			int Fail = m_vSubstringNodes[Node].m_Fail;
+			while(true)
+			{
+				auto FailChild = m_vSubstringNodes[Fail].m_Children.find(Code);
+				if(FailChild != m_vSubstringNodes[Fail].m_Children.end())
+				{
+					m_vSubstringNodes[Child].m_Fail = FailChild->second;
+					break;
+				}
+				if(Fail == 0)
+				{
+					m_vSubstringNodes[Child].m_Fail = 0;
+					break;
+				}
+				Fail = m_vSubstringNodes[Fail].m_Fail;
+			}
+			Queue.push_back(Child);
+		}
+	}
+
+	m_IndexValid = true;
+}
+
+int CNameBans::FindDistanceMatch(const int *pSkeleton, int SkeletonLength) const
+{
+	int Result = -1;
+	for(int Length = 0; Length <= MAX_NAME_SKELETON_LENGTH; Length++)
+	{
+		if(absolute(Length - SkeletonLength) > m_aBucketMaxDistance[Length])
+			continue;
+
+		const std::vector<int> &vBucket = m_avLengthBuckets[Length];
+		for(auto It = vBucket.rbegin(); It != vBucket.rend() && *It > Result; ++It)
+		{
+			const CNameBan &Ban = m_vNameBans[*It];
+			if(BoundedDistance(pSkeleton, SkeletonLength, Ban.m_aSkeleton, Ban.m_SkeletonLength, Ban.m_Distance) <= Ban.m_Distance)
+			{
+				// buckets are sorted, so this is the last matching ban in this bucket
+				Result = *It;
+				break;
+			}
+		}
+	}
+	return Result;
+}
+
+int CNameBans::FindSubstringMatch(const char *pName) const
+{
+	// like `str_utf8_find_nocase`, nothing is found in an empty name
+	if(!*pName)
+		return -1;
+
+	int Node = 0;
+	int Result = m_vSubstringNodes[0].m_BanIndex;
+	while(*pName)
+	{
+		const int Code = str_utf8_tolower(str_utf8_decode(&pName));
+		while(true)
+		{
+			auto Child = m_vSubstringNodes[Node].m_Children.find(Code);
+			if(Child != m_vSubstringNodes[Node].m_Children.end())
+			{
+				Node = Child->second;
+				break;
+			}
+			if(Node == 0)
+				break;
+			Node = m_vSubstringNodes[Node].m_Fail;
+		}
+		Result = maximum(Result, m_vSubstringNodes[Node].m_BanIndex);
+	}
+	return Result;
+}
+
 const CNameBan *CNameBans::IsBanned(const char *pName) const
 {
+	if(!m_IndexValid)
+		BuildIndex();
+
 	char aTrimmed[MAX_NAME_LENGTH];
 	str_copy(aTrimmed, str_utf8_skip_whitespaces(pName));
 	str_utf8_trim_right(aTrimmed);
 
 	int aSkeleton[MAX_NAME_SKELETON_LENGTH];
 	int SkeletonLength = str_utf8_to_skeleton(aTrimmed, aSkeleton, std::size(aSkeleton));
-	int aBuffer[MAX_NAME_SKELETON_LENGTH * 2 + 2];
 
-	const CNameBan *pResult = nullptr;
-	for(const CNameBan &Ban : m_vNameBans)
-	{
-		int Distance = str_utf32_dist_buffer(aSkeleton, SkeletonLength, Ban.m_aSkeleton, Ban.m_SkeletonLength, aBuffer, std::size(aBuffer));
-		if(Distance <= Ban.m_Distance || (Ban.m_IsSubstring && str_utf8_find_nocase(pName, Ban.m_aName)))
-			pResult = &Ban;
-	}
-	return pResult;
+	// the last matching ban takes precedence
+	const int BanIndex = maximum(FindDistanceMatch(aSkeleton, SkeletonLength), FindSubstringMatch(pName));
+	return BanIndex >= 0 ? &m_vNameBans[BanIndex] : nullptr;
 }
 
 void CNameBans::ConNameBan(IConsole::IResult *pResult, void *pUser)
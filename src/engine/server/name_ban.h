@@ -4,6 +4,7 @@
 #include <engine/console.h>
 #include <engine/shared/protocol.h>
 
+#include <map>
 #include <vector>
 
 enum
@@ -30,6 +31,24 @@ class CNameBans
 	IConsole *m_pConsole = nullptr;
 	std::vector<CNameBan> m_vNameBans;
 
+	// Aho-Corasick automaton over the lowercase code points of substring bans
+	struct SSubstringNode
+	{
+		std::map<int, int> m_Children;
+		int m_Fail = 0;
+		int m_BanIndex = -1; // highest index of a ban ending here or in a suffix
+	};
+
+	// Lookup index for the bans, rebuilt lazily after the bans have changed
+	mutable bool m_IndexValid = false;
+	mutable std::vector<int> m_avLengthBuckets[MAX_NAME_SKELETON_LENGTH + 1]; // ban indices by skeleton length
+	mutable int m_aBucketMaxDistance[MAX_NAME_SKELETON_LENGTH + 1];
+	mutable std::vector<SSubstringNode> m_vSubstringNodes;
+
+	void BuildIndex() const;
+	int FindDistanceMatch(const int *pSkeleton, int SkeletonLength) const;
+	int FindSubstringMatch(const char *pName) const;
+
 	static void ConNameBan(IConsole::IResult *pResult, void *pUser);
 	static void ConNameUnban(IConsole::IResult *pResult, void *pUser);
 	static void ConNameBans(IConsole::IResult *pResult, void *pUser);
@@ -207,6 +207,11 @@ void CRconClientLogger::Log(const CLogMessage *pMessage)
 	m_pServer->SendRconLogLine(m_ClientId, pMessage);
 }
 
+void CServer::CClient::UpdateNameSkeleton()
+{
+	m_NameSkeletonLength = str_utf8_to_skeleton(m_aName, m_aNameSkeleton, std::size(m_aNameSkeleton));
+}
+
 void CServer::CClient::Reset()
 {
 	// reset input
@@ -244,6 +249,7 @@ CServer::CServer()
 	{
 		m_apCurrentMapData[i] = 0;
 		m_aCurrentMapSize[i] = 0;
+		m_aCurrentMapDataMapped[i] = false;
 	}
 
 	m_MapReload = false;
@@ -256,6 +262,11 @@ CServer::CServer()
 	m_RconClientId = IServer::RCON_CID_SERV;
 	m_RconAuthLevel = AUTHED_ADMIN;
 
+	static const char *s_apProfilerSectionNames[NUM_PROFILER_SECTIONS] = {"tick", "input", "game_tick", "snapshot", "rcon_commands", "fifo", "register", "antibot", "network"};
+	for(int i = 0; i < NUM_PROFILER_SECTIONS; i++)
+		m_aProfilerSections[i] = m_TickProfiler.AddSection(s_apProfilerSectionNames[i]);
+	m_TickProfilerLastPrint = 0;
+
 	m_ServerInfoFirstRequest = 0;
 	m_ServerInfoNumRequests = 0;
 	m_ServerInfoNeedsUpdate = false;
@@ -274,9 +285,9 @@ CServer::CServer()
 
 CServer::~CServer()
 {
-	for(auto &pCurrentMapData : m_apCurrentMapData)
+	for(int i = 0; i < NUM_MAP_TYPES; i++)
 	{
-		free(pCurrentMapData);
+		FreeMapData(i);
 	}
 
 	if(m_RunServer != UNINITIALIZED)
@@ -304,12 +315,23 @@ bool CServer::IsClientNameAvailable(int ClientId, const char *pNameRequest)
 		return false;
 
 	// make sure that two clients don't have the same name
+	int aSkeleton[MAX_NAME_SKELETON_LENGTH];
+	const int SkeletonLength = str_utf8_to_skeleton(pNameRequest, aSkeleton, std::size(aSkeleton));
 	for(int i = 0; i < MAX_CLIENTS; i++)
 	{
 		if(i != ClientId && m_aClients[i].m_State >= CClient::STATE_READY)
 		{
-			if(str_utf8_comp_confusable(pNameRequest, m_aClients[i].m_aName) == 0)
+			const CClient &Client = m_aClients[i];
+			if(SkeletonLength == (int)std::size(aSkeleton) || Client.m_NameSkeletonLength == (int)std::size(Client.m_aNameSkeleton))
+			{
+				// the skeletons might be truncated, compare the full names
+				if(str_utf8_comp_confusable(pNameRequest, Client.m_aName) == 0)
+					return false;
+			}
+			else if(SkeletonLength == Client.m_NameSkeletonLength && mem_comp(aSkeleton, Client.m_aNameSkeleton, SkeletonLength * sizeof(int)) == 0)
+			{
 				return false;
+			}
 		}
 	}
 
@@ -366,6 +388,7 @@ bool CServer::SetClientNameImpl(int ClientId, const char *pNameRequest, bool Set
 	{
 		// set the client name
 		str_copy(m_aClients[ClientId].m_aName, aNameTry);
+		m_aClients[ClientId].UpdateNameSkeleton();
 		GameServer()->TeehistorianRecordPlayerName(ClientId, m_aClients[ClientId].m_aName);
 	}
 
@@ -528,6 +551,7 @@ int CServer::Init()
 	{
 		Client.m_State = CClient::STATE_EMPTY;
 		Client.m_aName[0] = 0;
+		Client.UpdateNameSkeleton();
 		Client.m_aClan[0] = 0;
 		Client.m_Country = -1;
 		Client.m_Snapshots.Init();
@@ -1044,6 +1068,7 @@ int CServer::NewClientNoAuthCallback(int ClientId, void *pUser)
 
 	pThis->m_aClients[ClientId].m_State = CClient::STATE_CONNECTING;
 	pThis->m_aClients[ClientId].m_aName[0] = 0;
+	pThis->m_aClients[ClientId].UpdateNameSkeleton();
 	pThis->m_aClients[ClientId].m_aClan[0] = 0;
 	pThis->m_aClients[ClientId].m_Country = -1;
 	pThis->m_aClients[ClientId].m_Authed = AUTHED_NO;
@@ -1074,6 +1099,7 @@ int CServer::NewClientCallback(int ClientId, void *pUser, bool Sixup)
 	pThis->m_aClients[ClientId].m_State = CClient::STATE_PREAUTH;
 	pThis->m_aClients[ClientId].m_DnsblState = CClient::DNSBL_STATE_NONE;
 	pThis->m_aClients[ClientId].m_aName[0] = 0;
+	pThis->m_aClients[ClientId].UpdateNameSkeleton();
 	pThis->m_aClients[ClientId].m_aClan[0] = 0;
 	pThis->m_aClients[ClientId].m_Country = -1;
 	pThis->m_aClients[ClientId].m_Authed = AUTHED_NO;
@@ -1161,6 +1187,7 @@ int CServer::DelClientCallback(int ClientId, const char *pReason, void *pUser)
 
 	pThis->m_aClients[ClientId].m_State = CClient::STATE_EMPTY;
 	pThis->m_aClients[ClientId].m_aName[0] = 0;
+	pThis->m_aClients[ClientId].UpdateNameSkeleton();
 	pThis->m_aClients[ClientId].m_aClan[0] = 0;
 	pThis->m_aClients[ClientId].m_Country = -1;
 	pThis->m_aClients[ClientId].m_Authed = AUTHED_NO;
@@ -1927,31 +1954,6 @@ static inline int GetCacheIndex(int Type, bool SendClient)
 	return Type * 2 + SendClient;
 }
 
-CServer::CCache::CCache()
-{
-	m_vCache.clear();
-}
-
-CServer::CCache::~CCache()
-{
-	Clear();
-}
-
-CServer::CCache::CCacheChunk::CCacheChunk(const void *pData, int Size)
-{
-	m_vData.assign((const uint8_t *)pData, (const uint8_t *)pData + Size);
-}
-
-void CServer::CCache::AddChunk(const void *pData, int Size)
-{
-	m_vCache.emplace_back(pData, Size);
-}
-
-void CServer::CCache::Clear()
-{
-	m_vCache.clear();
-}
-
 void CServer::CacheServerInfo(CCache *pCache, int Type, bool SendClients)
 {
 	pCache->Clear();
@@ -2051,7 +2053,17 @@ void CServer::CacheServerInfo(CCache *pCache, int Type, bool SendClients)
 #define SAVE(size) \
 	do \
 	{ \
-		pCache->AddChunk(q.Data(), size); \
+		if(Type == SERVERINFO_EXTENDED) \
+		{ \
+			if(ChunksStored == 0) \
+				pCache->AddChunk(SERVERBROWSE_INFO_EXTENDED, sizeof(SERVERBROWSE_INFO_EXTENDED), q.Data(), size); \
+			else \
+				pCache->AddChunk(SERVERBROWSE_INFO_EXTENDED_MORE, sizeof(SERVERBROWSE_INFO_EXTENDED_MORE), q.Data(), size); \
+		} \
+		else if(Type == SERVERINFO_64_LEGACY) \
+			pCache->AddChunk(SERVERBROWSE_INFO_64_LEGACY, sizeof(SERVERBROWSE_INFO_64_LEGACY), q.Data(), size); \
+		else \
+			pCache->AddChunk(SERVERBROWSE_INFO, sizeof(SERVERBROWSE_INFO), q.Data(), size); \
 		ChunksStored++; \
 	} while(0)
 
@@ -2116,35 +2128,15 @@ void CServer::CacheServerInfo(CCache *pCache, int Type, bool SendClients)
 
 			int PreviousSize = q.Size();
 
-			q.AddString(ClientName(i), MAX_NAME_LENGTH); // client name
-			q.AddString(ClientClan(i), MAX_CLAN_LENGTH); // client clan
-
-			ADD_INT(q, m_aClients[i].m_Country); // client country
-
-			int Score;
-			if(m_aClients[i].m_Score.has_value())
-			{
-				Score = m_aClients[i].m_Score.value();
-				if(Score == 9999)
-					Score = -10000;
-				else if(Score == 0) // 0 time isn't displayed otherwise.
-					Score = -1;
-				else
-					Score = -Score;
-			}
-			else
-			{
-				Score = -9999;
-			}
-
-			ADD_INT(q, Score); // client score
-			ADD_INT(q, GameServer()->IsClientPlayer(i) ? 1 : 0); // is player?
+			// name, clan, country, score and is player, see UpdateCachedClientInfo
+			const std::vector<uint8_t> &vClientData = m_aCachedClientInfo[i].m_vData;
+			q.AddRaw(vClientData.data(), vClientData.size());
 			if(Type == SERVERINFO_EXTENDED)
 				q.AddString("", 0); // extra info, reserved
 
 			if(Type == SERVERINFO_EXTENDED)
 			{
-				if(q.Size() >= NET_MAX_PAYLOAD - 18) // 8 bytes for type, 10 bytes for the largest token
+				if(q.Size() >= NET_MAX_PAYLOAD - 8 - CCache::MAX_TOKEN_SIZE) // 8 bytes for type
 				{
 					// Retry current player.
 					i--;
@@ -2216,11 +2208,8 @@ void CServer::CacheServerInfoSixup(CCache *pCache, bool SendClients)
 		{
 			if(m_aClients[i].IncludedInServerInfo())
 			{
-				Packer.AddString(ClientName(i), MAX_NAME_LENGTH); // client name
-				Packer.AddString(ClientClan(i), MAX_CLAN_LENGTH); // client clan
-				Packer.AddInt(m_aClients[i].m_Country); // client country
-				Packer.AddInt(m_aClients[i].m_Score.value_or(-1)); // client score
-				Packer.AddInt(GameServer()->IsClientPlayer(i) ? 0 : 1); // flag spectator=1, bot=2 (player=0)
+				const std::vector<uint8_t> &vClientData = m_aCachedClientInfo[i].m_vDataSixup;
+				Packer.AddRaw(vClientData.data(), vClientData.size());
 			}
 		}
 	}
@@ -2230,54 +2219,21 @@ void CServer::CacheServerInfoSixup(CCache *pCache, bool SendClients)
 
 void CServer::SendServerInfo(const NETADDR *pAddr, int Token, int Type, bool SendClients)
 {
-	CPacker p;
-	char aBuf[128];
-	p.Reset();
+	dbg_assert(Type == SERVERINFO_VANILLA || Type == SERVERINFO_INGAME || Type == SERVERINFO_64_LEGACY || Type == SERVERINFO_EXTENDED, "unknown serverinfo type");
 
-	CCache *pCache = &m_aServerInfoCache[GetCacheIndex(Type, SendClients)];
-
-#define ADD_RAW(p, x) (p).AddRaw(x, sizeof(x))
-#define ADD_INT(p, x) \
-	do \
-	{ \
-		str_format(aBuf, sizeof(aBuf), "%d", x); \
-		(p).AddString(aBuf, 0); \
-	} while(0)
+	const CCache *pCache = &m_aServerInfoCache[GetCacheIndex(Type, SendClients)];
 
 	CNetChunk Packet;
 	Packet.m_ClientId = -1;
 	Packet.m_Address = *pAddr;
 	Packet.m_Flags = NETSENDFLAG_CONNLESS;
 
+	// the payloads are prebuilt, only the token has to be inserted
+	unsigned char aData[NET_MAX_PAYLOAD];
 	for(const auto &Chunk : pCache->m_vCache)
 	{
-		p.Reset();
-		if(Type == SERVERINFO_EXTENDED)
-		{
-			if(&Chunk == &pCache->m_vCache.front())
-				p.AddRaw(SERVERBROWSE_INFO_EXTENDED, sizeof(SERVERBROWSE_INFO_EXTENDED));
-			else
-				p.AddRaw(SERVERBROWSE_INFO_EXTENDED_MORE, sizeof(SERVERBROWSE_INFO_EXTENDED_MORE));
-			ADD_INT(p, Token);
-		}
-		else if(Type == SERVERINFO_64_LEGACY)
-		{
-			ADD_RAW(p, SERVERBROWSE_INFO_64_LEGACY);
-			ADD_INT(p, Token);
-		}
-		else if(Type == SERVERINFO_VANILLA || Type == SERVERINFO_INGAME)
-		{
-			ADD_RAW(p, SERVERBROWSE_INFO);
-			ADD_INT(p, Token);
-		}
-		else
-		{
-			dbg_assert(false, "unknown serverinfo type");
-		}
-
-		p.AddRaw(Chunk.m_vData.data(), Chunk.m_vData.size());
-		Packet.m_pData = p.Data();
-		Packet.m_DataSize = p.Size();
+		Packet.m_pData = aData;
+		Packet.m_DataSize = Chunk.Payload(Token, aData);
 		m_NetServer.Send(&Packet);
 	}
 }
@@ -2409,12 +2365,51 @@ void CServer::UpdateRegisterServerInfo()
 	m_pRegister->OnNewInfo(JsonWriter.GetOutputString().c_str());
 }
 
+void CServer::UpdateCachedClientInfo()
+{
+	CPacker Packer;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		CCachedClientInfo &Info = m_aCachedClientInfo[i];
+		if(!m_aClients[i].IncludedInServerInfo())
+		{
+			Info.m_Valid = false;
+			continue;
+		}
+
+		const char *pName = ClientName(i);
+		const char *pClan = ClientClan(i);
+		const bool IsPlayer = GameServer()->IsClientPlayer(i);
+		if(Info.m_Valid && str_comp(Info.m_aName, pName) == 0 && str_comp(Info.m_aClan, pClan) == 0 &&
+			Info.m_Country == m_aClients[i].m_Country && Info.m_Score == m_aClients[i].m_Score && Info.m_IsPlayer == IsPlayer)
+		{
+			continue;
+		}
+
+		Info.m_Valid = true;
+		str_copy(Info.m_aName, pName);
+		str_copy(Info.m_aClan, pClan);
+		Info.m_Country = m_aClients[i].m_Country;
+		Info.m_Score = m_aClients[i].m_Score;
+		Info.m_IsPlayer = IsPlayer;
+
+		Packer.Reset();
+		CCache::PackClient(&Packer, pName, pClan, Info.m_Country, Info.m_Score, IsPlayer);
+		Info.m_vData.assign(Packer.Data(), Packer.Data() + Packer.Size());
+
+		Packer.Reset();
+		CCache::PackClientSixup(&Packer, pName, pClan, Info.m_Country, Info.m_Score, IsPlayer);
+		Info.m_vDataSixup.assign(Packer.Data(), Packer.Data() + Packer.Size());
+	}
+}
+
 void CServer::UpdateServerInfo(bool Resend)
 {
 	if(m_RunServer == UNINITIALIZED)
 		return;
 
 	UpdateRegisterServerInfo();
+	UpdateCachedClientInfo();
 
 	for(int i = 0; i < 3; i++)
 		for(int j = 0; j < 2; j++)
@@ -2565,6 +2560,92 @@ void CServer::ReloadMap()
 	m_SameMapReload = true;
 }
 
+// Returns a read-only mapping of a snapshot of the map data or nullptr. The
+// snapshot is named after the hash of the data and only ever created by
+// renaming a complete file, so unlike the map file itself it is never
+// truncated or overwritten while it is mapped.
+static const void *MapMapDataSnapshot(IStorage *pStorage, const void *pData, unsigned Size)
+{
+	char aSha256[SHA256_MAXSTRSIZE];
+	sha256_str(sha256(pData, Size), aSha256, sizeof(aSha256));
+	char aPath[IO_MAX_PATH_LENGTH];
+	str_format(aPath, sizeof(aPath), "mapdata/%s.map", aSha256);
+
+	IOHANDLE File = pStorage->OpenFile(aPath, IOFLAG_READ, IStorage::TYPE_SAVE);
+	if(!File)
+	{
+		pStorage->CreateFolder("mapdata", IStorage::TYPE_SAVE);
+		char aTmpPath[IO_MAX_PATH_LENGTH];
+		IStorage::FormatTmpPath(aTmpPath, sizeof(aTmpPath), aPath);
+		IOHANDLE TmpFile = pStorage->OpenFile(aTmpPath, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+		if(!TmpFile)
+			return nullptr;
+		const bool Written = io_write(TmpFile, pData, Size) == Size && io_sync(TmpFile) == 0;
+		io_close(TmpFile);
+		// another server may have created the same snapshot in the meantime
+		if(!Written || !pStorage->RenameFile(aTmpPath, aPath, IStorage::TYPE_SAVE))
+			pStorage->RemoveFile(aTmpPath, IStorage::TYPE_SAVE);
+		File = pStorage->OpenFile(aPath, IOFLAG_READ, IStorage::TYPE_SAVE);
+		if(!File)
+			return nullptr;
+	}
+
+	unsigned MappedSize;
+	const void *pMapped = io_map(File, &MappedSize);
+	// the mapping stays valid without the file
+	io_close(File);
+	if(pMapped && (MappedSize != Size || mem_comp(pMapped, pData, Size) != 0))
+	{
+		io_unmap(pMapped, MappedSize);
+		return nullptr;
+	}
+	return pMapped;
+}
+
+bool CServer::LoadMapData(int MapType, const char *pFilename)
+{
+	FreeMapData(MapType);
+
+	void *pData;
+	unsigned Size;
+	if(!Storage()->ReadFile(pFilename, IStorage::TYPE_ALL, &pData, &Size))
+		return false;
+
+	// A read-only mapping is backed by the page cache, so all server
+	// processes on this machine hosting the same map share its pages instead
+	// of keeping a copy each. Running several servers in one process would
+	// save more, but the game and engine state is global.
+	if(Config()->m_SvShareMapData)
+	{
+		const void *pMapped = MapMapDataSnapshot(Storage(), pData, Size);
+		if(pMapped)
+		{
+			free(pData);
+			// never written to, the pointer is only non-const for the demo recorder
+			m_apCurrentMapData[MapType] = (unsigned char *)pMapped;
+			m_aCurrentMapSize[MapType] = Size;
+			m_aCurrentMapDataMapped[MapType] = true;
+			return true;
+		}
+		log_warn("server", "couldn't map a snapshot of %s, keeping a copy instead", pFilename);
+	}
+
+	m_apCurrentMapData[MapType] = (unsigned char *)pData;
+	m_aCurrentMapSize[MapType] = Size;
+	return true;
+}
+
+void CServer::FreeMapData(int MapType)
+{
+	if(m_aCurrentMapDataMapped[MapType])
+		io_unmap(m_apCurrentMapData[MapType], m_aCurrentMapSize[MapType]);
+	else
+		free(m_apCurrentMapData[MapType]);
+	m_apCurrentMapData[MapType] = 0;
+	m_aCurrentMapSize[MapType] = 0;
+	m_aCurrentMapDataMapped[MapType] = false;
+}
+
 int CServer::LoadMap(const char *pMapName)
 {
 	m_MapReload = false;
@@ -2593,12 +2674,7 @@ int CServer::LoadMap(const char *pMapName)
 	m_pCurrentMapName = fs_filename(m_aCurrentMap);
 
 	// load complete map into memory for download
-	{
-		free(m_apCurrentMapData[MAP_TYPE_SIX]);
-		void *pData;
-		Storage()->ReadFile(aBuf, IStorage::TYPE_ALL, &pData, &m_aCurrentMapSize[MAP_TYPE_SIX]);
-		m_apCurrentMapData[MAP_TYPE_SIX] = (unsigned char *)pData;
-	}
+	LoadMapData(MAP_TYPE_SIX, aBuf);
 
 	if(Config()->m_SvMapsBaseUrl[0])
 	{
@@ -2614,8 +2690,7 @@ int CServer::LoadMap(const char *pMapName)
 	if(Config()->m_SvSixup)
 	{
 		str_format(aBuf, sizeof(aBuf), "maps7/%s.map", pMapName);
-		void *pData;
-		if(!Storage()->ReadFile(aBuf, IStorage::TYPE_ALL, &pData, &m_aCurrentMapSize[MAP_TYPE_SIXUP]))
+		if(!LoadMapData(MAP_TYPE_SIXUP, aBuf))
 		{
 			Config()->m_SvSixup = 0;
 			if(m_pRegister)
@@ -2627,9 +2702,6 @@ int CServer::LoadMap(const char *pMapName)
 		}
 		else
 		{
-			free(m_apCurrentMapData[MAP_TYPE_SIXUP]);
-			m_apCurrentMapData[MAP_TYPE_SIXUP] = (unsigned char *)pData;
-
 			m_aCurrentMapSha256[MAP_TYPE_SIXUP] = sha256(m_apCurrentMapData[MAP_TYPE_SIXUP], m_aCurrentMapSize[MAP_TYPE_SIXUP]);
 			m_aCurrentMapCrc[MAP_TYPE_SIXUP] = crc32(0, m_apCurrentMapData[MAP_TYPE_SIXUP], m_aCurrentMapSize[MAP_TYPE_SIXUP]);
 			sha256_str(m_aCurrentMapSha256[MAP_TYPE_SIXUP], aSha256, sizeof(aSha256));
@@ -2639,8 +2711,7 @@ int CServer::LoadMap(const char *pMapName)
 	}
 	if(!Config()->m_SvSixup)
 	{
-		free(m_apCurrentMapData[MAP_TYPE_SIXUP]);
-		m_apCurrentMapData[MAP_TYPE_SIXUP] = 0;
+		FreeMapData(MAP_TYPE_SIXUP);
 	}
 
 	for(int i = 0; i < MAX_CLIENTS; i++)
@@ -2667,6 +2738,7 @@ void CServer::UpdateDebugDummies(bool ForceDisconnect)
 			GameServer()->OnClientConnected(ClientId, nullptr);
 			m_aClients[ClientId].m_State = CClient::STATE_INGAME;
 			str_format(m_aClients[ClientId].m_aName, sizeof(m_aClients[ClientId].m_aName), "Debug dummy %d", DummyIndex + 1);
+			m_aClients[ClientId].UpdateNameSkeleton();
 			GameServer()->OnClientEnter(ClientId);
 		}
 		else if(!AddDummy && m_aClients[ClientId].m_DebugDummy)
@@ -2896,54 +2968,71 @@ int CServer::Run()
 				}
 			}
 
+			const bool TickBatch = Config()->m_SvTickBatch;
+			if(TickBatch)
+				m_NetServer.BeginTickBatch();
+
+			m_TickProfiler.SetEnabled(Config()->m_SvTickProfiler);
 			while(t > TickStartTime(m_CurrentGameTick + 1))
 			{
+				m_TickProfiler.SetTick(m_CurrentGameTick + 1);
+				CTickProfiler::CScope TickScope(&m_TickProfiler, m_aProfilerSections[PROFILER_TICK]);
+
 				GameServer()->OnPreTickTeehistorian();
 
 #ifdef CONF_DEBUG
 				UpdateDebugDummies(false);
 #endif
 
-				for(int c = 0; c < MAX_CLIENTS; c++)
 				{
-					if(m_aClients[c].m_State != CClient::STATE_INGAME)
-						continue;
-					bool ClientHadInput = false;
-					for(auto &Input : m_aClients[c].m_aInputs)
+					CTickProfiler::CScope Scope(&m_TickProfiler, m_aProfilerSections[PROFILER_INPUT]);
+					for(int c = 0; c < MAX_CLIENTS; c++)
 					{
-						if(Input.m_GameTick == Tick() + 1)
+						if(m_aClients[c].m_State != CClient::STATE_INGAME)
+							continue;
+						bool ClientHadInput = false;
+						for(auto &Input : m_aClients[c].m_aInputs)
 						{
-							GameServer()->OnClientPredictedEarlyInput(c, Input.m_aData);
-							ClientHadInput = true;
+							if(Input.m_GameTick == Tick() + 1)
+							{
+								GameServer()->OnClientPredictedEarlyInput(c, Input.m_aData);
+								ClientHadInput = true;
+							}
 						}
+						if(!ClientHadInput)
+							GameServer()->OnClientPredictedEarlyInput(c, nullptr);
 					}
-					if(!ClientHadInput)
-						GameServer()->OnClientPredictedEarlyInput(c, nullptr);
 				}
 
 				m_CurrentGameTick++;
 				NewTicks++;
 
 				// apply new input
-				for(int c = 0; c < MAX_CLIENTS; c++)
 				{
-					if(m_aClients[c].m_State != CClient::STATE_INGAME)
-						continue;
-					bool ClientHadInput = false;
-					for(auto &Input : m_aClients[c].m_aInputs)
+					CTickProfiler::CScope Scope(&m_TickProfiler, m_aProfilerSections[PROFILER_INPUT]);
+					for(int c = 0; c < MAX_CLIENTS; c++)
 					{
-						if(Input.m_GameTick == Tick())
+						if(m_aClients[c].m_State != CClient::STATE_INGAME)
+							continue;
+						bool ClientHadInput = false;
+						for(auto &Input : m_aClients[c].m_aInputs)
 						{
-							GameServer()->OnClientPredictedInput(c, Input.m_aData);
-							ClientHadInput = true;
-							break;
+							if(Input.m_GameTick == Tick())
+							{
+								GameServer()->OnClientPredictedInput(c, Input.m_aData);
+								ClientHadInput = true;
+								break;
+							}
 						}
+						if(!ClientHadInput)
+							GameServer()->OnClientPredictedInput(c, nullptr);
 					}
-					if(!ClientHadInput)
-						GameServer()->OnClientPredictedInput(c, nullptr);
 				}
 
-				GameServer()->OnTick();
+				{
+					CTickProfiler::CScope Scope(&m_TickProfiler, m_aProfilerSections[PROFILER_GAME_TICK]);
+					GameServer()->OnTick();
+				}
 				if(ErrorShutdown())
 				{
 					break;
@@ -2954,11 +3043,20 @@ int CServer::Run()
 			if(NewTicks)
 			{
 				if(Config()->m_SvHighBandwidth || (m_CurrentGameTick % 2) == 0)
+				{
+					CTickProfiler::CScope Scope(&m_TickProfiler, m_aProfilerSections[PROFILER_SNAPSHOT]);
 					DoSnapshot();
+				}
 
-				UpdateClientRconCommands();
+				{
+					CTickProfiler::CScope Scope(&m_TickProfiler, m_aProfilerSections[PROFILER_RCON_COMMANDS]);
+					UpdateClientRconCommands();
+				}
 
-				m_Fifo.Update();
+				{
+					CTickProfiler::CScope Scope(&m_TickProfiler, m_aProfilerSections[PROFILER_FIFO]);
+					m_Fifo.Update();
+				}
 
 #if defined(CONF_PLATFORM_ANDROID)
 				std::vector<std::string> vAndroidCommandQueue = FetchAndroidServerCommandQueue();
@@ -2969,12 +3067,24 @@ int CServer::Run()
 #endif
 
 				// master server stuff
-				m_pRegister->Update();
+				{
+					CTickProfiler::CScope Scope(&m_TickProfiler, m_aProfilerSections[PROFILER_REGISTER]);
+					m_pRegister->Update();
+				}
 
 				if(m_ServerInfoNeedsUpdate)
 					UpdateServerInfo();
 
-				Antibot()->OnEngineTick();
+				{
+					CTickProfiler::CScope Scope(&m_TickProfiler, m_aProfilerSections[PROFILER_ANTIBOT]);
+					Antibot()->OnEngineTick();
+				}
+
+				if(m_TickProfiler.Enabled() && Config()->m_SvTickProfilerInterval && time_get() > m_TickProfilerLastPrint + Config()->m_SvTickProfilerInterval * time_freq())
+				{
+					m_TickProfilerLastPrint = time_get();
+					PrintTickProfile();
+				}
 
 				// handle dnsbl
 				if(Config()->m_SvDnsbl)
@@ -3035,8 +3145,14 @@ int CServer::Run()
 				}
 			}
 
+			if(TickBatch)
+				m_NetServer.EndTickBatch();
+
 			if(!NonActive)
+			{
+				CTickProfiler::CScope Scope(&m_TickProfiler, m_aProfilerSections[PROFILER_NETWORK]);
 				PumpNetwork(PacketWaiting);
+			}
 
 			NonActive = true;
 			for(const auto &Client : m_aClients)
@@ -3186,6 +3302,69 @@ void CServer::ConStatus(IConsole::IResult *pResult, void *pUser)
 	}
 }
 
+void CServer::ConNetStats(IConsole::IResult *pResult, void *pUser)
+{
+	char aBuf[256];
+	CServer *pThis = static_cast<CServer *>(pUser);
+
+	uint64_t TotalPackets = 0;
+	uint64_t TotalBytes = 0;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(pThis->m_aClients[i].m_State == CClient::STATE_EMPTY)
+			continue;
+
+		const CNetConnection *pConnection = pThis->m_NetServer.Connection(i);
+		const uint64_t NumPackets = pConnection->NumPacketsSent();
+		const uint64_t NumBytes = pConnection->NumChunkBytesSent();
+		TotalPackets += NumPackets;
+		TotalBytes += NumBytes;
+		str_format(aBuf, sizeof(aBuf), "id=%d packets=%" PRIu64 " avg_size=%" PRIu64 " fill=%d%%",
+			i, NumPackets, NumPackets ? NumBytes / NumPackets : 0, NumPackets ? (int)(NumBytes * 100 / (NumPackets * NET_MAX_PAYLOAD)) : 0);
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+	}
+	str_format(aBuf, sizeof(aBuf), "total packets=%" PRIu64 " avg_size=%" PRIu64 " fill=%d%%",
+		TotalPackets, TotalPackets ? TotalBytes / TotalPackets : 0, TotalPackets ? (int)(TotalBytes * 100 / (TotalPackets * NET_MAX_PAYLOAD)) : 0);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+}
+
+void CServer::PrintTickProfile()
+{
+	char aBuf[256];
+	for(int i = 0; i < m_TickProfiler.NumSections(); i++)
+	{
+		if(!m_TickProfiler.Histogram(i).Count())
+			continue;
+		m_TickProfiler.FormatSummary(i, aBuf, sizeof(aBuf));
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "tickprofiler", aBuf);
+	}
+}
+
+void CServer::ConTickProfile(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = static_cast<CServer *>(pUser);
+	if(!pThis->m_TickProfiler.Enabled())
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "tickprofiler", "tick profiler is disabled, enable it with sv_tick_profiler 1");
+	pThis->PrintTickProfile();
+}
+
+void CServer::ConTickProfileReset(IConsole::IResult *pResult, void *pUser)
+{
+	static_cast<CServer *>(pUser)->m_TickProfiler.Reset();
+}
+
+void CServer::ConTickProfileDump(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = static_cast<CServer *>(pUser);
+	const char *pFilename = pResult->NumArguments() ? pResult->GetString(0) : "tickprofile.json";
+	char aBuf[IO_MAX_PATH_LENGTH + 64];
+	if(pThis->m_TickProfiler.WriteChromeTrace(pThis->Storage()->OpenFile(pFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE)))
+		str_format(aBuf, sizeof(aBuf), "wrote trace to '%s'", pFilename);
+	else
+		str_format(aBuf, sizeof(aBuf), "failed to open '%s' for writing", pFilename);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "tickprofiler", aBuf);
+}
+
 static int GetAuthLevel(const char *pLevel)
 {
 	int Level = -1;
@@ -3434,7 +3613,8 @@ void CServer::DemoRecorder_HandleAutoStart()
 			m_apCurrentMapData[MAP_TYPE_SIX],
 			nullptr,
 			nullptr,
-			nullptr);
+			nullptr,
+			Config()->m_SvDemoAsyncWrite);
 
 		if(Config()->m_SvAutoDemoMax)
 		{
@@ -3474,7 +3654,8 @@ void CServer::StartRecord(int ClientId)
 			m_apCurrentMapData[MAP_TYPE_SIX],
 			nullptr,
 			nullptr,
-			nullptr);
+			nullptr,
+			Config()->m_SvDemoAsyncWrite);
 	}
 }
 
@@ -3536,7 +3717,8 @@ void CServer::ConRecord(IConsole::IResult *pResult, void *pUser)
 		pServer->m_apCurrentMapData[MAP_TYPE_SIX],
 		nullptr,
 		nullptr,
-		nullptr);
+		nullptr,
+		pServer->Config()->m_SvDemoAsyncWrite);
 }
 
 void CServer::ConStopRecord(IConsole::IResult *pResult, void *pUser)
@@ -3891,6 +4073,10 @@ void CServer::RegisterCommands()
 	// register console commands
 	Console()->Register("kick", "i[id] ?r[reason]", CFGFLAG_SERVER, ConKick, this, "Kick player with specified id for any reason");
 	Console()->Register("status", "?r[name]", CFGFLAG_SERVER, ConStatus, this, "List players containing name or all players");
+	Console()->Register("net_stats", "", CFGFLAG_SERVER, ConNetStats, this, "List how many packets were sent to each client and how well they were filled");
+	Console()->Register("tick_profile", "", CFGFLAG_SERVER, ConTickProfile, this, "Show how long the sections of the server tick take");
+	Console()->Register("tick_profile_reset", "", CFGFLAG_SERVER, ConTickProfileReset, this, "Reset the tick profiler statistics");
+	Console()->Register("tick_profile_dump", "?s[file]", CFGFLAG_SERVER, ConTickProfileDump, this, "Write the most recent tick profiler measurements as Chrome trace JSON");
 	Console()->Register("shutdown", "?r[reason]", CFGFLAG_SERVER, ConShutdown, this, "Shut down");
 	Console()->Register("logout", "", CFGFLAG_SERVER, ConLogout, this, "Logout of rcon");
 	Console()->Register("show_ips", "?i[show]", CFGFLAG_SERVER, ConShowIps, this, "Show IP addresses in rcon commands (1 = on, 0 = off)");
@@ -16,6 +16,7 @@
 #include <engine/shared/network.h>
 #include <engine/shared/protocol.h>
 #include <engine/shared/snapshot.h>
+#include <engine/shared/tickprofiler.h>
 #include <engine/shared/uuid_manager.h>
 
 #include <list>
@@ -26,6 +27,7 @@
 #include "antibot.h"
 #include "authmanager.h"
 #include "name_ban.h"
+#include "serverinfo_cache.h"
 #include "snap_id_pool.h"
 
 #if defined(CONF_UPNP)
@@ -154,6 +156,11 @@ public:
 		char m_aName[MAX_NAME_LENGTH];
 		char m_aClan[MAX_CLAN_LENGTH];
 		int m_Country;
+
+		// confusable skeleton of m_aName, must be updated whenever the name changes
+		int m_aNameSkeleton[MAX_NAME_SKELETON_LENGTH];
+		int m_NameSkeletonLength;
+		void UpdateNameSkeleton();
 		std::optional<int> m_Score;
 		int m_Authed;
 		int m_AuthKey;
@@ -202,6 +209,23 @@ public:
 	CEcon m_Econ;
 	CFifo m_Fifo;
 	CServerBan m_ServerBan;
+
+	enum
+	{
+		PROFILER_TICK,
+		PROFILER_INPUT,
+		PROFILER_GAME_TICK,
+		PROFILER_SNAPSHOT,
+		PROFILER_RCON_COMMANDS,
+		PROFILER_FIFO,
+		PROFILER_REGISTER,
+		PROFILER_ANTIBOT,
+		PROFILER_NETWORK,
+		NUM_PROFILER_SECTIONS
+	};
+	CTickProfiler m_TickProfiler;
+	int m_aProfilerSections[NUM_PROFILER_SECTIONS];
+	int64_t m_TickProfilerLastPrint;
 	CHttp m_Http;
 
 	IEngineMap *m_pMap;
@@ -247,6 +271,7 @@ public:
 	unsigned m_aCurrentMapCrc[NUM_MAP_TYPES];
 	unsigned char *m_apCurrentMapData[NUM_MAP_TYPES];
 	unsigned int m_aCurrentMapSize[NUM_MAP_TYPES];
+	bool m_aCurrentMapDataMapped[NUM_MAP_TYPES];
 	char m_aMapDownloadUrl[256];
 
 	CDemoRecorder m_aDemoRecorder[NUM_RECORDERS];
@@ -340,30 +365,28 @@ public:
 	bool CheckReservedSlotAuth(int ClientId, const char *pPassword);
 	void ProcessClientPacket(CNetChunk *pPacket);
 
-	class CCache
+	typedef CServerInfoCache CCache;
+	CCache m_aServerInfoCache[3 * 2];
+	CCache m_aSixupServerInfoCache[2];
+	bool m_ServerInfoNeedsUpdate;
+
+	// Packed server info entry of a client, only repacked when one of its
+	// fields changed since the last server info update.
+	class CCachedClientInfo
 	{
 	public:
-		class CCacheChunk
-		{
-		public:
-			CCacheChunk(const void *pData, int Size);
-			CCacheChunk(const CCacheChunk &) = delete;
-			CCacheChunk(CCacheChunk &&) = default;
-
-			std::vector<uint8_t> m_vData;
-		};
-
-		std::vector<CCacheChunk> m_vCache;
-
-		CCache();
-		~CCache();
+		bool m_Valid = false;
+		char m_aName[MAX_NAME_LENGTH];
+		char m_aClan[MAX_CLAN_LENGTH];
+		int m_Country;
+		std::optional<int> m_Score;
+		bool m_IsPlayer;
 
-		void AddChunk(const void *pData, int Size);
-		void Clear();
+		std::vector<uint8_t> m_vData;
+		std::vector<uint8_t> m_vDataSixup;
 	};
-	CCache m_aServerInfoCache[3 * 2];
-	CCache m_aSixupServerInfoCache[2];
-	bool m_ServerInfoNeedsUpdate;
+	CCachedClientInfo m_aCachedClientInfo[MAX_CLIENTS];
+	void UpdateCachedClientInfo();
 
 	void FillAntibot(CAntibotRoundData *pData) override;
 
@@ -383,6 +406,8 @@ public:
 	const char *GetMapName() const override;
 	void ReloadMap() override;
 	int LoadMap(const char *pMapName);
+	bool LoadMapData(int MapType, const char *pFilename);
+	void FreeMapData(int MapType);
 
 	void SaveDemo(int ClientId, float Time) override;
 	void StartRecord(int ClientId) override;
@@ -394,6 +419,10 @@ public:
 
 	static void ConKick(IConsole::IResult *pResult, void *pUser);
 	static void ConStatus(IConsole::IResult *pResult, void *pUser);
+	static void ConNetStats(IConsole::IResult *pResult, void *pUser);
+	static void ConTickProfile(IConsole::IResult *pResult, void *pUser);
+	static void ConTickProfileReset(IConsole::IResult *pResult, void *pUser);
+	static void ConTickProfileDump(IConsole::IResult *pResult, void *pUser);
 	static void ConShutdown(IConsole::IResult *pResult, void *pUser);
 	static void ConRecord(IConsole::IResult *pResult, void *pUser);
 	static void ConStopRecord(IConsole::IResult *pResult, void *pUser);
@@ -478,6 +507,9 @@ public:
 	bool ErrorShutdown() const { return m_aErrorShutdownReason[0] != 0; }
 	void SetErrorShutdown(const char *pReason) override;
 
+	CTickProfiler *TickProfiler() override { return &m_TickProfiler; }
+	void PrintTickProfile();
+
 	bool IsSixup(int ClientId) const override { return ClientId != SERVER_DEMO_CLIENT && m_aClients[ClientId].m_Sixup; }
 
 	void SetLoggers(std::shared_ptr<ILogger> &&pFileLogger, std::shared_ptr<ILogger> &&pStdoutLogger);
@@ -0,0 +1,98 @@
+#include "serverinfo_cache.h"
+
+#include <base/logger.h>
+#include <base/system.h>
+
+#include <engine/shared/network.h>
+#include <engine/shared/packer.h>
+#include <engine/shared/protocol.h>
+
+CServerInfoCache::CServerInfoCache()
+{
+	m_vCache.clear();
+}
+
+CServerInfoCache::~CServerInfoCache()
+{
+	Clear();
+}
+
+CServerInfoCache::CCacheChunk::CCacheChunk(const void *pHeader, int HeaderSize, const void *pData, int Size)
+{
+	m_vData.reserve(HeaderSize + Size);
+	m_vData.assign((const uint8_t *)pHeader, (const uint8_t *)pHeader + HeaderSize);
+	m_vData.insert(m_vData.end(), (const uint8_t *)pData, (const uint8_t *)pData + Size);
+	m_HeaderSize = HeaderSize;
+}
+
+int CServerInfoCache::CCacheChunk::Payload(int Token, unsigned char *pData) const
+{
+	char aToken[16];
+	str_format(aToken, sizeof(aToken), "%d", Token);
+	const int TokenSize = str_length(aToken) + 1;
+	dbg_assert(TokenSize <= MAX_TOKEN_SIZE, "server info token too large");
+
+	const int BodySize = m_vData.size() - m_HeaderSize;
+	mem_copy(pData, m_vData.data(), m_HeaderSize);
+	mem_copy(pData + m_HeaderSize, aToken, TokenSize);
+	mem_copy(pData + m_HeaderSize + TokenSize, m_vData.data() + m_HeaderSize, BodySize);
+	return m_HeaderSize + TokenSize + BodySize;
+}
+
+void CServerInfoCache::AddChunk(const void *pData, int Size)
+{
+	m_vCache.emplace_back(nullptr, 0, pData, Size);
+}
+
+void CServerInfoCache::AddChunk(const void *pHeader, int HeaderSize, const void *pData, int Size)
+{
+	// the chunk has to fit into one packet with any token
+	if(HeaderSize + MAX_TOKEN_SIZE + Size > NET_MAX_PAYLOAD)
+	{
+		log_error("server", "server info chunk of %d bytes does not fit into a packet with the token", HeaderSize + Size);
+		dbg_assert(false, "server info chunk too large");
+	}
+	m_vCache.emplace_back(pHeader, HeaderSize, pData, Size);
+}
+
+void CServerInfoCache::Clear()
+{
+	m_vCache.clear();
+}
+
+void CServerInfoCache::PackClient(CPacker *pPacker, const char *pName, const char *pClan, int Country, std::optional<int> Score, bool IsPlayer)
+{
+	int PackedScore;
+	if(Score.has_value())
+	{
+		PackedScore = Score.value();
+		if(PackedScore == 9999)
+			PackedScore = -10000;
+		else if(PackedScore == 0) // 0 time isn't displayed otherwise.
+			PackedScore = -1;
+		else
+			PackedScore = -PackedScore;
+	}
+	else
+	{
+		PackedScore = -9999;
+	}
+
+	char aBuf[16];
+	pPacker->AddString(pName, MAX_NAME_LENGTH); // client name
+	pPacker->AddString(pClan, MAX_CLAN_LENGTH); // client clan
+	str_format(aBuf, sizeof(aBuf), "%d", Country);
+	pPacker->AddString(aBuf, 0); // client country
+	str_format(aBuf, sizeof(aBuf), "%d", PackedScore);
+	pPacker->AddString(aBuf, 0); // client score
+	pPacker->AddString(IsPlayer ? "1" : "0", 0); // is player?
+}
+
+void CServerInfoCache::PackClientSixup(CPacker *pPacker, const char *pName, const char *pClan, int Country, std::optional<int> Score, bool IsPlayer)
+{
+	pPacker->AddString(pName, MAX_NAME_LENGTH); // client name
+	pPacker->AddString(pClan, MAX_CLAN_LENGTH); // client clan
+	pPacker->AddInt(Country); // client country
+	pPacker->AddInt(Score.value_or(-1)); // client score
+	pPacker->AddInt(IsPlayer ? 0 : 1); // flag spectator=1, bot=2 (player=0)
+}
@@ -0,0 +1,53 @@
+#ifndef ENGINE_SERVER_SERVERINFO_CACHE_H
+#define ENGINE_SERVER_SERVERINFO_CACHE_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+class CPacker;
+
+// Prebuilt server info responses. A chunk holds the packet type header and
+// the body of one response, the token of the request is inserted between
+// them when it is sent.
+class CServerInfoCache
+{
+public:
+	enum
+	{
+		// request tokens have 24 bits, "%d" of them and the null terminator
+		// take 9 bytes at most
+		MAX_TOKEN_SIZE = 10,
+	};
+
+	class CCacheChunk
+	{
+	public:
+		CCacheChunk(const void *pHeader, int HeaderSize, const void *pData, int Size);
+		CCacheChunk(const CCacheChunk &) = delete;
+		CCacheChunk(CCacheChunk &&) = default;
+
+		// prebuilt payload, the token is inserted at m_HeaderSize when sending
+		std::vector<uint8_t> m_vData;
+		int m_HeaderSize;
+
+		// Writes the payload for the token to `pData`, which has to hold
+		// `m_vData.size() + MAX_TOKEN_SIZE` bytes. Returns the payload size.
+		int Payload(int Token, unsigned char *pData) const;
+	};
+
+	std::vector<CCacheChunk> m_vCache;
+
+	CServerInfoCache();
+	~CServerInfoCache();
+
+	void AddChunk(const void *pData, int Size);
+	void AddChunk(const void *pHeader, int HeaderSize, const void *pData, int Size);
+	void Clear();
+
+	// the server info entry of a client for 0.6 and 0.7 server info
+	static void PackClient(CPacker *pPacker, const char *pName, const char *pClan, int Country, std::optional<int> Score, bool IsPlayer);
+	static void PackClientSixup(CPacker *pPacker, const char *pName, const char *pClan, int Country, std::optional<int> Score, bool IsPlayer);
+};
+
+#endif
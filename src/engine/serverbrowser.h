@@ -19,6 +19,9 @@ static constexpr const char *DDNET_INFO_URL = "https://info.ddnet.org/info";
 
 class CUIElement;
 
+// The info of one server. The client list and most strings are only pointed
+// to, they are stored in the CServerInfoArena of whoever keeps the info, so a
+// copy stays valid only as long as that arena isn't reset.
 class CServerInfo
 {
 public:
@@ -61,18 +64,19 @@ public:
 		MAX_COMMUNITY_TYPE_LENGTH = 32,
 	};
 
+	// The strings point into the CServerInfoArena that holds the client list.
 	class CClient
 	{
 	public:
-		char m_aName[MAX_NAME_LENGTH];
-		char m_aClan[MAX_CLAN_LENGTH];
+		const char *m_pName;
+		const char *m_pClan;
 		int m_Country;
 		int m_Score;
 		bool m_Player;
 		bool m_Afk;
 
 		// skin info
-		char m_aSkin[MAX_SKIN_LENGTH];
+		const char *m_pSkin;
 		bool m_CustomSkinColors;
 		int m_CustomSkinColorBody;
 		int m_CustomSkinColorFeet;
@@ -101,21 +105,23 @@ public:
 	EClientScoreKind m_ClientScoreKind;
 	TRISTATE m_Favorite;
 	TRISTATE m_FavoriteAllowPing;
-	char m_aCommunityId[MAX_COMMUNITY_ID_LENGTH];
-	char m_aCommunityCountry[MAX_COMMUNITY_COUNTRY_LENGTH];
-	char m_aCommunityType[MAX_COMMUNITY_TYPE_LENGTH];
+	// interned, see CServerInfoArena
+	const char *m_pCommunityId = "";
+	const char *m_pCommunityCountry = "";
+	const char *m_pCommunityType = "";
 	int m_Location;
 	bool m_LatencyIsEstimated;
 	int m_Latency; // in ms
 	ERankState m_HasRank;
-	char m_aGameType[16];
+	const char *m_pGameType = ""; // interned
 	char m_aName[64];
-	char m_aMap[MAX_MAP_LENGTH];
+	const char *m_pMap = ""; // interned
 	int m_MapCrc;
 	int m_MapSize;
 	char m_aVersion[32];
 	char m_aAddress[MAX_SERVER_ADDRESSES * NETADDR_MAXSTRSIZE];
-	CClient m_aClients[SERVERINFO_MAX_CLIENTS];
+	// m_NumReceivedClients clients, at most SERVERINFO_MAX_CLIENTS
+	CClient *m_pClients = nullptr;
 	int m_NumFilteredPlayers;
 	bool m_RequiresLogin;
 
@@ -4,8 +4,28 @@
 
 #include "compression.h"
 
+#include <cstdint>
 #include <iterator> // std::size
 
+// Runs of ints that fit into a single byte are handled in blocks, which the
+// compiler can turn into vector code. Snapshot deltas mostly consist of them.
+static constexpr int BLOCK_SIZE = 8;
+
+static inline bool IsSingleByteBlock(const unsigned char *pSrc)
+{
+	uint64_t Block;
+	mem_copy(&Block, pSrc, sizeof(Block));
+	return (Block & 0x8080808080808080ull) == 0;
+}
+
+static inline bool IsSingleByteBlock(const int *pSrc)
+{
+	unsigned Large = 0;
+	for(int i = 0; i < BLOCK_SIZE; i++)
+		Large |= ((unsigned)pSrc[i] + 64) & ~0x7Fu;
+	return Large == 0;
+}
+
 // Format: ESDDDDDD EDDDDDDD EDD... Extended, Data, Sign
 unsigned char *CVariableInt::Pack(unsigned char *pDst, int i, int DstSize)
 {
@@ -75,12 +95,27 @@ long CVariableInt::Decompress(const void *pSrc_, int SrcSize, void *pDst_, int D
 	const int *pDstEnd = pDst + DstSize / sizeof(int);
 	while(pSrc < pSrcEnd)
 	{
-		if(pDst >= pDstEnd)
-			return -1;
-		pSrc = CVariableInt::Unpack(pSrc, pDst, pSrcEnd - pSrc);
-		if(!pSrc)
-			return -1;
-		pDst++;
+		while(pSrcEnd - pSrc >= BLOCK_SIZE && pDstEnd - pDst >= BLOCK_SIZE && IsSingleByteBlock(pSrc))
+		{
+			for(int i = 0; i < BLOCK_SIZE; i++)
+			{
+				const int Sign = (pSrc[i] >> 6) & 1;
+				pDst[i] = (pSrc[i] & 0x3F) ^ -Sign;
+			}
+			pSrc += BLOCK_SIZE;
+			pDst += BLOCK_SIZE;
+		}
+		// unpack a whole block one by one, so mixed data is not checked
+		// for single byte runs after every int
+		for(int i = 0; i < BLOCK_SIZE && pSrc < pSrcEnd; i++)
+		{
+			if(pDst >= pDstEnd)
+				return -1;
+			pSrc = CVariableInt::Unpack(pSrc, pDst, pSrcEnd - pSrc);
+			if(!pSrc)
+				return -1;
+			pDst++;
+		}
 	}
 	return (long)((unsigned char *)pDst - (unsigned char *)pDst_);
 }
@@ -95,11 +130,25 @@ long CVariableInt::Compress(const void *pSrc_, int SrcSize, void *pDst_, int Dst
 	SrcSize /= sizeof(int);
 	while(SrcSize)
 	{
-		pDst = CVariableInt::Pack(pDst, *pSrc, pDstEnd - pDst);
-		if(!pDst)
-			return -1;
-		SrcSize--;
-		pSrc++;
+		while(SrcSize >= BLOCK_SIZE && pDstEnd - pDst >= BLOCK_SIZE && IsSingleByteBlock(pSrc))
+		{
+			for(int i = 0; i < BLOCK_SIZE; i++)
+			{
+				const int Sign = pSrc[i] >> 31;
+				pDst[i] = (Sign & 0x40) | ((pSrc[i] ^ Sign) & 0x3F);
+			}
+			SrcSize -= BLOCK_SIZE;
+			pSrc += BLOCK_SIZE;
+			pDst += BLOCK_SIZE;
+		}
+		for(int i = 0; i < BLOCK_SIZE && SrcSize; i++)
+		{
+			pDst = CVariableInt::Pack(pDst, *pSrc, pDstEnd - pDst);
+			if(!pDst)
+				return -1;
+			SrcSize--;
+			pSrc++;
+		}
 	}
 	return (long)(pDst - (unsigned char *)pDst_);
 }
@@ -1,13 +1,18 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/lock.h>
 #include <base/math.h>
 #include <base/system.h>
+#include <base/tl/threading.h>
 
 #include <engine/console.h>
 #include <engine/storage.h>
 
 #include <engine/shared/config.h>
 
+#include <condition_variable>
+#include <mutex>
+
 #if defined(CONF_VIDEORECORDER)
 #include <engine/shared/video.h>
 #endif
@@ -39,6 +44,288 @@ bool CDemoHeader::Valid() const
 	       mem_has_null(m_aTimestamp, sizeof(m_aTimestamp)) && str_utf8_check(m_aTimestamp);
 }
 
+/*
+	Tickmarker
+		7	= Always set
+		6	= Keyframe flag
+		0-5	= Delta tick
+
+	Normal
+		7 = Not set
+		5-6	= Type
+		0-4	= Size
+*/
+
+enum
+{
+	CHUNKTYPEFLAG_TICKMARKER = 0x80,
+	CHUNKTICKFLAG_KEYFRAME = 0x40, // only when tickmarker is set
+	CHUNKTICKFLAG_TICK_COMPRESSED = 0x20, // when we store the tick value in the first chunk
+
+	CHUNKMASK_TICK = 0x1f,
+	CHUNKMASK_TICK_LEGACY = 0x3f,
+	CHUNKMASK_TYPE = 0x60,
+	CHUNKMASK_SIZE = 0x1f,
+
+	CHUNKTYPE_SNAPSHOT = 1,
+	CHUNKTYPE_MESSAGE = 2,
+	CHUNKTYPE_DELTA = 3,
+};
+
+enum
+{
+	MAX_CHUNK_DATA_SIZE = 64 * 1024,
+	MAX_CHUNK_HEADER_SIZE = 3,
+	MAX_TICKMARKER_SIZE = sizeof(int32_t) + 1,
+};
+
+// Compresses the chunk data and prepends the chunk header, returns the
+// number of bytes written to pOut or -1 on failure.
+static int EncodeChunk(int Type, const void *pData, int Size, unsigned char *pOut)
+{
+	if(Size > MAX_CHUNK_DATA_SIZE)
+		return -1;
+
+	/* pad the data with 0 so we get an alignment of 4,
+	else the compression won't work and miss some bytes */
+	char aBuffer[MAX_CHUNK_DATA_SIZE];
+	char aBuffer2[MAX_CHUNK_DATA_SIZE];
+	mem_copy(aBuffer2, pData, Size);
+	while(Size & 3)
+		aBuffer2[Size++] = 0;
+	Size = CVariableInt::Compress(aBuffer2, Size, aBuffer, sizeof(aBuffer)); // buffer2 -> buffer
+	if(Size < 0)
+		return -1;
+
+	unsigned char *pCompressed = pOut + MAX_CHUNK_HEADER_SIZE;
+	Size = CNetBase::Compress(aBuffer, Size, pCompressed, MAX_CHUNK_DATA_SIZE); // buffer -> out
+	if(Size < 0)
+		return -1;
+
+	unsigned char aChunk[MAX_CHUNK_HEADER_SIZE];
+	int HeaderSize;
+	aChunk[0] = ((Type & 0x3) << 5);
+	if(Size < 30)
+	{
+		aChunk[0] |= Size;
+		HeaderSize = 1;
+	}
+	else
+	{
+		if(Size < 256)
+		{
+			aChunk[0] |= 30;
+			aChunk[1] = Size & 0xff;
+			HeaderSize = 2;
+		}
+		else
+		{
+			aChunk[0] |= 31;
+			aChunk[1] = Size & 0xff;
+			aChunk[2] = Size >> 8;
+			HeaderSize = 3;
+		}
+	}
+
+	// move the header right in front of the compressed data
+	unsigned char *pStart = pCompressed - HeaderSize;
+	mem_copy(pStart, aChunk, HeaderSize);
+	if(pStart != pOut)
+		mem_move(pOut, pStart, HeaderSize + Size);
+	return HeaderSize + Size;
+}
+
+// the state of one asynchronous recording on the writer thread
+class CDemoRecorder::CAsyncStream
+{
+public:
+	CAsyncStream(IOHANDLE File, const CSnapshotDelta *pSnapshotDelta) :
+		m_File(File), m_SnapshotDelta(*pSnapshotDelta)
+	{
+		m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, true);
+		m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, true);
+	}
+
+	IOHANDLE m_File;
+	CSnapshotDelta m_SnapshotDelta;
+	unsigned char m_aLastSnapshotData[CSnapshot::MAX_SIZE];
+	// signaled by the writer thread once all chunks of the stream are written
+	CSemaphore m_Stopped;
+};
+
+// One thread writes the demos of all recorders that record asynchronously.
+// It is started with the first of them and exits after the last one stopped.
+class CDemoRecorder::CWriter
+{
+public:
+	enum
+	{
+		QUEUE_SIZE = 1024,
+	};
+
+	enum
+	{
+		ITEM_SNAPSHOT,
+		ITEM_DELTA,
+		ITEM_MESSAGE,
+		ITEM_STOP,
+		ITEM_EXIT,
+	};
+
+	static CWriter *Acquire()
+	{
+		const CLockScope LockScope(ms_Lock);
+		if(ms_NumUsers++ == 0)
+			ms_pWriter = new CWriter();
+		return ms_pWriter;
+	}
+
+	static void Release()
+	{
+		const CLockScope LockScope(ms_Lock);
+		if(--ms_NumUsers == 0)
+		{
+			ms_pWriter->Reserve(std::chrono::nanoseconds(-1));
+			ms_pWriter->Push(nullptr, ITEM_EXIT, nullptr, 0, nullptr, 0);
+			thread_wait(ms_pWriter->m_pThread);
+			delete ms_pWriter;
+			ms_pWriter = nullptr;
+		}
+	}
+
+	// Reserves a queue slot for the next Push. Waits at most MaxWait for the
+	// writer to free one while the queue is full, forever if it's negative.
+	bool Reserve(std::chrono::nanoseconds MaxWait)
+	{
+		std::unique_lock<std::mutex> Lock(m_FreeMutex);
+		const auto HasFree = [this]() { return m_NumFree > 0; };
+		if(MaxWait < std::chrono::nanoseconds(0))
+			m_FreeCond.wait(Lock, HasFree);
+		else if(!m_FreeCond.wait_for(Lock, MaxWait, HasFree))
+			return false;
+		m_NumFree--;
+		return true;
+	}
+
+	// needs a slot from Reserve
+	void Push(CAsyncStream *pStream, int Type, const unsigned char *pTickMarker, int TickMarkerSize, const void *pData, int Size)
+	{
+		{
+			const CLockScope LockScope(m_InsertLock);
+			CItem &Item = m_aItems[m_InsertIndex];
+			Item.m_pStream = pStream;
+			Item.m_Type = Type;
+			mem_copy(Item.m_aTickMarker, pTickMarker, TickMarkerSize);
+			Item.m_TickMarkerSize = TickMarkerSize;
+			Item.m_vData.assign((const unsigned char *)pData, (const unsigned char *)pData + Size);
+			m_InsertIndex = (m_InsertIndex + 1) % QUEUE_SIZE;
+		}
+		m_NumQueued.Signal();
+	}
+
+	// Waits until all queued chunks of the stream are written.
+	void Stop(CAsyncStream *pStream)
+	{
+		Reserve(std::chrono::nanoseconds(-1));
+		Push(pStream, ITEM_STOP, nullptr, 0, nullptr, 0);
+		pStream->m_Stopped.Wait();
+	}
+
+private:
+	struct CItem
+	{
+		CAsyncStream *m_pStream;
+		int m_Type;
+		unsigned char m_aTickMarker[MAX_TICKMARKER_SIZE];
+		int m_TickMarkerSize;
+		std::vector<unsigned char> m_vData;
+	};
+
+	static CLock ms_Lock;
+	static CWriter *ms_pWriter;
+	static int ms_NumUsers;
+
+	unsigned char m_aOutput[MAX_TICKMARKER_SIZE + MAX_CHUNK_HEADER_SIZE + MAX_CHUNK_DATA_SIZE];
+
+	// multiple producers, single consumer queue
+	CItem m_aItems[QUEUE_SIZE];
+	CLock m_InsertLock;
+	int m_InsertIndex = 0;
+	int m_ProcessIndex = 0;
+	CSemaphore m_NumQueued;
+	std::mutex m_FreeMutex;
+	std::condition_variable m_FreeCond;
+	int m_NumFree = QUEUE_SIZE;
+	void *m_pThread;
+
+	CWriter()
+	{
+		m_pThread = thread_init(ThreadMain, this, "demo writer");
+	}
+
+	static void ThreadMain(void *pUser)
+	{
+		CWriter *pThis = static_cast<CWriter *>(pUser);
+		while(true)
+		{
+			pThis->m_NumQueued.Wait();
+			CItem &Item = pThis->m_aItems[pThis->m_ProcessIndex];
+			const int Type = Item.m_Type;
+			CAsyncStream *pStream = Item.m_pStream;
+			if(Type != ITEM_STOP && Type != ITEM_EXIT)
+				pThis->Process(Item);
+			pThis->m_ProcessIndex = (pThis->m_ProcessIndex + 1) % QUEUE_SIZE;
+			{
+				const std::unique_lock<std::mutex> Lock(pThis->m_FreeMutex);
+				pThis->m_NumFree++;
+			}
+			pThis->m_FreeCond.notify_one();
+			if(Type == ITEM_STOP)
+				pStream->m_Stopped.Signal();
+			else if(Type == ITEM_EXIT)
+				break;
+		}
+	}
+
+	void Process(const CItem &Item)
+	{
+		CAsyncStream *pStream = Item.m_pStream;
+		mem_copy(m_aOutput, Item.m_aTickMarker, Item.m_TickMarkerSize);
+		int OutputSize = Item.m_TickMarkerSize;
+		const int Size = Item.m_vData.size();
+
+		int ChunkSize = 0;
+		if(Item.m_Type == ITEM_SNAPSHOT)
+		{
+			ChunkSize = EncodeChunk(CHUNKTYPE_SNAPSHOT, Item.m_vData.data(), Size, m_aOutput + OutputSize);
+			mem_copy(pStream->m_aLastSnapshotData, Item.m_vData.data(), Size);
+		}
+		else if(Item.m_Type == ITEM_DELTA)
+		{
+			char aDeltaData[CSnapshot::MAX_SIZE + sizeof(int)];
+			const int DeltaSize = pStream->m_SnapshotDelta.CreateDelta((CSnapshot *)pStream->m_aLastSnapshotData, (const CSnapshot *)Item.m_vData.data(), &aDeltaData);
+			if(DeltaSize)
+			{
+				ChunkSize = EncodeChunk(CHUNKTYPE_DELTA, aDeltaData, DeltaSize, m_aOutput + OutputSize);
+				mem_copy(pStream->m_aLastSnapshotData, Item.m_vData.data(), Size);
+			}
+		}
+		else
+		{
+			ChunkSize = EncodeChunk(CHUNKTYPE_MESSAGE, Item.m_vData.data(), Size, m_aOutput + OutputSize);
+		}
+
+		if(ChunkSize > 0)
+			OutputSize += ChunkSize;
+		if(OutputSize > 0)
+			io_write(pStream->m_File, m_aOutput, OutputSize);
+	}
+};
+
+CLock CDemoRecorder::CWriter::ms_Lock;
+CDemoRecorder::CWriter *CDemoRecorder::CWriter::ms_pWriter = nullptr;
+int CDemoRecorder::CWriter::ms_NumUsers = 0;
+
 CDemoRecorder::CDemoRecorder(class CSnapshotDelta *pSnapshotDelta, bool NoMapData)
 {
 	m_File = 0;
@@ -50,13 +337,17 @@ CDemoRecorder::CDemoRecorder(class CSnapshotDelta *pSnapshotDelta, bool NoMapDat
 	m_NoMapData = NoMapData;
 }
 
+CDemoRecorder::CDemoRecorder() = default;
+CDemoRecorder::CDemoRecorder(CDemoRecorder &&Other) = default;
+CDemoRecorder &CDemoRecorder::operator=(CDemoRecorder &&Other) = default;
+
 CDemoRecorder::~CDemoRecorder()
 {
 	dbg_assert(m_File == 0, "Demo recorder was not stopped");
 }
 
 // Record
-int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, const char *pNetVersion, const char *pMap, const SHA256_DIGEST &Sha256, unsigned Crc, const char *pType, unsigned MapSize, unsigned char *pMapData, IOHANDLE MapFile, DEMOFUNC_FILTER pfnFilter, void *pUser)
+int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, const char *pNetVersion, const char *pMap, const SHA256_DIGEST &Sha256, unsigned Crc, const char *pType, unsigned MapSize, unsigned char *pMapData, IOHANDLE MapFile, DEMOFUNC_FILTER pfnFilter, void *pUser, bool AsyncWrite)
 {
 	dbg_assert(m_File == 0, "Demo recorder already recording");
 
@@ -210,60 +501,47 @@ int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, con
 	m_File = DemoFile;
 	str_copy(m_aCurrentFilename, pFilename);
 
+	m_NumDroppedSnapshots = 0;
+	m_WriterWait = std::chrono::nanoseconds(0);
+	if(AsyncWrite)
+	{
+		m_pAsyncStream = std::make_unique<CAsyncStream>(m_File, m_pSnapshotDelta);
+		m_pWriter = CWriter::Acquire();
+	}
+
 	return 0;
 }
 
-/*
-	Tickmarker
-		7	= Always set
-		6	= Keyframe flag
-		0-5	= Delta tick
-
-	Normal
-		7 = Not set
-		5-6	= Type
-		0-4	= Size
-*/
-
-enum
-{
-	CHUNKTYPEFLAG_TICKMARKER = 0x80,
-	CHUNKTICKFLAG_KEYFRAME = 0x40, // only when tickmarker is set
-	CHUNKTICKFLAG_TICK_COMPRESSED = 0x20, // when we store the tick value in the first chunk
-
-	CHUNKMASK_TICK = 0x1f,
-	CHUNKMASK_TICK_LEGACY = 0x3f,
-	CHUNKMASK_TYPE = 0x60,
-	CHUNKMASK_SIZE = 0x1f,
-
-	CHUNKTYPE_SNAPSHOT = 1,
-	CHUNKTYPE_MESSAGE = 2,
-	CHUNKTYPE_DELTA = 3,
-};
-
-void CDemoRecorder::WriteTickMarker(int Tick, bool Keyframe)
+int CDemoRecorder::MakeTickMarker(int Tick, bool Keyframe, unsigned char *pChunk)
 {
+	int Size;
 	if(m_LastTickMarker == -1 || Tick - m_LastTickMarker > CHUNKMASK_TICK || Keyframe)
 	{
-		unsigned char aChunk[sizeof(int32_t) + 1];
-		aChunk[0] = CHUNKTYPEFLAG_TICKMARKER;
-		uint_to_bytes_be(aChunk + 1, Tick);
+		pChunk[0] = CHUNKTYPEFLAG_TICKMARKER;
+		uint_to_bytes_be(pChunk + 1, Tick);
 
 		if(Keyframe)
-			aChunk[0] |= CHUNKTICKFLAG_KEYFRAME;
+			pChunk[0] |= CHUNKTICKFLAG_KEYFRAME;
 
-		io_write(m_File, aChunk, sizeof(aChunk));
+		Size = sizeof(int32_t) + 1;
 	}
 	else
 	{
-		unsigned char aChunk[1];
-		aChunk[0] = CHUNKTYPEFLAG_TICKMARKER | CHUNKTICKFLAG_TICK_COMPRESSED | (Tick - m_LastTickMarker);
-		io_write(m_File, aChunk, sizeof(aChunk));
+		pChunk[0] = CHUNKTYPEFLAG_TICKMARKER | CHUNKTICKFLAG_TICK_COMPRESSED | (Tick - m_LastTickMarker);
+		Size = 1;
 	}
 
 	m_LastTickMarker = Tick;
 	if(m_FirstTick < 0)
 		m_FirstTick = Tick;
+	return Size;
+}
+
+void CDemoRecorder::WriteTickMarker(int Tick, bool Keyframe)
+{
+	unsigned char aChunk[MAX_TICKMARKER_SIZE];
+	const int Size = MakeTickMarker(Tick, Keyframe, aChunk);
+	io_write(m_File, aChunk, Size);
 }
 
 void CDemoRecorder::Write(int Type, const void *pData, int Size)
@@ -271,54 +549,45 @@ void CDemoRecorder::Write(int Type, const void *pData, int Size)
 	if(!m_File)
 		return;
 
-	if(Size > 64 * 1024)
-		return;
-
-	/* pad the data with 0 so we get an alignment of 4,
-	else the compression won't work and miss some bytes */
-	char aBuffer[64 * 1024];
-	char aBuffer2[64 * 1024];
-	mem_copy(aBuffer2, pData, Size);
-	while(Size & 3)
-		aBuffer2[Size++] = 0;
-	Size = CVariableInt::Compress(aBuffer2, Size, aBuffer, sizeof(aBuffer)); // buffer2 -> buffer
+	unsigned char aChunk[MAX_CHUNK_HEADER_SIZE + MAX_CHUNK_DATA_SIZE];
+	Size = EncodeChunk(Type, pData, Size, aChunk);
 	if(Size < 0)
 		return;
 
-	Size = CNetBase::Compress(aBuffer, Size, aBuffer2, sizeof(aBuffer2)); // buffer -> buffer2
-	if(Size < 0)
-		return;
+	io_write(m_File, aChunk, Size);
+}
 
-	unsigned char aChunk[3];
-	aChunk[0] = ((Type & 0x3) << 5);
-	if(Size < 30)
-	{
-		aChunk[0] |= Size;
-		io_write(m_File, aChunk, 1);
-	}
-	else
+bool CDemoRecorder::ReserveWriterSlot(std::chrono::nanoseconds MaxWait)
+{
+	const std::chrono::nanoseconds Start = time_get_nanoseconds();
+	const bool Reserved = m_pWriter->Reserve(MaxWait);
+	m_WriterWait += time_get_nanoseconds() - Start;
+	return Reserved;
+}
+
+void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
+{
+	const bool Keyframe = m_LastKeyFrame == -1 || (Tick - m_LastKeyFrame) > SERVER_TICK_SPEED * 5;
+	if(m_pWriter)
 	{
-		if(Size < 256)
-		{
-			aChunk[0] |= 30;
-			aChunk[1] = Size & 0xff;
-			io_write(m_File, aChunk, 2);
-		}
-		else
+		// Keyframes wait for the writer. Delta snapshots wait at most
+		// m_MaxSnapshotWait and are dropped after that, which doesn't break
+		// the demo as the next delta is created against the last written
+		// snapshot.
+		if(!ReserveWriterSlot(Keyframe ? std::chrono::nanoseconds(-1) : m_MaxSnapshotWait))
 		{
-			aChunk[0] |= 31;
-			aChunk[1] = Size & 0xff;
-			aChunk[2] = Size >> 8;
-			io_write(m_File, aChunk, 3);
+			m_NumDroppedSnapshots++;
+			return;
 		}
+		unsigned char aTickMarker[MAX_TICKMARKER_SIZE];
+		const int TickMarkerSize = MakeTickMarker(Tick, Keyframe, aTickMarker);
+		m_pWriter->Push(m_pAsyncStream.get(), Keyframe ? CWriter::ITEM_SNAPSHOT : CWriter::ITEM_DELTA, aTickMarker, TickMarkerSize, pData, Size);
+		if(Keyframe)
+			m_LastKeyFrame = Tick;
+		return;
 	}
 
-	io_write(m_File, aBuffer2, Size);
-}
-
-void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
-{
-	if(m_LastKeyFrame == -1 || (Tick - m_LastKeyFrame) > SERVER_TICK_SPEED * 5)
+	if(Keyframe)
 	{
 		// write full tickmarker
 		WriteTickMarker(Tick, true);
@@ -357,6 +626,12 @@ void CDemoRecorder::RecordMessage(const void *pData, int Size)
 			return;
 		}
 	}
+	if(m_pWriter)
+	{
+		ReserveWriterSlot(std::chrono::nanoseconds(-1));
+		m_pWriter->Push(m_pAsyncStream.get(), CWriter::ITEM_MESSAGE, nullptr, 0, pData, Size);
+		return;
+	}
 	Write(CHUNKTYPE_MESSAGE, pData, Size);
 }
 
@@ -365,6 +640,20 @@ int CDemoRecorder::Stop(IDemoRecorder::EStopMode Mode, const char *pTargetFilena
 	if(!m_File)
 		return -1;
 
+	if(m_pWriter)
+	{
+		m_pWriter->Stop(m_pAsyncStream.get());
+		CWriter::Release();
+		m_pWriter = nullptr;
+		m_pAsyncStream = nullptr;
+		if((m_NumDroppedSnapshots > 0 || m_WriterWait > std::chrono::milliseconds(1)) && m_pConsole)
+		{
+			char aBuf[128 + IO_MAX_PATH_LENGTH];
+			str_format(aBuf, sizeof(aBuf), "Dropped %d snapshots and waited %.3fms for the demo writer while recording to '%s'", m_NumDroppedSnapshots, m_WriterWait.count() / 1000000.0, m_aCurrentFilename);
+			m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_recorder", aBuf, gs_DemoPrintColor);
+		}
+	}
+
 	if(Mode == IDemoRecorder::EStopMode::KEEP_FILE)
 	{
 		// add the demo length to the header
@@ -8,7 +8,9 @@
 #include <engine/demo.h>
 #include <engine/shared/protocol.h>
 
+#include <chrono>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include "snapshot.h"
@@ -37,15 +39,39 @@ class CDemoRecorder : public IDemoRecorder
 	DEMOFUNC_FILTER m_pfnFilter;
 	void *m_pUser;
 
+	// The writer thread shared by all asynchronous recordings does the delta,
+	// compression and file writes, nullptr when writing on the calling thread.
+	class CWriter;
+	class CAsyncStream;
+	CWriter *m_pWriter = nullptr;
+	std::unique_ptr<CAsyncStream> m_pAsyncStream;
+	std::chrono::nanoseconds m_MaxSnapshotWait = std::chrono::nanoseconds(0);
+	int m_NumDroppedSnapshots = 0;
+	std::chrono::nanoseconds m_WriterWait = std::chrono::nanoseconds(0);
+
+	bool ReserveWriterSlot(std::chrono::nanoseconds MaxWait);
+
+	int MakeTickMarker(int Tick, bool Keyframe, unsigned char *pChunk);
 	void WriteTickMarker(int Tick, bool Keyframe);
 	void Write(int Type, const void *pData, int Size);
 
 public:
 	CDemoRecorder(class CSnapshotDelta *pSnapshotDelta, bool NoMapData = false);
-	CDemoRecorder() {}
+	CDemoRecorder();
+	CDemoRecorder(CDemoRecorder &&Other);
+	CDemoRecorder &operator=(CDemoRecorder &&Other);
 	~CDemoRecorder() override;
 
-	int Start(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, const char *pNetversion, const char *pMap, const SHA256_DIGEST &Sha256, unsigned MapCrc, const char *pType, unsigned MapSize, unsigned char *pMapData, IOHANDLE MapFile, DEMOFUNC_FILTER pfnFilter, void *pUser);
+	/**
+	 * Starts recording a demo.
+	 *
+	 * @param AsyncWrite Only queue snapshots and messages and create, compress
+	 *                   and write the chunks on the demo writer thread. While the
+	 *                   writer is too far behind, delta snapshots are dropped
+	 *                   after waiting at most the time set with
+	 *                   SetMaxSnapshotWait, keyframes and messages wait.
+	 */
+	int Start(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, const char *pNetversion, const char *pMap, const SHA256_DIGEST &Sha256, unsigned MapCrc, const char *pType, unsigned MapSize, unsigned char *pMapData, IOHANDLE MapFile, DEMOFUNC_FILTER pfnFilter, void *pUser, bool AsyncWrite = false);
 	int Stop(IDemoRecorder::EStopMode Mode, const char *pTargetFilename = "") override;
 
 	void AddDemoMarker();
@@ -58,6 +84,12 @@ public:
 	const char *CurrentFilename() const override { return m_aCurrentFilename; }
 
 	int Length() const override { return (m_LastTickMarker - m_FirstTick) / SERVER_TICK_SPEED; }
+
+	// negative to never drop delta snapshots, 0 by default
+	void SetMaxSnapshotWait(std::chrono::nanoseconds MaxWait) { m_MaxSnapshotWait = MaxWait; }
+	int NumDroppedSnapshots() const { return m_NumDroppedSnapshots; }
+	// time spent waiting for the demo writer
+	std::chrono::nanoseconds WriterWait() const { return m_WriterWait; }
 };
 
 class CDemoPlayer : public IDemoPlayer
@@ -270,7 +270,12 @@ size_t CHttpRequest::OnData(char *pData, size_t DataSize)
 
 	sha256_update(&m_ActualSha256Ctx, pData, DataSize);
 
-	if(!m_WriteToFile)
+	if(m_StreamResponse)
+	{
+		m_ResponseLength += DataSize;
+		return OnResponseData((const unsigned char *)pData, DataSize) ? DataSize : 0;
+	}
+	else if(!m_WriteToFile)
 	{
 		if(DataSize == 0)
 		{
@@ -422,6 +427,7 @@ void CHttpRequest::Result(unsigned char **ppResult, size_t *pResultLength) const
 {
 	dbg_assert(State() == EHttpState::DONE, "Request not done");
 	dbg_assert(!m_WriteToFile, "Result not usable together with WriteToFile");
+	dbg_assert(!m_StreamResponse, "Result not usable together with StreamResponse");
 	*ppResult = m_pBuffer;
 	*pResultLength = m_ResponseLength;
 }
@@ -94,10 +94,11 @@ class CHttpRequest : public IHttpRequest
 	SHA256_DIGEST m_ExpectedSha256 = SHA256_ZEROED;
 
 	bool m_WriteToFile = false;
+	bool m_StreamResponse = false;
 
 	uint64_t m_ResponseLength = 0;
 
-	// If `m_WriteToFile` is false.
+	// If `m_WriteToFile` and `m_StreamResponse` are false.
 	size_t m_BufferSize = 0;
 	unsigned char *m_pBuffer = nullptr;
 
@@ -146,6 +147,11 @@ protected:
 	// These run on the curl thread now, DO NOT STALL THE THREAD
 	virtual void OnProgress() {}
 	virtual void OnCompletion(EHttpState State) {}
+	// Only called if `StreamResponse()` was set, receives the response body
+	// in chunks instead of buffering it. Abort the request by returning false.
+	virtual bool OnResponseData(const unsigned char *pData, size_t DataSize) { return true; }
+
+	void StreamResponse() { m_StreamResponse = true; }
 
 public:
 	CHttpRequest(const char *pUrl);
@@ -0,0 +1,311 @@
+#include "jsonstream.h"
+
+#include <base/system.h>
+
+static bool IsDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+CJsonStreamParser::CJsonStreamParser(IJsonStreamHandler *pHandler, int MaxDepth) :
+	m_pHandler(pHandler),
+	m_MaxDepth(MaxDepth)
+{
+}
+
+bool CJsonStreamParser::Fail(const char *pReason)
+{
+	if(!Failed())
+		str_format(m_aError, sizeof(m_aError), "%s at offset %" PRIu64, pReason, m_Offset);
+	return false;
+}
+
+bool CJsonStreamParser::Emit(EJsonEvent Event, uint64_t Offset)
+{
+	bool Continue;
+	if(Event == EJsonEvent::KEY || Event == EJsonEvent::STRING || Event == EJsonEvent::NUMBER)
+		Continue = m_pHandler->OnJsonEvent(Event, m_Token.c_str(), m_Token.size(), Offset);
+	else
+		Continue = m_pHandler->OnJsonEvent(Event, "", 0, Offset);
+	if(!Continue)
+		return Fail("stopped by handler");
+	return true;
+}
+
+bool CJsonStreamParser::BeginValue(char c)
+{
+	m_TokenOffset = m_Offset;
+	if(c == '{' || c == '[')
+	{
+		if((int)m_vContainers.size() >= m_MaxDepth)
+			return Fail("nesting too deep");
+		m_vContainers.push_back(c);
+		m_State = c == '{' ? STATE_KEY_OR_END : STATE_VALUE_OR_END;
+		return Emit(c == '{' ? EJsonEvent::BEGIN_OBJECT : EJsonEvent::BEGIN_ARRAY, m_TokenOffset);
+	}
+	else if(c == '"')
+	{
+		m_Token.clear();
+		m_StringIsKey = false;
+		m_State = STATE_STRING;
+		return true;
+	}
+	else if(c == '-' || IsDigit(c))
+	{
+		m_Token.assign(1, c);
+		m_State = STATE_NUMBER;
+		return true;
+	}
+	else if(c == 't' || c == 'f' || c == 'n')
+	{
+		m_pLiteral = c == 't' ? "true" : c == 'f' ? "false" : "null";
+		m_LiteralEvent = c == 't' ? EJsonEvent::BOOL_TRUE : c == 'f' ? EJsonEvent::BOOL_FALSE : EJsonEvent::NULL_VALUE;
+		m_LiteralLength = 1;
+		m_State = STATE_LITERAL;
+		return true;
+	}
+	return Fail("unexpected character");
+}
+
+bool CJsonStreamParser::EndValue()
+{
+	m_State = m_vContainers.empty() ? STATE_DONE : STATE_COMMA_OR_END;
+	return true;
+}
+
+bool CJsonStreamParser::EndContainer(char c)
+{
+	if(m_vContainers.empty() || (m_vContainers.back() == '{') != (c == '}'))
+		return Fail("mismatched bracket");
+	m_vContainers.pop_back();
+	if(!Emit(c == '}' ? EJsonEvent::END_OBJECT : EJsonEvent::END_ARRAY, m_Offset))
+		return false;
+	return EndValue();
+}
+
+bool CJsonStreamParser::EndNumber()
+{
+	// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+	const char *p = m_Token.c_str();
+	if(*p == '-')
+		p++;
+	if(*p == '0')
+		p++;
+	else if(IsDigit(*p))
+		while(IsDigit(*p))
+			p++;
+	else
+		return Fail("invalid number");
+	if(*p == '.')
+	{
+		p++;
+		if(!IsDigit(*p))
+			return Fail("invalid number");
+		while(IsDigit(*p))
+			p++;
+	}
+	if(*p == 'e' || *p == 'E')
+	{
+		p++;
+		if(*p == '+' || *p == '-')
+			p++;
+		if(!IsDigit(*p))
+			return Fail("invalid number");
+		while(IsDigit(*p))
+			p++;
+	}
+	if(*p != '\0')
+		return Fail("invalid number");
+	if(!Emit(EJsonEvent::NUMBER, m_TokenOffset))
+		return false;
+	return EndValue();
+}
+
+bool CJsonStreamParser::AppendCodeUnit(int Code)
+{
+	// UTF-16 surrogates must come in pairs
+	const bool High = Code >= 0xD800 && Code <= 0xDBFF;
+	const bool Low = Code >= 0xDC00 && Code <= 0xDFFF;
+	if(m_HighSurrogate)
+	{
+		if(!Low)
+			return Fail("lone surrogate");
+		Code = 0x10000 + ((m_HighSurrogate - 0xD800) << 10) + (Code - 0xDC00);
+		m_HighSurrogate = 0;
+	}
+	else if(High)
+	{
+		m_HighSurrogate = Code;
+		return true;
+	}
+	else if(Low)
+		return Fail("lone surrogate");
+	char aBuf[4];
+	m_Token.append(aBuf, str_utf8_encode(aBuf, Code));
+	return true;
+}
+
+bool CJsonStreamParser::Feed(const char *pData, size_t DataSize)
+{
+	if(Failed())
+		return false;
+
+	size_t i = 0;
+	while(i < DataSize)
+	{
+		const char c = pData[i];
+		switch(m_State)
+		{
+		case STATE_STRING:
+			if(m_HighSurrogate && c != '\\')
+				return Fail("lone surrogate");
+			if(c == '"')
+			{
+				if(m_StringIsKey)
+				{
+					if(!Emit(EJsonEvent::KEY, m_TokenOffset))
+						return false;
+					m_State = STATE_COLON;
+				}
+				else if(!Emit(EJsonEvent::STRING, m_TokenOffset) || !EndValue())
+					return false;
+			}
+			else if(c == '\\')
+				m_State = STATE_STRING_ESCAPE;
+			else if((unsigned char)c < 0x20)
+				return Fail("control character in string");
+			else
+				m_Token.push_back(c);
+			break;
+
+		case STATE_STRING_ESCAPE:
+			if(c == 'u')
+			{
+				m_UnicodeDigits = 0;
+				m_UnicodeValue = 0;
+				m_State = STATE_STRING_UNICODE;
+				break;
+			}
+			if(m_HighSurrogate)
+				return Fail("lone surrogate");
+			switch(c)
+			{
+			case '"':
+			case '\\':
+			case '/': m_Token.push_back(c); break;
+			case 'b': m_Token.push_back('\b'); break;
+			case 'f': m_Token.push_back('\f'); break;
+			case 'n': m_Token.push_back('\n'); break;
+			case 'r': m_Token.push_back('\r'); break;
+			case 't': m_Token.push_back('\t'); break;
+			default: return Fail("invalid escape sequence");
+			}
+			m_State = STATE_STRING;
+			break;
+
+		case STATE_STRING_UNICODE:
+		{
+			int Digit;
+			if(IsDigit(c))
+				Digit = c - '0';
+			else if(c >= 'a' && c <= 'f')
+				Digit = c - 'a' + 10;
+			else if(c >= 'A' && c <= 'F')
+				Digit = c - 'A' + 10;
+			else
+				return Fail("invalid unicode escape");
+			m_UnicodeValue = m_UnicodeValue * 16 + Digit;
+			if(++m_UnicodeDigits == 4)
+			{
+				if(!AppendCodeUnit(m_UnicodeValue))
+					return false;
+				m_State = STATE_STRING;
+			}
+			break;
+		}
+
+		case STATE_NUMBER:
+			if(IsDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')
+			{
+				m_Token.push_back(c);
+				break;
+			}
+			if(!EndNumber())
+				return false;
+			// the character after the number still needs to be handled
+			continue;
+
+		case STATE_LITERAL:
+			if(c != m_pLiteral[m_LiteralLength])
+				return Fail("invalid literal");
+			if(m_pLiteral[++m_LiteralLength] == '\0' && (!Emit(m_LiteralEvent, m_TokenOffset) || !EndValue()))
+				return false;
+			break;
+
+		default:
+			if(c == ' ' || c == '\t' || c == '\n' || c == '\r')
+				break;
+			switch(m_State)
+			{
+			case STATE_VALUE:
+				if(!BeginValue(c))
+					return false;
+				break;
+			case STATE_VALUE_OR_END:
+				if(!(c == ']' ? EndContainer(c) : BeginValue(c)))
+					return false;
+				break;
+			case STATE_KEY_OR_END:
+				if(c == '}')
+				{
+					if(!EndContainer(c))
+						return false;
+					break;
+				}
+				[[fallthrough]];
+			case STATE_KEY:
+				if(c != '"')
+					return Fail("expected key");
+				m_Token.clear();
+				m_TokenOffset = m_Offset;
+				m_StringIsKey = true;
+				m_State = STATE_STRING;
+				break;
+			case STATE_COLON:
+				if(c != ':')
+					return Fail("expected ':'");
+				m_State = STATE_VALUE;
+				break;
+			case STATE_COMMA_OR_END:
+				if(c == ',')
+					m_State = m_vContainers.back() == '{' ? STATE_KEY : STATE_VALUE;
+				else if(c == '}' || c == ']')
+				{
+					if(!EndContainer(c))
+						return false;
+				}
+				else
+					return Fail("expected ',' or end of container");
+				break;
+			case STATE_DONE:
+				return Fail("unexpected data after the end");
+			default:
+				dbg_assert(false, "invalid json stream parser state");
+			}
+		}
+		i++;
+		m_Offset++;
+	}
+	return true;
+}
+
+bool CJsonStreamParser::Finish()
+{
+	if(Failed())
+		return false;
+	if(m_State == STATE_NUMBER && !EndNumber())
+		return false;
+	if(m_State != STATE_DONE)
+		return Fail("unexpected end of input");
+	return true;
+}
@@ -0,0 +1,99 @@
+#ifndef ENGINE_SHARED_JSONSTREAM_H
+#define ENGINE_SHARED_JSONSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class EJsonEvent
+{
+	BEGIN_OBJECT,
+	END_OBJECT,
+	BEGIN_ARRAY,
+	END_ARRAY,
+	KEY,
+	STRING,
+	NUMBER,
+	BOOL_TRUE,
+	BOOL_FALSE,
+	NULL_VALUE,
+};
+
+class IJsonStreamHandler
+{
+public:
+	virtual ~IJsonStreamHandler() = default;
+
+	// `pValue` is the unescaped key or string or the text of a number and
+	// empty for all other events, it is zero-terminated but may contain
+	// zeros itself. `Offset` is the position of the first byte of the token
+	// in the whole input. Return false to stop parsing.
+	virtual bool OnJsonEvent(EJsonEvent Event, const char *pValue, size_t ValueLength, uint64_t Offset) = 0;
+};
+
+/**
+ * Incremental JSON parser that reports the document as a sequence of events
+ * instead of building a tree. The input can be split at any byte, so it can
+ * be fed while it is being received.
+ */
+class CJsonStreamParser
+{
+public:
+	CJsonStreamParser(IJsonStreamHandler *pHandler, int MaxDepth = 256);
+
+	// Returns false if the input is malformed or the handler stopped parsing.
+	bool Feed(const char *pData, size_t DataSize);
+	// Must be called after the last data. Returns false if the document is
+	// malformed or incomplete.
+	bool Finish();
+
+	bool Failed() const { return m_aError[0] != '\0'; }
+	const char *Error() const { return m_aError; }
+	uint64_t Offset() const { return m_Offset; }
+
+private:
+	enum EState
+	{
+		STATE_VALUE,
+		STATE_VALUE_OR_END,
+		STATE_KEY,
+		STATE_KEY_OR_END,
+		STATE_COLON,
+		STATE_COMMA_OR_END,
+		STATE_STRING,
+		STATE_STRING_ESCAPE,
+		STATE_STRING_UNICODE,
+		STATE_NUMBER,
+		STATE_LITERAL,
+		STATE_DONE,
+	};
+
+	IJsonStreamHandler *m_pHandler;
+	int m_MaxDepth;
+	EState m_State = STATE_VALUE;
+	std::vector<char> m_vContainers;
+	uint64_t m_Offset = 0;
+	char m_aError[128] = "";
+
+	// the token that is currently being read
+	std::string m_Token;
+	uint64_t m_TokenOffset = 0;
+	bool m_StringIsKey = false;
+	int m_UnicodeDigits = 0;
+	int m_UnicodeValue = 0;
+	int m_HighSurrogate = 0;
+	const char *m_pLiteral = nullptr;
+	EJsonEvent m_LiteralEvent = EJsonEvent::NULL_VALUE;
+	int m_LiteralLength = 0;
+
+	bool Fail(const char *pReason);
+	bool Emit(EJsonEvent Event, uint64_t Offset);
+	bool BeginValue(char c);
+	bool EndValue();
+	bool EndContainer(char c);
+	bool EndNumber();
+	bool AppendCodeUnit(int Code);
+};
+
+#endif
@@ -6,6 +6,8 @@
 
 #include "netban.h"
 
+#include <algorithm>
+
 CNetBan::CNetHash::CNetHash(const NETADDR *pAddr)
 {
 	if(pAddr->type == NETTYPE_IPV4)
@@ -110,6 +112,7 @@ typename CNetBan::CBan<T> *CNetBan::CBanPool<T, HashCount>::Add(const T *pData,
 
 	// update ban count
 	++m_CountUsed;
+	++m_Generation;
 
 	return pBan;
 }
@@ -146,6 +149,7 @@ int CNetBan::CBanPool<T, HashCount>::Remove(CBan<T> *pBan)
 
 	// update ban count
 	--m_CountUsed;
+	++m_Generation;
 
 	return 0;
 }
@@ -180,6 +184,7 @@ void CNetBan::CBanPool<T, HashCount>::Reset()
 	mem_zero(m_aBans, sizeof(m_aBans));
 	m_pFirstUsed = 0;
 	m_CountUsed = 0;
+	++m_Generation;
 
 	for(int i = 1; i < MAX_BANS - 1; ++i)
 	{
@@ -276,6 +281,9 @@ void CNetBan::Init(IConsole *pConsole, IStorage *pStorage)
 	m_pStorage = pStorage;
 	m_BanAddrPool.Reset();
 	m_BanRangePool.Reset();
+	m_RangeTable.Build(&m_BanRangePool);
+	m_RangeTableGeneration = m_BanRangePool.Generation();
+	mem_zero(m_aNegativeCache, sizeof(m_aNegativeCache));
 
 	net_host_lookup("localhost", &m_LocalhostIpV4, NETTYPE_IPV4);
 	net_host_lookup("localhost", &m_LocalhostIpV6, NETTYPE_IPV6);
@@ -369,7 +377,7 @@ int CNetBan::UnbanByIndex(int Index)
 	return Result;
 }
 
-bool CNetBan::IsBanned(const NETADDR *pOrigAddr, char *pBuf, unsigned BufferSize) const
+bool CNetBan::IsBanned(const NETADDR *pOrigAddr, char *pBuf, unsigned BufferSize)
 {
 	NETADDR Addr;
 	const NETADDR *pAddr = pOrigAddr;
@@ -379,31 +387,134 @@ bool CNetBan::IsBanned(const NETADDR *pOrigAddr, char *pBuf, unsigned BufferSize
 		pAddr = &Addr;
 		Addr.type = NETTYPE_IPV4;
 	}
-	CNetHash aHash[17];
-	int Length = CNetHash::MakeHashArray(pAddr, aHash);
+
+	// check recently seen addresses that were not banned
+	const unsigned Generation = NegativeCacheGeneration();
+	unsigned CacheHash = 2166136261u;
+	const int Length = pAddr->type == NETTYPE_IPV4 ? 4 : 16;
+	for(int i = 0; i < Length; i++)
+		CacheHash = (CacheHash ^ pAddr->ip[i]) * 16777619u;
+	CNegativeCacheEntry *pCacheEntry = &m_aNegativeCache[CacheHash % NEGATIVE_CACHE_SIZE];
+	if(pCacheEntry->m_Generation == Generation && NetComp(&pCacheEntry->m_Addr, pAddr) == 0)
+		return false;
 
 	// check ban addresses
-	CBanAddr *pBan = m_BanAddrPool.Find(pAddr, &aHash[Length]);
+	CNetHash NetHash(pAddr);
+	CBanAddr *pBan = m_BanAddrPool.Find(pAddr, &NetHash);
 	if(pBan)
 	{
 		MakeBanInfo(pBan, pBuf, BufferSize, MSGTYPE_PLAYER);
 		return true;
 	}
 
-	// check ban ranges
-	for(int i = Length - 1; i >= 0; --i)
+	// check ban ranges, the table is rebuilt on the first lookup after a
+	// change instead of on every change as ban lists are loaded one ban at a
+	// time
+	if(m_RangeTableGeneration != m_BanRangePool.Generation())
+	{
+		m_RangeTable.Build(&m_BanRangePool);
+		m_RangeTableGeneration = m_BanRangePool.Generation();
+	}
+	CBanRange *pBanRange = m_RangeTable.Find(pAddr);
+	if(pBanRange)
+	{
+		MakeBanInfo(pBanRange, pBuf, BufferSize, MSGTYPE_PLAYER);
+		return true;
+	}
+
+	pCacheEntry->m_Addr = *pAddr;
+	pCacheEntry->m_Generation = Generation;
+	return false;
+}
+
+CNetBan::CRangeTable::CKey CNetBan::CRangeTable::MakeKey(const NETADDR *pAddr)
+{
+	CKey Key = {{0, 0}};
+	const int Length = pAddr->type == NETTYPE_IPV4 ? 4 : 16;
+	for(int i = 0; i < Length; i++)
+		Key.m_aWords[i / 8] |= (uint64_t)pAddr->ip[i] << (56 - 8 * (i % 8));
+	return Key;
+}
+
+void CNetBan::CRangeTable::Build(const CBanRangePool *pPool)
+{
+	for(int Family = 0; Family < 2; Family++)
 	{
-		for(CBanRange *pBanRange = m_BanRangePool.First(&aHash[i]); pBanRange; pBanRange = pBanRange->m_pHashNext)
+		m_avBounds[Family].clear();
+		m_avBounds[Family].push_back({{0, 0}});
+	}
+
+	// every range starts an interval and the address after it starts another
+	for(CBanRange *pBan = pPool->First(); pBan; pBan = pBan->m_pNext)
+	{
+		const NETADDR *pLB = &pBan->m_Data.m_LB;
+		const NETADDR *pUB = &pBan->m_Data.m_UB;
+		if(pLB->type != NETTYPE_IPV4 && pLB->type != NETTYPE_IPV6)
+			continue;
+		std::vector<CKey> &vBounds = m_avBounds[pLB->type == NETTYPE_IPV4 ? 0 : 1];
+		vBounds.push_back(MakeKey(pLB));
+		CKey Next = MakeKey(pUB);
+		if(pLB->type == NETTYPE_IPV4)
 		{
-			if(NetMatch(&pBanRange->m_Data, pAddr, i, Length))
+			Next.m_aWords[0] += (uint64_t)1 << 32;
+			if(Next.m_aWords[0] != 0)
+				vBounds.push_back(Next);
+		}
+		else if(++Next.m_aWords[1] != 0 || ++Next.m_aWords[0] != 0)
+		{
+			vBounds.push_back(Next);
+		}
+	}
+	for(int Family = 0; Family < 2; Family++)
+	{
+		std::vector<CKey> &vBounds = m_avBounds[Family];
+		std::sort(vBounds.begin(), vBounds.end());
+		vBounds.erase(std::unique(vBounds.begin(), vBounds.end()), vBounds.end());
+		m_avpBans[Family].assign(vBounds.size(), nullptr);
+	}
+
+	// Visit the bans in the order the hash based lookup would: longest
+	// common prefix of the range bounds first, then hash chain order. The
+	// first ban covering an interval is the one that is reported.
+	for(int HashIndex = 15; HashIndex >= 0; HashIndex--)
+	{
+		for(int Hash = 0; Hash < 256; Hash++)
+		{
+			CNetHash NetHash;
+			NetHash.m_Hash = Hash;
+			NetHash.m_HashIndex = HashIndex;
+			for(CBanRange *pBan = pPool->First(&NetHash); pBan; pBan = pBan->m_pHashNext)
 			{
-				MakeBanInfo(pBanRange, pBuf, BufferSize, MSGTYPE_PLAYER);
-				return true;
+				const NETADDR *pLB = &pBan->m_Data.m_LB;
+				if(pLB->type != NETTYPE_IPV4 && pLB->type != NETTYPE_IPV6)
+					continue;
+				const int Family = pLB->type == NETTYPE_IPV4 ? 0 : 1;
+				const std::vector<CKey> &vBounds = m_avBounds[Family];
+				const CKey UB = MakeKey(&pBan->m_Data.m_UB);
+				for(size_t i = std::lower_bound(vBounds.begin(), vBounds.end(), MakeKey(pLB)) - vBounds.begin(); i < vBounds.size() && !(UB < vBounds[i]); i++)
+				{
+					if(!m_avpBans[Family][i])
+						m_avpBans[Family][i] = pBan;
+				}
 			}
 		}
 	}
+}
 
-	return false;
+CNetBan::CBanRange *CNetBan::CRangeTable::Find(const NETADDR *pAddr) const
+{
+	int Family;
+	if(pAddr->type == NETTYPE_IPV4)
+		Family = 0;
+	else if(pAddr->type == NETTYPE_IPV6)
+		Family = 1;
+	else
+		return nullptr;
+
+	// the first bound is the lowest address, so there always is an interval
+	const std::vector<CKey> &vBounds = m_avBounds[Family];
+	const size_t Interval = std::upper_bound(vBounds.begin(), vBounds.end(), MakeKey(pAddr)) - vBounds.begin() - 1;
+	return m_avpBans[Family][Interval];
 }
 
 void CNetBan::ConBan(IConsole::IResult *pResult, void *pUser)
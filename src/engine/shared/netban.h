@@ -4,6 +4,8 @@
 #include <base/system.h>
 #include <engine/console.h>
 
+#include <vector>
+
 inline int NetComp(const NETADDR *pAddr1, const NETADDR *pAddr2)
 {
 	return mem_comp(pAddr1, pAddr2, pAddr1->type == NETTYPE_IPV4 ? 8 : 20);
@@ -113,6 +115,8 @@ protected:
 
 		int Num() const { return m_CountUsed; }
 		bool IsFull() const { return m_CountUsed == MAX_BANS; }
+		// changes whenever a ban is added or removed
+		unsigned Generation() const { return m_Generation; }
 
 		CBan<CDataType> *First() const { return m_pFirstUsed; }
 		CBan<CDataType> *First(const CNetHash *pNetHash) const { return m_aapHashList[pNetHash->m_HashIndex][pNetHash->m_Hash]; }
@@ -139,6 +143,7 @@ protected:
 		CBan<CDataType> *m_pFirstFree;
 		CBan<CDataType> *m_pFirstUsed;
 		int m_CountUsed;
+		unsigned m_Generation = 0;
 
 		void InsertUsed(CBan<CDataType> *pBan);
 	};
@@ -148,6 +153,45 @@ protected:
 	typedef CBan<NETADDR> CBanAddr;
 	typedef CBan<CNetRange> CBanRange;
 
+	// The bounds of all range bans split the address space of each family
+	// into disjoint intervals, every interval remembers the ban the hash
+	// based lookup would report for it. A lookup is a binary search over at
+	// most two bounds per range ban.
+	class CRangeTable
+	{
+	public:
+		void Build(const CBanRangePool *pPool);
+		CBanRange *Find(const NETADDR *pAddr) const;
+
+	private:
+		// the address bits, most significant first
+		struct CKey
+		{
+			uint64_t m_aWords[2];
+
+			bool operator<(const CKey &Other) const { return m_aWords[0] < Other.m_aWords[0] || (m_aWords[0] == Other.m_aWords[0] && m_aWords[1] < Other.m_aWords[1]); }
+			bool operator==(const CKey &Other) const { return m_aWords[0] == Other.m_aWords[0] && m_aWords[1] == Other.m_aWords[1]; }
+		};
+
+		// sorted lower bounds of the intervals and the ban of each of them
+		std::vector<CKey> m_avBounds[2];
+		std::vector<CBanRange *> m_avpBans[2];
+
+		static CKey MakeKey(const NETADDR *pAddr);
+	};
+
+	// remembers recently checked addresses that are not banned
+	struct CNegativeCacheEntry
+	{
+		NETADDR m_Addr;
+		unsigned m_Generation;
+	};
+
+	enum
+	{
+		NEGATIVE_CACHE_SIZE = 1024,
+	};
+
 	template<class T>
 	void MakeBanInfo(const CBan<T> *pBan, char *pBuf, unsigned BuffSize, int Type) const;
 	template<class T>
@@ -161,6 +205,12 @@ protected:
 	CBanRangePool m_BanRangePool;
 	NETADDR m_LocalhostIpV4, m_LocalhostIpV6;
 
+	CRangeTable m_RangeTable;
+	unsigned m_RangeTableGeneration;
+	CNegativeCacheEntry m_aNegativeCache[NEGATIVE_CACHE_SIZE];
+
+	unsigned NegativeCacheGeneration() const { return m_BanAddrPool.Generation() + m_BanRangePool.Generation(); }
+
 public:
 	enum
 	{
@@ -183,7 +233,10 @@ public:
 	int UnbanByRange(const CNetRange *pRange);
 	int UnbanByIndex(int Index);
 	void UnbanAll();
-	bool IsBanned(const NETADDR *pOrigAddr, char *pBuf, unsigned BufferSize) const;
+	// Not const: rebuilds the range table if the range bans changed since the
+	// last call and remembers addresses that are not banned. Like every other
+	// member this must only be called from the thread that owns the bans.
+	bool IsBanned(const NETADDR *pOrigAddr, char *pBuf, unsigned BufferSize);
 
 	static void ConBan(class IConsole::IResult *pResult, void *pUser);
 	static void ConBanRange(class IConsole::IResult *pResult, void *pUser);
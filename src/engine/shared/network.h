@@ -262,6 +262,10 @@ private:
 	NETSOCKET m_Socket;
 	NETSTATS m_Stats;
 
+	// how well the sent packets are filled with chunks
+	uint64_t m_NumPacketsSent;
+	uint64_t m_NumChunkBytesSent;
+
 	char m_aPeerAddrStr[NETADDR_MAXSTRSIZE];
 	// client 0.7
 	static TOKEN GenerateToken7(const NETADDR *pPeerAddr);
@@ -316,6 +320,9 @@ public:
 	int64_t LastRecvTime() const { return m_LastRecvTime; }
 	int64_t ConnectTime() const { return m_LastUpdateTime; }
 
+	uint64_t NumPacketsSent() const { return m_NumPacketsSent; }
+	uint64_t NumChunkBytesSent() const { return m_NumChunkBytesSent; }
+
 	int AckSequence() const { return m_Ack; }
 	int SeqSequence() const { return m_Sequence; }
 	int SecurityToken() const { return m_SecurityToken; }
@@ -387,6 +394,7 @@ class CNetServer
 	{
 	public:
 		CNetConnection m_Connection;
+		bool m_FlushPending;
 	};
 
 	struct CSpamConn
@@ -421,6 +429,8 @@ class CNetServer
 
 	CNetRecvUnpacker m_RecvUnpacker;
 
+	bool m_TickBatch = false;
+
 	void OnTokenCtrlMsg(NETADDR &Addr, int ControlMsg, const CNetPacketConstruct &Packet);
 	int OnSixupCtrlMsg(NETADDR &Addr, CNetChunk *pChunk, int ControlMsg, const CNetPacketConstruct &Packet, SECURITY_TOKEN &ResponseToken, SECURITY_TOKEN Token);
 	void OnPreConnMsg(NETADDR &Addr, CNetPacketConstruct &Packet);
@@ -447,6 +457,11 @@ public:
 	int Send(CNetChunk *pChunk);
 	int Update();
 
+	// while a tick batch is open, flushes are delayed until it ends so that
+	// all chunks of a tick are packed into as few packets as possible
+	void BeginTickBatch();
+	void EndTickBatch();
+
 	//
 	int Drop(int ClientId, const char *pReason);
 
@@ -454,6 +469,7 @@ public:
 	const NETADDR *ClientAddr(int ClientId) const { return m_aSlots[ClientId].m_Connection.PeerAddress(); }
 	const char (*ClientAddrString(int ClientID) const)[NETADDR_MAXSTRSIZE] { return m_aSlots[ClientID].m_Connection.PeerAddressString(); }
 	bool HasSecurityToken(int ClientId) const { return m_aSlots[ClientId].m_Connection.SecurityToken() != NET_SECURITY_TOKEN_UNSUPPORTED; }
+	const CNetConnection *Connection(int ClientId) const { return &m_aSlots[ClientId].m_Connection; }
 	NETADDR Address() const { return m_Address; }
 	NETSOCKET Socket() const { return m_Socket; }
 	CNetBan *NetBan() const { return m_pNetBan; }
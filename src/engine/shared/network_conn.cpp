@@ -7,6 +7,8 @@
 void CNetConnection::ResetStats()
 {
 	mem_zero(&m_Stats, sizeof(m_Stats));
+	m_NumPacketsSent = 0;
+	m_NumChunkBytesSent = 0;
 	mem_zero(&m_PeerAddr, sizeof(m_PeerAddr));
 	m_aPeerAddrStr[0] = '\0';
 	m_LastUpdateTime = 0;
@@ -93,6 +95,8 @@ int CNetConnection::Flush()
 	// send of the packets
 	m_Construct.m_Ack = m_Ack;
 	CNetBase::SendPacket(m_Socket, &m_PeerAddr, &m_Construct, m_SecurityToken, m_Sixup);
+	m_NumPacketsSent++;
+	m_NumChunkBytesSent += m_Construct.m_DataSize;
 
 	// update send times
 	m_LastSendTime = time_get();
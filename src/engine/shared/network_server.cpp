@@ -62,7 +62,10 @@ bool CNetServer::Open(NETADDR BindAddr, CNetBan *pNetBan, int MaxClients, int Ma
 	secure_random_fill(m_aSecurityTokenSeed, sizeof(m_aSecurityTokenSeed));
 
 	for(auto &Slot : m_aSlots)
+	{
 		Slot.m_Connection.Init(m_Socket, true);
+		Slot.m_FlushPending = false;
+	}
 
 	return true;
 }
@@ -743,7 +746,12 @@ int CNetServer::Send(CNetChunk *pChunk)
 		if(m_aSlots[pChunk->m_ClientId].m_Connection.QueueChunk(Flags, pChunk->m_DataSize, pChunk->m_pData) == 0)
 		{
 			if(pChunk->m_Flags & NETSENDFLAG_FLUSH)
-				m_aSlots[pChunk->m_ClientId].m_Connection.Flush();
+			{
+				if(m_TickBatch)
+					m_aSlots[pChunk->m_ClientId].m_FlushPending = true;
+				else
+					m_aSlots[pChunk->m_ClientId].m_Connection.Flush();
+			}
 		}
 		else
 		{
@@ -753,6 +761,24 @@ int CNetServer::Send(CNetChunk *pChunk)
 	return 0;
 }
 
+void CNetServer::BeginTickBatch()
+{
+	m_TickBatch = true;
+}
+
+void CNetServer::EndTickBatch()
+{
+	m_TickBatch = false;
+	for(int i = 0; i < MaxClients(); i++)
+	{
+		if(m_aSlots[i].m_FlushPending)
+		{
+			m_aSlots[i].m_Connection.Flush();
+			m_aSlots[i].m_FlushPending = false;
+		}
+	}
+}
+
 void CNetServer::SendTokenSixup(NETADDR &Addr, SECURITY_TOKEN Token)
 {
 	SECURITY_TOKEN MyToken = GetToken(Addr);
@@ -1,6 +1,7 @@
 #include "serverinfo.h"
 
 #include "json.h"
+#include "serverinfo_arena.h"
 #include <base/math.h>
 #include <base/system.h>
 #include <engine/external/json-parser/json.h>
@@ -225,7 +226,7 @@ bool CServerInfo2::operator==(const CServerInfo2 &Other) const
 	return true;
 }
 
-CServerInfo2::operator CServerInfo() const
+void CServerInfo2::ToServerInfo(CServerInfo *pOut, CServerInfoArena *pArena) const
 {
 	CServerInfo Result = {0};
 	Result.m_MaxClients = m_MaxClients;
@@ -235,28 +236,31 @@ CServerInfo2::operator CServerInfo() const
 	Result.m_ClientScoreKind = m_ClientScoreKind;
 	Result.m_RequiresLogin = m_RequiresLogin;
 	Result.m_Flags = m_Passworded ? SERVER_FLAG_PASSWORD : 0;
-	str_copy(Result.m_aGameType, m_aGameType);
+	Result.m_pGameType = pArena->InternString(m_aGameType);
 	str_copy(Result.m_aName, m_aName);
-	str_copy(Result.m_aMap, m_aMapName);
+	Result.m_pMap = pArena->InternString(m_aMapName);
 	str_copy(Result.m_aVersion, m_aVersion);
 
-	for(int i = 0; i < minimum(m_NumClients, (int)SERVERINFO_MAX_CLIENTS); i++)
+	Result.m_NumReceivedClients = minimum(m_NumClients, (int)SERVERINFO_MAX_CLIENTS);
+	Result.m_pClients = pArena->AllocateClients(Result.m_NumReceivedClients);
+	for(int i = 0; i < Result.m_NumReceivedClients; i++)
 	{
-		str_copy(Result.m_aClients[i].m_aName, m_aClients[i].m_aName);
-		str_copy(Result.m_aClients[i].m_aClan, m_aClients[i].m_aClan);
-		Result.m_aClients[i].m_Country = m_aClients[i].m_Country;
-		Result.m_aClients[i].m_Score = m_aClients[i].m_Score;
-		Result.m_aClients[i].m_Player = m_aClients[i].m_IsPlayer;
-		Result.m_aClients[i].m_Afk = m_aClients[i].m_IsAfk;
+		CServerInfo::CClient &Client = Result.m_pClients[i];
+		Client.m_pName = pArena->StoreString(m_aClients[i].m_aName);
+		Client.m_pClan = pArena->StoreString(m_aClients[i].m_aClan);
+		Client.m_Country = m_aClients[i].m_Country;
+		Client.m_Score = m_aClients[i].m_Score;
+		Client.m_Player = m_aClients[i].m_IsPlayer;
+		Client.m_Afk = m_aClients[i].m_IsAfk;
 
-		str_copy(Result.m_aClients[i].m_aSkin, m_aClients[i].m_aSkin);
-		Result.m_aClients[i].m_CustomSkinColors = m_aClients[i].m_CustomSkinColors;
-		Result.m_aClients[i].m_CustomSkinColorBody = m_aClients[i].m_CustomSkinColorBody;
-		Result.m_aClients[i].m_CustomSkinColorFeet = m_aClients[i].m_CustomSkinColorFeet;
+		Client.m_pSkin = pArena->InternString(m_aClients[i].m_aSkin);
+		Client.m_CustomSkinColors = m_aClients[i].m_CustomSkinColors;
+		Client.m_CustomSkinColorBody = m_aClients[i].m_CustomSkinColorBody;
+		Client.m_CustomSkinColorFeet = m_aClients[i].m_CustomSkinColorFeet;
+		Client.m_FriendState = 0;
 	}
 
-	Result.m_NumReceivedClients = minimum(m_NumClients, (int)SERVERINFO_MAX_CLIENTS);
 	Result.m_Latency = -1;
 
-	return Result;
+	*pOut = Result;
 }
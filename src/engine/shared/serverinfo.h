@@ -8,6 +8,7 @@
 
 typedef struct _json_value json_value;
 class CServerInfo;
+class CServerInfoArena;
 
 class CServerInfo2
 {
@@ -47,7 +48,8 @@ public:
 	bool Validate() const;
 	void ToJson(char *pBuffer, int BufferSize) const;
 
-	operator CServerInfo() const;
+	// the clients and strings are stored in the arena
+	void ToServerInfo(CServerInfo *pOut, CServerInfoArena *pArena) const;
 };
 
 bool ParseCrc(unsigned int *pResult, const char *pString);
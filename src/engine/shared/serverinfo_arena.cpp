@@ -0,0 +1,64 @@
+#include "serverinfo_arena.h"
+
+#include "memheap.h"
+
+CServerInfoArena::CServerInfoArena() :
+	m_pHeap(std::make_unique<CHeap>())
+{
+}
+
+CServerInfoArena::CServerInfoArena(CServerInfoArena &&Other) = default;
+CServerInfoArena &CServerInfoArena::operator=(CServerInfoArena &&Other) = default;
+CServerInfoArena::~CServerInfoArena() = default;
+
+void CServerInfoArena::Reset()
+{
+	m_Interned.clear();
+	m_pHeap->Reset();
+}
+
+const char *CServerInfoArena::StoreString(const char *pString)
+{
+	if(pString[0] == '\0')
+		return "";
+	return m_pHeap->StoreString(pString);
+}
+
+const char *CServerInfoArena::InternString(const char *pString)
+{
+	if(pString[0] == '\0')
+		return "";
+	const auto Interned = m_Interned.find(pString);
+	if(Interned != m_Interned.end())
+		return Interned->data();
+	const char *pStored = m_pHeap->StoreString(pString);
+	m_Interned.insert(pStored);
+	return pStored;
+}
+
+CServerInfo::CClient *CServerInfoArena::AllocateClients(int NumClients)
+{
+	if(NumClients <= 0)
+		return nullptr;
+	return static_cast<CServerInfo::CClient *>(m_pHeap->Allocate(NumClients * sizeof(CServerInfo::CClient), alignof(CServerInfo::CClient)));
+}
+
+void CServerInfoArena::Store(CServerInfo *pInfo)
+{
+	pInfo->m_pCommunityId = InternString(pInfo->m_pCommunityId);
+	pInfo->m_pCommunityCountry = InternString(pInfo->m_pCommunityCountry);
+	pInfo->m_pCommunityType = InternString(pInfo->m_pCommunityType);
+	pInfo->m_pGameType = InternString(pInfo->m_pGameType);
+	pInfo->m_pMap = InternString(pInfo->m_pMap);
+
+	const CServerInfo::CClient *pClients = pInfo->m_pClients;
+	pInfo->m_pClients = AllocateClients(pInfo->m_NumReceivedClients);
+	for(int i = 0; i < pInfo->m_NumReceivedClients; i++)
+	{
+		CServerInfo::CClient &Client = pInfo->m_pClients[i];
+		Client = pClients[i];
+		Client.m_pName = StoreString(Client.m_pName);
+		Client.m_pClan = StoreString(Client.m_pClan);
+		Client.m_pSkin = InternString(Client.m_pSkin);
+	}
+}
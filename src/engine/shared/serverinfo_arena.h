@@ -0,0 +1,42 @@
+#ifndef ENGINE_SHARED_SERVERINFO_ARENA_H
+#define ENGINE_SHARED_SERVERINFO_ARENA_H
+
+#include <engine/serverbrowser.h>
+
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+
+class CHeap;
+
+// Storage for the client lists and strings that CServerInfo points to.
+// Player names and clans are appended to the arena, game types, maps,
+// skins and community strings are interned because only few of them are
+// distinct. Nothing is freed before Reset, moving the arena keeps the
+// pointers valid.
+class CServerInfoArena
+{
+public:
+	CServerInfoArena();
+	CServerInfoArena(CServerInfoArena &&Other);
+	CServerInfoArena &operator=(CServerInfoArena &&Other);
+	~CServerInfoArena();
+
+	void Reset();
+
+	const char *StoreString(const char *pString);
+	// returns the same pointer for equal strings
+	const char *InternString(const char *pString);
+	// the clients are uninitialized
+	CServerInfo::CClient *AllocateClients(int NumClients);
+
+	// copies the client list and the strings of the info into the arena,
+	// so that it doesn't point into the storage it was filled from anymore
+	void Store(CServerInfo *pInfo);
+
+private:
+	std::unique_ptr<CHeap> m_pHeap;
+	std::unordered_set<std::string_view> m_Interned;
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include "compression.h"
 #include "uuid_manager.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <limits>
 
@@ -161,96 +162,99 @@ bool CSnapshot::IsValid(size_t ActualSize) const
 
 // CSnapshotDelta
 
-enum
+// Fills pSorted with the keys of the snapshot items in the upper and the item
+// indices in the lower 32 bits, sorted by key and then by index.
+static void SortItemKeys(const CSnapshot *pSnapshot, uint64_t *pSorted)
 {
-	HASHLIST_SIZE = 256,
-	HASHLIST_BUCKET_SIZE = 64,
-};
+	const int NumItems = pSnapshot->NumItems();
+	for(int i = 0; i < NumItems; i++)
+		pSorted[i] = ((uint64_t)(uint32_t)pSnapshot->GetItem(i)->Key() << 32) | (uint32_t)i;
+	std::sort(pSorted, pSorted + NumItems);
+}
 
-struct CItemList
+static int SortedKey(uint64_t Entry)
 {
-	int m_Num;
-	int m_aKeys[HASHLIST_BUCKET_SIZE];
-	int m_aIndex[HASHLIST_BUCKET_SIZE];
-};
+	return (int)(uint32_t)(Entry >> 32);
+}
 
-inline size_t CalcHashId(int Key)
+static int SortedIndex(uint64_t Entry)
 {
-	// djb2 (http://www.cse.yorku.ca/~oz/hash.html)
-	unsigned Hash = 5381;
-	for(unsigned Shift = 0; Shift < sizeof(int); Shift++)
-		Hash = ((Hash << 5) + Hash) + ((Key >> (Shift * 8)) & 0xFF);
-	return Hash % HASHLIST_SIZE;
+	return (int)(uint32_t)Entry;
 }
 
-static void GenerateHash(CItemList *pHashlist, const CSnapshot *pSnapshot)
+// Whether any key appears more than once, checked with an open addressing
+// table so that it stays cheaper than sorting the keys.
+static bool HasDuplicateKeys(const CSnapshot *pSnapshot)
 {
-	for(int i = 0; i < HASHLIST_SIZE; i++)
-		pHashlist[i].m_Num = 0;
-
-	for(int i = 0; i < pSnapshot->NumItems(); i++)
+	enum
+	{
+		TABLE_SIZE = 2 * CSnapshot::MAX_ITEMS,
+	};
+	int aKeys[TABLE_SIZE];
+	bool aUsed[TABLE_SIZE] = {false};
+	const int NumItems = pSnapshot->NumItems();
+	for(int i = 0; i < NumItems; i++)
 	{
-		int Key = pSnapshot->GetItem(i)->Key();
-		size_t HashId = CalcHashId(Key);
-		if(pHashlist[HashId].m_Num < HASHLIST_BUCKET_SIZE)
+		const int Key = pSnapshot->GetItem(i)->Key();
+		unsigned Slot = ((uint32_t)Key * 2654435761u) % TABLE_SIZE;
+		while(aUsed[Slot])
 		{
-			pHashlist[HashId].m_aIndex[pHashlist[HashId].m_Num] = i;
-			pHashlist[HashId].m_aKeys[pHashlist[HashId].m_Num] = Key;
-			pHashlist[HashId].m_Num++;
+			if(aKeys[Slot] == Key)
+				return true;
+			Slot = (Slot + 1) % TABLE_SIZE;
 		}
+		aUsed[Slot] = true;
+		aKeys[Slot] = Key;
 	}
+	return false;
 }
 
-static int GetItemIndexHashed(int Key, const CItemList *pHashlist)
+// Returns the position of the first entry with the given key or -1.
+static int FindSortedKey(const uint64_t *pSorted, int Num, int Key)
 {
-	size_t HashId = CalcHashId(Key);
-	for(int i = 0; i < pHashlist[HashId].m_Num; i++)
-	{
-		if(pHashlist[HashId].m_aKeys[i] == Key)
-			return pHashlist[HashId].m_aIndex[i];
-	}
-
-	return -1;
+	const uint64_t Search = (uint64_t)(uint32_t)Key << 32;
+	const uint64_t *pFound = std::lower_bound(pSorted, pSorted + Num, Search);
+	if(pFound == pSorted + Num || SortedKey(*pFound) != Key)
+		return -1;
+	return pFound - pSorted;
 }
 
 int CSnapshotDelta::DiffItem(const int *pPast, const int *pCurrent, int *pOut, int Size)
 {
-	int Needed = 0;
-	while(Size)
+	// subtraction with wrapping by using unsigned, written without
+	// dependencies between iterations so the compiler can vectorize it
+	unsigned Needed = 0;
+	for(int i = 0; i < Size; i++)
 	{
-		// subtraction with wrapping by casting to unsigned
-		*pOut = (unsigned)*pCurrent - (unsigned)*pPast;
-		Needed |= *pOut;
-		pOut++;
-		pPast++;
-		pCurrent++;
-		Size--;
+		const unsigned Diff = (unsigned)pCurrent[i] - (unsigned)pPast[i];
+		pOut[i] = Diff;
+		Needed |= Diff;
 	}
 
-	return Needed;
+	return Needed != 0;
+}
+
+// The size in bits that the diff takes up in the compressed delta: one bit for
+// an unchanged value, otherwise the bytes of CVariableInt::Pack, which stores
+// 6 bits in the first and 7 bits in every further byte.
+static unsigned DiffBits(int Diff)
+{
+	const unsigned Value = Diff < 0 ? ~(unsigned)Diff : (unsigned)Diff;
+	const unsigned Bytes = 1 + (Value >= (1u << 6)) + (Value >= (1u << 13)) + (Value >= (1u << 20)) + (Value >= (1u << 27));
+	return Diff == 0 ? 1 : Bytes * 8;
 }
 
 void CSnapshotDelta::UndiffItem(const int *pPast, const int *pDiff, int *pOut, int Size, uint64_t *pDataRate)
 {
-	while(Size)
+	// addition with wrapping by using unsigned, like in DiffItem without
+	// dependencies between iterations so the compiler can vectorize it
+	uint64_t DataRate = 0;
+	for(int i = 0; i < Size; i++)
 	{
-		// addition with wrapping by casting to unsigned
-		*pOut = (unsigned)*pPast + (unsigned)*pDiff;
-
-		if(*pDiff == 0)
-			*pDataRate += 1;
-		else
-		{
-			unsigned char aBuf[CVariableInt::MAX_BYTES_PACKED];
-			unsigned char *pEnd = CVariableInt::Pack(aBuf, *pDiff, sizeof(aBuf));
-			*pDataRate += (uint64_t)(pEnd - (unsigned char *)aBuf) * 8;
-		}
-
-		pOut++;
-		pPast++;
-		pDiff++;
-		Size--;
+		pOut[i] = (unsigned)pPast[i] + (unsigned)pDiff[i];
+		DataRate += DiffBits(pDiff[i]);
 	}
+	*pDataRate += DataRate;
 }
 
 CSnapshotDelta::CSnapshotDelta()
@@ -290,7 +294,6 @@ const CSnapshotDelta::CData *CSnapshotDelta::EmptyDelta() const
 	return &m_Empty;
 }
 
-// TODO: OPT: this should be made much faster
 int CSnapshotDelta::CreateDelta(const CSnapshot *pFrom, const CSnapshot *pTo, void *pDstData)
 {
 	CData *pDelta = (CData *)pDstData;
@@ -300,32 +303,66 @@ int CSnapshotDelta::CreateDelta(const CSnapshot *pFrom, const CSnapshot *pTo, vo
 	pDelta->m_NumUpdateItems = 0;
 	pDelta->m_NumTempItems = 0;
 
-	CItemList aHashlist[HASHLIST_SIZE];
-	GenerateHash(aHashlist, pTo);
+	const int NumFromItems = pFrom->NumItems();
+	const int NumItems = pTo->NumItems();
 
-	// pack deleted stuff
-	for(int i = 0; i < pFrom->NumItems(); i++)
-	{
-		const CSnapshotItem *pFromItem = pFrom->GetItem(i);
-		if(GetItemIndexHashed(pFromItem->Key(), aHashlist) == -1)
+	// match the items by key, past index is the first item with the same key
+	int aPastIndices[CSnapshot::MAX_ITEMS];
+	bool aDeleted[CSnapshot::MAX_ITEMS];
+	bool SameKeys = NumFromItems == NumItems;
+	for(int i = 0; SameKeys && i < NumItems; i++)
+		SameKeys = pFrom->GetItem(i)->Key() == pTo->GetItem(i)->Key();
+	if(SameKeys && !HasDuplicateKeys(pTo))
+	{
+		// usually the snapshots contain the same items in the same order,
+		// then every item is its own past item unless a key repeats
+		for(int i = 0; i < NumItems; i++)
 		{
-			// deleted
-			pDelta->m_NumDeletedItems++;
-			*pData = pFromItem->Key();
-			pData++;
+			aPastIndices[i] = i;
+			aDeleted[i] = false;
 		}
 	}
+	else
+	{
+		// otherwise merge the items sorted by key
+		uint64_t aSortedFrom[CSnapshot::MAX_ITEMS];
+		uint64_t aSortedTo[CSnapshot::MAX_ITEMS];
+		SortItemKeys(pFrom, aSortedFrom);
+		SortItemKeys(pTo, aSortedTo);
 
-	GenerateHash(aHashlist, pFrom);
+		int From = 0;
+		int To = 0;
+		while(From < NumFromItems || To < NumItems)
+		{
+			if(To == NumItems || (From < NumFromItems && SortedKey(aSortedFrom[From]) < SortedKey(aSortedTo[To])))
+			{
+				aDeleted[SortedIndex(aSortedFrom[From++])] = true;
+			}
+			else if(From == NumFromItems || SortedKey(aSortedFrom[From]) > SortedKey(aSortedTo[To]))
+			{
+				aPastIndices[SortedIndex(aSortedTo[To++])] = -1;
+			}
+			else
+			{
+				const int Key = SortedKey(aSortedTo[To]);
+				const int PastIndex = SortedIndex(aSortedFrom[From]);
+				while(From < NumFromItems && SortedKey(aSortedFrom[From]) == Key)
+					aDeleted[SortedIndex(aSortedFrom[From++])] = false;
+				while(To < NumItems && SortedKey(aSortedTo[To]) == Key)
+					aPastIndices[SortedIndex(aSortedTo[To++])] = PastIndex;
+			}
+		}
+	}
 
-	// fetch previous indices
-	// we do this as a separate pass because it helps the cache
-	int aPastIndices[CSnapshot::MAX_ITEMS];
-	const int NumItems = pTo->NumItems();
-	for(int i = 0; i < NumItems; i++)
+	// pack deleted stuff
+	for(int i = 0; i < NumFromItems; i++)
 	{
-		const CSnapshotItem *pCurItem = pTo->GetItem(i); // O(1) .. O(n)
-		aPastIndices[i] = GetItemIndexHashed(pCurItem->Key(), aHashlist); // O(n) .. O(n^n)
+		if(aDeleted[i])
+		{
+			pDelta->m_NumDeletedItems++;
+			*pData = pFrom->GetItem(i)->Key();
+			pData++;
+		}
 	}
 
 	for(int i = 0; i < NumItems; i++)
@@ -338,10 +375,13 @@ int CSnapshotDelta::CreateDelta(const CSnapshot *pFrom, const CSnapshot *pTo, vo
 
 		if(PastIndex != -1)
 		{
-			int *pItemDataDst = pData + 3;
-
 			const CSnapshotItem *pPastItem = pFrom->GetItem(PastIndex);
 
+			// most items do not change between snapshots
+			if(mem_comp(pPastItem->Data(), pCurItem->Data(), ItemSize) == 0)
+				continue;
+
+			int *pItemDataDst = pData + 3;
 			if(!IncludeSize)
 				pItemDataDst = pData + 2;
 
@@ -523,23 +563,28 @@ int CSnapshotDelta::UnpackDelta(const CSnapshot *pFrom, CSnapshot *pTo, const vo
 	if(pData > pEnd)
 		return -101;
 
+	// look up the previous items by key instead of searching them linearly
+	const int NumFromItems = pFrom->NumItems();
+	uint64_t aSortedFrom[CSnapshot::MAX_ITEMS];
+	SortItemKeys(pFrom, aSortedFrom);
+
+	bool aDeleted[CSnapshot::MAX_ITEMS] = {false};
+	for(int d = 0; d < pDelta->m_NumDeletedItems; d++)
+	{
+		for(int Pos = FindSortedKey(aSortedFrom, NumFromItems, pDeleted[d]); Pos != -1 && Pos < NumFromItems && SortedKey(aSortedFrom[Pos]) == pDeleted[d]; Pos++)
+			aDeleted[SortedIndex(aSortedFrom[Pos])] = true;
+	}
+
 	// copy all non deleted stuff
-	for(int i = 0; i < pFrom->NumItems(); i++)
+	int aBuilderIndices[CSnapshot::MAX_ITEMS];
+	for(int i = 0; i < NumFromItems; i++)
 	{
 		const CSnapshotItem *pFromItem = pFrom->GetItem(i);
 		const int ItemSize = pFrom->GetItemSize(i);
-		bool Keep = true;
-		for(int d = 0; d < pDelta->m_NumDeletedItems; d++)
-		{
-			if(pDeleted[d] == pFromItem->Key())
-			{
-				Keep = false;
-				break;
-			}
-		}
 
-		if(Keep)
+		if(!aDeleted[i])
 		{
+			aBuilderIndices[i] = Builder.NumItems();
 			void *pObj = Builder.NewItem(pFromItem->Type(), pFromItem->Id(), ItemSize);
 			if(!pObj)
 				return -301;
@@ -581,15 +626,21 @@ int CSnapshotDelta::UnpackDelta(const CSnapshot *pFrom, CSnapshot *pTo, const vo
 
 		const int Key = (Type << 16) | Id;
 
+		const int FromPos = FindSortedKey(aSortedFrom, NumFromItems, Key);
+		const int FromIndex = FromPos == -1 ? -1 : SortedIndex(aSortedFrom[FromPos]);
+
 		// create the item if needed
-		int *pNewData = Builder.GetItemData(Key);
+		int *pNewData;
+		if(FromIndex != -1 && !aDeleted[FromIndex])
+			pNewData = Builder.GetItem(aBuilderIndices[FromIndex])->Data();
+		else
+			pNewData = Builder.GetItemData(Key);
 		if(!pNewData)
 			pNewData = (int *)Builder.NewItem(Type, Id, ItemSize);
 
 		if(!pNewData)
 			return -302;
 
-		const int FromIndex = pFrom->GetItemIndex(Key);
 		if(FromIndex != -1)
 		{
 			// we got an update so we need to apply the diff
@@ -611,10 +662,54 @@ int CSnapshotDelta::UnpackDelta(const CSnapshot *pFrom, CSnapshot *pTo, const vo
 
 // CSnapshotStorage
 
+CSnapshotStorage::~CSnapshotStorage()
+{
+	PurgeAll();
+	while(m_pFirstFree)
+	{
+		CStoredHolder *pNext = m_pFirstFree->m_pNextFree;
+		free(m_pFirstFree);
+		m_pFirstFree = pNext;
+	}
+}
+
 void CSnapshotStorage::Init()
 {
-	m_pFirst = nullptr;
-	m_pLast = nullptr;
+	PurgeAll();
+}
+
+CSnapshotStorage::CStoredHolder *CSnapshotStorage::AllocHolder(size_t Size)
+{
+	CStoredHolder *pHolder = m_pFirstFree;
+	if(pHolder && pHolder->m_Capacity >= Size)
+	{
+		m_pFirstFree = pHolder->m_pNextFree;
+		return pHolder;
+	}
+	if(pHolder)
+	{
+		// too small, replace it with a bigger one
+		m_pFirstFree = pHolder->m_pNextFree;
+		free(pHolder);
+	}
+
+	// round up so that the buffer can be reused for slightly bigger snapshots
+	const size_t Capacity = (Size + 1023) & ~(size_t)1023;
+	pHolder = static_cast<CStoredHolder *>(malloc(sizeof(CStoredHolder) + Capacity));
+	pHolder->m_Capacity = Capacity;
+	return pHolder;
+}
+
+void CSnapshotStorage::ReleaseHolder(CStoredHolder *pHolder)
+{
+	CStoredHolder *&pIndexed = m_apTickIndex[TickIndex(pHolder->m_Tick)];
+	if(pIndexed == pHolder)
+		pIndexed = nullptr;
+	if(pHolder->m_Collided)
+		m_NumUnindexed--;
+
+	pHolder->m_pNextFree = m_pFirstFree;
+	m_pFirstFree = pHolder;
 }
 
 void CSnapshotStorage::PurgeAll()
@@ -622,9 +717,7 @@ void CSnapshotStorage::PurgeAll()
 	while(m_pFirst)
 	{
 		CHolder *pNext = m_pFirst->m_pNext;
-		free(m_pFirst->m_pSnap);
-		free(m_pFirst->m_pAltSnap);
-		free(m_pFirst);
+		ReleaseHolder(static_cast<CStoredHolder *>(m_pFirst));
 		m_pFirst = pNext;
 	}
 	m_pLast = nullptr;
@@ -632,29 +725,17 @@ void CSnapshotStorage::PurgeAll()
 
 void CSnapshotStorage::PurgeUntil(int Tick)
 {
-	CHolder *pHolder = m_pFirst;
-
-	while(pHolder)
+	while(m_pFirst && m_pFirst->m_Tick < Tick)
 	{
-		CHolder *pNext = pHolder->m_pNext;
-		if(pHolder->m_Tick >= Tick)
-			return; // no more to remove
-		free(pHolder->m_pSnap);
-		free(pHolder->m_pAltSnap);
-		free(pHolder);
-
-		// did we come to the end of the list?
-		if(!pNext)
-			break;
-
+		CHolder *pNext = m_pFirst->m_pNext;
+		ReleaseHolder(static_cast<CStoredHolder *>(m_pFirst));
 		m_pFirst = pNext;
-		pNext->m_pPrev = nullptr;
-		pHolder = pNext;
 	}
 
-	// no more snapshots in storage
-	m_pFirst = nullptr;
-	m_pLast = nullptr;
+	if(m_pFirst)
+		m_pFirst->m_pPrev = nullptr;
+	else
+		m_pLast = nullptr; // no more snapshots in storage
 }
 
 void CSnapshotStorage::Add(int Tick, int64_t Tagtime, size_t DataSize, const void *pData, size_t AltDataSize, const void *pAltData)
@@ -662,17 +743,20 @@ void CSnapshotStorage::Add(int Tick, int64_t Tagtime, size_t DataSize, const voi
 	dbg_assert(DataSize <= (size_t)CSnapshot::MAX_SIZE, "Snapshot data size invalid");
 	dbg_assert(AltDataSize <= (size_t)CSnapshot::MAX_SIZE, "Alt snapshot data size invalid");
 
-	CHolder *pHolder = static_cast<CHolder *>(malloc(sizeof(CHolder)));
+	// keep the alternative snapshot aligned behind the first one
+	const size_t AltOffset = (DataSize + alignof(CSnapshot) - 1) & ~(alignof(CSnapshot) - 1);
+	CStoredHolder *pHolder = AllocHolder(AltOffset + AltDataSize);
 	pHolder->m_Tick = Tick;
 	pHolder->m_Tagtime = Tagtime;
 
-	pHolder->m_pSnap = static_cast<CSnapshot *>(malloc(DataSize));
+	char *pBuffer = reinterpret_cast<char *>(pHolder + 1);
+	pHolder->m_pSnap = reinterpret_cast<CSnapshot *>(pBuffer);
 	mem_copy(pHolder->m_pSnap, pData, DataSize);
 	pHolder->m_SnapSize = DataSize;
 
 	if(AltDataSize) // create alternative if wanted
 	{
-		pHolder->m_pAltSnap = static_cast<CSnapshot *>(malloc(AltDataSize));
+		pHolder->m_pAltSnap = reinterpret_cast<CSnapshot *>(pBuffer + AltOffset);
 		mem_copy(pHolder->m_pAltSnap, pAltData, AltDataSize);
 		pHolder->m_AltSnapSize = AltDataSize;
 	}
@@ -682,6 +766,14 @@ void CSnapshotStorage::Add(int Tick, int64_t Tagtime, size_t DataSize, const voi
 		pHolder->m_AltSnapSize = 0;
 	}
 
+	// index by tick, a holder that collides with a different tick is only found by walking the list
+	CStoredHolder *&pIndexed = m_apTickIndex[TickIndex(Tick)];
+	pHolder->m_Collided = pIndexed && pIndexed->m_Tick != Tick;
+	if(!pIndexed)
+		pIndexed = pHolder;
+	else if(pHolder->m_Collided)
+		m_NumUnindexed++;
+
 	// link
 	pHolder->m_pNext = nullptr;
 	pHolder->m_pPrev = m_pLast;
@@ -694,25 +786,33 @@ void CSnapshotStorage::Add(int Tick, int64_t Tagtime, size_t DataSize, const voi
 
 int CSnapshotStorage::Get(int Tick, int64_t *pTagtime, const CSnapshot **ppData, const CSnapshot **ppAltData) const
 {
-	CHolder *pHolder = m_pFirst;
-
-	while(pHolder)
+	const CHolder *pHolder = m_apTickIndex[TickIndex(Tick)];
+	if(!pHolder || pHolder->m_Tick != Tick)
 	{
-		if(pHolder->m_Tick == Tick)
+		pHolder = nullptr;
+		if(m_NumUnindexed > 0)
 		{
-			if(pTagtime)
-				*pTagtime = pHolder->m_Tagtime;
-			if(ppData)
-				*ppData = pHolder->m_pSnap;
-			if(ppAltData)
-				*ppAltData = pHolder->m_pAltSnap;
-			return pHolder->m_SnapSize;
+			for(const CHolder *pCur = m_pFirst; pCur; pCur = pCur->m_pNext)
+			{
+				if(pCur->m_Tick == Tick)
+				{
+					pHolder = pCur;
+					break;
+				}
+			}
 		}
-
-		pHolder = pHolder->m_pNext;
 	}
 
-	return -1;
+	if(!pHolder)
+		return -1;
+
+	if(pTagtime)
+		*pTagtime = pHolder->m_Tagtime;
+	if(ppData)
+		*ppData = pHolder->m_pSnap;
+	if(ppAltData)
+		*ppAltData = pHolder->m_pAltSnap;
+	return pHolder->m_SnapSize;
 }
 
 // CSnapshotBuilder
@@ -14,6 +14,7 @@
 class CSnapshotItem
 {
 	friend class CSnapshotBuilder;
+	friend class CSnapshotDelta;
 
 	int *Data() { return (int *)(this + 1); }
 
@@ -130,16 +131,39 @@ public:
 		CSnapshot *m_pAltSnap;
 	};
 
-	CHolder *m_pFirst;
-	CHolder *m_pLast;
+	CHolder *m_pFirst = nullptr;
+	CHolder *m_pLast = nullptr;
 
 	CSnapshotStorage() { Init(); }
-	~CSnapshotStorage() { PurgeAll(); }
+	~CSnapshotStorage();
 	void Init();
 	void PurgeAll();
 	void PurgeUntil(int Tick);
 	void Add(int Tick, int64_t Tagtime, size_t DataSize, const void *pData, size_t AltDataSize, const void *pAltData);
 	int Get(int Tick, int64_t *pTagtime, const CSnapshot **ppData, const CSnapshot **ppAltData) const;
+
+private:
+	enum
+	{
+		TICK_INDEX_SIZE = 256,
+	};
+
+	// holders are recycled together with their snapshot buffers
+	class CStoredHolder : public CHolder
+	{
+	public:
+		CStoredHolder *m_pNextFree;
+		size_t m_Capacity;
+		bool m_Collided;
+	};
+
+	CStoredHolder *m_pFirstFree = nullptr;
+	CStoredHolder *m_apTickIndex[TICK_INDEX_SIZE] = {};
+	int m_NumUnindexed = 0;
+
+	static unsigned TickIndex(int Tick) { return (unsigned)Tick % TICK_INDEX_SIZE; }
+	CStoredHolder *AllocHolder(size_t Size);
+	void ReleaseHolder(CStoredHolder *pHolder);
 };
 
 class CSnapshotBuilder
@@ -174,6 +198,7 @@ public:
 
 	CSnapshotItem *GetItem(int Index);
 	int *GetItemData(int Key);
+	int NumItems() const { return m_NumItems; }
 
 	int Finish(void *pSnapdata);
 };
@@ -11,5 +11,26 @@ enum
 	OFFSET_GAME_UUID
 };
 
+// the name of the teehistorian format, its UUID starts every file
+static const char TEEHISTORIAN_NAME[] = "teehistorian@ddnet.tw";
+
+// chunk types, written negated in front of the chunk data. Extra chunks
+// (TEEHISTORIAN_EX) carry one of the UUIDs registered above.
+enum
+{
+	TEEHISTORIAN_NONE,
+	TEEHISTORIAN_FINISH,
+	TEEHISTORIAN_TICK_SKIP,
+	TEEHISTORIAN_PLAYER_NEW,
+	TEEHISTORIAN_PLAYER_OLD,
+	TEEHISTORIAN_INPUT_DIFF,
+	TEEHISTORIAN_INPUT_NEW,
+	TEEHISTORIAN_MESSAGE,
+	TEEHISTORIAN_JOIN,
+	TEEHISTORIAN_DROP,
+	TEEHISTORIAN_CONSOLE_COMMAND,
+	TEEHISTORIAN_EX,
+};
+
 void RegisterTeehistorianUuids(class CUuidManager *pManager);
 #endif // ENGINE_SHARED_TEEHISTORIAN_EX_H
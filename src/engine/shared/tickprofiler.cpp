@@ -0,0 +1,159 @@
+#include "tickprofiler.h"
+
+#include <base/math.h>
+
+#include <engine/shared/jsonwriter.h>
+
+void CDurationHistogram::Reset()
+{
+	mem_zero(m_aBuckets, sizeof(m_aBuckets));
+	m_Count = 0;
+	m_Min = 0;
+	m_Max = 0;
+	m_Sum = 0;
+}
+
+int CDurationHistogram::BucketIndex(int64_t Value)
+{
+	if(Value < SUB_BUCKETS)
+		return maximum<int64_t>(Value, 0);
+
+	int Exponent = SUB_BUCKET_BITS;
+	while(Value >> (Exponent + 1))
+		Exponent++;
+	const int SubBucket = (Value >> (Exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+	return (Exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + SubBucket;
+}
+
+int64_t CDurationHistogram::BucketLowerBound(int Index)
+{
+	if(Index < SUB_BUCKETS)
+		return Index;
+
+	const int Exponent = Index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+	const int SubBucket = Index % SUB_BUCKETS;
+	return (int64_t)(SUB_BUCKETS + SubBucket) << (Exponent - SUB_BUCKET_BITS);
+}
+
+void CDurationHistogram::Record(int64_t Value)
+{
+	m_aBuckets[BucketIndex(Value)]++;
+	if(!m_Count || Value < m_Min)
+		m_Min = Value;
+	if(Value > m_Max)
+		m_Max = Value;
+	m_Count++;
+	m_Sum += Value;
+}
+
+int64_t CDurationHistogram::Percentile(double Percentile) const
+{
+	if(!m_Count)
+		return 0;
+
+	const int64_t Target = maximum<int64_t>(1, (int64_t)(Percentile / 100.0 * m_Count + 0.5));
+	int64_t Seen = 0;
+	for(int i = 0; i < NUM_BUCKETS; i++)
+	{
+		Seen += m_aBuckets[i];
+		if(Seen >= Target)
+			return clamp(BucketLowerBound(i), m_Min, m_Max);
+	}
+	return m_Max;
+}
+
+CTickProfiler::CTickProfiler()
+{
+	m_vEvents.resize(MAX_EVENTS);
+}
+
+int CTickProfiler::AddSection(const char *pName)
+{
+	for(int i = 0; i < m_NumSections; i++)
+	{
+		if(str_comp(m_aSections[i].m_aName, pName) == 0)
+			return i;
+	}
+	dbg_assert(m_NumSections < MAX_SECTIONS, "too many tick profiler sections");
+	str_copy(m_aSections[m_NumSections].m_aName, pName);
+	m_aSections[m_NumSections].m_Histogram.Reset();
+	return m_NumSections++;
+}
+
+void CTickProfiler::Record(int Section, int64_t Start, int64_t Duration)
+{
+	m_aSections[Section].m_Histogram.Record(Duration);
+
+	CEvent &Event = m_vEvents[m_NextEvent];
+	Event.m_Start = Start;
+	Event.m_Duration = Duration;
+	Event.m_Section = Section;
+	Event.m_Tick = m_Tick;
+	m_NextEvent = (m_NextEvent + 1) % MAX_EVENTS;
+	m_NumEvents = minimum(m_NumEvents + 1, (int)MAX_EVENTS);
+}
+
+void CTickProfiler::Reset()
+{
+	for(int i = 0; i < m_NumSections; i++)
+		m_aSections[i].m_Histogram.Reset();
+	m_NextEvent = 0;
+	m_NumEvents = 0;
+}
+
+void CTickProfiler::FormatSummary(int Section, char *pBuf, int BufSize) const
+{
+	const CDurationHistogram &Histogram = m_aSections[Section].m_Histogram;
+	str_format(pBuf, BufSize, "%s: count=%" PRId64 " mean=%.1fus p50=%.1fus p90=%.1fus p99=%.1fus max=%.1fus total=%.1fms",
+		m_aSections[Section].m_aName, Histogram.Count(),
+		Histogram.Mean() / 1000.0, Histogram.Percentile(50) / 1000.0, Histogram.Percentile(90) / 1000.0,
+		Histogram.Percentile(99) / 1000.0, Histogram.Max() / 1000.0, Histogram.Sum() / 1000000.0);
+}
+
+bool CTickProfiler::WriteChromeTrace(IOHANDLE File) const
+{
+	if(!File)
+		return false;
+
+	CJsonFileWriter Writer(File);
+	Writer.BeginObject();
+	Writer.WriteAttribute("displayTimeUnit");
+	Writer.WriteStrValue("ms");
+	Writer.WriteAttribute("traceEvents");
+	Writer.BeginArray();
+
+	// Timestamps are in microseconds relative to the earliest start. Scopes
+	// are recorded when they end, so the oldest event in the ring can be a
+	// nested scope that started after its parent.
+	const int First = (m_NextEvent - m_NumEvents + MAX_EVENTS) % MAX_EVENTS;
+	int64_t Base = m_NumEvents ? m_vEvents[First].m_Start : 0;
+	for(int i = 0; i < m_NumEvents; i++)
+		Base = minimum(Base, m_vEvents[(First + i) % MAX_EVENTS].m_Start);
+	for(int i = 0; i < m_NumEvents; i++)
+	{
+		const CEvent &Event = m_vEvents[(First + i) % MAX_EVENTS];
+		Writer.BeginObject();
+		Writer.WriteAttribute("name");
+		Writer.WriteStrValue(m_aSections[Event.m_Section].m_aName);
+		Writer.WriteAttribute("ph");
+		Writer.WriteStrValue("X");
+		Writer.WriteAttribute("ts");
+		Writer.WriteInt64Value((Event.m_Start - Base) / 1000);
+		Writer.WriteAttribute("dur");
+		Writer.WriteInt64Value((Event.m_Duration + 500) / 1000);
+		Writer.WriteAttribute("pid");
+		Writer.WriteIntValue(0);
+		Writer.WriteAttribute("tid");
+		Writer.WriteIntValue(0);
+		Writer.WriteAttribute("args");
+		Writer.BeginObject();
+		Writer.WriteAttribute("tick");
+		Writer.WriteIntValue(Event.m_Tick);
+		Writer.EndObject();
+		Writer.EndObject();
+	}
+
+	Writer.EndArray();
+	Writer.EndObject();
+	return true;
+}
@@ -0,0 +1,121 @@
+#ifndef ENGINE_SHARED_TICKPROFILER_H
+#define ENGINE_SHARED_TICKPROFILER_H
+
+#include <base/system.h>
+
+#include <cstdint>
+#include <vector>
+
+// histogram of durations in nanoseconds with log-linear buckets, the
+// relative error of the reported values stays below 1/SUB_BUCKETS
+class CDurationHistogram
+{
+public:
+	enum
+	{
+		SUB_BUCKET_BITS = 4,
+		SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+		NUM_BUCKETS = (64 - SUB_BUCKET_BITS) * SUB_BUCKETS,
+	};
+
+	CDurationHistogram() { Reset(); }
+
+	void Reset();
+	void Record(int64_t Value);
+
+	int64_t Count() const { return m_Count; }
+	int64_t Min() const { return m_Count ? m_Min : 0; }
+	int64_t Max() const { return m_Max; }
+	int64_t Sum() const { return m_Sum; }
+	int64_t Mean() const { return m_Count ? m_Sum / m_Count : 0; }
+	int64_t Percentile(double Percentile) const;
+
+	static int BucketIndex(int64_t Value);
+	static int64_t BucketLowerBound(int Index);
+
+private:
+	uint32_t m_aBuckets[NUM_BUCKETS];
+	int64_t m_Count;
+	int64_t m_Min;
+	int64_t m_Max;
+	int64_t m_Sum;
+};
+
+// collects how long named sections of the server tick take. Every section
+// has a histogram, and the most recent measurements are kept in a ring so
+// that they can be exported as a Chrome trace.
+class CTickProfiler
+{
+public:
+	enum
+	{
+		MAX_SECTIONS = 64,
+		MAX_EVENTS = 1 << 16,
+	};
+
+	class CScope
+	{
+		CTickProfiler *m_pProfiler;
+		int m_Section;
+		int64_t m_Start;
+
+	public:
+		CScope(CTickProfiler *pProfiler, int Section) :
+			m_pProfiler(pProfiler && pProfiler->Enabled() ? pProfiler : nullptr),
+			m_Section(Section),
+			m_Start(m_pProfiler ? Now() : 0)
+		{
+		}
+		~CScope()
+		{
+			if(m_pProfiler)
+				m_pProfiler->Record(m_Section, m_Start, Now() - m_Start);
+		}
+	};
+
+	CTickProfiler();
+
+	// returns the id of the section with this name, adding it if necessary
+	int AddSection(const char *pName);
+	int NumSections() const { return m_NumSections; }
+	const char *SectionName(int Section) const { return m_aSections[Section].m_aName; }
+	const CDurationHistogram &Histogram(int Section) const { return m_aSections[Section].m_Histogram; }
+
+	bool Enabled() const { return m_Enabled; }
+	void SetEnabled(bool Enabled) { m_Enabled = Enabled; }
+	void SetTick(int Tick) { m_Tick = Tick; }
+
+	void Record(int Section, int64_t Start, int64_t Duration);
+	void Reset();
+
+	// formats a one line summary of the durations recorded for the section
+	void FormatSummary(int Section, char *pBuf, int BufSize) const;
+	bool WriteChromeTrace(IOHANDLE File) const;
+
+	static int64_t Now() { return time_get_nanoseconds().count(); }
+
+private:
+	struct CSection
+	{
+		char m_aName[32];
+		CDurationHistogram m_Histogram;
+	};
+
+	struct CEvent
+	{
+		int64_t m_Start;
+		int64_t m_Duration;
+		int m_Section;
+		int m_Tick;
+	};
+
+	bool m_Enabled = false;
+	int m_Tick = 0;
+	int m_NumSections = 0;
+	CSection m_aSections[MAX_SECTIONS];
+	std::vector<CEvent> m_vEvents;
+	int m_NextEvent = 0;
+	int m_NumEvents = 0;
+};
+
+#endif
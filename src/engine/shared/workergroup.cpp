@@ -0,0 +1,88 @@
+#include "workergroup.h"
+
+CWorkerGroup::~CWorkerGroup()
+{
+	Shutdown();
+}
+
+void CWorkerGroup::Init(int NumThreads)
+{
+	Shutdown();
+	m_Shutdown = false;
+	for(int i = 0; i < NumThreads; i++)
+		m_vThreads.emplace_back([this, i]() { WorkerLoop(i + 1); });
+}
+
+void CWorkerGroup::Shutdown()
+{
+	{
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		m_Shutdown = true;
+	}
+	m_StartCond.notify_all();
+	for(auto &Thread : m_vThreads)
+		Thread.join();
+	m_vThreads.clear();
+}
+
+void CWorkerGroup::Run(int NumTasks, const FTask &Task)
+{
+	if(m_vThreads.empty() || NumTasks <= 1)
+	{
+		for(int i = 0; i < NumTasks; i++)
+			Task(i, 0);
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> Lock(m_Mutex);
+		// a helper thread that woke up late for the previous batch might still be looking for tasks
+		m_DoneCond.wait(Lock, [this]() { return m_NumBusy == 0; });
+		m_pTask = &Task;
+		m_NumTasks = NumTasks;
+		m_NextTask = 0;
+		m_NumDone = 0;
+		m_Generation++;
+		m_NumBusy++;
+	}
+	m_StartCond.notify_all();
+
+	WorkOn(0);
+
+	std::unique_lock<std::mutex> Lock(m_Mutex);
+	m_DoneCond.wait(Lock, [this]() { return m_NumDone == m_NumTasks && m_NumBusy == 0; });
+	m_pTask = nullptr;
+}
+
+void CWorkerGroup::WorkerLoop(int Worker)
+{
+	unsigned SeenGeneration = 0;
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> Lock(m_Mutex);
+			m_StartCond.wait(Lock, [&]() { return m_Shutdown || m_Generation != SeenGeneration; });
+			if(m_Shutdown)
+				return;
+			SeenGeneration = m_Generation;
+			m_NumBusy++;
+		}
+		WorkOn(Worker);
+	}
+}
+
+void CWorkerGroup::WorkOn(int Worker)
+{
+	std::unique_lock<std::mutex> Lock(m_Mutex);
+	while(m_NextTask < m_NumTasks)
+	{
+		const int Task = m_NextTask++;
+		Lock.unlock();
+		(*m_pTask)(Task, Worker);
+		Lock.lock();
+		m_NumDone++;
+	}
+	m_NumBusy--;
+	if(m_NumBusy == 0)
+		m_DoneCond.notify_all();
+}
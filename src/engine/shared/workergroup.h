@@ -0,0 +1,53 @@
+#ifndef ENGINE_SHARED_WORKERGROUP_H
+#define ENGINE_SHARED_WORKERGROUP_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// runs batches of independent tasks on a fixed set of threads. Unlike the
+// job pool, Run blocks until the whole batch is done and the calling
+// thread works on the batch too, so it can be used inside a frame or a tick.
+class CWorkerGroup
+{
+public:
+	// Task is the index of the task, Worker is 0 for the calling thread
+	// and 1 to NumThreads() for the helper threads
+	typedef std::function<void(int Task, int Worker)> FTask;
+
+	CWorkerGroup() = default;
+	~CWorkerGroup();
+
+	CWorkerGroup(const CWorkerGroup &Other) = delete;
+	CWorkerGroup &operator=(const CWorkerGroup &Other) = delete;
+
+	// starts NumThreads helper threads, 0 runs all tasks on the calling thread
+	void Init(int NumThreads);
+	void Shutdown();
+	int NumThreads() const { return m_vThreads.size(); }
+
+	void Run(int NumTasks, const FTask &Task);
+
+private:
+	void WorkerLoop(int Worker);
+	void WorkOn(int Worker);
+
+	std::vector<std::thread> m_vThreads;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_StartCond;
+	std::condition_variable m_DoneCond;
+	bool m_Shutdown = false;
+	unsigned m_Generation = 0;
+	int m_NumBusy = 0;
+
+	// only changed while no worker is busy
+	const FTask *m_pTask = nullptr;
+	int m_NumTasks = 0;
+	int m_NextTask = 0;
+	int m_NumDone = 0;
+};
+
+#endif
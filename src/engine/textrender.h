@@ -322,6 +322,18 @@ public:
 	virtual void SetFontPreset(EFontPreset FontPreset) = 0;
 	virtual void SetFontLanguageVariant(const char *pLanguageFile) = 0;
 
+	/**
+	 * Rasterizes the glyphs of the given text in the background, so they are
+	 * already in the glyph atlas when the text is first rendered.
+	 * The font size is interpreted relative to the current screen mapping.
+	 */
+	virtual void PrewarmGlyphs(const char *pText, float FontSize) = 0;
+	/**
+	 * Whether glyphs are still being prewarmed. The prewarmed glyphs are added
+	 * to the glyph atlas by the first call after they are ready.
+	 */
+	virtual bool IsPrewarming() = 0;
+
 	virtual void SetRenderFlags(unsigned Flags) = 0;
 	virtual unsigned GetRenderFlags() const = 0;
 
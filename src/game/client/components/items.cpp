@@ -314,33 +314,30 @@ void CItems::RenderLaser(const CLaserData *pCurrent, bool IsPredicted)
 		a = clamp(a, 0.0f, 1.0f);
 		float Ia = 1 - a;
 
-		vec2 Out;
+		// outline and inner part are drawn together
+		IGraphics::CFreeformQuad aQuads[2];
+		const float aWidths[2] = {7.0f, 5.0f};
+		const ColorRGBA aColors[2] = {
+			ColorRGBA(OuterColor.r, OuterColor.g, OuterColor.b, Alpha),
+			ColorRGBA(InnerColor.r, InnerColor.g, InnerColor.b, Alpha)};
+		for(int i = 0; i < 2; i++)
+		{
+			const vec2 Out = vec2(Dir.y, -Dir.x) * (aWidths[i] * Ia);
+			aQuads[i].m_aPos[0] = From - Out;
+			aQuads[i].m_aPos[1] = From + Out;
+			aQuads[i].m_aPos[2] = Pos - Out;
+			aQuads[i].m_aPos[3] = Pos + Out;
+			aQuads[i].m_aTexCoords[0] = vec2(0.0f, 0.0f);
+			aQuads[i].m_aTexCoords[1] = vec2(1.0f, 0.0f);
+			aQuads[i].m_aTexCoords[2] = vec2(0.0f, 1.0f);
+			aQuads[i].m_aTexCoords[3] = vec2(1.0f, 1.0f);
+			for(ColorRGBA &Color : aQuads[i].m_aColors)
+				Color = aColors[i];
+		}
 
 		Graphics()->TextureClear();
 		Graphics()->QuadsBegin();
-
-		// do outline
-		Graphics()->SetColor(OuterColor.r, OuterColor.g, OuterColor.b, Alpha);
-		Out = vec2(Dir.y, -Dir.x) * (7.0f * Ia);
-
-		IGraphics::CFreeformItem Freeform(
-			From.x - Out.x, From.y - Out.y,
-			From.x + Out.x, From.y + Out.y,
-			Pos.x - Out.x, Pos.y - Out.y,
-			Pos.x + Out.x, Pos.y + Out.y);
-		Graphics()->QuadsDrawFreeform(&Freeform, 1);
-
-		// do inner
-		Out = vec2(Dir.y, -Dir.x) * (5.0f * Ia);
-		Graphics()->SetColor(InnerColor.r, InnerColor.g, InnerColor.b, Alpha); // center
-
-		Freeform = IGraphics::CFreeformItem(
-			From.x - Out.x, From.y - Out.y,
-			From.x + Out.x, From.y + Out.y,
-			Pos.x - Out.x, Pos.y - Out.y,
-			Pos.x + Out.x, Pos.y + Out.y);
-		Graphics()->QuadsDrawFreeform(&Freeform, 1);
-
+		Graphics()->QuadsDrawFreeformBatch(aQuads, std::size(aQuads));
 		Graphics()->QuadsEnd();
 	}
 
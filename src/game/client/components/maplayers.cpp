@@ -60,6 +60,16 @@ void CMapLayers::EnvelopeEval(int TimeOffsetMillis, int Env, ColorRGBA &Result,
 		return;
 	Channels = minimum<size_t>(Channels, pItem->m_Channels, CEnvPoint::MAX_CHANNELS);
 
+	// the time only changes between frames, so every envelope has to be
+	// evaluated once per frame for each time offset it is used with
+	if(pThis->m_EnvelopeCacheFrame != pThis->Graphics()->FrameCount())
+	{
+		pThis->m_EnvelopeCache.Clear();
+		pThis->m_EnvelopeCacheFrame = pThis->Graphics()->FrameCount();
+	}
+	if(pThis->m_EnvelopeCache.Find(Env, TimeOffsetMillis, Channels, Result))
+		return;
+
 	CMapBasedEnvelopePointAccess EnvelopePoints(pThis->m_pLayers->Map());
 	EnvelopePoints.SetPointsRange(pItem->m_StartPoint, pItem->m_NumPoints);
 	if(EnvelopePoints.NumPoints() == 0)
@@ -89,87 +99,14 @@ void CMapLayers::EnvelopeEval(int TimeOffsetMillis, int Env, ColorRGBA &Result,
 		s_Time += CurTime - s_LastLocalTime;
 		s_LastLocalTime = CurTime;
 	}
-	CRenderTools::RenderEvalEnvelope(&EnvelopePoints, s_Time + std::chrono::nanoseconds(std::chrono::milliseconds(TimeOffsetMillis)), Result, Channels);
-}
-
-static void FillTmpTile(SGraphicTile *pTmpTile, SGraphicTileTexureCoords *pTmpTex, unsigned char Flags, unsigned char Index, int x, int y, const ivec2 &Offset, int Scale)
-{
-	if(pTmpTex)
-	{
-		unsigned char x0 = 0;
-		unsigned char y0 = 0;
-		unsigned char x1 = x0 + 1;
-		unsigned char y1 = y0;
-		unsigned char x2 = x0 + 1;
-		unsigned char y2 = y0 + 1;
-		unsigned char x3 = x0;
-		unsigned char y3 = y0 + 1;
-
-		if(Flags & TILEFLAG_XFLIP)
-		{
-			x0 = x2;
-			x1 = x3;
-			x2 = x3;
-			x3 = x0;
-		}
-
-		if(Flags & TILEFLAG_YFLIP)
-		{
-			y0 = y3;
-			y2 = y1;
-			y3 = y1;
-			y1 = y0;
-		}
-
-		if(Flags & TILEFLAG_ROTATE)
-		{
-			unsigned char Tmp = x0;
-			x0 = x3;
-			x3 = x2;
-			x2 = x1;
-			x1 = Tmp;
-			Tmp = y0;
-			y0 = y3;
-			y3 = y2;
-			y2 = y1;
-			y1 = Tmp;
-		}
-
-		pTmpTex->m_TexCoordTopLeft.x = x0;
-		pTmpTex->m_TexCoordTopLeft.y = y0;
-		pTmpTex->m_TexCoordBottomLeft.x = x3;
-		pTmpTex->m_TexCoordBottomLeft.y = y3;
-		pTmpTex->m_TexCoordTopRight.x = x1;
-		pTmpTex->m_TexCoordTopRight.y = y1;
-		pTmpTex->m_TexCoordBottomRight.x = x2;
-		pTmpTex->m_TexCoordBottomRight.y = y2;
-
-		pTmpTex->m_TexCoordTopLeft.z = Index;
-		pTmpTex->m_TexCoordBottomLeft.z = Index;
-		pTmpTex->m_TexCoordTopRight.z = Index;
-		pTmpTex->m_TexCoordBottomRight.z = Index;
-
-		bool HasRotation = (Flags & TILEFLAG_ROTATE) != 0;
-		pTmpTex->m_TexCoordTopLeft.w = HasRotation;
-		pTmpTex->m_TexCoordBottomLeft.w = HasRotation;
-		pTmpTex->m_TexCoordTopRight.w = HasRotation;
-		pTmpTex->m_TexCoordBottomRight.w = HasRotation;
-	}
-
-	pTmpTile->m_TopLeft.x = x * Scale + Offset.x;
-	pTmpTile->m_TopLeft.y = y * Scale + Offset.y;
-	pTmpTile->m_BottomLeft.x = x * Scale + Offset.x;
-	pTmpTile->m_BottomLeft.y = y * Scale + Scale + Offset.y;
-	pTmpTile->m_TopRight.x = x * Scale + Scale + Offset.x;
-	pTmpTile->m_TopRight.y = y * Scale + Offset.y;
-	pTmpTile->m_BottomRight.x = x * Scale + Scale + Offset.x;
-	pTmpTile->m_BottomRight.y = y * Scale + Scale + Offset.y;
+	EvalEnvelope(&EnvelopePoints, s_Time + std::chrono::nanoseconds(std::chrono::milliseconds(TimeOffsetMillis)), Result, Channels);
+	pThis->m_EnvelopeCache.Add(Env, TimeOffsetMillis, Channels, Result);
 }
 
 static void FillTmpTileSpeedup(SGraphicTile *pTmpTile, SGraphicTileTexureCoords *pTmpTex, unsigned char Flags, int x, int y, const ivec2 &Offset, int Scale, short AngleRotate)
 {
 	int Angle = AngleRotate % 360;
-	FillTmpTile(pTmpTile, pTmpTex, Angle >= 270 ? ROTATION_270 : (Angle >= 180 ? ROTATION_180 : (Angle >= 90 ? ROTATION_90 : 0)), AngleRotate % 90, x, y, Offset, Scale);
+	CRenderTools::FillTileVertices(pTmpTile, pTmpTex, Angle >= 270 ? ROTATION_270 : (Angle >= 180 ? ROTATION_180 : (Angle >= 90 ? ROTATION_90 : 0)), AngleRotate % 90, x, y, Offset, Scale);
 }
 
 bool CMapLayers::STileLayerVisuals::Init(unsigned int Width, unsigned int Height)
@@ -215,7 +152,7 @@ static bool AddTile(std::vector<SGraphicTile> &vTmpTiles, std::vector<SGraphicTi
 		if(FillSpeedup)
 			FillTmpTileSpeedup(&Tile, pTileTex, Flags, x, y, Offset, Scale, AngleRotate);
 		else
-			FillTmpTile(&Tile, pTileTex, Flags, Index, x, y, Offset, Scale);
+			CRenderTools::FillTileVertices(&Tile, pTileTex, Flags, Index, x, y, Offset, Scale);
 
 		return true;
 	}
@@ -278,6 +215,8 @@ CMapLayers::~CMapLayers()
 
 void CMapLayers::OnMapLoad()
 {
+	m_EnvelopeCache.Clear();
+
 	if(!Graphics()->IsTileBufferingEnabled() && !Graphics()->IsQuadBufferingEnabled())
 		return;
 
@@ -1455,7 +1394,7 @@ void CMapLayers::OnRender()
 				CServerInfo CurrentServerInfo;
 				Client()->GetServerInfo(&CurrentServerInfo);
 				char aFilename[IO_MAX_PATH_LENGTH];
-				str_format(aFilename, sizeof(aFilename), "dumps/tilelayer_dump_%s-%d-%d-%dx%d.txt", CurrentServerInfo.m_aMap, g, l, pTMap->m_Width, pTMap->m_Height);
+				str_format(aFilename, sizeof(aFilename), "dumps/tilelayer_dump_%s-%d-%d-%dx%d.txt", CurrentServerInfo.m_pMap, g, l, pTMap->m_Width, pTMap->m_Height);
 				IOHANDLE File = Storage()->OpenFile(aFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
 				if(File)
 				{
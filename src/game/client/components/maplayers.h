@@ -3,6 +3,7 @@
 #ifndef GAME_CLIENT_COMPONENTS_MAPLAYERS_H
 #define GAME_CLIENT_COMPONENTS_MAPLAYERS_H
 #include <game/client/component.h>
+#include <game/envelope.h>
 
 #include <cstdint>
 #include <vector>
@@ -34,6 +35,9 @@ class CMapLayers : public CComponent
 	int m_Type;
 	bool m_OnlineOnly;
 
+	CEnvelopeEvalCache m_EnvelopeCache;
+	uint64_t m_EnvelopeCacheFrame = 0;
+
 	struct STileLayerVisuals
 	{
 		STileLayerVisuals() :
@@ -880,6 +880,8 @@ void CMenus::OnInit()
 	m_RefreshButton.Init(Ui(), -1);
 	m_ConnectButton.Init(Ui(), -1);
 
+	m_pDemoHeaderCache = std::shared_ptr<IDemoHeaderCache>(CreateDemoHeaderCache(Console(), Storage()));
+
 	Console()->Chain("add_favorite", ConchainFavoritesUpdate, this);
 	Console()->Chain("remove_favorite", ConchainFavoritesUpdate, this);
 	Console()->Chain("add_friend", ConchainFriendlistUpdate, this);
@@ -1493,7 +1495,7 @@ void CMenus::RenderPopupFullscreen(CUIRect Screen)
 			Icon.VSplitLeft(80.0f, &Icon, 0);
 			Name.VSplitLeft(20.0f, 0, &Name);
 
-			const SCommunityIcon *pIcon = FindCommunityIcon(pEntry->m_Info.m_aCommunityId);
+			const SCommunityIcon *pIcon = FindCommunityIcon(pEntry->m_Info.m_pCommunityId);
 			if(pIcon != nullptr)
 				RenderCommunityIcon(pIcon, Icon, true);
 			else
@@ -2182,6 +2184,11 @@ void CMenus::OnReset()
 void CMenus::OnShutdown()
 {
 	KillServer();
+	if(m_pDemoListJob)
+	{
+		m_pDemoListJob->Abort();
+		m_pDemoListJob = nullptr;
+	}
 	m_CommunityIconLoadJobs.clear();
 	m_CommunityIconDownloadJobs.clear();
 }
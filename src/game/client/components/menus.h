@@ -3,15 +3,19 @@
 #ifndef GAME_CLIENT_COMPONENTS_MENUS_H
 #define GAME_CLIENT_COMPONENTS_MENUS_H
 
+#include <base/lock.h>
 #include <base/types.h>
 #include <base/vmath.h>
 
 #include <chrono>
 #include <deque>
+#include <memory>
 #include <optional>
+#include <string>
 #include <unordered_set>
 #include <vector>
 
+#include <engine/client/demo_header_cache.h>
 #include <engine/console.h>
 #include <engine/demo.h>
 #include <engine/friends.h>
@@ -293,6 +297,9 @@ protected:
 		bool m_IsLink;
 		int m_StorageType;
 		time_t m_Date;
+		int64_t m_FileSize;
+		// position in the order the demo list job found the items, -1 for the links
+		int m_ScanIndex;
 
 		bool m_InfosLoaded;
 		bool m_Valid;
@@ -362,10 +369,69 @@ protected:
 	int m_Speed = 4;
 	bool m_StartPaused = false;
 
-	std::chrono::nanoseconds m_DemoPopulateStartTime{0};
+	// lists a demo folder and reads the headers of its demos, the results
+	// are taken over by UpdateDemolistJob while the job is running
+	class CDemoListJob : public IJob
+	{
+	public:
+		class CHeaderResult
+		{
+		public:
+			int m_ScanIndex;
+			IDemoHeaderCache::CEntry m_Entry;
+		};
+
+		// the headers of `vpItems` are read, and of the demos found in the
+		// folder if `ListFolder` is set
+		CDemoListJob(CMenus *pMenus, bool ListFolder, bool FetchHeaders, const std::vector<const CDemoItem *> &vpItems);
+
+		void TakeResults(std::vector<CDemoItem> &vItems, std::vector<CHeaderResult> &vHeaders) REQUIRES(!m_Lock);
+
+	protected:
+		void Run() override REQUIRES(!m_Lock);
+
+	private:
+		class CDemoFile
+		{
+		public:
+			int m_ScanIndex;
+			std::string m_Filename;
+			int m_StorageType;
+			int64_t m_Size;
+			time_t m_Modified;
+		};
+
+		static int ListCallback(const CFsFileInfo *pInfo, int IsDir, int StorageType, void *pUser) NO_THREAD_SAFETY_ANALYSIS;
+		void PublishItems() REQUIRES(!m_Lock);
+		void PublishHeaders() REQUIRES(!m_Lock);
+
+		CMenus *m_pMenus;
+		std::shared_ptr<IDemoHeaderCache> m_pHeaderCache;
+		char m_aFolder[IO_MAX_PATH_LENGTH];
+		int m_StorageType;
+		bool m_ListFolder;
+		bool m_FetchHeaders;
+		bool m_ShowParentFolder;
+
+		std::vector<CDemoFile> m_vFiles;
+		std::vector<CDemoItem> m_vNewItems;
+		std::vector<CHeaderResult> m_vNewHeaders;
+
+		CLock m_Lock;
+		std::vector<CDemoItem> m_vItems GUARDED_BY(m_Lock);
+		std::vector<CHeaderResult> m_vHeaders GUARDED_BY(m_Lock);
+	};
+
+	std::shared_ptr<CDemoListJob> m_pDemoListJob;
+	std::shared_ptr<IDemoHeaderCache> m_pDemoHeaderCache;
+	std::chrono::nanoseconds m_DemolistLastUpdate{0};
+	std::chrono::nanoseconds m_DemolistLastSort{0};
+	bool m_DemolistResetPending = false;
 
 	void DemolistOnUpdate(bool Reset);
-	static int DemolistFetchCallback(const CFsFileInfo *pInfo, int IsDir, int StorageType, void *pUser);
+	void StartDemolistJob(bool ListFolder, bool FetchHeaders, const std::vector<const CDemoItem *> &vpItems);
+	void UpdateDemolistJob();
+	bool LoadDemoHeader(const char *pFolder, const char *pFilename, int StorageType, int64_t Size, time_t Modified, IDemoHeaderCache::CEntry *pEntry) const;
 
 	// friends
 	class CFriendItem
@@ -406,9 +472,9 @@ protected:
 			m_CustomSkinColorBody(CurrentClient.m_CustomSkinColorBody),
 			m_CustomSkinColorFeet(CurrentClient.m_CustomSkinColorFeet)
 		{
-			str_copy(m_aName, CurrentClient.m_aName);
-			str_copy(m_aClan, CurrentClient.m_aClan);
-			str_copy(m_aSkin, CurrentClient.m_aSkin);
+			str_copy(m_aName, CurrentClient.m_pName);
+			str_copy(m_aClan, CurrentClient.m_pClan);
+			str_copy(m_aSkin, CurrentClient.m_pSkin);
 		}
 
 		const char *Name() const { return m_aName; }
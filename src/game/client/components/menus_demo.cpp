@@ -6,6 +6,7 @@
 #include <base/system.h>
 
 #include <engine/demo.h>
+#include <engine/engine.h>
 #include <engine/graphics.h>
 #include <engine/keys.h>
 #include <engine/shared/localization.h>
@@ -902,11 +903,27 @@ void CMenus::RenderDemoPlayerSliceSavePopup(CUIRect MainView)
 	}
 }
 
-int CMenus::DemolistFetchCallback(const CFsFileInfo *pInfo, int IsDir, int StorageType, void *pUser)
+CMenus::CDemoListJob::CDemoListJob(CMenus *pMenus, bool ListFolder, bool FetchHeaders, const std::vector<const CDemoItem *> &vpItems) :
+	m_pMenus(pMenus),
+	m_pHeaderCache(pMenus->m_pDemoHeaderCache),
+	m_StorageType(pMenus->m_DemolistStorageType),
+	m_ListFolder(ListFolder),
+	m_FetchHeaders(FetchHeaders)
 {
-	CMenus *pSelf = (CMenus *)pUser;
+	str_copy(m_aFolder, pMenus->m_aCurrentDemoFolder);
+	m_ShowParentFolder = !(m_aFolder[0] == '\0' || (!pMenus->m_DemolistMultipleStorages && str_comp(m_aFolder, "demos") == 0));
+	for(const CDemoItem *pItem : vpItems)
+		m_vFiles.push_back(CDemoFile{pItem->m_ScanIndex, pItem->m_aFilename, pItem->m_StorageType, pItem->m_FileSize, pItem->m_Date});
+	Abortable(true);
+}
+
+int CMenus::CDemoListJob::ListCallback(const CFsFileInfo *pInfo, int IsDir, int StorageType, void *pUser)
+{
+	CDemoListJob *pSelf = static_cast<CDemoListJob *>(pUser);
+	if(pSelf->State() == IJob::STATE_ABORTED)
+		return 1;
 	if(str_comp(pInfo->m_pName, ".") == 0 ||
-		(str_comp(pInfo->m_pName, "..") == 0 && (pSelf->m_aCurrentDemoFolder[0] == '\0' || (!pSelf->m_DemolistMultipleStorages && str_comp(pSelf->m_aCurrentDemoFolder, "demos") == 0))) ||
+		(str_comp(pInfo->m_pName, "..") == 0 && !pSelf->m_ShowParentFolder) ||
 		(!IsDir && !str_endswith(pInfo->m_pName, ".demo")))
 	{
 		return 0;
@@ -924,23 +941,174 @@ int CMenus::DemolistFetchCallback(const CFsFileInfo *pInfo, int IsDir, int Stora
 		str_truncate(Item.m_aName, sizeof(Item.m_aName), pInfo->m_pName, str_length(pInfo->m_pName) - str_length(".demo"));
 		Item.m_Date = pInfo->m_TimeModified;
 	}
+	Item.m_FileSize = pInfo->m_Size;
+	Item.m_ScanIndex = pSelf->m_vFiles.size();
 	Item.m_InfosLoaded = false;
 	Item.m_Valid = false;
 	Item.m_IsDir = IsDir != 0;
 	Item.m_IsLink = false;
 	Item.m_StorageType = StorageType;
-	pSelf->m_vDemos.push_back(Item);
+	pSelf->m_vNewItems.push_back(Item);
 
-	if(time_get_nanoseconds() - pSelf->m_DemoPopulateStartTime > 500ms)
+	// directories are kept as well so that the position is the scan index
+	pSelf->m_vFiles.push_back(CDemoFile{Item.m_ScanIndex, IsDir ? "" : pInfo->m_pName, StorageType, pInfo->m_Size, Item.m_Date});
+
+	if(pSelf->m_vNewItems.size() >= 256)
+		pSelf->PublishItems();
+	return 0;
+}
+
+void CMenus::CDemoListJob::PublishItems()
+{
+	const CLockScope LockScope(m_Lock);
+	m_vItems.insert(m_vItems.end(), m_vNewItems.begin(), m_vNewItems.end());
+	m_vNewItems.clear();
+}
+
+void CMenus::CDemoListJob::PublishHeaders()
+{
+	const CLockScope LockScope(m_Lock);
+	m_vHeaders.insert(m_vHeaders.end(), m_vNewHeaders.begin(), m_vNewHeaders.end());
+	m_vNewHeaders.clear();
+}
+
+void CMenus::CDemoListJob::TakeResults(std::vector<CDemoItem> &vItems, std::vector<CHeaderResult> &vHeaders)
+{
+	const CLockScope LockScope(m_Lock);
+	std::swap(vItems, m_vItems);
+	std::swap(vHeaders, m_vHeaders);
+}
+
+void CMenus::CDemoListJob::Run()
+{
+	if(m_ListFolder)
 	{
-		pSelf->RenderLoading(Localize("Loading demo files"), "", 0);
+		m_pMenus->Storage()->ListDirectoryInfo(m_StorageType, m_aFolder, ListCallback, this);
+		PublishItems();
 	}
 
-	return 0;
+	if(m_FetchHeaders)
+	{
+		for(const CDemoFile &File : m_vFiles)
+		{
+			if(State() == IJob::STATE_ABORTED)
+				break;
+			if(File.m_Filename.empty())
+				continue;
+			CHeaderResult Result;
+			Result.m_ScanIndex = File.m_ScanIndex;
+			m_pMenus->LoadDemoHeader(m_aFolder, File.m_Filename.c_str(), File.m_StorageType, File.m_Size, File.m_Modified, &Result.m_Entry);
+			m_vNewHeaders.push_back(Result);
+			if(m_vNewHeaders.size() >= 64)
+				PublishHeaders();
+		}
+		PublishHeaders();
+		if(m_pHeaderCache)
+			m_pHeaderCache->Flush();
+	}
+}
+
+bool CMenus::LoadDemoHeader(const char *pFolder, const char *pFilename, int StorageType, int64_t Size, time_t Modified, IDemoHeaderCache::CEntry *pEntry) const
+{
+	char aPath[IO_MAX_PATH_LENGTH];
+	str_format(aPath, sizeof(aPath), "%s/%s", pFolder, pFilename);
+	char aCompletePath[IO_MAX_PATH_LENGTH];
+	Storage()->GetCompletePath(StorageType, aPath, aCompletePath, sizeof(aCompletePath));
+	if(m_pDemoHeaderCache && m_pDemoHeaderCache->Get(aCompletePath, Size, Modified, pEntry))
+		return pEntry->m_Valid;
+
+	// no console, this also runs in the demo list job
+	pEntry->m_Valid = DemoPlayer()->GetDemoInfo(Storage(), nullptr, aPath, StorageType, &pEntry->m_Info, &pEntry->m_TimelineMarkers, &pEntry->m_MapInfo);
+	if(m_pDemoHeaderCache)
+		m_pDemoHeaderCache->Set(aCompletePath, Size, Modified, *pEntry);
+	return pEntry->m_Valid;
+}
+
+void CMenus::StartDemolistJob(bool ListFolder, bool FetchHeaders, const std::vector<const CDemoItem *> &vpItems)
+{
+	if(m_pDemoListJob)
+		m_pDemoListJob->Abort();
+	m_pDemoListJob = std::make_shared<CDemoListJob>(this, ListFolder, FetchHeaders, vpItems);
+	Engine()->AddJob(m_pDemoListJob);
+	m_DemolistLastUpdate = time_get_nanoseconds();
+	m_DemolistLastSort = m_DemolistLastUpdate;
+}
+
+void CMenus::UpdateDemolistJob()
+{
+	if(!m_pDemoListJob)
+		return;
+
+	// the results are taken over a few times per second, the list has to
+	// be filtered again after every change
+	const bool Done = m_pDemoListJob->Done();
+	const std::chrono::nanoseconds Now = time_get_nanoseconds();
+	if(!Done && Now - m_DemolistLastUpdate < 100ms)
+		return;
+	m_DemolistLastUpdate = Now;
+
+	std::vector<CDemoItem> vItems;
+	std::vector<CDemoListJob::CHeaderResult> vHeaders;
+	m_pDemoListJob->TakeResults(vItems, vHeaders);
+	m_vDemos.insert(m_vDemos.end(), vItems.begin(), vItems.end());
+
+	if(!vHeaders.empty())
+	{
+		int NumScanned = 0;
+		for(const CDemoItem &Item : m_vDemos)
+			NumScanned = maximum(NumScanned, Item.m_ScanIndex + 1);
+		std::vector<int> vPositions(NumScanned, -1);
+		for(int i = 0; i < (int)m_vDemos.size(); i++)
+		{
+			if(m_vDemos[i].m_ScanIndex >= 0)
+				vPositions[m_vDemos[i].m_ScanIndex] = i;
+		}
+		for(const CDemoListJob::CHeaderResult &Result : vHeaders)
+		{
+			if(Result.m_ScanIndex >= NumScanned || vPositions[Result.m_ScanIndex] < 0)
+				continue;
+			CDemoItem &Item = m_vDemos[vPositions[Result.m_ScanIndex]];
+			Item.m_Valid = Result.m_Entry.m_Valid;
+			Item.m_Info = Result.m_Entry.m_Info;
+			Item.m_TimelineMarkers = Result.m_Entry.m_TimelineMarkers;
+			Item.m_MapInfo = Result.m_Entry.m_MapInfo;
+			Item.m_InfosLoaded = true;
+		}
+	}
+
+	// sorting all demos is expensive, so it is only done once per second
+	// while the job is running
+	if(Done || Now - m_DemolistLastSort >= 1s)
+	{
+		std::stable_sort(m_vDemos.begin(), m_vDemos.end());
+		m_DemolistLastSort = Now;
+	}
+
+	if(Done)
+		m_pDemoListJob = nullptr;
+
+	if(!vItems.empty() || !vHeaders.empty() || Done)
+	{
+		// don't scroll back to the selected demo while the list is growing
+		const bool SelectedReveal = m_DemolistSelectedReveal;
+		DemolistOnUpdate(false);
+		if(!Done)
+			m_DemolistSelectedReveal = SelectedReveal;
+	}
+	if(Done && m_DemolistResetPending)
+	{
+		m_DemolistResetPending = false;
+		DemolistOnUpdate(true);
+	}
 }
 
 void CMenus::DemolistPopulate()
 {
+	if(m_pDemoListJob)
+	{
+		m_pDemoListJob->Abort();
+		m_pDemoListJob = nullptr;
+	}
 	m_vDemos.clear();
 
 	int NumStoragesWithDemos = 0;
@@ -962,6 +1130,8 @@ void CMenus::DemolistPopulate()
 			Item.m_InfosLoaded = false;
 			Item.m_Valid = false;
 			Item.m_Date = 0;
+			Item.m_FileSize = 0;
+			Item.m_ScanIndex = -1;
 			Item.m_IsDir = true;
 			Item.m_IsLink = true;
 			Item.m_StorageType = IStorage::TYPE_ALL;
@@ -979,6 +1149,8 @@ void CMenus::DemolistPopulate()
 				Item.m_InfosLoaded = false;
 				Item.m_Valid = false;
 				Item.m_Date = 0;
+				Item.m_FileSize = 0;
+				Item.m_ScanIndex = -1;
 				Item.m_IsDir = true;
 				Item.m_IsLink = true;
 				Item.m_StorageType = StorageType;
@@ -988,13 +1160,9 @@ void CMenus::DemolistPopulate()
 	}
 	else
 	{
-		m_DemoPopulateStartTime = time_get_nanoseconds();
-		Storage()->ListDirectoryInfo(m_DemolistStorageType, m_aCurrentDemoFolder, DemolistFetchCallback, this);
-
-		if(g_Config.m_BrDemoFetchInfo)
-			FetchAllHeaders();
-
-		std::stable_sort(m_vDemos.begin(), m_vDemos.end());
+		// the folder is listed in the background, the demos are added to
+		// the list by UpdateDemolistJob
+		StartDemolistJob(true, g_Config.m_BrDemoFetchInfo, {});
 	}
 	RefreshFilteredDemos();
 }
@@ -1015,6 +1183,8 @@ void CMenus::DemolistOnUpdate(bool Reset)
 {
 	if(Reset)
 	{
+		// select the first demo once the folder has been listed
+		m_DemolistResetPending = m_pDemoListJob != nullptr;
 		if(m_vpFilteredDemos.empty())
 		{
 			m_DemolistSelectedIndex = -1;
@@ -1052,9 +1222,11 @@ bool CMenus::FetchHeader(CDemoItem &Item)
 {
 	if(!Item.m_InfosLoaded)
 	{
-		char aBuffer[IO_MAX_PATH_LENGTH];
-		str_format(aBuffer, sizeof(aBuffer), "%s/%s", m_aCurrentDemoFolder, Item.m_aFilename);
-		Item.m_Valid = DemoPlayer()->GetDemoInfo(Storage(), nullptr, aBuffer, Item.m_StorageType, &Item.m_Info, &Item.m_TimelineMarkers, &Item.m_MapInfo);
+		IDemoHeaderCache::CEntry Entry;
+		Item.m_Valid = LoadDemoHeader(m_aCurrentDemoFolder, Item.m_aFilename, Item.m_StorageType, Item.m_FileSize, Item.m_Date, &Entry);
+		Item.m_Info = Entry.m_Info;
+		Item.m_TimelineMarkers = Entry.m_TimelineMarkers;
+		Item.m_MapInfo = Entry.m_MapInfo;
 		Item.m_InfosLoaded = true;
 	}
 	return Item.m_Valid;
@@ -1062,11 +1234,21 @@ bool CMenus::FetchHeader(CDemoItem &Item)
 
 void CMenus::FetchAllHeaders()
 {
-	for(auto &Item : m_vDemos)
+	// the folder is still being listed without headers, list it again
+	if(m_pDemoListJob)
+	{
+		DemolistPopulate();
+		return;
+	}
+
+	std::vector<const CDemoItem *> vpItems;
+	for(const CDemoItem &Item : m_vDemos)
 	{
-		FetchHeader(Item);
+		if(!Item.m_InfosLoaded && !Item.m_IsDir && Item.m_ScanIndex >= 0)
+			vpItems.push_back(&Item);
 	}
-	std::stable_sort(m_vDemos.begin(), m_vDemos.end());
+	if(!vpItems.empty())
+		StartDemolistJob(false, true, vpItems);
 }
 
 void CMenus::RenderDemoBrowser(CUIRect MainView)
@@ -1094,6 +1276,7 @@ void CMenus::RenderDemoBrowserList(CUIRect ListView, bool &WasListboxItemActivat
 		DemolistOnUpdate(true);
 		m_DemoBrowserListInitialized = true;
 	}
+	UpdateDemolistJob();
 
 #if defined(CONF_VIDEORECORDER)
 	if(!m_DemoRenderInput.IsEmpty())
@@ -1266,6 +1449,7 @@ void CMenus::RenderDemoBrowserList(CUIRect ListView, bool &WasListboxItemActivat
 		m_DemolistSelectedIndex = NewSelected;
 		if(m_DemolistSelectedIndex >= 0)
 			str_copy(m_aCurrentDemoSelectionName, m_vpFilteredDemos[m_DemolistSelectedIndex]->m_aName);
+		m_DemolistResetPending = false;
 		DemolistOnUpdate(false);
 	}
 
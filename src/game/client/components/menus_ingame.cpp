@@ -702,8 +702,8 @@ void CMenus::RenderServerInfo(CUIRect MainView)
 			"%s: %d\n"
 			"\n"
 			"%s: %d/%d\n",
-			Localize("Game type"), CurrentServerInfo.m_aGameType,
-			Localize("Map"), CurrentServerInfo.m_aMap,
+			Localize("Game type"), CurrentServerInfo.m_pGameType,
+			Localize("Map"), CurrentServerInfo.m_pMap,
 			Localize("Score limit"), m_pClient->m_Snap.m_pGameInfoObj->m_ScoreLimit,
 			Localize("Time limit"), m_pClient->m_Snap.m_pGameInfoObj->m_TimeLimit,
 			Localize("Players"), m_pClient->m_Snap.m_NumPlayers, CurrentServerInfo.m_MaxClients);
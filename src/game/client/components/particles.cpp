@@ -10,6 +10,8 @@
 
 #include <game/client/gameclient.h>
 
+#include <vector>
+
 CParticles::CParticles()
 {
 	OnReset();
@@ -23,18 +25,8 @@ CParticles::CParticles()
 void CParticles::OnReset()
 {
 	// reset particles
-	for(int i = 0; i < MAX_PARTICLES; i++)
-	{
-		m_aParticles[i].m_PrevPart = i - 1;
-		m_aParticles[i].m_NextPart = i + 1;
-	}
-
-	m_aParticles[0].m_PrevPart = 0;
-	m_aParticles[MAX_PARTICLES - 1].m_NextPart = -1;
-	m_FirstFree = 0;
-
-	for(int &FirstPart : m_aFirstPart)
-		FirstPart = -1;
+	for(CParticleStore &Particles : m_aGroups)
+		Particles.Clear();
 }
 
 void CParticles::Add(int Group, CParticle *pPart, float TimePassed)
@@ -51,27 +43,13 @@ void CParticles::Add(int Group, CParticle *pPart, float TimePassed)
 			return;
 	}
 
-	if(m_FirstFree == -1)
+	int NumParticles = 0;
+	for(const CParticleStore &Particles : m_aGroups)
+		NumParticles += Particles.NumAlive();
+	if(NumParticles >= MAX_PARTICLES)
 		return;
 
-	// remove from the free list
-	int Id = m_FirstFree;
-	m_FirstFree = m_aParticles[Id].m_NextPart;
-	if(m_FirstFree != -1)
-		m_aParticles[m_FirstFree].m_PrevPart = -1;
-
-	// copy data
-	m_aParticles[Id] = *pPart;
-
-	// insert to the group list
-	m_aParticles[Id].m_PrevPart = -1;
-	m_aParticles[Id].m_NextPart = m_aFirstPart[Group];
-	if(m_aFirstPart[Group] != -1)
-		m_aParticles[m_aFirstPart[Group]].m_PrevPart = Id;
-	m_aFirstPart[Group] = Id;
-
-	// set some parameters
-	m_aParticles[Id].m_Life = TimePassed;
+	m_aGroups[Group].Add(*pPart, TimePassed);
 }
 
 void CParticles::Update(float TimePassed)
@@ -91,56 +69,8 @@ void CParticles::Update(float TimePassed)
 		m_FrictionFraction -= 0.05f;
 	}
 
-	for(int &FirstPart : m_aFirstPart)
-	{
-		int i = FirstPart;
-		while(i != -1)
-		{
-			int Next = m_aParticles[i].m_NextPart;
-			//m_aParticles[i].vel += flow_get(m_aParticles[i].pos)*time_passed * m_aParticles[i].flow_affected;
-			m_aParticles[i].m_Vel.y += m_aParticles[i].m_Gravity * TimePassed;
-
-			for(int f = 0; f < FrictionCount; f++) // apply friction
-				m_aParticles[i].m_Vel *= m_aParticles[i].m_Friction;
-
-			// move the point
-			vec2 Vel = m_aParticles[i].m_Vel * TimePassed;
-			if(m_aParticles[i].m_Collides)
-			{
-				Collision()->MovePoint(&m_aParticles[i].m_Pos, &Vel, random_float(0.1f, 1.0f), NULL);
-			}
-			else
-			{
-				m_aParticles[i].m_Pos += Vel;
-			}
-			m_aParticles[i].m_Vel = Vel * (1.0f / TimePassed);
-
-			m_aParticles[i].m_Life += TimePassed;
-			m_aParticles[i].m_Rot += TimePassed * m_aParticles[i].m_Rotspeed;
-
-			// check particle death
-			if(m_aParticles[i].m_Life > m_aParticles[i].m_LifeSpan)
-			{
-				// remove it from the group list
-				if(m_aParticles[i].m_PrevPart != -1)
-					m_aParticles[m_aParticles[i].m_PrevPart].m_NextPart = m_aParticles[i].m_NextPart;
-				else
-					FirstPart = m_aParticles[i].m_NextPart;
-
-				if(m_aParticles[i].m_NextPart != -1)
-					m_aParticles[m_aParticles[i].m_NextPart].m_PrevPart = m_aParticles[i].m_PrevPart;
-
-				// insert to the free list
-				if(m_FirstFree != -1)
-					m_aParticles[m_FirstFree].m_PrevPart = i;
-				m_aParticles[i].m_PrevPart = -1;
-				m_aParticles[i].m_NextPart = m_FirstFree;
-				m_FirstFree = i;
-			}
-
-			i = Next;
-		}
-	}
+	for(CParticleStore &Particles : m_aGroups)
+		Particles.Update(TimePassed, FrictionCount, Collision());
 }
 
 void CParticles::OnRender()
@@ -218,11 +148,12 @@ void CParticles::RenderGroup(int Group)
 		ParticleQuadContainerIndex = m_ExtraParticleQuadContainerIndex;
 	}
 
+	const CParticleStore &Particles = m_aGroups[Group];
+	const int NumParticles = Particles.Size();
+
 	// don't use the buffer methods here, else the old renderer gets many draw calls
 	if(Graphics()->IsQuadContainerBufferingEnabled())
 	{
-		int i = m_aFirstPart[Group];
-
 		static IGraphics::SRenderSpriteInfo s_aParticleRenderInfo[MAX_PARTICLES];
 
 		int CurParticleRenderCount = 0;
@@ -231,71 +162,57 @@ void CParticles::RenderGroup(int Group)
 		ColorRGBA LastColor;
 		int LastQuadOffset = 0;
 
-		if(i != -1)
+		// the newest particles are rendered first
+		int Newest = NumParticles - 1;
+		while(Newest >= 0 && !Particles.IsAlive(Newest))
+			Newest--;
+		if(Newest >= 0)
 		{
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
-			{
-				float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
-			}
-			LastColor.r = m_aParticles[i].m_Color.r;
-			LastColor.g = m_aParticles[i].m_Color.g;
-			LastColor.b = m_aParticles[i].m_Color.b;
-			LastColor.a = Alpha;
-
-			Graphics()->SetColor(
-				m_aParticles[i].m_Color.r,
-				m_aParticles[i].m_Color.g,
-				m_aParticles[i].m_Color.b,
-				Alpha);
-
-			LastQuadOffset = m_aParticles[i].m_Spr;
+			const int i = Newest;
+			LastColor = Particles.m_vColor[i];
+			LastColor.a = Particles.CurrentAlpha(i);
+
+			Graphics()->SetColor(LastColor.r, LastColor.g, LastColor.b, LastColor.a);
+
+			LastQuadOffset = Particles.m_vSpr[i];
 		}
 
-		while(i != -1)
+		for(int i = Newest; i >= 0; i--)
 		{
-			int QuadOffset = m_aParticles[i].m_Spr;
-			float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-			vec2 p = m_aParticles[i].m_Pos;
-			float Size = mix(m_aParticles[i].m_StartSize, m_aParticles[i].m_EndSize, a);
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
-			{
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
-			}
+			if(!Particles.IsAlive(i))
+				continue;
+
+			int QuadOffset = Particles.m_vSpr[i];
+			vec2 p = vec2(Particles.m_vPosX[i], Particles.m_vPosY[i]);
+			float Size = Particles.CurrentSize(i);
+			float Alpha = Particles.CurrentAlpha(i);
+			const ColorRGBA &Color = Particles.m_vColor[i];
 
 			// the current position, respecting the size, is inside the viewport, render it, else ignore
 			if(ParticleIsVisibleOnScreen(p, Size))
 			{
-				if((size_t)CurParticleRenderCount == gs_GraphicsMaxParticlesRenderCount || LastColor.r != m_aParticles[i].m_Color.r || LastColor.g != m_aParticles[i].m_Color.g || LastColor.b != m_aParticles[i].m_Color.b || LastColor.a != Alpha || LastQuadOffset != QuadOffset)
+				if((size_t)CurParticleRenderCount == gs_GraphicsMaxParticlesRenderCount || LastColor.r != Color.r || LastColor.g != Color.g || LastColor.b != Color.b || LastColor.a != Alpha || LastQuadOffset != QuadOffset)
 				{
 					Graphics()->TextureSet(aParticles[LastQuadOffset - FirstParticleOffset]);
 					Graphics()->RenderQuadContainerAsSpriteMultiple(ParticleQuadContainerIndex, LastQuadOffset - FirstParticleOffset, CurParticleRenderCount, s_aParticleRenderInfo);
 					CurParticleRenderCount = 0;
 					LastQuadOffset = QuadOffset;
 
-					Graphics()->SetColor(
-						m_aParticles[i].m_Color.r,
-						m_aParticles[i].m_Color.g,
-						m_aParticles[i].m_Color.b,
-						Alpha);
+					Graphics()->SetColor(Color.r, Color.g, Color.b, Alpha);
 
-					LastColor.r = m_aParticles[i].m_Color.r;
-					LastColor.g = m_aParticles[i].m_Color.g;
-					LastColor.b = m_aParticles[i].m_Color.b;
+					LastColor.r = Color.r;
+					LastColor.g = Color.g;
+					LastColor.b = Color.b;
 					LastColor.a = Alpha;
 				}
 
 				s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[0] = p.x;
 				s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[1] = p.y;
 				s_aParticleRenderInfo[CurParticleRenderCount].m_Scale = Size;
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Rotation = m_aParticles[i].m_Rot;
+				s_aParticleRenderInfo[CurParticleRenderCount].m_Rotation = Particles.m_vRot[i];
 
 				++CurParticleRenderCount;
 			}
-
-			i = m_aParticles[i].m_NextPart;
 		}
 
 		Graphics()->TextureSet(aParticles[LastQuadOffset - FirstParticleOffset]);
@@ -303,43 +220,56 @@ void CParticles::RenderGroup(int Group)
 	}
 	else
 	{
-		int i = m_aFirstPart[Group];
-
 		Graphics()->BlendNormal();
 		Graphics()->WrapClamp();
 
-		while(i != -1)
+		// consecutive particles with the same texture are drawn together
+		static std::vector<IGraphics::CFreeformQuad> s_vBatch;
+		s_vBatch.clear();
+		int BatchSprite = -1;
+		const auto &&FlushBatch = [&]() {
+			if(s_vBatch.empty())
+				return;
+			Graphics()->TextureSet(aParticles[BatchSprite - FirstParticleOffset]);
+			Graphics()->QuadsBegin();
+			Graphics()->QuadsDrawFreeformBatch(s_vBatch.data(), s_vBatch.size());
+			Graphics()->QuadsEnd();
+			s_vBatch.clear();
+		};
+
+		for(int i = NumParticles - 1; i >= 0; i--)
 		{
-			float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-			vec2 p = m_aParticles[i].m_Pos;
-			float Size = mix(m_aParticles[i].m_StartSize, m_aParticles[i].m_EndSize, a);
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
-			{
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
-			}
+			if(!Particles.IsAlive(i))
+				continue;
+
+			vec2 p = vec2(Particles.m_vPosX[i], Particles.m_vPosY[i]);
+			float Size = Particles.CurrentSize(i);
 
 			// the current position, respecting the size, is inside the viewport, render it, else ignore
 			if(ParticleIsVisibleOnScreen(p, Size))
 			{
-				Graphics()->TextureSet(aParticles[m_aParticles[i].m_Spr - FirstParticleOffset]);
-				Graphics()->QuadsBegin();
-
-				Graphics()->QuadsSetRotation(m_aParticles[i].m_Rot);
-
-				Graphics()->SetColor(
-					m_aParticles[i].m_Color.r,
-					m_aParticles[i].m_Color.g,
-					m_aParticles[i].m_Color.b,
-					Alpha);
+				if(Particles.m_vSpr[i] != BatchSprite)
+				{
+					FlushBatch();
+					BatchSprite = Particles.m_vSpr[i];
+				}
 
-				IGraphics::CQuadItem QuadItem(p.x, p.y, Size, Size);
-				Graphics()->QuadsDraw(&QuadItem, 1);
-				Graphics()->QuadsEnd();
+				// rotate the corners around the center like QuadsSetRotation
+				const float c = std::cos(Particles.m_vRot[i]);
+				const float s = std::sin(Particles.m_vRot[i]);
+				const float Half = Size / 2.0f;
+				const vec2 aCorners[4] = {vec2(-Half, -Half), vec2(Half, -Half), vec2(-Half, Half), vec2(Half, Half)};
+				const ColorRGBA Color(Particles.m_vColor[i].r, Particles.m_vColor[i].g, Particles.m_vColor[i].b, Particles.CurrentAlpha(i));
+				IGraphics::CFreeformQuad &Quad = s_vBatch.emplace_back();
+				for(int Corner = 0; Corner < 4; Corner++)
+				{
+					Quad.m_aPos[Corner] = p + vec2(aCorners[Corner].x * c - aCorners[Corner].y * s, aCorners[Corner].x * s + aCorners[Corner].y * c);
+					Quad.m_aTexCoords[Corner] = vec2(Corner % 2, Corner / 2);
+					Quad.m_aColors[Corner] = Color;
+				}
 			}
-
-			i = m_aParticles[i].m_NextPart;
 		}
+		FlushBatch();
 		Graphics()->WrapNormal();
 		Graphics()->BlendNormal();
 	}
@@ -39,6 +39,12 @@ void CScoreboard::OnReset()
 {
 	m_Active = false;
 	m_ServerRecord = -1.0f;
+	for(int ClientId = 0; ClientId < MAX_CLIENTS; ++ClientId)
+	{
+		m_aaPrewarmedNames[ClientId][0] = '\0';
+		m_aaPrewarmedClans[ClientId][0] = '\0';
+	}
+	m_PrewarmedFontSize = 0.0f;
 }
 
 void CScoreboard::OnRelease()
@@ -257,14 +263,12 @@ void CScoreboard::RenderScoreboard(CUIRect Scoreboard, int Team, int CountStart,
 	float TeeSizeMod;
 	float Spacing;
 	float RoundRadius;
-	float FontSize;
 	if(NumPlayers <= 8)
 	{
 		LineHeight = 60.0f;
 		TeeSizeMod = 1.0f;
 		Spacing = 16.0f;
 		RoundRadius = 10.0f;
-		FontSize = 24.0f;
 	}
 	else if(NumPlayers <= 12)
 	{
@@ -272,7 +276,6 @@ void CScoreboard::RenderScoreboard(CUIRect Scoreboard, int Team, int CountStart,
 		TeeSizeMod = 0.9f;
 		Spacing = 5.0f;
 		RoundRadius = 10.0f;
-		FontSize = 24.0f;
 	}
 	else if(NumPlayers <= 16)
 	{
@@ -280,7 +283,6 @@ void CScoreboard::RenderScoreboard(CUIRect Scoreboard, int Team, int CountStart,
 		TeeSizeMod = 0.8f;
 		Spacing = 0.0f;
 		RoundRadius = 5.0f;
-		FontSize = 24.0f;
 	}
 	else if(NumPlayers <= 24)
 	{
@@ -288,7 +290,6 @@ void CScoreboard::RenderScoreboard(CUIRect Scoreboard, int Team, int CountStart,
 		TeeSizeMod = 0.6f;
 		Spacing = 0.0f;
 		RoundRadius = 5.0f;
-		FontSize = 20.0f;
 	}
 	else if(NumPlayers <= 32)
 	{
@@ -296,7 +297,6 @@ void CScoreboard::RenderScoreboard(CUIRect Scoreboard, int Team, int CountStart,
 		TeeSizeMod = 0.4f;
 		Spacing = 0.0f;
 		RoundRadius = 5.0f;
-		FontSize = 16.0f;
 	}
 	else if(LowScoreboardWidth)
 	{
@@ -304,7 +304,6 @@ void CScoreboard::RenderScoreboard(CUIRect Scoreboard, int Team, int CountStart,
 		TeeSizeMod = 0.25f;
 		Spacing = 0.0f;
 		RoundRadius = 2.0f;
-		FontSize = 14.0f;
 	}
 	else
 	{
@@ -312,9 +311,10 @@ void CScoreboard::RenderScoreboard(CUIRect Scoreboard, int Team, int CountStart,
 		TeeSizeMod = 0.2f;
 		Spacing = 0.0f;
 		RoundRadius = 2.0f;
-		FontSize = 10.0f;
 	}
 
+	const float FontSize = RowFontSize(NumPlayers, LowScoreboardWidth);
+
 	const float ScoreOffset = Scoreboard.x + 40.0f;
 	const float ScoreLength = TextRender()->TextWidth(FontSize, TimeScore ? "00:00:00" : "99999");
 	const float TeeOffset = ScoreOffset + ScoreLength + 20.0f;
@@ -633,13 +633,73 @@ void CScoreboard::RenderRecordingNotification(float x)
 	Ui()->DoLabel(&Rect, aBuf, FontSize, TEXTALIGN_ML);
 }
 
+float CScoreboard::RowFontSize(int NumPlayers, bool LowScoreboardWidth)
+{
+	if(NumPlayers <= 16)
+		return 24.0f;
+	else if(NumPlayers <= 24)
+		return 20.0f;
+	else if(NumPlayers <= 32)
+		return 16.0f;
+	else if(LowScoreboardWidth)
+		return 14.0f;
+	else
+		return 10.0f;
+}
+
+void CScoreboard::PrewarmPlayerNames()
+{
+	const CNetObj_GameInfo *pGameInfoObj = GameClient()->m_Snap.m_pGameInfoObj;
+	const bool Teams = pGameInfoObj && (pGameInfoObj->m_GameFlags & GAMEFLAG_TEAMS);
+	const auto &aTeamSize = GameClient()->m_Snap.m_aTeamSize;
+	const int NumPlayers = Teams ? maximum(aTeamSize[TEAM_RED], aTeamSize[TEAM_BLUE]) : aTeamSize[TEAM_RED];
+
+	// number of rows per scoreboard column, see OnRender
+	int NumRows = NumPlayers;
+	if(!Teams && NumPlayers > 64)
+		NumRows = std::ceil(128.0f / 3);
+	else if(!Teams && NumPlayers > 16)
+		NumRows = NumPlayers <= 24 ? 12 : NumPlayers <= 32 ? 16 : NumPlayers <= 48 ? 24 : 32;
+	const float FontSize = RowFontSize(NumRows, false);
+
+	// the glyphs are rasterized for the scoreboard mapping, the mapping of
+	// whatever renders next is restored afterwards
+	bool MappedScreen = false;
+	float aPrevScreen[4];
+	for(int ClientId = 0; ClientId < MAX_CLIENTS; ++ClientId)
+	{
+		const CGameClient::CClientData &ClientData = GameClient()->m_aClients[ClientId];
+		if(!ClientData.m_Active || (str_comp(ClientData.m_aName, m_aaPrewarmedNames[ClientId]) == 0 && str_comp(ClientData.m_aClan, m_aaPrewarmedClans[ClientId]) == 0 && FontSize == m_PrewarmedFontSize))
+			continue;
+
+		if(!MappedScreen)
+		{
+			Graphics()->GetScreen(&aPrevScreen[0], &aPrevScreen[1], &aPrevScreen[2], &aPrevScreen[3]);
+			const float Height = 400.0f * 3.0f;
+			Graphics()->MapScreen(0, 0, Height * Graphics()->ScreenAspect(), Height);
+			MappedScreen = true;
+		}
+		TextRender()->PrewarmGlyphs(ClientData.m_aName, FontSize);
+		TextRender()->PrewarmGlyphs(ClientData.m_aClan, FontSize);
+		str_copy(m_aaPrewarmedNames[ClientId], ClientData.m_aName);
+		str_copy(m_aaPrewarmedClans[ClientId], ClientData.m_aClan);
+	}
+	if(MappedScreen)
+		Graphics()->MapScreen(aPrevScreen[0], aPrevScreen[1], aPrevScreen[2], aPrevScreen[3]);
+	m_PrewarmedFontSize = FontSize;
+}
+
 void CScoreboard::OnRender()
 {
 	if(Client()->State() != IClient::STATE_ONLINE && Client()->State() != IClient::STATE_DEMOPLAYBACK)
 		return;
 
 	if(!Active())
+	{
+		// prepare glyphs of new names, so opening the scoreboard does not stutter
+		PrewarmPlayerNames();
 		return;
+	}
 
 	// if the score board is active, then we should clear the motd message as well
 	if(GameClient()->m_Motd.IsActive())
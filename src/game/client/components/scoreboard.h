@@ -4,6 +4,7 @@
 #define GAME_CLIENT_COMPONENTS_SCOREBOARD_H
 
 #include <engine/console.h>
+#include <engine/shared/protocol.h>
 
 #include <game/client/component.h>
 #include <game/client/ui_rect.h>
@@ -26,12 +27,19 @@ class CScoreboard : public CComponent
 	void RenderScoreboard(CUIRect Scoreboard, int Team, int CountStart, int CountEnd, CScoreboardRenderState &State);
 	void RenderRecordingNotification(float x);
 
+	static float RowFontSize(int NumPlayers, bool LowScoreboardWidth);
+	void PrewarmPlayerNames();
+
 	static void ConKeyScoreboard(IConsole::IResult *pResult, void *pUserData);
 	const char *GetTeamName(int Team) const;
 
 	bool m_Active;
 	float m_ServerRecord;
 
+	char m_aaPrewarmedNames[MAX_CLIENTS][MAX_NAME_LENGTH];
+	char m_aaPrewarmedClans[MAX_CLIENTS][MAX_CLAN_LENGTH];
+	float m_PrewarmedFontSize;
+
 public:
 	CScoreboard();
 	virtual int Sizeof() const override { return sizeof(*this); }
@@ -427,7 +427,7 @@ void CStatboard::AutoStatCSV()
 	}
 }
 
-std::string CStatboard::ReplaceCommata(char *pStr)
+std::string CStatboard::ReplaceCommata(const char *pStr)
 {
 	if(!str_find(pStr, ","))
 		return pStr;
@@ -435,7 +435,7 @@ std::string CStatboard::ReplaceCommata(char *pStr)
 	char aOutbuf[256];
 	mem_zero(aOutbuf, sizeof(aOutbuf));
 
-	for(int i = 0, skip = 0; i < 64; i++)
+	for(int i = 0, skip = 0; i < 64 && pStr[i] != '\0'; i++)
 	{
 		if(pStr[i] == ',')
 		{
@@ -456,7 +456,7 @@ void CStatboard::FormatStats(char *pDest, size_t DestSize)
 	CServerInfo CurrentServerInfo;
 	Client()->GetServerInfo(&CurrentServerInfo);
 	char aServerStats[1024];
-	str_format(aServerStats, sizeof(aServerStats), "Servername,Game-type,Map\n%s,%s,%s", ReplaceCommata(CurrentServerInfo.m_aName).c_str(), ReplaceCommata(CurrentServerInfo.m_aGameType).c_str(), ReplaceCommata(CurrentServerInfo.m_aMap).c_str());
+	str_format(aServerStats, sizeof(aServerStats), "Servername,Game-type,Map\n%s,%s,%s", ReplaceCommata(CurrentServerInfo.m_aName).c_str(), ReplaceCommata(CurrentServerInfo.m_pGameType).c_str(), ReplaceCommata(CurrentServerInfo.m_pMap).c_str());
 
 	// player stats
 
@@ -1381,7 +1381,7 @@ static CGameInfo GetGameInfo(const CNetObj_GameInfoEx *pInfoEx, int InfoExSize,
 	bool FDDrace;
 	if(Version < 1)
 	{
-		const char *pGameType = pFallbackServerInfo->m_aGameType;
+		const char *pGameType = pFallbackServerInfo->m_pGameType;
 		Race = str_find_nocase(pGameType, "race") || str_find_nocase(pGameType, "fastcap");
 		FastCap = str_find_nocase(pGameType, "fastcap");
 		FNG = str_find_nocase(pGameType, "fng");
@@ -2009,9 +2009,9 @@ void CGameClient::OnNewSnapshot()
 	}
 
 	CTuningParams StandardTuning;
-	if(ServerInfo.m_aGameType[0] != '0')
+	if(ServerInfo.m_pGameType[0] != '0')
 	{
-		if(str_comp(ServerInfo.m_aGameType, "DM") != 0 && str_comp(ServerInfo.m_aGameType, "TDM") != 0 && str_comp(ServerInfo.m_aGameType, "CTF") != 0)
+		if(str_comp(ServerInfo.m_pGameType, "DM") != 0 && str_comp(ServerInfo.m_pGameType, "TDM") != 0 && str_comp(ServerInfo.m_pGameType, "CTF") != 0)
 			m_ServerMode = SERVERMODE_MOD;
 		else if(mem_comp(&StandardTuning, &m_aTuning[g_Config.m_ClDummy], 33) == 0)
 			m_ServerMode = SERVERMODE_PURE;
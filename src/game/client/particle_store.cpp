@@ -0,0 +1,205 @@
+#include "particle_store.h"
+
+#include <game/collision.h>
+
+#include <algorithm>
+
+template<typename F>
+void CParticleStore::ForEachArray(F &&Func)
+{
+	Func(m_vPosX);
+	Func(m_vPosY);
+	Func(m_vVelX);
+	Func(m_vVelY);
+	Func(m_vLife);
+	Func(m_vLifeSpan);
+	Func(m_vRot);
+	Func(m_vRotSpeed);
+	Func(m_vGravity);
+	Func(m_vFriction);
+	Func(m_vCollides);
+	Func(m_vSpr);
+	Func(m_vStartSize);
+	Func(m_vEndSize);
+	Func(m_vUseAlphaFading);
+	Func(m_vStartAlpha);
+	Func(m_vEndAlpha);
+	Func(m_vColor);
+}
+
+void CParticleStore::Clear()
+{
+	ForEachArray([](auto &vArray) { vArray.clear(); });
+	m_NumDead = 0;
+}
+
+void CParticleStore::Add(const CParticle &Particle, float Life)
+{
+	m_vPosX.push_back(Particle.m_Pos.x);
+	m_vPosY.push_back(Particle.m_Pos.y);
+	m_vVelX.push_back(Particle.m_Vel.x);
+	m_vVelY.push_back(Particle.m_Vel.y);
+	m_vLife.push_back(Life);
+	m_vLifeSpan.push_back(Particle.m_LifeSpan);
+	m_vRot.push_back(Particle.m_Rot);
+	m_vRotSpeed.push_back(Particle.m_Rotspeed);
+	m_vGravity.push_back(Particle.m_Gravity);
+	m_vFriction.push_back(Particle.m_Friction);
+	m_vCollides.push_back(Particle.m_Collides);
+	m_vSpr.push_back(Particle.m_Spr);
+	m_vStartSize.push_back(Particle.m_StartSize);
+	m_vEndSize.push_back(Particle.m_EndSize);
+	m_vUseAlphaFading.push_back(Particle.m_UseAlphaFading);
+	m_vStartAlpha.push_back(Particle.m_StartAlpha);
+	m_vEndAlpha.push_back(Particle.m_EndAlpha);
+	m_vColor.push_back(Particle.m_Color);
+	if(!IsAlive(Size() - 1))
+		m_NumDead++;
+}
+
+void CParticleStore::Update(float TimePassed, int FrictionCount, const CCollision *pCollision)
+{
+	const int Num = Size();
+	float *pPosX = m_vPosX.data();
+	float *pPosY = m_vPosY.data();
+	float *pVelX = m_vVelX.data();
+	float *pVelY = m_vVelY.data();
+	const float *pGravity = m_vGravity.data();
+	const float *pFriction = m_vFriction.data();
+
+	for(int i = 0; i < Num; i++)
+		pVelY[i] += pGravity[i] * TimePassed;
+
+	for(int f = 0; f < FrictionCount; f++)
+	{
+		for(int i = 0; i < Num; i++)
+		{
+			pVelX[i] *= pFriction[i];
+			pVelY[i] *= pFriction[i];
+		}
+	}
+
+	// the velocity is the movement of this update until the particles are moved
+	for(int i = 0; i < Num; i++)
+	{
+		pVelX[i] *= TimePassed;
+		pVelY[i] *= TimePassed;
+	}
+
+	// the collision map is queried for all targets at once, only the
+	// particles that hit something are looked at separately below
+	m_vBlocked.resize(Num);
+	unsigned char *pBlocked = m_vBlocked.data();
+	if(pCollision)
+	{
+		m_vTargetX.resize(Num);
+		m_vTargetY.resize(Num);
+		float *pTargetX = m_vTargetX.data();
+		float *pTargetY = m_vTargetY.data();
+		for(int i = 0; i < Num; i++)
+		{
+			pTargetX[i] = pPosX[i] + pVelX[i];
+			pTargetY[i] = pPosY[i] + pVelY[i];
+		}
+		pCollision->CheckPoints(pTargetX, pTargetY, pBlocked, Num);
+		const unsigned char *pCollides = m_vCollides.data();
+		const float *pLife = m_vLife.data();
+		const float *pLifeSpan = m_vLifeSpan.data();
+		for(int i = 0; i < Num; i++)
+			pBlocked[i] &= pCollides[i] & (pLife[i] <= pLifeSpan[i]);
+	}
+	else
+	{
+		std::fill(m_vBlocked.begin(), m_vBlocked.end(), 0);
+	}
+
+	for(int i = 0; i < Num; i++)
+	{
+		pPosX[i] += pBlocked[i] ? 0.0f : pVelX[i];
+		pPosY[i] += pBlocked[i] ? 0.0f : pVelY[i];
+	}
+
+	// bounce off like CCollision::MovePoint
+	for(int i = 0; i < Num; i++)
+	{
+		if(!pBlocked[i])
+			continue;
+		const float Elasticity = random_float(0.1f, 1.0f);
+		int Affected = 0;
+		if(pCollision->CheckPoint(pPosX[i] + pVelX[i], pPosY[i]))
+		{
+			pVelX[i] *= -Elasticity;
+			Affected++;
+		}
+		if(pCollision->CheckPoint(pPosX[i], pPosY[i] + pVelY[i]))
+		{
+			pVelY[i] *= -Elasticity;
+			Affected++;
+		}
+		if(Affected == 0)
+		{
+			pVelX[i] *= -Elasticity;
+			pVelY[i] *= -Elasticity;
+		}
+	}
+
+	const float InvTimePassed = 1.0f / TimePassed;
+	float *pLife = m_vLife.data();
+	float *pRot = m_vRot.data();
+	const float *pRotSpeed = m_vRotSpeed.data();
+	for(int i = 0; i < Num; i++)
+	{
+		pVelX[i] *= InvTimePassed;
+		pVelY[i] *= InvTimePassed;
+		pLife[i] += TimePassed;
+		pRot[i] += TimePassed * pRotSpeed[i];
+	}
+
+	Compact();
+}
+
+void CParticleStore::Compact()
+{
+	const int Num = Size();
+	const float *pLife = m_vLife.data();
+	const float *pLifeSpan = m_vLifeSpan.data();
+
+	int NumDead = 0;
+	for(int i = 0; i < Num; i++)
+		NumDead += pLife[i] > pLifeSpan[i];
+	m_NumDead = NumDead;
+
+	// dead particles are kept until there are enough of them, so that the
+	// arrays don't have to be moved in every update
+	if(NumDead == 0 || NumDead * 8 < Num)
+		return;
+
+	// find the runs of living particles behind the first dead one
+	m_vAliveRuns.clear();
+	int i = 0;
+	while(IsAlive(i))
+		i++;
+	const int FirstDead = i;
+	while(i < Num)
+	{
+		while(i < Num && !IsAlive(i))
+			i++;
+		const int Start = i;
+		while(i < Num && IsAlive(i))
+			i++;
+		if(i > Start)
+			m_vAliveRuns.emplace_back(Start, i);
+	}
+
+	// and move them to the front, one attribute after another
+	ForEachArray([this, FirstDead](auto &vArray) {
+		int Alive = FirstDead;
+		for(const auto &[Start, End] : m_vAliveRuns)
+		{
+			std::copy(vArray.begin() + Start, vArray.begin() + End, vArray.begin() + Alive);
+			Alive += End - Start;
+		}
+		vArray.resize(Alive);
+	});
+	m_NumDead = 0;
+}
@@ -0,0 +1,121 @@
+#ifndef GAME_CLIENT_PARTICLE_STORE_H
+#define GAME_CLIENT_PARTICLE_STORE_H
+
+#include <base/color.h>
+#include <base/math.h>
+#include <base/vmath.h>
+
+#include <utility>
+#include <vector>
+
+class CCollision;
+
+// particles
+struct CParticle
+{
+	void SetDefault()
+	{
+		m_Pos = vec2(0, 0);
+		m_Vel = vec2(0, 0);
+		m_LifeSpan = 0;
+		m_StartSize = 32;
+		m_EndSize = 32;
+		m_UseAlphaFading = false;
+		m_StartAlpha = 1;
+		m_EndAlpha = 1;
+		m_Rot = 0;
+		m_Rotspeed = 0;
+		m_Gravity = 0;
+		m_Friction = 0;
+		m_FlowAffected = 1.0f;
+		m_Color = ColorRGBA(1, 1, 1, 1);
+		m_Collides = true;
+	}
+
+	vec2 m_Pos;
+	vec2 m_Vel;
+
+	int m_Spr;
+
+	float m_FlowAffected;
+
+	float m_LifeSpan;
+
+	float m_StartSize;
+	float m_EndSize;
+
+	bool m_UseAlphaFading;
+	float m_StartAlpha;
+	float m_EndAlpha;
+
+	float m_Rot;
+	float m_Rotspeed;
+
+	float m_Gravity;
+	float m_Friction;
+
+	ColorRGBA m_Color;
+
+	bool m_Collides;
+};
+
+/**
+ * The particles of one group, stored as one array per attribute so that the
+ * update runs over contiguous memory and can be vectorized by the compiler.
+ * New particles are appended, dead ones are removed by compacting the
+ * arrays, which keeps the order of the remaining particles. The compaction
+ * only happens once enough particles died, until then the dead particles
+ * stay in the arrays and must be skipped with IsAlive.
+ */
+class CParticleStore
+{
+public:
+	// number of particles in the arrays, including the dead ones
+	int Size() const { return m_vLife.size(); }
+	int NumAlive() const { return Size() - m_NumDead; }
+	bool IsAlive(int i) const { return m_vLife[i] <= m_vLifeSpan[i]; }
+	void Clear();
+	void Add(const CParticle &Particle, float Life);
+	// `FrictionCount` is the number of friction steps to apply. Particles
+	// that collide are moved with `pCollision` if it is set.
+	void Update(float TimePassed, int FrictionCount, const CCollision *pCollision);
+
+	// the particles in the order they were added, for rendering
+	std::vector<float> m_vPosX;
+	std::vector<float> m_vPosY;
+	std::vector<float> m_vVelX;
+	std::vector<float> m_vVelY;
+	std::vector<float> m_vLife;
+	std::vector<float> m_vLifeSpan;
+	std::vector<float> m_vRot;
+	std::vector<float> m_vRotSpeed;
+	std::vector<float> m_vGravity;
+	std::vector<float> m_vFriction;
+	std::vector<unsigned char> m_vCollides;
+	std::vector<int> m_vSpr;
+	std::vector<float> m_vStartSize;
+	std::vector<float> m_vEndSize;
+	std::vector<unsigned char> m_vUseAlphaFading;
+	std::vector<float> m_vStartAlpha;
+	std::vector<float> m_vEndAlpha;
+	std::vector<ColorRGBA> m_vColor;
+
+	float LifeFraction(int i) const { return m_vLife[i] / m_vLifeSpan[i]; }
+	float CurrentSize(int i) const { return mix(m_vStartSize[i], m_vEndSize[i], LifeFraction(i)); }
+	float CurrentAlpha(int i) const { return m_vUseAlphaFading[i] ? mix(m_vStartAlpha[i], m_vEndAlpha[i], LifeFraction(i)) : m_vColor[i].a; }
+
+private:
+	int m_NumDead = 0;
+
+	// scratch space of the update
+	std::vector<float> m_vTargetX;
+	std::vector<float> m_vTargetY;
+	std::vector<unsigned char> m_vBlocked;
+	std::vector<std::pair<int, int>> m_vAliveRuns;
+
+	template<typename F>
+	void ForEachArray(F &&Func);
+	void Compact();
+};
+
+#endif
@@ -10,6 +10,7 @@
 
 #include <game/client/skin.h>
 #include <game/client/ui_rect.h>
+#include <game/envelope.h>
 #include <game/generated/protocol7.h>
 
 class CAnimState;
@@ -22,11 +23,10 @@ namespace client_data7 {
 struct CDataSprite;
 }
 struct CDataSprite;
-struct CEnvPoint;
-struct CEnvPointBezier;
-struct CEnvPointBezier_upstream;
 struct CMapItemGroup;
 struct CQuad;
+struct SGraphicTile;
+struct SGraphicTileTexureCoords;
 
 #include <game/generated/protocol.h>
 
@@ -153,35 +153,6 @@ enum
 	TILERENDERFLAG_EXTEND = 4,
 };
 
-class IEnvelopePointAccess
-{
-public:
-	virtual ~IEnvelopePointAccess() = default;
-	virtual int NumPoints() const = 0;
-	virtual const CEnvPoint *GetPoint(int Index) const = 0;
-	virtual const CEnvPointBezier *GetBezier(int Index) const = 0;
-};
-
-class CMapBasedEnvelopePointAccess : public IEnvelopePointAccess
-{
-	int m_StartPoint;
-	int m_NumPoints;
-	int m_NumPointsMax;
-	CEnvPoint *m_pPoints;
-	CEnvPointBezier *m_pPointsBezier;
-	CEnvPointBezier_upstream *m_pPointsBezierUpstream;
-
-public:
-	CMapBasedEnvelopePointAccess(class CDataFileReader *pReader);
-	CMapBasedEnvelopePointAccess(class IMap *pMap);
-	void SetPointsRange(int StartPoint, int NumPoints);
-	int StartPoint() const;
-	int NumPoints() const override;
-	int NumPointsMax() const;
-	const CEnvPoint *GetPoint(int Index) const override;
-	const CEnvPointBezier *GetBezier(int Index) const override;
-};
-
 typedef void (*ENVELOPE_EVAL)(int TimeOffsetMillis, int Env, ColorRGBA &Result, size_t Channels, void *pUser);
 
 class CRenderTools
@@ -232,9 +203,10 @@ public:
 	void RenderTee(const CAnimState *pAnim, const CTeeRenderInfo *pInfo, int Emote, vec2 Dir, vec2 Pos, float Alpha = 1.0f) const;
 
 	// map render methods (render_map.cpp)
-	static void RenderEvalEnvelope(const IEnvelopePointAccess *pPoints, std::chrono::nanoseconds TimeNanos, ColorRGBA &Result, size_t Channels);
 	void RenderQuads(CQuad *pQuads, int NumQuads, int Flags, ENVELOPE_EVAL pfnEval, void *pUser) const;
 	void ForceRenderQuads(CQuad *pQuads, int NumQuads, int Flags, ENVELOPE_EVAL pfnEval, void *pUser, float Alpha = 1.0f) const;
+	// fills the vertices and texture array coordinates of a tile for the buffered tile rendering
+	static void FillTileVertices(SGraphicTile *pTmpTile, SGraphicTileTexureCoords *pTmpTex, unsigned char Flags, unsigned char Index, int x, int y, const ivec2 &Offset, int Scale);
 	void RenderTilemap(CTile *pTiles, int w, int h, float Scale, ColorRGBA Color, int RenderFlags) const;
 
 	// render a rectangle made of IndexIn tiles, over a background made of IndexOut tiles
@@ -7,8 +7,6 @@
 #include <engine/textrender.h>
 
 #include <engine/shared/config.h>
-#include <engine/shared/datafile.h>
-#include <engine/shared/map.h>
 
 #include "render.h"
 
@@ -17,320 +15,8 @@
 #include <game/mapitems.h>
 #include <game/mapitems_ex.h>
 
-#include <chrono>
 #include <cmath>
-
-using namespace std::chrono_literals;
-
-CMapBasedEnvelopePointAccess::CMapBasedEnvelopePointAccess(CDataFileReader *pReader)
-{
-	bool FoundBezierEnvelope = false;
-	int EnvStart, EnvNum;
-	pReader->GetType(MAPITEMTYPE_ENVELOPE, &EnvStart, &EnvNum);
-	for(int EnvIndex = 0; EnvIndex < EnvNum; EnvIndex++)
-	{
-		CMapItemEnvelope *pEnvelope = static_cast<CMapItemEnvelope *>(pReader->GetItem(EnvStart + EnvIndex));
-		if(pEnvelope->m_Version >= CMapItemEnvelope_v3::CURRENT_VERSION)
-		{
-			FoundBezierEnvelope = true;
-			break;
-		}
-	}
-
-	if(FoundBezierEnvelope)
-	{
-		m_pPoints = nullptr;
-		m_pPointsBezier = nullptr;
-
-		int EnvPointStart, FakeEnvPointNum;
-		pReader->GetType(MAPITEMTYPE_ENVPOINTS, &EnvPointStart, &FakeEnvPointNum);
-		if(FakeEnvPointNum > 0)
-			m_pPointsBezierUpstream = static_cast<CEnvPointBezier_upstream *>(pReader->GetItem(EnvPointStart));
-		else
-			m_pPointsBezierUpstream = nullptr;
-
-		m_NumPointsMax = pReader->GetItemSize(EnvPointStart) / sizeof(CEnvPointBezier_upstream);
-	}
-	else
-	{
-		int EnvPointStart, FakeEnvPointNum;
-		pReader->GetType(MAPITEMTYPE_ENVPOINTS, &EnvPointStart, &FakeEnvPointNum);
-		if(FakeEnvPointNum > 0)
-			m_pPoints = static_cast<CEnvPoint *>(pReader->GetItem(EnvPointStart));
-		else
-			m_pPoints = nullptr;
-
-		m_NumPointsMax = pReader->GetItemSize(EnvPointStart) / sizeof(CEnvPoint);
-
-		int EnvPointBezierStart, FakeEnvPointBezierNum;
-		pReader->GetType(MAPITEMTYPE_ENVPOINTS_BEZIER, &EnvPointBezierStart, &FakeEnvPointBezierNum);
-		const int NumPointsBezier = pReader->GetItemSize(EnvPointBezierStart) / sizeof(CEnvPointBezier);
-		if(FakeEnvPointBezierNum > 0 && m_NumPointsMax == NumPointsBezier)
-			m_pPointsBezier = static_cast<CEnvPointBezier *>(pReader->GetItem(EnvPointBezierStart));
-		else
-			m_pPointsBezier = nullptr;
-
-		m_pPointsBezierUpstream = nullptr;
-	}
-
-	SetPointsRange(0, m_NumPointsMax);
-}
-
-CMapBasedEnvelopePointAccess::CMapBasedEnvelopePointAccess(IMap *pMap) :
-	CMapBasedEnvelopePointAccess(static_cast<CMap *>(pMap)->GetReader())
-{
-}
-
-void CMapBasedEnvelopePointAccess::SetPointsRange(int StartPoint, int NumPoints)
-{
-	m_StartPoint = clamp(StartPoint, 0, m_NumPointsMax);
-	m_NumPoints = clamp(NumPoints, 0, maximum(m_NumPointsMax - StartPoint, 0));
-}
-
-int CMapBasedEnvelopePointAccess::StartPoint() const
-{
-	return m_StartPoint;
-}
-
-int CMapBasedEnvelopePointAccess::NumPoints() const
-{
-	return m_NumPoints;
-}
-
-int CMapBasedEnvelopePointAccess::NumPointsMax() const
-{
-	return m_NumPointsMax;
-}
-
-const CEnvPoint *CMapBasedEnvelopePointAccess::GetPoint(int Index) const
-{
-	if(Index < 0 || Index >= m_NumPoints)
-		return nullptr;
-	if(m_pPoints != nullptr)
-		return &m_pPoints[Index + m_StartPoint];
-	if(m_pPointsBezierUpstream != nullptr)
-		return &m_pPointsBezierUpstream[Index + m_StartPoint];
-	return nullptr;
-}
-
-const CEnvPointBezier *CMapBasedEnvelopePointAccess::GetBezier(int Index) const
-{
-	if(Index < 0 || Index >= m_NumPoints)
-		return nullptr;
-	if(m_pPointsBezier != nullptr)
-		return &m_pPointsBezier[Index + m_StartPoint];
-	if(m_pPointsBezierUpstream != nullptr)
-		return &m_pPointsBezierUpstream[Index + m_StartPoint].m_Bezier;
-	return nullptr;
-}
-
-static double CubicRoot(double x)
-{
-	if(x == 0.0)
-		return 0.0;
-	else if(x < 0.0)
-		return -std::exp(std::log(-x) / 3.0);
-	else
-		return std::exp(std::log(x) / 3.0);
-}
-
-static float SolveBezier(float x, float p0, float p1, float p2, float p3)
-{
-	const double x3 = -p0 + 3.0 * p1 - 3.0 * p2 + p3;
-	const double x2 = 3.0 * p0 - 6.0 * p1 + 3.0 * p2;
-	const double x1 = -3.0 * p0 + 3.0 * p1;
-	const double x0 = p0 - x;
-
-	if(x3 == 0.0 && x2 == 0.0)
-	{
-		// linear
-		// a * t + b = 0
-		const double a = x1;
-		const double b = x0;
-
-		if(a == 0.0)
-			return 0.0f;
-		return -b / a;
-	}
-	else if(x3 == 0.0)
-	{
-		// quadratic
-		// t * t + b * t + c = 0
-		const double b = x1 / x2;
-		const double c = x0 / x2;
-
-		if(c == 0.0)
-			return 0.0f;
-
-		const double D = b * b - 4.0 * c;
-		const double SqrtD = std::sqrt(D);
-
-		const double t = (-b + SqrtD) / 2.0;
-
-		if(0.0 <= t && t <= 1.0001)
-			return t;
-		return (-b - SqrtD) / 2.0;
-	}
-	else
-	{
-		// cubic
-		// t * t * t + a * t * t + b * t * t + c = 0
-		const double a = x2 / x3;
-		const double b = x1 / x3;
-		const double c = x0 / x3;
-
-		// substitute t = y - a / 3
-		const double sub = a / 3.0;
-
-		// depressed form x^3 + px + q = 0
-		// cardano's method
-		const double p = b / 3.0 - a * a / 9.0;
-		const double q = (2.0 * a * a * a / 27.0 - a * b / 3.0 + c) / 2.0;
-
-		const double D = q * q + p * p * p;
-
-		if(D > 0.0)
-		{
-			// only one 'real' solution
-			const double s = std::sqrt(D);
-			return CubicRoot(s - q) - CubicRoot(s + q) - sub;
-		}
-		else if(D == 0.0)
-		{
-			// one single, one double solution or triple solution
-			const double s = CubicRoot(-q);
-			const double t = 2.0 * s - sub;
-
-			if(0.0 <= t && t <= 1.0001)
-				return t;
-			return (-s - sub);
-		}
-		else
-		{
-			// Casus irreducibilis ... ,_,
-			const double phi = std::acos(-q / std::sqrt(-(p * p * p))) / 3.0;
-			const double s = 2.0 * std::sqrt(-p);
-
-			const double t1 = s * std::cos(phi) - sub;
-
-			if(0.0 <= t1 && t1 <= 1.0001)
-				return t1;
-
-			const double t2 = -s * std::cos(phi + pi / 3.0) - sub;
-
-			if(0.0 <= t2 && t2 <= 1.0001)
-				return t2;
-			return -s * std::cos(phi - pi / 3.0) - sub;
-		}
-	}
-}
-
-void CRenderTools::RenderEvalEnvelope(const IEnvelopePointAccess *pPoints, std::chrono::nanoseconds TimeNanos, ColorRGBA &Result, size_t Channels)
-{
-	const int NumPoints = pPoints->NumPoints();
-	if(NumPoints == 0)
-	{
-		return;
-	}
-
-	if(NumPoints == 1)
-	{
-		const CEnvPoint *pFirstPoint = pPoints->GetPoint(0);
-		for(size_t c = 0; c < Channels; c++)
-		{
-			Result[c] = fx2f(pFirstPoint->m_aValues[c]);
-		}
-		return;
-	}
-
-	const CEnvPoint *pLastPoint = pPoints->GetPoint(NumPoints - 1);
-	const int64_t MaxPointTime = (int64_t)pLastPoint->m_Time * std::chrono::nanoseconds(1ms).count();
-	if(MaxPointTime > 0) // TODO: remove this check when implementing a IO check for maps(in this case broken envelopes)
-		TimeNanos = std::chrono::nanoseconds(TimeNanos.count() % MaxPointTime);
-	else
-		TimeNanos = decltype(TimeNanos)::zero();
-
-	const double TimeMillis = TimeNanos.count() / (double)std::chrono::nanoseconds(1ms).count();
-	for(int i = 0; i < NumPoints - 1; i++)
-	{
-		const CEnvPoint *pCurrentPoint = pPoints->GetPoint(i);
-		const CEnvPoint *pNextPoint = pPoints->GetPoint(i + 1);
-		if(TimeMillis >= pCurrentPoint->m_Time && TimeMillis < pNextPoint->m_Time)
-		{
-			const float Delta = pNextPoint->m_Time - pCurrentPoint->m_Time;
-			float a = (float)(TimeMillis - pCurrentPoint->m_Time) / Delta;
-
-			switch(pCurrentPoint->m_Curvetype)
-			{
-			case CURVETYPE_STEP:
-				a = 0.0f;
-				break;
-
-			case CURVETYPE_SLOW:
-				a = a * a * a;
-				break;
-
-			case CURVETYPE_FAST:
-				a = 1.0f - a;
-				a = 1.0f - a * a * a;
-				break;
-
-			case CURVETYPE_SMOOTH:
-				a = -2.0f * a * a * a + 3.0f * a * a; // second hermite basis
-				break;
-
-			case CURVETYPE_BEZIER:
-			{
-				const CEnvPointBezier *pCurrentPointBezier = pPoints->GetBezier(i);
-				const CEnvPointBezier *pNextPointBezier = pPoints->GetBezier(i + 1);
-				if(pCurrentPointBezier == nullptr || pNextPointBezier == nullptr)
-					break; // fallback to linear
-				for(size_t c = 0; c < Channels; c++)
-				{
-					// monotonic 2d cubic bezier curve
-					const vec2 p0 = vec2(pCurrentPoint->m_Time, fx2f(pCurrentPoint->m_aValues[c]));
-					const vec2 p3 = vec2(pNextPoint->m_Time, fx2f(pNextPoint->m_aValues[c]));
-
-					const vec2 OutTang = vec2(pCurrentPointBezier->m_aOutTangentDeltaX[c], fx2f(pCurrentPointBezier->m_aOutTangentDeltaY[c]));
-					const vec2 InTang = vec2(pNextPointBezier->m_aInTangentDeltaX[c], fx2f(pNextPointBezier->m_aInTangentDeltaY[c]));
-
-					vec2 p1 = p0 + OutTang;
-					vec2 p2 = p3 + InTang;
-
-					// validate bezier curve
-					p1.x = clamp(p1.x, p0.x, p3.x);
-					p2.x = clamp(p2.x, p0.x, p3.x);
-
-					// solve x(a) = time for a
-					a = clamp(SolveBezier(TimeMillis, p0.x, p1.x, p2.x, p3.x), 0.0f, 1.0f);
-
-					// value = y(t)
-					Result[c] = bezier(p0.y, p1.y, p2.y, p3.y, a);
-				}
-				return;
-			}
-
-			case CURVETYPE_LINEAR: [[fallthrough]];
-			default:
-				break;
-			}
-
-			for(size_t c = 0; c < Channels; c++)
-			{
-				const float v0 = fx2f(pCurrentPoint->m_aValues[c]);
-				const float v1 = fx2f(pNextPoint->m_aValues[c]);
-				Result[c] = v0 + (v1 - v0) * a;
-			}
-
-			return;
-		}
-	}
-
-	for(size_t c = 0; c < Channels; c++)
-	{
-		Result[c] = fx2f(pLastPoint->m_aValues[c]);
-	}
-}
+#include <vector>
 
 static void Rotate(const CPoint *pCenter, CPoint *pPoint, float Rotation)
 {
@@ -350,6 +36,9 @@ void CRenderTools::RenderQuads(CQuad *pQuads, int NumQuads, int RenderFlags, ENV
 
 void CRenderTools::ForceRenderQuads(CQuad *pQuads, int NumQuads, int RenderFlags, ENVELOPE_EVAL pfnEval, void *pUser, float Alpha) const
 {
+	static std::vector<IGraphics::CFreeformQuad> s_vBatch;
+	s_vBatch.clear();
+
 	Graphics()->TrianglesBegin();
 	float Conv = 1 / 255.0f;
 	for(int i = 0; i < NumQuads; i++)
@@ -372,24 +61,11 @@ void CRenderTools::ForceRenderQuads(CQuad *pQuads, int NumQuads, int RenderFlags
 		if(!Opaque && !(RenderFlags & LAYERRENDERFLAG_TRANSPARENT))
 			continue;
 
-		Graphics()->QuadsSetSubsetFree(
-			fx2f(pQuad->m_aTexcoords[0].x), fx2f(pQuad->m_aTexcoords[0].y),
-			fx2f(pQuad->m_aTexcoords[1].x), fx2f(pQuad->m_aTexcoords[1].y),
-			fx2f(pQuad->m_aTexcoords[2].x), fx2f(pQuad->m_aTexcoords[2].y),
-			fx2f(pQuad->m_aTexcoords[3].x), fx2f(pQuad->m_aTexcoords[3].y));
-
 		ColorRGBA Position = ColorRGBA(0.0f, 0.0f, 0.0f, 0.0f);
 		pfnEval(pQuad->m_PosEnvOffset, pQuad->m_PosEnv, Position, 3, pUser);
 		const vec2 Offset = vec2(Position.r, Position.g);
 		const float Rotation = Position.b / 180.0f * pi;
 
-		IGraphics::CColorVertex Array[4] = {
-			IGraphics::CColorVertex(0, pQuad->m_aColors[0].r * Conv * Color.r, pQuad->m_aColors[0].g * Conv * Color.g, pQuad->m_aColors[0].b * Conv * Color.b, pQuad->m_aColors[0].a * Conv * Color.a * Alpha),
-			IGraphics::CColorVertex(1, pQuad->m_aColors[1].r * Conv * Color.r, pQuad->m_aColors[1].g * Conv * Color.g, pQuad->m_aColors[1].b * Conv * Color.b, pQuad->m_aColors[1].a * Conv * Color.a * Alpha),
-			IGraphics::CColorVertex(2, pQuad->m_aColors[2].r * Conv * Color.r, pQuad->m_aColors[2].g * Conv * Color.g, pQuad->m_aColors[2].b * Conv * Color.b, pQuad->m_aColors[2].a * Conv * Color.a * Alpha),
-			IGraphics::CColorVertex(3, pQuad->m_aColors[3].r * Conv * Color.r, pQuad->m_aColors[3].g * Conv * Color.g, pQuad->m_aColors[3].b * Conv * Color.b, pQuad->m_aColors[3].a * Conv * Color.a * Alpha)};
-		Graphics()->SetColorVertex(Array, 4);
-
 		CPoint *pPoints = pQuad->m_aPoints;
 
 		CPoint aRotated[4];
@@ -403,13 +79,19 @@ void CRenderTools::ForceRenderQuads(CQuad *pQuads, int NumQuads, int RenderFlags
 			pPoints = aRotated;
 		}
 
-		IGraphics::CFreeformItem Freeform(
-			fx2f(pPoints[0].x) + Offset.x, fx2f(pPoints[0].y) + Offset.y,
-			fx2f(pPoints[1].x) + Offset.x, fx2f(pPoints[1].y) + Offset.y,
-			fx2f(pPoints[2].x) + Offset.x, fx2f(pPoints[2].y) + Offset.y,
-			fx2f(pPoints[3].x) + Offset.x, fx2f(pPoints[3].y) + Offset.y);
-		Graphics()->QuadsDrawFreeform(&Freeform, 1);
+		IGraphics::CFreeformQuad &Batched = s_vBatch.emplace_back();
+		for(int Corner = 0; Corner < 4; Corner++)
+		{
+			Batched.m_aPos[Corner] = vec2(fx2f(pPoints[Corner].x), fx2f(pPoints[Corner].y)) + Offset;
+			Batched.m_aTexCoords[Corner] = vec2(fx2f(pQuad->m_aTexcoords[Corner].x), fx2f(pQuad->m_aTexcoords[Corner].y));
+			Batched.m_aColors[Corner] = ColorRGBA(
+				pQuad->m_aColors[Corner].r * Conv * Color.r,
+				pQuad->m_aColors[Corner].g * Conv * Color.g,
+				pQuad->m_aColors[Corner].b * Conv * Color.b,
+				pQuad->m_aColors[Corner].a * Conv * Color.a * Alpha);
+		}
 	}
+	Graphics()->QuadsDrawFreeformBatch(s_vBatch.data(), s_vBatch.size());
 	Graphics()->TrianglesEnd();
 }
 
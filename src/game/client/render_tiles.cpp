@@ -0,0 +1,78 @@
+#include "render.h"
+
+#include <game/mapitems.h>
+
+// kept apart from render_map.cpp, the editor tile chunks need it without the client data
+void CRenderTools::FillTileVertices(SGraphicTile *pTmpTile, SGraphicTileTexureCoords *pTmpTex, unsigned char Flags, unsigned char Index, int x, int y, const ivec2 &Offset, int Scale)
+{
+	if(pTmpTex)
+	{
+		unsigned char x0 = 0;
+		unsigned char y0 = 0;
+		unsigned char x1 = x0 + 1;
+		unsigned char y1 = y0;
+		unsigned char x2 = x0 + 1;
+		unsigned char y2 = y0 + 1;
+		unsigned char x3 = x0;
+		unsigned char y3 = y0 + 1;
+
+		if(Flags & TILEFLAG_XFLIP)
+		{
+			x0 = x2;
+			x1 = x3;
+			x2 = x3;
+			x3 = x0;
+		}
+
+		if(Flags & TILEFLAG_YFLIP)
+		{
+			y0 = y3;
+			y2 = y1;
+			y3 = y1;
+			y1 = y0;
+		}
+
+		if(Flags & TILEFLAG_ROTATE)
+		{
+			unsigned char Tmp = x0;
+			x0 = x3;
+			x3 = x2;
+			x2 = x1;
+			x1 = Tmp;
+			Tmp = y0;
+			y0 = y3;
+			y3 = y2;
+			y2 = y1;
+			y1 = Tmp;
+		}
+
+		pTmpTex->m_TexCoordTopLeft.x = x0;
+		pTmpTex->m_TexCoordTopLeft.y = y0;
+		pTmpTex->m_TexCoordBottomLeft.x = x3;
+		pTmpTex->m_TexCoordBottomLeft.y = y3;
+		pTmpTex->m_TexCoordTopRight.x = x1;
+		pTmpTex->m_TexCoordTopRight.y = y1;
+		pTmpTex->m_TexCoordBottomRight.x = x2;
+		pTmpTex->m_TexCoordBottomRight.y = y2;
+
+		pTmpTex->m_TexCoordTopLeft.z = Index;
+		pTmpTex->m_TexCoordBottomLeft.z = Index;
+		pTmpTex->m_TexCoordTopRight.z = Index;
+		pTmpTex->m_TexCoordBottomRight.z = Index;
+
+		bool HasRotation = (Flags & TILEFLAG_ROTATE) != 0;
+		pTmpTex->m_TexCoordTopLeft.w = HasRotation;
+		pTmpTex->m_TexCoordBottomLeft.w = HasRotation;
+		pTmpTex->m_TexCoordTopRight.w = HasRotation;
+		pTmpTex->m_TexCoordBottomRight.w = HasRotation;
+	}
+
+	pTmpTile->m_TopLeft.x = x * Scale + Offset.x;
+	pTmpTile->m_TopLeft.y = y * Scale + Offset.y;
+	pTmpTile->m_BottomLeft.x = x * Scale + Offset.x;
+	pTmpTile->m_BottomLeft.y = y * Scale + Scale + Offset.y;
+	pTmpTile->m_TopRight.x = x * Scale + Scale + Offset.x;
+	pTmpTile->m_TopRight.y = y * Scale + Offset.y;
+	pTmpTile->m_BottomRight.x = x * Scale + Scale + Offset.x;
+	pTmpTile->m_BottomRight.y = y * Scale + Scale + Offset.y;
+}
@@ -504,6 +504,27 @@ void CCollision::MovePoint(vec2 *pInoutPos, vec2 *pInoutVel, float Elasticity, i
 	}
 }
 
+void CCollision::CheckPoints(const float *pX, const float *pY, unsigned char *pSolid, int Num) const
+{
+	if(!m_pTiles)
+	{
+		mem_zero(pSolid, Num);
+		return;
+	}
+
+	// same as IsSolid, without going through GetTile for every point
+	const CTile *pTiles = m_pTiles;
+	const int Width = m_Width;
+	const int Height = m_Height;
+	for(int i = 0; i < Num; i++)
+	{
+		const int Nx = clamp(round_to_int(pX[i]) / 32, 0, Width - 1);
+		const int Ny = clamp(round_to_int(pY[i]) / 32, 0, Height - 1);
+		const int Index = pTiles[Ny * Width + Nx].m_Index;
+		pSolid[i] = Index == TILE_SOLID || Index == TILE_NOHOOK;
+	}
+}
+
 bool CCollision::TestBox(vec2 Pos, vec2 Size) const
 {
 	Size *= 0.5f;
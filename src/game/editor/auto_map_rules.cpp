@@ -0,0 +1,658 @@
+#include "auto_map_rules.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/linereader.h>
+#include <engine/shared/workergroup.h>
+
+#include <cstdio> // sscanf
+
+// Based on triple32inc from https://github.com/skeeto/hash-prospector/tree/79a6074062a84907df6e45b756134b74e2956760
+static uint32_t HashUInt32(uint32_t Num)
+{
+	Num++;
+	Num ^= Num >> 17;
+	Num *= 0xed5ad4bbu;
+	Num ^= Num >> 11;
+	Num *= 0xac4c1b51u;
+	Num ^= Num >> 15;
+	Num *= 0x31848babu;
+	Num ^= Num >> 14;
+	return Num;
+}
+
+// the part of the location hash that is the same for all tiles of a rule
+static uint32_t HashRule(uint32_t Seed, uint32_t Run, uint32_t Rule)
+{
+	const uint32_t Prime = 31;
+	uint32_t Hash = 1;
+	Hash = Hash * Prime + HashUInt32(Seed);
+	Hash = Hash * Prime + HashUInt32(Run);
+	Hash = Hash * Prime + HashUInt32(Rule);
+	return Hash;
+}
+
+// takes the hashes of the coordinates, they are the same for all rules
+static int HashTile(uint32_t RuleHash, uint32_t HashX, uint32_t HashY)
+{
+	const uint32_t Prime = 31;
+	uint32_t Hash = RuleHash;
+	Hash = Hash * Prime + HashX;
+	Hash = Hash * Prime + HashY;
+	Hash = HashUInt32(Hash * Prime); // Just to double-check that values are well-distributed
+	return Hash % CAutoMapRules::HASH_MAX;
+}
+
+int CAutoMapRules::HashLocation(uint32_t Seed, uint32_t Run, uint32_t Rule, uint32_t X, uint32_t Y)
+{
+	return HashTile(HashRule(Seed, Run, Rule), HashUInt32(X), HashUInt32(Y));
+}
+
+void CAutoMapRules::Load(CLineReader &LineReader)
+{
+	CConfiguration *pCurrentConf = nullptr;
+	CRun *pCurrentRun = nullptr;
+	CIndexRule *pCurrentIndex = nullptr;
+
+	// read each line
+	while(const char *pLine = LineReader.Get())
+	{
+		// skip blank/empty lines as well as comments
+		if(str_length(pLine) > 0 && pLine[0] != '#' && pLine[0] != '\n' && pLine[0] != '\r' && pLine[0] != '\t' && pLine[0] != '\v' && pLine[0] != ' ')
+		{
+			if(pLine[0] == '[')
+			{
+				// new configuration, get the name
+				pLine++;
+				CConfiguration NewConf;
+				NewConf.m_aName[0] = '\0';
+				NewConf.m_StartX = 0;
+				NewConf.m_StartY = 0;
+				NewConf.m_EndX = 0;
+				NewConf.m_EndY = 0;
+				m_vConfigs.push_back(NewConf);
+				int ConfigurationId = m_vConfigs.size() - 1;
+				pCurrentConf = &m_vConfigs[ConfigurationId];
+				str_copy(pCurrentConf->m_aName, pLine, minimum<int>(sizeof(pCurrentConf->m_aName), str_length(pLine)));
+
+				// add start run
+				CRun NewRun;
+				NewRun.m_AutomapCopy = true;
+				pCurrentConf->m_vRuns.push_back(NewRun);
+				int RunId = pCurrentConf->m_vRuns.size() - 1;
+				pCurrentRun = &pCurrentConf->m_vRuns[RunId];
+			}
+			else if(str_startswith(pLine, "NewRun") && pCurrentConf)
+			{
+				// add new run
+				CRun NewRun;
+				NewRun.m_AutomapCopy = true;
+				pCurrentConf->m_vRuns.push_back(NewRun);
+				int RunId = pCurrentConf->m_vRuns.size() - 1;
+				pCurrentRun = &pCurrentConf->m_vRuns[RunId];
+			}
+			else if(str_startswith(pLine, "Index") && pCurrentRun)
+			{
+				// new index
+				int Id = 0;
+				char aOrientation1[128] = "";
+				char aOrientation2[128] = "";
+				char aOrientation3[128] = "";
+
+				sscanf(pLine, "Index %d %127s %127s %127s", &Id, aOrientation1, aOrientation2, aOrientation3);
+
+				CIndexRule NewIndexRule;
+				NewIndexRule.m_Id = Id;
+				NewIndexRule.m_Flag = 0;
+				NewIndexRule.m_RandomProbability = 1.0f;
+				NewIndexRule.m_DefaultRule = true;
+				NewIndexRule.m_SkipEmpty = false;
+				NewIndexRule.m_SkipFull = false;
+
+				if(str_length(aOrientation1) > 0)
+				{
+					if(!str_comp(aOrientation1, "XFLIP"))
+						NewIndexRule.m_Flag |= TILEFLAG_XFLIP;
+					else if(!str_comp(aOrientation1, "YFLIP"))
+						NewIndexRule.m_Flag |= TILEFLAG_YFLIP;
+					else if(!str_comp(aOrientation1, "ROTATE"))
+						NewIndexRule.m_Flag |= TILEFLAG_ROTATE;
+				}
+
+				if(str_length(aOrientation2) > 0)
+				{
+					if(!str_comp(aOrientation2, "XFLIP"))
+						NewIndexRule.m_Flag |= TILEFLAG_XFLIP;
+					else if(!str_comp(aOrientation2, "YFLIP"))
+						NewIndexRule.m_Flag |= TILEFLAG_YFLIP;
+					else if(!str_comp(aOrientation2, "ROTATE"))
+						NewIndexRule.m_Flag |= TILEFLAG_ROTATE;
+				}
+
+				if(str_length(aOrientation3) > 0)
+				{
+					if(!str_comp(aOrientation3, "XFLIP"))
+						NewIndexRule.m_Flag |= TILEFLAG_XFLIP;
+					else if(!str_comp(aOrientation3, "YFLIP"))
+						NewIndexRule.m_Flag |= TILEFLAG_YFLIP;
+					else if(!str_comp(aOrientation3, "ROTATE"))
+						NewIndexRule.m_Flag |= TILEFLAG_ROTATE;
+				}
+
+				// add the index rule object and make it current
+				pCurrentRun->m_vIndexRules.push_back(NewIndexRule);
+				int IndexRuleId = pCurrentRun->m_vIndexRules.size() - 1;
+				pCurrentIndex = &pCurrentRun->m_vIndexRules[IndexRuleId];
+			}
+			else if(str_startswith(pLine, "Pos") && pCurrentIndex)
+			{
+				int x = 0, y = 0;
+				char aValue[128];
+				int Value = CPosRule::NORULE;
+				std::vector<CIndexInfo> vNewIndexList;
+
+				sscanf(pLine, "Pos %d %d %127s", &x, &y, aValue);
+
+				if(!str_comp(aValue, "EMPTY"))
+				{
+					Value = CPosRule::INDEX;
+					CIndexInfo NewIndexInfo = {0, 0, false};
+					vNewIndexList.push_back(NewIndexInfo);
+				}
+				else if(!str_comp(aValue, "FULL"))
+				{
+					Value = CPosRule::NOTINDEX;
+					CIndexInfo NewIndexInfo1 = {0, 0, false};
+					// CIndexInfo NewIndexInfo2 = {-1, 0};
+					vNewIndexList.push_back(NewIndexInfo1);
+					// vNewIndexList.push_back(NewIndexInfo2);
+				}
+				else if(!str_comp(aValue, "INDEX") || !str_comp(aValue, "NOTINDEX"))
+				{
+					if(!str_comp(aValue, "INDEX"))
+						Value = CPosRule::INDEX;
+					else
+						Value = CPosRule::NOTINDEX;
+
+					int pWord = 4;
+					while(true)
+					{
+						int Id = 0;
+						char aOrientation1[128] = "";
+						char aOrientation2[128] = "";
+						char aOrientation3[128] = "";
+						char aOrientation4[128] = "";
+						sscanf(str_trim_words(pLine, pWord), "%d %127s %127s %127s %127s", &Id, aOrientation1, aOrientation2, aOrientation3, aOrientation4);
+
+						CIndexInfo NewIndexInfo;
+						NewIndexInfo.m_Id = Id;
+						NewIndexInfo.m_Flag = 0;
+						NewIndexInfo.m_TestFlag = false;
+
+						if(!str_comp(aOrientation1, "OR"))
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							pWord += 2;
+							continue;
+						}
+						else if(str_length(aOrientation1) > 0)
+						{
+							NewIndexInfo.m_TestFlag = true;
+							if(!str_comp(aOrientation1, "XFLIP"))
+								NewIndexInfo.m_Flag = TILEFLAG_XFLIP;
+							else if(!str_comp(aOrientation1, "YFLIP"))
+								NewIndexInfo.m_Flag = TILEFLAG_YFLIP;
+							else if(!str_comp(aOrientation1, "ROTATE"))
+								NewIndexInfo.m_Flag = TILEFLAG_ROTATE;
+							else if(!str_comp(aOrientation1, "NONE"))
+								NewIndexInfo.m_Flag = 0;
+							else
+								NewIndexInfo.m_TestFlag = false;
+						}
+						else
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							break;
+						}
+
+						if(!str_comp(aOrientation2, "OR"))
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							pWord += 3;
+							continue;
+						}
+						else if(str_length(aOrientation2) > 0 && NewIndexInfo.m_Flag != 0)
+						{
+							if(!str_comp(aOrientation2, "XFLIP"))
+								NewIndexInfo.m_Flag |= TILEFLAG_XFLIP;
+							else if(!str_comp(aOrientation2, "YFLIP"))
+								NewIndexInfo.m_Flag |= TILEFLAG_YFLIP;
+							else if(!str_comp(aOrientation2, "ROTATE"))
+								NewIndexInfo.m_Flag |= TILEFLAG_ROTATE;
+						}
+						else
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							break;
+						}
+
+						if(!str_comp(aOrientation3, "OR"))
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							pWord += 4;
+							continue;
+						}
+						else if(str_length(aOrientation3) > 0 && NewIndexInfo.m_Flag != 0)
+						{
+							if(!str_comp(aOrientation3, "XFLIP"))
+								NewIndexInfo.m_Flag |= TILEFLAG_XFLIP;
+							else if(!str_comp(aOrientation3, "YFLIP"))
+								NewIndexInfo.m_Flag |= TILEFLAG_YFLIP;
+							else if(!str_comp(aOrientation3, "ROTATE"))
+								NewIndexInfo.m_Flag |= TILEFLAG_ROTATE;
+						}
+						else
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							break;
+						}
+
+						if(!str_comp(aOrientation4, "OR"))
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							pWord += 5;
+							continue;
+						}
+						else
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							break;
+						}
+					}
+				}
+
+				if(Value != CPosRule::NORULE)
+				{
+					CPosRule NewPosRule = {x, y, Value, vNewIndexList};
+					pCurrentIndex->m_vRules.push_back(NewPosRule);
+
+					pCurrentConf->m_StartX = minimum(pCurrentConf->m_StartX, NewPosRule.m_X);
+					pCurrentConf->m_StartY = minimum(pCurrentConf->m_StartY, NewPosRule.m_Y);
+					pCurrentConf->m_EndX = maximum(pCurrentConf->m_EndX, NewPosRule.m_X);
+					pCurrentConf->m_EndY = maximum(pCurrentConf->m_EndY, NewPosRule.m_Y);
+
+					if(x == 0 && y == 0)
+					{
+						for(const auto &Index : vNewIndexList)
+						{
+							if(Index.m_Id == 0 && Value == CPosRule::INDEX)
+							{
+								// Skip full tiles if we have a rule "POS 0 0 INDEX 0"
+								// because that forces the tile to be empty
+								pCurrentIndex->m_SkipFull = true;
+							}
+							else if((Index.m_Id > 0 && Value == CPosRule::INDEX) || (Index.m_Id == 0 && Value == CPosRule::NOTINDEX))
+							{
+								// Skip empty tiles if we have a rule "POS 0 0 INDEX i" where i > 0
+								// or if we have a rule "POS 0 0 NOTINDEX 0"
+								pCurrentIndex->m_SkipEmpty = true;
+							}
+						}
+					}
+				}
+			}
+			else if(str_startswith(pLine, "Random") && pCurrentIndex)
+			{
+				float Value;
+				char Specifier = ' ';
+				sscanf(pLine, "Random %f%c", &Value, &Specifier);
+				if(Specifier == '%')
+				{
+					pCurrentIndex->m_RandomProbability = Value / 100.0f;
+				}
+				else
+				{
+					pCurrentIndex->m_RandomProbability = 1.0f / Value;
+				}
+			}
+			else if(str_startswith(pLine, "NoDefaultRule") && pCurrentIndex)
+			{
+				pCurrentIndex->m_DefaultRule = false;
+			}
+			else if(str_startswith(pLine, "NoLayerCopy") && pCurrentRun)
+			{
+				pCurrentRun->m_AutomapCopy = false;
+			}
+		}
+	}
+
+	// add default rule for Pos 0 0 if there is none
+	for(auto &Config : m_vConfigs)
+	{
+		for(auto &Run : Config.m_vRuns)
+		{
+			for(auto &IndexRule : Run.m_vIndexRules)
+			{
+				bool Found = false;
+
+				// Search for the exact rule "POS 0 0 INDEX 0" which corresponds to the default rule
+				for(const auto &Rule : IndexRule.m_vRules)
+				{
+					if(Rule.m_X == 0 && Rule.m_Y == 0 && Rule.m_Value == CPosRule::INDEX)
+					{
+						for(const auto &Index : Rule.m_vIndexList)
+						{
+							if(Index.m_Id == 0)
+								Found = true;
+						}
+						break;
+					}
+
+					if(Found)
+						break;
+				}
+
+				// If the default rule was not found, and we require it, then add it
+				if(!Found && IndexRule.m_DefaultRule)
+				{
+					std::vector<CIndexInfo> vNewIndexList;
+					CIndexInfo NewIndexInfo = {0, 0, false};
+					vNewIndexList.push_back(NewIndexInfo);
+					CPosRule NewPosRule = {0, 0, CPosRule::NOTINDEX, vNewIndexList};
+					IndexRule.m_vRules.push_back(NewPosRule);
+
+					IndexRule.m_SkipEmpty = true;
+					IndexRule.m_SkipFull = false;
+				}
+
+				if(IndexRule.m_SkipEmpty && IndexRule.m_SkipFull)
+				{
+					IndexRule.m_SkipEmpty = false;
+					IndexRule.m_SkipFull = false;
+				}
+			}
+		}
+	}
+
+	for(auto &Config : m_vConfigs)
+	{
+		for(auto &Run : Config.m_vRuns)
+			Compile(Run);
+	}
+}
+
+void CAutoMapRules::Compile(CRun &Run)
+{
+	CCompiledRun &Compiled = Run.m_Compiled;
+	Compiled = CCompiledRun();
+	for(const CIndexRule &IndexRule : Run.m_vIndexRules)
+	{
+		CCompiledRun::CIndexCheck Check;
+		Check.m_Tile.m_Index = IndexRule.m_Id;
+		Check.m_Tile.m_Flags = IndexRule.m_Flag;
+		Check.m_Tile.m_Skip = 0;
+		Check.m_Tile.m_Reserved = 0;
+		Check.m_Random = !(IndexRule.m_RandomProbability >= 1.0f);
+		Check.m_RandomLimit = HASH_MAX * IndexRule.m_RandomProbability;
+		Check.m_SkipEmpty = IndexRule.m_SkipEmpty;
+		Check.m_SkipFull = IndexRule.m_SkipFull;
+		Check.m_FirstPosCheck = Compiled.m_vPosChecks.size();
+		Check.m_Mask = 0;
+		Check.m_Want = 0;
+		Check.m_Impossible = false;
+		for(const CPosRule &Rule : IndexRule.m_vRules)
+		{
+			if(Rule.m_Value != CPosRule::INDEX && Rule.m_Value != CPosRule::NOTINDEX)
+				continue;
+
+			CCompiledRun::CMatchTable Table = {};
+			for(const CIndexInfo &Index : Rule.m_vIndexList)
+			{
+				// tile indices are unsigned char, -1 is outside of the layer
+				if(Index.m_Id < -1 || Index.m_Id > 255)
+					continue;
+				for(int Flags = 0; Flags < 16; Flags++)
+				{
+					if(!Index.m_TestFlag || Flags == Index.m_Flag)
+						Table[Index.m_Id + 1] |= 1 << Flags;
+				}
+			}
+
+			// most rules check for the same few index lists
+			int TableIndex = 0;
+			while(TableIndex < (int)Compiled.m_vTables.size() && Compiled.m_vTables[TableIndex] != Table)
+				TableIndex++;
+			if(TableIndex == (int)Compiled.m_vTables.size())
+				Compiled.m_vTables.push_back(Table);
+
+			Compiled.m_vPosChecks.push_back({Rule.m_X, Rule.m_Y, Rule.m_Value == CPosRule::NOTINDEX, TableIndex});
+
+			int Neighbour = 0;
+			while(Neighbour < (int)Compiled.m_vNeighbours.size() &&
+				(Compiled.m_vNeighbours[Neighbour].m_X != Rule.m_X || Compiled.m_vNeighbours[Neighbour].m_Y != Rule.m_Y || Compiled.m_vNeighbours[Neighbour].m_Table != TableIndex))
+				Neighbour++;
+			if(Neighbour == (int)Compiled.m_vNeighbours.size())
+				Compiled.m_vNeighbours.push_back({Rule.m_X, Rule.m_Y, TableIndex});
+			if(Neighbour < 64)
+			{
+				const uint64_t Bit = (uint64_t)1 << Neighbour;
+				const uint64_t Want = Rule.m_Value == CPosRule::INDEX ? Bit : 0;
+				if(Check.m_Mask & Bit && (Check.m_Want & Bit) != Want)
+					Check.m_Impossible = true;
+				Check.m_Mask |= Bit;
+				Check.m_Want |= Want;
+			}
+			Compiled.m_MinX = minimum(Compiled.m_MinX, Rule.m_X);
+			Compiled.m_MinY = minimum(Compiled.m_MinY, Rule.m_Y);
+			Compiled.m_MaxX = maximum(Compiled.m_MaxX, Rule.m_X);
+			Compiled.m_MaxY = maximum(Compiled.m_MaxY, Rule.m_Y);
+		}
+		Check.m_NumPosChecks = Compiled.m_vPosChecks.size() - Check.m_FirstPosCheck;
+		if(!Check.m_SkipEmpty)
+			Compiled.m_vEmptyChecks.push_back(Compiled.m_vIndexChecks.size());
+		if(!Check.m_SkipFull)
+			Compiled.m_vFullChecks.push_back(Compiled.m_vIndexChecks.size());
+		Compiled.m_vIndexChecks.push_back(Check);
+	}
+	Compiled.m_UseMasks = Compiled.m_vNeighbours.size() <= 64;
+}
+
+template<bool Inside>
+uint64_t CAutoMapRules::NeighbourBits(const CCompiledRun &Compiled, const int *pOffsets, const CTile *pRead, int Width, int Height, int x, int y)
+{
+	const CTile *pCenter = &pRead[y * Width + x];
+	uint64_t Bits = 0;
+	for(int i = 0; i < (int)Compiled.m_vNeighbours.size(); i++)
+	{
+		const CCompiledRun::CNeighbour &Neighbour = Compiled.m_vNeighbours[i];
+		int Entry = 0;
+		int CheckFlags = 0;
+		if(Inside || (x + Neighbour.m_X >= 0 && x + Neighbour.m_X < Width && y + Neighbour.m_Y >= 0 && y + Neighbour.m_Y < Height))
+		{
+			const CTile &Tile = pCenter[pOffsets[i]];
+			Entry = Tile.m_Index + 1;
+			CheckFlags = Tile.m_Flags & (TILEFLAG_ROTATE | TILEFLAG_XFLIP | TILEFLAG_YFLIP);
+		}
+		Bits |= (uint64_t)((Compiled.m_vTables[Neighbour.m_Table][Entry] >> CheckFlags) & 1) << i;
+	}
+	return Bits;
+}
+
+template<bool Inside>
+bool CAutoMapRules::Matches(const CCompiledRun &Compiled, const CCompiledRun::CIndexCheck &Check, const int *pOffsets, const CTile *pRead, int Width, int Height, int x, int y)
+{
+	const CCompiledRun::CPosCheck *pPosCheck = &Compiled.m_vPosChecks[Check.m_FirstPosCheck];
+	const int *pOffset = &pOffsets[Check.m_FirstPosCheck];
+	const CTile *pCenter = &pRead[y * Width + x];
+	for(int i = 0; i < Check.m_NumPosChecks; i++)
+	{
+		int Entry = 0;
+		int CheckFlags = 0;
+		// the bounds only have to be checked near the border of the layer
+		if(Inside || (x + pPosCheck[i].m_X >= 0 && x + pPosCheck[i].m_X < Width && y + pPosCheck[i].m_Y >= 0 && y + pPosCheck[i].m_Y < Height))
+		{
+			const CTile &Tile = pCenter[pOffset[i]];
+			Entry = Tile.m_Index + 1;
+			CheckFlags = Tile.m_Flags & (TILEFLAG_ROTATE | TILEFLAG_XFLIP | TILEFLAG_YFLIP);
+		}
+		const bool Match = (Compiled.m_vTables[pPosCheck[i].m_Table][Entry] >> CheckFlags) & 1;
+		if(Match == pPosCheck[i].m_NotIndex)
+			return false;
+	}
+	return true;
+}
+
+void CAutoMapRules::Proceed(CTile *pTiles, int Width, int Height, int ConfigId, int Seed, int SeedOffsetX, int SeedOffsetY, CWorkerGroup *pWorkers, const FTileChanged &TileChanged) const
+{
+	const CConfiguration &Conf = m_vConfigs[ConfigId];
+	std::vector<CTile> vReadTiles;
+	std::vector<unsigned char> vChanged;
+	std::vector<int> vOffsets;
+	std::vector<int> vNeighbourOffsets;
+	std::vector<uint32_t> vRuleHashes;
+
+	for(size_t h = 0; h < Conf.m_vRuns.size(); ++h)
+	{
+		const CRun &Run = Conf.m_vRuns[h];
+		const CCompiledRun &Compiled = Run.m_Compiled;
+		const int NumIndexChecks = Compiled.m_vIndexChecks.size();
+		// the position checks as offsets in the tiles of this layer
+		vOffsets.resize(Compiled.m_vPosChecks.size());
+		for(size_t i = 0; i < Compiled.m_vPosChecks.size(); i++)
+			vOffsets[i] = Compiled.m_vPosChecks[i].m_Y * Width + Compiled.m_vPosChecks[i].m_X;
+		const int *pOffsets = vOffsets.data();
+		vNeighbourOffsets.resize(Compiled.m_vNeighbours.size());
+		for(size_t i = 0; i < Compiled.m_vNeighbours.size(); i++)
+			vNeighbourOffsets[i] = Compiled.m_vNeighbours[i].m_Y * Width + Compiled.m_vNeighbours[i].m_X;
+		const int *pNeighbourOffsets = vNeighbourOffsets.data();
+		vRuleHashes.resize(NumIndexChecks);
+		for(int i = 0; i < NumIndexChecks; i++)
+			vRuleHashes[i] = HashRule(Seed, h, i);
+		const uint32_t *pRuleHashes = vRuleHashes.data();
+		const auto &&IsInside = [&](int x, int y) {
+			return x + Compiled.m_MinX >= 0 && x + Compiled.m_MaxX < Width && y + Compiled.m_MinY >= 0 && y + Compiled.m_MaxY < Height;
+		};
+		const auto &&IsApplied = [&](const CCompiledRun::CIndexCheck &Check, int i, const CTile &ReadTile, const CTile *pRead, bool Inside, int x, int y) {
+			if(Check.m_SkipEmpty && ReadTile.m_Index == 0) // skip empty tiles
+				return false;
+			if(Check.m_SkipFull && ReadTile.m_Index != 0) // skip full tiles
+				return false;
+			const bool RespectRules = Inside ? Matches<true>(Compiled, Check, pOffsets, pRead, Width, Height, x, y) : Matches<false>(Compiled, Check, pOffsets, pRead, Width, Height, x, y);
+			return RespectRules &&
+			       (!Check.m_Random || HashTile(pRuleHashes[i], HashUInt32(x + SeedOffsetX), HashUInt32(y + SeedOffsetY)) < Check.m_RandomLimit);
+		};
+
+		if(!Run.m_AutomapCopy)
+		{
+			// the rules see the tiles that were already changed by this run,
+			// so the tiles have to be processed in order
+			for(int y = 0; y < Height; y++)
+			{
+				for(int x = 0; x < Width; x++)
+				{
+					CTile *pTile = &pTiles[y * Width + x];
+					const CTile Previous = *pTile;
+					const bool Inside = IsInside(x, y);
+					bool Changed = false;
+					for(int i = 0; i < NumIndexChecks; i++)
+					{
+						const CCompiledRun::CIndexCheck &Check = Compiled.m_vIndexChecks[i];
+						if(IsApplied(Check, i, *pTile, pTiles, Inside, x, y))
+						{
+							pTile->m_Index = Check.m_Tile.m_Index;
+							pTile->m_Flags = Check.m_Tile.m_Flags;
+							Changed = true;
+						}
+					}
+					if(Changed)
+						TileChanged(x, y, Previous, *pTile);
+				}
+			}
+			continue;
+		}
+
+		// the run reads from a copy of the layer, so every row can be
+		// processed on its own
+		vReadTiles.assign(pTiles, pTiles + Width * Height);
+		vChanged.assign(Width * Height, 0);
+		const CTile *pRead = vReadTiles.data();
+		const int RowsPerTask = 16;
+		const int NumTasks = (Height + RowsPerTask - 1) / RowsPerTask;
+		const auto &&ProcessRows = [&](int Task, int Worker) {
+			const int EndY = minimum((Task + 1) * RowsPerTask, Height);
+			for(int y = Task * RowsPerTask; y < EndY; y++)
+			{
+				for(int x = 0; x < Width; x++)
+				{
+					// the last rule that applies wins
+					const CTile &ReadTile = pRead[y * Width + x];
+					const std::vector<int> &vChecks = ReadTile.m_Index == 0 ? Compiled.m_vEmptyChecks : Compiled.m_vFullChecks;
+					if(vChecks.empty())
+						continue;
+					const bool Inside = IsInside(x, y);
+					int Applied = -1;
+					if(Compiled.m_UseMasks)
+					{
+						const uint64_t Bits = Inside ? NeighbourBits<true>(Compiled, pNeighbourOffsets, pRead, Width, Height, x, y) : NeighbourBits<false>(Compiled, pNeighbourOffsets, pRead, Width, Height, x, y);
+						// the coordinates are only hashed once for all random rules
+						uint32_t HashX = 0;
+						uint32_t HashY = 0;
+						bool Hashed = false;
+						for(int c = vChecks.size() - 1; c >= 0 && Applied < 0; c--)
+						{
+							const int i = vChecks[c];
+							const CCompiledRun::CIndexCheck &Check = Compiled.m_vIndexChecks[i];
+							if(Check.m_Impossible || (Bits & Check.m_Mask) != Check.m_Want)
+								continue;
+							if(Check.m_Random)
+							{
+								if(!Hashed)
+								{
+									HashX = HashUInt32(x + SeedOffsetX);
+									HashY = HashUInt32(y + SeedOffsetY);
+									Hashed = true;
+								}
+								if(HashTile(pRuleHashes[i], HashX, HashY) >= Check.m_RandomLimit)
+									continue;
+							}
+							Applied = i;
+						}
+					}
+					else
+					{
+						for(int c = vChecks.size() - 1; c >= 0 && Applied < 0; c--)
+						{
+							if(IsApplied(Compiled.m_vIndexChecks[vChecks[c]], vChecks[c], ReadTile, pRead, Inside, x, y))
+								Applied = vChecks[c];
+						}
+					}
+					if(Applied >= 0)
+					{
+						pTiles[y * Width + x].m_Index = Compiled.m_vIndexChecks[Applied].m_Tile.m_Index;
+						pTiles[y * Width + x].m_Flags = Compiled.m_vIndexChecks[Applied].m_Tile.m_Flags;
+						vChanged[y * Width + x] = 1;
+					}
+				}
+			}
+		};
+		if(pWorkers)
+		{
+			pWorkers->Run(NumTasks, ProcessRows);
+		}
+		else
+		{
+			for(int Task = 0; Task < NumTasks; Task++)
+				ProcessRows(Task, 0);
+		}
+
+		for(int y = 0; y < Height; y++)
+		{
+			for(int x = 0; x < Width; x++)
+			{
+				if(vChanged[y * Width + x])
+					TileChanged(x, y, pRead[y * Width + x], pTiles[y * Width + x]);
+			}
+		}
+	}
+}
@@ -0,0 +1,161 @@
+#ifndef GAME_EDITOR_AUTO_MAP_RULES_H
+#define GAME_EDITOR_AUTO_MAP_RULES_H
+
+#include <game/mapitems.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class CLineReader;
+class CWorkerGroup;
+
+// The automapper rules of a tileset and their application to tiles,
+// independent of the editor.
+class CAutoMapRules
+{
+public:
+	struct CIndexInfo
+	{
+		int m_Id;
+		int m_Flag;
+		bool m_TestFlag;
+	};
+
+	struct CPosRule
+	{
+		int m_X;
+		int m_Y;
+		int m_Value;
+		std::vector<CIndexInfo> m_vIndexList;
+
+		enum
+		{
+			NORULE = 0,
+			INDEX,
+			NOTINDEX
+		};
+	};
+
+	struct CIndexRule
+	{
+		int m_Id;
+		std::vector<CPosRule> m_vRules;
+		int m_Flag;
+		float m_RandomProbability;
+		bool m_DefaultRule;
+		bool m_SkipEmpty;
+		bool m_SkipFull;
+	};
+
+	// the position rules of a run, compiled to lookup tables. A position
+	// rule matches if bit `Flags & (TILEFLAG_ROTATE | TILEFLAG_XFLIP |
+	// TILEFLAG_YFLIP)` of the table entry `Index + 1` is set, the first
+	// entry is for positions outside of the layer.
+	struct CCompiledRun
+	{
+		typedef std::array<uint16_t, 257> CMatchTable;
+
+		struct CPosCheck
+		{
+			int m_X;
+			int m_Y;
+			bool m_NotIndex;
+			int m_Table;
+		};
+
+		struct CNeighbour
+		{
+			int m_X;
+			int m_Y;
+			int m_Table;
+		};
+
+		struct CIndexCheck
+		{
+			CTile m_Tile;
+			// compared to the location hash, the rule is applied everywhere
+			// if it is not set
+			bool m_Random;
+			float m_RandomLimit;
+			bool m_SkipEmpty;
+			bool m_SkipFull;
+			int m_FirstPosCheck;
+			int m_NumPosChecks;
+			// the bits of the neighbours that are checked and the values
+			// they must have, if the run uses masks
+			uint64_t m_Mask;
+			uint64_t m_Want;
+			// checks the same neighbour with INDEX and NOTINDEX
+			bool m_Impossible;
+		};
+
+		std::vector<CMatchTable> m_vTables;
+		std::vector<CPosCheck> m_vPosChecks;
+		std::vector<CIndexCheck> m_vIndexChecks;
+		// the index checks that don't skip empty or full tiles, most rules
+		// only apply to one of them
+		std::vector<int> m_vEmptyChecks;
+		std::vector<int> m_vFullChecks;
+		// the distinct position checks of the run. If there are at most 64,
+		// every tile is looked up in each table once and the index checks
+		// only compare the bits of the results.
+		std::vector<CNeighbour> m_vNeighbours;
+		bool m_UseMasks = false;
+		// bounding box of the positions that are checked around a tile
+		int m_MinX = 0;
+		int m_MinY = 0;
+		int m_MaxX = 0;
+		int m_MaxY = 0;
+	};
+
+	struct CRun
+	{
+		std::vector<CIndexRule> m_vIndexRules;
+		bool m_AutomapCopy;
+		CCompiledRun m_Compiled;
+	};
+
+	struct CConfiguration
+	{
+		std::vector<CRun> m_vRuns;
+		char m_aName[128];
+		int m_StartX;
+		int m_StartY;
+		int m_EndX;
+		int m_EndY;
+	};
+
+	// called for every tile that a run changed, in the order of the runs
+	// and rows
+	typedef std::function<void(int x, int y, CTile Previous, CTile Tile)> FTileChanged;
+
+	// adds the configurations of a rules file
+	void Load(CLineReader &LineReader);
+
+	int NumConfigs() const { return m_vConfigs.size(); }
+	const CConfiguration &Config(int Index) const { return m_vConfigs[Index]; }
+
+	// Applies the configuration to the `Width` x `Height` tiles. Runs that
+	// work on a copy of the layer are split into rows on `pWorkers` if it
+	// is set, the result is the same as without workers.
+	void Proceed(CTile *pTiles, int Width, int Height, int ConfigId, int Seed, int SeedOffsetX, int SeedOffsetY, CWorkerGroup *pWorkers, const FTileChanged &TileChanged) const;
+
+	static int HashLocation(uint32_t Seed, uint32_t Run, uint32_t Rule, uint32_t X, uint32_t Y);
+	enum
+	{
+		HASH_MAX = 65536,
+	};
+
+private:
+	static void Compile(CRun &Run);
+	template<bool Inside>
+	static uint64_t NeighbourBits(const CCompiledRun &Compiled, const int *pOffsets, const CTile *pRead, int Width, int Height, int x, int y);
+	template<bool Inside>
+	static bool Matches(const CCompiledRun &Compiled, const CCompiledRun::CIndexCheck &Check, const int *pOffsets, const CTile *pRead, int Width, int Height, int x, int y);
+
+	std::vector<CConfiguration> m_vConfigs;
+};
+
+#endif
@@ -8473,6 +8473,12 @@ void CEditor::Init()
 	m_ZoomEnvelopeY.OnInit(this);
 	m_Map.m_pEditor = this;
 
+	char aSpillFile[IO_MAX_PATH_LENGTH];
+	IStorage::FormatTmpPath(aSpillFile, sizeof(aSpillFile), "editor_history");
+	char aSpillPath[IO_MAX_PATH_LENGTH];
+	Storage()->GetCompletePath(IStorage::TYPE_SAVE, aSpillFile, aSpillPath, sizeof(aSpillPath));
+	m_HistoryStore.Init(aSpillPath, (size_t)g_Config.m_ClEditorHistoryMemory * 1024 * 1024);
+
 	m_vComponents.emplace_back(m_MapView);
 	m_vComponents.emplace_back(m_MapSettingsBackend);
 	m_vComponents.emplace_back(m_LayerSelector);
@@ -8737,7 +8743,7 @@ void CEditor::HandleWriterFinishJobs()
 		{
 			char aMapName[128];
 			IStorage::StripPathAndExtension(pJob->GetRealFileName(), aMapName, sizeof(aMapName));
-			if(!str_comp(aMapName, CurrentServerInfo.m_aMap))
+			if(!str_comp(aMapName, CurrentServerInfo.m_pMap))
 				Client()->Rcon("hot_reload");
 		}
 	}
@@ -8779,6 +8785,7 @@ void CEditor::OnUpdate()
 	HandleCursorMovement();
 	HandleAutosave();
 	HandleWriterFinishJobs();
+	m_HistoryStore.SetMemoryLimit((size_t)g_Config.m_ClEditorHistoryMemory * 1024 * 1024);
 
 	for(CEditorComponent &Component : m_vComponents)
 		Component.OnUpdate();
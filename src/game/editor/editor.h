@@ -31,8 +31,10 @@
 #include <engine/graphics.h>
 #include <engine/shared/datafile.h>
 #include <engine/shared/jobs.h>
+#include <engine/shared/workergroup.h>
 
 #include "editor_history.h"
+#include "history_store.h"
 #include "editor_server_settings.h"
 #include "editor_trackers.h"
 #include "editor_ui.h"
@@ -833,6 +835,8 @@ public:
 
 	CEditorMap m_Map;
 	std::deque<std::shared_ptr<CDataFileWriterFinishJob>> m_WriterFinishJobs;
+	// shared by the automappers of all images
+	CWorkerGroup m_AutoMapWorkers;
 
 	int m_ShiftBy;
 
@@ -1171,6 +1175,8 @@ public:
 	int FindNextFreeTeleNumber(bool Checkpoint = false);
 
 	// Undo/Redo
+	// the tile changes of the histories, it has to outlive them
+	CHistoryStore m_HistoryStore;
 	CEditorHistory m_EditorHistory;
 	CEditorHistory m_ServerSettingsHistory;
 	CEditorHistory m_EnvelopeEditorHistory;
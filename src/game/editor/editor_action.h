@@ -20,11 +20,16 @@ public:
 
 	virtual bool IsEmpty() { return false; }
 
+	// whether the last Undo or Redo failed because the data kept in the
+	// history store could not be read, nothing was changed then
+	bool Failed() const { return m_Failed; }
+
 	const char *DisplayText() const { return m_aDisplayText; }
 
 protected:
 	CEditor *m_pEditor;
 	char m_aDisplayText[256];
+	bool m_Failed = false;
 };
 
 #endif
@@ -1,9 +1,131 @@
 #include "editor_actions.h"
 #include <game/editor/mapitems/image.h>
 
+#include <type_traits>
+
+// calls `Func` with the array of special tiles of the layer, if it has one
+template<typename F>
+static void SpecialTiles(CLayerTiles *pLayer, F &&Func)
+{
+	if(pLayer->m_Tele)
+		Func(static_cast<CLayerTele *>(pLayer)->m_pTeleTile);
+	else if(pLayer->m_Speedup)
+		Func(static_cast<CLayerSpeedup *>(pLayer)->m_pSpeedupTile);
+	else if(pLayer->m_Switch)
+		Func(static_cast<CLayerSwitch *>(pLayer)->m_pSwitchTile);
+	else if(pLayer->m_Tune)
+		Func(static_cast<CLayerTune *>(pLayer)->m_pTuneTile);
+}
+
+CStoredLayerTiles::CStoredLayerTiles(CEditor *pEditor, CLayerTiles *pLayer) :
+	m_pEditor(pEditor), m_Width(pLayer->m_Width), m_Height(pLayer->m_Height)
+{
+	const size_t NumTiles = (size_t)m_Width * m_Height;
+	std::vector<unsigned char> vData(NumTiles * sizeof(CTile));
+	mem_copy(vData.data(), pLayer->m_pTiles, vData.size());
+	SpecialTiles(pLayer, [&](auto *&pSpecialTiles) {
+		const size_t Offset = vData.size();
+		vData.resize(Offset + NumTiles * sizeof(*pSpecialTiles));
+		mem_copy(vData.data() + Offset, pSpecialTiles, NumTiles * sizeof(*pSpecialTiles));
+	});
+	m_Id = m_pEditor->m_HistoryStore.Add(vData);
+}
+
+CStoredLayerTiles::~CStoredLayerTiles()
+{
+	m_pEditor->m_HistoryStore.Remove(m_Id);
+}
+
+bool CStoredLayerTiles::Read(std::vector<unsigned char> &vData) const
+{
+	return m_pEditor->m_HistoryStore.Get(m_Id, vData);
+}
+
+bool CStoredLayerTiles::Restore(const std::shared_ptr<CLayerTiles> &pLayer, const std::vector<unsigned char> &vData) const
+{
+	const size_t NumTiles = (size_t)m_Width * m_Height;
+	size_t Size = NumTiles * sizeof(CTile);
+	SpecialTiles(pLayer.get(), [&](auto *&pSpecialTiles) { Size += NumTiles * sizeof(*pSpecialTiles); });
+	if(pLayer->m_Width != m_Width || pLayer->m_Height != m_Height || vData.size() != Size)
+		return false;
+
+	if(!pLayer->m_pTiles)
+		pLayer->m_pTiles = new CTile[NumTiles];
+	mem_copy(pLayer->m_pTiles, vData.data(), NumTiles * sizeof(CTile));
+	SpecialTiles(pLayer.get(), [&](auto *&pSpecialTiles) {
+		if(!pSpecialTiles)
+			pSpecialTiles = new std::remove_reference_t<decltype(*pSpecialTiles)>[NumTiles];
+		mem_copy(pSpecialTiles, vData.data() + NumTiles * sizeof(CTile), NumTiles * sizeof(*pSpecialTiles));
+	});
+	pLayer->m_TileChunks.InvalidateAll();
+	return true;
+}
+
+bool CStoredLayerTiles::Restore(const std::shared_ptr<CLayerTiles> &pLayer) const
+{
+	std::vector<unsigned char> vData;
+	return Read(vData) && Restore(pLayer, vData);
+}
+
+void CStoredLayerTiles::FreeTiles(const std::shared_ptr<CLayerTiles> &pLayer)
+{
+	delete[] pLayer->m_pTiles;
+	pLayer->m_pTiles = nullptr;
+	SpecialTiles(pLayer.get(), [](auto *&pSpecialTiles) {
+		delete[] pSpecialTiles;
+		pSpecialTiles = nullptr;
+	});
+	pLayer->m_TileChunks.InvalidateAll();
+}
+
+// stores and frees the tiles of the tiles layers of groups that are removed from the map
+static std::vector<std::unique_ptr<CStoredLayerTiles>> StoreGroupTiles(CEditor *pEditor, const std::vector<std::shared_ptr<CLayerGroup>> &vpGroups)
+{
+	std::vector<std::unique_ptr<CStoredLayerTiles>> vpStoredTiles;
+	for(const auto &pGroup : vpGroups)
+	{
+		for(const auto &pLayer : pGroup->m_vpLayers)
+		{
+			if(pLayer->m_Type != LAYERTYPE_TILES)
+				continue;
+			std::shared_ptr<CLayerTiles> pLayerTiles = std::static_pointer_cast<CLayerTiles>(pLayer);
+			vpStoredTiles.push_back(std::make_unique<CStoredLayerTiles>(pEditor, pLayerTiles.get()));
+			CStoredLayerTiles::FreeTiles(pLayerTiles);
+		}
+	}
+	return vpStoredTiles;
+}
+
+// the groups are not in the map while they are restored, so it doesn't
+// matter if only some of them are restored before one fails
+static bool RestoreGroupTiles(const std::vector<std::shared_ptr<CLayerGroup>> &vpGroups, const std::vector<std::unique_ptr<CStoredLayerTiles>> &vpStoredTiles)
+{
+	size_t i = 0;
+	for(const auto &pGroup : vpGroups)
+	{
+		for(const auto &pLayer : pGroup->m_vpLayers)
+		{
+			if(pLayer->m_Type != LAYERTYPE_TILES)
+				continue;
+			if(i >= vpStoredTiles.size() || !vpStoredTiles[i++]->Restore(std::static_pointer_cast<CLayerTiles>(pLayer)))
+				return false;
+		}
+	}
+	return true;
+}
+
+// -------------------------------------------
+
 CEditorBrushDrawAction::CEditorBrushDrawAction(CEditor *pEditor, int Group) :
 	IEditorAction(pEditor), m_Group(Group)
 {
+	m_TeleTileChanges = -1;
+	m_SpeedupTileChanges = -1;
+	m_SwitchTileChanges = -1;
+	m_TuneTileChanges = -1;
+	m_TotalTilesDrawn = 0;
+	m_TotalLayers = 0;
+
 	auto &Map = pEditor->m_Map;
 	for(size_t k = 0; k < Map.m_vpGroups[Group]->m_vpLayers.size(); k++)
 	{
@@ -17,7 +139,7 @@ CEditorBrushDrawAction::CEditorBrushDrawAction(CEditor *pEditor, int Group) :
 			{
 				if(!Map.m_pTeleLayer->m_History.empty())
 				{
-					m_TeleTileChanges = std::map(Map.m_pTeleLayer->m_History);
+					m_TeleTileChanges = StoreChanges(Map.m_pTeleLayer->m_History);
 					Map.m_pTeleLayer->ClearHistory();
 				}
 			}
@@ -25,7 +147,7 @@ CEditorBrushDrawAction::CEditorBrushDrawAction(CEditor *pEditor, int Group) :
 			{
 				if(!Map.m_pTuneLayer->m_History.empty())
 				{
-					m_TuneTileChanges = std::map(Map.m_pTuneLayer->m_History);
+					m_TuneTileChanges = StoreChanges(Map.m_pTuneLayer->m_History);
 					Map.m_pTuneLayer->ClearHistory();
 				}
 			}
@@ -33,7 +155,7 @@ CEditorBrushDrawAction::CEditorBrushDrawAction(CEditor *pEditor, int Group) :
 			{
 				if(!Map.m_pSwitchLayer->m_History.empty())
 				{
-					m_SwitchTileChanges = std::map(Map.m_pSwitchLayer->m_History);
+					m_SwitchTileChanges = StoreChanges(Map.m_pSwitchLayer->m_History);
 					Map.m_pSwitchLayer->ClearHistory();
 				}
 			}
@@ -41,79 +163,44 @@ CEditorBrushDrawAction::CEditorBrushDrawAction(CEditor *pEditor, int Group) :
 			{
 				if(!Map.m_pSpeedupLayer->m_History.empty())
 				{
-					m_SpeedupTileChanges = std::map(Map.m_pSpeedupLayer->m_History);
+					m_SpeedupTileChanges = StoreChanges(Map.m_pSpeedupLayer->m_History);
 					Map.m_pSpeedupLayer->ClearHistory();
 				}
 			}
 
 			if(!pLayerTiles->m_TilesHistory.empty())
 			{
-				m_vTileChanges.emplace_back(k, std::map(pLayerTiles->m_TilesHistory));
+				m_vTileChanges.emplace_back(k, StoreChanges(pLayerTiles->m_TilesHistory));
 				pLayerTiles->ClearHistory();
 			}
 		}
 	}
 
-	SetInfos();
 	str_format(m_aDisplayText, sizeof(m_aDisplayText), "Brush draw (x%d) on %d layers", m_TotalTilesDrawn, m_TotalLayers);
 }
 
-void CEditorBrushDrawAction::SetInfos()
+CEditorBrushDrawAction::~CEditorBrushDrawAction()
 {
-	m_TotalTilesDrawn = 0;
-	m_TotalLayers = 0;
-
-	// Process normal tiles
+	CHistoryStore &Store = m_pEditor->m_HistoryStore;
 	for(auto const &Pair : m_vTileChanges)
-	{
-		int Layer = Pair.first;
-		std::shared_ptr<CLayer> pLayer = m_pEditor->m_Map.m_vpGroups[m_Group]->m_vpLayers[Layer];
-		m_TotalLayers++;
-
-		if(pLayer->m_Type == LAYERTYPE_TILES)
-		{
-			std::shared_ptr<CLayerTiles> pLayerTiles = std::static_pointer_cast<CLayerTiles>(pLayer);
-			auto Changes = Pair.second;
-			for(auto &Change : Changes)
-			{
-				m_TotalTilesDrawn += Change.second.size();
-			}
-		}
-	}
-
-	// Process speedup tiles
-	for(auto const &SpeedupChange : m_SpeedupTileChanges)
-	{
-		m_TotalTilesDrawn += SpeedupChange.second.size();
-	}
-
-	// Process tele tiles
-	for(auto const &TeleChange : m_TeleTileChanges)
-	{
-		m_TotalTilesDrawn += TeleChange.second.size();
-	}
-
-	// Process switch tiles
-	for(auto const &SwitchChange : m_SwitchTileChanges)
-	{
-		m_TotalTilesDrawn += SwitchChange.second.size();
-	}
-
-	// Process tune tiles
-	for(auto const &TuneChange : m_TuneTileChanges)
-	{
-		m_TotalTilesDrawn += TuneChange.second.size();
-	}
+		Store.Remove(Pair.second);
+	Store.Remove(m_TeleTileChanges);
+	Store.Remove(m_SpeedupTileChanges);
+	Store.Remove(m_SwitchTileChanges);
+	Store.Remove(m_TuneTileChanges);
+}
 
-	m_TotalLayers += !m_SpeedupTileChanges.empty();
-	m_TotalLayers += !m_SwitchTileChanges.empty();
-	m_TotalLayers += !m_TeleTileChanges.empty();
-	m_TotalLayers += !m_TuneTileChanges.empty();
+template<typename T>
+int CEditorBrushDrawAction::StoreChanges(const EditorTileStateChangeHistory<T> &Changes)
+{
+	m_TotalTilesDrawn += NumTileChanges(Changes);
+	m_TotalLayers++;
+	return m_pEditor->m_HistoryStore.Add(PackTileChanges(Changes));
 }
 
 bool CEditorBrushDrawAction::IsEmpty()
 {
-	return m_vTileChanges.empty() && m_SpeedupTileChanges.empty() && m_SwitchTileChanges.empty() && m_TeleTileChanges.empty() && m_TuneTileChanges.empty();
+	return m_vTileChanges.empty() && m_SpeedupTileChanges < 0 && m_SwitchTileChanges < 0 && m_TeleTileChanges < 0 && m_TuneTileChanges < 0;
 }
 
 void CEditorBrushDrawAction::Undo()
@@ -129,106 +216,85 @@ void CEditorBrushDrawAction::Redo()
 void CEditorBrushDrawAction::Apply(bool Undo)
 {
 	auto &Map = m_pEditor->m_Map;
+	CHistoryStore &Store = m_pEditor->m_HistoryStore;
+
+	// read all changes first, so that nothing changes if one can't be read
+	auto &&Read = [&](int Id, std::vector<unsigned char> &vData) {
+		return Id < 0 || Store.Get(Id, vData);
+	};
+	std::vector<std::vector<unsigned char>> vvTileData(m_vTileChanges.size());
+	std::vector<unsigned char> vSpeedupData, vTeleData, vSwitchData, vTuneData;
+	bool Success = true;
+	for(size_t i = 0; i < m_vTileChanges.size(); i++)
+		Success = Success && Read(m_vTileChanges[i].second, vvTileData[i]);
+	Success = Success && Read(m_SpeedupTileChanges, vSpeedupData) && Read(m_TeleTileChanges, vTeleData) &&
+		  Read(m_SwitchTileChanges, vSwitchData) && Read(m_TuneTileChanges, vTuneData);
+	m_Failed = !Success;
+	if(m_Failed)
+		return;
 
 	// Process normal tiles
-	for(auto const &Pair : m_vTileChanges)
+	for(size_t i = 0; i < m_vTileChanges.size(); i++)
 	{
-		int Layer = Pair.first;
+		int Layer = m_vTileChanges[i].first;
 		std::shared_ptr<CLayer> pLayer = Map.m_vpGroups[m_Group]->m_vpLayers[Layer];
 
 		if(pLayer->m_Type == LAYERTYPE_TILES)
 		{
 			std::shared_ptr<CLayerTiles> pLayerTiles = std::static_pointer_cast<CLayerTiles>(pLayer);
-			auto Changes = Pair.second;
-			for(auto &Change : Changes)
-			{
-				int y = Change.first;
-				auto Line = Change.second;
-				for(auto &Tile : Line)
-				{
-					int x = Tile.first;
-					STileStateChange State = Tile.second;
-					pLayerTiles->SetTileIgnoreHistory(x, y, Undo ? State.m_Previous : State.m_Current);
-				}
-			}
+			ForEachTileChange<STileStateChange>(vvTileData[i], [&](int x, int y, const STileStateChange &State) {
+				pLayerTiles->SetTileIgnoreHistory(x, y, Undo ? State.m_Previous : State.m_Current);
+			});
 		}
 	}
 
 	// Process speedup tiles
-	for(auto const &SpeedupChange : m_SpeedupTileChanges)
-	{
-		int y = SpeedupChange.first;
-		auto Line = SpeedupChange.second;
-		for(auto &Tile : Line)
-		{
-			int x = Tile.first;
-			int Index = y * Map.m_pSpeedupLayer->m_Width + x;
-			SSpeedupTileStateChange State = Tile.second;
-			SSpeedupTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
-
-			Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Force = Data.m_Force;
-			Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_MaxSpeed = Data.m_MaxSpeed;
-			Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Angle = Data.m_Angle;
-			Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Type = Data.m_Type;
-			Map.m_pSpeedupLayer->m_pTiles[Index].m_Index = Data.m_Index;
-		}
-	}
+	ForEachTileChange<SSpeedupTileStateChange>(vSpeedupData, [&](int x, int y, const SSpeedupTileStateChange &State) {
+		int Index = y * Map.m_pSpeedupLayer->m_Width + x;
+		SSpeedupTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
+
+		Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Force = Data.m_Force;
+		Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_MaxSpeed = Data.m_MaxSpeed;
+		Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Angle = Data.m_Angle;
+		Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Type = Data.m_Type;
+		Map.m_pSpeedupLayer->m_pTiles[Index].m_Index = Data.m_Index;
+		Map.m_pSpeedupLayer->m_TileChunks.Invalidate(x, y, 1, 1);
+	});
 
 	// Process tele tiles
-	for(auto const &TeleChange : m_TeleTileChanges)
-	{
-		int y = TeleChange.first;
-		auto Line = TeleChange.second;
-		for(auto &Tile : Line)
-		{
-			int x = Tile.first;
-			int Index = y * Map.m_pTeleLayer->m_Width + x;
-			STeleTileStateChange State = Tile.second;
-			STeleTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
-
-			Map.m_pTeleLayer->m_pTeleTile[Index].m_Number = Data.m_Number;
-			Map.m_pTeleLayer->m_pTeleTile[Index].m_Type = Data.m_Type;
-			Map.m_pTeleLayer->m_pTiles[Index].m_Index = Data.m_Index;
-		}
-	}
+	ForEachTileChange<STeleTileStateChange>(vTeleData, [&](int x, int y, const STeleTileStateChange &State) {
+		int Index = y * Map.m_pTeleLayer->m_Width + x;
+		STeleTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
+
+		Map.m_pTeleLayer->m_pTeleTile[Index].m_Number = Data.m_Number;
+		Map.m_pTeleLayer->m_pTeleTile[Index].m_Type = Data.m_Type;
+		Map.m_pTeleLayer->m_pTiles[Index].m_Index = Data.m_Index;
+		Map.m_pTeleLayer->m_TileChunks.Invalidate(x, y, 1, 1);
+	});
 
 	// Process switch tiles
-	for(auto const &SwitchChange : m_SwitchTileChanges)
-	{
-		int y = SwitchChange.first;
-		auto Line = SwitchChange.second;
-		for(auto &Tile : Line)
-		{
-			int x = Tile.first;
-			int Index = y * Map.m_pSwitchLayer->m_Width + x;
-			SSwitchTileStateChange State = Tile.second;
-			SSwitchTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
-
-			Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Number = Data.m_Number;
-			Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Type = Data.m_Type;
-			Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Flags = Data.m_Flags;
-			Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Delay = Data.m_Delay;
-			Map.m_pSwitchLayer->m_pTiles[Index].m_Index = Data.m_Index;
-		}
-	}
+	ForEachTileChange<SSwitchTileStateChange>(vSwitchData, [&](int x, int y, const SSwitchTileStateChange &State) {
+		int Index = y * Map.m_pSwitchLayer->m_Width + x;
+		SSwitchTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
+
+		Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Number = Data.m_Number;
+		Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Type = Data.m_Type;
+		Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Flags = Data.m_Flags;
+		Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Delay = Data.m_Delay;
+		Map.m_pSwitchLayer->m_pTiles[Index].m_Index = Data.m_Index;
+		Map.m_pSwitchLayer->m_TileChunks.Invalidate(x, y, 1, 1);
+	});
 
 	// Process tune tiles
-	for(auto const &TuneChange : m_TuneTileChanges)
-	{
-		int y = TuneChange.first;
-		auto Line = TuneChange.second;
-		for(auto &Tile : Line)
-		{
-			int x = Tile.first;
-			int Index = y * Map.m_pTuneLayer->m_Width + x;
-			STuneTileStateChange State = Tile.second;
-			STuneTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
-
-			Map.m_pTuneLayer->m_pTuneTile[Index].m_Number = Data.m_Number;
-			Map.m_pTuneLayer->m_pTuneTile[Index].m_Type = Data.m_Type;
-			Map.m_pTuneLayer->m_pTiles[Index].m_Index = Data.m_Index;
-		}
-	}
+	ForEachTileChange<STuneTileStateChange>(vTuneData, [&](int x, int y, const STuneTileStateChange &State) {
+		int Index = y * Map.m_pTuneLayer->m_Width + x;
+		STuneTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
+
+		Map.m_pTuneLayer->m_pTuneTile[Index].m_Number = Data.m_Number;
+		Map.m_pTuneLayer->m_pTuneTile[Index].m_Type = Data.m_Type;
+		Map.m_pTuneLayer->m_pTiles[Index].m_Index = Data.m_Index;
+		Map.m_pTuneLayer->m_TileChunks.Invalidate(x, y, 1, 1);
+	});
 }
 
 // -------------------------------------------
@@ -449,40 +515,55 @@ CEditorActionBulk::CEditorActionBulk(CEditor *pEditor, const std::vector<std::sh
 
 void CEditorActionBulk::Undo()
 {
-	if(m_Reverse)
+	const int NumActions = m_vpActions.size();
+	for(int i = 0; i < NumActions; i++)
 	{
-		for(auto pIt = m_vpActions.rbegin(); pIt != m_vpActions.rend(); pIt++)
+		auto &pAction = m_vpActions[m_Reverse ? NumActions - 1 - i : i];
+		pAction->Undo();
+		if(pAction->Failed())
 		{
-			auto &pAction = *pIt;
-			pAction->Undo();
-		}
-	}
-	else
-	{
-		for(auto &pAction : m_vpActions)
-		{
-			pAction->Undo();
+			// redo the actions that were undone, so that the bulk is undone completely or not at all
+			for(int j = i - 1; j >= 0; j--)
+				m_vpActions[m_Reverse ? NumActions - 1 - j : j]->Redo();
+			m_Failed = true;
+			return;
 		}
 	}
+	m_Failed = false;
 }
 
 void CEditorActionBulk::Redo()
 {
-	for(auto &pAction : m_vpActions)
+	const int NumActions = m_vpActions.size();
+	for(int i = 0; i < NumActions; i++)
 	{
-		pAction->Redo();
+		m_vpActions[i]->Redo();
+		if(m_vpActions[i]->Failed())
+		{
+			for(int j = i - 1; j >= 0; j--)
+				m_vpActions[j]->Undo();
+			m_Failed = true;
+			return;
+		}
 	}
+	m_Failed = false;
 }
 
 // ---------
 
 CEditorActionTileChanges::CEditorActionTileChanges(CEditor *pEditor, int GroupIndex, int LayerIndex, const char *pAction, const EditorTileStateChangeHistory<STileStateChange> &Changes) :
-	CEditorActionLayerBase(pEditor, GroupIndex, LayerIndex), m_Changes(Changes)
+	CEditorActionLayerBase(pEditor, GroupIndex, LayerIndex)
 {
-	ComputeInfos();
+	m_Changes = pEditor->m_HistoryStore.Add(PackTileChanges(Changes));
+	m_TotalChanges = NumTileChanges(Changes);
 	str_format(m_aDisplayText, sizeof(m_aDisplayText), "%s (x%d)", pAction, m_TotalChanges);
 }
 
+CEditorActionTileChanges::~CEditorActionTileChanges()
+{
+	m_pEditor->m_HistoryStore.Remove(m_Changes);
+}
+
 void CEditorActionTileChanges::Undo()
 {
 	Apply(true);
@@ -497,28 +578,17 @@ void CEditorActionTileChanges::Apply(bool Undo)
 {
 	auto &Map = m_pEditor->m_Map;
 	std::shared_ptr<CLayerTiles> pLayerTiles = std::static_pointer_cast<CLayerTiles>(m_pLayer);
-	for(auto &Change : m_Changes)
-	{
-		int y = Change.first;
-		auto Line = Change.second;
-		for(auto &Tile : Line)
-		{
-			int x = Tile.first;
-			STileStateChange State = Tile.second;
-			pLayerTiles->SetTileIgnoreHistory(x, y, Undo ? State.m_Previous : State.m_Current);
-		}
-	}
+	std::vector<unsigned char> vData;
+	m_Failed = !m_pEditor->m_HistoryStore.Get(m_Changes, vData);
+	if(m_Failed)
+		return;
+	ForEachTileChange<STileStateChange>(vData, [&](int x, int y, const STileStateChange &State) {
+		pLayerTiles->SetTileIgnoreHistory(x, y, Undo ? State.m_Previous : State.m_Current);
+	});
 
 	Map.OnModify();
 }
 
-void CEditorActionTileChanges::ComputeInfos()
-{
-	m_TotalChanges = 0;
-	for(auto &Line : m_Changes)
-		m_TotalChanges += Line.second.size();
-}
-
 // ---------
 
 CEditorActionLayerBase::CEditorActionLayerBase(CEditor *pEditor, int GroupIndex, int LayerIndex) :
@@ -619,6 +689,14 @@ void CEditorActionDeleteLayer::Redo()
 
 	m_pEditor->m_Map.m_vpGroups[m_GroupIndex]->DeleteLayer(m_LayerIndex);
 
+	// the tiles are kept in the history store until the layer is added back
+	if(m_pLayer->m_Type == LAYERTYPE_TILES)
+	{
+		std::shared_ptr<CLayerTiles> pLayerTiles = std::static_pointer_cast<CLayerTiles>(m_pLayer);
+		m_pStoredTiles = std::make_unique<CStoredLayerTiles>(m_pEditor, pLayerTiles.get());
+		CStoredLayerTiles::FreeTiles(pLayerTiles);
+	}
+
 	m_pEditor->m_Map.m_vpGroups[m_GroupIndex]->m_Collapse = false;
 	if(m_LayerIndex >= (int)vLayers.size())
 		m_pEditor->SelectLayer(vLayers.size() - 1, m_GroupIndex);
@@ -634,6 +712,11 @@ void CEditorActionDeleteLayer::Undo()
 	if(m_pLayer->m_Type == LAYERTYPE_TILES)
 	{
 		std::shared_ptr<CLayerTiles> pLayerTiles = std::static_pointer_cast<CLayerTiles>(m_pLayer);
+		m_Failed = m_pStoredTiles && !m_pStoredTiles->Restore(pLayerTiles);
+		if(m_Failed)
+			return;
+		m_pStoredTiles = nullptr;
+
 		if(pLayerTiles->m_Front)
 			m_pEditor->m_Map.m_pFrontLayer = std::static_pointer_cast<CLayerFront>(m_pLayer);
 		else if(pLayerTiles->m_Tele)
@@ -861,7 +944,7 @@ CEditorActionEditLayerTilesProp::CEditorActionEditLayerTilesProp(CEditor *pEdito
 	str_format(m_aDisplayText, sizeof(m_aDisplayText), "Edit tiles layer %d in group %d %s property", m_LayerIndex, m_GroupIndex, s_apNames[(int)Prop]);
 }
 
-void CEditorActionEditLayerTilesProp::SetSavedLayers(const std::map<int, std::shared_ptr<CLayer>> &SavedLayers)
+void CEditorActionEditLayerTilesProp::SetSavedLayers(const std::map<int, std::shared_ptr<CStoredLayerTiles>> &SavedLayers)
 {
 	m_SavedLayers = std::map(SavedLayers);
 }
@@ -869,7 +952,13 @@ void CEditorActionEditLayerTilesProp::SetSavedLayers(const std::map<int, std::sh
 void CEditorActionEditLayerTilesProp::Undo()
 {
 	std::shared_ptr<CLayerTiles> pLayerTiles = std::static_pointer_cast<CLayerTiles>(m_pLayer);
-	std::shared_ptr<CLayerTiles> pSavedLayerTiles = nullptr;
+
+	// the saved tiles are read before anything changes, so that nothing
+	// changes if they can't be read
+	std::map<int, std::vector<unsigned char>> SavedTiles;
+	m_Failed = !ReadSavedLayers(SavedTiles);
+	if(m_Failed)
+		return;
 
 	if(m_Prop == ETilesProp::PROP_WIDTH || m_Prop == ETilesProp::PROP_HEIGHT)
 	{
@@ -878,26 +967,26 @@ void CEditorActionEditLayerTilesProp::Undo()
 		else if(m_Prop == ETilesProp::PROP_WIDTH)
 			pLayerTiles->Resize(m_Previous, pLayerTiles->m_Height);
 
-		RestoreLayer(LAYERTYPE_TILES, pLayerTiles);
+		RestoreLayer(LAYERTYPE_TILES, pLayerTiles, SavedTiles);
 		if(pLayerTiles->m_Game || pLayerTiles->m_Front || pLayerTiles->m_Switch || pLayerTiles->m_Speedup || pLayerTiles->m_Tune)
 		{
 			if(m_pEditor->m_Map.m_pFrontLayer && !pLayerTiles->m_Front)
-				RestoreLayer(LAYERTYPE_FRONT, m_pEditor->m_Map.m_pFrontLayer);
+				RestoreLayer(LAYERTYPE_FRONT, m_pEditor->m_Map.m_pFrontLayer, SavedTiles);
 			if(m_pEditor->m_Map.m_pTeleLayer && !pLayerTiles->m_Tele)
-				RestoreLayer(LAYERTYPE_TELE, m_pEditor->m_Map.m_pTeleLayer);
+				RestoreLayer(LAYERTYPE_TELE, m_pEditor->m_Map.m_pTeleLayer, SavedTiles);
 			if(m_pEditor->m_Map.m_pSwitchLayer && !pLayerTiles->m_Switch)
-				RestoreLayer(LAYERTYPE_SWITCH, m_pEditor->m_Map.m_pSwitchLayer);
+				RestoreLayer(LAYERTYPE_SWITCH, m_pEditor->m_Map.m_pSwitchLayer, SavedTiles);
 			if(m_pEditor->m_Map.m_pSpeedupLayer && !pLayerTiles->m_Speedup)
-				RestoreLayer(LAYERTYPE_SPEEDUP, m_pEditor->m_Map.m_pSpeedupLayer);
+				RestoreLayer(LAYERTYPE_SPEEDUP, m_pEditor->m_Map.m_pSpeedupLayer, SavedTiles);
 			if(m_pEditor->m_Map.m_pTuneLayer && !pLayerTiles->m_Tune)
-				RestoreLayer(LAYERTYPE_TUNE, m_pEditor->m_Map.m_pTuneLayer);
+				RestoreLayer(LAYERTYPE_TUNE, m_pEditor->m_Map.m_pTuneLayer, SavedTiles);
 			if(!pLayerTiles->m_Game)
-				RestoreLayer(LAYERTYPE_GAME, m_pEditor->m_Map.m_pGameLayer);
+				RestoreLayer(LAYERTYPE_GAME, m_pEditor->m_Map.m_pGameLayer, SavedTiles);
 		}
 	}
 	else if(m_Prop == ETilesProp::PROP_SHIFT)
 	{
-		RestoreLayer(LAYERTYPE_TILES, pLayerTiles);
+		RestoreLayer(LAYERTYPE_TILES, pLayerTiles, SavedTiles);
 	}
 	else if(m_Prop == ETilesProp::PROP_SHIFT_BY)
 	{
@@ -1028,38 +1117,21 @@ void CEditorActionEditLayerTilesProp::Redo()
 	m_pEditor->m_Map.OnModify();
 }
 
-void CEditorActionEditLayerTilesProp::RestoreLayer(int Layer, const std::shared_ptr<CLayerTiles> &pLayerTiles)
+bool CEditorActionEditLayerTilesProp::ReadSavedLayers(std::map<int, std::vector<unsigned char>> &SavedTiles)
 {
-	if(m_SavedLayers[Layer] != nullptr)
+	for(const auto &[Layer, pSavedLayer] : m_SavedLayers)
 	{
-		std::shared_ptr<CLayerTiles> pSavedLayerTiles = std::static_pointer_cast<CLayerTiles>(m_SavedLayers[Layer]);
-		mem_copy(pLayerTiles->m_pTiles, pSavedLayerTiles->m_pTiles, (size_t)pLayerTiles->m_Width * pLayerTiles->m_Height * sizeof(CTile));
-
-		if(pLayerTiles->m_Tele)
-		{
-			std::shared_ptr<CLayerTele> pLayerTele = std::static_pointer_cast<CLayerTele>(pLayerTiles);
-			std::shared_ptr<CLayerTele> pSavedLayerTele = std::static_pointer_cast<CLayerTele>(pSavedLayerTiles);
-			mem_copy(pLayerTele->m_pTeleTile, pSavedLayerTele->m_pTeleTile, (size_t)pLayerTiles->m_Width * pLayerTiles->m_Height * sizeof(CTeleTile));
-		}
-		else if(pLayerTiles->m_Speedup)
-		{
-			std::shared_ptr<CLayerSpeedup> pLayerSpeedup = std::static_pointer_cast<CLayerSpeedup>(pLayerTiles);
-			std::shared_ptr<CLayerSpeedup> pSavedLayerSpeedup = std::static_pointer_cast<CLayerSpeedup>(pSavedLayerTiles);
-			mem_copy(pLayerSpeedup->m_pSpeedupTile, pSavedLayerSpeedup->m_pSpeedupTile, (size_t)pLayerTiles->m_Width * pLayerTiles->m_Height * sizeof(CSpeedupTile));
-		}
-		else if(pLayerTiles->m_Switch)
-		{
-			std::shared_ptr<CLayerSwitch> pLayerSwitch = std::static_pointer_cast<CLayerSwitch>(pLayerTiles);
-			std::shared_ptr<CLayerSwitch> pSavedLayerSwitch = std::static_pointer_cast<CLayerSwitch>(pSavedLayerTiles);
-			mem_copy(pLayerSwitch->m_pSwitchTile, pSavedLayerSwitch->m_pSwitchTile, (size_t)pLayerTiles->m_Width * pLayerTiles->m_Height * sizeof(CSwitchTile));
-		}
-		else if(pLayerTiles->m_Tune)
-		{
-			std::shared_ptr<CLayerTune> pLayerTune = std::static_pointer_cast<CLayerTune>(pLayerTiles);
-			std::shared_ptr<CLayerTune> pSavedLayerTune = std::static_pointer_cast<CLayerTune>(pSavedLayerTiles);
-			mem_copy(pLayerTune->m_pTuneTile, pSavedLayerTune->m_pTuneTile, (size_t)pLayerTiles->m_Width * pLayerTiles->m_Height * sizeof(CTuneTile));
-		}
+		if(pSavedLayer && !pSavedLayer->Read(SavedTiles[Layer]))
+			return false;
 	}
+	return true;
+}
+
+void CEditorActionEditLayerTilesProp::RestoreLayer(int Layer, const std::shared_ptr<CLayerTiles> &pLayerTiles, const std::map<int, std::vector<unsigned char>> &SavedTiles)
+{
+	auto SavedLayerIt = m_SavedLayers.find(Layer);
+	if(SavedLayerIt != m_SavedLayers.end() && SavedLayerIt->second != nullptr)
+		SavedLayerIt->second->Restore(pLayerTiles, SavedTiles.at(Layer));
 }
 
 CEditorActionEditLayerQuadsProp::CEditorActionEditLayerQuadsProp(CEditor *pEditor, int GroupIndex, int LayerIndex, ELayerQuadsProp Prop, int Previous, int Current) :
@@ -1151,6 +1223,26 @@ void CEditorActionEditLayersGroupAndOrder::Redo()
 
 // -----------------------------------
 
+// moves the image at index k to vIndexMap[k] and updates the image indices of the layers
+static void MoveImages(CEditorMap &Map, const std::vector<int> &vIndexMap)
+{
+	std::vector<std::shared_ptr<CEditorImage>> vpMovedImages;
+	vpMovedImages.resize(Map.m_vpImages.size());
+
+	for(int k = 0; k < (int)vIndexMap.size(); k++)
+	{
+		vpMovedImages[vIndexMap[k]] = Map.m_vpImages[k];
+	}
+	Map.m_vpImages = vpMovedImages;
+
+	Map.ModifyImageIndex([vIndexMap](int *pIndex) {
+		if(*pIndex >= 0)
+		{
+			*pIndex = vIndexMap[*pIndex];
+		}
+	});
+}
+
 CEditorActionAppendMap::CEditorActionAppendMap(CEditor *pEditor, const char *pMapName, const SPrevInfo &PrevInfo, std::vector<int> &vImageIndexMap) :
 	IEditorAction(pEditor), m_PrevInfo(PrevInfo), m_vImageIndexMap(vImageIndexMap)
 {
@@ -1162,31 +1254,14 @@ void CEditorActionAppendMap::Undo()
 {
 	auto &Map = m_pEditor->m_Map;
 	// Undo append:
-	// - delete added groups
-	// - delete added envelopes
-	// - delete added images
-	// - delete added sounds
-
-	// Delete added groups
-	while((int)Map.m_vpGroups.size() != m_PrevInfo.m_Groups)
-	{
-		Map.m_vpGroups.pop_back();
-	}
-
-	// Delete added envelopes
-	while((int)Map.m_vpEnvelopes.size() != m_PrevInfo.m_Envelopes)
-	{
-		Map.m_vpEnvelopes.pop_back();
-	}
-
-	// Delete added sounds
-	while((int)Map.m_vpSounds.size() != m_PrevInfo.m_Sounds)
-	{
-		Map.m_vpSounds.pop_back();
-	}
-
-	// Delete added images
-	// Images are sorted when appending, so we need to revert sorting before deleting the images
+	// - revert the sorting of the images
+	// - remove added groups, their tiles are kept in the history store
+	// - remove added envelopes
+	// - remove added images
+	// - remove added sounds
+
+	// Images are sorted when appending, so we need to revert sorting before removing the images.
+	// The appended groups are still in the map, so they get the indices that Redo sorts again.
 	if(!m_vImageIndexMap.empty())
 	{
 		std::vector<int> vReverseIndexMap;
@@ -1195,33 +1270,51 @@ void CEditorActionAppendMap::Undo()
 		for(int k = 0; k < (int)m_vImageIndexMap.size(); k++)
 			vReverseIndexMap[m_vImageIndexMap[k]] = k;
 
-		std::vector<std::shared_ptr<CEditorImage>> vpRevertedImages;
-		vpRevertedImages.resize(Map.m_vpImages.size());
+		MoveImages(Map, vReverseIndexMap);
+	}
 
-		for(int k = 0; k < (int)vReverseIndexMap.size(); k++)
-		{
-			vpRevertedImages[vReverseIndexMap[k]] = Map.m_vpImages[k];
-		}
-		Map.m_vpImages = vpRevertedImages;
+	// Remove added groups
+	m_vpGroups.assign(Map.m_vpGroups.begin() + m_PrevInfo.m_Groups, Map.m_vpGroups.end());
+	Map.m_vpGroups.resize(m_PrevInfo.m_Groups);
+	m_vpStoredTiles = StoreGroupTiles(m_pEditor, m_vpGroups);
 
-		Map.ModifyImageIndex([vReverseIndexMap](int *pIndex) {
-			if(*pIndex >= 0)
-			{
-				*pIndex = vReverseIndexMap[*pIndex];
-			}
-		});
-	}
+	// Remove added envelopes
+	m_vpEnvelopes.assign(Map.m_vpEnvelopes.begin() + m_PrevInfo.m_Envelopes, Map.m_vpEnvelopes.end());
+	Map.m_vpEnvelopes.resize(m_PrevInfo.m_Envelopes);
 
-	while((int)Map.m_vpImages.size() != m_PrevInfo.m_Images)
-	{
-		Map.m_vpImages.pop_back();
-	}
+	// Remove added sounds
+	m_vpSounds.assign(Map.m_vpSounds.begin() + m_PrevInfo.m_Sounds, Map.m_vpSounds.end());
+	Map.m_vpSounds.resize(m_PrevInfo.m_Sounds);
+
+	// Remove added images
+	m_vpImages.assign(Map.m_vpImages.begin() + m_PrevInfo.m_Images, Map.m_vpImages.end());
+	Map.m_vpImages.resize(m_PrevInfo.m_Images);
+
+	Map.OnModify();
 }
 
 void CEditorActionAppendMap::Redo()
 {
-	// Redo is just re-appending the same map
-	m_pEditor->Append(m_aMapName, IStorage::TYPE_ALL, true);
+	// Redo adds back what was removed instead of reading the map file again
+	auto &Map = m_pEditor->m_Map;
+	m_Failed = !RestoreGroupTiles(m_vpGroups, m_vpStoredTiles);
+	if(m_Failed)
+		return;
+
+	Map.m_vpImages.insert(Map.m_vpImages.end(), m_vpImages.begin(), m_vpImages.end());
+	Map.m_vpSounds.insert(Map.m_vpSounds.end(), m_vpSounds.begin(), m_vpSounds.end());
+	Map.m_vpEnvelopes.insert(Map.m_vpEnvelopes.end(), m_vpEnvelopes.begin(), m_vpEnvelopes.end());
+	Map.m_vpGroups.insert(Map.m_vpGroups.end(), m_vpGroups.begin(), m_vpGroups.end());
+	m_vpImages.clear();
+	m_vpSounds.clear();
+	m_vpEnvelopes.clear();
+	m_vpGroups.clear();
+	m_vpStoredTiles.clear();
+
+	// sort the images like appending did
+	if(!m_vImageIndexMap.empty())
+		MoveImages(Map, m_vImageIndexMap);
+	Map.OnModify();
 }
 
 // ---------------------------
@@ -1237,11 +1330,8 @@ void CEditorActionTileArt::Undo()
 {
 	auto &Map = m_pEditor->m_Map;
 
-	// Delete added group
-	Map.m_vpGroups.pop_back();
-
-	// Delete added images
-	// Images are sorted when appending, so we need to revert sorting before deleting the images
+	// Images are sorted when adding the tile art, so we need to revert sorting before removing the images.
+	// The added group is still in the map, so it gets the indices that Redo sorts again.
 	if(!m_vImageIndexMap.empty())
 	{
 		std::vector<int> vReverseIndexMap;
@@ -1250,39 +1340,39 @@ void CEditorActionTileArt::Undo()
 		for(int k = 0; k < (int)m_vImageIndexMap.size(); k++)
 			vReverseIndexMap[m_vImageIndexMap[k]] = k;
 
-		std::vector<std::shared_ptr<CEditorImage>> vpRevertedImages;
-		vpRevertedImages.resize(Map.m_vpImages.size());
+		MoveImages(Map, vReverseIndexMap);
+	}
 
-		for(int k = 0; k < (int)vReverseIndexMap.size(); k++)
-		{
-			vpRevertedImages[vReverseIndexMap[k]] = Map.m_vpImages[k];
-		}
-		Map.m_vpImages = vpRevertedImages;
+	// Remove added group, its tiles are kept in the history store
+	m_pGroup = Map.m_vpGroups.back();
+	Map.m_vpGroups.pop_back();
+	m_vpStoredTiles = StoreGroupTiles(m_pEditor, {m_pGroup});
 
-		Map.ModifyImageIndex([vReverseIndexMap](int *pIndex) {
-			if(*pIndex >= 0)
-			{
-				*pIndex = vReverseIndexMap[*pIndex];
-			}
-		});
-	}
+	// Remove added images
+	m_vpImages.assign(Map.m_vpImages.begin() + m_PreviousImageCount, Map.m_vpImages.end());
+	Map.m_vpImages.resize(m_PreviousImageCount);
 
-	while((int)Map.m_vpImages.size() != m_PreviousImageCount)
-	{
-		Map.m_vpImages.pop_back();
-	}
+	Map.OnModify();
 }
 
 void CEditorActionTileArt::Redo()
 {
-	if(!m_pEditor->Graphics()->LoadPng(m_pEditor->m_TileartImageInfo, m_aTileArtFile, IStorage::TYPE_ALL))
-	{
-		m_pEditor->ShowFileDialogError("Failed to load image from file '%s'.", m_aTileArtFile);
+	// Redo adds back what was removed instead of creating the tile art again
+	auto &Map = m_pEditor->m_Map;
+	m_Failed = !RestoreGroupTiles({m_pGroup}, m_vpStoredTiles);
+	if(m_Failed)
 		return;
-	}
 
-	IStorage::StripPathAndExtension(m_aTileArtFile, m_pEditor->m_aTileartFilename, sizeof(m_pEditor->m_aTileartFilename));
-	m_pEditor->AddTileart(true);
+	Map.m_vpImages.insert(Map.m_vpImages.end(), m_vpImages.begin(), m_vpImages.end());
+	Map.m_vpGroups.push_back(m_pGroup);
+	m_vpImages.clear();
+	m_pGroup = nullptr;
+	m_vpStoredTiles.clear();
+
+	// sort the images like adding the tile art did
+	if(!m_vImageIndexMap.empty())
+		MoveImages(Map, m_vImageIndexMap);
+	Map.OnModify();
 }
 
 // ---------------------------------
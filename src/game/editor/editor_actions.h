@@ -4,6 +4,33 @@
 #include "editor.h"
 #include "editor_action.h"
 
+// The tiles of a tiles layer, including its special tiles, kept in the
+// history store of the editor instead of in a copy of the layer.
+class CStoredLayerTiles
+{
+public:
+	CStoredLayerTiles(CEditor *pEditor, CLayerTiles *pLayer);
+	~CStoredLayerTiles();
+
+	CStoredLayerTiles(const CStoredLayerTiles &Other) = delete;
+	CStoredLayerTiles &operator=(const CStoredLayerTiles &Other) = delete;
+
+	bool Read(std::vector<unsigned char> &vData) const;
+	// copies the read tiles into the layer, which must have the size that it
+	// had when it was stored, and allocates them if they were freed
+	bool Restore(const std::shared_ptr<CLayerTiles> &pLayer, const std::vector<unsigned char> &vData) const;
+	bool Restore(const std::shared_ptr<CLayerTiles> &pLayer) const;
+
+	// frees the tiles of a layer that is not in the map until they are restored
+	static void FreeTiles(const std::shared_ptr<CLayerTiles> &pLayer);
+
+private:
+	CEditor *m_pEditor;
+	int m_Width;
+	int m_Height;
+	int m_Id;
+};
+
 class CEditorActionLayerBase : public IEditorAction
 {
 public:
@@ -22,6 +49,7 @@ class CEditorBrushDrawAction : public IEditorAction
 {
 public:
 	CEditorBrushDrawAction(CEditor *pEditor, int Group);
+	~CEditorBrushDrawAction() override;
 
 	void Undo() override;
 	void Redo() override;
@@ -30,19 +58,21 @@ public:
 private:
 	int m_Group;
 	// m_vTileChanges is a list of changes for each layer that was modified.
-	// The std::pair is used to pair one layer (index) with its history (2D map).
-	// EditorTileStateChangeHistory<T> is a 2D map, storing a change item at a specific y,x position.
-	std::vector<std::pair<int, EditorTileStateChangeHistory<STileStateChange>>> m_vTileChanges;
-	EditorTileStateChangeHistory<STeleTileStateChange> m_TeleTileChanges;
-	EditorTileStateChangeHistory<SSpeedupTileStateChange> m_SpeedupTileChanges;
-	EditorTileStateChangeHistory<SSwitchTileStateChange> m_SwitchTileChanges;
-	EditorTileStateChangeHistory<STuneTileStateChange> m_TuneTileChanges;
+	// The std::pair is used to pair one layer (index) with its history.
+	// The changes are packed with PackTileChanges and kept in the history
+	// store of the editor, the ids are -1 if the layer was not changed.
+	std::vector<std::pair<int, int>> m_vTileChanges;
+	int m_TeleTileChanges;
+	int m_SpeedupTileChanges;
+	int m_SwitchTileChanges;
+	int m_TuneTileChanges;
 
 	int m_TotalTilesDrawn;
 	int m_TotalLayers;
 
 	void Apply(bool Undo);
-	void SetInfos();
+	template<typename T>
+	int StoreChanges(const EditorTileStateChangeHistory<T> &Changes);
 };
 
 // ---------------------------------------------------------
@@ -159,15 +189,16 @@ class CEditorActionTileChanges : public CEditorActionLayerBase
 {
 public:
 	CEditorActionTileChanges(CEditor *pEditor, int GroupIndex, int LayerIndex, const char *pAction, const EditorTileStateChangeHistory<STileStateChange> &Changes);
+	~CEditorActionTileChanges() override;
 
 	void Undo() override;
 	void Redo() override;
 
 private:
-	EditorTileStateChangeHistory<STileStateChange> m_Changes;
+	// id of the packed changes in the history store of the editor
+	int m_Changes;
 	int m_TotalChanges;
 
-	void ComputeInfos();
 	void Apply(bool Undo);
 };
 
@@ -192,6 +223,10 @@ public:
 
 	void Undo() override;
 	void Redo() override;
+
+private:
+	// the tiles of a deleted tiles layer
+	std::unique_ptr<CStoredLayerTiles> m_pStoredTiles;
 };
 
 class CEditorActionGroup : public IEditorAction
@@ -260,12 +295,13 @@ public:
 	void Undo() override;
 	void Redo() override;
 
-	void SetSavedLayers(const std::map<int, std::shared_ptr<CLayer>> &SavedLayers);
+	void SetSavedLayers(const std::map<int, std::shared_ptr<CStoredLayerTiles>> &SavedLayers);
 
 private:
-	std::map<int, std::shared_ptr<CLayer>> m_SavedLayers;
+	std::map<int, std::shared_ptr<CStoredLayerTiles>> m_SavedLayers;
 
-	void RestoreLayer(int Layer, const std::shared_ptr<CLayerTiles> &pLayerTiles);
+	bool ReadSavedLayers(std::map<int, std::vector<unsigned char>> &SavedTiles);
+	void RestoreLayer(int Layer, const std::shared_ptr<CLayerTiles> &pLayerTiles, const std::map<int, std::vector<unsigned char>> &SavedTiles);
 };
 
 class CEditorActionEditLayerQuadsProp : public CEditorActionEditLayerPropBase<ELayerQuadsProp>
@@ -318,6 +354,14 @@ private:
 	char m_aMapName[IO_MAX_PATH_LENGTH];
 	SPrevInfo m_PrevInfo;
 	std::vector<int> m_vImageIndexMap;
+
+	// what was appended while it is undone, with the tiles of the groups
+	// in the history store
+	std::vector<std::shared_ptr<CLayerGroup>> m_vpGroups;
+	std::vector<std::shared_ptr<CEditorImage>> m_vpImages;
+	std::vector<std::shared_ptr<CEditorSound>> m_vpSounds;
+	std::vector<std::shared_ptr<CEnvelope>> m_vpEnvelopes;
+	std::vector<std::unique_ptr<CStoredLayerTiles>> m_vpStoredTiles;
 };
 
 // --------------
@@ -334,6 +378,12 @@ private:
 	int m_PreviousImageCount;
 	char m_aTileArtFile[IO_MAX_PATH_LENGTH];
 	std::vector<int> m_vImageIndexMap;
+
+	// the added group and images while it is undone, with the tiles of the
+	// group in the history store
+	std::shared_ptr<CLayerGroup> m_pGroup;
+	std::vector<std::shared_ptr<CEditorImage>> m_vpImages;
+	std::vector<std::unique_ptr<CStoredLayerTiles>> m_vpStoredTiles;
 };
 
 // ----------------------
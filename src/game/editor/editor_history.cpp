@@ -45,6 +45,13 @@ bool CEditorHistory::Undo()
 	m_vpUndoActions.pop_back();
 
 	pLastAction->Undo();
+	if(pLastAction->Failed())
+	{
+		// the step stays the next one to undo
+		m_vpUndoActions.emplace_back(pLastAction);
+		m_pEditor->ShowFileDialogError("Failed to read the history of '%s', it was not undone.", pLastAction->DisplayText());
+		return false;
+	}
 
 	m_vpRedoActions.emplace_back(pLastAction);
 	return true;
@@ -59,6 +66,13 @@ bool CEditorHistory::Redo()
 	m_vpRedoActions.pop_back();
 
 	pLastAction->Redo();
+	if(pLastAction->Failed())
+	{
+		// the step stays the next one to redo
+		m_vpRedoActions.emplace_back(pLastAction);
+		m_pEditor->ShowFileDialogError("Failed to read the history of '%s', it was not redone.", pLastAction->DisplayText());
+		return false;
+	}
 
 	m_vpUndoActions.emplace_back(pLastAction);
 	return true;
@@ -453,26 +453,26 @@ void CLayerTilesPropTracker::OnStart(ETilesProp Prop)
 {
 	if(Prop == ETilesProp::PROP_WIDTH || Prop == ETilesProp::PROP_HEIGHT)
 	{
-		m_SavedLayers[LAYERTYPE_TILES] = m_pObject->Duplicate();
+		m_SavedLayers[LAYERTYPE_TILES] = std::make_shared<CStoredLayerTiles>(m_pEditor, m_pObject);
 		if(m_pObject->m_Game || m_pObject->m_Front || m_pObject->m_Switch || m_pObject->m_Speedup || m_pObject->m_Tune || m_pObject->m_Tele)
 		{ // Need to save all entities layers when any entity layer
 			if(m_pEditor->m_Map.m_pFrontLayer && !m_pObject->m_Front)
-				m_SavedLayers[LAYERTYPE_FRONT] = m_pEditor->m_Map.m_pFrontLayer->Duplicate();
+				m_SavedLayers[LAYERTYPE_FRONT] = std::make_shared<CStoredLayerTiles>(m_pEditor, m_pEditor->m_Map.m_pFrontLayer.get());
 			if(m_pEditor->m_Map.m_pTeleLayer && !m_pObject->m_Tele)
-				m_SavedLayers[LAYERTYPE_TELE] = m_pEditor->m_Map.m_pTeleLayer->Duplicate();
+				m_SavedLayers[LAYERTYPE_TELE] = std::make_shared<CStoredLayerTiles>(m_pEditor, m_pEditor->m_Map.m_pTeleLayer.get());
 			if(m_pEditor->m_Map.m_pSwitchLayer && !m_pObject->m_Switch)
-				m_SavedLayers[LAYERTYPE_SWITCH] = m_pEditor->m_Map.m_pSwitchLayer->Duplicate();
+				m_SavedLayers[LAYERTYPE_SWITCH] = std::make_shared<CStoredLayerTiles>(m_pEditor, m_pEditor->m_Map.m_pSwitchLayer.get());
 			if(m_pEditor->m_Map.m_pSpeedupLayer && !m_pObject->m_Speedup)
-				m_SavedLayers[LAYERTYPE_SPEEDUP] = m_pEditor->m_Map.m_pSpeedupLayer->Duplicate();
+				m_SavedLayers[LAYERTYPE_SPEEDUP] = std::make_shared<CStoredLayerTiles>(m_pEditor, m_pEditor->m_Map.m_pSpeedupLayer.get());
 			if(m_pEditor->m_Map.m_pTuneLayer && !m_pObject->m_Tune)
-				m_SavedLayers[LAYERTYPE_TUNE] = m_pEditor->m_Map.m_pTuneLayer->Duplicate();
+				m_SavedLayers[LAYERTYPE_TUNE] = std::make_shared<CStoredLayerTiles>(m_pEditor, m_pEditor->m_Map.m_pTuneLayer.get());
 			if(!m_pObject->m_Game)
-				m_SavedLayers[LAYERTYPE_GAME] = m_pEditor->m_Map.m_pGameLayer->Duplicate();
+				m_SavedLayers[LAYERTYPE_GAME] = std::make_shared<CStoredLayerTiles>(m_pEditor, m_pEditor->m_Map.m_pGameLayer.get());
 		}
 	}
 	else if(Prop == ETilesProp::PROP_SHIFT)
 	{
-		m_SavedLayers[LAYERTYPE_TILES] = m_pObject->Duplicate();
+		m_SavedLayers[LAYERTYPE_TILES] = std::make_shared<CStoredLayerTiles>(m_pEditor, m_pObject);
 	}
 }
 
@@ -511,7 +511,7 @@ void CLayerTilesCommonPropTracker::OnStart(ETilesCommonProp Prop)
 	{
 		if(Prop == ETilesCommonProp::PROP_SHIFT)
 		{
-			m_SavedLayers[pLayer][LAYERTYPE_TILES] = pLayer->Duplicate();
+			m_SavedLayers[pLayer][LAYERTYPE_TILES] = std::make_shared<CStoredLayerTiles>(m_pEditor, pLayer.get());
 		}
 	}
 }
@@ -13,6 +13,7 @@ class CEditor;
 class CLayerTiles;
 class CLayerGroup;
 class CLayerSounds;
+class CStoredLayerTiles;
 struct CSoundSource;
 
 class CQuadEditTracker
@@ -222,7 +223,7 @@ protected:
 	int PropToValue(ETilesProp Prop) override;
 
 private:
-	std::map<int, std::shared_ptr<CLayer>> m_SavedLayers;
+	std::map<int, std::shared_ptr<CStoredLayerTiles>> m_SavedLayers;
 };
 
 class CLayerTilesCommonPropTracker : public CPropTracker<CLayerTiles, ETilesCommonProp>
@@ -239,7 +240,7 @@ protected:
 	int PropToValue(ETilesCommonProp Prop) override;
 
 private:
-	std::map<std::shared_ptr<CLayerTiles>, std::map<int, std::shared_ptr<CLayer>>> m_SavedLayers;
+	std::map<std::shared_ptr<CLayerTiles>, std::map<int, std::shared_ptr<CStoredLayerTiles>>> m_SavedLayers;
 
 public:
 	std::vector<std::shared_ptr<CLayerTiles>> m_vpLayers;
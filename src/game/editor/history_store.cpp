@@ -0,0 +1,230 @@
+#include "history_store.h"
+
+#include <zlib.h>
+
+CHistoryStore::~CHistoryStore()
+{
+	CloseSpillFile();
+}
+
+void CHistoryStore::Init(const char *pSpillPath, size_t MemoryLimit)
+{
+	str_copy(m_aSpillPath, pSpillPath);
+	m_MemoryLimit = MemoryLimit;
+}
+
+void CHistoryStore::SetMemoryLimit(size_t MemoryLimit)
+{
+	if(MemoryLimit == m_MemoryLimit)
+		return;
+	m_MemoryLimit = MemoryLimit;
+	Spill();
+}
+
+int CHistoryStore::Add(const void *pData, size_t Size)
+{
+	dbg_assert(Size <= 0xffffffffu, "history entry too big");
+	CEntry Entry;
+	Entry.m_Size = Size;
+	// the fastest level already shrinks tile changes a lot, the history
+	// is written while the user is drawing
+	uLongf CompressedSize = compressBound(Size);
+	Entry.m_vCompressed.resize(CompressedSize);
+	const int Result = compress2(Entry.m_vCompressed.data(), &CompressedSize, (const Bytef *)pData, Size, Z_BEST_SPEED);
+	if(Result != Z_OK)
+	{
+		char aError[32];
+		str_format(aError, sizeof(aError), "zlib compression error %d", Result);
+		dbg_assert(false, aError);
+	}
+	Entry.m_vCompressed.resize(CompressedSize);
+	Entry.m_vCompressed.shrink_to_fit();
+	Entry.m_CompressedSize = CompressedSize;
+
+	const int Id = m_NextId++;
+	m_MemoryUsage += Entry.m_CompressedSize;
+	m_Entries.emplace(Id, std::move(Entry));
+	Spill();
+	return Id;
+}
+
+bool CHistoryStore::Get(int Id, std::vector<unsigned char> &vData)
+{
+	auto It = m_Entries.find(Id);
+	if(It == m_Entries.end())
+		return false;
+	const CEntry &Entry = It->second;
+
+	std::vector<unsigned char> vSpilled;
+	const unsigned char *pCompressed = Entry.m_vCompressed.data();
+	if(Entry.m_SpillOffset >= 0)
+	{
+		// the entry might still be buffered by the writer
+		if(m_SpillWriteFile)
+			io_flush(m_SpillWriteFile);
+		if(!m_SpillReadFile)
+			m_SpillReadFile = io_open(m_aSpillPath, IOFLAG_READ);
+		vSpilled.resize(Entry.m_CompressedSize);
+		if(!m_SpillReadFile ||
+			io_seek(m_SpillReadFile, Entry.m_SpillOffset, IOSEEK_START) != 0 ||
+			io_read(m_SpillReadFile, vSpilled.data(), vSpilled.size()) != vSpilled.size())
+		{
+			dbg_msg("editor", "failed to read history entry from '%s'", m_aSpillPath);
+			return false;
+		}
+		pCompressed = vSpilled.data();
+	}
+
+	vData.resize(Entry.m_Size);
+	uLongf Size = Entry.m_Size;
+	if(uncompress(vData.data(), &Size, pCompressed, Entry.m_CompressedSize) != Z_OK || Size != Entry.m_Size)
+	{
+		dbg_msg("editor", "failed to decompress history entry");
+		return false;
+	}
+	return true;
+}
+
+void CHistoryStore::Remove(int Id)
+{
+	auto It = m_Entries.find(Id);
+	if(It == m_Entries.end())
+		return;
+	if(It->second.m_SpillOffset >= 0)
+	{
+		m_SpilledSize -= It->second.m_CompressedSize;
+		m_NumSpilled--;
+	}
+	else
+	{
+		m_MemoryUsage -= It->second.m_CompressedSize;
+	}
+	m_Entries.erase(It);
+
+	if(m_NumSpilled == 0)
+		CloseSpillFile();
+	else
+	{
+		const int64_t RemovedSize = m_SpillFileSize - (int64_t)m_SpilledSize;
+		if(RemovedSize > COMPACT_MIN_REMOVED_SIZE && RemovedSize > (int64_t)m_SpilledSize)
+			CompactSpillFile();
+	}
+}
+
+void CHistoryStore::Spill()
+{
+	while(m_MemoryUsage > m_MemoryLimit)
+	{
+		auto It = m_Entries.lower_bound(m_FirstInMemory);
+		if(It == m_Entries.end())
+			return;
+		CEntry &Entry = It->second;
+
+		if(m_SpillFailed || m_aSpillPath[0] == '\0')
+			return;
+		if(!m_SpillWriteFile)
+		{
+			m_SpillWriteFile = io_open(m_aSpillPath, IOFLAG_WRITE);
+			m_SpillFileSize = 0;
+			if(!m_SpillWriteFile)
+			{
+				dbg_msg("editor", "failed to open '%s', keeping the history in memory", m_aSpillPath);
+				m_SpillFailed = true;
+				return;
+			}
+		}
+		if(io_write(m_SpillWriteFile, Entry.m_vCompressed.data(), Entry.m_CompressedSize) != Entry.m_CompressedSize)
+		{
+			// the entries that were already spilled can still be read
+			dbg_msg("editor", "failed to write to '%s', keeping the history in memory", m_aSpillPath);
+			m_SpillFailed = true;
+			return;
+		}
+
+		Entry.m_SpillOffset = m_SpillFileSize;
+		m_SpillFileSize += Entry.m_CompressedSize;
+		std::vector<unsigned char>().swap(Entry.m_vCompressed);
+		m_MemoryUsage -= Entry.m_CompressedSize;
+		m_SpilledSize += Entry.m_CompressedSize;
+		m_NumSpilled++;
+		m_FirstInMemory = It->first + 1;
+	}
+}
+
+void CHistoryStore::CompactSpillFile()
+{
+	// the stored entries are copied to a new file that then replaces the
+	// old one, which is kept if anything fails
+	char aCompactPath[IO_MAX_PATH_LENGTH];
+	str_format(aCompactPath, sizeof(aCompactPath), "%s.compact", m_aSpillPath);
+	if(m_SpillWriteFile)
+		io_flush(m_SpillWriteFile);
+	if(!m_SpillReadFile)
+		m_SpillReadFile = io_open(m_aSpillPath, IOFLAG_READ);
+	IOHANDLE CompactFile = io_open(aCompactPath, IOFLAG_WRITE);
+	bool Failed = !m_SpillReadFile || !CompactFile;
+
+	std::vector<std::pair<CEntry *, int64_t>> vNewOffsets;
+	std::vector<unsigned char> vCompressed;
+	int64_t CompactSize = 0;
+	for(auto It = m_Entries.begin(); !Failed && It != m_Entries.end(); ++It)
+	{
+		CEntry &Entry = It->second;
+		if(Entry.m_SpillOffset < 0)
+			continue;
+		vCompressed.resize(Entry.m_CompressedSize);
+		Failed = io_seek(m_SpillReadFile, Entry.m_SpillOffset, IOSEEK_START) != 0 ||
+			 io_read(m_SpillReadFile, vCompressed.data(), vCompressed.size()) != vCompressed.size() ||
+			 io_write(CompactFile, vCompressed.data(), vCompressed.size()) != vCompressed.size();
+		vNewOffsets.emplace_back(&Entry, CompactSize);
+		CompactSize += Entry.m_CompressedSize;
+	}
+	if(CompactFile)
+		Failed = io_close(CompactFile) != 0 || Failed;
+	if(!Failed)
+	{
+		io_close(m_SpillReadFile);
+		m_SpillReadFile = nullptr;
+		if(m_SpillWriteFile)
+			io_close(m_SpillWriteFile);
+		m_SpillWriteFile = nullptr;
+		Failed = fs_rename(aCompactPath, m_aSpillPath) != 0;
+		// the file is written where the stored entries end, whether it is
+		// the compacted one or still the old one
+		m_SpillWriteFile = io_open(m_aSpillPath, IOFLAG_APPEND);
+		if(!m_SpillWriteFile)
+		{
+			dbg_msg("editor", "failed to reopen '%s', keeping the history in memory", m_aSpillPath);
+			m_SpillFailed = true;
+		}
+	}
+	if(Failed)
+	{
+		dbg_msg("editor", "failed to compact '%s'", m_aSpillPath);
+		fs_remove(aCompactPath);
+		return;
+	}
+
+	for(const auto &[pEntry, Offset] : vNewOffsets)
+		pEntry->m_SpillOffset = Offset;
+	m_SpillFileSize = CompactSize;
+}
+
+void CHistoryStore::CloseSpillFile()
+{
+	if(m_SpillReadFile)
+	{
+		io_close(m_SpillReadFile);
+		m_SpillReadFile = nullptr;
+	}
+	// the write file might be gone after a failed compaction
+	const bool Exists = m_SpillWriteFile || m_SpillFileSize > 0;
+	if(m_SpillWriteFile)
+	{
+		io_close(m_SpillWriteFile);
+		m_SpillWriteFile = nullptr;
+	}
+	if(Exists)
+		fs_remove(m_aSpillPath);
+	m_SpillFileSize = 0;
+}
@@ -0,0 +1,149 @@
+#ifndef GAME_EDITOR_HISTORY_STORE_H
+#define GAME_EDITOR_HISTORY_STORE_H
+
+#include <base/system.h>
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// Compressed storage for the data of undo history entries. When the
+// compressed entries use more memory than the limit, the oldest ones are
+// moved to a temporary file and read back from there when they are needed.
+class CHistoryStore
+{
+public:
+	CHistoryStore() = default;
+	~CHistoryStore();
+
+	CHistoryStore(const CHistoryStore &Other) = delete;
+	CHistoryStore &operator=(const CHistoryStore &Other) = delete;
+
+	// the spill file is only created once it is needed and deleted
+	// again when no entry is stored in it anymore, it is compacted when
+	// most of it belongs to removed entries
+	void Init(const char *pSpillPath, size_t MemoryLimit);
+	void SetMemoryLimit(size_t MemoryLimit);
+
+	// returns the id of the entry, ids are increasing so that older
+	// entries are spilled first
+	int Add(const void *pData, size_t Size);
+	int Add(const std::vector<unsigned char> &vData) { return Add(vData.data(), vData.size()); }
+	bool Get(int Id, std::vector<unsigned char> &vData);
+	void Remove(int Id);
+
+	size_t NumEntries() const { return m_Entries.size(); }
+	size_t MemoryUsage() const { return m_MemoryUsage; }
+	size_t SpilledSize() const { return m_SpilledSize; }
+	int64_t SpillFileSize() const { return m_SpillFileSize; }
+
+private:
+	enum
+	{
+		// the spill file is compacted once it has more than this many bytes
+		// of removed entries, and more of them than of stored ones
+		COMPACT_MIN_REMOVED_SIZE = 1024 * 1024,
+	};
+
+	struct CEntry
+	{
+		unsigned m_Size;
+		unsigned m_CompressedSize;
+		std::vector<unsigned char> m_vCompressed;
+		// position in the spill file, -1 while the entry is in memory
+		int64_t m_SpillOffset = -1;
+	};
+
+	void Spill();
+	void CompactSpillFile();
+	void CloseSpillFile();
+
+	std::map<int, CEntry> m_Entries;
+	int m_NextId = 0;
+	// the entries before it are spilled or removed
+	int m_FirstInMemory = 0;
+
+	char m_aSpillPath[IO_MAX_PATH_LENGTH] = "";
+	IOHANDLE m_SpillWriteFile = nullptr;
+	IOHANDLE m_SpillReadFile = nullptr;
+	int64_t m_SpillFileSize = 0;
+	int m_NumSpilled = 0;
+	bool m_SpillFailed = false;
+
+	size_t m_MemoryLimit = 0;
+	size_t m_MemoryUsage = 0;
+	size_t m_SpilledSize = 0;
+};
+
+template<typename T>
+int NumTileChanges(const std::map<int, std::map<int, T>> &Changes)
+{
+	int Num = 0;
+	for(const auto &[y, Line] : Changes)
+		Num += Line.size();
+	return Num;
+}
+
+// Packs the tile changes of an undo step, `T` is one of the tile state
+// changes of the editor layers. The coordinates are stored as differences
+// to the previous ones in front of the changes, which compresses well for
+// the lines and rectangles that are usually changed.
+template<typename T>
+std::vector<unsigned char> PackTileChanges(const std::map<int, std::map<int, T>> &Changes)
+{
+	const int Num = NumTileChanges(Changes);
+	std::vector<unsigned char> vData(sizeof(int) + Num * (2 * sizeof(int) + sizeof(T)));
+	unsigned char *pNum = vData.data();
+	unsigned char *pDeltaY = pNum + sizeof(int);
+	unsigned char *pDeltaX = pDeltaY + Num * sizeof(int);
+	unsigned char *pChanges = pDeltaX + Num * sizeof(int);
+	mem_copy(pNum, &Num, sizeof(int));
+	int PrevY = 0;
+	int PrevX = 0;
+	int i = 0;
+	for(const auto &[y, Line] : Changes)
+	{
+		for(const auto &[x, Change] : Line)
+		{
+			const int DeltaY = y - PrevY;
+			const int DeltaX = DeltaY == 0 ? x - PrevX : x;
+			mem_copy(pDeltaY + i * sizeof(int), &DeltaY, sizeof(int));
+			mem_copy(pDeltaX + i * sizeof(int), &DeltaX, sizeof(int));
+			mem_copy(pChanges + i * sizeof(T), &Change, sizeof(T));
+			PrevY = y;
+			PrevX = x;
+			i++;
+		}
+	}
+	return vData;
+}
+
+// calls `Func(x, y, Change)` for every change packed by PackTileChanges
+template<typename T, typename F>
+void ForEachTileChange(const std::vector<unsigned char> &vData, F &&Func)
+{
+	int Num = 0;
+	if(vData.size() < sizeof(int))
+		return;
+	mem_copy(&Num, vData.data(), sizeof(int));
+	if(Num < 0 || vData.size() != sizeof(int) + Num * (2 * sizeof(int) + sizeof(T)))
+		return;
+	const unsigned char *pDeltaY = vData.data() + sizeof(int);
+	const unsigned char *pDeltaX = pDeltaY + Num * sizeof(int);
+	const unsigned char *pChanges = pDeltaX + Num * sizeof(int);
+	int y = 0;
+	int x = 0;
+	for(int i = 0; i < Num; i++)
+	{
+		int DeltaY, DeltaX;
+		T Change;
+		mem_copy(&DeltaY, pDeltaY + i * sizeof(int), sizeof(int));
+		mem_copy(&DeltaX, pDeltaX + i * sizeof(int), sizeof(int));
+		mem_copy(&Change, pChanges + i * sizeof(T), sizeof(T));
+		y += DeltaY;
+		x = DeltaY == 0 ? x + DeltaX : DeltaX;
+		Func(x, y, Change);
+	}
+}
+
+#endif
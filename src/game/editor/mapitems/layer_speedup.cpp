@@ -163,6 +163,7 @@ void CLayerSpeedup::BrushDraw(std::shared_ptr<CLayer> pBrush, vec2 WorldPos)
 
 void CLayerSpeedup::RecordStateChange(int x, int y, SSpeedupTileStateChange::SData Previous, SSpeedupTileStateChange::SData Current)
 {
+	m_TileChunks.Invalidate(x, y, 1, 1);
 	if(!m_History[y][x].m_Changed)
 		m_History[y][x] = SSpeedupTileStateChange{true, Previous, Current};
 	else
@@ -165,6 +165,7 @@ void CLayerSwitch::BrushDraw(std::shared_ptr<CLayer> pBrush, vec2 WorldPos)
 
 void CLayerSwitch::RecordStateChange(int x, int y, SSwitchTileStateChange::SData Previous, SSwitchTileStateChange::SData Current)
 {
+	m_TileChunks.Invalidate(x, y, 1, 1);
 	if(!m_History[y][x].m_Changed)
 		m_History[y][x] = SSwitchTileStateChange{true, Previous, Current};
 	else
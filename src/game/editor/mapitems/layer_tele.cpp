@@ -160,6 +160,7 @@ void CLayerTele::BrushDraw(std::shared_ptr<CLayer> pBrush, vec2 WorldPos)
 
 void CLayerTele::RecordStateChange(int x, int y, STeleTileStateChange::SData Previous, STeleTileStateChange::SData Current)
 {
+	m_TileChunks.Invalidate(x, y, 1, 1);
 	if(!m_History[y][x].m_Changed)
 		m_History[y][x] = STeleTileStateChange{true, Previous, Current};
 	else
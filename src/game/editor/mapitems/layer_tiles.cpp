@@ -85,13 +85,15 @@ void CLayerTiles::SetTile(int x, int y, CTile Tile)
 	RecordStateChange(x, y, CurrentTile, Tile);
 }
 
-void CLayerTiles::SetTileIgnoreHistory(int x, int y, CTile Tile) const
+void CLayerTiles::SetTileIgnoreHistory(int x, int y, CTile Tile)
 {
 	m_pTiles[y * m_Width + x] = Tile;
+	m_TileChunks.Invalidate(x, y, 1, 1);
 }
 
 void CLayerTiles::RecordStateChange(int x, int y, CTile Previous, CTile Tile)
 {
+	m_TileChunks.Invalidate(x, y, 1, 1);
 	if(!m_TilesHistory[y][x].m_Changed)
 		m_TilesHistory[y][x] = STileStateChange{true, Previous, Tile};
 	else
@@ -151,10 +153,21 @@ void CLayerTiles::Render(bool Tileset)
 	CEditor::EnvelopeEval(m_ColorEnvOffset, m_ColorEnv, ColorEnv, 4, m_pEditor);
 	const ColorRGBA Color = ColorRGBA(m_Color.r / 255.0f, m_Color.g / 255.0f, m_Color.b / 255.0f, m_Color.a / 255.0f).Multiply(ColorEnv);
 
-	Graphics()->BlendNone();
-	m_pEditor->RenderTools()->RenderTilemap(m_pTiles, m_Width, m_Height, 32.0f, Color, LAYERRENDERFLAG_OPAQUE);
-	Graphics()->BlendNormal();
-	m_pEditor->RenderTools()->RenderTilemap(m_pTiles, m_Width, m_Height, 32.0f, Color, LAYERRENDERFLAG_TRANSPARENT);
+	if(Graphics()->IsTileBufferingEnabled())
+	{
+		// One pass with blending for the opaque and the transparent tiles. The
+		// tiles of a layer do not overlap and opaque tiles have full alpha, so
+		// this gives the same pixels as the separate BlendNone pass below.
+		Graphics()->BlendNormal();
+		m_TileChunks.Render(Graphics(), m_pTiles, m_Width, m_Height, Texture.IsValid(), Color);
+	}
+	else
+	{
+		Graphics()->BlendNone();
+		m_pEditor->RenderTools()->RenderTilemap(m_pTiles, m_Width, m_Height, 32.0f, Color, LAYERRENDERFLAG_OPAQUE);
+		Graphics()->BlendNormal();
+		m_pEditor->RenderTools()->RenderTilemap(m_pTiles, m_Width, m_Height, 32.0f, Color, LAYERRENDERFLAG_TRANSPARENT);
+	}
 
 	// Render DDRace Layers
 	if(!Tileset)
@@ -544,6 +557,7 @@ void CLayerTiles::BrushDraw(std::shared_ptr<CLayer> pBrush, vec2 WorldPos)
 void CLayerTiles::BrushFlipX()
 {
 	BrushFlipXImpl(m_pTiles);
+	m_TileChunks.InvalidateAll();
 
 	if(m_Tele || m_Speedup || m_Tune)
 		return;
@@ -560,6 +574,7 @@ void CLayerTiles::BrushFlipX()
 void CLayerTiles::BrushFlipY()
 {
 	BrushFlipYImpl(m_pTiles);
+	m_TileChunks.InvalidateAll();
 
 	if(m_Tele || m_Speedup || m_Tune)
 		return;
@@ -602,6 +617,7 @@ void CLayerTiles::BrushRotate(float Amount)
 
 		std::swap(m_Width, m_Height);
 		delete[] pTempData;
+		m_TileChunks.InvalidateAll();
 	}
 
 	if(Rotation == 2 || Rotation == 3)
@@ -635,6 +651,7 @@ void CLayerTiles::Resize(int NewW, int NewH)
 	m_pTiles = pNewData;
 	m_Width = NewW;
 	m_Height = NewH;
+	m_TileChunks.InvalidateAll();
 
 	// resize tele layer if available
 	if(m_Game && m_pEditor->m_Map.m_pTeleLayer && (m_pEditor->m_Map.m_pTeleLayer->m_Width != NewW || m_pEditor->m_Map.m_pTeleLayer->m_Height != NewH))
@@ -660,6 +677,7 @@ void CLayerTiles::Resize(int NewW, int NewH)
 void CLayerTiles::Shift(int Direction)
 {
 	ShiftImpl(m_pTiles, Direction, m_pEditor->m_ShiftBy);
+	m_TileChunks.InvalidateAll();
 }
 
 void CLayerTiles::ShowInfo()
@@ -758,8 +776,8 @@ void CLayerTiles::FillGameTiles(EGameTileOp Fill)
 		{
 			if(pGLayer->m_Width < m_Width + OffsetX || pGLayer->m_Height < m_Height + OffsetY)
 			{
-				std::map<int, std::shared_ptr<CLayer>> savedLayers;
-				savedLayers[LAYERTYPE_TILES] = pGLayer->Duplicate();
+				std::map<int, std::shared_ptr<CStoredLayerTiles>> savedLayers;
+				savedLayers[LAYERTYPE_TILES] = std::make_shared<CStoredLayerTiles>(m_pEditor, pGLayer.get());
 				savedLayers[LAYERTYPE_GAME] = savedLayers[LAYERTYPE_TILES];
 
 				int PrevW = pGLayer->m_Width;
@@ -807,8 +825,8 @@ void CLayerTiles::FillGameTiles(EGameTileOp Fill)
 
 				if(m_Width != pGLayer->m_Width || m_Height > pGLayer->m_Height)
 				{
-					std::map<int, std::shared_ptr<CLayer>> savedLayers;
-					savedLayers[LAYERTYPE_TILES] = pGLayer->Duplicate();
+					std::map<int, std::shared_ptr<CStoredLayerTiles>> savedLayers;
+					savedLayers[LAYERTYPE_TILES] = std::make_shared<CStoredLayerTiles>(m_pEditor, pGLayer.get());
 					savedLayers[LAYERTYPE_GAME] = savedLayers[LAYERTYPE_TILES];
 
 					int NewW = pGLayer->m_Width;
@@ -840,8 +858,8 @@ void CLayerTiles::FillGameTiles(EGameTileOp Fill)
 
 			if(pTLayer->m_Width < m_Width + OffsetX || pTLayer->m_Height < m_Height + OffsetY)
 			{
-				std::map<int, std::shared_ptr<CLayer>> savedLayers;
-				savedLayers[LAYERTYPE_TILES] = pTLayer->Duplicate();
+				std::map<int, std::shared_ptr<CStoredLayerTiles>> savedLayers;
+				savedLayers[LAYERTYPE_TILES] = std::make_shared<CStoredLayerTiles>(m_pEditor, pTLayer.get());
 				savedLayers[LAYERTYPE_TELE] = savedLayers[LAYERTYPE_TILES];
 
 				int PrevW = pTLayer->m_Width;
@@ -881,7 +899,7 @@ void CLayerTiles::FillGameTiles(EGameTileOp Fill)
 							pTLayer->m_pTeleTile[TileIndex].m_Type,
 							pTLayer->m_pTiles[TileIndex].m_Index};
 
-						pTLayer->RecordStateChange(x, y, Previous, Current);
+						pTLayer->RecordStateChange(x + OffsetX, y + OffsetY, Previous, Current);
 					}
 				}
 			}
@@ -1125,22 +1143,22 @@ CUi::EPopupMenuFunctionResult CLayerTiles::RenderCommonProperties(SCommonPropSta
 				int LayerIndex = vLayerIndices[j++];
 				if(HasModifiedSize)
 				{
-					std::map<int, std::shared_ptr<CLayer>> SavedLayers;
-					SavedLayers[LAYERTYPE_TILES] = pLayer->Duplicate();
+					std::map<int, std::shared_ptr<CStoredLayerTiles>> SavedLayers;
+					SavedLayers[LAYERTYPE_TILES] = std::make_shared<CStoredLayerTiles>(pEditor, pLayer.get());
 					if(pLayer->m_Game || pLayer->m_Front || pLayer->m_Switch || pLayer->m_Speedup || pLayer->m_Tune || pLayer->m_Tele)
 					{ // Need to save all entities layers when any entity layer
 						if(pEditor->m_Map.m_pFrontLayer && !pLayer->m_Front)
-							SavedLayers[LAYERTYPE_FRONT] = pEditor->m_Map.m_pFrontLayer->Duplicate();
+							SavedLayers[LAYERTYPE_FRONT] = std::make_shared<CStoredLayerTiles>(pEditor, pEditor->m_Map.m_pFrontLayer.get());
 						if(pEditor->m_Map.m_pTeleLayer && !pLayer->m_Tele)
-							SavedLayers[LAYERTYPE_TELE] = pEditor->m_Map.m_pTeleLayer->Duplicate();
+							SavedLayers[LAYERTYPE_TELE] = std::make_shared<CStoredLayerTiles>(pEditor, pEditor->m_Map.m_pTeleLayer.get());
 						if(pEditor->m_Map.m_pSwitchLayer && !pLayer->m_Switch)
-							SavedLayers[LAYERTYPE_SWITCH] = pEditor->m_Map.m_pSwitchLayer->Duplicate();
+							SavedLayers[LAYERTYPE_SWITCH] = std::make_shared<CStoredLayerTiles>(pEditor, pEditor->m_Map.m_pSwitchLayer.get());
 						if(pEditor->m_Map.m_pSpeedupLayer && !pLayer->m_Speedup)
-							SavedLayers[LAYERTYPE_SPEEDUP] = pEditor->m_Map.m_pSpeedupLayer->Duplicate();
+							SavedLayers[LAYERTYPE_SPEEDUP] = std::make_shared<CStoredLayerTiles>(pEditor, pEditor->m_Map.m_pSpeedupLayer.get());
 						if(pEditor->m_Map.m_pTuneLayer && !pLayer->m_Tune)
-							SavedLayers[LAYERTYPE_TUNE] = pEditor->m_Map.m_pTuneLayer->Duplicate();
+							SavedLayers[LAYERTYPE_TUNE] = std::make_shared<CStoredLayerTiles>(pEditor, pEditor->m_Map.m_pTuneLayer.get());
 						if(!pLayer->m_Game)
-							SavedLayers[LAYERTYPE_GAME] = pEditor->m_Map.m_pGameLayer->Duplicate();
+							SavedLayers[LAYERTYPE_GAME] = std::make_shared<CStoredLayerTiles>(pEditor, pEditor->m_Map.m_pGameLayer.get());
 					}
 
 					int PrevW = pLayer->m_Width;
@@ -1283,6 +1301,7 @@ CUi::EPopupMenuFunctionResult CLayerTiles::RenderCommonProperties(SCommonPropSta
 
 void CLayerTiles::FlagModified(int x, int y, int w, int h)
 {
+	m_TileChunks.Invalidate(x, y, w, h);
 	m_pEditor->m_Map.OnModify();
 	if(m_Seed != 0 && m_AutoMapperConfig != -1 && m_AutoAutoMap && m_Image >= 0)
 	{
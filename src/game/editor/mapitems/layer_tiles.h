@@ -6,6 +6,7 @@
 #include <map>
 
 #include "layer.h"
+#include "tile_chunks.h"
 
 struct STileStateChange
 {
@@ -103,7 +104,7 @@ public:
 
 	virtual CTile GetTile(int x, int y);
 	virtual void SetTile(int x, int y, CTile Tile);
-	void SetTileIgnoreHistory(int x, int y, CTile Tile) const;
+	void SetTileIgnoreHistory(int x, int y, CTile Tile);
 
 	virtual void Resize(int NewW, int NewH);
 	virtual void Shift(int Direction);
@@ -172,6 +173,8 @@ public:
 	int m_ColorEnv;
 	int m_ColorEnvOffset;
 	CTile *m_pTiles;
+	// must be invalidated when m_pTiles is modified without SetTile, RecordStateChange or FlagModified
+	CTileChunks m_TileChunks;
 
 	// DDRace
 
@@ -144,6 +144,7 @@ void CLayerTune::BrushDraw(std::shared_ptr<CLayer> pBrush, vec2 WorldPos)
 
 void CLayerTune::RecordStateChange(int x, int y, STuneTileStateChange::SData Previous, STuneTileStateChange::SData Current)
 {
+	m_TileChunks.Invalidate(x, y, 1, 1);
 	if(!m_History[y][x].m_Changed)
 		m_History[y][x] = STuneTileStateChange{true, Previous, Current};
 	else
@@ -0,0 +1,169 @@
+#include "tile_chunks.h"
+
+#include <base/math.h>
+
+#include <engine/graphics.h>
+
+#include <game/client/render.h>
+#include <game/mapitems.h>
+
+#include <cmath>
+
+CTileChunks::~CTileChunks()
+{
+	Reset(0, 0, false);
+}
+
+void CTileChunks::Invalidate(int x, int y, int w, int h)
+{
+	if(m_vChunks.empty() || w <= 0 || h <= 0)
+		return;
+
+	const int ChunkX0 = clamp(x / CHUNK_SIZE, 0, m_NumChunksX - 1);
+	const int ChunkY0 = clamp(y / CHUNK_SIZE, 0, m_NumChunksY - 1);
+	const int ChunkX1 = clamp((x + w - 1) / CHUNK_SIZE, 0, m_NumChunksX - 1);
+	const int ChunkY1 = clamp((y + h - 1) / CHUNK_SIZE, 0, m_NumChunksY - 1);
+	for(int ChunkY = ChunkY0; ChunkY <= ChunkY1; ChunkY++)
+		for(int ChunkX = ChunkX0; ChunkX <= ChunkX1; ChunkX++)
+			m_vChunks[ChunkY * m_NumChunksX + ChunkX].m_Dirty = true;
+}
+
+void CTileChunks::InvalidateAll()
+{
+	for(SChunk &Chunk : m_vChunks)
+		Chunk.m_Dirty = true;
+}
+
+void CTileChunks::Reset(int Width, int Height, bool Textured)
+{
+	for(SChunk &Chunk : m_vChunks)
+	{
+		if(Chunk.m_BufferContainerIndex != -1)
+			m_pGraphics->DeleteBufferContainer(Chunk.m_BufferContainerIndex, true);
+	}
+
+	m_Width = Width;
+	m_Height = Height;
+	m_Textured = Textured;
+	m_NumChunksX = (Width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	m_NumChunksY = (Height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	m_vChunks.clear();
+	m_vChunks.resize((size_t)m_NumChunksX * m_NumChunksY);
+}
+
+void CTileChunks::Rebuild(SChunk &Chunk, int ChunkX, int ChunkY, const CTile *pTiles)
+{
+	if(Chunk.m_BufferContainerIndex != -1)
+		m_pGraphics->DeleteBufferContainer(Chunk.m_BufferContainerIndex, true);
+	Chunk.m_BufferContainerIndex = -1;
+	Chunk.m_NumTiles = 0;
+	Chunk.m_Dirty = false;
+
+	std::vector<SGraphicTile> vTiles;
+	std::vector<SGraphicTileTexureCoords> vTileTexCoords;
+	const int EndX = minimum((ChunkX + 1) * CHUNK_SIZE, m_Width);
+	const int EndY = minimum((ChunkY + 1) * CHUNK_SIZE, m_Height);
+	for(int y = ChunkY * CHUNK_SIZE; y < EndY; y++)
+	{
+		for(int x = ChunkX * CHUNK_SIZE; x < EndX; x++)
+		{
+			const CTile &Tile = pTiles[y * m_Width + x];
+			if(!Tile.m_Index)
+				continue;
+			vTiles.emplace_back();
+			if(m_Textured)
+				vTileTexCoords.emplace_back();
+			CRenderTools::FillTileVertices(&vTiles.back(), m_Textured ? &vTileTexCoords.back() : nullptr, Tile.m_Flags, Tile.m_Index, x, y, ivec2(0, 0), 32);
+		}
+	}
+	if(vTiles.empty())
+		return;
+
+	// interleave the positions and texture coordinates of the vertices
+	const size_t PositionSize = sizeof(vec2);
+	const size_t TexCoordSize = m_Textured ? sizeof(ubvec4) : 0;
+	const size_t NumVertices = vTiles.size() * 4;
+	const size_t UploadDataSize = NumVertices * (PositionSize + TexCoordSize);
+	char *pUploadData = (char *)malloc(UploadDataSize);
+	const vec2 *pPositions = (const vec2 *)vTiles.data();
+	const ubvec4 *pTexCoords = (const ubvec4 *)vTileTexCoords.data();
+	for(size_t i = 0; i < NumVertices; i++)
+	{
+		mem_copy(pUploadData + i * (PositionSize + TexCoordSize), &pPositions[i], PositionSize);
+		if(m_Textured)
+			mem_copy(pUploadData + i * (PositionSize + TexCoordSize) + PositionSize, &pTexCoords[i], TexCoordSize);
+	}
+
+	const int BufferObjectIndex = m_pGraphics->CreateBufferObject(UploadDataSize, pUploadData, 0, true);
+
+	SBufferContainerInfo ContainerInfo;
+	ContainerInfo.m_Stride = m_Textured ? PositionSize + TexCoordSize : 0;
+	ContainerInfo.m_VertBufferBindingIndex = BufferObjectIndex;
+	ContainerInfo.m_vAttributes.emplace_back();
+	SBufferContainerInfo::SAttribute *pAttr = &ContainerInfo.m_vAttributes.back();
+	pAttr->m_DataTypeCount = 2;
+	pAttr->m_Type = GRAPHICS_TYPE_FLOAT;
+	pAttr->m_Normalized = false;
+	pAttr->m_pOffset = nullptr;
+	pAttr->m_FuncType = 0;
+	if(m_Textured)
+	{
+		ContainerInfo.m_vAttributes.emplace_back();
+		pAttr = &ContainerInfo.m_vAttributes.back();
+		pAttr->m_DataTypeCount = 4;
+		pAttr->m_Type = GRAPHICS_TYPE_UNSIGNED_BYTE;
+		pAttr->m_Normalized = false;
+		pAttr->m_pOffset = (void *)PositionSize;
+		pAttr->m_FuncType = 1;
+	}
+
+	Chunk.m_BufferContainerIndex = m_pGraphics->CreateBufferContainer(&ContainerInfo);
+	Chunk.m_NumTiles = vTiles.size();
+	m_pGraphics->IndicesNumRequiredNotify(Chunk.m_NumTiles * 6);
+}
+
+void CTileChunks::Render(IGraphics *pGraphics, const CTile *pTiles, int Width, int Height, bool Textured, const ColorRGBA &Color)
+{
+	m_NumChunksRebuilt = 0;
+	m_NumChunksDrawn = 0;
+
+	if(!m_pGraphics)
+		m_pGraphics = pGraphics;
+	if(Width != m_Width || Height != m_Height || Textured != m_Textured)
+		Reset(Width, Height, Textured);
+	if(m_vChunks.empty())
+		return;
+
+	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+	m_pGraphics->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+	const int TileX0 = std::floor(ScreenX0 / 32.0f);
+	const int TileY0 = std::floor(ScreenY0 / 32.0f);
+	const int TileX1 = std::ceil(ScreenX1 / 32.0f) - 1;
+	const int TileY1 = std::ceil(ScreenY1 / 32.0f) - 1;
+	if(TileX1 < 0 || TileY1 < 0 || TileX0 >= m_Width || TileY0 >= m_Height)
+		return;
+
+	const int ChunkX0 = maximum(TileX0, 0) / CHUNK_SIZE;
+	const int ChunkY0 = maximum(TileY0, 0) / CHUNK_SIZE;
+	const int ChunkX1 = minimum(TileX1, m_Width - 1) / CHUNK_SIZE;
+	const int ChunkY1 = minimum(TileY1, m_Height - 1) / CHUNK_SIZE;
+	for(int ChunkY = ChunkY0; ChunkY <= ChunkY1; ChunkY++)
+	{
+		for(int ChunkX = ChunkX0; ChunkX <= ChunkX1; ChunkX++)
+		{
+			SChunk &Chunk = m_vChunks[ChunkY * m_NumChunksX + ChunkX];
+			if(Chunk.m_Dirty)
+			{
+				Rebuild(Chunk, ChunkX, ChunkY, pTiles);
+				m_NumChunksRebuilt++;
+			}
+			if(Chunk.m_BufferContainerIndex == -1)
+				continue;
+
+			char *pOffset = nullptr;
+			unsigned int NumIndices = Chunk.m_NumTiles * 6;
+			m_pGraphics->RenderTileLayer(Chunk.m_BufferContainerIndex, Color, &pOffset, &NumIndices, 1);
+			m_NumChunksDrawn++;
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#ifndef GAME_EDITOR_MAPITEMS_TILE_CHUNKS_H
+#define GAME_EDITOR_MAPITEMS_TILE_CHUNKS_H
+
+#include <base/color.h>
+
+#include <vector>
+
+class IGraphics;
+class CTile;
+
+// Retained buffers for rendering the tiles of an editor tile layer. The layer
+// is split into chunks of CHUNK_SIZE x CHUNK_SIZE tiles which each have their
+// own buffer container, a chunk is only rebuilt after it was invalidated.
+class CTileChunks
+{
+public:
+	enum
+	{
+		CHUNK_SIZE = 64,
+	};
+
+	CTileChunks() = default;
+	CTileChunks(const CTileChunks &Other) = delete;
+	CTileChunks &operator=(const CTileChunks &Other) = delete;
+	~CTileChunks();
+
+	void Invalidate(int x, int y, int w, int h);
+	void InvalidateAll();
+
+	// rebuilds the invalidated chunks that are visible on the screen and draws them,
+	// requires tile buffering to be enabled
+	void Render(IGraphics *pGraphics, const CTile *pTiles, int Width, int Height, bool Textured, const ColorRGBA &Color);
+
+	// statistics of the last call to Render
+	int NumChunksRebuilt() const { return m_NumChunksRebuilt; }
+	int NumChunksDrawn() const { return m_NumChunksDrawn; }
+
+private:
+	struct SChunk
+	{
+		int m_BufferContainerIndex = -1;
+		int m_NumTiles = 0;
+		bool m_Dirty = true;
+	};
+
+	void Reset(int Width, int Height, bool Textured);
+	void Rebuild(SChunk &Chunk, int ChunkX, int ChunkY, const CTile *pTiles);
+
+	IGraphics *m_pGraphics = nullptr;
+	int m_Width = 0;
+	int m_Height = 0;
+	int m_NumChunksX = 0;
+	int m_NumChunksY = 0;
+	bool m_Textured = false;
+	std::vector<SChunk> m_vChunks;
+
+	int m_NumChunksRebuilt = 0;
+	int m_NumChunksDrawn = 0;
+};
+
+#endif
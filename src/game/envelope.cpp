@@ -0,0 +1,354 @@
+#include "envelope.h"
+
+#include "mapitems.h"
+#include "mapitems_ex.h"
+
+#include <base/math.h>
+#include <base/vmath.h>
+
+#include <engine/shared/datafile.h>
+#include <engine/shared/map.h>
+
+#include <cmath>
+
+using namespace std::chrono_literals;
+
+CMapBasedEnvelopePointAccess::CMapBasedEnvelopePointAccess(CDataFileReader *pReader)
+{
+	bool FoundBezierEnvelope = false;
+	int EnvStart, EnvNum;
+	pReader->GetType(MAPITEMTYPE_ENVELOPE, &EnvStart, &EnvNum);
+	for(int EnvIndex = 0; EnvIndex < EnvNum; EnvIndex++)
+	{
+		CMapItemEnvelope *pEnvelope = static_cast<CMapItemEnvelope *>(pReader->GetItem(EnvStart + EnvIndex));
+		if(pEnvelope->m_Version >= CMapItemEnvelope_v3::CURRENT_VERSION)
+		{
+			FoundBezierEnvelope = true;
+			break;
+		}
+	}
+
+	if(FoundBezierEnvelope)
+	{
+		m_pPoints = nullptr;
+		m_pPointsBezier = nullptr;
+
+		int EnvPointStart, FakeEnvPointNum;
+		pReader->GetType(MAPITEMTYPE_ENVPOINTS, &EnvPointStart, &FakeEnvPointNum);
+		if(FakeEnvPointNum > 0)
+			m_pPointsBezierUpstream = static_cast<CEnvPointBezier_upstream *>(pReader->GetItem(EnvPointStart));
+		else
+			m_pPointsBezierUpstream = nullptr;
+
+		m_NumPointsMax = pReader->GetItemSize(EnvPointStart) / sizeof(CEnvPointBezier_upstream);
+	}
+	else
+	{
+		int EnvPointStart, FakeEnvPointNum;
+		pReader->GetType(MAPITEMTYPE_ENVPOINTS, &EnvPointStart, &FakeEnvPointNum);
+		if(FakeEnvPointNum > 0)
+			m_pPoints = static_cast<CEnvPoint *>(pReader->GetItem(EnvPointStart));
+		else
+			m_pPoints = nullptr;
+
+		m_NumPointsMax = pReader->GetItemSize(EnvPointStart) / sizeof(CEnvPoint);
+
+		int EnvPointBezierStart, FakeEnvPointBezierNum;
+		pReader->GetType(MAPITEMTYPE_ENVPOINTS_BEZIER, &EnvPointBezierStart, &FakeEnvPointBezierNum);
+		const int NumPointsBezier = pReader->GetItemSize(EnvPointBezierStart) / sizeof(CEnvPointBezier);
+		if(FakeEnvPointBezierNum > 0 && m_NumPointsMax == NumPointsBezier)
+			m_pPointsBezier = static_cast<CEnvPointBezier *>(pReader->GetItem(EnvPointBezierStart));
+		else
+			m_pPointsBezier = nullptr;
+
+		m_pPointsBezierUpstream = nullptr;
+	}
+
+	SetPointsRange(0, m_NumPointsMax);
+}
+
+CMapBasedEnvelopePointAccess::CMapBasedEnvelopePointAccess(IMap *pMap) :
+	CMapBasedEnvelopePointAccess(static_cast<CMap *>(pMap)->GetReader())
+{
+}
+
+void CMapBasedEnvelopePointAccess::SetPointsRange(int StartPoint, int NumPoints)
+{
+	m_StartPoint = clamp(StartPoint, 0, m_NumPointsMax);
+	m_NumPoints = clamp(NumPoints, 0, maximum(m_NumPointsMax - StartPoint, 0));
+}
+
+int CMapBasedEnvelopePointAccess::StartPoint() const
+{
+	return m_StartPoint;
+}
+
+int CMapBasedEnvelopePointAccess::NumPoints() const
+{
+	return m_NumPoints;
+}
+
+int CMapBasedEnvelopePointAccess::NumPointsMax() const
+{
+	return m_NumPointsMax;
+}
+
+const CEnvPoint *CMapBasedEnvelopePointAccess::GetPoint(int Index) const
+{
+	if(Index < 0 || Index >= m_NumPoints)
+		return nullptr;
+	if(m_pPoints != nullptr)
+		return &m_pPoints[Index + m_StartPoint];
+	if(m_pPointsBezierUpstream != nullptr)
+		return &m_pPointsBezierUpstream[Index + m_StartPoint];
+	return nullptr;
+}
+
+const CEnvPointBezier *CMapBasedEnvelopePointAccess::GetBezier(int Index) const
+{
+	if(Index < 0 || Index >= m_NumPoints)
+		return nullptr;
+	if(m_pPointsBezier != nullptr)
+		return &m_pPointsBezier[Index + m_StartPoint];
+	if(m_pPointsBezierUpstream != nullptr)
+		return &m_pPointsBezierUpstream[Index + m_StartPoint].m_Bezier;
+	return nullptr;
+}
+
+static double CubicRoot(double x)
+{
+	if(x == 0.0)
+		return 0.0;
+	else if(x < 0.0)
+		return -std::exp(std::log(-x) / 3.0);
+	else
+		return std::exp(std::log(x) / 3.0);
+}
+
+static float SolveBezier(float x, float p0, float p1, float p2, float p3)
+{
+	const double x3 = -p0 + 3.0 * p1 - 3.0 * p2 + p3;
+	const double x2 = 3.0 * p0 - 6.0 * p1 + 3.0 * p2;
+	const double x1 = -3.0 * p0 + 3.0 * p1;
+	const double x0 = p0 - x;
+
+	if(x3 == 0.0 && x2 == 0.0)
+	{
+		// linear
+		// a * t + b = 0
+		const double a = x1;
+		const double b = x0;
+
+		if(a == 0.0)
+			return 0.0f;
+		return -b / a;
+	}
+	else if(x3 == 0.0)
+	{
+		// quadratic
+		// t * t + b * t + c = 0
+		const double b = x1 / x2;
+		const double c = x0 / x2;
+
+		if(c == 0.0)
+			return 0.0f;
+
+		const double D = b * b - 4.0 * c;
+		const double SqrtD = std::sqrt(D);
+
+		const double t = (-b + SqrtD) / 2.0;
+
+		if(0.0 <= t && t <= 1.0001)
+			return t;
+		return (-b - SqrtD) / 2.0;
+	}
+	else
+	{
+		// cubic
+		// t * t * t + a * t * t + b * t * t + c = 0
+		const double a = x2 / x3;
+		const double b = x1 / x3;
+		const double c = x0 / x3;
+
+		// substitute t = y - a / 3
+		const double sub = a / 3.0;
+
+		// depressed form x^3 + px + q = 0
+		// cardano's method
+		const double p = b / 3.0 - a * a / 9.0;
+		const double q = (2.0 * a * a * a / 27.0 - a * b / 3.0 + c) / 2.0;
+
+		const double D = q * q + p * p * p;
+
+		if(D > 0.0)
+		{
+			// only one 'real' solution
+			const double s = std::sqrt(D);
+			return CubicRoot(s - q) - CubicRoot(s + q) - sub;
+		}
+		else if(D == 0.0)
+		{
+			// one single, one double solution or triple solution
+			const double s = CubicRoot(-q);
+			const double t = 2.0 * s - sub;
+
+			if(0.0 <= t && t <= 1.0001)
+				return t;
+			return (-s - sub);
+		}
+		else
+		{
+			// Casus irreducibilis ... ,_,
+			const double phi = std::acos(-q / std::sqrt(-(p * p * p))) / 3.0;
+			const double s = 2.0 * std::sqrt(-p);
+
+			const double t1 = s * std::cos(phi) - sub;
+
+			if(0.0 <= t1 && t1 <= 1.0001)
+				return t1;
+
+			const double t2 = -s * std::cos(phi + pi / 3.0) - sub;
+
+			if(0.0 <= t2 && t2 <= 1.0001)
+				return t2;
+			return -s * std::cos(phi - pi / 3.0) - sub;
+		}
+	}
+}
+
+void EvalEnvelope(const IEnvelopePointAccess *pPoints, std::chrono::nanoseconds TimeNanos, ColorRGBA &Result, size_t Channels)
+{
+	const int NumPoints = pPoints->NumPoints();
+	if(NumPoints == 0)
+	{
+		return;
+	}
+
+	if(NumPoints == 1)
+	{
+		const CEnvPoint *pFirstPoint = pPoints->GetPoint(0);
+		for(size_t c = 0; c < Channels; c++)
+		{
+			Result[c] = fx2f(pFirstPoint->m_aValues[c]);
+		}
+		return;
+	}
+
+	const CEnvPoint *pLastPoint = pPoints->GetPoint(NumPoints - 1);
+	const int64_t MaxPointTime = (int64_t)pLastPoint->m_Time * std::chrono::nanoseconds(1ms).count();
+	if(MaxPointTime > 0) // TODO: remove this check when implementing a IO check for maps(in this case broken envelopes)
+		TimeNanos = std::chrono::nanoseconds(TimeNanos.count() % MaxPointTime);
+	else
+		TimeNanos = decltype(TimeNanos)::zero();
+
+	const double TimeMillis = TimeNanos.count() / (double)std::chrono::nanoseconds(1ms).count();
+
+	// binary search for the last point that starts at or before the current time,
+	// the points of an envelope are sorted by time
+	int Low = 0;
+	int High = NumPoints;
+	while(Low < High)
+	{
+		const int Middle = Low + (High - Low) / 2;
+		if(pPoints->GetPoint(Middle)->m_Time <= TimeMillis)
+			Low = Middle + 1;
+		else
+			High = Middle;
+	}
+	const int i = Low - 1;
+	if(i >= 0 && i < NumPoints - 1)
+	{
+		const CEnvPoint *pCurrentPoint = pPoints->GetPoint(i);
+		const CEnvPoint *pNextPoint = pPoints->GetPoint(i + 1);
+		if(TimeMillis >= pCurrentPoint->m_Time && TimeMillis < pNextPoint->m_Time)
+		{
+			const float Delta = pNextPoint->m_Time - pCurrentPoint->m_Time;
+			float a = (float)(TimeMillis - pCurrentPoint->m_Time) / Delta;
+
+			switch(pCurrentPoint->m_Curvetype)
+			{
+			case CURVETYPE_STEP:
+				a = 0.0f;
+				break;
+
+			case CURVETYPE_SLOW:
+				a = a * a * a;
+				break;
+
+			case CURVETYPE_FAST:
+				a = 1.0f - a;
+				a = 1.0f - a * a * a;
+				break;
+
+			case CURVETYPE_SMOOTH:
+				a = -2.0f * a * a * a + 3.0f * a * a; // second hermite basis
+				break;
+
+			case CURVETYPE_BEZIER:
+			{
+				const CEnvPointBezier *pCurrentPointBezier = pPoints->GetBezier(i);
+				const CEnvPointBezier *pNextPointBezier = pPoints->GetBezier(i + 1);
+				if(pCurrentPointBezier == nullptr || pNextPointBezier == nullptr)
+					break; // fallback to linear
+				for(size_t c = 0; c < Channels; c++)
+				{
+					// monotonic 2d cubic bezier curve
+					const vec2 p0 = vec2(pCurrentPoint->m_Time, fx2f(pCurrentPoint->m_aValues[c]));
+					const vec2 p3 = vec2(pNextPoint->m_Time, fx2f(pNextPoint->m_aValues[c]));
+
+					const vec2 OutTang = vec2(pCurrentPointBezier->m_aOutTangentDeltaX[c], fx2f(pCurrentPointBezier->m_aOutTangentDeltaY[c]));
+					const vec2 InTang = vec2(pNextPointBezier->m_aInTangentDeltaX[c], fx2f(pNextPointBezier->m_aInTangentDeltaY[c]));
+
+					vec2 p1 = p0 + OutTang;
+					vec2 p2 = p3 + InTang;
+
+					// validate bezier curve
+					p1.x = clamp(p1.x, p0.x, p3.x);
+					p2.x = clamp(p2.x, p0.x, p3.x);
+
+					// solve x(a) = time for a
+					a = clamp(SolveBezier(TimeMillis, p0.x, p1.x, p2.x, p3.x), 0.0f, 1.0f);
+
+					// value = y(t)
+					Result[c] = bezier(p0.y, p1.y, p2.y, p3.y, a);
+				}
+				return;
+			}
+
+			case CURVETYPE_LINEAR: [[fallthrough]];
+			default:
+				break;
+			}
+
+			for(size_t c = 0; c < Channels; c++)
+			{
+				const float v0 = fx2f(pCurrentPoint->m_aValues[c]);
+				const float v1 = fx2f(pNextPoint->m_aValues[c]);
+				Result[c] = v0 + (v1 - v0) * a;
+			}
+
+			return;
+		}
+	}
+
+	for(size_t c = 0; c < Channels; c++)
+	{
+		Result[c] = fx2f(pLastPoint->m_aValues[c]);
+	}
+}
+
+bool CEnvelopeEvalCache::Find(int Env, int TimeOffsetMillis, size_t Channels, ColorRGBA &Result) const
+{
+	const auto It = m_Entries.find(Key(Env, TimeOffsetMillis, Channels));
+	if(It == m_Entries.end())
+		return false;
+	ColorRGBA Cached = It->second;
+	for(size_t c = 0; c < Channels; c++)
+		Result[c] = Cached[c];
+	return true;
+}
+
+void CEnvelopeEvalCache::Add(int Env, int TimeOffsetMillis, size_t Channels, const ColorRGBA &Result)
+{
+	m_Entries[Key(Env, TimeOffsetMillis, Channels)] = Result;
+}
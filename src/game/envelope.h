@@ -0,0 +1,71 @@
+#ifndef GAME_ENVELOPE_H
+#define GAME_ENVELOPE_H
+
+#include <base/color.h>
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+class CDataFileReader;
+class IMap;
+struct CEnvPoint;
+struct CEnvPointBezier;
+struct CEnvPointBezier_upstream;
+
+class IEnvelopePointAccess
+{
+public:
+	virtual ~IEnvelopePointAccess() = default;
+	virtual int NumPoints() const = 0;
+	virtual const CEnvPoint *GetPoint(int Index) const = 0;
+	virtual const CEnvPointBezier *GetBezier(int Index) const = 0;
+};
+
+class CMapBasedEnvelopePointAccess : public IEnvelopePointAccess
+{
+	int m_StartPoint;
+	int m_NumPoints;
+	int m_NumPointsMax;
+	CEnvPoint *m_pPoints;
+	CEnvPointBezier *m_pPointsBezier;
+	CEnvPointBezier_upstream *m_pPointsBezierUpstream;
+
+public:
+	CMapBasedEnvelopePointAccess(CDataFileReader *pReader);
+	CMapBasedEnvelopePointAccess(IMap *pMap);
+	void SetPointsRange(int StartPoint, int NumPoints);
+	int StartPoint() const;
+	int NumPoints() const override;
+	int NumPointsMax() const;
+	const CEnvPoint *GetPoint(int Index) const override;
+	const CEnvPointBezier *GetBezier(int Index) const override;
+};
+
+// writes the value of the first Channels channels of the envelope at the given
+// time to Result, Result is left untouched if the envelope has no points
+void EvalEnvelope(const IEnvelopePointAccess *pPoints, std::chrono::nanoseconds TimeNanos, ColorRGBA &Result, size_t Channels);
+
+// remembers evaluated envelope values for one frame, many quads share the
+// same envelope and time offset so most of them can reuse a single evaluation
+class CEnvelopeEvalCache
+{
+public:
+	void Clear() { m_Entries.clear(); }
+	int Size() const { return m_Entries.size(); }
+
+	// returns true and writes the first Channels channels to Result if the
+	// envelope has already been evaluated with this time offset
+	bool Find(int Env, int TimeOffsetMillis, size_t Channels, ColorRGBA &Result) const;
+	void Add(int Env, int TimeOffsetMillis, size_t Channels, const ColorRGBA &Result);
+
+private:
+	static uint64_t Key(int Env, int TimeOffsetMillis, size_t Channels)
+	{
+		return ((uint64_t)(uint32_t)TimeOffsetMillis << 32) | ((uint64_t)(uint32_t)Env << 3) | (Channels & 7);
+	}
+
+	std::unordered_map<uint64_t, ColorRGBA> m_Entries;
+};
+
+#endif
@@ -8,6 +8,7 @@
 #include "gamecontroller.h"
 
 #include <engine/shared/config.h>
+#include <engine/shared/tickprofiler.h>
 
 #include <algorithm>
 #include <utility>
@@ -40,6 +41,17 @@ void CGameWorld::SetGameServer(CGameContext *pGameServer)
 	m_pGameServer = pGameServer;
 	m_pConfig = m_pGameServer->Config();
 	m_pServer = m_pGameServer->Server();
+
+	static const char *s_apEntTypeNames[NUM_ENTTYPES] = {"projectile", "laser", "pickup", "flag", "character"};
+	m_pTickProfiler = m_pServer->TickProfiler();
+	for(int i = 0; i < NUM_ENTTYPES; i++)
+	{
+		char aName[32];
+		str_format(aName, sizeof(aName), "tick:%s", s_apEntTypeNames[i]);
+		m_aTickProfilerTickSections[i] = m_pTickProfiler->AddSection(aName);
+		str_format(aName, sizeof(aName), "snap:%s", s_apEntTypeNames[i]);
+		m_aTickProfilerSnapSections[i] = m_pTickProfiler->AddSection(aName);
+	}
 }
 
 CEntity *CGameWorld::FindFirst(int Type)
@@ -108,11 +120,14 @@ void CGameWorld::RemoveEntity(CEntity *pEnt)
 //
 void CGameWorld::Snap(int SnappingClient)
 {
-	for(CEntity *pEnt = m_apFirstEntityTypes[ENTTYPE_CHARACTER]; pEnt;)
 	{
-		m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
-		pEnt->Snap(SnappingClient);
-		pEnt = m_pNextTraverseEntity;
+		CTickProfiler::CScope Scope(m_pTickProfiler, m_aTickProfilerSnapSections[ENTTYPE_CHARACTER]);
+		for(CEntity *pEnt = m_apFirstEntityTypes[ENTTYPE_CHARACTER]; pEnt;)
+		{
+			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
+			pEnt->Snap(SnappingClient);
+			pEnt = m_pNextTraverseEntity;
+		}
 	}
 
 	for(int i = 0; i < NUM_ENTTYPES; i++)
@@ -120,6 +135,7 @@ void CGameWorld::Snap(int SnappingClient)
 		if(i == ENTTYPE_CHARACTER)
 			continue;
 
+		CTickProfiler::CScope Scope(m_pTickProfiler, m_aTickProfilerSnapSections[i]);
 		for(CEntity *pEnt = m_apFirstEntityTypes[i]; pEnt;)
 		{
 			m_pNextTraverseEntity = pEnt->m_pNextTypeEntity;
@@ -217,6 +233,8 @@ void CGameWorld::Tick()
 		// update all objects
 		for(int i = 0; i < NUM_ENTTYPES; i++)
 		{
+			CTickProfiler::CScope Scope(m_pTickProfiler, m_aTickProfilerTickSections[i]);
+
 			// It's important to call PreTick() and Tick() after each other.
 			// If we call PreTick() before, and Tick() after other entities have been processed, it causes physics changes such as a stronger shotgun or grenade.
 			if(g_Config.m_SvNoWeakHook && i == ENTTYPE_CHARACTER)
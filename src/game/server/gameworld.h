@@ -41,6 +41,10 @@ private:
 	class CConfig *m_pConfig;
 	class IServer *m_pServer;
 
+	class CTickProfiler *m_pTickProfiler = nullptr;
+	int m_aTickProfilerTickSections[NUM_ENTTYPES];
+	int m_aTickProfilerSnapSections[NUM_ENTTYPES];
+
 public:
 	class CGameContext *GameServer() { return m_pGameServer; }
 	class CConfig *Config() { return m_pConfig; }
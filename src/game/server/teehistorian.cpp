@@ -6,6 +6,7 @@
 #include <engine/shared/json.h>
 #include <engine/shared/packer.h>
 #include <engine/shared/snapshot.h>
+#include <engine/shared/teehistorian_ex.h>
 
 #include <game/gamecore.h>
 
@@ -21,7 +22,6 @@ private:
 	unsigned char m_aBuffer[1024 * 64];
 };
 
-static const char TEEHISTORIAN_NAME[] = "teehistorian@ddnet.tw";
 static const CUuid TEEHISTORIAN_UUID = CalculateUuid(TEEHISTORIAN_NAME);
 static const char TEEHISTORIAN_VERSION[] = "2";
 static const char TEEHISTORIAN_VERSION_MINOR[] = "9";
@@ -30,22 +30,6 @@ static const char TEEHISTORIAN_VERSION_MINOR[] = "9";
 #include <engine/shared/teehistorian_ex_chunks.h>
 #undef UUID
 
-enum
-{
-	TEEHISTORIAN_NONE,
-	TEEHISTORIAN_FINISH,
-	TEEHISTORIAN_TICK_SKIP,
-	TEEHISTORIAN_PLAYER_NEW,
-	TEEHISTORIAN_PLAYER_OLD,
-	TEEHISTORIAN_INPUT_DIFF,
-	TEEHISTORIAN_INPUT_NEW,
-	TEEHISTORIAN_MESSAGE,
-	TEEHISTORIAN_JOIN,
-	TEEHISTORIAN_DROP,
-	TEEHISTORIAN_CONSOLE_COMMAND,
-	TEEHISTORIAN_EX,
-};
-
 CTeeHistorian::CTeeHistorian()
 {
 	m_State = STATE_START;
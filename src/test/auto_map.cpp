@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <engine/shared/linereader.h>
+#include <engine/shared/workergroup.h>
+
+#include <game/editor/auto_map_rules.h>
+
+#include <string>
+#include <vector>
+
+static const char RULES[] =
+	"[Walls]\n"
+	"Index 16\n"
+	"\n"
+	"Index 17\n"
+	"Pos 0 -1 EMPTY\n"
+	"Pos 0 1 EMPTY\n"
+	"Pos -1 0 EMPTY\n"
+	"\n"
+	"Index 18 YFLIP\n"
+	"Pos 0 -1 FULL\n"
+	"Pos 0 1 INDEX 16 OR 18 XFLIP OR 17 ROTATE YFLIP\n"
+	"\n"
+	"Index 19 XFLIP ROTATE\n"
+	"Pos -2 1 NOTINDEX 0 OR 20 NONE\n"
+	"Pos 2 -2 INDEX 19 XFLIP\n"
+	"Random 3\n"
+	"\n"
+	"Index 21\n"
+	"NoDefaultRule\n"
+	"Pos 0 0 INDEX 0\n"
+	"Pos 1 1 FULL\n"
+	"Random 40%\n"
+	"\n"
+	"Index 25\n"
+	"Pos 1 0 INDEX 16\n"
+	"Pos 1 0 NOTINDEX 16\n"
+	"\n"
+	"NewRun\n"
+	"NoLayerCopy\n"
+	"Index 22\n"
+	"Pos -1 0 INDEX 22 OR 17\n"
+	"Pos 0 0 NOTINDEX 0\n"
+	"\n"
+	"Index 23\n"
+	"Pos 0 0 INDEX 22\n"
+	"Pos 0 -1 INDEX 22\n"
+	"\n"
+	"NewRun\n"
+	"Index 24\n"
+	"Pos 1 0 INDEX 22 OR 23\n"
+	"Pos 0 1 INDEX -1\n"
+	"\n"
+	"[Empty]\n"
+	"\n"
+	"[Fill]\n"
+	"Index 5\n"
+	"NoDefaultRule\n"
+	"Random 2\n";
+
+static void LoadRules(CAutoMapRules &AutoMapRules)
+{
+	// a rule with more position checks than fit into the masks
+	std::string Rules = RULES;
+	Rules += "[Wide]\nIndex 7\n";
+	for(int i = 0; i < 70; i++)
+		Rules += "Pos " + std::to_string(i % 9 - 4) + " " + std::to_string(i / 9 - 4) + " NOTINDEX " + std::to_string(i % 3 == 0 ? 0 : i) + "\n";
+	Rules += "\nIndex 8\nPos 1 0 FULL\nRandom 2\n";
+
+	char *pBuffer = (char *)malloc(Rules.size() + 1);
+	mem_copy(pBuffer, Rules.c_str(), Rules.size() + 1);
+	CLineReader LineReader;
+	LineReader.OpenBuffer(pBuffer);
+	AutoMapRules.Load(LineReader);
+}
+
+// the automapper before the rules were compiled, the changes are the
+// tiles for which any rule was applied
+static void ProceedReference(const CAutoMapRules &Rules, CTile *pTiles, int Width, int Height, int ConfigId, int Seed, int SeedOffsetX, int SeedOffsetY, std::vector<int> &vChanges)
+{
+	const CAutoMapRules::CConfiguration *pConf = &Rules.Config(ConfigId);
+	for(size_t h = 0; h < pConf->m_vRuns.size(); ++h)
+	{
+		const CAutoMapRules::CRun *pRun = &pConf->m_vRuns[h];
+		std::vector<CTile> vCopy(pTiles, pTiles + Width * Height);
+		const CTile *pRead = pRun->m_AutomapCopy ? vCopy.data() : pTiles;
+
+		for(int y = 0; y < Height; y++)
+		{
+			for(int x = 0; x < Width; x++)
+			{
+				CTile *pTile = &pTiles[y * Width + x];
+				const CTile *pReadTile = &pRead[y * Width + x];
+				bool Changed = false;
+				for(size_t i = 0; i < pRun->m_vIndexRules.size(); ++i)
+				{
+					const CAutoMapRules::CIndexRule *pIndexRule = &pRun->m_vIndexRules[i];
+					if(pIndexRule->m_SkipEmpty && pReadTile->m_Index == 0)
+						continue;
+					if(pIndexRule->m_SkipFull && pReadTile->m_Index != 0)
+						continue;
+
+					bool RespectRules = true;
+					for(size_t j = 0; j < pIndexRule->m_vRules.size() && RespectRules; ++j)
+					{
+						const CAutoMapRules::CPosRule *pRule = &pIndexRule->m_vRules[j];
+						int CheckIndex, CheckFlags;
+						int CheckX = x + pRule->m_X;
+						int CheckY = y + pRule->m_Y;
+						if(CheckX >= 0 && CheckX < Width && CheckY >= 0 && CheckY < Height)
+						{
+							int CheckTile = CheckY * Width + CheckX;
+							CheckIndex = pRead[CheckTile].m_Index;
+							CheckFlags = pRead[CheckTile].m_Flags & (TILEFLAG_ROTATE | TILEFLAG_XFLIP | TILEFLAG_YFLIP);
+						}
+						else
+						{
+							CheckIndex = -1;
+							CheckFlags = 0;
+						}
+
+						if(pRule->m_Value == CAutoMapRules::CPosRule::INDEX)
+						{
+							RespectRules = false;
+							for(const auto &Index : pRule->m_vIndexList)
+							{
+								if(CheckIndex == Index.m_Id && (!Index.m_TestFlag || CheckFlags == Index.m_Flag))
+								{
+									RespectRules = true;
+									break;
+								}
+							}
+						}
+						else if(pRule->m_Value == CAutoMapRules::CPosRule::NOTINDEX)
+						{
+							for(const auto &Index : pRule->m_vIndexList)
+							{
+								if(CheckIndex == Index.m_Id && (!Index.m_TestFlag || CheckFlags == Index.m_Flag))
+								{
+									RespectRules = false;
+									break;
+								}
+							}
+						}
+					}
+
+					if(RespectRules &&
+						(pIndexRule->m_RandomProbability >= 1.0f || CAutoMapRules::HashLocation(Seed, h, i, x + SeedOffsetX, y + SeedOffsetY) < CAutoMapRules::HASH_MAX * pIndexRule->m_RandomProbability))
+					{
+						pTile->m_Index = pIndexRule->m_Id;
+						pTile->m_Flags = pIndexRule->m_Flag;
+						Changed = true;
+					}
+				}
+				if(Changed)
+					vChanges.push_back(y * Width + x);
+			}
+		}
+	}
+}
+
+static std::vector<CTile> RandomTiles(int Width, int Height)
+{
+	// mostly the indices that the rules check, in all orientations
+	static const unsigned char s_aIndices[] = {0, 0, 0, 1, 16, 17, 18, 19, 20, 22, 23};
+	std::vector<CTile> vTiles(Width * Height);
+	for(CTile &Tile : vTiles)
+	{
+		unsigned char aRandom[2];
+		secure_random_fill(aRandom, sizeof(aRandom));
+		Tile.m_Index = s_aIndices[aRandom[0] % std::size(s_aIndices)];
+		Tile.m_Flags = aRandom[1] & (TILEFLAG_ROTATE | TILEFLAG_XFLIP | TILEFLAG_YFLIP | TILEFLAG_OPAQUE);
+		Tile.m_Skip = 0;
+		Tile.m_Reserved = 0;
+	}
+	return vTiles;
+}
+
+TEST(AutoMap, Load)
+{
+	CAutoMapRules Rules;
+	LoadRules(Rules);
+	ASSERT_EQ(Rules.NumConfigs(), 4);
+	EXPECT_STREQ(Rules.Config(0).m_aName, "Walls");
+	EXPECT_STREQ(Rules.Config(1).m_aName, "Empty");
+	EXPECT_STREQ(Rules.Config(2).m_aName, "Fill");
+	ASSERT_EQ(Rules.Config(0).m_vRuns.size(), 3u);
+	EXPECT_TRUE(Rules.Config(0).m_vRuns[0].m_AutomapCopy);
+	EXPECT_FALSE(Rules.Config(0).m_vRuns[1].m_AutomapCopy);
+	EXPECT_EQ(Rules.Config(0).m_StartX, -2);
+	EXPECT_EQ(Rules.Config(0).m_StartY, -2);
+	EXPECT_EQ(Rules.Config(0).m_EndX, 2);
+	EXPECT_EQ(Rules.Config(0).m_EndY, 1);
+
+	// EMPTY, FULL, the default rule and INDEX 0 all check for index 0
+	const CAutoMapRules::CCompiledRun &Compiled = Rules.Config(0).m_vRuns[0].m_Compiled;
+	EXPECT_EQ(Compiled.m_vIndexChecks.size(), 6u);
+	EXPECT_EQ(Compiled.m_vPosChecks.size(), 16u);
+	EXPECT_EQ(Compiled.m_vTables.size(), 5u);
+	EXPECT_TRUE(Compiled.m_UseMasks);
+	EXPECT_TRUE(Compiled.m_vIndexChecks[5].m_Impossible);
+	EXPECT_FALSE(Rules.Config(3).m_vRuns[0].m_Compiled.m_UseMasks);
+}
+
+TEST(AutoMap, SameAsReference)
+{
+	CAutoMapRules Rules;
+	LoadRules(Rules);
+
+	CWorkerGroup Workers;
+	Workers.Init(3);
+
+	// sizes smaller than the rules, not divisible by the rows per task
+	const int aSizes[][2] = {{1, 1}, {3, 2}, {57, 41}, {128, 77}};
+	for(const auto &Size : aSizes)
+	{
+		const int Width = Size[0];
+		const int Height = Size[1];
+		for(int ConfigId = 0; ConfigId < Rules.NumConfigs(); ConfigId++)
+		{
+			for(int Seed = 1; Seed <= 3; Seed++)
+			{
+				const std::vector<CTile> vTiles = RandomTiles(Width, Height);
+				std::vector<CTile> vExpected = vTiles;
+				std::vector<int> vExpectedChanges;
+				ProceedReference(Rules, vExpected.data(), Width, Height, ConfigId, Seed, 5, 7, vExpectedChanges);
+
+				for(CWorkerGroup *pWorkers : {(CWorkerGroup *)nullptr, &Workers})
+				{
+					std::vector<CTile> vResult = vTiles;
+					std::vector<int> vChanges;
+					Rules.Proceed(vResult.data(), Width, Height, ConfigId, Seed, 5, 7, pWorkers, [&](int x, int y, CTile Previous, CTile Tile) {
+						vChanges.push_back(y * Width + x);
+					});
+					EXPECT_EQ(mem_comp(vResult.data(), vExpected.data(), vResult.size() * sizeof(CTile)), 0) << Width << "x" << Height << " config " << ConfigId << " seed " << Seed;
+					EXPECT_EQ(vChanges, vExpectedChanges) << Width << "x" << Height << " config " << ConfigId << " seed " << Seed;
+				}
+			}
+		}
+	}
+}
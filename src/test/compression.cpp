@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <base/system.h>
 #include <engine/shared/compression.h>
 
 static const int DATA[] = {0, 1, -1, 32, 64, 256, -512, 12345, -123456, 1234567, 12345678, 123456789, 2147483647, (-2147483647 - 1)};
@@ -82,3 +83,103 @@ TEST(CVariableInt, DecompressBufferTooSmall)
 	long CompressedSize = CVariableInt::Decompress(aCompressed, sizeof(aCompressed), aUncompressed, sizeof(aUncompressed));
 	ASSERT_EQ(CompressedSize, -1);
 }
+
+static long CompressScalar(const int *pSrc, int Num, unsigned char *pDst, int DstSize)
+{
+	unsigned char *pCur = pDst;
+	for(int i = 0; i < Num; i++)
+	{
+		pCur = CVariableInt::Pack(pCur, pSrc[i], pDst + DstSize - pCur);
+		if(!pCur)
+			return -1;
+	}
+	return pCur - pDst;
+}
+
+static long DecompressScalar(const unsigned char *pSrc, int SrcSize, int *pDst, int Num)
+{
+	const unsigned char *pEnd = pSrc + SrcSize;
+	int i = 0;
+	while(pSrc < pEnd)
+	{
+		if(i >= Num)
+			return -1;
+		pSrc = CVariableInt::Unpack(pSrc, &pDst[i], pEnd - pSrc);
+		if(!pSrc)
+			return -1;
+		i++;
+	}
+	return i * sizeof(int);
+}
+
+TEST(CVariableInt, FuzzAgainstPackUnpack)
+{
+	unsigned Seed = 1234;
+	auto Random = [&Seed]() {
+		Seed = Seed * 1103515245 + 12345;
+		return Seed;
+	};
+
+	int aData[100];
+	unsigned char aCompressed[sizeof(aData) / sizeof(int) * CVariableInt::MAX_BYTES_PACKED];
+	unsigned char aExpectedCompressed[sizeof(aCompressed)];
+	int aDecompressed[std::size(aData)];
+	int aExpectedDecompressed[std::size(aData)];
+	for(int Round = 0; Round < 5000; Round++)
+	{
+		// mostly small values with a few large ones, like snapshot deltas
+		const int Num = Random() % (std::size(aData) + 1);
+		for(int i = 0; i < Num; i++)
+		{
+			const unsigned Kind = Random() % 16;
+			if(Kind < 12)
+				aData[i] = (int)(Random() >> 8) % 64 - (Kind % 2 ? 64 : 0);
+			else
+				aData[i] = (int)(Random() ^ (Random() << 16)) >> (Random() % 32);
+		}
+
+		const int DstSize = Random() % 2 ? sizeof(aCompressed) : Random() % sizeof(aCompressed);
+		const long Expected = CompressScalar(aData, Num, aExpectedCompressed, DstSize);
+		const long Size = CVariableInt::Compress(aData, Num * sizeof(int), aCompressed, DstSize);
+		ASSERT_EQ(Size, Expected);
+		if(Size < 0)
+			continue;
+		ASSERT_EQ(mem_comp(aCompressed, aExpectedCompressed, Size), 0);
+
+		const int NumDst = Random() % 2 ? Num : Random() % (Num + 1);
+		const long DecompressedSize = CVariableInt::Decompress(aCompressed, Size, aDecompressed, NumDst * sizeof(int));
+		ASSERT_EQ(DecompressedSize, DecompressScalar(aCompressed, Size, aExpectedDecompressed, NumDst));
+		if(NumDst == Num)
+		{
+			ASSERT_EQ(DecompressedSize, (long)(Num * sizeof(int)));
+			ASSERT_EQ(mem_comp(aDecompressed, aData, Num * sizeof(int)), 0);
+		}
+	}
+}
+
+TEST(CVariableInt, FuzzDecompressGarbage)
+{
+	unsigned Seed = 5678;
+	auto Random = [&Seed]() {
+		Seed = Seed * 1103515245 + 12345;
+		return Seed >> 16;
+	};
+
+	unsigned char aSrc[256];
+	int aDecompressed[256];
+	int aExpected[256];
+	for(int Round = 0; Round < 5000; Round++)
+	{
+		const int SrcSize = Random() % (sizeof(aSrc) + 1);
+		for(int i = 0; i < SrcSize; i++)
+			aSrc[i] = Random() % 4 ? Random() % 0x80 : Random() % 0x100;
+		const int NumDst = Random() % (std::size(aDecompressed) + 1);
+		const long Expected = DecompressScalar(aSrc, SrcSize, aExpected, NumDst);
+		const long Size = CVariableInt::Decompress(aSrc, SrcSize, aDecompressed, NumDst * sizeof(int));
+		ASSERT_EQ(Size, Expected);
+		if(Size > 0)
+		{
+			ASSERT_EQ(mem_comp(aDecompressed, aExpected, Size), 0);
+		}
+	}
+}
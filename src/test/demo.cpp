@@ -0,0 +1,247 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/client/demo_header_cache.h>
+#include <engine/console.h>
+#include <engine/shared/config.h>
+#include <engine/shared/demo.h>
+#include <engine/shared/snapshot.h>
+#include <engine/storage.h>
+#include <game/generated/protocol.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// Records the same demo to all files at once, interleaving the recorders
+// like the server does with its demo and the auto recorded race demos.
+static void RecordDemos(IStorage *pStorage, const std::vector<const char *> &vpFilenames, bool AsyncWrite, int NumItems = 8, std::chrono::nanoseconds MaxSnapshotWait = std::chrono::nanoseconds(-1), std::vector<int> *pvNumDropped = nullptr)
+{
+	CSnapshotDelta SnapshotDelta;
+	std::vector<std::unique_ptr<CDemoRecorder>> vpRecorders;
+	SHA256_DIGEST Sha256 = {{0}};
+	unsigned char aMapData[1] = {0};
+	for(const char *pFilename : vpFilenames)
+	{
+		vpRecorders.push_back(std::make_unique<CDemoRecorder>(&SnapshotDelta, true));
+		ASSERT_EQ(vpRecorders.back()->Start(pStorage, nullptr, pFilename, "0.6 626fce9a778df4d4", "test", Sha256, 0, "server", 0, aMapData, nullptr, nullptr, nullptr, AsyncWrite), 0);
+		vpRecorders.back()->SetMaxSnapshotWait(MaxSnapshotWait);
+	}
+
+	// built up front, so that the recorders are fed faster than the writer
+	// can write
+	const int NUM_SNAPSHOTS = 1500;
+	std::vector<std::vector<char>> vvSnapshots(NUM_SNAPSHOTS);
+	for(int i = 0; i < NUM_SNAPSHOTS; i++)
+	{
+		CSnapshotBuilder Builder;
+		Builder.Init();
+		for(int Id = 0; Id < NumItems; Id++)
+		{
+			CNetObj_Flag *pFlag = (CNetObj_Flag *)Builder.NewItem(CNetObj_Flag::ms_MsgId, Id, sizeof(CNetObj_Flag));
+			ASSERT_TRUE(pFlag);
+			pFlag->m_X = Id * 32 + (Id % 3 == 0 ? i : 0);
+			pFlag->m_Y = i / 7;
+			pFlag->m_Team = Id % 2;
+		}
+		char aData[CSnapshot::MAX_SIZE];
+		const int Size = Builder.Finish((CSnapshot *)aData);
+		vvSnapshots[i].assign(aData, aData + Size);
+	}
+
+	// more items than fit into the writer queue, so the recorders have to
+	// wait for the writer or drop snapshots
+	for(int i = 0; i < NUM_SNAPSHOTS; i++)
+	{
+		const int Tick = i * 3 + (i % 10 == 0 ? 40 : 0);
+		char aMessage[64];
+		str_format(aMessage, sizeof(aMessage), "message %d", i);
+		for(auto &pRecorder : vpRecorders)
+		{
+			pRecorder->RecordSnapshot(Tick, vvSnapshots[i].data(), vvSnapshots[i].size());
+			if(i % 2 == 0)
+				pRecorder->RecordMessage(aMessage, str_length(aMessage) + 1);
+		}
+	}
+	for(auto &pRecorder : vpRecorders)
+	{
+		pRecorder->AddDemoMarker();
+		EXPECT_EQ(pRecorder->Stop(IDemoRecorder::EStopMode::KEEP_FILE), 0);
+		if(pvNumDropped)
+			pvNumDropped->push_back(pRecorder->NumDroppedSnapshots());
+	}
+}
+
+static std::vector<unsigned char> ReadDemo(IStorage *pStorage, const char *pFilename)
+{
+	std::vector<unsigned char> vData;
+	void *pData;
+	unsigned Size;
+	EXPECT_TRUE(pStorage->ReadFile(pFilename, IStorage::TYPE_SAVE, &pData, &Size));
+	if(pData)
+	{
+		// skip the header as it contains the timestamp
+		if(Size > sizeof(CDemoHeader))
+			vData.assign((unsigned char *)pData + sizeof(CDemoHeader), (unsigned char *)pData + Size);
+		free(pData);
+	}
+	return vData;
+}
+
+TEST(Demo, AsyncWriteIdentical)
+{
+	auto pStorage = std::unique_ptr<IStorage>(CreateLocalStorage());
+	CTestInfo Info;
+	char aSyncFilename[IO_MAX_PATH_LENGTH];
+	char aaAsyncFilenames[3][IO_MAX_PATH_LENGTH];
+	Info.Filename(aSyncFilename, sizeof(aSyncFilename), "-sync.demo");
+	std::vector<const char *> vpAsyncFilenames;
+	for(int i = 0; i < (int)std::size(aaAsyncFilenames); i++)
+	{
+		char aSuffix[32];
+		str_format(aSuffix, sizeof(aSuffix), "-async%d.demo", i);
+		Info.Filename(aaAsyncFilenames[i], sizeof(aaAsyncFilenames[i]), aSuffix);
+		vpAsyncFilenames.push_back(aaAsyncFilenames[i]);
+	}
+
+	RecordDemos(pStorage.get(), {aSyncFilename}, false);
+	// the recorders share the writer thread
+	RecordDemos(pStorage.get(), vpAsyncFilenames, true);
+
+	const std::vector<unsigned char> vSync = ReadDemo(pStorage.get(), aSyncFilename);
+	EXPECT_FALSE(vSync.empty());
+	for(const char *pFilename : vpAsyncFilenames)
+		EXPECT_TRUE(vSync == ReadDemo(pStorage.get(), pFilename)) << pFilename;
+
+	if(!HasFailure())
+	{
+		pStorage->RemoveFile(aSyncFilename, IStorage::TYPE_SAVE);
+		for(const char *pFilename : vpAsyncFilenames)
+			pStorage->RemoveFile(pFilename, IStorage::TYPE_SAVE);
+	}
+}
+
+TEST(Demo, AsyncWriteDropsSnapshots)
+{
+	auto pStorage = std::unique_ptr<IStorage>(CreateLocalStorage());
+	CTestInfo Info;
+	char aSyncFilename[IO_MAX_PATH_LENGTH];
+	char aaAsyncFilenames[3][IO_MAX_PATH_LENGTH];
+	Info.Filename(aSyncFilename, sizeof(aSyncFilename), "-sync.demo");
+	std::vector<const char *> vpAsyncFilenames;
+	for(int i = 0; i < (int)std::size(aaAsyncFilenames); i++)
+	{
+		char aSuffix[32];
+		str_format(aSuffix, sizeof(aSuffix), "-async%d.demo", i);
+		Info.Filename(aaAsyncFilenames[i], sizeof(aaAsyncFilenames[i]), aSuffix);
+		vpAsyncFilenames.push_back(aaAsyncFilenames[i]);
+	}
+
+	// Big snapshots take the writer longer than queueing them, whether it
+	// falls behind still depends on the machine. Without waiting the
+	// recorders never block on it and count what they drop.
+	const int NumItems = 600;
+	RecordDemos(pStorage.get(), {aSyncFilename}, false, NumItems);
+	std::vector<int> vNumDropped;
+	RecordDemos(pStorage.get(), vpAsyncFilenames, true, NumItems, std::chrono::nanoseconds(0), &vNumDropped);
+	ASSERT_EQ(vNumDropped.size(), vpAsyncFilenames.size());
+
+	const std::vector<unsigned char> vSync = ReadDemo(pStorage.get(), aSyncFilename);
+	CSnapshotDelta SnapshotDelta;
+	CDemoPlayer Player(&SnapshotDelta, false);
+	for(int i = 0; i < (int)vpAsyncFilenames.size(); i++)
+	{
+		const std::vector<unsigned char> vAsync = ReadDemo(pStorage.get(), vpAsyncFilenames[i]);
+		if(vNumDropped[i] == 0)
+			EXPECT_TRUE(vSync == vAsync) << vpAsyncFilenames[i];
+		else
+			EXPECT_LT(vAsync.size(), vSync.size()) << vpAsyncFilenames[i];
+
+		CDemoHeader DemoInfo;
+		CTimelineMarkers TimelineMarkers;
+		CMapInfo MapInfo;
+		EXPECT_TRUE(Player.GetDemoInfo(pStorage.get(), nullptr, vpAsyncFilenames[i], IStorage::TYPE_SAVE, &DemoInfo, &TimelineMarkers, &MapInfo)) << vpAsyncFilenames[i];
+	}
+
+	if(!HasFailure())
+	{
+		pStorage->RemoveFile(aSyncFilename, IStorage::TYPE_SAVE);
+		for(const char *pFilename : vpAsyncFilenames)
+			pStorage->RemoveFile(pFilename, IStorage::TYPE_SAVE);
+	}
+}
+
+TEST(Demo, HeaderCache)
+{
+	CTestInfo Info;
+	Info.m_DeleteTestStorageFilesOnSuccess = true;
+	auto pConsole = CreateConsole(CFGFLAG_CLIENT);
+	auto pStorage = std::unique_ptr<IStorage>(Info.CreateTestStorage());
+
+	char aFilename[IO_MAX_PATH_LENGTH];
+	Info.Filename(aFilename, sizeof(aFilename), ".demo");
+	RecordDemos(pStorage.get(), {aFilename}, false);
+	if(HasFatalFailure())
+		return;
+
+	CSnapshotDelta SnapshotDelta;
+	CDemoPlayer Player(&SnapshotDelta, false);
+	IDemoHeaderCache::CEntry Demo;
+	Demo.m_Valid = Player.GetDemoInfo(pStorage.get(), nullptr, aFilename, IStorage::TYPE_SAVE, &Demo.m_Info, &Demo.m_TimelineMarkers, &Demo.m_MapInfo);
+	ASSERT_TRUE(Demo.m_Valid);
+	pStorage->RemoveFile(aFilename, IStorage::TYPE_SAVE);
+
+	IDemoHeaderCache::CEntry Invalid;
+	mem_zero(&Invalid, sizeof(Invalid));
+	Invalid.m_Valid = false;
+
+	auto ExpectEntry = [](const IDemoHeaderCache::CEntry &Entry, const IDemoHeaderCache::CEntry &Expected) {
+		EXPECT_EQ(Entry.m_Valid, Expected.m_Valid);
+		EXPECT_EQ(mem_comp(&Entry.m_Info, &Expected.m_Info, sizeof(CDemoHeader)), 0);
+		EXPECT_EQ(mem_comp(&Entry.m_TimelineMarkers, &Expected.m_TimelineMarkers, sizeof(CTimelineMarkers)), 0);
+		EXPECT_STREQ(Entry.m_MapInfo.m_aName, Expected.m_MapInfo.m_aName);
+		EXPECT_EQ(Entry.m_MapInfo.m_Sha256, Expected.m_MapInfo.m_Sha256);
+		EXPECT_EQ(Entry.m_MapInfo.m_Crc, Expected.m_MapInfo.m_Crc);
+		EXPECT_EQ(Entry.m_MapInfo.m_Size, Expected.m_MapInfo.m_Size);
+	};
+
+	{
+		auto pCache = std::unique_ptr<IDemoHeaderCache>(CreateDemoHeaderCache(pConsole.get(), pStorage.get()));
+		IDemoHeaderCache::CEntry Entry;
+		EXPECT_FALSE(pCache->Get("/demos/a.demo", 100, 10, &Entry));
+		pCache->Set("/demos/a.demo", 100, 10, Demo);
+		pCache->Set("/demos/b.demo", 200, 20, Invalid);
+
+		// not written to the disk yet
+		ASSERT_TRUE(pCache->Get("/demos/a.demo", 100, 10, &Entry));
+		ExpectEntry(Entry, Demo);
+		EXPECT_FALSE(pCache->Get("/demos/a.demo", 101, 10, &Entry));
+		EXPECT_FALSE(pCache->Get("/demos/a.demo", 100, 11, &Entry));
+		pCache->Flush();
+		ASSERT_TRUE(pCache->Get("/demos/a.demo", 100, 10, &Entry));
+		ExpectEntry(Entry, Demo);
+	}
+
+	// a new cache reads the entries from the disk
+	{
+		auto pCache = std::unique_ptr<IDemoHeaderCache>(CreateDemoHeaderCache(pConsole.get(), pStorage.get()));
+		IDemoHeaderCache::CEntry Entry;
+		ASSERT_TRUE(pCache->Get("/demos/a.demo", 100, 10, &Entry));
+		ExpectEntry(Entry, Demo);
+		ASSERT_TRUE(pCache->Get("/demos/b.demo", 200, 20, &Entry));
+		ExpectEntry(Entry, Invalid);
+		EXPECT_FALSE(pCache->Get("/demos/a.demo", 100, 11, &Entry));
+		EXPECT_FALSE(pCache->Get("/demos/c.demo", 100, 10, &Entry));
+
+		// a modified demo replaces the old entry
+		pCache->Set("/demos/a.demo", 100, 11, Invalid);
+	}
+	{
+		auto pCache = std::unique_ptr<IDemoHeaderCache>(CreateDemoHeaderCache(pConsole.get(), pStorage.get()));
+		IDemoHeaderCache::CEntry Entry;
+		EXPECT_FALSE(pCache->Get("/demos/a.demo", 100, 10, &Entry));
+		ASSERT_TRUE(pCache->Get("/demos/a.demo", 100, 11, &Entry));
+		ExpectEntry(Entry, Invalid);
+	}
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <game/envelope.h>
+#include <game/mapitems.h>
+
+#include <chrono>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+class CTestEnvelopePoints : public IEnvelopePointAccess
+{
+public:
+	std::vector<CEnvPoint> m_vPoints;
+
+	void AddPoint(int Time, int Curvetype, float Value)
+	{
+		CEnvPoint Point;
+		Point.m_Time = Time;
+		Point.m_Curvetype = Curvetype;
+		for(auto &Channel : Point.m_aValues)
+			Channel = f2fx(Value);
+		m_vPoints.push_back(Point);
+	}
+
+	int NumPoints() const override { return m_vPoints.size(); }
+	const CEnvPoint *GetPoint(int Index) const override { return &m_vPoints[Index]; }
+	const CEnvPointBezier *GetBezier(int Index) const override { return nullptr; }
+};
+
+static float Eval(const CTestEnvelopePoints &Points, std::chrono::nanoseconds Time)
+{
+	ColorRGBA Result(-1.0f, -1.0f, -1.0f, -1.0f);
+	EvalEnvelope(&Points, Time, Result, 1);
+	return Result.r;
+}
+
+TEST(Envelope, Empty)
+{
+	CTestEnvelopePoints Points;
+	EXPECT_EQ(Eval(Points, 0ms), -1.0f);
+}
+
+TEST(Envelope, SinglePoint)
+{
+	CTestEnvelopePoints Points;
+	Points.AddPoint(0, CURVETYPE_LINEAR, 3.0f);
+	EXPECT_EQ(Eval(Points, 0ms), 3.0f);
+	EXPECT_EQ(Eval(Points, 1234ms), 3.0f);
+}
+
+TEST(Envelope, Linear)
+{
+	// the value is a tenth of the time in every segment
+	CTestEnvelopePoints Points;
+	for(int i = 0; i <= 100; i++)
+		Points.AddPoint(i * 10, CURVETYPE_LINEAR, i);
+
+	EXPECT_FLOAT_EQ(Eval(Points, 0ms), 0.0f);
+	EXPECT_FLOAT_EQ(Eval(Points, 5ms), 0.5f);
+	EXPECT_FLOAT_EQ(Eval(Points, 10ms), 1.0f);
+	EXPECT_FLOAT_EQ(Eval(Points, 333ms), 33.3f);
+	EXPECT_FLOAT_EQ(Eval(Points, 999ms), 99.9f);
+	// the envelope loops after the last point
+	EXPECT_FLOAT_EQ(Eval(Points, 1005ms), 0.5f);
+	EXPECT_FLOAT_EQ(Eval(Points, 2500ms), 50.0f);
+}
+
+TEST(Envelope, Curvetypes)
+{
+	CTestEnvelopePoints Points;
+	Points.AddPoint(0, CURVETYPE_STEP, 1.0f);
+	Points.AddPoint(100, CURVETYPE_SLOW, 2.0f);
+	Points.AddPoint(200, CURVETYPE_LINEAR, 3.0f);
+	Points.AddPoint(300, CURVETYPE_LINEAR, 1.0f);
+
+	EXPECT_FLOAT_EQ(Eval(Points, 50ms), 1.0f);
+	EXPECT_FLOAT_EQ(Eval(Points, 150ms), 2.125f);
+	EXPECT_FLOAT_EQ(Eval(Points, 250ms), 2.0f);
+}
+
+TEST(Envelope, FirstPointAfterStart)
+{
+	// before the first point the value of the last point is used
+	CTestEnvelopePoints Points;
+	Points.AddPoint(100, CURVETYPE_LINEAR, 1.0f);
+	Points.AddPoint(200, CURVETYPE_LINEAR, 2.0f);
+	EXPECT_FLOAT_EQ(Eval(Points, 50ms), 2.0f);
+	EXPECT_FLOAT_EQ(Eval(Points, 150ms), 1.5f);
+}
+
+TEST(Envelope, Cache)
+{
+	CEnvelopeEvalCache Cache;
+	ColorRGBA Result(0.0f, 0.0f, 0.0f, 0.0f);
+	EXPECT_FALSE(Cache.Find(1, 0, 4, Result));
+
+	Cache.Add(1, 0, 4, ColorRGBA(0.1f, 0.2f, 0.3f, 0.4f));
+	Cache.Add(1, 500, 4, ColorRGBA(0.5f, 0.6f, 0.7f, 0.8f));
+	Cache.Add(1, -500, 2, ColorRGBA(0.9f, 1.0f, 0.0f, 0.0f));
+	EXPECT_EQ(Cache.Size(), 3);
+
+	EXPECT_TRUE(Cache.Find(1, 0, 4, Result));
+	EXPECT_EQ(Result, ColorRGBA(0.1f, 0.2f, 0.3f, 0.4f));
+	EXPECT_TRUE(Cache.Find(1, 500, 4, Result));
+	EXPECT_EQ(Result, ColorRGBA(0.5f, 0.6f, 0.7f, 0.8f));
+
+	// only the cached channels are written
+	Result = ColorRGBA(0.0f, 0.0f, 0.0f, 0.0f);
+	EXPECT_TRUE(Cache.Find(1, -500, 2, Result));
+	EXPECT_EQ(Result, ColorRGBA(0.9f, 1.0f, 0.0f, 0.0f));
+
+	EXPECT_FALSE(Cache.Find(2, 0, 4, Result));
+	EXPECT_FALSE(Cache.Find(1, 0, 3, Result));
+
+	Cache.Clear();
+	EXPECT_EQ(Cache.Size(), 0);
+	EXPECT_FALSE(Cache.Find(1, 0, 4, Result));
+}
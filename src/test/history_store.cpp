@@ -0,0 +1,186 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <game/editor/history_store.h>
+#include <game/mapitems.h>
+
+#include <tuple>
+
+struct STestTileChange
+{
+	bool m_Changed;
+	CTile m_Previous;
+	CTile m_Current;
+};
+
+static std::vector<unsigned char> RandomData(size_t Size)
+{
+	std::vector<unsigned char> vData(Size);
+	secure_random_fill(vData.data(), vData.size());
+	return vData;
+}
+
+TEST(HistoryStore, TileChanges)
+{
+	std::map<int, std::map<int, STestTileChange>> Changes;
+	// a rectangle, a line and some single tiles
+	for(int y = 3; y < 10; y++)
+		for(int x = 5; x < 20; x++)
+			Changes[y][x] = {true, {1, 0, 0, 0}, {(unsigned char)x, (unsigned char)y, 0, 0}};
+	for(int x = 0; x < 300; x++)
+		Changes[1000][x] = {true, {0, 0, 0, 0}, {1, TILEFLAG_XFLIP, 0, 0}};
+	Changes[0][0] = {true, {5, 0, 0, 0}, {6, 0, 0, 0}};
+	Changes[2000][1] = {true, {7, 0, 0, 0}, {8, 0, 0, 0}};
+	Changes[2001][0] = {true, {9, 0, 0, 0}, {10, 0, 0, 0}};
+
+	const std::vector<unsigned char> vData = PackTileChanges(Changes);
+	std::vector<std::tuple<int, int, int, int>> vExpected;
+	for(const auto &[y, Line] : Changes)
+		for(const auto &[x, Change] : Line)
+			vExpected.emplace_back(x, y, Change.m_Previous.m_Index, Change.m_Current.m_Index | Change.m_Current.m_Flags << 8);
+	std::vector<std::tuple<int, int, int, int>> vUnpacked;
+	ForEachTileChange<STestTileChange>(vData, [&](int x, int y, const STestTileChange &Change) {
+		vUnpacked.emplace_back(x, y, Change.m_Previous.m_Index, Change.m_Current.m_Index | Change.m_Current.m_Flags << 8);
+	});
+	EXPECT_EQ(NumTileChanges(Changes), (int)vExpected.size());
+	EXPECT_EQ(vUnpacked, vExpected);
+
+	// truncated data is ignored
+	std::vector<unsigned char> vTruncated(vData.begin(), vData.end() - 1);
+	int NumCalls = 0;
+	ForEachTileChange<STestTileChange>(vTruncated, [&](int x, int y, const STestTileChange &Change) { NumCalls++; });
+	EXPECT_EQ(NumCalls, 0);
+}
+
+TEST(HistoryStore, Compressed)
+{
+	CTestInfo Info;
+	CHistoryStore Store;
+	Store.Init(Info.m_aFilename, 1024 * 1024);
+
+	std::vector<unsigned char> vData(100000, 0x42);
+	const int Id = Store.Add(vData);
+	EXPECT_LT(Store.MemoryUsage(), vData.size() / 10);
+	EXPECT_EQ(Store.SpilledSize(), 0u);
+	EXPECT_FALSE(fs_is_file(Info.m_aFilename));
+
+	std::vector<unsigned char> vResult;
+	ASSERT_TRUE(Store.Get(Id, vResult));
+	EXPECT_EQ(vResult, vData);
+	EXPECT_FALSE(Store.Get(Id + 1, vResult));
+
+	Store.Remove(Id);
+	EXPECT_EQ(Store.NumEntries(), 0u);
+	EXPECT_EQ(Store.MemoryUsage(), 0u);
+}
+
+TEST(HistoryStore, Spill)
+{
+	CTestInfo Info;
+	CHistoryStore Store;
+	Store.Init(Info.m_aFilename, 4000);
+
+	// random data doesn't compress, so only the newest entries fit
+	std::vector<std::vector<unsigned char>> vvData;
+	std::vector<int> vIds;
+	for(int i = 0; i < 20; i++)
+	{
+		vvData.push_back(RandomData(1000));
+		vIds.push_back(Store.Add(vvData.back()));
+		EXPECT_LE(Store.MemoryUsage(), 4000u);
+	}
+	EXPECT_GT(Store.SpilledSize(), 10000u);
+	EXPECT_TRUE(fs_is_file(Info.m_aFilename));
+
+	std::vector<unsigned char> vResult;
+	for(int i = 0; i < 20; i++)
+	{
+		ASSERT_TRUE(Store.Get(vIds[i], vResult));
+		EXPECT_EQ(vResult, vvData[i]);
+	}
+
+	// a smaller limit spills the remaining entries, the newest entries can
+	// be read right after they were spilled
+	Store.SetMemoryLimit(0);
+	EXPECT_EQ(Store.MemoryUsage(), 0u);
+	ASSERT_TRUE(Store.Get(vIds.back(), vResult));
+	EXPECT_EQ(vResult, vvData.back());
+
+	vvData.push_back(RandomData(1000));
+	vIds.push_back(Store.Add(vvData.back()));
+	ASSERT_TRUE(Store.Get(vIds.back(), vResult));
+	EXPECT_EQ(vResult, vvData.back());
+
+	// the file is deleted once no entry is in it anymore
+	for(int i = 0; i < (int)vIds.size() - 1; i++)
+		Store.Remove(vIds[i]);
+	EXPECT_TRUE(fs_is_file(Info.m_aFilename));
+	Store.Remove(vIds.back());
+	EXPECT_EQ(Store.SpilledSize(), 0u);
+	EXPECT_FALSE(fs_is_file(Info.m_aFilename));
+
+	// and created again when it is needed
+	Store.SetMemoryLimit(1000);
+	vvData.push_back(RandomData(2000));
+	vIds.push_back(Store.Add(vvData.back()));
+	EXPECT_TRUE(fs_is_file(Info.m_aFilename));
+	ASSERT_TRUE(Store.Get(vIds.back(), vResult));
+	EXPECT_EQ(vResult, vvData.back());
+}
+
+TEST(HistoryStore, DeletedOnDestruction)
+{
+	CTestInfo Info;
+	{
+		CHistoryStore Store;
+		Store.Init(Info.m_aFilename, 0);
+		Store.Add(RandomData(100));
+		EXPECT_TRUE(fs_is_file(Info.m_aFilename));
+	}
+	EXPECT_FALSE(fs_is_file(Info.m_aFilename));
+}
+
+TEST(HistoryStore, SpillCompacted)
+{
+	CTestInfo Info;
+	CHistoryStore Store;
+	Store.Init(Info.m_aFilename, 0);
+
+	std::vector<std::vector<unsigned char>> vvData;
+	std::vector<int> vIds;
+	for(int i = 0; i < 60; i++)
+	{
+		vvData.push_back(RandomData(50000));
+		vIds.push_back(Store.Add(vvData.back()));
+	}
+	const int64_t FullSize = Store.SpillFileSize();
+	EXPECT_GE(FullSize, 60 * 50000);
+
+	// removing the oldest entries like a full history does shrinks the file
+	// once most of it belongs to removed entries
+	for(int i = 0; i < 40; i++)
+		Store.Remove(vIds[i]);
+	EXPECT_LT(Store.SpillFileSize(), FullSize / 2);
+	EXPECT_GE(Store.SpillFileSize(), (int64_t)Store.SpilledSize());
+
+	std::vector<unsigned char> vResult;
+	for(int i = 40; i < 60; i++)
+	{
+		ASSERT_TRUE(Store.Get(vIds[i], vResult));
+		EXPECT_EQ(vResult, vvData[i]);
+	}
+
+	// entries spilled after the compaction are appended to the new file
+	vvData.push_back(RandomData(50000));
+	vIds.push_back(Store.Add(vvData.back()));
+	for(int i = 40; i < 61; i++)
+	{
+		ASSERT_TRUE(Store.Get(vIds[i], vResult));
+		EXPECT_EQ(vResult, vvData[i]);
+	}
+	for(int i = 40; i < 61; i++)
+		Store.Remove(vIds[i]);
+	EXPECT_FALSE(fs_is_file(Info.m_aFilename));
+}
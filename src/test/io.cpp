@@ -167,3 +167,68 @@ TEST(Io, WriteTruncatesFile)
 
 	EXPECT_FALSE(fs_remove(Info.m_aFilename));
 }
+
+TEST(Io, Map)
+{
+	CTestInfo Info;
+
+	IOHANDLE File = io_open(Info.m_aFilename, IOFLAG_WRITE);
+	ASSERT_TRUE(File);
+	EXPECT_FALSE(io_close(File));
+
+	unsigned Size;
+	File = io_open(Info.m_aFilename, IOFLAG_READ);
+	ASSERT_TRUE(File);
+	EXPECT_FALSE(io_map(File, &Size));
+	EXPECT_EQ(Size, 0);
+	EXPECT_FALSE(io_close(File));
+
+	File = io_open(Info.m_aFilename, IOFLAG_WRITE);
+	ASSERT_TRUE(File);
+	EXPECT_EQ(io_write(File, "0123456789", 10), 10);
+	EXPECT_FALSE(io_close(File));
+
+	File = io_open(Info.m_aFilename, IOFLAG_READ);
+	ASSERT_TRUE(File);
+	const void *pData = io_map(File, &Size);
+	EXPECT_FALSE(io_close(File));
+	ASSERT_TRUE(pData);
+	EXPECT_EQ(Size, 10);
+	// the mapping outlives the file handle
+	EXPECT_TRUE(mem_comp(pData, "0123456789", 10) == 0);
+	io_unmap(pData, Size);
+
+	EXPECT_FALSE(fs_remove(Info.m_aFilename));
+}
+
+// Windows does not allow truncating a mapped file
+#if !defined(CONF_FAMILY_WINDOWS)
+TEST(Io, MapTruncated)
+{
+	CTestInfo Info;
+
+	IOHANDLE File = io_open(Info.m_aFilename, IOFLAG_WRITE);
+	ASSERT_TRUE(File);
+	EXPECT_EQ(io_write(File, "0123456789", 10), 10);
+	EXPECT_FALSE(io_close(File));
+
+	unsigned Size;
+	IOHANDLE MappedFile = io_open(Info.m_aFilename, IOFLAG_READ);
+	ASSERT_TRUE(MappedFile);
+	const void *pData = io_map(MappedFile, &Size);
+	ASSERT_TRUE(pData);
+
+	// overwriting the file in place truncates it, the handle of the mapped
+	// file sees the new length before the missing pages are read
+	File = io_open(Info.m_aFilename, IOFLAG_WRITE);
+	ASSERT_TRUE(File);
+	EXPECT_EQ(io_write(File, "abcd", 4), 4);
+	EXPECT_FALSE(io_close(File));
+	EXPECT_EQ(io_length(MappedFile), 4);
+	EXPECT_TRUE(mem_comp(pData, "abcd", 4) == 0);
+
+	io_unmap(pData, Size);
+	EXPECT_FALSE(io_close(MappedFile));
+	EXPECT_FALSE(fs_remove(Info.m_aFilename));
+}
+#endif
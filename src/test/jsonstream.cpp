@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <engine/external/json-parser/json.h>
+#include <engine/shared/jsonstream.h>
+
+#include <random>
+#include <string>
+
+// Records the events as a compact string, e.g. `{k(a)n(1)}`.
+class CJsonRecorder : public IJsonStreamHandler
+{
+public:
+	std::string m_Events;
+	int m_StopAfter = -1;
+
+	bool OnJsonEvent(EJsonEvent Event, const char *pValue, size_t ValueLength, uint64_t Offset) override
+	{
+		switch(Event)
+		{
+		case EJsonEvent::BEGIN_OBJECT: m_Events += "{"; break;
+		case EJsonEvent::END_OBJECT: m_Events += "}"; break;
+		case EJsonEvent::BEGIN_ARRAY: m_Events += "["; break;
+		case EJsonEvent::END_ARRAY: m_Events += "]"; break;
+		case EJsonEvent::KEY: m_Events += "k(" + std::string(pValue, ValueLength) + ")"; break;
+		case EJsonEvent::STRING: m_Events += "s(" + std::string(pValue, ValueLength) + ")"; break;
+		case EJsonEvent::NUMBER: m_Events += "n(" + std::string(pValue, ValueLength) + ")"; break;
+		case EJsonEvent::BOOL_TRUE: m_Events += "t"; break;
+		case EJsonEvent::BOOL_FALSE: m_Events += "f"; break;
+		case EJsonEvent::NULL_VALUE: m_Events += "0"; break;
+		}
+		return m_StopAfter < 0 || --m_StopAfter > 0;
+	}
+};
+
+static bool ParseWhole(const std::string &Json, std::string *pEvents = nullptr)
+{
+	CJsonRecorder Recorder;
+	CJsonStreamParser Parser(&Recorder);
+	const bool Result = Parser.Feed(Json.data(), Json.size()) && Parser.Finish();
+	if(pEvents)
+		*pEvents = Recorder.m_Events;
+	return Result;
+}
+
+TEST(JsonStream, Events)
+{
+	std::string Events;
+	EXPECT_TRUE(ParseWhole(R"({"a": [1, -2.5e3, "x", true, false, null], "b": {}})", &Events));
+	EXPECT_EQ(Events, "{k(a)[n(1)n(-2.5e3)s(x)tf0]k(b){}}");
+	EXPECT_TRUE(ParseWhole(" \t\r\n[ ] \n", &Events));
+	EXPECT_EQ(Events, "[]");
+	EXPECT_TRUE(ParseWhole("42", &Events));
+	EXPECT_EQ(Events, "n(42)");
+	EXPECT_TRUE(ParseWhole(R"("\"\\\/\b\f\n\r\t")", &Events));
+	EXPECT_EQ(Events, "s(\"\\/\b\f\n\r\t)");
+}
+
+TEST(JsonStream, Unicode)
+{
+	std::string Events;
+	EXPECT_TRUE(ParseWhole(R"("\u00e4\u611B")", &Events));
+	EXPECT_EQ(Events, "s(ä愛)");
+	EXPECT_TRUE(ParseWhole(R"("\ud83d\ude02")", &Events));
+	EXPECT_EQ(Events, "s(😂)");
+	EXPECT_TRUE(ParseWhole("\"😂\"", &Events));
+	EXPECT_EQ(Events, "s(😂)");
+	EXPECT_FALSE(ParseWhole(R"("\ud83dx\ude02")"));
+	EXPECT_FALSE(ParseWhole(R"("\ud83d")"));
+	EXPECT_FALSE(ParseWhole(R"("\ud83d\n")"));
+	EXPECT_FALSE(ParseWhole(R"("\ud83d\u0041")"));
+	EXPECT_FALSE(ParseWhole(R"("\ude02")"));
+	EXPECT_TRUE(ParseWhole(R"("\u0000")", &Events));
+	EXPECT_EQ(Events, std::string("s(\0)", 4));
+}
+
+TEST(JsonStream, Malformed)
+{
+	const char *apMalformed[] = {
+		"",
+		" ",
+		"{",
+		"[1,]",
+		"[1 2]",
+		"{\"a\"}",
+		"{\"a\":}",
+		"{\"a\":1,}",
+		"{1:2}",
+		"[}",
+		"{]",
+		"]",
+		"[1]]",
+		"[1] 2",
+		"01",
+		"-",
+		"1.",
+		".5",
+		"1e",
+		"1e+",
+		"+1",
+		"tru",
+		"nul",
+		"True",
+		"\"abc",
+		"\"\\x\"",
+		"\"\\u12g4\"",
+		"\"a\nb\"",
+		"'a'",
+	};
+	for(const char *pMalformed : apMalformed)
+	{
+		EXPECT_FALSE(ParseWhole(pMalformed)) << pMalformed;
+	}
+}
+
+TEST(JsonStream, MaxDepth)
+{
+	CJsonRecorder Recorder;
+	CJsonStreamParser Parser(&Recorder, 3);
+	EXPECT_TRUE(Parser.Feed("[[[]]]", 6));
+	EXPECT_TRUE(Parser.Finish());
+
+	CJsonStreamParser TooDeep(&Recorder, 3);
+	EXPECT_FALSE(TooDeep.Feed("[[[[]]]]", 8));
+	EXPECT_TRUE(TooDeep.Failed());
+	EXPECT_FALSE(TooDeep.Finish());
+}
+
+TEST(JsonStream, HandlerStops)
+{
+	CJsonRecorder Recorder;
+	Recorder.m_StopAfter = 2;
+	CJsonStreamParser Parser(&Recorder);
+	EXPECT_FALSE(Parser.Feed("[1, 2, 3]", 9));
+	EXPECT_EQ(Recorder.m_Events, "[n(1)");
+	EXPECT_TRUE(Parser.Failed());
+}
+
+TEST(JsonStream, Offsets)
+{
+	class COffsets : public IJsonStreamHandler
+	{
+	public:
+		std::vector<uint64_t> m_vOffsets;
+		bool OnJsonEvent(EJsonEvent Event, const char *pValue, size_t ValueLength, uint64_t Offset) override
+		{
+			m_vOffsets.push_back(Offset);
+			return true;
+		}
+	} Offsets;
+	CJsonStreamParser Parser(&Offsets);
+	const char *pJson = R"({"ab": [12, null]})";
+	EXPECT_TRUE(Parser.Feed(pJson, str_length(pJson)));
+	EXPECT_TRUE(Parser.Finish());
+	EXPECT_EQ(Offsets.m_vOffsets, (std::vector<uint64_t>{0, 1, 7, 8, 12, 16, 17}));
+}
+
+TEST(JsonStream, Split)
+{
+	const std::string Json = R"({"name": "a\"b\u00e4\ud83d\ude02", "n": [-1.25e+10, 0, true, false, null, {}, []]})";
+	std::string Expected;
+	ASSERT_TRUE(ParseWhole(Json, &Expected));
+	for(size_t First = 0; First <= Json.size(); First++)
+	{
+		for(size_t Second = First; Second <= Json.size(); Second++)
+		{
+			CJsonRecorder Recorder;
+			CJsonStreamParser Parser(&Recorder);
+			EXPECT_TRUE(Parser.Feed(Json.data(), First));
+			EXPECT_TRUE(Parser.Feed(Json.data() + First, Second - First));
+			EXPECT_TRUE(Parser.Feed(Json.data() + Second, Json.size() - Second));
+			EXPECT_TRUE(Parser.Finish());
+			EXPECT_EQ(Recorder.m_Events, Expected) << First << " " << Second;
+		}
+	}
+}
+
+// Mutates valid documents randomly. The result must not depend on how the
+// input is split, and everything that is accepted must be accepted by the DOM
+// parser as well. The DOM parser is more lenient, e.g. about unknown escape
+// sequences, so the other direction doesn't hold.
+TEST(JsonStream, Fuzz)
+{
+	const char *apSeeds[] = {
+		R"({"servers": [{"addresses": ["tw-0.6+udp://1.2.3.4:8303"], "location": "eu", "info": {"name": "a\"b", "map": {"name": "x"}, "clients": [{"score": -1, "is_player": true}]}}]})",
+		R"([1, -2.5e3, 0.5, "\u00e4\ud83d\ude02", true, false, null, {}, [[]]])",
+		R"({"a": {"b": {"c": [0, 1E+2, -0.0e-1]}}, "": "", "n": null})",
+	};
+	const char aAlphabet[] = "{}[]:,\" \\/0123456789abcdefu-+.eEtrlsn\x01\x7f";
+
+	std::mt19937 Rng(1);
+	int NumAccepted = 0;
+	for(int Iteration = 0; Iteration < 30000; Iteration++)
+	{
+		std::string Json = apSeeds[Iteration % std::size(apSeeds)];
+		const int NumMutations = 1 + Rng() % 3;
+		for(int i = 0; i < NumMutations; i++)
+		{
+			const size_t Pos = Rng() % (Json.size() + 1);
+			const char c = aAlphabet[Rng() % (sizeof(aAlphabet) - 1)];
+			switch(Rng() % 3)
+			{
+			case 0:
+				Json.insert(Json.begin() + Pos, c);
+				break;
+			case 1:
+				if(Pos < Json.size())
+					Json.erase(Json.begin() + Pos);
+				break;
+			case 2:
+				if(Pos < Json.size())
+					Json[Pos] = c;
+				break;
+			}
+		}
+
+		std::string Expected;
+		const bool ExpectedResult = ParseWhole(Json, &Expected);
+		if(ExpectedResult)
+		{
+			NumAccepted++;
+			json_value *pJson = json_parse(Json.data(), Json.size());
+			EXPECT_NE(pJson, nullptr) << Json;
+			json_value_free(pJson);
+		}
+
+		CJsonRecorder Recorder;
+		CJsonStreamParser Parser(&Recorder);
+		const size_t Split = Rng() % (Json.size() + 1);
+		bool Result = Parser.Feed(Json.data(), Split);
+		Result = Parser.Feed(Json.data() + Split, Json.size() - Split) && Result;
+		Result = Parser.Finish() && Result;
+		EXPECT_EQ(Result, ExpectedResult) << Json << " " << Parser.Error();
+		EXPECT_EQ(Result, !Parser.Failed());
+		EXPECT_EQ(Recorder.m_Events, Expected) << Json;
+	}
+	// make sure that the mutations leave enough valid documents
+	EXPECT_GT(NumAccepted, 1000);
+}
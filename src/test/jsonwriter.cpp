@@ -210,3 +210,15 @@ TYPED_TEST(JsonWriters, Small)
 	this->Impl.m_pJson->WriteIntValue(std::numeric_limits<int>::min());
 	this->Impl.Expect("-2147483648\n");
 }
+
+TYPED_TEST(JsonWriters, Large64)
+{
+	this->Impl.m_pJson->WriteInt64Value(std::numeric_limits<int64_t>::max());
+	this->Impl.Expect("9223372036854775807\n");
+}
+
+TYPED_TEST(JsonWriters, Small64)
+{
+	this->Impl.m_pJson->WriteInt64Value(std::numeric_limits<int64_t>::min());
+	this->Impl.Expect("-9223372036854775808\n");
+}
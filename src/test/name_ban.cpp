@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
 
+#include <base/system.h>
+
 #include <engine/server/name_ban.h>
 
+#include <algorithm>
+
 TEST(NameBan, Empty)
 {
 	CNameBans Bans;
@@ -78,3 +82,93 @@ TEST(NameBan, UnbanNotFound)
 	CNameBans Bans;
 	Bans.Unban("abc");
 }
+
+TEST(NameBan, LastBanTakesPrecedence)
+{
+	CNameBans Bans;
+	Bans.Ban("abc", "first", 1, false);
+	Bans.Ban("bc", "second", 0, true);
+	Bans.Ban("abd", "third", 1, false);
+	const CNameBan *pBan = Bans.IsBanned("abc");
+	ASSERT_TRUE(pBan);
+	EXPECT_STREQ(pBan->m_aReason, "third");
+	pBan = Bans.IsBanned("xbc");
+	ASSERT_TRUE(pBan);
+	EXPECT_STREQ(pBan->m_aReason, "second");
+	pBan = Bans.IsBanned("xxbcxx");
+	ASSERT_TRUE(pBan);
+	EXPECT_STREQ(pBan->m_aReason, "second");
+}
+
+TEST(NameBan, MatchesBruteForce)
+{
+	// compare the ban index against checking every ban
+	static const char *const s_apParts[] = {"a", "b", "rn", "m", "l", "I", "ä", "Ö", "ö", " ", "xy"};
+	unsigned Seed = 1337;
+	auto Random = [&Seed](unsigned Max) {
+		Seed = Seed * 1103515245 + 12345;
+		return (Seed >> 16) % Max;
+	};
+	auto RandomName = [&](char *pBuf, int BufSize) {
+		pBuf[0] = '\0';
+		const int NumParts = Random(6);
+		for(int i = 0; i < NumParts; i++)
+			str_append(pBuf, s_apParts[Random(std::size(s_apParts))], BufSize);
+	};
+
+	struct SBan
+	{
+		char m_aName[MAX_NAME_LENGTH];
+		int m_Distance;
+		bool m_IsSubstring;
+	};
+	std::vector<SBan> vBans;
+	CNameBans Bans;
+	for(int i = 0; i < 200; i++)
+	{
+		SBan Ban;
+		RandomName(Ban.m_aName, sizeof(Ban.m_aName));
+		Ban.m_Distance = (int)Random(4) - 1;
+		Ban.m_IsSubstring = Random(4) == 0;
+		auto Existing = std::find_if(vBans.begin(), vBans.end(), [&](const SBan &Other) { return str_comp(Other.m_aName, Ban.m_aName) == 0; });
+		if(Existing != vBans.end())
+			*Existing = Ban;
+		else
+			vBans.push_back(Ban);
+		Bans.Ban(Ban.m_aName, "", Ban.m_Distance, Ban.m_IsSubstring);
+	}
+
+	int aBuffer[MAX_NAME_SKELETON_LENGTH * 2 + 2];
+	for(int i = 0; i < 500; i++)
+	{
+		char aName[MAX_NAME_LENGTH];
+		RandomName(aName, sizeof(aName));
+
+		char aTrimmed[MAX_NAME_LENGTH];
+		str_copy(aTrimmed, str_utf8_skip_whitespaces(aName));
+		str_utf8_trim_right(aTrimmed);
+		int aSkeleton[MAX_NAME_SKELETON_LENGTH];
+		const int SkeletonLength = str_utf8_to_skeleton(aTrimmed, aSkeleton, std::size(aSkeleton));
+
+		const SBan *pExpected = nullptr;
+		for(const SBan &Ban : vBans)
+		{
+			int aBanSkeleton[MAX_NAME_SKELETON_LENGTH];
+			const int BanSkeletonLength = str_utf8_to_skeleton(Ban.m_aName, aBanSkeleton, std::size(aBanSkeleton));
+			const int Distance = str_utf32_dist_buffer(aSkeleton, SkeletonLength, aBanSkeleton, BanSkeletonLength, aBuffer, std::size(aBuffer));
+			if(Distance <= Ban.m_Distance || (Ban.m_IsSubstring && str_utf8_find_nocase(aName, Ban.m_aName)))
+				pExpected = &Ban;
+		}
+
+		const CNameBan *pBan = Bans.IsBanned(aName);
+		if(pExpected == nullptr)
+		{
+			EXPECT_FALSE(pBan) << "Name='" << aName << "'";
+		}
+		else
+		{
+			ASSERT_TRUE(pBan) << "Name='" << aName << "'";
+			EXPECT_STREQ(pBan->m_aName, pExpected->m_aName) << "Name='" << aName << "'";
+		}
+	}
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <engine/console.h>
+#include <engine/shared/config.h>
+#include <engine/shared/netban.h>
+
+#include <memory>
+#include <utility>
+
+class CTestNetBan : public CNetBan
+{
+public:
+	// the hash chain lookup the range table replaces
+	bool IsBannedHashed(const NETADDR *pAddr, char *pBuf, unsigned BufferSize) const
+	{
+		CNetHash aHash[17];
+		int Length = CNetHash::MakeHashArray(pAddr, aHash);
+
+		CBanAddr *pBan = m_BanAddrPool.Find(pAddr, &aHash[Length]);
+		if(pBan)
+		{
+			MakeBanInfo(pBan, pBuf, BufferSize, MSGTYPE_PLAYER);
+			return true;
+		}
+
+		for(int i = Length - 1; i >= 0; --i)
+		{
+			for(CBanRange *pBanRange = m_BanRangePool.First(&aHash[i]); pBanRange; pBanRange = pBanRange->m_pHashNext)
+			{
+				if(NetMatch(&pBanRange->m_Data, pAddr, i, Length))
+				{
+					MakeBanInfo(pBanRange, pBuf, BufferSize, MSGTYPE_PLAYER);
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+};
+
+static NETADDR Addr(const char *pStr)
+{
+	NETADDR Addr;
+	EXPECT_FALSE(net_addr_from_str(&Addr, pStr));
+	return Addr;
+}
+
+static CNetRange Range(const char *pLB, const char *pUB)
+{
+	CNetRange Range;
+	Range.m_LB = Addr(pLB);
+	Range.m_UB = Addr(pUB);
+	return Range;
+}
+
+TEST(NetBan, Range)
+{
+	auto pConsole = CreateConsole(CFGFLAG_SERVER);
+	CTestNetBan Ban;
+	Ban.Init(pConsole.get(), nullptr);
+
+	const CNetRange Range4 = Range("10.0.0.5", "10.0.1.17");
+	const CNetRange Range6 = Range("[2001:db8::ff]", "[2001:db8::1:0]");
+	EXPECT_EQ(Ban.BanRange(&Range4, 0, "v4"), 0);
+	EXPECT_EQ(Ban.BanRange(&Range6, 0, "v6"), 0);
+
+	char aBuf[256];
+	EXPECT_TRUE(Ban.IsBanned(&Range4.m_LB, aBuf, sizeof(aBuf)));
+	EXPECT_STREQ(aBuf, "You have been banned (v4)");
+	NETADDR Inside = Addr("10.0.0.200:8303");
+	EXPECT_TRUE(Ban.IsBanned(&Inside, aBuf, sizeof(aBuf)));
+	NETADDR Outside = Addr("10.0.0.4");
+	EXPECT_FALSE(Ban.IsBanned(&Outside, aBuf, sizeof(aBuf)));
+	Outside = Addr("10.0.1.18");
+	EXPECT_FALSE(Ban.IsBanned(&Outside, aBuf, sizeof(aBuf)));
+
+	EXPECT_TRUE(Ban.IsBanned(&Range6.m_UB, aBuf, sizeof(aBuf)));
+	EXPECT_STREQ(aBuf, "You have been banned (v6)");
+	Outside = Addr("[2001:db8::1:1]");
+	EXPECT_FALSE(Ban.IsBanned(&Outside, aBuf, sizeof(aBuf)));
+
+	// the same bytes with a different address type are not banned
+	Outside = Addr("[a00:5::]");
+	EXPECT_FALSE(Ban.IsBanned(&Outside, aBuf, sizeof(aBuf)));
+
+	NETADDR WebSocket = Inside;
+	WebSocket.type = NETTYPE_WEBSOCKET_IPV4;
+	EXPECT_TRUE(Ban.IsBanned(&WebSocket, aBuf, sizeof(aBuf)));
+}
+
+TEST(NetBan, NegativeCacheInvalidation)
+{
+	auto pConsole = CreateConsole(CFGFLAG_SERVER);
+	CTestNetBan Ban;
+	Ban.Init(pConsole.get(), nullptr);
+
+	char aBuf[256];
+	NETADDR Target = Addr("192.0.2.7");
+	EXPECT_FALSE(Ban.IsBanned(&Target, aBuf, sizeof(aBuf)));
+	EXPECT_FALSE(Ban.IsBanned(&Target, aBuf, sizeof(aBuf)));
+
+	const CNetRange Range4 = Range("192.0.2.0", "192.0.2.255");
+	EXPECT_EQ(Ban.BanRange(&Range4, 0, "range"), 0);
+	EXPECT_TRUE(Ban.IsBanned(&Target, aBuf, sizeof(aBuf)));
+	EXPECT_EQ(Ban.UnbanByRange(&Range4), 0);
+	EXPECT_FALSE(Ban.IsBanned(&Target, aBuf, sizeof(aBuf)));
+
+	EXPECT_EQ(Ban.BanAddr(&Target, 0, "addr", false), 0);
+	EXPECT_TRUE(Ban.IsBanned(&Target, aBuf, sizeof(aBuf)));
+	Ban.UnbanAll();
+	EXPECT_FALSE(Ban.IsBanned(&Target, aBuf, sizeof(aBuf)));
+}
+
+TEST(NetBan, MatchesHashLookup)
+{
+	// compare the range table against the hash chain lookup, including which ban is reported
+	auto pConsole = CreateConsole(CFGFLAG_SERVER);
+	CTestNetBan Ban;
+	Ban.Init(pConsole.get(), nullptr);
+
+	unsigned Seed = 1337;
+	auto Random = [&Seed](unsigned Max) {
+		Seed = Seed * 1103515245 + 12345;
+		return (Seed >> 16) % Max;
+	};
+	// keep the addresses in a small space so that ranges overlap a lot
+	auto RandomAddr = [&](NETADDR *pAddr, int Type) {
+		mem_zero(pAddr, sizeof(*pAddr));
+		pAddr->type = Type;
+		if(Type == NETTYPE_IPV4)
+		{
+			pAddr->ip[0] = 10;
+			pAddr->ip[1] = Random(2);
+			pAddr->ip[2] = Random(4);
+			pAddr->ip[3] = Random(256);
+		}
+		else
+		{
+			pAddr->ip[0] = 0x20;
+			pAddr->ip[1] = 0x01;
+			pAddr->ip[2] = 0x0d;
+			pAddr->ip[3] = 0xb8;
+			pAddr->ip[7] = Random(2);
+			pAddr->ip[14] = Random(4);
+			pAddr->ip[15] = Random(256);
+		}
+	};
+
+	char aReason[32];
+	for(int i = 0; i < 300; i++)
+	{
+		const int Type = Random(2) ? NETTYPE_IPV4 : NETTYPE_IPV6;
+		str_format(aReason, sizeof(aReason), "ban %d", i);
+		if(Random(4) == 0)
+		{
+			NETADDR BanAddr;
+			RandomAddr(&BanAddr, Type);
+			Ban.BanAddr(&BanAddr, 0, aReason, false);
+			continue;
+		}
+		CNetRange BanRange;
+		RandomAddr(&BanRange.m_LB, Type);
+		RandomAddr(&BanRange.m_UB, Type);
+		if(NetComp(&BanRange.m_UB, &BanRange.m_LB) < 0)
+			std::swap(BanRange.m_LB, BanRange.m_UB);
+		Ban.BanRange(&BanRange, 0, aReason);
+
+		if(Random(8) == 0)
+			Ban.UnbanByIndex(Random(i + 1));
+
+		for(int j = 0; j < 50; j++)
+		{
+			NETADDR Check;
+			RandomAddr(&Check, Random(2) ? NETTYPE_IPV4 : NETTYPE_IPV6);
+			char aBuf[256] = "";
+			char aExpected[256] = "";
+			const bool Expected = Ban.IsBannedHashed(&Check, aExpected, sizeof(aExpected));
+			ASSERT_EQ(Ban.IsBanned(&Check, aBuf, sizeof(aBuf)), Expected);
+			EXPECT_STREQ(aBuf, aExpected);
+		}
+	}
+}
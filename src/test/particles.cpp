@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <game/client/particle_store.h>
+#include <game/collision.h>
+
+#include <vector>
+
+static CParticle MakeParticle(float LifeSpan, int Spr)
+{
+	CParticle Particle;
+	Particle.SetDefault();
+	Particle.m_LifeSpan = LifeSpan;
+	Particle.m_Spr = Spr;
+	return Particle;
+}
+
+TEST(Particles, Compaction)
+{
+	CParticleStore Store;
+	const float aLifeSpans[] = {1.0f, 0.1f, 2.0f, 0.1f, 0.1f, 3.0f};
+	for(int i = 0; i < (int)std::size(aLifeSpans); i++)
+		Store.Add(MakeParticle(aLifeSpans[i], i), 0.0f);
+	ASSERT_EQ(Store.Size(), 6);
+
+	Store.Update(0.5f, 0, nullptr);
+	EXPECT_EQ(Store.m_vSpr, (std::vector<int>{0, 2, 5}));
+	for(int i = 0; i < Store.Size(); i++)
+		EXPECT_EQ(Store.m_vLife[i], 0.5f);
+
+	Store.Update(1.0f, 0, nullptr);
+	EXPECT_EQ(Store.m_vSpr, (std::vector<int>{2, 5}));
+	Store.Update(1.0f, 0, nullptr);
+	EXPECT_EQ(Store.m_vSpr, (std::vector<int>{5}));
+
+	Store.Clear();
+	EXPECT_EQ(Store.Size(), 0);
+}
+
+TEST(Particles, Update)
+{
+	// the update must give the same results as moving every particle on its own
+	CCollision Collision;
+	CParticleStore Store;
+	std::vector<CParticle> vReference;
+	for(int i = 0; i < 100; i++)
+	{
+		CParticle Particle = MakeParticle(10.0f, 0);
+		Particle.m_Pos = vec2(i * 3.0f, i * -2.0f);
+		Particle.m_Vel = vec2(i * 7.0f - 300.0f, 50.0f - i);
+		Particle.m_Gravity = i * 10.0f;
+		Particle.m_Friction = 0.5f + i / 250.0f;
+		Particle.m_Rotspeed = i / 10.0f;
+		Particle.m_Collides = i % 3 == 0;
+		Store.Add(Particle, 0.0f);
+		vReference.push_back(Particle);
+	}
+
+	const float aTimes[] = {0.016f, 0.1f, 0.0333f};
+	const int aFrictionCounts[] = {0, 2, 1};
+	for(int Step = 0; Step < (int)std::size(aTimes); Step++)
+	{
+		const float TimePassed = aTimes[Step];
+		Store.Update(TimePassed, aFrictionCounts[Step], &Collision);
+		for(CParticle &Particle : vReference)
+		{
+			Particle.m_Vel.y += Particle.m_Gravity * TimePassed;
+			for(int f = 0; f < aFrictionCounts[Step]; f++)
+				Particle.m_Vel *= Particle.m_Friction;
+			vec2 Vel = Particle.m_Vel * TimePassed;
+			if(Particle.m_Collides)
+				Collision.MovePoint(&Particle.m_Pos, &Vel, 0.5f, nullptr);
+			else
+				Particle.m_Pos += Vel;
+			Particle.m_Vel = Vel * (1.0f / TimePassed);
+			Particle.m_Rot += TimePassed * Particle.m_Rotspeed;
+		}
+	}
+
+	ASSERT_EQ(Store.Size(), (int)vReference.size());
+	for(int i = 0; i < Store.Size(); i++)
+	{
+		EXPECT_EQ(Store.m_vPosX[i], vReference[i].m_Pos.x) << i;
+		EXPECT_EQ(Store.m_vPosY[i], vReference[i].m_Pos.y) << i;
+		EXPECT_EQ(Store.m_vVelX[i], vReference[i].m_Vel.x) << i;
+		EXPECT_EQ(Store.m_vVelY[i], vReference[i].m_Vel.y) << i;
+		EXPECT_EQ(Store.m_vRot[i], vReference[i].m_Rot) << i;
+	}
+}
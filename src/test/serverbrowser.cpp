@@ -1,12 +1,20 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include <base/system.h>
 
+#include <engine/client/serverbrowser_http.h>
 #include <engine/client/serverbrowser_ping_cache.h>
+#include <engine/client/serverbrowser_search.h>
+#include <engine/client/serverbrowser_sortkeys.h>
 #include <engine/console.h>
 #include <engine/engine.h>
+#include <engine/external/json-parser/json.h>
+#include <engine/serverbrowser.h>
 #include <engine/shared/config.h>
+#include <engine/shared/serverinfo_arena.h>
 #include <engine/storage.h>
 #include <test/test.h>
 
@@ -99,3 +107,282 @@ TEST(ServerBrowser, PingCache)
 	EXPECT_EQ(pPingCache->GetPing(&OtherLocalhost4, 1), 1337);
 	EXPECT_EQ(pPingCache->GetPing(&OtherLocalhost6, 1), 345);
 }
+
+static void SetSearchInfo(CServerInfo *pInfo, CServerInfoArena *pArena, const char *pName, const char *pMap, const char *pPlayer, const char *pClan)
+{
+	*pInfo = CServerInfo{};
+	str_copy(pInfo->m_aName, pName);
+	pInfo->m_pMap = pArena->InternString(pMap);
+	pInfo->m_pClients = pArena->AllocateClients(1);
+	pInfo->m_pClients[0] = {};
+	pInfo->m_pClients[0].m_pName = pArena->StoreString(pPlayer);
+	pInfo->m_pClients[0].m_pClan = pArena->StoreString(pClan);
+	pInfo->m_pClients[0].m_pSkin = "";
+	pInfo->m_NumClients = 1;
+	pInfo->m_NumReceivedClients = 1;
+}
+
+TEST(ServerBrowser, SearchIndexCandidates)
+{
+	CServerBrowserSearchIndex Index;
+	CServerInfoArena Arena;
+	CServerInfo Info;
+	SetSearchInfo(&Info, &Arena, "DDNet GER10 [DDraceNetwork] - Novice", "Tutorial", "nameless tee", "");
+	Index.Update(0, Info);
+	SetSearchInfo(&Info, &Arena, "Block Server", "BlmapChill", "ChillerDragon", "Chilli.*");
+	Index.Update(1, Info);
+	SetSearchInfo(&Info, &Arena, "Ünicode Ärena", "Straße", "ÖÖÖ", "");
+	Index.Update(2, Info);
+	EXPECT_EQ(Index.NumEntries(), 3);
+
+	std::vector<int> vCandidates;
+	EXPECT_TRUE(Index.Candidates("novice", vCandidates));
+	EXPECT_EQ(vCandidates, std::vector<int>{0});
+	EXPECT_TRUE(Index.Candidates("CHILL", vCandidates));
+	EXPECT_EQ(vCandidates, std::vector<int>{1});
+	EXPECT_TRUE(Index.Candidates("üNICODE", vCandidates));
+	EXPECT_EQ(vCandidates, std::vector<int>{2});
+	EXPECT_TRUE(Index.Candidates("ööö", vCandidates));
+	EXPECT_EQ(vCandidates, std::vector<int>{2});
+	EXPECT_TRUE(Index.Candidates("tee", vCandidates));
+	EXPECT_EQ(vCandidates, std::vector<int>{0});
+	EXPECT_TRUE(Index.Candidates("nothing", vCandidates));
+	EXPECT_TRUE(vCandidates.empty());
+
+	// too short to be looked up
+	EXPECT_FALSE(Index.Candidates("dd", vCandidates));
+	EXPECT_FALSE(Index.Candidates("öö", vCandidates));
+	EXPECT_FALSE(Index.Candidates("", vCandidates));
+}
+
+TEST(ServerBrowser, SearchIndexUpdate)
+{
+	CServerBrowserSearchIndex Index;
+	CServerInfoArena Arena;
+	CServerInfo Info;
+	SetSearchInfo(&Info, &Arena, "Server", "Gores", "brainless tee", "");
+	Index.Update(0, Info);
+	Index.Update(1, Info);
+
+	std::vector<int> vCandidates;
+	EXPECT_TRUE(Index.Candidates("brainless", vCandidates));
+	std::sort(vCandidates.begin(), vCandidates.end());
+	EXPECT_EQ(vCandidates, (std::vector<int>{0, 1}));
+
+	// the player left the first server
+	SetSearchInfo(&Info, &Arena, "Server", "Gores", "", "");
+	Index.Update(0, Info);
+	EXPECT_TRUE(Index.Candidates("brainless", vCandidates));
+	EXPECT_EQ(vCandidates, std::vector<int>{1});
+	EXPECT_TRUE(Index.Candidates("gores", vCandidates));
+	std::sort(vCandidates.begin(), vCandidates.end());
+	EXPECT_EQ(vCandidates, (std::vector<int>{0, 1}));
+
+	// no postings are left behind
+	const int NumTrigrams = Index.NumTrigrams();
+	Index.Update(1, Info);
+	EXPECT_LT(Index.NumTrigrams(), NumTrigrams);
+	EXPECT_TRUE(Index.Candidates("brainless", vCandidates));
+	EXPECT_TRUE(vCandidates.empty());
+
+	Index.Clear();
+	EXPECT_EQ(Index.NumEntries(), 0);
+	EXPECT_EQ(Index.NumTrigrams(), 0);
+}
+
+TEST(ServerBrowser, SearchIndexMatchesFindNocase)
+{
+	// every server that str_utf8_find_nocase matches must be a candidate
+	const char *apWords[] = {"DDNet", "ddnet", "Ärger", "ärger", "KoG", "kog", "Σίσυφος", "ΣΊΣΥΦΟΣ", "Multimap", "multi map", "[Test]", "tëst"};
+	const int NumWords = std::size(apWords);
+	CServerBrowserSearchIndex Index;
+	CServerInfoArena Arena;
+	std::vector<CServerInfo> vInfos(NumWords * NumWords);
+	for(int i = 0; i < NumWords * NumWords; i++)
+	{
+		char aName[64];
+		str_format(aName, sizeof(aName), "%s %s", apWords[i % NumWords], apWords[i / NumWords]);
+		SetSearchInfo(&vInfos[i], &Arena, aName, apWords[(i + 3) % NumWords], apWords[(i + 5) % NumWords], apWords[(i + 7) % NumWords]);
+		Index.Update(i, vInfos[i]);
+	}
+
+	std::vector<int> vCandidates;
+	for(const char *pNeedle : apWords)
+	{
+		ASSERT_TRUE(Index.Candidates(pNeedle, vCandidates));
+		for(int i = 0; i < (int)vInfos.size(); i++)
+		{
+			const CServerInfo &Info = vInfos[i];
+			const bool Matches = str_utf8_find_nocase(Info.m_aName, pNeedle) ||
+					     str_utf8_find_nocase(Info.m_pMap, pNeedle) ||
+					     str_utf8_find_nocase(Info.m_pClients[0].m_pName, pNeedle) ||
+					     str_utf8_find_nocase(Info.m_pClients[0].m_pClan, pNeedle);
+			const bool Candidate = std::find(vCandidates.begin(), vCandidates.end(), i) != vCandidates.end();
+			EXPECT_TRUE(!Matches || Candidate) << pNeedle << " in " << Info.m_aName;
+		}
+	}
+}
+
+TEST(ServerBrowser, SortKeysRankStrings)
+{
+	const std::vector<const char *> vpStrings = {"Kobra 4", "Tutorial", "", "Kobra 4", "kobra 4", "Aim 1", "Tutorial", "Kobra 40"};
+	std::vector<int> vRanks;
+	CServerBrowserSortKeys::RankStrings(vpStrings, vRanks);
+	ASSERT_EQ(vRanks.size(), vpStrings.size());
+	EXPECT_EQ(vRanks, (std::vector<int>{2, 4, 0, 2, 5, 1, 4, 3}));
+	for(size_t a = 0; a < vpStrings.size(); a++)
+	{
+		for(size_t b = 0; b < vpStrings.size(); b++)
+		{
+			EXPECT_EQ(vRanks[a] < vRanks[b], str_comp(vpStrings[a], vpStrings[b]) < 0);
+			EXPECT_EQ(vRanks[a] == vRanks[b], str_comp(vpStrings[a], vpStrings[b]) == 0);
+		}
+	}
+
+	CServerBrowserSortKeys::RankStrings({}, vRanks);
+	EXPECT_TRUE(vRanks.empty());
+}
+
+TEST(ServerBrowser, SortKeysUpdate)
+{
+	std::vector<IServerBrowser::CServerEntry> vEntries(3);
+	std::vector<const IServerBrowser::CServerEntry *> vpEntries;
+	const char *apNames[] = {"b", "a", "c"};
+	const char *apGameTypes[] = {"DDraceNetwork", "DDraceNetwork", "Gores"};
+	for(int i = 0; i < 3; i++)
+	{
+		vEntries[i].m_GotInfo = i != 2;
+		vEntries[i].m_Info.m_Latency = 100 - i;
+		vEntries[i].m_Info.m_NumClients = i * 2;
+		vEntries[i].m_Info.m_NumFilteredPlayers = i;
+		vEntries[i].m_Info.m_FriendNum = 3 - i;
+		str_copy(vEntries[i].m_Info.m_aName, apNames[i]);
+		vEntries[i].m_Info.m_pGameType = apGameTypes[i];
+		vpEntries.push_back(&vEntries[i]);
+	}
+
+	CServerBrowserSortKeys SortKeys;
+	SortKeys.Update(vpEntries.data(), vpEntries.size(), IServerBrowser::SORT_NAME);
+	EXPECT_EQ(SortKeys.m_vGotInfo, (std::vector<int>{1, 1, 0}));
+	EXPECT_EQ(SortKeys.m_vLatency, (std::vector<int>{100, 99, 98}));
+	EXPECT_EQ(SortKeys.m_vNumClients, (std::vector<int>{0, 2, 4}));
+	EXPECT_EQ(SortKeys.m_vNumFilteredPlayers, (std::vector<int>{0, 1, 2}));
+	EXPECT_EQ(SortKeys.m_vFriendNum, (std::vector<int>{3, 2, 1}));
+	ASSERT_EQ(SortKeys.m_vpName.size(), 3u);
+	EXPECT_EQ(SortKeys.m_vpName[1], vEntries[1].m_Info.m_aName);
+	EXPECT_TRUE(SortKeys.m_vGameTypeRank.empty());
+
+	SortKeys.Update(vpEntries.data(), vpEntries.size(), IServerBrowser::SORT_GAMETYPE);
+	EXPECT_EQ(SortKeys.m_vGameTypeRank, (std::vector<int>{0, 0, 1}));
+}
+
+static const char SERVER_LIST[] = R"({
+	"servers": [
+		{
+			"addresses": ["tw-0.6+udp://1.2.3.4:8303", "tw-0.7+udp://1.2.3.4:8303"],
+			"location": "eu:de",
+			"info": {"max_clients": 64, "max_players": 64, "passworded": false, "game_type": "DDraceNetwork", "name": "DDNet \u00e4", "map": {"name": "Multeasymap"}, "version": "0.6.4", "clients": [{"name": "nameless tee", "clan": "", "country": -1, "score": 0, "is_player": true}]}
+		},
+		{
+			"addresses": ["tw-0.7+udp://5.6.7.8:8303", "tw-0.7+udp://[::1]:8303", "unknown://x"],
+			"info": {"max_clients": 16, "max_players": 16, "passworded": true, "game_type": "CTF", "name": "0.7 only", "map": {"name": "ctf5"}, "version": "0.7.5", "clients": []}
+		},
+		{
+			"addresses": ["tw-0.6+udp://9.9.9.9:8303"],
+			"info": {"max_clients": 1, "max_players": 2, "passworded": false, "game_type": "DM", "name": "invalid info", "map": {"name": "dm1"}, "version": "0.6.4", "clients": []}
+		},
+		{
+			"addresses": ["unknown://x"],
+			"info": {"max_clients": 16, "max_players": 16, "passworded": false, "game_type": "DM", "name": "no address", "map": {"name": "dm1"}, "version": "0.6.4", "clients": []}
+		}
+	],
+	"other": {"servers": 1}
+})";
+
+static bool ParseServerListDom(const char *pJson, size_t Length, std::vector<CServerInfo> *pvServers, CServerInfoArena *pArena)
+{
+	json_value *pDom = json_parse(pJson, Length);
+	if(!pDom)
+		return true;
+	const bool Failure = ServerbrowserParseServerList(pDom, pvServers, pArena);
+	json_value_free(pDom);
+	return Failure;
+}
+
+static void ExpectSameServers(const std::vector<CServerInfo> &vExpected, const std::vector<CServerInfo> &vActual)
+{
+	ASSERT_EQ(vExpected.size(), vActual.size());
+	for(size_t i = 0; i < vExpected.size(); i++)
+	{
+		EXPECT_STREQ(vExpected[i].m_aName, vActual[i].m_aName);
+		EXPECT_STREQ(vExpected[i].m_pMap, vActual[i].m_pMap);
+		EXPECT_EQ(vExpected[i].m_Location, vActual[i].m_Location);
+		EXPECT_EQ(vExpected[i].m_NumClients, vActual[i].m_NumClients);
+		ASSERT_EQ(vExpected[i].m_NumReceivedClients, vActual[i].m_NumReceivedClients);
+		for(int c = 0; c < vExpected[i].m_NumReceivedClients; c++)
+			EXPECT_STREQ(vExpected[i].m_pClients[c].m_pName, vActual[i].m_pClients[c].m_pName);
+		ASSERT_EQ(vExpected[i].m_NumAddresses, vActual[i].m_NumAddresses);
+		for(int a = 0; a < vExpected[i].m_NumAddresses; a++)
+			EXPECT_EQ(net_addr_comp(&vExpected[i].m_aAddresses[a], &vActual[i].m_aAddresses[a]), 0);
+	}
+}
+
+TEST(ServerBrowser, ServerListStream)
+{
+	const size_t Length = str_length(SERVER_LIST);
+	std::vector<CServerInfo> vExpected;
+	CServerInfoArena Arena;
+	ASSERT_FALSE(ParseServerListDom(SERVER_LIST, Length, &vExpected, &Arena));
+	ASSERT_EQ(vExpected.size(), 2u);
+	EXPECT_STREQ(vExpected[0].m_aName, "DDNet ä");
+	EXPECT_EQ(vExpected[0].m_NumAddresses, 1);
+	EXPECT_EQ(vExpected[1].m_NumAddresses, 2);
+
+	for(size_t Split = 0; Split <= Length; Split++)
+	{
+		CServerListStreamParser Parser;
+		EXPECT_TRUE(Parser.Feed(SERVER_LIST, Split));
+		EXPECT_TRUE(Parser.Feed(SERVER_LIST + Split, Length - Split));
+		ASSERT_TRUE(Parser.Finish()) << Split << " " << Parser.Error();
+		ExpectSameServers(vExpected, Parser.Servers());
+		// at most one server entry is kept at a time
+		EXPECT_LT(Parser.PeakBufferSize(), Length / 2);
+	}
+}
+
+TEST(ServerBrowser, ServerListStreamInvalid)
+{
+	const char *apInvalid[] = {
+		"[]",
+		"{}",
+		R"({"servers": {}})",
+		R"({"servers": 1})",
+		R"({"servers": [1]})",
+		R"({"servers": [[]]})",
+		R"({"servers": [{}]})",
+		R"({"servers": [{"addresses": "tw-0.6+udp://1.2.3.4:8303"}]})",
+		R"({"servers": [{"addresses": [], "location": 1}]})",
+		R"({"servers": [{"addresses": [], "location": "nowhere"}]})",
+		R"({"servers": 1, "servers": []})",
+		R"({"servers": [])",
+		R"({"servers": []} [])",
+	};
+	for(const char *pInvalid : apInvalid)
+	{
+		std::vector<CServerInfo> vServers;
+		CServerInfoArena Arena;
+		EXPECT_TRUE(ParseServerListDom(pInvalid, str_length(pInvalid), &vServers, &Arena)) << pInvalid;
+
+		CServerListStreamParser Parser;
+		const bool Result = Parser.Feed(pInvalid, str_length(pInvalid)) && Parser.Finish();
+		EXPECT_FALSE(Result) << pInvalid;
+		EXPECT_TRUE(Parser.Failed()) << pInvalid;
+	}
+
+	const char *pValid = R"({"servers": [], "servers": 1})";
+	std::vector<CServerInfo> vServers;
+	CServerInfoArena Arena;
+	EXPECT_FALSE(ParseServerListDom(pValid, str_length(pValid), &vServers, &Arena));
+	CServerListStreamParser Parser;
+	EXPECT_TRUE(Parser.Feed(pValid, str_length(pValid)) && Parser.Finish()) << Parser.Error();
+}
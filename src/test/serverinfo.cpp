@@ -2,6 +2,7 @@
 
 #include <engine/serverbrowser.h>
 #include <engine/shared/serverinfo.h>
+#include <engine/shared/serverinfo_arena.h>
 
 #include <engine/external/json-parser/json.h>
 
@@ -53,3 +54,55 @@ TEST(ServerInfo, Crc)
 	EXPECT_EQ(ParseCrcOrDeadbeef("000000000"), 0xdeadbeef);
 	EXPECT_EQ(ParseCrcOrDeadbeef("00000000x"), 0xdeadbeef);
 }
+
+TEST(ServerInfo, ArenaIntern)
+{
+	CServerInfoArena Arena;
+	char aMap[] = "Multeasymap";
+	const char *pMap = Arena.InternString(aMap);
+	EXPECT_STREQ(pMap, "Multeasymap");
+	EXPECT_NE(pMap, aMap);
+	EXPECT_EQ(Arena.InternString("Multeasymap"), pMap);
+	EXPECT_NE(Arena.InternString("Multeasymap2"), pMap);
+	EXPECT_STREQ(Arena.InternString(""), "");
+
+	// stored strings aren't shared
+	const char *pName = Arena.StoreString("nameless tee");
+	EXPECT_STREQ(pName, "nameless tee");
+	EXPECT_NE(Arena.StoreString("nameless tee"), pName);
+}
+
+TEST(ServerInfo, ArenaStore)
+{
+	CServerInfoArena TmpArena;
+	CServerInfo Info;
+	Info.m_pMap = TmpArena.InternString("Tutorial");
+	Info.m_pGameType = "DDraceNetwork";
+	Info.m_NumReceivedClients = 2;
+	Info.m_pClients = TmpArena.AllocateClients(2);
+	for(int i = 0; i < 2; i++)
+	{
+		Info.m_pClients[i] = {};
+		Info.m_pClients[i].m_pName = TmpArena.StoreString(i == 0 ? "brainless tee" : "nameless tee");
+		Info.m_pClients[i].m_pClan = "";
+		Info.m_pClients[i].m_pSkin = "default";
+		Info.m_pClients[i].m_Score = i;
+	}
+
+	CServerInfoArena Arena;
+	Arena.Store(&Info);
+	TmpArena.Reset();
+	const char *pMap = Arena.InternString("Tutorial");
+	EXPECT_EQ(Info.m_pMap, pMap);
+	EXPECT_EQ(Info.m_pGameType, Arena.InternString("DDraceNetwork"));
+	EXPECT_STREQ(Info.m_pClients[0].m_pName, "brainless tee");
+	EXPECT_STREQ(Info.m_pClients[1].m_pName, "nameless tee");
+	EXPECT_EQ(Info.m_pClients[1].m_Score, 1);
+	// equal skins are interned
+	EXPECT_EQ(Info.m_pClients[0].m_pSkin, Info.m_pClients[1].m_pSkin);
+
+	// moving the arena keeps the strings in place
+	CServerInfoArena MovedArena = std::move(Arena);
+	EXPECT_EQ(MovedArena.InternString("Tutorial"), pMap);
+	EXPECT_STREQ(Info.m_pClients[0].m_pName, "brainless tee");
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <engine/server/serverinfo_cache.h>
+#include <engine/shared/masterserver.h>
+#include <engine/shared/network.h>
+#include <engine/shared/packer.h>
+#include <engine/shared/protocol.h>
+
+#include <optional>
+#include <vector>
+
+// the response packing of SendServerInfo before the payloads were prebuilt
+static std::vector<uint8_t> OldPayload(const unsigned char *pHeader, int HeaderSize, const std::vector<uint8_t> &vBody, int Token)
+{
+	char aBuf[128];
+	CPacker p;
+	p.Reset();
+	p.AddRaw(pHeader, HeaderSize);
+	str_format(aBuf, sizeof(aBuf), "%d", Token);
+	p.AddString(aBuf, 0);
+	p.AddRaw(vBody.data(), vBody.size());
+	return std::vector<uint8_t>(p.Data(), p.Data() + p.Size());
+}
+
+// the client entry packing of CacheServerInfo before it was cached
+static std::vector<uint8_t> OldClient(const char *pName, const char *pClan, int Country, std::optional<int> OptScore, bool IsPlayer)
+{
+	char aBuf[128];
+	CPacker q;
+	q.Reset();
+	q.AddString(pName, MAX_NAME_LENGTH);
+	q.AddString(pClan, MAX_CLAN_LENGTH);
+	str_format(aBuf, sizeof(aBuf), "%d", Country);
+	q.AddString(aBuf, 0);
+	int Score;
+	if(OptScore.has_value())
+	{
+		Score = OptScore.value();
+		if(Score == 9999)
+			Score = -10000;
+		else if(Score == 0)
+			Score = -1;
+		else
+			Score = -Score;
+	}
+	else
+	{
+		Score = -9999;
+	}
+	str_format(aBuf, sizeof(aBuf), "%d", Score);
+	q.AddString(aBuf, 0);
+	str_format(aBuf, sizeof(aBuf), "%d", IsPlayer ? 1 : 0);
+	q.AddString(aBuf, 0);
+	return std::vector<uint8_t>(q.Data(), q.Data() + q.Size());
+}
+
+static std::vector<uint8_t> OldClientSixup(const char *pName, const char *pClan, int Country, std::optional<int> Score, bool IsPlayer)
+{
+	CPacker Packer;
+	Packer.Reset();
+	Packer.AddString(pName, MAX_NAME_LENGTH);
+	Packer.AddString(pClan, MAX_CLAN_LENGTH);
+	Packer.AddInt(Country);
+	Packer.AddInt(Score.value_or(-1));
+	Packer.AddInt(IsPlayer ? 0 : 1);
+	return std::vector<uint8_t>(Packer.Data(), Packer.Data() + Packer.Size());
+}
+
+TEST(ServerInfoCache, Payload)
+{
+	const unsigned char *apHeaders[] = {SERVERBROWSE_INFO, SERVERBROWSE_INFO_64_LEGACY, SERVERBROWSE_INFO_EXTENDED, SERVERBROWSE_INFO_EXTENDED_MORE};
+	const int aTokens[] = {-1, 0, 7, 255, 65536, 1234567, 16777215};
+
+	std::vector<uint8_t> vBody;
+	for(int i = 0; i < 1000; i++)
+		vBody.push_back(i * 7 % 251);
+
+	unsigned char aData[NET_MAX_PAYLOAD];
+	for(const unsigned char *pHeader : apHeaders)
+	{
+		for(int BodySize : {0, 1, 1000})
+		{
+			CServerInfoCache Cache;
+			Cache.AddChunk(pHeader, SERVERBROWSE_SIZE, vBody.data(), BodySize);
+			ASSERT_EQ(Cache.m_vCache.size(), 1u);
+			const std::vector<uint8_t> vChunkBody(vBody.begin(), vBody.begin() + BodySize);
+			for(int Token : aTokens)
+			{
+				const int Size = Cache.m_vCache[0].Payload(Token, aData);
+				const std::vector<uint8_t> vExpected = OldPayload(pHeader, SERVERBROWSE_SIZE, vChunkBody, Token);
+				EXPECT_EQ(std::vector<uint8_t>(aData, aData + Size), vExpected);
+			}
+		}
+	}
+}
+
+TEST(ServerInfoCache, Client)
+{
+	const char *apNames[] = {"", "nameless tee", "abcdefghijklmnopqrstuvwxyz", "ДДРейсерДДРейсер", "ツツツツツツ"};
+	const char *apClans[] = {"", "clan", "Ω-clan-too-long"};
+	const std::optional<int> aScores[] = {std::nullopt, 0, 1, 9999, 123456, -5};
+
+	CPacker Packer;
+	int Country = -1;
+	for(const char *pName : apNames)
+	{
+		for(const char *pClan : apClans)
+		{
+			for(const std::optional<int> &Score : aScores)
+			{
+				for(bool IsPlayer : {false, true})
+				{
+					Country = (Country + 37) % 1000;
+
+					Packer.Reset();
+					CServerInfoCache::PackClient(&Packer, pName, pClan, Country, Score, IsPlayer);
+					EXPECT_EQ(std::vector<uint8_t>(Packer.Data(), Packer.Data() + Packer.Size()), OldClient(pName, pClan, Country, Score, IsPlayer));
+
+					Packer.Reset();
+					CServerInfoCache::PackClientSixup(&Packer, pName, pClan, Country, Score, IsPlayer);
+					EXPECT_EQ(std::vector<uint8_t>(Packer.Data(), Packer.Data() + Packer.Size()), OldClientSixup(pName, pClan, Country, Score, IsPlayer));
+				}
+			}
+		}
+	}
+}
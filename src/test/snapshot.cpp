@@ -83,3 +83,302 @@ TEST(Snapshot, CrcOverflow)
 
 	ASSERT_EQ(pSnapshot->Crc(), 1);
 }
+
+static void RandomSnapshot(CSnapshotBuilder *pBuilder, const CSnapshot *pBase, unsigned *pSeed)
+{
+	auto Random = [pSeed](unsigned Max) {
+		*pSeed = *pSeed * 1103515245 + 12345;
+		return (*pSeed >> 16) % Max;
+	};
+
+	pBuilder->Init();
+	// keep, change or drop the items of the base snapshot
+	for(int i = 0; pBase && i < pBase->NumItems(); i++)
+	{
+		const unsigned Action = Random(8);
+		if(Action == 0)
+			continue;
+		const CSnapshotItem *pItem = pBase->GetItem(i);
+		const int Size = pBase->GetItemSize(i);
+		int *pData = (int *)pBuilder->NewItem(pItem->Type(), pItem->Id(), Size);
+		ASSERT_TRUE(pData);
+		mem_copy(pData, pItem->Data(), Size);
+		if(Action == 1)
+			pData[Random(Size / sizeof(int))] += Random(64) - 32;
+	}
+	// add new items with ids that may or may not exist already
+	const int NumNew = Random(40);
+	for(int i = 0; i < NumNew; i++)
+	{
+		const int Type = 1 + Random(4);
+		const int Id = Random(64);
+		if(pBuilder->GetItemData((Type << 16) | Id))
+			continue;
+		const int Size = (1 + Type) * sizeof(int);
+		int *pData = (int *)pBuilder->NewItem(Type, Id, Size);
+		ASSERT_TRUE(pData);
+		for(int j = 0; j < Size / (int)sizeof(int); j++)
+			pData[j] = Random(1000);
+	}
+}
+
+static void ExpectSameItems(const CSnapshot *pExpected, const CSnapshot *pActual)
+{
+	ASSERT_EQ(pActual->NumItems(), pExpected->NumItems());
+	for(int i = 0; i < pExpected->NumItems(); i++)
+	{
+		const CSnapshotItem *pItem = pExpected->GetItem(i);
+		const int Index = pActual->GetItemIndex(pItem->Key());
+		ASSERT_GE(Index, 0);
+		ASSERT_EQ(pActual->GetItemSize(Index), pExpected->GetItemSize(i));
+		EXPECT_EQ(mem_comp(pActual->GetItem(Index)->Data(), pItem->Data(), pExpected->GetItemSize(i)), 0);
+	}
+}
+
+TEST(Snapshot, DeltaRoundTrip)
+{
+	CSnapshotDelta Delta;
+	unsigned Seed = 42;
+
+	char aFromData[CSnapshot::MAX_SIZE];
+	char aToData[CSnapshot::MAX_SIZE];
+	char aUnpackedData[CSnapshot::MAX_SIZE];
+	char aDeltaData[CSnapshot::MAX_SIZE];
+	CSnapshot *pFrom = (CSnapshot *)aFromData;
+	CSnapshot *pTo = (CSnapshot *)aToData;
+	CSnapshot *pUnpacked = (CSnapshot *)aUnpackedData;
+
+	CSnapshotBuilder Builder;
+	RandomSnapshot(&Builder, nullptr, &Seed);
+	Builder.Finish(pFrom);
+	for(int Round = 0; Round < 200; Round++)
+	{
+		RandomSnapshot(&Builder, pFrom, &Seed);
+		Builder.Finish(pTo);
+
+		const int DeltaSize = Delta.CreateDelta(pFrom, pTo, aDeltaData);
+		ASSERT_GE(DeltaSize, 0);
+		if(DeltaSize == 0)
+		{
+			ExpectSameItems(pTo, pFrom);
+		}
+		else
+		{
+			ASSERT_GE(Delta.UnpackDelta(pFrom, pUnpacked, aDeltaData, DeltaSize, false), 0);
+			ExpectSameItems(pTo, pUnpacked);
+		}
+		mem_copy(aFromData, aToData, sizeof(aFromData));
+	}
+}
+
+TEST(Snapshot, DeltaIdentical)
+{
+	CSnapshotDelta Delta;
+	unsigned Seed = 7;
+	CSnapshotBuilder Builder;
+	RandomSnapshot(&Builder, nullptr, &Seed);
+	char aData[CSnapshot::MAX_SIZE];
+	CSnapshot *pSnapshot = (CSnapshot *)aData;
+	Builder.Finish(pSnapshot);
+
+	char aDeltaData[CSnapshot::MAX_SIZE];
+	EXPECT_EQ(Delta.CreateDelta(pSnapshot, pSnapshot, aDeltaData), 0);
+}
+
+// CreateDelta before the sorted key merge, the items were matched with a hash
+// list of the keys that returns the first item with the key
+static int OldCreateDelta(const short *pItemSizes, const CSnapshot *pFrom, const CSnapshot *pTo, void *pDstData)
+{
+	const auto &&FindKey = [](const CSnapshot *pSnapshot, int Key) {
+		for(int i = 0; i < pSnapshot->NumItems(); i++)
+			if(pSnapshot->GetItem(i)->Key() == Key)
+				return i;
+		return -1;
+	};
+
+	CSnapshotDelta::CData *pDelta = (CSnapshotDelta::CData *)pDstData;
+	int *pData = (int *)pDelta->m_aData;
+	pDelta->m_NumDeletedItems = 0;
+	pDelta->m_NumUpdateItems = 0;
+	pDelta->m_NumTempItems = 0;
+
+	for(int i = 0; i < pFrom->NumItems(); i++)
+	{
+		if(FindKey(pTo, pFrom->GetItem(i)->Key()) == -1)
+		{
+			pDelta->m_NumDeletedItems++;
+			*pData++ = pFrom->GetItem(i)->Key();
+		}
+	}
+
+	for(int i = 0; i < pTo->NumItems(); i++)
+	{
+		const int ItemSize = pTo->GetItemSize(i);
+		const CSnapshotItem *pCurItem = pTo->GetItem(i);
+		const int PastIndex = FindKey(pFrom, pCurItem->Key());
+		const bool IncludeSize = pCurItem->Type() >= 64 || !pItemSizes[pCurItem->Type()];
+		int *pItemDataDst = pData + (IncludeSize ? 3 : 2);
+		if(PastIndex != -1)
+		{
+			const int *pPast = pFrom->GetItem(PastIndex)->Data();
+			int Needed = 0;
+			for(int j = 0; j < ItemSize / (int)sizeof(int32_t); j++)
+			{
+				pItemDataDst[j] = (unsigned)pCurItem->Data()[j] - (unsigned)pPast[j];
+				Needed |= pItemDataDst[j];
+			}
+			if(!Needed)
+				continue;
+		}
+		else
+		{
+			mem_copy(pItemDataDst, pCurItem->Data(), ItemSize);
+		}
+		*pData++ = pCurItem->Type();
+		*pData++ = pCurItem->Id();
+		if(IncludeSize)
+			*pData++ = ItemSize / sizeof(int32_t);
+		pData += ItemSize / sizeof(int32_t);
+		pDelta->m_NumUpdateItems++;
+	}
+
+	if(!pDelta->m_NumDeletedItems && !pDelta->m_NumUpdateItems)
+		return 0;
+	return (int)((char *)pData - (char *)pDstData);
+}
+
+// Snapshots should not contain the same key twice, but the delta of ones
+// that do must not change either. The previous snapshot is matched by the
+// first item with the key.
+TEST(Snapshot, DeltaDuplicateKeys)
+{
+	short aItemSizes[64] = {0};
+	aItemSizes[2] = 3 * sizeof(int);
+	CSnapshotDelta Delta;
+	Delta.SetStaticsize(2, aItemSizes[2]);
+	unsigned Seed = 1234;
+	auto Random = [&Seed](unsigned Max) {
+		Seed = Seed * 1103515245 + 12345;
+		return (Seed >> 16) % Max;
+	};
+
+	char aFromData[CSnapshot::MAX_SIZE];
+	char aToData[CSnapshot::MAX_SIZE];
+	char aDeltaData[CSnapshot::MAX_SIZE];
+	char aOldDeltaData[CSnapshot::MAX_SIZE];
+	CSnapshot *pFrom = (CSnapshot *)aFromData;
+	CSnapshot *pTo = (CSnapshot *)aToData;
+
+	CSnapshotBuilder Builder;
+	Builder.Init();
+	Builder.Finish(pFrom);
+	for(int Round = 0; Round < 300; Round++)
+	{
+		// few types and ids, so that keys repeat within and across snapshots
+		Builder.Init();
+		for(int i = 0; i < pFrom->NumItems(); i++)
+		{
+			if(Random(5) == 0)
+				continue;
+			const CSnapshotItem *pItem = pFrom->GetItem(i);
+			const int Size = pFrom->GetItemSize(i);
+			int *pData = (int *)Builder.NewItem(pItem->Type(), pItem->Id(), Size);
+			ASSERT_TRUE(pData);
+			mem_copy(pData, pItem->Data(), Size);
+			if(Random(3) == 0)
+				pData[Random(Size / sizeof(int))] += Random(1 << 20) - (1 << 19);
+		}
+		const int NumNew = Random(12);
+		for(int i = 0; i < NumNew && Builder.NumItems() < 200; i++)
+		{
+			const int Type = 1 + Random(3);
+			const int Size = (1 + Type) * sizeof(int);
+			int *pData = (int *)Builder.NewItem(Type, Random(6), Size);
+			ASSERT_TRUE(pData);
+			for(int j = 0; j < Size / (int)sizeof(int); j++)
+				pData[j] = Random(1000);
+		}
+		Builder.Finish(pTo);
+
+		const int DeltaSize = Delta.CreateDelta(pFrom, pTo, aDeltaData);
+		const int OldDeltaSize = OldCreateDelta(aItemSizes, pFrom, pTo, aOldDeltaData);
+		ASSERT_EQ(DeltaSize, OldDeltaSize) << "round " << Round;
+		EXPECT_EQ(mem_comp(aDeltaData, aOldDeltaData, DeltaSize), 0) << "round " << Round;
+		mem_copy(aFromData, aToData, sizeof(aFromData));
+	}
+
+	// the same keys in the same order, a repeated key must still be diffed
+	// against the first item with it
+	for(int Snap = 0; Snap < 2; Snap++)
+	{
+		Builder.Init();
+		for(int i = 0; i < 4; i++)
+		{
+			int *pData = (int *)Builder.NewItem(2, i % 2, aItemSizes[2]);
+			ASSERT_TRUE(pData);
+			for(int j = 0; j < 3; j++)
+				pData[j] = Snap * 100 + i * 10 + j;
+		}
+		Builder.Finish(Snap == 0 ? pFrom : pTo);
+	}
+	const int DeltaSize = Delta.CreateDelta(pFrom, pTo, aDeltaData);
+	const int OldDeltaSize = OldCreateDelta(aItemSizes, pFrom, pTo, aOldDeltaData);
+	ASSERT_EQ(DeltaSize, OldDeltaSize);
+	EXPECT_EQ(mem_comp(aDeltaData, aOldDeltaData, DeltaSize), 0);
+}
+
+TEST(Snapshot, StorageGetAndPurge)
+{
+	CSnapshotStorage Storage;
+	char aData[64];
+	char aAltData[32];
+	for(int Tick = 0; Tick < 1000; Tick += 3)
+	{
+		mem_zero(aData, sizeof(aData));
+		mem_zero(aAltData, sizeof(aAltData));
+		aData[0] = Tick % 100;
+		aAltData[0] = Tick % 50;
+		const size_t Size = 8 + Tick % 50;
+		Storage.Add(Tick, Tick * 10, Size, aData, Tick % 2 ? sizeof(aAltData) : 0, aAltData);
+		// keep enough snapshots that ticks collide in the tick index
+		Storage.PurgeUntil(Tick - 600);
+
+		for(int Get = Tick - 700; Get <= Tick + 1; Get++)
+		{
+			int64_t Tagtime;
+			const CSnapshot *pData;
+			const CSnapshot *pAltData;
+			const int Result = Storage.Get(Get, &Tagtime, &pData, &pAltData);
+			if(Get < 0 || Get < Tick - 600 || Get > Tick || Get % 3 != 0)
+			{
+				ASSERT_EQ(Result, -1);
+				continue;
+			}
+			ASSERT_EQ(Result, 8 + Get % 50);
+			EXPECT_EQ(Tagtime, Get * 10);
+			EXPECT_EQ(((const char *)pData)[0], Get % 100);
+			if(Get % 2)
+			{
+				ASSERT_TRUE(pAltData);
+				EXPECT_EQ(((const char *)pAltData)[0], Get % 50);
+			}
+			else
+			{
+				EXPECT_FALSE(pAltData);
+			}
+		}
+	}
+
+	ASSERT_TRUE(Storage.m_pFirst);
+	EXPECT_FALSE(Storage.m_pFirst->m_pPrev);
+	int Num = 0;
+	for(const CSnapshotStorage::CHolder *pHolder = Storage.m_pFirst; pHolder; pHolder = pHolder->m_pNext)
+		Num++;
+	EXPECT_EQ(Num, 201);
+	EXPECT_EQ(Storage.m_pLast->m_Tick, 999);
+
+	Storage.PurgeUntil(2000);
+	EXPECT_FALSE(Storage.m_pFirst);
+	EXPECT_FALSE(Storage.m_pLast);
+	EXPECT_EQ(Storage.Get(999, nullptr, nullptr, nullptr), -1);
+}
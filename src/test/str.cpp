@@ -1,9 +1,13 @@
 #include <gtest/gtest.h>
 
 #include <base/system.h>
+#include <base/unicode/confusables.h>
+#include <base/unicode/tolower.h>
 
 #include <game/gamecore.h>
 
+#include <algorithm>
+
 TEST(Str, StrDelim)
 {
 	int Start, End;
@@ -185,6 +189,44 @@ TEST(Str, Utf8ToSkeleton)
 	EXPECT_EQ(aBuf[5], 'u');
 }
 
+TEST(Str, Utf8ToSkeletonAllCodepoints)
+{
+	// compare the lookup table with a search of the sorted decomposition list
+	int aBuf[32];
+	char aChar[8];
+	for(int Code = 1; Code <= 0x10FFFF; Code++)
+	{
+		if(Code >= 0xD800 && Code <= 0xDFFF)
+			continue;
+		mem_zero(aChar, sizeof(aChar));
+		str_utf8_encode(aChar, Code);
+		const int Length = str_utf8_to_skeleton(aChar, aBuf, std::size(aBuf));
+
+		const int32_t *pDecomp = std::lower_bound(decomp_chars, decomp_chars + NUM_DECOMPS, Code);
+		if(pDecomp == decomp_chars + NUM_DECOMPS || *pDecomp != Code)
+		{
+			ASSERT_EQ(Length, 1) << "Code=" << Code;
+			ASSERT_EQ(aBuf[0], Code);
+			continue;
+		}
+		const DECOMP_SLICE &Slice = decomp_slices[pDecomp - decomp_chars];
+		ASSERT_EQ(Length, decomp_lengths[Slice.length]) << "Code=" << Code;
+		for(int i = 0; i < Length; i++)
+			ASSERT_EQ(aBuf[i], decomp_data[Slice.offset + i]) << "Code=" << Code;
+	}
+}
+
+TEST(Str, Utf8ToLowerAllCodepoints)
+{
+	// compare the lookup table with a search of the sorted mapping list
+	for(int Code = -1; Code <= 0x110000; Code++)
+	{
+		const UPPER_LOWER *pMapping = std::lower_bound(tolowermap, tolowermap + NUM_TOLOWER, Code, [](const UPPER_LOWER &Mapping, int Value) { return Mapping.upper < Value; });
+		const int Expected = pMapping != tolowermap + NUM_TOLOWER && pMapping->upper == Code ? pMapping->lower : Code;
+		ASSERT_EQ(str_utf8_tolower(Code), Expected) << "Code=" << Code;
+	}
+}
+
 TEST(Str, Utf8ToLower)
 {
 	EXPECT_TRUE(str_utf8_tolower('A') == 'a');
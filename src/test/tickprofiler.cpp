@@ -0,0 +1,117 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/shared/tickprofiler.h>
+
+TEST(TickProfiler, HistogramBuckets)
+{
+	const int64_t aValues[] = {0, 1, 15, 16, 17, 31, 32, 1000, 123456789, (int64_t)1 << 40};
+	for(int64_t Value : aValues)
+	{
+		const int Index = CDurationHistogram::BucketIndex(Value);
+		ASSERT_GE(Index, 0);
+		ASSERT_LT(Index, CDurationHistogram::NUM_BUCKETS);
+		EXPECT_LE(CDurationHistogram::BucketLowerBound(Index), Value);
+		if(Index + 1 < CDurationHistogram::NUM_BUCKETS)
+		{
+			EXPECT_GT(CDurationHistogram::BucketLowerBound(Index + 1), Value);
+		}
+	}
+	EXPECT_EQ(CDurationHistogram::BucketIndex(INT64_MAX), CDurationHistogram::NUM_BUCKETS - 1);
+}
+
+TEST(TickProfiler, HistogramPercentile)
+{
+	CDurationHistogram Histogram;
+	EXPECT_EQ(Histogram.Percentile(50), 0);
+
+	for(int i = 1; i <= 1000; i++)
+		Histogram.Record(i * 1000);
+	EXPECT_EQ(Histogram.Count(), 1000);
+	EXPECT_EQ(Histogram.Min(), 1000);
+	EXPECT_EQ(Histogram.Max(), 1000000);
+	EXPECT_EQ(Histogram.Mean(), 500500);
+	// the buckets are accurate to 1/16th of the value
+	EXPECT_NEAR(Histogram.Percentile(50), 500000, 500000 / 16);
+	EXPECT_NEAR(Histogram.Percentile(99), 990000, 990000 / 16);
+	EXPECT_EQ(Histogram.Percentile(100), CDurationHistogram::BucketLowerBound(CDurationHistogram::BucketIndex(1000000)));
+
+	Histogram.Reset();
+	EXPECT_EQ(Histogram.Count(), 0);
+	EXPECT_EQ(Histogram.Max(), 0);
+}
+
+TEST(TickProfiler, Sections)
+{
+	CTickProfiler Profiler;
+	const int Tick = Profiler.AddSection("tick");
+	const int Snap = Profiler.AddSection("snap");
+	EXPECT_NE(Tick, Snap);
+	EXPECT_EQ(Profiler.AddSection("tick"), Tick);
+	EXPECT_EQ(Profiler.NumSections(), 2);
+	EXPECT_STREQ(Profiler.SectionName(Snap), "snap");
+
+	{
+		CTickProfiler::CScope Scope(&Profiler, Tick);
+	}
+	EXPECT_EQ(Profiler.Histogram(Tick).Count(), 0);
+
+	Profiler.SetEnabled(true);
+	{
+		CTickProfiler::CScope Scope(&Profiler, Tick);
+	}
+	{
+		CTickProfiler::CScope Scope(nullptr, Tick);
+	}
+	Profiler.Record(Snap, 0, 2500);
+	EXPECT_EQ(Profiler.Histogram(Tick).Count(), 1);
+	EXPECT_EQ(Profiler.Histogram(Snap).Count(), 1);
+
+	char aBuf[256];
+	Profiler.FormatSummary(Snap, aBuf, sizeof(aBuf));
+	EXPECT_TRUE(str_startswith(aBuf, "snap: count=1 "));
+
+	Profiler.Reset();
+	EXPECT_EQ(Profiler.Histogram(Tick).Count(), 0);
+	EXPECT_EQ(Profiler.NumSections(), 2);
+}
+
+TEST(TickProfiler, ChromeTrace)
+{
+	CTickProfiler Profiler;
+	const int Section = Profiler.AddSection("tick");
+	const int Parent = Profiler.AddSection("parent");
+	Profiler.SetEnabled(true);
+	Profiler.SetTick(42);
+	// the nested scope ends and is recorded before its parent
+	Profiler.Record(Section, 1000000, 3000);
+	Profiler.Record(Parent, 990000, 15000);
+	Profiler.Record(Section, 1020000, 5000);
+	// durations in microseconds that do not fit into an int
+	Profiler.Record(Parent, 1030000, 3000000000000000);
+
+	CTestInfo Info;
+	char aFilename[IO_MAX_PATH_LENGTH];
+	Info.Filename(aFilename, sizeof(aFilename), ".json");
+	ASSERT_TRUE(Profiler.WriteChromeTrace(io_open(aFilename, IOFLAG_WRITE)));
+	EXPECT_FALSE(Profiler.WriteChromeTrace(nullptr));
+
+	IOHANDLE File = io_open(aFilename, IOFLAG_READ);
+	ASSERT_TRUE(File);
+	char *pOutput = io_read_all_str(File);
+	io_close(File);
+	ASSERT_TRUE(pOutput);
+	EXPECT_TRUE(str_find(pOutput, "\"traceEvents\""));
+	EXPECT_TRUE(str_find(pOutput, "\"ts\": 0"));
+	EXPECT_TRUE(str_find(pOutput, "\"ts\": 10"));
+	EXPECT_TRUE(str_find(pOutput, "\"ts\": 30"));
+	EXPECT_FALSE(str_find(pOutput, "\"ts\": -"));
+	EXPECT_TRUE(str_find(pOutput, "\"dur\": 3000000000000"));
+	EXPECT_TRUE(str_find(pOutput, "\"dur\": 5"));
+	EXPECT_TRUE(str_find(pOutput, "\"tick\": 42"));
+	free(pOutput);
+
+	if(!HasFailure())
+		fs_remove(aFilename);
+}
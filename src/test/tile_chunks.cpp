@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <engine/client/graphics_stub.h>
+
+#include <game/editor/mapitems/tile_chunks.h>
+#include <game/mapitems.h>
+
+#include <vector>
+
+static const int WIDTH = 200;
+static const int HEIGHT = 150;
+// 4 x 3 chunks, the last column and row are not full
+static const int NUM_CHUNKS = 12;
+
+class TileChunks : public ::testing::Test
+{
+protected:
+	CGraphicsStub m_Graphics;
+	std::vector<CTile> m_vTiles;
+
+	TileChunks() :
+		m_vTiles(WIDTH * HEIGHT)
+	{
+		// one tile in every chunk, so each chunk has a buffer container
+		for(int y = 0; y < HEIGHT; y += CTileChunks::CHUNK_SIZE)
+			for(int x = 0; x < WIDTH; x += CTileChunks::CHUNK_SIZE)
+				m_vTiles[y * WIDTH + x].m_Index = 1;
+		ShowAll();
+	}
+
+	void ShowAll()
+	{
+		m_Graphics.MapScreen(0.0f, 0.0f, WIDTH * 32.0f, HEIGHT * 32.0f);
+	}
+
+	void Render(CTileChunks &Chunks)
+	{
+		m_Graphics.ResetCounters();
+		Chunks.Render(&m_Graphics, m_vTiles.data(), WIDTH, HEIGHT, true, ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f));
+	}
+};
+
+TEST_F(TileChunks, OnlyInvalidatedChunksRebuilt)
+{
+	CTileChunks Chunks;
+	Render(Chunks);
+	EXPECT_EQ(Chunks.NumChunksRebuilt(), NUM_CHUNKS);
+	EXPECT_EQ(Chunks.NumChunksDrawn(), NUM_CHUNKS);
+	EXPECT_EQ(m_Graphics.m_NumBufferContainersCreated, NUM_CHUNKS);
+	EXPECT_EQ(m_Graphics.m_NumDrawCalls, NUM_CHUNKS);
+
+	Render(Chunks);
+	EXPECT_EQ(Chunks.NumChunksRebuilt(), 0);
+	EXPECT_EQ(Chunks.NumChunksDrawn(), NUM_CHUNKS);
+	EXPECT_EQ(m_Graphics.m_NumBufferContainersCreated, 0);
+
+	// a tile in the second chunk of the first row
+	m_vTiles[10 * WIDTH + 70].m_Index = 2;
+	Chunks.Invalidate(70, 10, 1, 1);
+	Render(Chunks);
+	EXPECT_EQ(Chunks.NumChunksRebuilt(), 1);
+	EXPECT_EQ(m_Graphics.m_NumBufferContainersCreated, 1);
+	EXPECT_EQ(m_Graphics.m_NumBufferContainers, NUM_CHUNKS);
+	EXPECT_EQ(m_Graphics.m_NumIndicesDrawn, (NUM_CHUNKS + 1) * 6u);
+
+	// a rectangle on the corner of four chunks
+	Chunks.Invalidate(63, 63, 2, 2);
+	Render(Chunks);
+	EXPECT_EQ(Chunks.NumChunksRebuilt(), 4);
+	EXPECT_EQ(m_Graphics.m_NumBufferContainersCreated, 4);
+
+	// an empty rectangle
+	Chunks.Invalidate(100, 100, 0, 0);
+	Render(Chunks);
+	EXPECT_EQ(Chunks.NumChunksRebuilt(), 0);
+}
+
+TEST_F(TileChunks, OnlyVisibleChunksRebuilt)
+{
+	CTileChunks Chunks;
+	m_Graphics.MapScreen(0.0f, 0.0f, 1000.0f, 1000.0f);
+	Render(Chunks);
+	EXPECT_EQ(Chunks.NumChunksRebuilt(), 1);
+	EXPECT_EQ(Chunks.NumChunksDrawn(), 1);
+
+	// the invalidated chunks off the screen stay dirty until they are shown
+	Chunks.InvalidateAll();
+	Render(Chunks);
+	EXPECT_EQ(Chunks.NumChunksRebuilt(), 1);
+	ShowAll();
+	Render(Chunks);
+	EXPECT_EQ(Chunks.NumChunksRebuilt(), NUM_CHUNKS - 1);
+	Render(Chunks);
+	EXPECT_EQ(Chunks.NumChunksRebuilt(), 0);
+}
+
+TEST_F(TileChunks, EmptyChunks)
+{
+	CTileChunks Chunks;
+	Render(Chunks);
+	EXPECT_EQ(m_Graphics.m_NumBufferContainers, NUM_CHUNKS);
+
+	// clearing the only tile of a chunk frees its buffer container
+	m_vTiles[0].m_Index = 0;
+	Chunks.Invalidate(0, 0, 1, 1);
+	Render(Chunks);
+	EXPECT_EQ(Chunks.NumChunksRebuilt(), 1);
+	EXPECT_EQ(Chunks.NumChunksDrawn(), NUM_CHUNKS - 1);
+	EXPECT_EQ(m_Graphics.m_NumBufferContainers, NUM_CHUNKS - 1);
+}
+
+TEST_F(TileChunks, Resize)
+{
+	{
+		CTileChunks Chunks;
+		Render(Chunks);
+		EXPECT_EQ(m_Graphics.m_NumBufferContainers, NUM_CHUNKS);
+
+		// a resized layer rebuilds everything and frees the old containers
+		Chunks.Render(&m_Graphics, m_vTiles.data(), WIDTH, 64, true, ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f));
+		EXPECT_EQ(Chunks.NumChunksRebuilt(), 4);
+		EXPECT_EQ(m_Graphics.m_NumBufferContainers, 4);
+	}
+	EXPECT_EQ(m_Graphics.m_NumBufferContainers, 0);
+	EXPECT_EQ(m_Graphics.m_NumBufferObjects, 0);
+}
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/shared/workergroup.h>
+
+#include <atomic>
+#include <vector>
+
+TEST(WorkerGroup, RunsEveryTaskOnce)
+{
+	for(int NumThreads : {0, 1, 4})
+	{
+		CWorkerGroup Workers;
+		Workers.Init(NumThreads);
+		EXPECT_EQ(Workers.NumThreads(), NumThreads);
+		for(int Batch = 0; Batch < 50; Batch++)
+		{
+			const int NumTasks = Batch % 17;
+			std::vector<std::atomic<int>> vCalls(NumTasks);
+			std::atomic<bool> BadWorker(false);
+			Workers.Run(NumTasks, [&](int Task, int Worker) {
+				vCalls[Task]++;
+				if(Worker < 0 || Worker > NumThreads)
+					BadWorker = true;
+			});
+			for(int i = 0; i < NumTasks; i++)
+				EXPECT_EQ(vCalls[i], 1);
+			EXPECT_FALSE(BadWorker);
+		}
+	}
+}
+
+TEST(WorkerGroup, Reinit)
+{
+	CWorkerGroup Workers;
+	std::atomic<int> Sum(0);
+	for(int NumThreads : {2, 0, 3})
+	{
+		Workers.Init(NumThreads);
+		Workers.Run(10, [&](int Task, int Worker) { Sum += Task; });
+	}
+	Workers.Shutdown();
+	Workers.Run(10, [&](int Task, int Worker) { Sum += Task; });
+	EXPECT_EQ(Sum, 4 * 45);
+}
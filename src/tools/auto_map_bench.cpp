@@ -0,0 +1,198 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/kernel.h>
+#include <engine/map.h>
+#include <engine/shared/linereader.h>
+#include <engine/shared/workergroup.h>
+#include <engine/storage.h>
+
+#include <game/editor/auto_map_rules.h>
+#include <game/layers.h>
+
+#include <memory>
+#include <vector>
+
+static const char *TOOL_NAME = "auto_map_bench";
+
+// the automapper before the rules were compiled, it went through the
+// lists of position rules for every tile
+static void ProceedLists(const CAutoMapRules &Rules, CTile *pTiles, int Width, int Height, int ConfigId, int Seed)
+{
+	const CAutoMapRules::CConfiguration *pConf = &Rules.Config(ConfigId);
+	for(size_t h = 0; h < pConf->m_vRuns.size(); ++h)
+	{
+		const CAutoMapRules::CRun *pRun = &pConf->m_vRuns[h];
+		std::vector<CTile> vCopy;
+		if(pRun->m_AutomapCopy)
+			vCopy.assign(pTiles, pTiles + Width * Height);
+		const CTile *pRead = pRun->m_AutomapCopy ? vCopy.data() : pTiles;
+
+		for(int y = 0; y < Height; y++)
+		{
+			for(int x = 0; x < Width; x++)
+			{
+				CTile *pTile = &pTiles[y * Width + x];
+				const CTile *pReadTile = &pRead[y * Width + x];
+				for(size_t i = 0; i < pRun->m_vIndexRules.size(); ++i)
+				{
+					const CAutoMapRules::CIndexRule *pIndexRule = &pRun->m_vIndexRules[i];
+					if(pIndexRule->m_SkipEmpty && pReadTile->m_Index == 0)
+						continue;
+					if(pIndexRule->m_SkipFull && pReadTile->m_Index != 0)
+						continue;
+
+					bool RespectRules = true;
+					for(size_t j = 0; j < pIndexRule->m_vRules.size() && RespectRules; ++j)
+					{
+						const CAutoMapRules::CPosRule *pRule = &pIndexRule->m_vRules[j];
+						int CheckIndex, CheckFlags;
+						int CheckX = x + pRule->m_X;
+						int CheckY = y + pRule->m_Y;
+						if(CheckX >= 0 && CheckX < Width && CheckY >= 0 && CheckY < Height)
+						{
+							int CheckTile = CheckY * Width + CheckX;
+							CheckIndex = pRead[CheckTile].m_Index;
+							CheckFlags = pRead[CheckTile].m_Flags & (TILEFLAG_ROTATE | TILEFLAG_XFLIP | TILEFLAG_YFLIP);
+						}
+						else
+						{
+							CheckIndex = -1;
+							CheckFlags = 0;
+						}
+
+						if(pRule->m_Value == CAutoMapRules::CPosRule::INDEX)
+						{
+							RespectRules = false;
+							for(const auto &Index : pRule->m_vIndexList)
+							{
+								if(CheckIndex == Index.m_Id && (!Index.m_TestFlag || CheckFlags == Index.m_Flag))
+								{
+									RespectRules = true;
+									break;
+								}
+							}
+						}
+						else if(pRule->m_Value == CAutoMapRules::CPosRule::NOTINDEX)
+						{
+							for(const auto &Index : pRule->m_vIndexList)
+							{
+								if(CheckIndex == Index.m_Id && (!Index.m_TestFlag || CheckFlags == Index.m_Flag))
+								{
+									RespectRules = false;
+									break;
+								}
+							}
+						}
+					}
+
+					if(RespectRules &&
+						(pIndexRule->m_RandomProbability >= 1.0f || CAutoMapRules::HashLocation(Seed, h, i, x, y) < CAutoMapRules::HASH_MAX * pIndexRule->m_RandomProbability))
+					{
+						pTile->m_Index = pIndexRule->m_Id;
+						pTile->m_Flags = pIndexRule->m_Flag;
+					}
+				}
+			}
+		}
+	}
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc < 2 || argc > 5)
+	{
+		log_error(TOOL_NAME, "Usage: %s <map> [rules] [threads] [repetitions]", TOOL_NAME);
+		log_error(TOOL_NAME, "the solid tiles of the game layer are automapped with the first configuration of the rules, e.g. editor/automap/grass_main.rules");
+		return -1;
+	}
+	const char *pRulesFile = argc > 2 ? argv[2] : "editor/automap/grass_main.rules";
+	const int NumThreads = argc > 3 ? clamp(str_toint(argv[3]), 1, 64) : 3;
+	const int NumRepetitions = argc > 4 ? maximum(str_toint(argv[4]), 1) : 10;
+
+	std::unique_ptr<IKernel> pKernel = std::unique_ptr<IKernel>(IKernel::Create());
+	IStorage *pStorage = CreateStorage(IStorage::STORAGETYPE_SERVER, argc, argv);
+	if(!pStorage)
+	{
+		log_error(TOOL_NAME, "could not initialize storage");
+		return -1;
+	}
+	pKernel->RegisterInterface(pStorage);
+	IEngineMap *pMap = CreateEngineMap();
+	pKernel->RegisterInterface(pMap);
+	pKernel->RegisterInterface(static_cast<IMap *>(pMap), false);
+	if(!pMap->Load(argv[1]))
+	{
+		log_error(TOOL_NAME, "could not load map '%s'", argv[1]);
+		return -1;
+	}
+
+	CAutoMapRules Rules;
+	CLineReader LineReader;
+	if(!LineReader.OpenFile(pStorage->OpenFile(pRulesFile, IOFLAG_READ, IStorage::TYPE_ALL)))
+	{
+		log_error(TOOL_NAME, "could not open rules '%s'", pRulesFile);
+		return -1;
+	}
+	Rules.Load(LineReader);
+	if(Rules.NumConfigs() == 0)
+	{
+		log_error(TOOL_NAME, "no configurations in '%s'", pRulesFile);
+		return -1;
+	}
+
+	// the solid tiles of the game layer, like a layer that was drawn with
+	// the first tile of a tileset
+	CLayers Layers;
+	Layers.Init(pMap, true);
+	const int Width = Layers.GameLayer()->m_Width;
+	const int Height = Layers.GameLayer()->m_Height;
+	const CTile *pGameTiles = static_cast<CTile *>(pMap->GetData(Layers.GameLayer()->m_Data));
+	std::vector<CTile> vTiles(pGameTiles, pGameTiles + Width * Height);
+	for(CTile &Tile : vTiles)
+	{
+		Tile.m_Index = Tile.m_Index == TILE_SOLID || Tile.m_Index == TILE_NOHOOK ? 1 : 0;
+		Tile.m_Flags = 0;
+	}
+
+	std::vector<CTile> vExpected;
+	const int64_t ListsStart = time_get_nanoseconds().count();
+	for(int i = 0; i < NumRepetitions; i++)
+	{
+		vExpected = vTiles;
+		ProceedLists(Rules, vExpected.data(), Width, Height, 0, 0);
+	}
+	const int64_t ListsDuration = time_get_nanoseconds().count() - ListsStart;
+
+	CWorkerGroup Workers;
+	Workers.Init(NumThreads);
+	bool Equal = true;
+	int64_t aDurations[2];
+	for(int Threaded = 0; Threaded < 2; Threaded++)
+	{
+		std::vector<CTile> vResult;
+		const int64_t Start = time_get_nanoseconds().count();
+		for(int i = 0; i < NumRepetitions; i++)
+		{
+			vResult = vTiles;
+			Rules.Proceed(vResult.data(), Width, Height, 0, 0, 0, 0, Threaded ? &Workers : nullptr, [](int x, int y, CTile Previous, CTile Tile) {});
+		}
+		aDurations[Threaded] = time_get_nanoseconds().count() - Start;
+		Equal = Equal && mem_comp(vResult.data(), vExpected.data(), vResult.size() * sizeof(CTile)) == 0;
+	}
+
+	log_info(TOOL_NAME, "%dx%d tiles, config '%s', %d repetitions", Width, Height, Rules.Config(0).m_aName, NumRepetitions);
+	log_info(TOOL_NAME, "rule lists: %.3fms", ListsDuration / 1000000.0 / NumRepetitions);
+	log_info(TOOL_NAME, "compiled rules: %.3fms", aDurations[0] / 1000000.0 / NumRepetitions);
+	log_info(TOOL_NAME, "compiled rules, %d threads: %.3fms", NumThreads, aDurations[1] / 1000000.0 / NumRepetitions);
+	if(!Equal)
+	{
+		log_error(TOOL_NAME, "the compiled rules changed the result");
+		return -1;
+	}
+	return 0;
+}
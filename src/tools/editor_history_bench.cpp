@@ -0,0 +1,231 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/storage.h>
+
+#include <game/editor/history_store.h>
+#include <game/mapitems.h>
+#include <game/prng.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+static const char *TOOL_NAME = "editor_history_bench";
+
+// same layout as STileStateChange of the editor
+struct STileChange
+{
+	bool m_Changed;
+	CTile m_Previous;
+	CTile m_Current;
+};
+
+typedef std::map<int, std::map<int, STileChange>> CTileChanges;
+
+// the editor history before the history store kept the maps, this is
+// about what they take on the heap
+static size_t EstimateMapMemory(const CTileChanges &Changes)
+{
+	const size_t NodeOverhead = 4 * sizeof(void *) + 16;
+	size_t Size = 0;
+	for(const auto &[y, Line] : Changes)
+		Size += NodeOverhead + sizeof(Line) + Line.size() * (NodeOverhead + sizeof(std::pair<const int, STileChange>));
+	return Size;
+}
+
+class CSession
+{
+	CPrng m_Prng;
+	int m_Width;
+	int m_Height;
+	std::vector<CTile> m_vTiles;
+
+	int Random(int Max) { return m_Prng.RandomBits() % Max; }
+
+	void Change(CTileChanges &Changes, int x, int y, CTile Tile)
+	{
+		if(x < 0 || y < 0 || x >= m_Width || y >= m_Height)
+			return;
+		CTile &Current = m_vTiles[y * m_Width + x];
+		auto &Change = Changes[y][x];
+		if(!Change.m_Changed)
+			Change = {true, Current, Tile};
+		Change.m_Current = Tile;
+		Current = Tile;
+	}
+
+public:
+	CSession(int Width, int Height) :
+		m_Width(Width), m_Height(Height), m_vTiles(Width * Height)
+	{
+		uint64_t aSeed[2] = {0x5eed, 0xed17};
+		m_Prng.Seed(aSeed);
+		mem_zero(m_vTiles.data(), m_vTiles.size() * sizeof(CTile));
+	}
+
+	const std::vector<CTile> &Tiles() const { return m_vTiles; }
+
+	// mostly brush strokes and some fills, every few hundred steps the
+	// whole layer is automapped
+	CTileChanges Step()
+	{
+		CTileChanges Changes;
+		const int Kind = Random(1000);
+		CTile Tile = {(unsigned char)(1 + Random(255)), (unsigned char)(Random(4) * TILEFLAG_XFLIP), 0, 0};
+		if(Kind < 700)
+		{
+			int x = Random(m_Width);
+			int y = Random(m_Height);
+			const int Length = 1 + Random(60);
+			for(int i = 0; i < Length; i++)
+			{
+				x += Random(3) - 1;
+				y += Random(3) - 1;
+				for(int by = -1; by <= 1; by++)
+					for(int bx = -1; bx <= 1; bx++)
+						Change(Changes, x + bx, y + by, Tile);
+			}
+		}
+		else if(Kind < 990)
+		{
+			const int w = 1 + Random(Kind < 950 ? 100 : m_Width / 2);
+			const int h = 1 + Random(Kind < 950 ? 100 : m_Height / 2);
+			const int x0 = Random(m_Width);
+			const int y0 = Random(m_Height);
+			for(int y = y0; y < y0 + h; y++)
+				for(int x = x0; x < x0 + w; x++)
+					Change(Changes, x, y, Tile);
+		}
+		else
+		{
+			for(int y = 0; y < m_Height; y++)
+			{
+				for(int x = 0; x < m_Width; x++)
+				{
+					CTile Automapped = m_vTiles[y * m_Width + x];
+					if(Automapped.m_Index == 0)
+						continue;
+					Automapped.m_Index = 1 + (x + y) % 16;
+					Automapped.m_Flags = Random(16) & (TILEFLAG_XFLIP | TILEFLAG_YFLIP);
+					Change(Changes, x, y, Automapped);
+				}
+			}
+		}
+		return Changes;
+	}
+};
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc > 5)
+	{
+		log_error(TOOL_NAME, "Usage: %s [steps] [memory_mib] [max_history] [size]", TOOL_NAME);
+		return -1;
+	}
+	const int NumSteps = argc > 1 ? maximum(str_toint(argv[1]), 1) : 2000;
+	const size_t MemoryLimit = (size_t)(argc > 2 ? maximum(str_toint(argv[2]), 0) : 64) * 1024 * 1024;
+	const int MaxHistory = argc > 3 ? maximum(str_toint(argv[3]), 1) : 500;
+	const int Size = argc > 4 ? maximum(str_toint(argv[4]), 16) : 1000;
+
+	char aSpillPath[IO_MAX_PATH_LENGTH];
+	IStorage::FormatTmpPath(aSpillPath, sizeof(aSpillPath), TOOL_NAME);
+	CHistoryStore Store;
+	Store.Init(aSpillPath, MemoryLimit);
+
+	// record the session like the editor history does, the oldest entries
+	// are dropped after `MaxHistory` steps
+	CSession Session(Size, Size);
+	std::deque<CTileChanges> vMaps;
+	std::deque<int> vIds;
+	size_t MapMemory = 0;
+	size_t PeakMapMemory = 0;
+	size_t PeakStoreMemory = 0;
+	int64_t RecordDuration = 0;
+	int64_t MaxRecordDuration = 0;
+	int NumChanges = 0;
+	for(int Step = 0; Step < NumSteps; Step++)
+	{
+		CTileChanges Changes = Session.Step();
+		NumChanges += NumTileChanges(Changes);
+
+		const int64_t Start = time_get_nanoseconds().count();
+		vIds.push_back(Store.Add(PackTileChanges(Changes)));
+		if((int)vIds.size() > MaxHistory)
+		{
+			Store.Remove(vIds.front());
+			vIds.pop_front();
+		}
+		const int64_t Duration = time_get_nanoseconds().count() - Start;
+		RecordDuration += Duration;
+		MaxRecordDuration = maximum(MaxRecordDuration, Duration);
+		PeakStoreMemory = maximum(PeakStoreMemory, Store.MemoryUsage());
+
+		MapMemory += EstimateMapMemory(Changes);
+		vMaps.push_back(std::move(Changes));
+		if((int)vMaps.size() > MaxHistory)
+		{
+			MapMemory -= EstimateMapMemory(vMaps.front());
+			vMaps.pop_front();
+		}
+		PeakMapMemory = maximum(PeakMapMemory, MapMemory);
+	}
+
+	// undo and then redo everything that is still in the history, with both
+	std::vector<CTile> vMapTiles = Session.Tiles();
+	std::vector<CTile> vStoreTiles = Session.Tiles();
+	const auto &&Apply = [Size](std::vector<CTile> &vTiles, int x, int y, const STileChange &Change, bool Undo) {
+		vTiles[y * Size + x] = Undo ? Change.m_Previous : Change.m_Current;
+	};
+	int64_t aMapDurations[2] = {0, 0};
+	int64_t aStoreDurations[2] = {0, 0};
+	int64_t aMaxStoreDurations[2] = {0, 0};
+	std::vector<unsigned char> vData;
+	bool Error = false;
+	for(int Undo = 1; Undo >= 0; Undo--)
+	{
+		for(int i = 0; i < (int)vIds.size(); i++)
+		{
+			const int Entry = Undo ? vIds.size() - 1 - i : i;
+
+			int64_t Start = time_get_nanoseconds().count();
+			for(const auto &[y, Line] : vMaps[Entry])
+				for(const auto &[x, Change] : Line)
+					Apply(vMapTiles, x, y, Change, Undo);
+			aMapDurations[Undo] += time_get_nanoseconds().count() - Start;
+
+			Start = time_get_nanoseconds().count();
+			if(!Store.Get(vIds[Entry], vData))
+				Error = true;
+			ForEachTileChange<STileChange>(vData, [&](int x, int y, const STileChange &Change) {
+				Apply(vStoreTiles, x, y, Change, Undo);
+			});
+			const int64_t Duration = time_get_nanoseconds().count() - Start;
+			aStoreDurations[Undo] += Duration;
+			aMaxStoreDurations[Undo] = maximum(aMaxStoreDurations[Undo], Duration);
+		}
+		if(mem_comp(vMapTiles.data(), vStoreTiles.data(), vMapTiles.size() * sizeof(CTile)) != 0)
+			Error = true;
+	}
+
+	const int NumEntries = vIds.size();
+	log_info(TOOL_NAME, "%d steps with %d tile changes on %dx%d tiles, %d in the history", NumSteps, NumChanges, Size, Size, NumEntries);
+	log_info(TOOL_NAME, "maps: %.1f MiB at most (estimated)", PeakMapMemory / 1024.0 / 1024.0);
+	log_info(TOOL_NAME, "store: %.1f MiB at most in memory, %.1f MiB in the file at the end", PeakStoreMemory / 1024.0 / 1024.0, Store.SpilledSize() / 1024.0 / 1024.0);
+	log_info(TOOL_NAME, "store: record %.3fms per step, %.3fms at most", RecordDuration / 1000000.0 / NumSteps, MaxRecordDuration / 1000000.0);
+	for(int Undo = 1; Undo >= 0; Undo--)
+	{
+		log_info(TOOL_NAME, "%s: maps %.3fms, store %.3fms per step, store %.3fms at most", Undo ? "undo" : "redo",
+			aMapDurations[Undo] / 1000000.0 / NumEntries, aStoreDurations[Undo] / 1000000.0 / NumEntries, aMaxStoreDurations[Undo] / 1000000.0);
+	}
+	if(Error)
+	{
+		log_error(TOOL_NAME, "the history store changed the result");
+		return -1;
+	}
+	return 0;
+}
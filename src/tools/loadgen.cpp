@@ -0,0 +1,469 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/message.h>
+#include <engine/shared/config.h>
+#include <engine/shared/network.h>
+#include <engine/shared/packer.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/protocol_ex.h>
+#include <engine/shared/snapshot.h>
+
+#include <game/generated/protocol.h>
+#include <game/version.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+static const char *TOOL_NAME = "loadgen";
+
+// a headless client that connects, downloads the map, joins the game and
+// sends scripted input, while recording what it receives from the server
+class CBot
+{
+public:
+	enum EState
+	{
+		STATE_WAITING,
+		STATE_CONNECTING,
+		STATE_LOADING,
+		STATE_INGAME,
+		STATE_DISCONNECTED,
+	};
+
+	int m_Id;
+	EState m_State = STATE_WAITING;
+	int64_t m_StartTime;
+	CNetClient m_NetClient;
+	bool m_SentInfo = false;
+
+	// map download
+	int m_MapCrc = 0;
+	int m_MapChunk = 0;
+	int m_MapBytes = 0;
+
+	// snapshots
+	int m_AckGameTick = -1;
+	int64_t m_AckTime = 0;
+	int m_SnapTick = -1;
+	uint64_t m_SnapPartsReceived = 0;
+	int m_SnapSize = 0;
+	int64_t m_LastSnapTime = 0;
+	int m_InputTick = 0;
+
+	// statistics
+	int64_t m_ConnectTime = 0;
+	int64_t m_InGameTime = 0;
+	int64_t m_NumBytesReceived = 0;
+	int m_NumSnapshots = 0;
+	int64_t m_SnapshotBytes = 0;
+	int m_MaxSnapshotSize = 0;
+	int64_t m_MaxSnapshotInterval = 0;
+	char m_aDisconnectReason[128] = "";
+
+	CBot(int Id, int64_t StartTime) :
+		m_Id(Id), m_StartTime(StartTime)
+	{
+	}
+
+	bool Open(const NETADDR &BindAddr)
+	{
+		return m_NetClient.Open(BindAddr);
+	}
+
+	void SendMsg(CMsgPacker *pMsg, int Flags)
+	{
+		CPacker Packer;
+		Packer.Reset();
+		if(pMsg->m_MsgId < OFFSET_UUID)
+		{
+			Packer.AddInt((pMsg->m_MsgId << 1) | (pMsg->m_System ? 1 : 0));
+		}
+		else
+		{
+			Packer.AddInt(pMsg->m_System ? 1 : 0); // NETMSG_EX, NETMSGTYPE_EX
+			g_UuidManager.PackUuid(pMsg->m_MsgId, &Packer);
+		}
+		Packer.AddRaw(pMsg->Data(), pMsg->Size());
+
+		CNetChunk Packet;
+		mem_zero(&Packet, sizeof(Packet));
+		Packet.m_ClientId = 0;
+		Packet.m_pData = Packer.Data();
+		Packet.m_DataSize = Packer.Size();
+		if(Flags & MSGFLAG_VITAL)
+			Packet.m_Flags |= NETSENDFLAG_VITAL;
+		if(Flags & MSGFLAG_FLUSH)
+			Packet.m_Flags |= NETSENDFLAG_FLUSH;
+		m_NetClient.Send(&Packet);
+	}
+
+	void SendInfo()
+	{
+		CUuid ConnectionId = RandomUuid();
+		CMsgPacker MsgVer(NETMSG_CLIENTVER, true);
+		MsgVer.AddRaw(&ConnectionId, sizeof(ConnectionId));
+		MsgVer.AddInt(DDNET_VERSION_NUMBER);
+		MsgVer.AddString(GAME_NAME " " GAME_RELEASE_VERSION " (loadgen)");
+		SendMsg(&MsgVer, MSGFLAG_VITAL);
+
+		CMsgPacker Msg(NETMSG_INFO, true);
+		Msg.AddString(GAME_NETVERSION);
+		Msg.AddString("");
+		SendMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_FLUSH);
+	}
+
+	void SendMapRequest()
+	{
+		CMsgPacker Msg(NETMSG_REQUEST_MAP_DATA, true);
+		Msg.AddInt(m_MapChunk);
+		SendMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_FLUSH);
+	}
+
+	void SendStartInfo()
+	{
+		char aName[16];
+		str_format(aName, sizeof(aName), "loadgen %d", m_Id);
+		CNetMsg_Cl_StartInfo StartInfo;
+		StartInfo.m_pName = aName;
+		StartInfo.m_pClan = "";
+		StartInfo.m_Country = -1;
+		StartInfo.m_pSkin = "default";
+		StartInfo.m_UseCustomColor = 0;
+		StartInfo.m_ColorBody = 0;
+		StartInfo.m_ColorFeet = 0;
+		CMsgPacker Msg(&StartInfo);
+		StartInfo.Pack(&Msg);
+		SendMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_FLUSH);
+
+		CMsgPacker MsgEnter(NETMSG_ENTERGAME, true);
+		SendMsg(&MsgEnter, MSGFLAG_VITAL | MSGFLAG_FLUSH);
+	}
+
+	void SendInput(int64_t Now)
+	{
+		// estimate the current server tick from the last snapshot and predict a bit ahead
+		const int ServerTick = m_AckGameTick + (int)((Now - m_AckTime) * SERVER_TICK_SPEED / time_freq());
+		const int PredTick = ServerTick + 2;
+		if(PredTick <= m_InputTick)
+			return;
+		m_InputTick = PredTick;
+
+		// run around, aim in circles, jump, hook and shoot every now and then
+		CNetObj_PlayerInput Input;
+		mem_zero(&Input, sizeof(Input));
+		const float Angle = PredTick * 0.05f + m_Id;
+		Input.m_Direction = (PredTick / SERVER_TICK_SPEED + m_Id) % 3 - 1;
+		Input.m_TargetX = (int)(std::cos(Angle) * 100.0f);
+		Input.m_TargetY = (int)(std::sin(Angle) * 100.0f);
+		Input.m_Jump = (PredTick + m_Id) % 37 < 2;
+		Input.m_Fire = (PredTick + m_Id) / 10;
+		Input.m_Hook = (PredTick + m_Id) / 60 % 2;
+		Input.m_PlayerFlags = PLAYERFLAG_PLAYING;
+
+		CMsgPacker Msg(NETMSG_INPUT, true);
+		Msg.AddInt(m_AckGameTick);
+		Msg.AddInt(PredTick);
+		Msg.AddInt(sizeof(Input));
+		const int *pData = (const int *)&Input;
+		for(unsigned i = 0; i < sizeof(Input) / sizeof(int); i++)
+			Msg.AddInt(pData[i]);
+		SendMsg(&Msg, MSGFLAG_FLUSH);
+	}
+
+	void OnSnapshot(int GameTick, int64_t Now)
+	{
+		if(m_LastSnapTime)
+			m_MaxSnapshotInterval = maximum(m_MaxSnapshotInterval, Now - m_LastSnapTime);
+		m_LastSnapTime = Now;
+		m_NumSnapshots++;
+		m_SnapshotBytes += m_SnapSize;
+		m_MaxSnapshotSize = maximum(m_MaxSnapshotSize, m_SnapSize);
+		if(GameTick > m_AckGameTick)
+		{
+			m_AckGameTick = GameTick;
+			m_AckTime = Now;
+		}
+	}
+
+	void ProcessPacket(CNetChunk *pPacket, int64_t Now)
+	{
+		m_NumBytesReceived += pPacket->m_DataSize;
+
+		CUnpacker Unpacker;
+		Unpacker.Reset(pPacket->m_pData, pPacket->m_DataSize);
+		CMsgPacker Packer(NETMSG_EX, true);
+		int Msg;
+		bool Sys;
+		CUuid Uuid;
+		const int Result = UnpackMessageId(&Msg, &Sys, &Uuid, &Unpacker, &Packer);
+		if(Result == UNPACKMESSAGE_ERROR)
+			return;
+		else if(Result == UNPACKMESSAGE_ANSWER)
+			SendMsg(&Packer, MSGFLAG_VITAL);
+
+		if(!Sys)
+			return;
+
+		if(Msg == NETMSG_MAP_CHANGE && (pPacket->m_Flags & NET_CHUNKFLAG_VITAL))
+		{
+			Unpacker.GetString();
+			m_MapCrc = Unpacker.GetInt();
+			Unpacker.GetInt(); // map size
+			if(Unpacker.Error())
+				return;
+			m_State = STATE_LOADING;
+			m_MapChunk = 0;
+			m_MapBytes = 0;
+			SendMapRequest();
+		}
+		else if(Msg == NETMSG_MAP_DATA)
+		{
+			const int Last = Unpacker.GetInt();
+			const int MapCrc = Unpacker.GetInt();
+			const int Chunk = Unpacker.GetInt();
+			const int Size = Unpacker.GetInt();
+			Unpacker.GetRaw(Size);
+			if(Unpacker.Error() || Size <= 0 || MapCrc != m_MapCrc || Chunk != m_MapChunk)
+				return;
+
+			m_MapBytes += Size;
+			if(Last)
+			{
+				CMsgPacker MsgReady(NETMSG_READY, true);
+				SendMsg(&MsgReady, MSGFLAG_VITAL | MSGFLAG_FLUSH);
+			}
+			else
+			{
+				m_MapChunk++;
+				SendMapRequest();
+			}
+		}
+		else if(Msg == NETMSG_CON_READY && (pPacket->m_Flags & NET_CHUNKFLAG_VITAL))
+		{
+			SendStartInfo();
+			m_State = STATE_INGAME;
+			m_InGameTime = Now;
+		}
+		else if(Msg == NETMSG_PING)
+		{
+			CMsgPacker MsgReply(NETMSG_PING_REPLY, true);
+			SendMsg(&MsgReply, MSGFLAG_FLUSH | ((pPacket->m_Flags & NET_CHUNKFLAG_VITAL) ? MSGFLAG_VITAL : 0));
+		}
+		else if(Msg == NETMSG_SNAP || Msg == NETMSG_SNAPSINGLE || Msg == NETMSG_SNAPEMPTY)
+		{
+			const int GameTick = Unpacker.GetInt();
+			Unpacker.GetInt(); // delta tick
+			int NumParts = 1;
+			int Part = 0;
+			int PartSize = 0;
+			if(Msg == NETMSG_SNAP)
+			{
+				NumParts = Unpacker.GetInt();
+				Part = Unpacker.GetInt();
+			}
+			if(Msg != NETMSG_SNAPEMPTY)
+			{
+				Unpacker.GetInt(); // crc
+				PartSize = Unpacker.GetInt();
+				Unpacker.GetRaw(PartSize);
+			}
+			if(Unpacker.Error() || NumParts < 1 || NumParts > CSnapshot::MAX_PARTS || Part < 0 || Part >= NumParts || PartSize < 0)
+				return;
+
+			if(GameTick != m_SnapTick)
+			{
+				m_SnapTick = GameTick;
+				m_SnapPartsReceived = 0;
+				m_SnapSize = 0;
+			}
+			m_SnapPartsReceived |= (uint64_t)1 << Part;
+			m_SnapSize += PartSize;
+			if(m_SnapPartsReceived == (NumParts == 64 ? ~(uint64_t)0 : ((uint64_t)1 << NumParts) - 1))
+				OnSnapshot(GameTick, Now);
+		}
+	}
+
+	void Update(const NETADDR &ServerAddr, int64_t Now)
+	{
+		if(m_State == STATE_WAITING)
+		{
+			if(Now < m_StartTime)
+				return;
+			m_NetClient.Connect(&ServerAddr, 1);
+			m_State = STATE_CONNECTING;
+		}
+		if(m_State == STATE_DISCONNECTED)
+			return;
+
+		m_NetClient.Update();
+		if(m_NetClient.State() == NETSTATE_OFFLINE)
+		{
+			str_copy(m_aDisconnectReason, m_NetClient.ErrorString());
+			m_State = STATE_DISCONNECTED;
+			return;
+		}
+		if(m_NetClient.State() == NETSTATE_ONLINE && !m_SentInfo)
+		{
+			m_ConnectTime = Now;
+			m_SentInfo = true;
+			SendInfo();
+		}
+
+		CNetChunk Packet;
+		SECURITY_TOKEN ResponseToken;
+		while(m_NetClient.Recv(&Packet, &ResponseToken, false))
+		{
+			if(Packet.m_ClientId != -1)
+				ProcessPacket(&Packet, Now);
+		}
+
+		if(m_State == STATE_INGAME && m_AckGameTick >= 0)
+			SendInput(Now);
+	}
+
+	void Report(int64_t EndTime) const
+	{
+		static const char *s_apStateNames[] = {"waiting", "connecting", "loading", "ingame", "disconnected"};
+		const double Freq = time_freq();
+		const double InGameSeconds = m_InGameTime ? (EndTime - m_InGameTime) / Freq : 0.0;
+		log_info(TOOL_NAME, "client=%d state=%s connect=%.1fms join=%.1fms map=%dB snaps=%d avg_snap=%dB max_snap=%dB max_interval=%.1fms recv=%.1fKiB/s%s%s",
+			m_Id, s_apStateNames[m_State],
+			m_ConnectTime ? (m_ConnectTime - m_StartTime) * 1000.0 / Freq : 0.0,
+			m_InGameTime ? (m_InGameTime - m_StartTime) * 1000.0 / Freq : 0.0,
+			m_MapBytes, m_NumSnapshots,
+			m_NumSnapshots ? (int)(m_SnapshotBytes / m_NumSnapshots) : 0, m_MaxSnapshotSize,
+			m_MaxSnapshotInterval * 1000.0 / Freq,
+			InGameSeconds > 0.0 ? m_NumBytesReceived / InGameSeconds / 1024.0 : 0.0,
+			m_aDisconnectReason[0] ? " reason=" : "", m_aDisconnectReason);
+	}
+};
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+
+	log_set_global_logger_default();
+	if(secure_random_init() != 0)
+	{
+		log_error(TOOL_NAME, "could not initialize secure RNG");
+		return -1;
+	}
+
+	if(argc < 3 || argc > 5)
+	{
+		log_error(TOOL_NAME, "usage: %s server[:port] num_clients [duration_seconds] [connects_per_second]", argv[0]);
+		log_error(TOOL_NAME, "clients connecting to a local IPv4 server each use their own loopback address,");
+		log_error(TOOL_NAME, "otherwise sv_max_clients_per_ip and sv_connlimit of the server have to be raised");
+		return -1;
+	}
+
+	NETADDR ServerAddr;
+	if(net_host_lookup(argv[1], &ServerAddr, NETTYPE_ALL))
+	{
+		log_error(TOOL_NAME, "host lookup failed");
+		return -1;
+	}
+	if(ServerAddr.port == 0)
+		ServerAddr.port = 8303;
+
+	const int NumClients = str_toint(argv[2]);
+	const int Duration = argc > 3 ? str_toint(argv[3]) : 60;
+	const int ConnectsPerSecond = argc > 4 ? str_toint(argv[4]) : 10;
+	if(NumClients <= 0 || Duration <= 0 || ConnectsPerSecond <= 0)
+	{
+		log_error(TOOL_NAME, "num_clients, duration_seconds and connects_per_second must be positive");
+		return -1;
+	}
+
+	net_init();
+	CNetBase::Init();
+
+	// the connection timeouts are read from the config
+	g_Config.m_ConnTimeout = CConfig::ms_ConnTimeout;
+	g_Config.m_ConnTimeoutProtection = CConfig::ms_ConnTimeoutProtection;
+
+	const bool LocalServer = ServerAddr.type == NETTYPE_IPV4 && ServerAddr.ip[0] == 127;
+	const int64_t Freq = time_freq();
+	const int64_t StartTime = time_get();
+	std::vector<std::unique_ptr<CBot>> vpBots;
+	for(int i = 0; i < NumClients; i++)
+	{
+		NETADDR BindAddr;
+		mem_zero(&BindAddr, sizeof(BindAddr));
+		BindAddr.type = ServerAddr.type == NETTYPE_IPV6 ? NETTYPE_IPV6 : NETTYPE_IPV4;
+		if(LocalServer)
+		{
+			// 127.1.x.y, so that the per-address limits of the server don't apply
+			BindAddr.ip[0] = 127;
+			BindAddr.ip[1] = 1;
+			BindAddr.ip[2] = i / 250;
+			BindAddr.ip[3] = i % 250 + 1;
+		}
+
+		auto pBot = std::make_unique<CBot>(i, StartTime + i * Freq / ConnectsPerSecond);
+		if(!pBot->Open(BindAddr))
+		{
+			log_error(TOOL_NAME, "could not open socket for client %d", i);
+			return -1;
+		}
+		vpBots.push_back(std::move(pBot));
+	}
+
+	log_info(TOOL_NAME, "running %d clients for %d seconds", NumClients, Duration);
+	const int64_t EndTime = StartTime + Duration * Freq;
+	int64_t LastStatusTime = StartTime;
+	while(true)
+	{
+		const int64_t Now = time_get();
+		if(Now >= EndTime)
+			break;
+
+		for(auto &pBot : vpBots)
+			pBot->Update(ServerAddr, Now);
+
+		if(Now - LastStatusTime >= 5 * Freq)
+		{
+			LastStatusTime = Now;
+			int aNumStates[CBot::STATE_DISCONNECTED + 1] = {0};
+			for(const auto &pBot : vpBots)
+				aNumStates[pBot->m_State]++;
+			log_info(TOOL_NAME, "waiting=%d connecting=%d loading=%d ingame=%d disconnected=%d",
+				aNumStates[CBot::STATE_WAITING], aNumStates[CBot::STATE_CONNECTING], aNumStates[CBot::STATE_LOADING],
+				aNumStates[CBot::STATE_INGAME], aNumStates[CBot::STATE_DISCONNECTED]);
+		}
+
+		std::this_thread::sleep_for(1ms);
+	}
+
+	const int64_t StopTime = time_get();
+	int NumInGame = 0;
+	int64_t TotalSnapshots = 0;
+	int64_t TotalSnapshotBytes = 0;
+	int64_t TotalBytes = 0;
+	int64_t MaxInterval = 0;
+	for(auto &pBot : vpBots)
+	{
+		pBot->Report(StopTime);
+		if(pBot->m_State == CBot::STATE_INGAME)
+			NumInGame++;
+		TotalSnapshots += pBot->m_NumSnapshots;
+		TotalSnapshotBytes += pBot->m_SnapshotBytes;
+		TotalBytes += pBot->m_NumBytesReceived;
+		MaxInterval = maximum(MaxInterval, pBot->m_MaxSnapshotInterval);
+
+		pBot->m_NetClient.Disconnect("loadgen finished");
+		pBot->m_NetClient.Close();
+	}
+	log_info(TOOL_NAME, "total ingame=%d/%d snaps=%" PRId64 " avg_snap=%dB max_interval=%.1fms recv=%.1fKiB/s",
+		NumInGame, NumClients, TotalSnapshots,
+		TotalSnapshots ? (int)(TotalSnapshotBytes / TotalSnapshots) : 0,
+		MaxInterval * 1000.0 / Freq,
+		TotalBytes / ((StopTime - StartTime) / (double)Freq) / 1024.0);
+	return 0;
+}
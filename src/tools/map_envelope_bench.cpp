@@ -0,0 +1,169 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/datafile.h>
+#include <engine/storage.h>
+
+#include <game/envelope.h>
+#include <game/mapitems.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+static const char *TOOL_NAME = "map_envelope_bench";
+
+// one envelope evaluation as done by the client when rendering a frame
+struct CEnvelopeRequest
+{
+	int m_Env;
+	int m_TimeOffsetMillis;
+	size_t m_Channels;
+};
+
+static void AddRequest(std::vector<CEnvelopeRequest> &vRequests, int Env, int TimeOffsetMillis, size_t Channels)
+{
+	vRequests.push_back({Env, TimeOffsetMillis, Channels});
+}
+
+// collects the envelope evaluations of all quads, tile layers and sound sources
+static std::vector<CEnvelopeRequest> CollectRequests(CDataFileReader &Reader)
+{
+	std::vector<CEnvelopeRequest> vRequests;
+
+	int LayersStart, LayersNum;
+	Reader.GetType(MAPITEMTYPE_LAYER, &LayersStart, &LayersNum);
+	for(int i = 0; i < LayersNum; i++)
+	{
+		const CMapItemLayer *pLayer = (CMapItemLayer *)Reader.GetItem(LayersStart + i);
+		if(pLayer->m_Type == LAYERTYPE_TILES)
+		{
+			const CMapItemLayerTilemap *pTilemap = (CMapItemLayerTilemap *)pLayer;
+			AddRequest(vRequests, pTilemap->m_ColorEnv, pTilemap->m_ColorEnvOffset, 4);
+		}
+		else if(pLayer->m_Type == LAYERTYPE_QUADS)
+		{
+			const CMapItemLayerQuads *pQuadLayer = (CMapItemLayerQuads *)pLayer;
+			const CQuad *pQuads = (CQuad *)Reader.GetData(pQuadLayer->m_Data);
+			const int NumQuads = minimum<int>(pQuadLayer->m_NumQuads, Reader.GetDataSize(pQuadLayer->m_Data) / sizeof(CQuad));
+			for(int Quad = 0; Quad < NumQuads; Quad++)
+			{
+				AddRequest(vRequests, pQuads[Quad].m_ColorEnv, pQuads[Quad].m_ColorEnvOffset, 4);
+				AddRequest(vRequests, pQuads[Quad].m_PosEnv, pQuads[Quad].m_PosEnvOffset, 3);
+			}
+		}
+		else if(pLayer->m_Type == LAYERTYPE_SOUNDS)
+		{
+			const CMapItemLayerSounds *pSoundLayer = (CMapItemLayerSounds *)pLayer;
+			if(pSoundLayer->m_Version < 2 || pSoundLayer->m_Version > CMapItemLayerSounds::CURRENT_VERSION)
+				continue;
+			const CSoundSource *pSources = (CSoundSource *)Reader.GetData(pSoundLayer->m_Data);
+			const int NumSources = minimum<int>(pSoundLayer->m_NumSources, Reader.GetDataSize(pSoundLayer->m_Data) / sizeof(CSoundSource));
+			for(int Source = 0; Source < NumSources; Source++)
+			{
+				AddRequest(vRequests, pSources[Source].m_PosEnv, pSources[Source].m_PosEnvOffset, 2);
+				AddRequest(vRequests, pSources[Source].m_SoundEnv, pSources[Source].m_SoundEnvOffset, 1);
+			}
+		}
+	}
+	return vRequests;
+}
+
+// mirrors CMapLayers::EnvelopeEval, with the cache being optional
+static void Evaluate(CDataFileReader &Reader, const CEnvelopeRequest &Request, std::chrono::nanoseconds Time, CEnvelopeEvalCache *pCache, ColorRGBA &Result)
+{
+	int EnvStart, EnvNum;
+	Reader.GetType(MAPITEMTYPE_ENVELOPE, &EnvStart, &EnvNum);
+	if(Request.m_Env < 0 || Request.m_Env >= EnvNum)
+		return;
+
+	const CMapItemEnvelope *pItem = (CMapItemEnvelope *)Reader.GetItem(EnvStart + Request.m_Env);
+	if(pItem->m_Channels <= 0)
+		return;
+	const size_t Channels = minimum<size_t>(Request.m_Channels, pItem->m_Channels, CEnvPoint::MAX_CHANNELS);
+
+	if(pCache && pCache->Find(Request.m_Env, Request.m_TimeOffsetMillis, Channels, Result))
+		return;
+
+	CMapBasedEnvelopePointAccess EnvelopePoints(&Reader);
+	EnvelopePoints.SetPointsRange(pItem->m_StartPoint, pItem->m_NumPoints);
+	if(EnvelopePoints.NumPoints() == 0)
+		return;
+
+	EvalEnvelope(&EnvelopePoints, Time + std::chrono::milliseconds(Request.m_TimeOffsetMillis), Result, Channels);
+	if(pCache)
+		pCache->Add(Request.m_Env, Request.m_TimeOffsetMillis, Channels, Result);
+}
+
+// returns the checksum of all evaluated values so that the passes can be compared
+static double RunPass(CDataFileReader &Reader, const std::vector<CEnvelopeRequest> &vRequests, int Frames, CEnvelopeEvalCache *pCache, int64_t &Duration, int &MaxCacheSize)
+{
+	double Checksum = 0.0;
+	MaxCacheSize = 0;
+	const int64_t Start = time_get_nanoseconds().count();
+	for(int Frame = 0; Frame < Frames; Frame++)
+	{
+		const std::chrono::nanoseconds Time = std::chrono::nanoseconds(1s) * Frame / 60;
+		if(pCache)
+			pCache->Clear();
+		for(const CEnvelopeRequest &Request : vRequests)
+		{
+			ColorRGBA Result(1.0f, 1.0f, 1.0f, 1.0f);
+			Evaluate(Reader, Request, Time, pCache, Result);
+			Checksum += Result.r + Result.g + Result.b + Result.a;
+		}
+		if(pCache)
+			MaxCacheSize = maximum(MaxCacheSize, pCache->Size());
+	}
+	Duration = time_get_nanoseconds().count() - Start;
+	return Checksum;
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc < 2 || argc > 3)
+	{
+		log_error(TOOL_NAME, "Usage: %s <map> [frames]", TOOL_NAME);
+		return -1;
+	}
+	const int Frames = argc == 3 ? maximum(str_toint(argv[2]), 1) : 1000;
+
+	std::unique_ptr<IStorage> pStorage = std::unique_ptr<IStorage>(CreateLocalStorage());
+	if(!pStorage)
+	{
+		log_error(TOOL_NAME, "Error creating local storage");
+		return -1;
+	}
+
+	CDataFileReader Reader;
+	if(!Reader.Open(pStorage.get(), argv[1], IStorage::TYPE_ABSOLUTE))
+	{
+		log_error(TOOL_NAME, "Error opening map '%s'", argv[1]);
+		return -1;
+	}
+
+	const std::vector<CEnvelopeRequest> vRequests = CollectRequests(Reader);
+	log_info(TOOL_NAME, "%d envelope evaluations per frame, %d frames", (int)vRequests.size(), Frames);
+
+	int64_t UncachedDuration, CachedDuration;
+	int UncachedSize, CachedSize;
+	CEnvelopeEvalCache Cache;
+	const double UncachedChecksum = RunPass(Reader, vRequests, Frames, nullptr, UncachedDuration, UncachedSize);
+	const double CachedChecksum = RunPass(Reader, vRequests, Frames, &Cache, CachedDuration, CachedSize);
+	Reader.Close();
+
+	log_info(TOOL_NAME, "uncached: %.3fms per frame", UncachedDuration / 1000000.0 / Frames);
+	log_info(TOOL_NAME, "cached: %.3fms per frame, %d unique samples per frame", CachedDuration / 1000000.0 / Frames, CachedSize);
+	if(UncachedChecksum != CachedChecksum)
+	{
+		log_error(TOOL_NAME, "cached values differ from uncached values (%f != %f)", CachedChecksum, UncachedChecksum);
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,160 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/server/name_ban.h>
+
+#include <game/prng.h>
+
+#include <string>
+#include <vector>
+
+static const char *TOOL_NAME = "name_ban_bench";
+
+static const char *const CHARACTERS[] = {
+	"a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m", "n", "o", "p", "q", "r", "s", "t", "u", "v", "w", "x", "y", "z",
+	"A", "B", "C", "D", "E", "K", "M", "N", "P", "S", "T", "X",
+	"0", "1", "2", "3", "4", "7", "_", "-", ".", " ",
+	"é", "ö", "ü", "я", "д", "ω", "σ", "ツ", "★", "ᴅ"};
+
+class CNameGenerator
+{
+	CPrng m_Prng;
+
+public:
+	CNameGenerator()
+	{
+		uint64_t aSeed[2] = {0x6e616d65, 0x62616e73};
+		m_Prng.Seed(aSeed);
+	}
+
+	int Random(int Max) { return m_Prng.RandomBits() % Max; }
+
+	std::string Name(int MinLength, int MaxLength)
+	{
+		std::string Name;
+		const int Length = MinLength + Random(MaxLength - MinLength + 1);
+		for(int i = 0; i < Length; i++)
+			Name += CHARACTERS[Random(std::size(CHARACTERS))];
+		return Name;
+	}
+
+	// a name that is a few edits away from the given one
+	std::string Edit(const std::string &Name)
+	{
+		std::string Result = Name;
+		const int NumEdits = 1 + Random(2);
+		for(int i = 0; i < NumEdits && !Result.empty(); i++)
+		{
+			const int Position = Random(Result.size());
+			if(Random(2))
+				Result[Position] = CHARACTERS[Random(26)][0];
+			else
+				Result.insert(Position, CHARACTERS[Random(26)]);
+		}
+		// keep the name valid utf-8 after replacing a byte of a multibyte character
+		char aSanitized[MAX_NAME_LENGTH];
+		str_copy(aSanitized, Result.c_str());
+		str_sanitize_cc(aSanitized);
+		if(!str_utf8_check(aSanitized))
+			return Name;
+		return aSanitized;
+	}
+};
+
+// the name ban check before the bans were indexed, every ban is compared
+// with the whole name
+static const CNameBan *OldIsBanned(const std::vector<CNameBan> &vBans, const char *pName)
+{
+	char aTrimmed[MAX_NAME_LENGTH];
+	str_copy(aTrimmed, str_utf8_skip_whitespaces(pName));
+	str_utf8_trim_right(aTrimmed);
+
+	int aSkeleton[MAX_NAME_SKELETON_LENGTH];
+	int SkeletonLength = str_utf8_to_skeleton(aTrimmed, aSkeleton, std::size(aSkeleton));
+	int aBuffer[MAX_NAME_SKELETON_LENGTH * 2 + 2];
+
+	const CNameBan *pResult = nullptr;
+	for(const CNameBan &Ban : vBans)
+	{
+		int Distance = str_utf32_dist_buffer(aSkeleton, SkeletonLength, Ban.m_aSkeleton, Ban.m_SkeletonLength, aBuffer, std::size(aBuffer));
+		if(Distance <= Ban.m_Distance || (Ban.m_IsSubstring && str_utf8_find_nocase(pName, Ban.m_aName)))
+			pResult = &Ban;
+	}
+	return pResult;
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc > 3)
+	{
+		log_error(TOOL_NAME, "Usage: %s [bans] [names]", TOOL_NAME);
+		return -1;
+	}
+	const int NumBans = argc > 1 ? maximum(str_toint(argv[1]), 1) : 10000;
+	const int NumNames = argc > 2 ? maximum(str_toint(argv[2]), 1) : 2000;
+
+	// mostly bans of whole names with a small distance, some substring bans
+	CNameGenerator Generator;
+	CNameBans NameBans;
+	std::vector<CNameBan> vBans;
+	std::vector<std::string> vBanNames;
+	for(int i = 0; i < NumBans; i++)
+	{
+		const bool IsSubstring = Generator.Random(20) == 0;
+		const std::string Name = IsSubstring ? Generator.Name(4, 6) : Generator.Name(3, 15);
+		const int Distance = IsSubstring ? 0 : Generator.Random(3);
+		NameBans.Ban(Name.c_str(), "", Distance, IsSubstring);
+		vBans.emplace_back(Name.c_str(), "", Distance, IsSubstring);
+		vBanNames.push_back(Name);
+	}
+
+	// names of connecting players, half of them are close to a banned name
+	std::vector<std::string> vNames;
+	for(int i = 0; i < NumNames; i++)
+	{
+		if(i % 2)
+			vNames.push_back(Generator.Edit(vBanNames[Generator.Random(vBanNames.size())]));
+		else
+			vNames.push_back(Generator.Name(3, 15));
+	}
+
+	std::vector<const CNameBan *> vOldResults;
+	const int64_t OldStart = time_get_nanoseconds().count();
+	for(const std::string &Name : vNames)
+		vOldResults.push_back(OldIsBanned(vBans, Name.c_str()));
+	const int64_t OldDuration = time_get_nanoseconds().count() - OldStart;
+
+	// the first check builds the index
+	const int64_t IndexStart = time_get_nanoseconds().count();
+	NameBans.IsBanned("");
+	const int64_t IndexDuration = time_get_nanoseconds().count() - IndexStart;
+
+	std::vector<const CNameBan *> vResults;
+	const int64_t Start = time_get_nanoseconds().count();
+	for(const std::string &Name : vNames)
+		vResults.push_back(NameBans.IsBanned(Name.c_str()));
+	const int64_t Duration = time_get_nanoseconds().count() - Start;
+
+	int NumBanned = 0;
+	bool Equal = true;
+	for(int i = 0; i < NumNames; i++)
+	{
+		NumBanned += vResults[i] != nullptr;
+		if((vResults[i] == nullptr) != (vOldResults[i] == nullptr) || (vResults[i] && str_comp(vResults[i]->m_aName, vOldResults[i]->m_aName) != 0))
+			Equal = false;
+	}
+
+	log_info(TOOL_NAME, "%d bans, %d names, %d of them banned", NumBans, NumNames, NumBanned);
+	log_info(TOOL_NAME, "every ban: %.2fus per name", OldDuration / 1000.0 / NumNames);
+	log_info(TOOL_NAME, "index: %.2fus per name, %.3fms to build the index", Duration / 1000.0 / NumNames, IndexDuration / 1000000.0);
+	if(!Equal)
+	{
+		log_error(TOOL_NAME, "the index changed the result");
+		return -1;
+	}
+	return 0;
+}
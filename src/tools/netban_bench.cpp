@@ -0,0 +1,254 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/console.h>
+#include <engine/shared/config.h>
+#include <engine/shared/netban.h>
+
+#include <game/prng.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+static const char *TOOL_NAME = "netban_bench";
+
+class CBenchNetBan : public CNetBan
+{
+public:
+	// the lookup before the range table and the negative cache, every prefix
+	// length of the address is probed in the range hash lists
+	bool OldIsBanned(const NETADDR *pOrigAddr, char *pBuf, unsigned BufferSize) const
+	{
+		NETADDR Addr;
+		const NETADDR *pAddr = pOrigAddr;
+		if(pOrigAddr->type == NETTYPE_WEBSOCKET_IPV4)
+		{
+			Addr = *pOrigAddr;
+			pAddr = &Addr;
+			Addr.type = NETTYPE_IPV4;
+		}
+		CNetHash aHash[17];
+		int Length = CNetHash::MakeHashArray(pAddr, aHash);
+
+		CBanAddr *pBan = m_BanAddrPool.Find(pAddr, &aHash[Length]);
+		if(pBan)
+		{
+			MakeBanInfo(pBan, pBuf, BufferSize, MSGTYPE_PLAYER);
+			return true;
+		}
+
+		for(int i = Length - 1; i >= 0; --i)
+		{
+			for(CBanRange *pBanRange = m_BanRangePool.First(&aHash[i]); pBanRange; pBanRange = pBanRange->m_pHashNext)
+			{
+				if(NetMatch(&pBanRange->m_Data, pAddr, i, Length))
+				{
+					MakeBanInfo(pBanRange, pBuf, BufferSize, MSGTYPE_PLAYER);
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+};
+
+class CAddrGenerator
+{
+	CPrng m_Prng;
+
+public:
+	CAddrGenerator()
+	{
+		uint64_t aSeed[2] = {0x6e657462, 0x616e7321};
+		m_Prng.Seed(aSeed);
+	}
+
+	int Random(int Max) { return m_Prng.RandomBits() % Max; }
+
+	// most addresses are IPv4, a quarter of them IPv6 from a few /32 networks
+	NETADDR Addr()
+	{
+		NETADDR Addr;
+		mem_zero(&Addr, sizeof(Addr));
+		if(Random(4))
+		{
+			Addr.type = NETTYPE_IPV4;
+			for(int i = 0; i < 4; i++)
+				Addr.ip[i] = Random(256);
+		}
+		else
+		{
+			Addr.type = NETTYPE_IPV6;
+			Addr.ip[0] = 0x20;
+			Addr.ip[1] = 0x01;
+			Addr.ip[2] = Random(4);
+			Addr.ip[3] = Random(256);
+			for(int i = 4; i < 16; i++)
+				Addr.ip[i] = Random(256);
+		}
+		return Addr;
+	}
+
+	// ranges from a handful of addresses up to a /12, some of them aligned
+	// like the CIDR ranges of hosting providers, the rest arbitrary
+	CNetRange Range()
+	{
+		CNetRange Range;
+		Range.m_LB = Addr();
+		Range.m_UB = Range.m_LB;
+		const int Length = Range.m_LB.type == NETTYPE_IPV4 ? 4 : 16;
+		const int FreeBits = 2 + Random(Length == 4 ? 18 : 80);
+		const bool Aligned = Random(2);
+		for(int Bit = 0; Bit < FreeBits; Bit++)
+		{
+			unsigned char &LB = Range.m_LB.ip[Length - 1 - Bit / 8];
+			unsigned char &UB = Range.m_UB.ip[Length - 1 - Bit / 8];
+			const unsigned char Mask = 1 << (Bit % 8);
+			if(Aligned)
+			{
+				LB &= ~Mask;
+				UB |= Mask;
+			}
+			else
+			{
+				UB |= Random(2) ? Mask : 0;
+			}
+		}
+		if(NetComp(&Range.m_UB, &Range.m_LB) < 0)
+			std::swap(Range.m_LB, Range.m_UB);
+		return Range;
+	}
+
+	// an address inside of the range
+	NETADDR Inside(const CNetRange &Range)
+	{
+		NETADDR Addr = Range.m_LB;
+		const int Length = Addr.type == NETTYPE_IPV4 ? 4 : 16;
+		int First = 0;
+		while(First < Length && Range.m_LB.ip[First] == Range.m_UB.ip[First])
+			First++;
+		if(First == Length)
+			return Addr;
+		Addr.ip[First] = Range.m_LB.ip[First] + Random(Range.m_UB.ip[First] - Range.m_LB.ip[First] + 1);
+		for(int i = First + 1; i < Length; i++)
+			Addr.ip[i] = Random(256);
+		if(NetComp(&Addr, &Range.m_LB) < 0 || NetComp(&Addr, &Range.m_UB) > 0)
+			return Range.m_LB;
+		return Addr;
+	}
+};
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc > 4)
+	{
+		log_error(TOOL_NAME, "Usage: %s [connections] [addr_bans] [range_bans]", TOOL_NAME);
+		return -1;
+	}
+	const int NumConnections = argc > 1 ? maximum(str_toint(argv[1]), 1) : 1000000;
+	// the ban pools hold 2048 bans each
+	const int NumAddrBans = argc > 2 ? maximum(str_toint(argv[2]), 0) : 2048;
+	const int NumRangeBans = argc > 3 ? maximum(str_toint(argv[3]), 0) : 2048;
+
+	std::unique_ptr<IConsole> pConsole = CreateConsole(CFGFLAG_SERVER);
+	CBenchNetBan NetBan;
+	NetBan.Init(pConsole.get(), nullptr);
+
+	// every added ban is printed, keep that out of the output
+	CAddrGenerator Generator;
+	std::vector<NETADDR> vBannedAddrs;
+	std::vector<CNetRange> vBannedRanges;
+	{
+		std::unique_ptr<ILogger> pNoopLogger = log_logger_noop();
+		CLogScope LogScope(pNoopLogger.get());
+		int Result = 0;
+		while((int)vBannedAddrs.size() < NumAddrBans && Result >= 0)
+		{
+			const NETADDR Addr = Generator.Addr();
+			Result = NetBan.BanAddr(&Addr, 0, "flood", false);
+			if(Result == 0)
+				vBannedAddrs.push_back(Addr);
+		}
+		Result = 0;
+		while((int)vBannedRanges.size() < NumRangeBans && Result >= 0)
+		{
+			const CNetRange Range = Generator.Range();
+			if(!Range.IsValid())
+				continue;
+			Result = NetBan.BanRange(&Range, 0, "flood");
+			if(Result == 0)
+				vBannedRanges.push_back(Range);
+		}
+	}
+
+	// A connection flood: most packets come from spoofed random addresses,
+	// the rest are retries from a pool of recent clients or come from banned
+	// addresses and ranges.
+	std::vector<NETADDR> vRecentAddrs;
+	for(int i = 0; i < 256; i++)
+		vRecentAddrs.push_back(Generator.Addr());
+	std::vector<NETADDR> vConnections;
+	vConnections.reserve(NumConnections);
+	for(int i = 0; i < NumConnections; i++)
+	{
+		const int Kind = Generator.Random(100);
+		if(Kind < 10 && !vBannedAddrs.empty())
+			vConnections.push_back(vBannedAddrs[Generator.Random(vBannedAddrs.size())]);
+		else if(Kind < 20 && !vBannedRanges.empty())
+			vConnections.push_back(Generator.Inside(vBannedRanges[Generator.Random(vBannedRanges.size())]));
+		else if(Kind < 50)
+			vConnections.push_back(vRecentAddrs[Generator.Random(vRecentAddrs.size())]);
+		else
+			vConnections.push_back(Generator.Addr());
+	}
+
+	char aBuf[256];
+	std::vector<bool> vOldResults;
+	vOldResults.reserve(NumConnections);
+	const int64_t OldStart = time_get_nanoseconds().count();
+	for(const NETADDR &Addr : vConnections)
+		vOldResults.push_back(NetBan.OldIsBanned(&Addr, aBuf, sizeof(aBuf)));
+	const int64_t OldDuration = time_get_nanoseconds().count() - OldStart;
+
+	// the first lookup that gets to the range bans builds the range table
+	NETADDR Unbanned;
+	mem_zero(&Unbanned, sizeof(Unbanned));
+	Unbanned.type = NETTYPE_IPV6;
+	const int64_t BuildStart = time_get_nanoseconds().count();
+	NetBan.IsBanned(&Unbanned, aBuf, sizeof(aBuf));
+	const int64_t BuildDuration = time_get_nanoseconds().count() - BuildStart;
+
+	std::vector<bool> vResults;
+	vResults.reserve(NumConnections);
+	const int64_t Start = time_get_nanoseconds().count();
+	for(const NETADDR &Addr : vConnections)
+		vResults.push_back(NetBan.IsBanned(&Addr, aBuf, sizeof(aBuf)));
+	const int64_t Duration = time_get_nanoseconds().count() - Start;
+
+	// the reported bans have to match as well, check some of them
+	bool Equal = vResults == vOldResults;
+	for(int i = 0; i < NumConnections && Equal; i += 97)
+	{
+		char aOld[256] = "";
+		char aNew[256] = "";
+		NetBan.OldIsBanned(&vConnections[i], aOld, sizeof(aOld));
+		NetBan.IsBanned(&vConnections[i], aNew, sizeof(aNew));
+		Equal = str_comp(aOld, aNew) == 0;
+	}
+
+	const int NumBanned = std::count(vResults.begin(), vResults.end(), true);
+	log_info(TOOL_NAME, "%d address bans, %d range bans, %d connections, %d of them banned", (int)vBannedAddrs.size(), (int)vBannedRanges.size(), NumConnections, NumBanned);
+	log_info(TOOL_NAME, "hash lists: %.1fns per connection, %.0f connections per second", OldDuration / (double)NumConnections, NumConnections / (OldDuration / 1000000000.0));
+	log_info(TOOL_NAME, "range table: %.1fns per connection, %.0f connections per second, %.3fms to build the table", Duration / (double)NumConnections, NumConnections / (Duration / 1000000000.0), BuildDuration / 1000000.0);
+	if(!Equal)
+	{
+		log_error(TOOL_NAME, "the range table changed the result");
+		return -1;
+	}
+	return 0;
+}
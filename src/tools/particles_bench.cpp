@@ -0,0 +1,206 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/kernel.h>
+#include <engine/map.h>
+#include <engine/storage.h>
+
+#include <game/client/particle_store.h>
+#include <game/collision.h>
+#include <game/layers.h>
+
+#include <memory>
+#include <vector>
+
+static const char *TOOL_NAME = "particles_bench";
+
+// the particles in linked lists of structs, like the client stored them
+// before the particle store
+class CLinkedParticles
+{
+	struct CLinkedParticle
+	{
+		CParticle m_Particle;
+		float m_Life;
+		int m_PrevPart;
+		int m_NextPart;
+	};
+	std::vector<CLinkedParticle> m_vParticles;
+	int m_FirstFree;
+	int m_FirstPart = -1;
+
+public:
+	CLinkedParticles(int MaxParticles) :
+		m_vParticles(MaxParticles)
+	{
+		for(int i = 0; i < MaxParticles; i++)
+		{
+			m_vParticles[i].m_PrevPart = i - 1;
+			m_vParticles[i].m_NextPart = i + 1;
+		}
+		m_vParticles[0].m_PrevPart = 0;
+		m_vParticles[MaxParticles - 1].m_NextPart = -1;
+		m_FirstFree = 0;
+	}
+
+	void Add(const CParticle &Particle)
+	{
+		if(m_FirstFree == -1)
+			return;
+		int Id = m_FirstFree;
+		m_FirstFree = m_vParticles[Id].m_NextPart;
+		if(m_FirstFree != -1)
+			m_vParticles[m_FirstFree].m_PrevPart = -1;
+		m_vParticles[Id].m_Particle = Particle;
+		m_vParticles[Id].m_Life = 0.0f;
+		m_vParticles[Id].m_PrevPart = -1;
+		m_vParticles[Id].m_NextPart = m_FirstPart;
+		if(m_FirstPart != -1)
+			m_vParticles[m_FirstPart].m_PrevPart = Id;
+		m_FirstPart = Id;
+	}
+
+	int Update(float TimePassed, int FrictionCount, const CCollision *pCollision)
+	{
+		int NumDied = 0;
+		int i = m_FirstPart;
+		while(i != -1)
+		{
+			CLinkedParticle &Linked = m_vParticles[i];
+			CParticle &Particle = Linked.m_Particle;
+			int Next = Linked.m_NextPart;
+			Particle.m_Vel.y += Particle.m_Gravity * TimePassed;
+			for(int f = 0; f < FrictionCount; f++)
+				Particle.m_Vel *= Particle.m_Friction;
+			vec2 Vel = Particle.m_Vel * TimePassed;
+			if(Particle.m_Collides)
+				pCollision->MovePoint(&Particle.m_Pos, &Vel, random_float(0.1f, 1.0f), nullptr);
+			else
+				Particle.m_Pos += Vel;
+			Particle.m_Vel = Vel * (1.0f / TimePassed);
+			Linked.m_Life += TimePassed;
+			Particle.m_Rot += TimePassed * Particle.m_Rotspeed;
+
+			if(Linked.m_Life > Particle.m_LifeSpan)
+			{
+				if(Linked.m_PrevPart != -1)
+					m_vParticles[Linked.m_PrevPart].m_NextPart = Linked.m_NextPart;
+				else
+					m_FirstPart = Linked.m_NextPart;
+				if(Linked.m_NextPart != -1)
+					m_vParticles[Linked.m_NextPart].m_PrevPart = Linked.m_PrevPart;
+				if(m_FirstFree != -1)
+					m_vParticles[m_FirstFree].m_PrevPart = i;
+				Linked.m_PrevPart = -1;
+				Linked.m_NextPart = m_FirstFree;
+				m_FirstFree = i;
+				NumDied++;
+			}
+			i = Next;
+		}
+		return NumDied;
+	}
+};
+
+// particles of an explosion at a random free position, similar to the
+// smoke of grenade explosions
+static void SpawnExplosion(const CCollision &Collision, int NumParticles, std::vector<CParticle> &vParticles)
+{
+	vec2 Center;
+	do
+	{
+		Center = vec2(random_float(Collision.GetWidth() * 32.0f), random_float(Collision.GetHeight() * 32.0f));
+	} while(Collision.CheckPoint(Center));
+
+	for(int i = 0; i < NumParticles; i++)
+	{
+		CParticle Particle;
+		Particle.SetDefault();
+		Particle.m_Spr = 0;
+		Particle.m_Pos = Center;
+		Particle.m_Vel = random_direction() * random_float(100.0f, 1000.0f);
+		Particle.m_LifeSpan = random_float(0.5f, 1.5f);
+		Particle.m_Rotspeed = random_float(-10.0f, 10.0f);
+		Particle.m_Gravity = random_float(-500.0f, 800.0f);
+		Particle.m_Friction = random_float(0.6f, 0.9f);
+		Particle.m_Collides = random_float() < 0.75f;
+		vParticles.push_back(Particle);
+	}
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc < 2 || argc > 4)
+	{
+		log_error(TOOL_NAME, "Usage: %s <map> [particles] [updates]", TOOL_NAME);
+		log_error(TOOL_NAME, "the map is looked up in the storage like the server does, e.g. maps/Tutorial.map");
+		return -1;
+	}
+	const int NumParticles = argc > 2 ? maximum(str_toint(argv[2]), 1) : 8192;
+	const int NumUpdates = argc > 3 ? maximum(str_toint(argv[3]), 1) : 1000;
+
+	std::unique_ptr<IKernel> pKernel = std::unique_ptr<IKernel>(IKernel::Create());
+	IStorage *pStorage = CreateStorage(IStorage::STORAGETYPE_SERVER, argc, argv);
+	if(!pStorage)
+	{
+		log_error(TOOL_NAME, "could not initialize storage");
+		return -1;
+	}
+	pKernel->RegisterInterface(pStorage);
+	IEngineMap *pMap = CreateEngineMap();
+	pKernel->RegisterInterface(pMap);
+	pKernel->RegisterInterface(static_cast<IMap *>(pMap), false);
+	if(!pMap->Load(argv[1]))
+	{
+		log_error(TOOL_NAME, "could not load map '%s'", argv[1]);
+		return -1;
+	}
+
+	CLayers Layers;
+	Layers.Init(pMap, true);
+	CCollision Collision;
+	Collision.Init(&Layers);
+
+	// the same particles are spawned for both, dead ones are replaced to
+	// keep the number of particles constant
+	const float TimePassed = 1.0f / 60.0f;
+	const int FrictionCount = 1;
+	std::vector<CParticle> vSpawned;
+	while((int)vSpawned.size() < NumParticles)
+		SpawnExplosion(Collision, minimum(64, NumParticles - (int)vSpawned.size()), vSpawned);
+
+	CLinkedParticles Linked(NumParticles);
+	for(const CParticle &Particle : vSpawned)
+		Linked.Add(Particle);
+	int Respawn = 0;
+	const int64_t LinkedStart = time_get_nanoseconds().count();
+	for(int Update = 0; Update < NumUpdates; Update++)
+	{
+		const int NumDied = Linked.Update(TimePassed, FrictionCount, &Collision);
+		for(int i = 0; i < NumDied; i++)
+			Linked.Add(vSpawned[Respawn++ % NumParticles]);
+	}
+	const int64_t LinkedDuration = time_get_nanoseconds().count() - LinkedStart;
+
+	CParticleStore Store;
+	for(const CParticle &Particle : vSpawned)
+		Store.Add(Particle, 0.0f);
+	Respawn = 0;
+	const int64_t StoreStart = time_get_nanoseconds().count();
+	for(int Update = 0; Update < NumUpdates; Update++)
+	{
+		Store.Update(TimePassed, FrictionCount, &Collision);
+		while(Store.NumAlive() < NumParticles)
+			Store.Add(vSpawned[Respawn++ % NumParticles], 0.0f);
+	}
+	const int64_t StoreDuration = time_get_nanoseconds().count() - StoreStart;
+
+	log_info(TOOL_NAME, "%d particles, %d updates", NumParticles, NumUpdates);
+	log_info(TOOL_NAME, "linked lists: %.3fms per update", LinkedDuration / 1000000.0 / NumUpdates);
+	log_info(TOOL_NAME, "particle store: %.3fms per update", StoreDuration / 1000000.0 / NumUpdates);
+	return 0;
+}
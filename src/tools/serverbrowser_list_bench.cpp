@@ -0,0 +1,102 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/client/serverbrowser_http.h>
+#include <engine/external/json-parser/json.h>
+#include <engine/serverbrowser.h>
+#include <engine/storage.h>
+
+#include <memory>
+#include <vector>
+
+static const char *TOOL_NAME = "serverbrowser_list_bench";
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc < 2 || argc > 4)
+	{
+		log_error(TOOL_NAME, "Usage: %s <servers.json> [chunk size] [iterations]", TOOL_NAME);
+		return -1;
+	}
+	// curl hands over at most 16 KiB per write callback by default
+	const int ChunkSize = argc >= 3 ? maximum(str_toint(argv[2]), 1) : 16 * 1024;
+	const int Iterations = argc >= 4 ? maximum(str_toint(argv[3]), 1) : 20;
+
+	std::unique_ptr<IStorage> pStorage = std::unique_ptr<IStorage>(CreateLocalStorage());
+	if(!pStorage)
+	{
+		log_error(TOOL_NAME, "Error creating local storage");
+		return -1;
+	}
+
+	void *pData;
+	unsigned DataSize;
+	if(!pStorage->ReadFile(argv[1], IStorage::TYPE_ABSOLUTE, &pData, &DataSize))
+	{
+		log_error(TOOL_NAME, "Error reading server list '%s'", argv[1]);
+		return -1;
+	}
+	const char *pJson = (const char *)pData;
+
+	// Previously the whole response was buffered, parsed into a DOM and
+	// converted, the buffer grew by doubling while it was received.
+	std::vector<CServerInfo> vDomServers;
+	CServerInfoArena DomArena;
+	bool DomFailure = false;
+	size_t DomBufferSize = 1024;
+	while(DomBufferSize < DataSize)
+		DomBufferSize *= 2;
+	const int64_t DomStart = time_get_nanoseconds().count();
+	for(int Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		json_value *pDom = json_parse(pJson, DataSize);
+		DomArena.Reset();
+		DomFailure = !pDom || ServerbrowserParseServerList(pDom, &vDomServers, &DomArena);
+		json_value_free(pDom);
+	}
+	const int64_t DomDuration = time_get_nanoseconds().count() - DomStart;
+
+	std::vector<CServerInfo> vStreamServers;
+	CServerInfoArena StreamArena;
+	bool StreamFailure = false;
+	size_t StreamBufferSize = 0;
+	const int64_t StreamStart = time_get_nanoseconds().count();
+	for(int Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		CServerListStreamParser Parser;
+		StreamFailure = false;
+		for(unsigned Offset = 0; Offset < DataSize && !StreamFailure; Offset += ChunkSize)
+			StreamFailure = !Parser.Feed(pJson + Offset, minimum((unsigned)ChunkSize, DataSize - Offset));
+		StreamFailure = StreamFailure || !Parser.Finish();
+		if(StreamFailure)
+			log_error(TOOL_NAME, "stream: %s", Parser.Error());
+		StreamBufferSize = Parser.PeakBufferSize();
+		vStreamServers = std::move(Parser.Servers());
+		StreamArena = std::move(Parser.Arena());
+	}
+	const int64_t StreamDuration = time_get_nanoseconds().count() - StreamStart;
+	free(pData);
+
+	log_info(TOOL_NAME, "%u bytes, %d servers, chunks of %d bytes", DataSize, (int)vDomServers.size(), ChunkSize);
+	log_info(TOOL_NAME, "dom: %.3fms, response buffer %d bytes", DomDuration / 1000000.0 / Iterations, (int)DomBufferSize);
+	log_info(TOOL_NAME, "stream: %.3fms, peak buffer %d bytes", StreamDuration / 1000000.0 / Iterations, (int)StreamBufferSize);
+
+	if(DomFailure != StreamFailure || vDomServers.size() != vStreamServers.size())
+	{
+		log_error(TOOL_NAME, "stream parsing gives a different result");
+		return -1;
+	}
+	for(size_t i = 0; i < vDomServers.size(); i++)
+	{
+		if(str_comp(vDomServers[i].m_aName, vStreamServers[i].m_aName) != 0 || vDomServers[i].m_NumAddresses != vStreamServers[i].m_NumAddresses)
+		{
+			log_error(TOOL_NAME, "stream parsing gives a different result for server %d", (int)i);
+			return -1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,214 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/serverbrowser.h>
+#include <engine/shared/json.h>
+#include <engine/shared/memheap.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/serverinfo.h>
+#include <engine/shared/serverinfo_arena.h>
+#include <engine/storage.h>
+
+#include <memory>
+#include <vector>
+
+#if defined(CONF_PLATFORM_LINUX)
+#include <unistd.h>
+#endif
+
+static const char *TOOL_NAME = "serverbrowser_memory_bench";
+
+typedef IServerBrowser::CServerEntry CServerEntry;
+
+// the server info before the client list and the strings were moved into
+// a CServerInfoArena, only the fields that hold the strings and clients
+class COldServerInfo
+{
+public:
+	class CClient
+	{
+	public:
+		char m_aName[MAX_NAME_LENGTH];
+		char m_aClan[MAX_CLAN_LENGTH];
+		int m_Country;
+		int m_Score;
+		bool m_Player;
+		bool m_Afk;
+
+		char m_aSkin[MAX_SKIN_LENGTH];
+		bool m_CustomSkinColors;
+		int m_CustomSkinColorBody;
+		int m_CustomSkinColorFeet;
+
+		int m_FriendState;
+	};
+
+	int m_NumReceivedClients;
+	int m_NumAddresses;
+	NETADDR m_aAddresses[MAX_SERVER_ADDRESSES];
+	char m_aCommunityId[CServerInfo::MAX_COMMUNITY_ID_LENGTH];
+	char m_aCommunityCountry[CServerInfo::MAX_COMMUNITY_COUNTRY_LENGTH];
+	char m_aCommunityType[CServerInfo::MAX_COMMUNITY_TYPE_LENGTH];
+	char m_aGameType[16];
+	char m_aName[64];
+	char m_aMap[MAX_MAP_LENGTH];
+	char m_aVersion[32];
+	char m_aAddress[MAX_SERVER_ADDRESSES * NETADDR_MAXSTRSIZE];
+	CClient m_aClients[SERVERINFO_MAX_CLIENTS];
+};
+
+static void ToOldServerInfo(const CServerInfo2 &Info, COldServerInfo *pOut)
+{
+	mem_zero(pOut, sizeof(*pOut));
+	str_copy(pOut->m_aGameType, Info.m_aGameType);
+	str_copy(pOut->m_aName, Info.m_aName);
+	str_copy(pOut->m_aMap, Info.m_aMapName);
+	str_copy(pOut->m_aVersion, Info.m_aVersion);
+	pOut->m_NumReceivedClients = minimum(Info.m_NumClients, (int)SERVERINFO_MAX_CLIENTS);
+	for(int i = 0; i < pOut->m_NumReceivedClients; i++)
+	{
+		str_copy(pOut->m_aClients[i].m_aName, Info.m_aClients[i].m_aName);
+		str_copy(pOut->m_aClients[i].m_aClan, Info.m_aClients[i].m_aClan);
+		str_copy(pOut->m_aClients[i].m_aSkin, Info.m_aClients[i].m_aSkin);
+		pOut->m_aClients[i].m_Score = Info.m_aClients[i].m_Score;
+	}
+}
+
+// resident set size in bytes, 0 where it can't be read
+static int64_t ResidentSetSize()
+{
+#if defined(CONF_PLATFORM_LINUX)
+	IOHANDLE File = io_open("/proc/self/statm", IOFLAG_READ);
+	if(!File)
+		return 0;
+	char aBuf[128];
+	const unsigned Size = io_read(File, aBuf, sizeof(aBuf) - 1);
+	io_close(File);
+	aBuf[Size] = '\0';
+	// the second field is the number of resident pages
+	const char *pResident = str_find(aBuf, " ");
+	return pResident ? str_toint64_base(pResident + 1) * sysconf(_SC_PAGESIZE) : 0;
+#else
+	return 0;
+#endif
+}
+
+static bool SameInfo(const COldServerInfo &Old, const CServerInfo &New)
+{
+	if(str_comp(Old.m_aName, New.m_aName) != 0 || str_comp(Old.m_aMap, New.m_pMap) != 0 ||
+		str_comp(Old.m_aGameType, New.m_pGameType) != 0 || Old.m_NumReceivedClients != New.m_NumReceivedClients)
+		return false;
+	for(int i = 0; i < Old.m_NumReceivedClients; i++)
+	{
+		const COldServerInfo::CClient &OldClient = Old.m_aClients[i];
+		const CServerInfo::CClient &NewClient = New.m_pClients[i];
+		if(str_comp(OldClient.m_aName, NewClient.m_pName) != 0 || str_comp(OldClient.m_aClan, NewClient.m_pClan) != 0 ||
+			str_comp(OldClient.m_aSkin, NewClient.m_pSkin) != 0 || OldClient.m_Score != NewClient.m_Score)
+			return false;
+	}
+	return true;
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc != 2)
+	{
+		log_error(TOOL_NAME, "Usage: %s <servers.json>", TOOL_NAME);
+		return -1;
+	}
+
+	std::unique_ptr<IStorage> pStorage = std::unique_ptr<IStorage>(CreateLocalStorage());
+	if(!pStorage)
+	{
+		log_error(TOOL_NAME, "Error creating local storage");
+		return -1;
+	}
+
+	void *pData;
+	unsigned DataSize;
+	if(!pStorage->ReadFile(argv[1], IStorage::TYPE_ABSOLUTE, &pData, &DataSize))
+	{
+		log_error(TOOL_NAME, "Error reading server list '%s'", argv[1]);
+		return -1;
+	}
+	json_value *pJson = json_parse((const char *)pData, DataSize);
+	free(pData);
+	if(!pJson || (*pJson)["servers"].type != json_array)
+	{
+		log_error(TOOL_NAME, "Error parsing server list '%s'", argv[1]);
+		json_value_free(pJson);
+		return -1;
+	}
+	// Parsed up front so that only the kept infos are measured, the json is
+	// freed at the end so that its memory isn't reused for them.
+	std::vector<CServerInfo2> vParsed;
+	const json_value &Servers = (*pJson)["servers"];
+	for(unsigned i = 0; i < Servers.u.array.length; i++)
+	{
+		CServerInfo2 ParsedInfo;
+		if(!CServerInfo2::FromJson(&ParsedInfo, &Servers[i]["info"]))
+			vParsed.push_back(ParsedInfo);
+	}
+	const int NumServers = vParsed.size();
+	int NumClients = 0;
+	for(const CServerInfo2 &Info : vParsed)
+		NumClients += minimum(Info.m_NumClients, (int)SERVERINFO_MAX_CLIENTS);
+
+	// Both layouts keep every info twice, in the list of the master server
+	// request and in the entries of the browser. The new one is measured
+	// first and both are kept until the end, so neither reuses memory freed
+	// by the other.
+	const int64_t NewStart = ResidentSetSize();
+	std::vector<CServerInfo> vNewList;
+	CServerInfoArena ListArena;
+	for(const CServerInfo2 &Info : vParsed)
+	{
+		CServerInfo NewInfo;
+		Info.ToServerInfo(&NewInfo, &ListArena);
+		vNewList.push_back(NewInfo);
+	}
+	CHeap NewHeap;
+	CServerInfoArena BrowserArena;
+	std::vector<CServerEntry *> vpNewEntries;
+	for(const CServerInfo &Info : vNewList)
+	{
+		CServerEntry *pEntry = NewHeap.Allocate<CServerEntry>();
+		pEntry->m_Info = Info;
+		BrowserArena.Store(&pEntry->m_Info);
+		vpNewEntries.push_back(pEntry);
+	}
+	const int64_t NewRss = ResidentSetSize() - NewStart;
+
+	const int64_t OldStart = ResidentSetSize();
+	std::vector<COldServerInfo> vOldList(NumServers);
+	for(int i = 0; i < NumServers; i++)
+		ToOldServerInfo(vParsed[i], &vOldList[i]);
+	CHeap OldHeap;
+	std::vector<COldServerInfo *> vpOldEntries;
+	for(const COldServerInfo &Info : vOldList)
+	{
+		COldServerInfo *pEntry = static_cast<COldServerInfo *>(OldHeap.Allocate(sizeof(COldServerInfo), alignof(COldServerInfo)));
+		*pEntry = Info;
+		vpOldEntries.push_back(pEntry);
+	}
+	const int64_t OldRss = ResidentSetSize() - OldStart;
+
+	log_info(TOOL_NAME, "%d servers, %d clients", NumServers, NumClients);
+	log_info(TOOL_NAME, "info: fixed arrays %d bytes, view %d bytes", (int)sizeof(COldServerInfo), (int)sizeof(CServerInfo));
+	log_info(TOOL_NAME, "rss: fixed arrays %.2fMiB, arena %.2fMiB", OldRss / 1024.0 / 1024.0, NewRss / 1024.0 / 1024.0);
+	json_value_free(pJson);
+
+	for(int i = 0; i < NumServers; i++)
+	{
+		if(!SameInfo(vOldList[i], vNewList[i]) || !SameInfo(*vpOldEntries[i], vpNewEntries[i]->m_Info))
+		{
+			log_error(TOOL_NAME, "the arena gives a different result for server %d", i);
+			return -1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,137 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/client/serverbrowser_search.h>
+#include <engine/serverbrowser.h>
+#include <engine/shared/json.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/serverinfo.h>
+#include <engine/shared/serverinfo_arena.h>
+#include <engine/storage.h>
+
+#include <memory>
+#include <vector>
+
+static const char *TOOL_NAME = "serverbrowser_search_bench";
+
+// reads the server list in the format served by the master servers
+static bool LoadServerList(IStorage *pStorage, const char *pFilename, std::vector<CServerInfo> &vInfos, CServerInfoArena *pArena)
+{
+	void *pData;
+	unsigned DataSize;
+	if(!pStorage->ReadFile(pFilename, IStorage::TYPE_ABSOLUTE, &pData, &DataSize))
+		return false;
+
+	json_value *pJson = json_parse((const char *)pData, DataSize);
+	free(pData);
+	if(!pJson)
+		return false;
+
+	const json_value &Servers = (*pJson)["servers"];
+	if(Servers.type == json_array)
+	{
+		for(unsigned i = 0; i < Servers.u.array.length; i++)
+		{
+			CServerInfo2 ParsedInfo;
+			if(CServerInfo2::FromJson(&ParsedInfo, &Servers[i]["info"]))
+				continue;
+			CServerInfo Info;
+			ParsedInfo.ToServerInfo(&Info, pArena);
+			vInfos.push_back(Info);
+		}
+	}
+	json_value_free(pJson);
+	return Servers.type == json_array;
+}
+
+static bool Matches(const CServerInfo &Info, const char *pNeedle)
+{
+	if(str_utf8_find_nocase(Info.m_aName, pNeedle) || str_utf8_find_nocase(Info.m_pMap, pNeedle))
+		return true;
+	for(int p = 0; p < Info.m_NumReceivedClients; p++)
+	{
+		if(str_utf8_find_nocase(Info.m_pClients[p].m_pName, pNeedle) || str_utf8_find_nocase(Info.m_pClients[p].m_pClan, pNeedle))
+			return true;
+	}
+	return false;
+}
+
+// returns the number of matching servers summed over all iterations
+static int RunPass(const std::vector<CServerInfo> &vInfos, const CServerBrowserSearchIndex *pIndex, const char *pNeedle, int Iterations, int64_t &Duration)
+{
+	int NumMatches = 0;
+	std::vector<int> vCandidates;
+	const int64_t Start = time_get_nanoseconds().count();
+	for(int Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		if(pIndex && pIndex->Candidates(pNeedle, vCandidates))
+		{
+			for(int Candidate : vCandidates)
+				NumMatches += Matches(vInfos[Candidate], pNeedle);
+		}
+		else
+		{
+			for(const CServerInfo &Info : vInfos)
+				NumMatches += Matches(Info, pNeedle);
+		}
+	}
+	Duration = time_get_nanoseconds().count() - Start;
+	return NumMatches;
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc < 2 || argc > 4)
+	{
+		log_error(TOOL_NAME, "Usage: %s <servers.json> [search string] [iterations]", TOOL_NAME);
+		return -1;
+	}
+	const char *pSearch = argc >= 3 ? argv[2] : "brainless tee";
+	const int Iterations = argc == 4 ? maximum(str_toint(argv[3]), 1) : 100;
+
+	std::unique_ptr<IStorage> pStorage = std::unique_ptr<IStorage>(CreateLocalStorage());
+	if(!pStorage)
+	{
+		log_error(TOOL_NAME, "Error creating local storage");
+		return -1;
+	}
+
+	std::vector<CServerInfo> vInfos;
+	CServerInfoArena Arena;
+	if(!LoadServerList(pStorage.get(), argv[1], vInfos, &Arena))
+	{
+		log_error(TOOL_NAME, "Error loading server list '%s'", argv[1]);
+		return -1;
+	}
+
+	CServerBrowserSearchIndex Index;
+	const int64_t IndexStart = time_get_nanoseconds().count();
+	for(int i = 0; i < (int)vInfos.size(); i++)
+		Index.Update(i, vInfos[i]);
+	const int64_t IndexDuration = time_get_nanoseconds().count() - IndexStart;
+	log_info(TOOL_NAME, "indexed %d servers in %.3fms, %d distinct trigrams", Index.NumEntries(), IndexDuration / 1000000.0, Index.NumTrigrams());
+
+	// search every prefix of the search string like it is typed into the browser
+	bool Identical = true;
+	char aNeedle[128];
+	for(int Length = str_utf8_forward(pSearch, 0); Length > 0; Length = str_utf8_forward(pSearch, Length))
+	{
+		str_truncate(aNeedle, sizeof(aNeedle), pSearch, Length);
+		int64_t ScanDuration, IndexedDuration;
+		const int ScanMatches = RunPass(vInfos, nullptr, aNeedle, Iterations, ScanDuration);
+		const int IndexedMatches = RunPass(vInfos, &Index, aNeedle, Iterations, IndexedDuration);
+		log_info(TOOL_NAME, "'%s': %d matches, scan %.3fms, indexed %.3fms", aNeedle, ScanMatches / Iterations, ScanDuration / 1000000.0 / Iterations, IndexedDuration / 1000000.0 / Iterations);
+		if(ScanMatches != IndexedMatches)
+		{
+			log_error(TOOL_NAME, "'%s': indexed search found %d matches instead of %d", aNeedle, IndexedMatches / Iterations, ScanMatches / Iterations);
+			Identical = false;
+		}
+		if(pSearch[Length] == '\0')
+			break;
+	}
+	return Identical ? 0 : -1;
+}
@@ -0,0 +1,169 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/client/serverbrowser_sortkeys.h>
+#include <engine/serverbrowser.h>
+#include <engine/shared/json.h>
+#include <engine/shared/serverinfo.h>
+#include <engine/shared/serverinfo_arena.h>
+#include <engine/storage.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+static const char *TOOL_NAME = "serverbrowser_sort_bench";
+
+typedef IServerBrowser::CServerEntry CServerEntry;
+
+// reads the server list in the format served by the master servers, every
+// entry is allocated separately like in the server browser
+static bool LoadServerList(IStorage *pStorage, const char *pFilename, std::vector<std::unique_ptr<CServerEntry>> &vpEntries, CServerInfoArena *pArena)
+{
+	void *pData;
+	unsigned DataSize;
+	if(!pStorage->ReadFile(pFilename, IStorage::TYPE_ABSOLUTE, &pData, &DataSize))
+		return false;
+
+	json_value *pJson = json_parse((const char *)pData, DataSize);
+	free(pData);
+	if(!pJson)
+		return false;
+
+	const json_value &Servers = (*pJson)["servers"];
+	if(Servers.type == json_array)
+	{
+		for(unsigned i = 0; i < Servers.u.array.length; i++)
+		{
+			CServerInfo2 ParsedInfo;
+			if(CServerInfo2::FromJson(&ParsedInfo, &Servers[i]["info"]))
+				continue;
+			std::unique_ptr<CServerEntry> pEntry = std::make_unique<CServerEntry>();
+			ParsedInfo.ToServerInfo(&pEntry->m_Info, pArena);
+			pEntry->m_GotInfo = 1;
+			pEntry->m_Info.m_Latency = secure_rand_below(400);
+			pEntry->m_Info.m_NumFilteredPlayers = pEntry->m_Info.m_NumPlayers;
+			pEntry->m_Info.m_FriendNum = secure_rand_below(3);
+			vpEntries.push_back(std::move(pEntry));
+		}
+	}
+	json_value_free(pJson);
+	return Servers.type == json_array;
+}
+
+struct CSortCriterion
+{
+	const char *m_pName;
+	int m_Sort;
+	// comparison on the server entries, as done before the sort keys
+	std::function<bool(const CServerEntry *, const CServerEntry *)> m_EntryLess;
+	std::function<bool(const CServerBrowserSortKeys &, int, int)> m_KeyLess;
+};
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+	if(secure_random_init() != 0)
+	{
+		log_error(TOOL_NAME, "could not initialize secure RNG");
+		return -1;
+	}
+
+	if(argc < 2 || argc > 3)
+	{
+		log_error(TOOL_NAME, "Usage: %s <servers.json> [iterations]", TOOL_NAME);
+		return -1;
+	}
+	const int Iterations = argc == 3 ? maximum(str_toint(argv[2]), 1) : 100;
+
+	std::unique_ptr<IStorage> pStorage = std::unique_ptr<IStorage>(CreateLocalStorage());
+	if(!pStorage)
+	{
+		log_error(TOOL_NAME, "Error creating local storage");
+		return -1;
+	}
+
+	std::vector<std::unique_ptr<CServerEntry>> vpOwnedEntries;
+	CServerInfoArena Arena;
+	if(!LoadServerList(pStorage.get(), argv[1], vpOwnedEntries, &Arena))
+	{
+		log_error(TOOL_NAME, "Error loading server list '%s'", argv[1]);
+		return -1;
+	}
+	std::vector<const CServerEntry *> vpEntries;
+	for(const auto &pEntry : vpOwnedEntries)
+		vpEntries.push_back(pEntry.get());
+	const int NumServers = vpEntries.size();
+	log_info(TOOL_NAME, "%d servers, %d bytes per entry", NumServers, (int)sizeof(CServerEntry));
+
+	const CSortCriterion aCriteria[] = {
+		{"name", IServerBrowser::SORT_NAME,
+			[](const CServerEntry *pEntry1, const CServerEntry *pEntry2) { return str_comp(pEntry1->m_Info.m_aName, pEntry2->m_Info.m_aName) < 0; },
+			[](const CServerBrowserSortKeys &Keys, int a, int b) { return str_comp(Keys.m_vpName[a], Keys.m_vpName[b]) < 0; }},
+		{"map", IServerBrowser::SORT_MAP,
+			[](const CServerEntry *pEntry1, const CServerEntry *pEntry2) { return str_comp(pEntry1->m_Info.m_pMap, pEntry2->m_Info.m_pMap) < 0; },
+			[](const CServerBrowserSortKeys &Keys, int a, int b) { return str_comp(Keys.m_vpMap[a], Keys.m_vpMap[b]) < 0; }},
+		{"gametype", IServerBrowser::SORT_GAMETYPE,
+			[](const CServerEntry *pEntry1, const CServerEntry *pEntry2) { return str_comp(pEntry1->m_Info.m_pGameType, pEntry2->m_Info.m_pGameType) < 0; },
+			[](const CServerBrowserSortKeys &Keys, int a, int b) { return Keys.m_vGameTypeRank[a] < Keys.m_vGameTypeRank[b]; }},
+		{"ping", IServerBrowser::SORT_PING,
+			[](const CServerEntry *pEntry1, const CServerEntry *pEntry2) { return pEntry1->m_Info.m_Latency < pEntry2->m_Info.m_Latency; },
+			[](const CServerBrowserSortKeys &Keys, int a, int b) { return Keys.m_vLatency[a] < Keys.m_vLatency[b]; }},
+		{"players", IServerBrowser::SORT_NUMPLAYERS,
+			[](const CServerEntry *pEntry1, const CServerEntry *pEntry2) { return pEntry1->m_Info.m_NumFilteredPlayers > pEntry2->m_Info.m_NumFilteredPlayers; },
+			[](const CServerBrowserSortKeys &Keys, int a, int b) { return Keys.m_vNumFilteredPlayers[a] > Keys.m_vNumFilteredPlayers[b]; }},
+		{"friends", IServerBrowser::SORT_NUMFRIENDS,
+			[](const CServerEntry *pEntry1, const CServerEntry *pEntry2) {
+				if(pEntry1->m_Info.m_FriendNum == pEntry2->m_Info.m_FriendNum)
+					return pEntry1->m_Info.m_NumFilteredPlayers > pEntry2->m_Info.m_NumFilteredPlayers;
+				return pEntry1->m_Info.m_FriendNum > pEntry2->m_Info.m_FriendNum;
+			},
+			[](const CServerBrowserSortKeys &Keys, int a, int b) {
+				if(Keys.m_vFriendNum[a] == Keys.m_vFriendNum[b])
+					return Keys.m_vNumFilteredPlayers[a] > Keys.m_vNumFilteredPlayers[b];
+				return Keys.m_vFriendNum[a] > Keys.m_vFriendNum[b];
+			}},
+	};
+
+	bool Identical = true;
+	std::vector<int> vEntryOrder(NumServers);
+	std::vector<int> vKeyOrder(NumServers);
+	CServerBrowserSortKeys SortKeys;
+	for(const CSortCriterion &Criterion : aCriteria)
+	{
+		// sort a shuffled list in every iteration like the browser does after updates
+		std::vector<int> vShuffled(NumServers);
+		for(int i = 0; i < NumServers; i++)
+			vShuffled[i] = i;
+		for(int i = NumServers - 1; i > 0; i--)
+			std::swap(vShuffled[i], vShuffled[secure_rand_below(i + 1)]);
+
+		const int64_t EntryStart = time_get_nanoseconds().count();
+		for(int Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			vEntryOrder = vShuffled;
+			std::stable_sort(vEntryOrder.begin(), vEntryOrder.end(), [&](int a, int b) { return Criterion.m_EntryLess(vpEntries[a], vpEntries[b]); });
+		}
+		const int64_t EntryDuration = time_get_nanoseconds().count() - EntryStart;
+
+		const int64_t KeyStart = time_get_nanoseconds().count();
+		for(int Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			SortKeys.Update(vpEntries.data(), NumServers, Criterion.m_Sort);
+			vKeyOrder = vShuffled;
+			std::stable_sort(vKeyOrder.begin(), vKeyOrder.end(), [&](int a, int b) { return Criterion.m_KeyLess(SortKeys, a, b); });
+		}
+		const int64_t KeyDuration = time_get_nanoseconds().count() - KeyStart;
+
+		log_info(TOOL_NAME, "%s: entries %.3fms, sort keys %.3fms (including update)", Criterion.m_pName, EntryDuration / 1000000.0 / Iterations, KeyDuration / 1000000.0 / Iterations);
+		if(vEntryOrder != vKeyOrder)
+		{
+			log_error(TOOL_NAME, "%s: sorting by the sort keys gives a different order", Criterion.m_pName);
+			Identical = false;
+		}
+	}
+	return Identical ? 0 : -1;
+}
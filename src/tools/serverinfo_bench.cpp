@@ -0,0 +1,234 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/server/serverinfo_cache.h>
+#include <engine/shared/masterserver.h>
+#include <engine/shared/network.h>
+#include <engine/shared/packer.h>
+#include <engine/shared/protocol.h>
+
+#include <game/prng.h>
+
+#include <vector>
+
+static const char *TOOL_NAME = "serverinfo_bench";
+
+enum
+{
+	TYPE_VANILLA = 0,
+	TYPE_64_LEGACY,
+	TYPE_EXTENDED,
+	NUM_TYPES,
+};
+
+static const char *const TYPE_NAMES[] = {"vanilla", "legacy 64", "extended"};
+
+static const char *const NAME_PARTS[] = {"nameless", "tee", "Dummy", "[D]", "ДДРейсер", "ツ", "Gores", "xX", "Pro", "★", "Müller", "42", "brainless", "Kirby"};
+
+// Server info responses of a full 64 player server. The caches are built
+// the way CServer::CacheServerInfo splits the clients into chunks.
+class CServerInfoCaches
+{
+public:
+	CServerInfoCache m_aCaches[NUM_TYPES];
+	// the header of each chunk, the old packing adds it for every request
+	std::vector<const unsigned char *> m_avpHeaders[NUM_TYPES];
+
+	void Build(const std::vector<std::vector<uint8_t>> &vvClients)
+	{
+		CPacker Prefix;
+		Prefix.Reset();
+		Prefix.AddString("0.6.4, 18.7", 32);
+		Prefix.AddString("DDNet GER10 [ger10.ddnet.org] - Novice", 64);
+		Prefix.AddString("Multeasymap", 32);
+		Prefix.AddString("DDraceNetwork", 16);
+		for(const char *pInt : {"0", "64", "64", "64", "64"})
+			Prefix.AddString(pInt, 0);
+
+		for(int Type = 0; Type < NUM_TYPES; Type++)
+		{
+			m_aCaches[Type].Clear();
+			m_avpHeaders[Type].clear();
+			CPacker q;
+			q.Reset();
+			if(Type != TYPE_EXTENDED)
+				q.AddRaw(Prefix.Data(), Prefix.Size());
+			if(Type == TYPE_64_LEGACY)
+				q.AddInt(0);
+			const auto &&Save = [&](int Size) {
+				const unsigned char *pHeader = Type == TYPE_VANILLA ? SERVERBROWSE_INFO : Type == TYPE_64_LEGACY ? SERVERBROWSE_INFO_64_LEGACY : m_avpHeaders[Type].empty() ? SERVERBROWSE_INFO_EXTENDED : SERVERBROWSE_INFO_EXTENDED_MORE;
+				m_aCaches[Type].AddChunk(pHeader, SERVERBROWSE_SIZE, q.Data(), Size);
+				m_avpHeaders[Type].push_back(pHeader);
+			};
+
+			int Stored = 0;
+			for(int i = 0; i < (int)vvClients.size(); i++)
+			{
+				if(Type == TYPE_VANILLA && Stored == VANILLA_MAX_CLIENTS)
+					break;
+				if(Type == TYPE_64_LEGACY && Stored > 0 && Stored % 24 == 0)
+				{
+					Save(q.Size());
+					q.Reset();
+					q.AddRaw(Prefix.Data(), Prefix.Size());
+					q.AddInt(Stored);
+				}
+				const int PreviousSize = q.Size();
+				q.AddRaw(vvClients[i].data(), vvClients[i].size());
+				if(Type == TYPE_EXTENDED)
+				{
+					q.AddString("", 0);
+					if(q.Size() >= NET_MAX_PAYLOAD - SERVERBROWSE_SIZE - CServerInfoCache::MAX_TOKEN_SIZE)
+					{
+						i--;
+						Save(PreviousSize);
+						q.Reset();
+						q.AddString("1", 0);
+						q.AddString("", 0);
+						continue;
+					}
+				}
+				Stored++;
+			}
+			Save(q.Size());
+		}
+	}
+};
+
+// the response packing of CServer::SendServerInfo before the payloads were
+// prebuilt, every chunk is packed again with the header and the token
+static unsigned OldResponse(const CServerInfoCache &Cache, const std::vector<const unsigned char *> &vpHeaders, int Token)
+{
+	unsigned Checksum = 0;
+	char aBuf[128];
+	CPacker p;
+	for(size_t c = 0; c < Cache.m_vCache.size(); c++)
+	{
+		const CServerInfoCache::CCacheChunk &Chunk = Cache.m_vCache[c];
+		p.Reset();
+		p.AddRaw(vpHeaders[c], SERVERBROWSE_SIZE);
+		str_format(aBuf, sizeof(aBuf), "%d", Token);
+		p.AddString(aBuf, 0);
+		p.AddRaw(Chunk.m_vData.data() + Chunk.m_HeaderSize, Chunk.m_vData.size() - Chunk.m_HeaderSize);
+		Checksum = Checksum * 31 + p.Size() + p.Data()[p.Size() - 1];
+	}
+	return Checksum;
+}
+
+static unsigned NewResponse(const CServerInfoCache &Cache, int Token)
+{
+	unsigned Checksum = 0;
+	unsigned char aData[NET_MAX_PAYLOAD];
+	for(const CServerInfoCache::CCacheChunk &Chunk : Cache.m_vCache)
+	{
+		const int Size = Chunk.Payload(Token, aData);
+		Checksum = Checksum * 31 + Size + aData[Size - 1];
+	}
+	return Checksum;
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc > 3)
+	{
+		log_error(TOOL_NAME, "Usage: %s [requests] [updates]", TOOL_NAME);
+		log_error(TOOL_NAME, "updates is the number of server info updates, each of them repacks the caches");
+		return -1;
+	}
+	const int NumRequests = argc > 1 ? maximum(str_toint(argv[1]), 1) : 200000;
+	const int NumUpdates = argc > 2 ? maximum(str_toint(argv[2]), 1) : 2000;
+
+	CPrng Prng;
+	uint64_t aSeed[2] = {0x73657276, 0x6572696e};
+	Prng.Seed(aSeed);
+
+	struct SClient
+	{
+		char m_aName[MAX_NAME_LENGTH];
+		char m_aClan[MAX_CLAN_LENGTH];
+		int m_Country;
+		int m_Score;
+		bool m_IsPlayer;
+	};
+	std::vector<SClient> vClients(MAX_CLIENTS);
+	for(SClient &Client : vClients)
+	{
+		str_format(Client.m_aName, sizeof(Client.m_aName), "%s %s", NAME_PARTS[Prng.RandomBits() % std::size(NAME_PARTS)], NAME_PARTS[Prng.RandomBits() % std::size(NAME_PARTS)]);
+		str_copy(Client.m_aClan, Prng.RandomBits() % 2 ? "Tee Team" : "");
+		Client.m_Country = Prng.RandomBits() % 1000;
+		Client.m_Score = Prng.RandomBits() % 20000;
+		Client.m_IsPlayer = Prng.RandomBits() % 8 != 0;
+	}
+
+	// Server info updates: the old code packed every client for every cache
+	// variant, the new one only repacks clients whose entry changed, which
+	// is about one client per update during a round.
+	std::vector<std::vector<uint8_t>> vvClients(MAX_CLIENTS);
+	CPacker Packer;
+	CServerInfoCaches Caches;
+	int64_t aUpdateDurations[2];
+	for(int New = 0; New < 2; New++)
+	{
+		const int64_t Start = time_get_nanoseconds().count();
+		for(int Update = 0; Update < NumUpdates; Update++)
+		{
+			vClients[Update % MAX_CLIENTS].m_Score++;
+			for(int i = 0; i < MAX_CLIENTS; i++)
+			{
+				if(New && i != Update % MAX_CLIENTS && !vvClients[i].empty())
+					continue;
+				const SClient &Client = vClients[i];
+				Packer.Reset();
+				CServerInfoCache::PackClient(&Packer, Client.m_aName, Client.m_aClan, Client.m_Country, Client.m_Score, Client.m_IsPlayer);
+				vvClients[i].assign(Packer.Data(), Packer.Data() + Packer.Size());
+			}
+			Caches.Build(vvClients);
+		}
+		aUpdateDurations[New] = time_get_nanoseconds().count() - Start;
+	}
+
+	// a request flood with random tokens, split over the info types
+	std::vector<int> vTokens;
+	std::vector<int> vTypes;
+	for(int i = 0; i < NumRequests; i++)
+	{
+		vTokens.push_back(Prng.RandomBits() % (1 << 24));
+		vTypes.push_back(Prng.RandomBits() % NUM_TYPES);
+	}
+
+	int64_t aDurations[2];
+	unsigned aChecksums[2] = {0, 0};
+	int NumPackets = 0;
+	for(int New = 0; New < 2; New++)
+	{
+		const int64_t Start = time_get_nanoseconds().count();
+		for(int i = 0; i < NumRequests; i++)
+		{
+			const int Type = vTypes[i];
+			if(New)
+				aChecksums[New] += NewResponse(Caches.m_aCaches[Type], vTokens[i]);
+			else
+				aChecksums[New] += OldResponse(Caches.m_aCaches[Type], Caches.m_avpHeaders[Type], vTokens[i]);
+		}
+		aDurations[New] = time_get_nanoseconds().count() - Start;
+	}
+	for(int i = 0; i < NumRequests; i++)
+		NumPackets += Caches.m_aCaches[vTypes[i]].m_vCache.size();
+
+	for(int Type = 0; Type < NUM_TYPES; Type++)
+		log_info(TOOL_NAME, "%s: %d chunks", TYPE_NAMES[Type], (int)Caches.m_aCaches[Type].m_vCache.size());
+	log_info(TOOL_NAME, "%d requests, %d packets, %d clients", NumRequests, NumPackets, MAX_CLIENTS);
+	log_info(TOOL_NAME, "packed per request: %.0f responses per second, %.1fns per packet", NumRequests / (aDurations[0] / 1000000000.0), aDurations[0] / (double)NumPackets);
+	log_info(TOOL_NAME, "prebuilt payloads: %.0f responses per second, %.1fns per packet", NumRequests / (aDurations[1] / 1000000000.0), aDurations[1] / (double)NumPackets);
+	log_info(TOOL_NAME, "cache updates: every client %.1fus, changed clients %.1fus per update", aUpdateDurations[0] / 1000.0 / NumUpdates, aUpdateDurations[1] / 1000.0 / NumUpdates);
+	if(aChecksums[0] != aChecksums[1])
+	{
+		log_error(TOOL_NAME, "the prebuilt payloads changed the result");
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,455 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/compression.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/snapshot.h>
+
+#include <game/generated/protocol.h>
+#include <game/prng.h>
+
+#include <vector>
+
+static const char *TOOL_NAME = "snapshot_bench";
+
+enum
+{
+	MAX_NETOBJSIZES = 64,
+};
+
+// CSnapshotDelta before the sorted key merge, the items were matched with
+// hash lists of the keys and deleted items were searched linearly
+class COldSnapshotDelta
+{
+	enum
+	{
+		HASHLIST_SIZE = 256,
+		HASHLIST_BUCKET_SIZE = 64,
+	};
+
+	struct CItemList
+	{
+		int m_Num;
+		int m_aKeys[HASHLIST_BUCKET_SIZE];
+		int m_aIndex[HASHLIST_BUCKET_SIZE];
+	};
+
+	static size_t CalcHashId(int Key)
+	{
+		unsigned Hash = 5381;
+		for(unsigned Shift = 0; Shift < sizeof(int); Shift++)
+			Hash = ((Hash << 5) + Hash) + ((Key >> (Shift * 8)) & 0xFF);
+		return Hash % HASHLIST_SIZE;
+	}
+
+	static void GenerateHash(CItemList *pHashlist, const CSnapshot *pSnapshot)
+	{
+		for(int i = 0; i < HASHLIST_SIZE; i++)
+			pHashlist[i].m_Num = 0;
+		for(int i = 0; i < pSnapshot->NumItems(); i++)
+		{
+			const int Key = pSnapshot->GetItem(i)->Key();
+			const size_t HashId = CalcHashId(Key);
+			if(pHashlist[HashId].m_Num < HASHLIST_BUCKET_SIZE)
+			{
+				pHashlist[HashId].m_aIndex[pHashlist[HashId].m_Num] = i;
+				pHashlist[HashId].m_aKeys[pHashlist[HashId].m_Num] = Key;
+				pHashlist[HashId].m_Num++;
+			}
+		}
+	}
+
+	static int GetItemIndexHashed(int Key, const CItemList *pHashlist)
+	{
+		const size_t HashId = CalcHashId(Key);
+		for(int i = 0; i < pHashlist[HashId].m_Num; i++)
+			if(pHashlist[HashId].m_aKeys[i] == Key)
+				return pHashlist[HashId].m_aIndex[i];
+		return -1;
+	}
+
+	static int DiffItem(const int *pPast, const int *pCurrent, int *pOut, int Size)
+	{
+		int Needed = 0;
+		while(Size)
+		{
+			*pOut = (unsigned)*pCurrent - (unsigned)*pPast;
+			Needed |= *pOut;
+			pOut++;
+			pPast++;
+			pCurrent++;
+			Size--;
+		}
+		return Needed;
+	}
+
+	static void UndiffItem(const int *pPast, const int *pDiff, int *pOut, int Size, uint64_t *pDataRate)
+	{
+		while(Size)
+		{
+			*pOut = (unsigned)*pPast + (unsigned)*pDiff;
+			if(*pDiff == 0)
+				*pDataRate += 1;
+			else
+			{
+				unsigned char aBuf[CVariableInt::MAX_BYTES_PACKED];
+				unsigned char *pEnd = CVariableInt::Pack(aBuf, *pDiff, sizeof(aBuf));
+				*pDataRate += (uint64_t)(pEnd - (unsigned char *)aBuf) * 8;
+			}
+			pOut++;
+			pPast++;
+			pDiff++;
+			Size--;
+		}
+	}
+
+public:
+	short m_aItemSizes[MAX_NETOBJSIZES] = {0};
+	uint64_t m_aSnapshotDataRate[CSnapshot::MAX_TYPE + 1] = {0};
+
+	int CreateDelta(const CSnapshot *pFrom, const CSnapshot *pTo, void *pDstData)
+	{
+		CSnapshotDelta::CData *pDelta = (CSnapshotDelta::CData *)pDstData;
+		int *pData = (int *)pDelta->m_aData;
+		pDelta->m_NumDeletedItems = 0;
+		pDelta->m_NumUpdateItems = 0;
+		pDelta->m_NumTempItems = 0;
+
+		CItemList aHashlist[HASHLIST_SIZE];
+		GenerateHash(aHashlist, pTo);
+		for(int i = 0; i < pFrom->NumItems(); i++)
+		{
+			const CSnapshotItem *pFromItem = pFrom->GetItem(i);
+			if(GetItemIndexHashed(pFromItem->Key(), aHashlist) == -1)
+			{
+				pDelta->m_NumDeletedItems++;
+				*pData++ = pFromItem->Key();
+			}
+		}
+
+		GenerateHash(aHashlist, pFrom);
+		int aPastIndices[CSnapshot::MAX_ITEMS];
+		const int NumItems = pTo->NumItems();
+		for(int i = 0; i < NumItems; i++)
+			aPastIndices[i] = GetItemIndexHashed(pTo->GetItem(i)->Key(), aHashlist);
+
+		for(int i = 0; i < NumItems; i++)
+		{
+			const int ItemSize = pTo->GetItemSize(i);
+			const CSnapshotItem *pCurItem = pTo->GetItem(i);
+			const int PastIndex = aPastIndices[i];
+			const bool IncludeSize = pCurItem->Type() >= MAX_NETOBJSIZES || !m_aItemSizes[pCurItem->Type()];
+			if(PastIndex != -1)
+			{
+				int *pItemDataDst = pData + (IncludeSize ? 3 : 2);
+				if(DiffItem(pFrom->GetItem(PastIndex)->Data(), pCurItem->Data(), pItemDataDst, ItemSize / sizeof(int32_t)))
+				{
+					*pData++ = pCurItem->Type();
+					*pData++ = pCurItem->Id();
+					if(IncludeSize)
+						*pData++ = ItemSize / sizeof(int32_t);
+					pData += ItemSize / sizeof(int32_t);
+					pDelta->m_NumUpdateItems++;
+				}
+			}
+			else
+			{
+				*pData++ = pCurItem->Type();
+				*pData++ = pCurItem->Id();
+				if(IncludeSize)
+					*pData++ = ItemSize / sizeof(int32_t);
+				mem_copy(pData, pCurItem->Data(), ItemSize);
+				pData += ItemSize / sizeof(int32_t);
+				pDelta->m_NumUpdateItems++;
+			}
+		}
+
+		if(!pDelta->m_NumDeletedItems && !pDelta->m_NumUpdateItems && !pDelta->m_NumTempItems)
+			return 0;
+		return (int)((char *)pData - (char *)pDstData);
+	}
+
+	// only the path taken by valid deltas, the error checks are the same
+	int UnpackDelta(const CSnapshot *pFrom, CSnapshot *pTo, const void *pSrcData, int DataSize)
+	{
+		const CSnapshotDelta::CData *pDelta = (const CSnapshotDelta::CData *)pSrcData;
+		const int *pData = pDelta->m_aData;
+
+		CSnapshotBuilder Builder;
+		Builder.Init();
+
+		const int *pDeleted = pData;
+		pData += pDelta->m_NumDeletedItems;
+		for(int i = 0; i < pFrom->NumItems(); i++)
+		{
+			const CSnapshotItem *pFromItem = pFrom->GetItem(i);
+			const int ItemSize = pFrom->GetItemSize(i);
+			bool Keep = true;
+			for(int d = 0; d < pDelta->m_NumDeletedItems; d++)
+			{
+				if(pDeleted[d] == pFromItem->Key())
+				{
+					Keep = false;
+					break;
+				}
+			}
+			if(Keep)
+				mem_copy(Builder.NewItem(pFromItem->Type(), pFromItem->Id(), ItemSize), pFromItem->Data(), ItemSize);
+		}
+
+		for(int i = 0; i < pDelta->m_NumUpdateItems; i++)
+		{
+			const int Type = *pData++;
+			const int Id = *pData++;
+			int ItemSize;
+			if(Type < MAX_NETOBJSIZES && m_aItemSizes[Type])
+				ItemSize = m_aItemSizes[Type];
+			else
+				ItemSize = (*pData++) * sizeof(int32_t);
+
+			const int Key = (Type << 16) | Id;
+			int *pNewData = Builder.GetItemData(Key);
+			if(!pNewData)
+				pNewData = (int *)Builder.NewItem(Type, Id, ItemSize);
+
+			const int FromIndex = pFrom->GetItemIndex(Key);
+			if(FromIndex != -1)
+			{
+				UndiffItem(pFrom->GetItem(FromIndex)->Data(), pData, pNewData, ItemSize / sizeof(int32_t), &m_aSnapshotDataRate[Type]);
+			}
+			else
+			{
+				mem_copy(pNewData, pData, ItemSize);
+				m_aSnapshotDataRate[Type] += ItemSize * 8;
+			}
+			pData += ItemSize / sizeof(int32_t);
+		}
+		return Builder.Finish(pTo);
+	}
+};
+
+// A full server: the players run around, shoot and sometimes reconnect,
+// projectiles and lasers come and go and the pickups stay where they are.
+class CWorld
+{
+	struct CPlayer
+	{
+		bool m_Present;
+		CNetObj_Character m_Character;
+		CNetObj_PlayerInfo m_PlayerInfo;
+		CNetObj_ClientInfo m_ClientInfo;
+	};
+
+	struct CShot
+	{
+		int m_Id;
+		bool m_Laser;
+		int m_Lifetime;
+		int m_aData[6];
+	};
+
+	CPrng m_Prng;
+	CPlayer m_aPlayers[MAX_CLIENTS];
+	std::vector<CShot> m_vShots;
+	int m_NextShotId = 0;
+	int m_Tick = 0;
+
+	int Random(int Max) { return m_Prng.RandomBits() % Max; }
+
+public:
+	CWorld()
+	{
+		uint64_t aSeed[2] = {0x736e6170, 0x73686f74};
+		m_Prng.Seed(aSeed);
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			CPlayer &Player = m_aPlayers[i];
+			mem_zero(&Player, sizeof(Player));
+			Player.m_Present = Random(8) != 0;
+			Player.m_Character.m_X = Random(200 * 32);
+			Player.m_Character.m_Y = Random(100 * 32);
+			Player.m_Character.m_Health = 10;
+			Player.m_PlayerInfo.m_ClientId = i;
+			int *pInfo = (int *)&Player.m_ClientInfo;
+			for(int j = 0; j < (int)(sizeof(Player.m_ClientInfo) / sizeof(int)); j++)
+				pInfo[j] = m_Prng.RandomBits();
+		}
+	}
+
+	void Tick()
+	{
+		m_Tick++;
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			CPlayer &Player = m_aPlayers[i];
+			if(Random(2000) == 0)
+				Player.m_Present = !Player.m_Present;
+			if(!Player.m_Present)
+				continue;
+			CNetObj_Character &Character = Player.m_Character;
+			// a third of the players are afk
+			if(i % 3 == 0)
+				continue;
+			Character.m_Tick = m_Tick;
+			Character.m_VelX = clamp(Character.m_VelX + Random(65) - 32, -1000, 1000);
+			Character.m_VelY = clamp(Character.m_VelY + Random(65) - 32, -1000, 1000);
+			Character.m_X += Character.m_VelX / 32;
+			Character.m_Y += Character.m_VelY / 32;
+			Character.m_Angle = Random(1024);
+			Character.m_Direction = Random(3) - 1;
+			if(Random(50) == 0)
+			{
+				Character.m_AttackTick = m_Tick;
+				CShot Shot;
+				Shot.m_Id = m_NextShotId++ % 1024;
+				Shot.m_Laser = Random(2);
+				Shot.m_Lifetime = 10 + Random(40);
+				Shot.m_aData[0] = Character.m_X;
+				Shot.m_aData[1] = Character.m_Y;
+				Shot.m_aData[2] = Random(2000) - 1000;
+				Shot.m_aData[3] = Random(2000) - 1000;
+				Shot.m_aData[4] = Shot.m_Laser ? m_Tick : Random(4);
+				Shot.m_aData[5] = m_Tick;
+				m_vShots.push_back(Shot);
+			}
+			Player.m_PlayerInfo.m_Latency = 20 + Random(40);
+		}
+		for(size_t i = 0; i < m_vShots.size();)
+		{
+			if(--m_vShots[i].m_Lifetime == 0)
+			{
+				m_vShots.erase(m_vShots.begin() + i);
+				continue;
+			}
+			i++;
+		}
+	}
+
+	void Snap(CSnapshotBuilder *pBuilder) const
+	{
+		pBuilder->Init();
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			const CPlayer &Player = m_aPlayers[i];
+			if(!Player.m_Present)
+				continue;
+			mem_copy(pBuilder->NewItem(NETOBJTYPE_CLIENTINFO, i, sizeof(Player.m_ClientInfo)), &Player.m_ClientInfo, sizeof(Player.m_ClientInfo));
+			mem_copy(pBuilder->NewItem(NETOBJTYPE_PLAYERINFO, i, sizeof(Player.m_PlayerInfo)), &Player.m_PlayerInfo, sizeof(Player.m_PlayerInfo));
+			mem_copy(pBuilder->NewItem(NETOBJTYPE_CHARACTER, i, sizeof(Player.m_Character)), &Player.m_Character, sizeof(Player.m_Character));
+		}
+		for(const CShot &Shot : m_vShots)
+		{
+			if(Shot.m_Laser)
+				mem_copy(pBuilder->NewItem(NETOBJTYPE_LASER, Shot.m_Id, sizeof(CNetObj_Laser)), Shot.m_aData, sizeof(CNetObj_Laser));
+			else
+				mem_copy(pBuilder->NewItem(NETOBJTYPE_PROJECTILE, Shot.m_Id, sizeof(CNetObj_Projectile)), Shot.m_aData, sizeof(CNetObj_Projectile));
+		}
+		for(int i = 0; i < 200; i++)
+		{
+			CNetObj_Pickup *pPickup = (CNetObj_Pickup *)pBuilder->NewItem(NETOBJTYPE_PICKUP, i, sizeof(CNetObj_Pickup));
+			pPickup->m_X = i * 64;
+			pPickup->m_Y = i % 7 * 64;
+			pPickup->m_Type = i % 3;
+		}
+	}
+};
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc > 2)
+	{
+		log_error(TOOL_NAME, "Usage: %s [ticks]", TOOL_NAME);
+		return -1;
+	}
+	const int NumTicks = argc > 1 ? maximum(str_toint(argv[1]), 1) : 5000;
+
+	CNetObjHandler NetObjHandler;
+	CSnapshotDelta Delta;
+	COldSnapshotDelta OldDelta;
+	for(int i = 0; i < NUM_NETOBJTYPES; i++)
+	{
+		Delta.SetStaticsize(i, NetObjHandler.GetObjSize(i));
+		OldDelta.m_aItemSizes[i] = NetObjHandler.GetObjSize(i);
+	}
+
+	// the snapshots of consecutive ticks
+	CWorld World;
+	CSnapshotBuilder Builder;
+	std::vector<std::vector<char>> vvSnapshots;
+	int TotalItems = 0;
+	for(int Tick = 0; Tick < NumTicks + 1; Tick++)
+	{
+		World.Tick();
+		World.Snap(&Builder);
+		std::vector<char> vSnapshot(CSnapshot::MAX_SIZE);
+		vSnapshot.resize(Builder.Finish(vSnapshot.data()));
+		TotalItems += ((const CSnapshot *)vSnapshot.data())->NumItems();
+		vvSnapshots.push_back(std::move(vSnapshot));
+	}
+
+	std::vector<std::vector<char>> avvDeltas[2];
+	int64_t aCreateDurations[2];
+	for(int New = 0; New < 2; New++)
+	{
+		char aDeltaData[CSnapshot::MAX_SIZE];
+		const int64_t Start = time_get_nanoseconds().count();
+		for(int Tick = 0; Tick < NumTicks; Tick++)
+		{
+			const CSnapshot *pFrom = (const CSnapshot *)vvSnapshots[Tick].data();
+			const CSnapshot *pTo = (const CSnapshot *)vvSnapshots[Tick + 1].data();
+			const int Size = New ? Delta.CreateDelta(pFrom, pTo, aDeltaData) : OldDelta.CreateDelta(pFrom, pTo, aDeltaData);
+			avvDeltas[New].emplace_back(aDeltaData, aDeltaData + Size);
+		}
+		aCreateDurations[New] = time_get_nanoseconds().count() - Start;
+	}
+
+	std::vector<std::vector<char>> avvUnpacked[2];
+	int64_t aUnpackDurations[2];
+	bool UnpackFailed = false;
+	for(int New = 0; New < 2; New++)
+	{
+		char aUnpacked[CSnapshot::MAX_SIZE];
+		const int64_t Start = time_get_nanoseconds().count();
+		for(int Tick = 0; Tick < NumTicks; Tick++)
+		{
+			const CSnapshot *pFrom = (const CSnapshot *)vvSnapshots[Tick].data();
+			const std::vector<char> &vDelta = avvDeltas[1][Tick];
+			if(vDelta.empty())
+				continue;
+			const int Size = New ? Delta.UnpackDelta(pFrom, (CSnapshot *)aUnpacked, vDelta.data(), vDelta.size(), false) : OldDelta.UnpackDelta(pFrom, (CSnapshot *)aUnpacked, vDelta.data(), vDelta.size());
+			UnpackFailed |= Size < 0;
+			avvUnpacked[New].emplace_back(aUnpacked, aUnpacked + maximum(Size, 0));
+		}
+		aUnpackDurations[New] = time_get_nanoseconds().count() - Start;
+	}
+
+	bool SameDataRate = true;
+	uint64_t TotalDataRate = 0;
+	for(int Type = 0; Type <= CSnapshot::MAX_TYPE; Type++)
+	{
+		SameDataRate &= Delta.GetDataRate(Type) == OldDelta.m_aSnapshotDataRate[Type];
+		TotalDataRate += Delta.GetDataRate(Type);
+	}
+
+	size_t DeltaBytes = 0;
+	for(const std::vector<char> &vDelta : avvDeltas[1])
+		DeltaBytes += vDelta.size();
+	log_info(TOOL_NAME, "%d deltas, %.1f items per snapshot, %.0f bytes per delta, %.0f bits data rate per delta", NumTicks, TotalItems / (double)(NumTicks + 1), DeltaBytes / (double)NumTicks, TotalDataRate / (double)NumTicks);
+	log_info(TOOL_NAME, "create delta: hash lists %.2fus, sorted keys %.2fus", aCreateDurations[0] / 1000.0 / NumTicks, aCreateDurations[1] / 1000.0 / NumTicks);
+	log_info(TOOL_NAME, "unpack delta: linear search %.2fus, sorted keys %.2fus", aUnpackDurations[0] / 1000.0 / NumTicks, aUnpackDurations[1] / 1000.0 / NumTicks);
+	if(avvDeltas[0] != avvDeltas[1])
+	{
+		log_error(TOOL_NAME, "the deltas differ from the hash list implementation");
+		return -1;
+	}
+	if(UnpackFailed || avvUnpacked[0] != avvUnpacked[1] || !SameDataRate)
+	{
+		log_error(TOOL_NAME, "the unpacked snapshots or the data rate differ from the previous implementation");
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,599 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/kernel.h>
+#include <engine/map.h>
+#include <engine/shared/json.h>
+#include <engine/shared/packer.h>
+#include <engine/shared/snapshot.h>
+#include <engine/shared/teehistorian_ex.h>
+#include <engine/shared/tickprofiler.h>
+#include <engine/shared/uuid_manager.h>
+#include <engine/storage.h>
+
+#include <game/collision.h>
+#include <game/gamecore.h>
+#include <game/layers.h>
+#include <game/teamscore.h>
+
+#include <memory>
+#include <vector>
+
+// Replays the inputs of a teehistorian file through the character cores
+// (CWorldCore, CCharacterCore and CTeamsCore) against the map collision and
+// measures how fast they tick. The game world of the server is not run:
+// freeze, death and teleporter tiles, switches, weapons and everything else
+// that CGameContext does outside of the cores is missing. On maps that use
+// those the replay diverges from the recording, so the match rate is only a
+// check of the core physics and only fails the run when asked to with
+// --tolerance. The timings cover the core phases of the replay, not the
+// subsystems of a server tick.
+
+static const char *TOOL_NAME = "teehistorian_replay";
+
+static const CUuid TEEHISTORIAN_UUID = CalculateUuid(TEEHISTORIAN_NAME);
+
+enum
+{
+	NUM_INPUT_INTS = sizeof(CNetObj_PlayerInput) / sizeof(int32_t),
+};
+
+// everything recorded for one tick that is relevant to the physics
+struct CRecordedTick
+{
+	struct CPlayer
+	{
+		enum EType
+		{
+			TYPE_DIFF,
+			TYPE_NEW,
+			TYPE_OLD,
+		};
+		EType m_Type;
+		int m_ClientId;
+		int m_X;
+		int m_Y;
+	};
+	struct CInput
+	{
+		int m_ClientId;
+		bool m_New;
+		int m_aData[NUM_INPUT_INTS];
+	};
+	struct CTeam
+	{
+		int m_ClientId;
+		int m_Team;
+	};
+
+	int m_Tick;
+	std::vector<CPlayer> m_vPlayers;
+	std::vector<CInput> m_vInputs;
+	std::vector<CTeam> m_vTeams;
+};
+
+class CTeehistorianFile
+{
+public:
+	char m_aMapName[128] = "";
+	char m_aMapSha256[SHA256_MAXSTRSIZE] = "";
+	CTuningParams m_Tuning;
+	std::vector<CRecordedTick> m_vTicks;
+
+	bool Load(const unsigned char *pData, unsigned Size);
+
+private:
+	bool ParseHeader(const char *pJson, int Length);
+	CRecordedTick *BeginTick(int Tick);
+};
+
+bool CTeehistorianFile::ParseHeader(const char *pJson, int Length)
+{
+	json_value *pHeader = json_parse(pJson, Length);
+	if(!pHeader || pHeader->type != json_object)
+	{
+		json_value_free(pHeader);
+		return false;
+	}
+
+	const json_value *pMapName = json_object_get(pHeader, "map_name");
+	if(pMapName->type == json_string)
+		str_copy(m_aMapName, json_string_get(pMapName));
+	const json_value *pMapSha256 = json_object_get(pHeader, "map_sha256");
+	if(pMapSha256->type == json_string)
+		str_copy(m_aMapSha256, json_string_get(pMapSha256));
+
+	// only tuning values different from the defaults are recorded, as fixed point strings
+	const json_value *pTuning = json_object_get(pHeader, "tuning");
+	if(pTuning->type == json_object)
+	{
+		for(unsigned i = 0; i < pTuning->u.object.length; i++)
+		{
+			const json_value *pValue = pTuning->u.object.values[i].value;
+			if(pValue->type == json_string)
+				m_Tuning.Set(pTuning->u.object.values[i].name, str_toint(json_string_get(pValue)) / 100.0f);
+		}
+	}
+
+	json_value_free(pHeader);
+	return true;
+}
+
+CRecordedTick *CTeehistorianFile::BeginTick(int Tick)
+{
+	m_vTicks.emplace_back();
+	m_vTicks.back().m_Tick = Tick;
+	return &m_vTicks.back();
+}
+
+bool CTeehistorianFile::Load(const unsigned char *pData, unsigned Size)
+{
+	if(Size < sizeof(CUuid) || mem_comp(pData, &TEEHISTORIAN_UUID, sizeof(CUuid)) != 0)
+	{
+		log_error(TOOL_NAME, "not a teehistorian file");
+		return false;
+	}
+	const char *pJson = (const char *)pData + sizeof(CUuid);
+	const int JsonLength = str_length(pJson);
+	if(sizeof(CUuid) + JsonLength + 1 > Size || !ParseHeader(pJson, JsonLength))
+	{
+		log_error(TOOL_NAME, "invalid teehistorian header");
+		return false;
+	}
+
+	CUnpacker Unpacker;
+	Unpacker.Reset(pJson + JsonLength + 1, Size - sizeof(CUuid) - JsonLength - 1);
+
+	int aPrevInput[MAX_CLIENTS][NUM_INPUT_INTS] = {{0}};
+	int aX[MAX_CLIENTS] = {0};
+	int aY[MAX_CLIENTS] = {0};
+
+	// the tick is implicit when player data is not in ascending client order
+	int Tick = 0;
+	int LastPlayerClientId = MAX_CLIENTS;
+	CRecordedTick *pTick = nullptr;
+	auto PlayerData = [&](int ClientId) {
+		if(ClientId <= LastPlayerClientId)
+		{
+			Tick++;
+			pTick = BeginTick(Tick);
+		}
+		LastPlayerClientId = ClientId;
+	};
+	auto ValidClientId = [&](int ClientId) {
+		if(ClientId < 0 || ClientId >= MAX_CLIENTS || !pTick)
+		{
+			log_error(TOOL_NAME, "invalid client id %d in tick %d", ClientId, Tick);
+			return false;
+		}
+		return true;
+	};
+
+	while(true)
+	{
+		const int Type = Unpacker.GetInt();
+		if(Unpacker.Error())
+		{
+			log_warn(TOOL_NAME, "file ends without finish chunk");
+			return true;
+		}
+
+		if(Type >= 0)
+		{
+			// player diff
+			const int dx = Unpacker.GetInt();
+			const int dy = Unpacker.GetInt();
+			PlayerData(Type);
+			if(!ValidClientId(Type))
+				return false;
+			aX[Type] += dx;
+			aY[Type] += dy;
+			pTick->m_vPlayers.push_back({CRecordedTick::CPlayer::TYPE_DIFF, Type, aX[Type], aY[Type]});
+			continue;
+		}
+
+		switch(-Type)
+		{
+		case TEEHISTORIAN_FINISH:
+			return true;
+		case TEEHISTORIAN_TICK_SKIP:
+			Tick += Unpacker.GetInt() + 1;
+			LastPlayerClientId = -1;
+			pTick = BeginTick(Tick);
+			break;
+		case TEEHISTORIAN_PLAYER_NEW:
+		{
+			const int ClientId = Unpacker.GetInt();
+			const int X = Unpacker.GetInt();
+			const int Y = Unpacker.GetInt();
+			PlayerData(ClientId);
+			if(!ValidClientId(ClientId))
+				return false;
+			aX[ClientId] = X;
+			aY[ClientId] = Y;
+			pTick->m_vPlayers.push_back({CRecordedTick::CPlayer::TYPE_NEW, ClientId, X, Y});
+			break;
+		}
+		case TEEHISTORIAN_PLAYER_OLD:
+		{
+			const int ClientId = Unpacker.GetInt();
+			PlayerData(ClientId);
+			if(!ValidClientId(ClientId))
+				return false;
+			pTick->m_vPlayers.push_back({CRecordedTick::CPlayer::TYPE_OLD, ClientId, 0, 0});
+			break;
+		}
+		case TEEHISTORIAN_INPUT_DIFF:
+		case TEEHISTORIAN_INPUT_NEW:
+		{
+			const int ClientId = Unpacker.GetInt();
+			if(!ValidClientId(ClientId))
+				return false;
+			CRecordedTick::CInput Input;
+			Input.m_ClientId = ClientId;
+			Input.m_New = Type == -TEEHISTORIAN_INPUT_NEW;
+			for(int i = 0; i < NUM_INPUT_INTS; i++)
+			{
+				const int Value = Unpacker.GetInt();
+				aPrevInput[ClientId][i] = Input.m_New ? Value : aPrevInput[ClientId][i] + Value;
+				Input.m_aData[i] = aPrevInput[ClientId][i];
+			}
+			pTick->m_vInputs.push_back(Input);
+			break;
+		}
+		case TEEHISTORIAN_MESSAGE:
+		{
+			Unpacker.GetInt();
+			const int MsgSize = Unpacker.GetInt();
+			Unpacker.GetRaw(MsgSize);
+			break;
+		}
+		case TEEHISTORIAN_JOIN:
+			Unpacker.GetInt();
+			break;
+		case TEEHISTORIAN_DROP:
+			Unpacker.GetInt();
+			Unpacker.GetString();
+			break;
+		case TEEHISTORIAN_CONSOLE_COMMAND:
+		{
+			Unpacker.GetInt();
+			Unpacker.GetInt();
+			Unpacker.GetString();
+			const int NumArgs = Unpacker.GetInt();
+			for(int i = 0; i < NumArgs && !Unpacker.Error(); i++)
+				Unpacker.GetString();
+			break;
+		}
+		case TEEHISTORIAN_EX:
+		{
+			const unsigned char *pUuid = Unpacker.GetRaw(sizeof(CUuid));
+			const int ExSize = Unpacker.GetInt();
+			const unsigned char *pExData = Unpacker.GetRaw(ExSize);
+			if(Unpacker.Error())
+				break;
+			CUuid Uuid;
+			mem_copy(&Uuid, pUuid, sizeof(Uuid));
+			if(g_UuidManager.LookupUuid(Uuid) == TEEHISTORIAN_PLAYER_TEAM)
+			{
+				CUnpacker Ex;
+				Ex.Reset(pExData, ExSize);
+				const int ClientId = Ex.GetInt();
+				const int Team = Ex.GetInt();
+				if(!Ex.Error() && ValidClientId(ClientId))
+					pTick->m_vTeams.push_back({ClientId, Team});
+			}
+			break;
+		}
+		default:
+			log_error(TOOL_NAME, "unknown chunk type %d in tick %d", -Type, Tick);
+			return false;
+		}
+	}
+}
+
+// replays the recorded inputs through the character cores only, a player
+// whose position diverges is counted and moved back to the recorded one to
+// keep checking the following ticks
+class CReplay
+{
+public:
+	enum
+	{
+		SECTION_INPUT,
+		SECTION_CORE_TICK,
+		SECTION_CORE_MOVE,
+		SECTION_VERIFY,
+		NUM_SECTIONS,
+	};
+
+	CCollision *m_pCollision;
+	const CTeehistorianFile *m_pFile;
+	CTickProfiler *m_pProfiler;
+	int m_aSections[NUM_SECTIONS];
+
+	int64_t m_NumTicks = 0;
+	int64_t m_NumPlayerTicks = 0;
+	int64_t m_NumMatches = 0;
+	int64_t m_NumResyncs = 0;
+	int m_MaxError = 0;
+	// the first position that did not match the recorded one
+	int m_FirstDivergenceTick = -1;
+	int m_FirstDivergenceClientId = -1;
+	ivec2 m_FirstDivergenceExpected;
+	ivec2 m_FirstDivergenceActual;
+
+	void Run();
+
+private:
+	CWorldCore m_World;
+	CTeamsCore m_Teams;
+	CCharacterCore m_aCores[MAX_CLIENTS];
+	CNetObj_PlayerInput m_aInputs[MAX_CLIENTS];
+	bool m_aAlive[MAX_CLIENTS];
+	int m_aRecordedX[MAX_CLIENTS];
+	int m_aRecordedY[MAX_CLIENTS];
+
+	void Tick();
+	void Verify(int Tick, const bool *pSpawned);
+	void Spawn(int ClientId, int X, int Y);
+};
+
+void CReplay::Spawn(int ClientId, int X, int Y)
+{
+	CCharacterCore &Core = m_aCores[ClientId];
+	Core.Reset();
+	Core.Init(&m_World, m_pCollision, &m_Teams);
+	Core.m_Id = ClientId;
+	Core.m_Pos = vec2(X, Y);
+	m_World.m_apCharacters[ClientId] = &Core;
+	m_aAlive[ClientId] = true;
+}
+
+void CReplay::Tick()
+{
+	{
+		CTickProfiler::CScope Scope(m_pProfiler, m_aSections[SECTION_INPUT]);
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			if(m_aAlive[i])
+				m_aCores[i].m_Input = m_aInputs[i];
+		}
+	}
+	{
+		CTickProfiler::CScope Scope(m_pProfiler, m_aSections[SECTION_CORE_TICK]);
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			if(m_aAlive[i])
+				m_aCores[i].Tick(true);
+		}
+	}
+	{
+		CTickProfiler::CScope Scope(m_pProfiler, m_aSections[SECTION_CORE_MOVE]);
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			if(m_aAlive[i])
+			{
+				m_aCores[i].Move();
+				m_aCores[i].Quantize();
+			}
+		}
+	}
+	m_NumTicks++;
+}
+
+void CReplay::Verify(int Tick, const bool *pSpawned)
+{
+	CTickProfiler::CScope Scope(m_pProfiler, m_aSections[SECTION_VERIFY]);
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(!m_aAlive[i] || (pSpawned && pSpawned[i]))
+			continue;
+
+		CNetObj_CharacterCore Core;
+		m_aCores[i].Write(&Core);
+		m_NumPlayerTicks++;
+		if(Core.m_X == m_aRecordedX[i] && Core.m_Y == m_aRecordedY[i])
+		{
+			m_NumMatches++;
+			continue;
+		}
+		m_MaxError = maximum(m_MaxError, maximum(absolute(Core.m_X - m_aRecordedX[i]), absolute(Core.m_Y - m_aRecordedY[i])));
+		if(m_FirstDivergenceTick == -1)
+		{
+			m_FirstDivergenceTick = Tick;
+			m_FirstDivergenceClientId = i;
+			m_FirstDivergenceExpected = ivec2(m_aRecordedX[i], m_aRecordedY[i]);
+			m_FirstDivergenceActual = ivec2(Core.m_X, Core.m_Y);
+		}
+		m_aCores[i].m_Pos = vec2(m_aRecordedX[i], m_aRecordedY[i]);
+		m_NumResyncs++;
+	}
+}
+
+void CReplay::Run()
+{
+	m_World = CWorldCore();
+	m_World.m_aTuning[0] = m_pFile->m_Tuning;
+	m_World.InitSwitchers(m_pCollision->m_HighestSwitchNumber);
+	m_Teams.Reset();
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		m_aAlive[i] = false;
+		m_aInputs[i] = CNetObj_PlayerInput();
+		m_aInputs[i].m_TargetY = -1;
+	}
+
+	int CurrentTick = m_pFile->m_vTicks.empty() ? 0 : m_pFile->m_vTicks.front().m_Tick - 1;
+	for(const CRecordedTick &Recorded : m_pFile->m_vTicks)
+	{
+		while(CurrentTick < Recorded.m_Tick)
+		{
+			CurrentTick++;
+			Tick();
+			// nothing was recorded for these ticks, so the positions didn't change
+			if(CurrentTick < Recorded.m_Tick)
+				Verify(CurrentTick, nullptr);
+		}
+
+		bool aSpawned[MAX_CLIENTS] = {false};
+		for(const auto &Player : Recorded.m_vPlayers)
+		{
+			if(Player.m_Type == CRecordedTick::CPlayer::TYPE_OLD)
+			{
+				m_aAlive[Player.m_ClientId] = false;
+				m_World.m_apCharacters[Player.m_ClientId] = nullptr;
+				continue;
+			}
+			m_aRecordedX[Player.m_ClientId] = Player.m_X;
+			m_aRecordedY[Player.m_ClientId] = Player.m_Y;
+			if(Player.m_Type == CRecordedTick::CPlayer::TYPE_NEW || !m_aAlive[Player.m_ClientId])
+			{
+				Spawn(Player.m_ClientId, Player.m_X, Player.m_Y);
+				aSpawned[Player.m_ClientId] = true;
+			}
+		}
+		Verify(CurrentTick, aSpawned);
+
+		for(const auto &Team : Recorded.m_vTeams)
+			m_Teams.Team(Team.m_ClientId, Team.m_Team);
+
+		// inputs recorded after the tick are applied in the next one
+		for(const auto &Input : Recorded.m_vInputs)
+			mem_copy(&m_aInputs[Input.m_ClientId], Input.m_aData, sizeof(m_aInputs[Input.m_ClientId]));
+	}
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	// the percentage of player ticks that may diverge from the recording,
+	// negative to only report the divergence
+	float Tolerance = -1.0f;
+	bool ValidTolerance = true;
+	std::vector<const char *> vpArgs;
+	for(int i = 1; i < argc; i++)
+	{
+		if(str_comp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+		{
+			Tolerance = str_tofloat(argv[++i]);
+			ValidTolerance = Tolerance >= 0.0f;
+		}
+		else
+			vpArgs.push_back(argv[i]);
+	}
+
+	if(vpArgs.size() < 2 || vpArgs.size() > 3 || !ValidTolerance)
+	{
+		log_error(TOOL_NAME, "usage: %s [--tolerance percent] map teehistorian [repetitions]", argv[0]);
+		log_error(TOOL_NAME, "replays the recorded inputs through the character cores as fast as possible,");
+		log_error(TOOL_NAME, "the map is looked up in the storage like the server does, e.g. maps/Tutorial.map");
+		log_error(TOOL_NAME, "tiles, switches and weapons that the game world handles outside of the cores are not simulated,");
+		log_error(TOOL_NAME, "so the replay diverges from the recording on maps that use them");
+		log_error(TOOL_NAME, "with --tolerance it fails if more than that percentage of player ticks diverge from the recorded positions");
+		return -1;
+	}
+	const char *pMapName = vpArgs[0];
+	const char *pTeehistorianName = vpArgs[1];
+	const int Repetitions = vpArgs.size() > 2 ? str_toint(vpArgs[2]) : 1;
+	if(Repetitions <= 0)
+	{
+		log_error(TOOL_NAME, "repetitions must be positive");
+		return -1;
+	}
+
+	std::unique_ptr<IKernel> pKernel = std::unique_ptr<IKernel>(IKernel::Create());
+	IStorage *pStorage = CreateStorage(IStorage::STORAGETYPE_SERVER, argc, argv);
+	if(!pStorage)
+	{
+		log_error(TOOL_NAME, "could not initialize storage");
+		return -1;
+	}
+	pKernel->RegisterInterface(pStorage);
+	IEngineMap *pMap = CreateEngineMap();
+	pKernel->RegisterInterface(pMap);
+	pKernel->RegisterInterface(static_cast<IMap *>(pMap), false);
+
+	if(!pMap->Load(pMapName))
+	{
+		log_error(TOOL_NAME, "could not load map '%s'", pMapName);
+		return -1;
+	}
+
+	void *pData;
+	unsigned Size;
+	if(!pStorage->ReadFile(pTeehistorianName, IStorage::TYPE_ABSOLUTE, &pData, &Size))
+	{
+		log_error(TOOL_NAME, "could not read teehistorian file '%s'", pTeehistorianName);
+		return -1;
+	}
+	CTeehistorianFile File;
+	const int64_t ParseStart = time_get_nanoseconds().count();
+	const bool Loaded = File.Load((const unsigned char *)pData, Size);
+	const int64_t ParseTime = time_get_nanoseconds().count() - ParseStart;
+	free(pData);
+	if(!Loaded)
+		return -1;
+
+	char aMapSha256[SHA256_MAXSTRSIZE];
+	sha256_str(pMap->Sha256(), aMapSha256, sizeof(aMapSha256));
+	if(File.m_aMapSha256[0] && str_comp(File.m_aMapSha256, aMapSha256) != 0)
+		log_warn(TOOL_NAME, "the teehistorian file was recorded on map '%s' with sha256 %s", File.m_aMapName, File.m_aMapSha256);
+	log_info(TOOL_NAME, "parsed %d ticks with recorded data in %.1fms", (int)File.m_vTicks.size(), ParseTime / 1000000.0);
+
+	CLayers Layers;
+	Layers.Init(pMap, true);
+	CCollision Collision;
+	Collision.Init(&Layers);
+
+	CTickProfiler Profiler;
+	Profiler.SetEnabled(true);
+	auto pReplay = std::make_unique<CReplay>();
+	pReplay->m_pCollision = &Collision;
+	pReplay->m_pFile = &File;
+	pReplay->m_pProfiler = &Profiler;
+	static const char *s_apSectionNames[CReplay::NUM_SECTIONS] = {"input", "core_tick", "core_move", "verify"};
+	for(int i = 0; i < CReplay::NUM_SECTIONS; i++)
+		pReplay->m_aSections[i] = Profiler.AddSection(s_apSectionNames[i]);
+
+	for(int i = 0; i < Repetitions; i++)
+	{
+		const int64_t Start = time_get_nanoseconds().count();
+		pReplay->m_NumTicks = 0;
+		pReplay->Run();
+		const double Seconds = (time_get_nanoseconds().count() - Start) / 1e9;
+		log_info(TOOL_NAME, "run %d: %" PRId64 " ticks in %.3fs, %.0f ticks/s", i + 1, pReplay->m_NumTicks, Seconds, Seconds > 0 ? pReplay->m_NumTicks / Seconds : 0.0);
+	}
+
+	// only the phases of the replay, the game world of a server tick is not run
+	log_info(TOOL_NAME, "character core timings:");
+	char aBuf[256];
+	for(int i = 0; i < Profiler.NumSections(); i++)
+	{
+		Profiler.FormatSummary(i, aBuf, sizeof(aBuf));
+		log_info(TOOL_NAME, "%s", aBuf);
+	}
+
+	const int64_t PlayerTicks = pReplay->m_NumPlayerTicks / Repetitions;
+	const int64_t Matches = pReplay->m_NumMatches / Repetitions;
+	log_info(TOOL_NAME, "verified %" PRId64 " player ticks against the recorded positions: %" PRId64 " matched (%.2f%%), %" PRId64 " resynced, max error %d",
+		PlayerTicks, Matches, PlayerTicks ? 100.0 * Matches / PlayerTicks : 100.0, pReplay->m_NumResyncs / Repetitions, pReplay->m_MaxError);
+
+	const double Diverged = PlayerTicks ? 100.0 * (PlayerTicks - Matches) / PlayerTicks : 0.0;
+	if(pReplay->m_FirstDivergenceTick != -1)
+	{
+		log_info(TOOL_NAME, "first divergence in tick %d: client %d at (%d, %d), recorded (%d, %d)",
+			pReplay->m_FirstDivergenceTick, pReplay->m_FirstDivergenceClientId,
+			pReplay->m_FirstDivergenceActual.x, pReplay->m_FirstDivergenceActual.y,
+			pReplay->m_FirstDivergenceExpected.x, pReplay->m_FirstDivergenceExpected.y);
+	}
+	if(Tolerance >= 0.0f && Diverged > Tolerance)
+	{
+		log_error(TOOL_NAME, "%.2f%% of the player ticks diverged, more than the tolerated %.2f%%", Diverged, Tolerance);
+		return -1;
+	}
+	return 0;
+}
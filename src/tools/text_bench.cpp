@@ -0,0 +1,188 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/client/graphics_stub.h>
+#include <engine/console.h>
+#include <engine/engine.h>
+#include <engine/kernel.h>
+#include <engine/shared/config.h>
+#include <engine/shared/linereader.h>
+#include <engine/storage.h>
+#include <engine/textrender.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+static const char *TOOL_NAME = "text_bench";
+
+static int RemoveCachedGlyphs(const char *pName, int IsDir, int StorageType, void *pUser)
+{
+	IStorage *pStorage = static_cast<IStorage *>(pUser);
+	if(!IsDir && str_endswith(pName, ".glyphs"))
+	{
+		char aPath[IO_MAX_PATH_LENGTH];
+		str_format(aPath, sizeof(aPath), "glyphcache/%s", pName);
+		pStorage->RemoveFile(aPath, IStorage::TYPE_SAVE);
+	}
+	return 0;
+}
+
+class CBench
+{
+	IKernel *m_pKernel;
+	CGraphicsStub *m_pGraphics;
+	const std::vector<std::string> &m_vLines;
+	float m_FontSize;
+
+	std::unique_ptr<IEngineTextRender> m_pTextRender;
+	bool m_Registered = false;
+
+public:
+	CBench(IKernel *pKernel, CGraphicsStub *pGraphics, const std::vector<std::string> &vLines, float FontSize) :
+		m_pKernel(pKernel), m_pGraphics(pGraphics), m_vLines(vLines), m_FontSize(FontSize)
+	{
+	}
+
+	// every measurement starts with an empty glyph atlas
+	void Start(bool UseDiskCache)
+	{
+		g_Config.m_ClTextGlyphCache = UseDiskCache;
+		m_pTextRender = std::unique_ptr<IEngineTextRender>(CreateEngineTextRender());
+		if(m_Registered)
+			m_pKernel->ReregisterInterface(m_pTextRender.get());
+		else
+			m_pKernel->RegisterInterface(m_pTextRender.get(), false);
+		m_Registered = true;
+		m_pTextRender->Init();
+		m_pTextRender->LoadFonts();
+		m_pGraphics->ResetCounters();
+	}
+
+	void Stop()
+	{
+		m_pTextRender->Shutdown();
+		m_pTextRender = nullptr;
+	}
+
+	// lays out all lines into text containers like the menus do, glyphs that
+	// are missing from the atlas are rendered on the way
+	int64_t Layout()
+	{
+		const int64_t Start = time_get_nanoseconds().count();
+		for(const std::string &Line : m_vLines)
+		{
+			CTextCursor Cursor;
+			m_pTextRender->SetCursor(&Cursor, 0.0f, 0.0f, m_FontSize, TEXTFLAG_RENDER);
+			Cursor.m_LineWidth = 600.0f;
+			STextContainerIndex TextContainer;
+			m_pTextRender->CreateTextContainer(TextContainer, &Cursor, Line.c_str());
+			m_pTextRender->DeleteTextContainer(TextContainer);
+		}
+		return time_get_nanoseconds().count() - Start;
+	}
+
+	int64_t Prewarm()
+	{
+		const int64_t Start = time_get_nanoseconds().count();
+		for(const std::string &Line : m_vLines)
+			m_pTextRender->PrewarmGlyphs(Line.c_str(), m_FontSize);
+		while(m_pTextRender->IsPrewarming())
+			thread_yield();
+		return time_get_nanoseconds().count() - Start;
+	}
+};
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc > 3)
+	{
+		log_error(TOOL_NAME, "Usage: %s [corpus] [font_size]", TOOL_NAME);
+		log_error(TOOL_NAME, "the corpus is a text file from the data directory, e.g. languages/russian.txt");
+		log_error(TOOL_NAME, "the glyph cache files in the glyphcache folder of the user directory are deleted");
+		return -1;
+	}
+	const char *pCorpus = argc > 1 ? argv[1] : "languages/russian.txt";
+	const float FontSize = argc > 2 ? clamp(str_tofloat(argv[2]), 6.0f, 128.0f) : 12.0f;
+
+	std::unique_ptr<IKernel> pKernel = std::unique_ptr<IKernel>(IKernel::Create());
+	IStorage *pStorage = CreateStorage(IStorage::STORAGETYPE_CLIENT, argc, argv);
+	if(!pStorage)
+	{
+		log_error(TOOL_NAME, "could not initialize storage");
+		return -1;
+	}
+	pKernel->RegisterInterface(pStorage);
+	std::unique_ptr<IConsole> pConsole = CreateConsole(CFGFLAG_CLIENT);
+	pKernel->RegisterInterface(pConsole.get(), false);
+	IEngine *pEngine = CreateTestEngine("DDNet", 2);
+	pKernel->RegisterInterface(pEngine);
+	CGraphicsStub Graphics;
+	pKernel->RegisterInterface(static_cast<IGraphics *>(&Graphics), false);
+
+	// every line of the corpus, the translation files are used as they are
+	std::vector<std::string> vLines;
+	size_t NumBytes = 0;
+	CLineReader LineReader;
+	if(!LineReader.OpenFile(pStorage->OpenFile(pCorpus, IOFLAG_READ, IStorage::TYPE_ALL)))
+	{
+		log_error(TOOL_NAME, "could not open corpus '%s'", pCorpus);
+		return -1;
+	}
+	while(const char *pLine = LineReader.Get())
+	{
+		if(pLine[0] == '\0' || pLine[0] == '#')
+			continue;
+		if(str_startswith(pLine, "== "))
+			pLine += 3;
+		vLines.emplace_back(pLine);
+		NumBytes += vLines.back().size();
+	}
+
+	pStorage->ListDirectory(IStorage::TYPE_SAVE, "glyphcache", RemoveCachedGlyphs, pStorage);
+
+	CBench Bench(pKernel.get(), &Graphics, vLines, FontSize);
+
+	// glyphs are rendered on demand while laying out the text, the second
+	// layout finds all glyphs in the atlas
+	Bench.Start(false);
+	const int64_t ColdDuration = Bench.Layout();
+	const int NumTextContainers = Graphics.m_NumBufferContainersCreated;
+	const int64_t WarmDuration = Bench.Layout();
+	Bench.Stop();
+
+	// the glyphs are rendered by a job before the text is laid out
+	Bench.Start(false);
+	const int64_t PrewarmDuration = Bench.Prewarm();
+	const int64_t PrewarmedDuration = Bench.Layout();
+	Bench.Stop();
+
+	// the first prewarm fills the glyph cache files, after a restart the
+	// glyphs are read from them when the text is laid out or prewarmed
+	Bench.Start(true);
+	const int64_t CacheFillDuration = Bench.Prewarm();
+	Bench.Stop();
+	Bench.Start(true);
+	const int64_t CachedColdDuration = Bench.Layout();
+	Bench.Stop();
+	Bench.Start(true);
+	const int64_t CachedPrewarmDuration = Bench.Prewarm();
+	Bench.Stop();
+
+	pStorage->ListDirectory(IStorage::TYPE_SAVE, "glyphcache", RemoveCachedGlyphs, pStorage);
+
+	log_info(TOOL_NAME, "'%s': %d lines, %d bytes, %d text containers, font size %.1f", pCorpus, (int)vLines.size(), (int)NumBytes, NumTextContainers, FontSize);
+	log_info(TOOL_NAME, "layout, glyphs rendered on demand: %.3fms", ColdDuration / 1000000.0);
+	log_info(TOOL_NAME, "layout, glyphs in the atlas: %.3fms", WarmDuration / 1000000.0);
+	log_info(TOOL_NAME, "prewarm job: %.3fms, layout afterwards: %.3fms", PrewarmDuration / 1000000.0, PrewarmedDuration / 1000000.0);
+	log_info(TOOL_NAME, "prewarm job writing the glyph cache: %.3fms", CacheFillDuration / 1000000.0);
+	log_info(TOOL_NAME, "layout, glyphs from the glyph cache: %.3fms", CachedColdDuration / 1000000.0);
+	log_info(TOOL_NAME, "prewarm job, glyphs from the glyph cache: %.3fms", CachedPrewarmDuration / 1000000.0);
+
+	pEngine->ShutdownJobs();
+	return 0;
+}
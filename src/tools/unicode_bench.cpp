@@ -0,0 +1,214 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+#include <base/unicode/confusables.h>
+#include <base/unicode/tolower.h>
+
+#include <engine/shared/linereader.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static const char *TOOL_NAME = "unicode_bench";
+
+// names like the ones seen on servers, from plain ASCII to names that are
+// decorated with lookalike characters of other scripts
+static const char *const DEFAULT_NAMES[] = {
+	"nameless tee",
+	"brainless tee",
+	"ChillerDragon",
+	"Gores Enjoyer",
+	"[D] Dummy",
+	"xX_Pro_Xx",
+	"Jumpy Müller",
+	"Ólafur",
+	"François",
+	"Łukasz",
+	"Ёжик",
+	"Пельмень",
+	"Ωmega",
+	"Σπύρος",
+	"ᴅᴜᴍᴍʏ",
+	"ѕмσкє",
+	"Ｆｕｌｌｗｉｄｔｈ",
+	"★Kirby★",
+	"ツ Zaaz",
+	"♥ love ♥",
+	"𝕯𝖔𝖔𝖒",
+	"𝓢𝓬𝓻𝓲𝓹𝓽",
+	"ʟᴏʀᴅ",
+	"Ꮶⅰng",
+	"n!ck",
+	"İstanbul",
+	"Ğökhan",
+	"Nguyễn",
+	"Đặng",
+	"ŻÓŁW",
+	"ДДРейсер",
+	"Tee 42",
+};
+
+// the skeleton lookup before the lookup table, a scan of the sorted list
+static int OldSkeleton(int Ch, const int **ppSkeleton, int *pSkeletonLen)
+{
+	for(int i = 0; i < NUM_DECOMPS; i++)
+	{
+		if(Ch == decomp_chars[i])
+		{
+			*ppSkeleton = &decomp_data[decomp_slices[i].offset];
+			*pSkeletonLen = decomp_lengths[decomp_slices[i].length];
+			return 1;
+		}
+		else if(Ch < decomp_chars[i])
+		{
+			break;
+		}
+	}
+	*ppSkeleton = nullptr;
+	*pSkeletonLen = 1;
+	return 0;
+}
+
+static int OldToSkeleton(const char *pStr, int *pBuf, int BufLen)
+{
+	int Length = 0;
+	while(Length < BufLen)
+	{
+		const int Ch = str_utf8_decode(&pStr);
+		if(Ch <= 0)
+			break;
+		const int *pSkeleton;
+		int SkeletonLen;
+		if(OldSkeleton(Ch, &pSkeleton, &SkeletonLen))
+		{
+			for(int i = 0; i < SkeletonLen && Length < BufLen; i++)
+				pBuf[Length++] = pSkeleton[i];
+		}
+		else
+		{
+			pBuf[Length++] = Ch;
+		}
+	}
+	return Length;
+}
+
+// the lowercase lookup before the lookup table, a binary search
+static int CompareUpper(const void *pA, const void *pB)
+{
+	return static_cast<const UPPER_LOWER *>(pA)->upper - static_cast<const UPPER_LOWER *>(pB)->upper;
+}
+
+static int OldToLower(int Code)
+{
+	UPPER_LOWER Key;
+	Key.upper = Code;
+	const UPPER_LOWER *pResult = static_cast<const UPPER_LOWER *>(bsearch(&Key, tolowermap, NUM_TOLOWER, sizeof(UPPER_LOWER), CompareUpper));
+	return pResult ? pResult->lower : Code;
+}
+
+static unsigned SkeletonHash(const int *pSkeleton, int Length)
+{
+	unsigned Hash = 5381;
+	for(int i = 0; i < Length; i++)
+		Hash = Hash * 33 + pSkeleton[i];
+	return Hash;
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc > 3)
+	{
+		log_error(TOOL_NAME, "Usage: %s [repetitions] [names]", TOOL_NAME);
+		log_error(TOOL_NAME, "names is a text file with one player name per line, a built-in list is used without it");
+		return -1;
+	}
+	const int NumRepetitions = argc > 1 ? maximum(str_toint(argv[1]), 1) : 10000;
+
+	std::vector<std::string> vNames;
+	if(argc > 2)
+	{
+		CLineReader LineReader;
+		if(!LineReader.OpenFile(io_open(argv[2], IOFLAG_READ)))
+		{
+			log_error(TOOL_NAME, "could not open '%s'", argv[2]);
+			return -1;
+		}
+		while(const char *pLine = LineReader.Get())
+		{
+			if(pLine[0] != '\0')
+				vNames.emplace_back(pLine);
+		}
+	}
+	else
+	{
+		vNames.assign(std::begin(DEFAULT_NAMES), std::end(DEFAULT_NAMES));
+	}
+
+	std::vector<std::vector<int>> vvCodes;
+	int NumCodes = 0;
+	for(const std::string &Name : vNames)
+	{
+		std::vector<int> &vCodes = vvCodes.emplace_back();
+		const char *pStr = Name.c_str();
+		while(int Code = str_utf8_decode(&pStr))
+		{
+			if(Code > 0)
+				vCodes.push_back(Code);
+		}
+		NumCodes += vCodes.size();
+	}
+
+	int aSkeleton[64];
+	bool Equal = true;
+	unsigned aHashes[2] = {0, 0};
+	int64_t aSkeletonDurations[2];
+	for(int New = 0; New < 2; New++)
+	{
+		const int64_t Start = time_get_nanoseconds().count();
+		for(int r = 0; r < NumRepetitions; r++)
+		{
+			for(const std::string &Name : vNames)
+			{
+				const int Length = New ? str_utf8_to_skeleton(Name.c_str(), aSkeleton, std::size(aSkeleton)) : OldToSkeleton(Name.c_str(), aSkeleton, std::size(aSkeleton));
+				aHashes[New] += SkeletonHash(aSkeleton, Length);
+			}
+		}
+		aSkeletonDurations[New] = time_get_nanoseconds().count() - Start;
+	}
+	Equal = Equal && aHashes[0] == aHashes[1];
+
+	int64_t aLowerDurations[2];
+	int aSums[2] = {0, 0};
+	for(int New = 0; New < 2; New++)
+	{
+		const int64_t Start = time_get_nanoseconds().count();
+		for(int r = 0; r < NumRepetitions; r++)
+		{
+			for(const std::vector<int> &vCodes : vvCodes)
+			{
+				for(int Code : vCodes)
+					aSums[New] += New ? str_utf8_tolower(Code) : OldToLower(Code);
+			}
+		}
+		aLowerDurations[New] = time_get_nanoseconds().count() - Start;
+	}
+	Equal = Equal && aSums[0] == aSums[1];
+
+	const double NumNames = (double)vNames.size() * NumRepetitions;
+	const double NumChars = (double)NumCodes * NumRepetitions;
+	log_info(TOOL_NAME, "%d names with %d code points, %d repetitions", (int)vNames.size(), NumCodes, NumRepetitions);
+	log_info(TOOL_NAME, "skeleton, sorted list: %.1fns per name", aSkeletonDurations[0] / NumNames);
+	log_info(TOOL_NAME, "skeleton, lookup table: %.1fns per name", aSkeletonDurations[1] / NumNames);
+	log_info(TOOL_NAME, "tolower, binary search: %.2fns per code point", aLowerDurations[0] / NumChars);
+	log_info(TOOL_NAME, "tolower, lookup table: %.2fns per code point", aLowerDurations[1] / NumChars);
+	if(!Equal)
+	{
+		log_error(TOOL_NAME, "the lookup tables changed the result");
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,160 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/compression.h>
+
+#include <game/prng.h>
+
+#include <vector>
+
+static const char *TOOL_NAME = "varint_bench";
+
+enum
+{
+	// ints per buffer, about the size of a snapshot delta chunk
+	BUFFER_INTS = 256,
+};
+
+// the compression loops before single byte runs were handled in blocks
+static long OldCompress(const int *pSrc, int Num, unsigned char *pDst, int DstSize)
+{
+	unsigned char *pOut = pDst;
+	const unsigned char *pDstEnd = pDst + DstSize;
+	for(int i = 0; i < Num; i++)
+	{
+		pOut = CVariableInt::Pack(pOut, pSrc[i], pDstEnd - pOut);
+		if(!pOut)
+			return -1;
+	}
+	return (long)(pOut - pDst);
+}
+
+static long OldDecompress(const unsigned char *pSrc, int SrcSize, int *pDst, int DstNum)
+{
+	const unsigned char *pSrcEnd = pSrc + SrcSize;
+	int *pOut = pDst;
+	while(pSrc < pSrcEnd)
+	{
+		if(pOut >= pDst + DstNum)
+			return -1;
+		pSrc = CVariableInt::Unpack(pSrc, pOut, pSrcEnd - pSrc);
+		if(!pSrc)
+			return -1;
+		pOut++;
+	}
+	return (long)((pOut - pDst) * sizeof(int));
+}
+
+class CGenerator
+{
+	CPrng m_Prng;
+
+public:
+	CGenerator()
+	{
+		uint64_t aSeed[2] = {0x76617269, 0x6e743332};
+		m_Prng.Seed(aSeed);
+	}
+
+	int Random(int Max) { return m_Prng.RandomBits() % Max; }
+
+	// A value with the given number of bytes when packed: the first byte
+	// holds 6 bits, every further one 7 bits.
+	int Value(int Bytes)
+	{
+		const int Bits = 6 + 7 * (Bytes - 1);
+		const unsigned Max = Bits >= 31 ? 0x7fffffffu : (1u << Bits) - 1;
+		const int Magnitude = m_Prng.RandomBits() & Max;
+		return Random(2) ? Magnitude : ~Magnitude;
+	}
+};
+
+struct CDataset
+{
+	const char *m_pName;
+	std::vector<int> m_vInts;
+};
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc > 2)
+	{
+		log_error(TOOL_NAME, "Usage: %s [buffers]", TOOL_NAME);
+		return -1;
+	}
+	const int NumBuffers = argc > 1 ? maximum(str_toint(argv[1]), 1) : 20000;
+
+	CGenerator Generator;
+	CDataset aDatasets[3] = {{"snapshot delta", {}}, {"single byte", {}}, {"mixed sizes", {}}};
+	for(int i = 0; i < NumBuffers * BUFFER_INTS; i++)
+	{
+		// Deltas of moving characters: mostly unchanged fields, now and then
+		// a few changed positions and velocities, rarely a new item.
+		const int Kind = Generator.Random(100);
+		aDatasets[0].m_vInts.push_back(Kind < 75 ? 0 : Kind < 90 ? Generator.Value(1) : Kind < 98 ? Generator.Value(2) : Generator.Value(3 + Generator.Random(3)));
+		aDatasets[1].m_vInts.push_back(Generator.Value(1));
+		aDatasets[2].m_vInts.push_back(Generator.Value(1 + Generator.Random(5)));
+	}
+
+	bool Equal = true;
+	for(const CDataset &Dataset : aDatasets)
+	{
+		const int *pInts = Dataset.m_vInts.data();
+		const int MaxPacked = BUFFER_INTS * CVariableInt::MAX_BYTES_PACKED;
+		std::vector<unsigned char> avPacked[2];
+		std::vector<int> avSizes[2];
+		int64_t aCompressDurations[2];
+		for(int New = 0; New < 2; New++)
+		{
+			avPacked[New].resize((size_t)NumBuffers * MaxPacked);
+			const int64_t Start = time_get_nanoseconds().count();
+			for(int b = 0; b < NumBuffers; b++)
+			{
+				unsigned char *pDst = avPacked[New].data() + (size_t)b * MaxPacked;
+				const int *pSrc = pInts + (size_t)b * BUFFER_INTS;
+				avSizes[New].push_back(New ? CVariableInt::Compress(pSrc, BUFFER_INTS * sizeof(int), pDst, MaxPacked) : OldCompress(pSrc, BUFFER_INTS, pDst, MaxPacked));
+			}
+			aCompressDurations[New] = time_get_nanoseconds().count() - Start;
+		}
+
+		std::vector<int> avUnpacked[2];
+		int64_t aDecompressDurations[2];
+		size_t PackedBytes = 0;
+		for(int New = 0; New < 2; New++)
+		{
+			avUnpacked[New].resize((size_t)NumBuffers * BUFFER_INTS);
+			const int64_t Start = time_get_nanoseconds().count();
+			for(int b = 0; b < NumBuffers; b++)
+			{
+				const unsigned char *pSrc = avPacked[1].data() + (size_t)b * MaxPacked;
+				int *pDst = avUnpacked[New].data() + (size_t)b * BUFFER_INTS;
+				const long Size = New ? CVariableInt::Decompress(pSrc, avSizes[1][b], pDst, BUFFER_INTS * sizeof(int)) : OldDecompress(pSrc, avSizes[1][b], pDst, BUFFER_INTS);
+				Equal &= Size == BUFFER_INTS * (long)sizeof(int);
+			}
+			aDecompressDurations[New] = time_get_nanoseconds().count() - Start;
+		}
+
+		for(int b = 0; b < NumBuffers; b++)
+		{
+			PackedBytes += avSizes[1][b];
+			Equal &= avSizes[0][b] == avSizes[1][b] && mem_comp(avPacked[0].data() + (size_t)b * MaxPacked, avPacked[1].data() + (size_t)b * MaxPacked, avSizes[1][b]) == 0;
+		}
+		Equal &= avUnpacked[0] == Dataset.m_vInts && avUnpacked[1] == Dataset.m_vInts;
+
+		const double NumInts = (double)NumBuffers * BUFFER_INTS;
+		log_info(TOOL_NAME, "%s: %.2f bytes per int", Dataset.m_pName, PackedBytes / NumInts);
+		log_info(TOOL_NAME, "  compress: scalar %.2fns, blocks %.2fns per int", aCompressDurations[0] / NumInts, aCompressDurations[1] / NumInts);
+		log_info(TOOL_NAME, "  decompress: scalar %.2fns, blocks %.2fns per int", aDecompressDurations[0] / NumInts, aDecompressDurations[1] / NumInts);
+	}
+
+	if(!Equal)
+	{
+		log_error(TOOL_NAME, "the block loops changed the result");
+		return -1;
+	}
+	return 0;
+}